@@ -39,6 +39,9 @@ project "S3DEngine"
     systemversion "latest"
     defines "SG_PLATFORM_WINDOWS"
 
+    filter "system:linux"
+    defines "SG_PLATFORM_LINUX=1"
+
 filter "configurations:Debug"
     kind "SharedLib"
     runtime "Debug"
@@ -1,11 +1,13 @@
 #pragma once
 
-#if defined(SG_BUILD_DLL) // If this module is a dll
+#if defined(SG_BUILD_DLL) && defined(SG_PLATFORM_WINDOWS) // If this module is a dll
 #	if defined(SG_MODULE)
 #		define SG_CORE_API __declspec(dllexport)
 #	else
 #		define SG_CORE_API __declspec(dllimport)
 #	endif
+#elif defined(SG_BUILD_DLL) // the shared object on linux
+#	define SG_CORE_API __attribute__((visibility("default")))
 #else
 #	define SG_CORE_API
 #endif
@@ -18,3 +20,6 @@
 #define SG_ENABLE_MEMORY_LEAK_DETECTION 0
 #define SG_ENABLE_MEMORY_PROFILE 0
 #define SG_USE_DEFAULT_MEMORY_ALLOCATION 1
+
+// re-reflect the shaders whose reflections are cached and check them, enable it on CI.
+#define SG_VALIDATE_SHADER_REFLECTION 0
\ No newline at end of file
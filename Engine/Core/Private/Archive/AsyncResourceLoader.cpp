@@ -0,0 +1,349 @@
+#include "StdAfx.h"
+#include "Archive/AsyncResourceLoader.h"
+
+#include "System/Logger.h"
+#include "Thread/IJobSystem.h"
+#include "Asset/Asset.h"
+#include "Event/MessageBus/MessageBus.h"
+#include "Memory/Memory.h"
+#include "Profile/Profile.h"
+
+#include "Stl/vector.h"
+#include "EASTL/heap.h"
+#include "EASTL/unordered_map.h"
+
+namespace SG
+{
+
+	namespace
+	{
+		struct LoadRequest
+		{
+			EResourceTypeCategory category = EResourceTypeCategory::eTexture;
+			ELoadPriority priority = ELoadPriority::eNormal;
+			UInt64        sequence = 0;
+			SJobHandle    handle = {};
+			bool          bSucceeded = false;
+
+			// filled on the main thread when the request is made, the workers only read them.
+			string        filename = "";
+			bool          bNeedMipmap = false;
+			bool          bIsCubeMap = false;
+			EMeshType     meshType = EMeshType::eUnknown;
+			ELoadMeshFlag meshFlag = ELoadMeshFlag(0);
+
+			// filled by the worker
+			Raw2DTexture  textureData = {};
+			MeshData      meshData = {};
+
+			RefPtr<TextureAsset>      pTextureAsset = nullptr;
+			vector<TextureLoadedFunc> textureCallbacks;
+			vector<MeshLoadedFunc>    meshCallbacks;
+		};
+
+		//! Order of the priority queue, the request with higher priority or made earlier is greater.
+		struct LoadRequestComparer
+		{
+			bool operator()(const LoadRequest* lhs, const LoadRequest* rhs) const
+			{
+				if (lhs->priority != rhs->priority)
+					return lhs->priority < rhs->priority;
+				return lhs->sequence > rhs->sequence;
+			}
+		};
+
+		struct AsyncLoaderContext
+		{
+			vector<LoadRequest*> pendingRequests;   //!< Binary heap ordered by LoadRequestComparer.
+			vector<LoadRequest*> runningRequests;   //!< Requests had been scheduled to the workers.
+			eastl::unordered_map<UInt32, LoadRequest*> textureRequests; //!< assetId -> request, for the textures not delivered yet.
+			UInt64 nextSequence = 0;
+
+			Mutex                finishedLock;
+			vector<LoadRequest*> finishedRequests;  //!< Pushed by the workers.
+
+			// the resources delivered in this frame, they are kept alive until the next OnUpdate().
+			vector<LoadRequest*>         deliveredRequests;
+			vector<RefPtr<TextureAsset>> loadedTextures;
+
+			MessageBusMember* pMessageBusMember = nullptr;
+			bool bInitialized = false;
+		};
+
+		static AsyncLoaderContext sContext;
+
+		static void _LoadJob(void* pUser)
+		{
+			LoadRequest* pRequest = reinterpret_cast<LoadRequest*>(pUser);
+			if (pRequest->category == EResourceTypeCategory::eTexture)
+			{
+				TextureResourceLoader texLoader;
+				pRequest->bSucceeded = texLoader.LoadFromFile(pRequest->filename.c_str(), pRequest->textureData, pRequest->bNeedMipmap, pRequest->bIsCubeMap) &&
+					pRequest->textureData.IsValid();
+			}
+			else
+			{
+				MeshResourceLoader meshLoader;
+				pRequest->bSucceeded = meshLoader.LoadFromFile(pRequest->filename, pRequest->meshType, pRequest->meshData, pRequest->meshFlag);
+			}
+
+			ScopeLock lock(sContext.finishedLock);
+			sContext.finishedRequests.push_back(pRequest);
+		}
+
+		static void _PushPendingRequest(LoadRequest* pRequest)
+		{
+			pRequest->sequence = sContext.nextSequence++;
+			sContext.pendingRequests.push_back(pRequest);
+			eastl::push_heap(sContext.pendingRequests.begin(), sContext.pendingRequests.end(), LoadRequestComparer());
+		}
+
+		static void _DispatchPendingRequests(UInt32 maxRunningRequests)
+		{
+			auto& pendingRequests = sContext.pendingRequests;
+			while (!pendingRequests.empty() && sContext.runningRequests.size() < maxRunningRequests)
+			{
+				eastl::pop_heap(pendingRequests.begin(), pendingRequests.end(), LoadRequestComparer());
+				LoadRequest* pRequest = pendingRequests.back();
+				pendingRequests.pop_back();
+
+				// it must be added before being scheduled, the job may finish at once.
+				sContext.runningRequests.push_back(pRequest);
+				pRequest->handle = JobSystem::Schedule(_LoadJob, pRequest);
+			}
+		}
+
+		static void _ReleaseRequest(LoadRequest* pRequest)
+		{
+			if (pRequest->textureData.IsValid())
+				pRequest->textureData.FreeMemory();
+			Delete(pRequest);
+		}
+
+		static UInt32 _GetMaxRunningRequests()
+		{
+			// do not flood the workers, so that the later requests with higher priority can still go first.
+			const UInt32 numWorkers = JobSystem::GetNumWorkers();
+			return numWorkers == 0 ? 1 : numWorkers;
+		}
+	}
+
+	void AsyncResourceLoader::OnInit()
+	{
+		SG_PROFILE_FUNCTION();
+
+		sContext.pMessageBusMember = New(MessageBusMember);
+		sContext.bInitialized = true;
+	}
+
+	void AsyncResourceLoader::OnShutdown()
+	{
+		SG_PROFILE_FUNCTION();
+
+		// drop the requests which had not started, and wait for the running ones.
+		for (auto* pRequest : sContext.pendingRequests)
+			_ReleaseRequest(pRequest);
+		sContext.pendingRequests.clear();
+
+		for (auto* pRequest : sContext.runningRequests)
+			JobSystem::CompleteAndDispose(pRequest->handle);
+		for (auto* pRequest : sContext.runningRequests)
+			_ReleaseRequest(pRequest);
+		sContext.runningRequests.clear();
+		sContext.finishedRequests.clear();
+		sContext.textureRequests.clear();
+
+		for (auto* pRequest : sContext.deliveredRequests)
+			_ReleaseRequest(pRequest);
+		sContext.deliveredRequests.clear();
+		sContext.loadedTextures.clear();
+
+		Delete(sContext.pMessageBusMember);
+		sContext.pMessageBusMember = nullptr;
+		sContext.bInitialized = false;
+	}
+
+	void AsyncResourceLoader::OnUpdate()
+	{
+		SG_PROFILE_FUNCTION();
+
+		// the events of the last frame had been cleared
+		for (auto* pRequest : sContext.deliveredRequests)
+			_ReleaseRequest(pRequest);
+		sContext.deliveredRequests.clear();
+		sContext.loadedTextures.clear();
+
+		DeliverFinishedRequests();
+		_DispatchPendingRequests(_GetMaxRunningRequests());
+
+		// no worker to run the jobs, load them on the main thread.
+		if (JobSystem::GetNumWorkers() == 0)
+		{
+			for (auto* pRequest : sContext.runningRequests)
+				pRequest->handle.Complete();
+		}
+	}
+
+	void AsyncResourceLoader::DeliverFinishedRequests()
+	{
+		SG_PROFILE_FUNCTION();
+
+		vector<LoadRequest*> finishedRequests;
+		{
+			ScopeLock lock(sContext.finishedLock);
+			finishedRequests.swap(sContext.finishedRequests);
+		}
+		if (finishedRequests.empty())
+			return;
+
+		const Size numLoadedTextures = sContext.loadedTextures.size();
+		for (auto* pRequest : finishedRequests)
+		{
+			pRequest->handle.Dispose();
+			sContext.runningRequests.erase(eastl::find(sContext.runningRequests.begin(), sContext.runningRequests.end(), pRequest));
+
+			if (pRequest->category == EResourceTypeCategory::eTexture)
+			{
+				RefPtr<TextureAsset> pTextureAsset = pRequest->pTextureAsset;
+				sContext.textureRequests.erase(pTextureAsset->GetAssetID());
+				if (!pRequest->bSucceeded)
+				{
+					SG_LOG_ERROR("Failed to load texture: %s", pRequest->filename.c_str());
+					_ReleaseRequest(pRequest);
+					continue;
+				}
+
+				// the asset may had been loaded synchronously while this request is running.
+				if (!pTextureAsset->IsDiskResourceLoaded())
+				{
+					pTextureAsset->mTextureData = pRequest->textureData;
+					pRequest->textureData.pData = nullptr;
+					pRequest->textureData.pUserData = nullptr;
+				}
+
+				for (auto& func : pRequest->textureCallbacks)
+					func(pTextureAsset);
+				sContext.loadedTextures.push_back(pTextureAsset);
+				_ReleaseRequest(pRequest);
+			}
+			else
+			{
+				if (!pRequest->bSucceeded)
+				{
+					SG_LOG_ERROR("Failed to load mesh: %s", pRequest->filename.c_str());
+					_ReleaseRequest(pRequest);
+					continue;
+				}
+
+				// no one listens for the mesh data as a whole, it only goes to the requesters.
+				for (auto& func : pRequest->meshCallbacks)
+					func(pRequest->meshData);
+				sContext.deliveredRequests.push_back(pRequest);
+			}
+		}
+
+		// the message bus only keeps the last event with the same name in a frame, so always publish all the resources of this frame.
+		if (sContext.loadedTextures.size() != numLoadedTextures)
+			sContext.pMessageBusMember->PushEvent("OnTextureAssetsLoaded", sContext.loadedTextures);
+	}
+
+	void AsyncResourceLoader::LoadTexture(RefPtr<TextureAsset> pTextureAsset, ELoadPriority priority, TextureLoadedFunc&& func)
+	{
+		SG_PROFILE_FUNCTION();
+
+		SG_ASSERT(pTextureAsset);
+		if (pTextureAsset->IsDiskResourceLoaded())
+		{
+			if (func)
+				func(pTextureAsset);
+			return;
+		}
+
+		if (!sContext.bInitialized)
+		{
+			SG_LOG_WARN("AsyncResourceLoader is not running, load texture synchronously: %s", pTextureAsset->GetFileName().c_str());
+			pTextureAsset->LoadDataFromFile();
+			if (func && pTextureAsset->IsDiskResourceLoaded())
+				func(pTextureAsset);
+			return;
+		}
+
+		auto node = sContext.textureRequests.find(pTextureAsset->GetAssetID());
+		if (node != sContext.textureRequests.end())
+		{
+			LoadRequest* pRequest = node->second;
+			if (func)
+				pRequest->textureCallbacks.emplace_back(eastl::move(func));
+
+			auto& pendingRequests = sContext.pendingRequests;
+			if (priority > pRequest->priority && eastl::find(pendingRequests.begin(), pendingRequests.end(), pRequest) != pendingRequests.end())
+			{
+				pRequest->priority = priority;
+				eastl::make_heap(pendingRequests.begin(), pendingRequests.end(), LoadRequestComparer());
+			}
+			return;
+		}
+
+		LoadRequest* pRequest = New(LoadRequest);
+		pRequest->category = EResourceTypeCategory::eTexture;
+		pRequest->priority = priority;
+		pRequest->filename = pTextureAsset->GetFileName();
+		pRequest->bNeedMipmap = pTextureAsset->mbNeedMipmap;
+		pRequest->bIsCubeMap = pTextureAsset->mbIsCubeMap;
+		pRequest->pTextureAsset = pTextureAsset;
+		if (func)
+			pRequest->textureCallbacks.emplace_back(eastl::move(func));
+
+		sContext.textureRequests[pTextureAsset->GetAssetID()] = pRequest;
+		_PushPendingRequest(pRequest);
+	}
+
+	void AsyncResourceLoader::LoadMesh(const string& filename, EMeshType type, ELoadPriority priority, MeshLoadedFunc&& func, ELoadMeshFlag flag)
+	{
+		SG_PROFILE_FUNCTION();
+
+		// the embedded materials are created in the asset archives, which can only be touched by the main thread.
+		SG_ASSERT(!SG_HAS_ENUM_FLAG(flag, ELoadMeshFlag::efLoadEmbeddedMaterials) && "Embedded materials can not be loaded in the background!");
+
+		if (!sContext.bInitialized)
+		{
+			SG_LOG_WARN("AsyncResourceLoader is not running, load mesh synchronously: %s", filename.c_str());
+			MeshData meshData;
+			MeshResourceLoader meshLoader;
+			if (meshLoader.LoadFromFile(filename, type, meshData, flag) && func)
+				func(meshData);
+			return;
+		}
+
+		LoadRequest* pRequest = New(LoadRequest);
+		pRequest->category = EResourceTypeCategory::eMesh;
+		pRequest->priority = priority;
+		pRequest->filename = filename;
+		pRequest->meshType = type;
+		// FileSystem only have one global stream, so the workers can not write the cooked file.
+		pRequest->meshFlag = flag | ELoadMeshFlag::efNoCookedFileWrite;
+		if (func)
+			pRequest->meshCallbacks.emplace_back(eastl::move(func));
+
+		_PushPendingRequest(pRequest);
+	}
+
+	UInt32 AsyncResourceLoader::GetNumPendingRequests()
+	{
+		return static_cast<UInt32>(sContext.pendingRequests.size() + sContext.runningRequests.size());
+	}
+
+	void AsyncResourceLoader::Flush()
+	{
+		SG_PROFILE_FUNCTION();
+
+		while (!sContext.pendingRequests.empty() || !sContext.runningRequests.empty())
+		{
+			_DispatchPendingRequests(UInt32(-1));
+			for (auto* pRequest : sContext.runningRequests)
+				pRequest->handle.Complete();
+			DeliverFinishedRequests();
+		}
+	}
+
+}
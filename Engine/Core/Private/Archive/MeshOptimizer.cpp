@@ -0,0 +1,378 @@
+#include "StdAfx.h"
+#include "Archive/MeshOptimizer.h"
+
+#include "System/Logger.h"
+#include "Stl/Hash.h"
+#include "Profile/Profile.h"
+
+#include "Math/MathBasic.h"
+
+#include <EASTL/sort.h>
+
+namespace SG
+{
+
+	namespace // anonymous namespace
+	{
+
+		static constexpr UInt32 INVALID_INDEX = UInt32(-1);
+
+		//! FIFO post-transform cache, a vertex is in the cache if it is pushed in the last cacheSize misses.
+		class FIFOCache
+		{
+		public:
+			FIFOCache(UInt32 numVertices, UInt32 cacheSize)
+				: mTimestamps(numVertices, 0), mCacheSize(cacheSize), mTime(cacheSize + 1)
+			{}
+
+			//! @return If the vertex missed the cache.
+			bool Access(UInt32 vertex)
+			{
+				if (mTime - mTimestamps[vertex] <= mCacheSize)
+					return false;
+				mTimestamps[vertex] = mTime++;
+				return true;
+			}
+
+			UInt32 AccessTriangle(const UInt32* pTriangle)
+			{
+				return UInt32(Access(pTriangle[0])) + UInt32(Access(pTriangle[1])) + UInt32(Access(pTriangle[2]));
+			}
+
+			void Flush() { mTime += mCacheSize + 1; }
+		private:
+			vector<UInt32> mTimestamps;
+			UInt32 mCacheSize;
+			UInt32 mTime;
+		};
+
+		Vector3f _GetPosition(const vector<float>& vertices, UInt32 vertexFloatCount, UInt32 vertex)
+		{
+			const float* pVertex = vertices.data() + Size(vertex) * vertexFloatCount;
+			return Vector3f(pVertex[0], pVertex[1], pVertex[2]);
+		}
+
+	}
+
+	bool MeshOptimizer::Optimize(vector<float>& vertices, vector<UInt32>& indices, UInt32 vertexFloatCount,
+		MeshCacheStatistics* pOutBefore, MeshCacheStatistics* pOutAfter)
+	{
+		SG_PROFILE_FUNCTION();
+
+		// position(3) is needed to reorder for the overdraw
+		if (vertexFloatCount < 3 || vertices.size() % vertexFloatCount != 0 || indices.empty() || indices.size() % 3 != 0)
+			return false;
+		const UInt32 numVertices = UInt32(vertices.size() / vertexFloatCount);
+		for (auto index : indices)
+		{
+			if (index >= numVertices)
+			{
+				SG_LOG_WARN("Mesh index out of range: %d (%d vertices)", index, numVertices);
+				return false;
+			}
+		}
+
+		if (pOutBefore)
+			*pOutBefore = AnalyzeVertexCache(indices, numVertices);
+
+		DeduplicateVertices(vertices, indices, vertexFloatCount);
+		OptimizeVertexCache(indices, UInt32(vertices.size() / vertexFloatCount));
+		OptimizeOverdraw(indices, vertices, vertexFloatCount);
+		OptimizeVertexFetch(vertices, indices, vertexFloatCount);
+
+		if (pOutAfter)
+			*pOutAfter = AnalyzeVertexCache(indices, UInt32(vertices.size() / vertexFloatCount));
+		return true;
+	}
+
+	void MeshOptimizer::DeduplicateVertices(vector<float>& vertices, vector<UInt32>& indices, UInt32 vertexFloatCount)
+	{
+		SG_PROFILE_FUNCTION();
+
+		const UInt32 numVertices = UInt32(vertices.size() / vertexFloatCount);
+		const Size vertexSize = vertexFloatCount * sizeof(float);
+
+		// open addressing hash table of the unique vertices, which is at most half full
+		UInt32 tableSize = 16;
+		while (tableSize < numVertices * 2)
+			tableSize *= 2;
+		vector<UInt32> table(tableSize, INVALID_INDEX);
+
+		// the unique vertices are compacted to the front in place,
+		// a vertex is always moved to the front of itself, so the vertices not visited yet are never overwritten.
+		vector<UInt32> remap(numVertices);
+		UInt32 numUniqueVertices = 0;
+		for (UInt32 i = 0; i < numVertices; ++i)
+		{
+			const float* pVertex = vertices.data() + Size(i) * vertexFloatCount;
+			UInt32 slot = UInt32(HashMemory(pVertex, vertexSize)) & (tableSize - 1);
+			while (table[slot] != INVALID_INDEX && memcmp(vertices.data() + Size(table[slot]) * vertexFloatCount, pVertex, vertexSize) != 0)
+				slot = (slot + 1) & (tableSize - 1);
+
+			if (table[slot] == INVALID_INDEX)
+			{
+				if (numUniqueVertices != i)
+					memcpy(vertices.data() + Size(numUniqueVertices) * vertexFloatCount, pVertex, vertexSize);
+				table[slot] = numUniqueVertices++;
+			}
+			remap[i] = table[slot];
+		}
+
+		for (auto& index : indices)
+			index = remap[index];
+		vertices.resize(Size(numUniqueVertices) * vertexFloatCount);
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(vector<UInt32>& indices, UInt32 numVertices, UInt32 cacheSize)
+	{
+		SG_PROFILE_FUNCTION();
+
+		const UInt32 numTriangles = UInt32(indices.size() / 3);
+
+		// vertex -> triangles adjacency
+		vector<UInt32> adjacencyOffsets(numVertices + 1, 0);
+		for (auto index : indices)
+			++adjacencyOffsets[index + 1];
+		for (UInt32 i = 0; i < numVertices; ++i)
+			adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+		vector<UInt32> adjacency(indices.size());
+		{
+			vector<UInt32> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (UInt32 i = 0; i < UInt32(indices.size()); ++i)
+				adjacency[cursors[indices[i]]++] = i / 3;
+		}
+
+		vector<UInt32> liveTriangles(numVertices);
+		for (UInt32 i = 0; i < numVertices; ++i)
+			liveTriangles[i] = adjacencyOffsets[i + 1] - adjacencyOffsets[i];
+
+		vector<UInt32> cacheTimestamps(numVertices, 0);
+		UInt32 time = cacheSize + 1;
+		vector<bool> emitted(numTriangles, false);
+		vector<UInt32> deadEndStack;
+		vector<UInt32> candidates;
+		UInt32 cursor = 0;
+
+		// the vertices which still have live triangles, recently used ones first, then in the input order
+		auto skipDeadEnd = [&]() -> UInt32
+		{
+			while (!deadEndStack.empty())
+			{
+				const UInt32 vertex = deadEndStack.back();
+				deadEndStack.pop_back();
+				if (liveTriangles[vertex] > 0)
+					return vertex;
+			}
+			for (; cursor < numVertices; ++cursor)
+			{
+				if (liveTriangles[cursor] > 0)
+					return cursor;
+			}
+			return INVALID_INDEX;
+		};
+
+		vector<UInt32> output;
+		output.reserve(indices.size());
+		UInt32 fanning = skipDeadEnd();
+		while (fanning != INVALID_INDEX)
+		{
+			// emit all the live triangles around the fanning vertex
+			candidates.clear();
+			for (UInt32 i = adjacencyOffsets[fanning]; i < adjacencyOffsets[fanning + 1]; ++i)
+			{
+				const UInt32 triangle = adjacency[i];
+				if (emitted[triangle])
+					continue;
+				for (UInt32 j = 0; j < 3; ++j)
+				{
+					const UInt32 vertex = indices[triangle * 3 + j];
+					output.push_back(vertex);
+					deadEndStack.push_back(vertex);
+					candidates.push_back(vertex);
+					--liveTriangles[vertex];
+					if (time - cacheTimestamps[vertex] > cacheSize)
+						cacheTimestamps[vertex] = time++;
+				}
+				emitted[triangle] = true;
+			}
+
+			// prefer the oldest candidate which will still be in the cache after all its triangles are emitted
+			UInt32 next = INVALID_INDEX;
+			Int32 bestPriority = -1;
+			for (auto vertex : candidates)
+			{
+				if (liveTriangles[vertex] == 0)
+					continue;
+				Int32 priority = 0;
+				if (time - cacheTimestamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+					priority = Int32(time - cacheTimestamps[vertex]);
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					next = vertex;
+				}
+			}
+			fanning = next != INVALID_INDEX ? next : skipDeadEnd();
+		}
+
+		SG_ASSERT(output.size() == indices.size());
+		indices.swap(output);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(vector<UInt32>& indices, const vector<float>& vertices, UInt32 vertexFloatCount, float threshold, UInt32 cacheSize)
+	{
+		SG_PROFILE_FUNCTION();
+
+		const UInt32 numVertices = UInt32(vertices.size() / vertexFloatCount);
+		const UInt32 numTriangles = UInt32(indices.size() / 3);
+		if (numTriangles == 0)
+			return;
+
+		// hard boundaries: the triangles which miss the cache with all the vertices, the cache is already cold there.
+		vector<UInt32> hardClusters;
+		{
+			FIFOCache cache(numVertices, cacheSize);
+			for (UInt32 i = 0; i < numTriangles; ++i)
+			{
+				if (cache.AccessTriangle(&indices[i * 3]) == 3 || i == 0)
+					hardClusters.push_back(i);
+			}
+			hardClusters.push_back(numTriangles);
+		}
+
+		// soft boundaries: split the hard clusters as soon as the ACMR of the split is close to the ACMR of the whole cluster.
+		vector<UInt32> clusters;
+		{
+			FIFOCache cache(numVertices, cacheSize);
+			for (Size c = 0; c + 1 < hardClusters.size(); ++c)
+			{
+				const UInt32 begin = hardClusters[c];
+				const UInt32 end = hardClusters[c + 1];
+
+				cache.Flush();
+				UInt32 clusterMisses = 0;
+				for (UInt32 i = begin; i < end; ++i)
+					clusterMisses += cache.AccessTriangle(&indices[i * 3]);
+				const float clusterAcmr = float(clusterMisses) / float(end - begin);
+
+				cache.Flush();
+				clusters.push_back(begin);
+				UInt32 start = begin;
+				UInt32 misses = 0;
+				for (UInt32 i = begin; i < end; ++i)
+				{
+					misses += cache.AccessTriangle(&indices[i * 3]);
+					if (i + 1 < end && float(misses) <= threshold * clusterAcmr * float(i + 1 - start))
+					{
+						clusters.push_back(i + 1);
+						start = i + 1;
+						misses = 0;
+						cache.Flush();
+					}
+				}
+			}
+			clusters.push_back(numTriangles);
+		}
+
+		// sort the clusters from the outside in, the ones facing outwards far from the center are likely to occlude the others.
+		const UInt32 numClusters = UInt32(clusters.size() - 1);
+		vector<Vector3f> clusterCentroids(numClusters, Vector3f(0.0f));
+		vector<Vector3f> clusterNormals(numClusters, Vector3f(0.0f));
+		vector<float>    clusterAreas(numClusters, 0.0f);
+		Vector3f meshCentroid(0.0f);
+		float meshArea = 0.0f;
+		for (UInt32 c = 0; c < numClusters; ++c)
+		{
+			for (UInt32 i = clusters[c]; i < clusters[c + 1]; ++i)
+			{
+				const Vector3f p0 = _GetPosition(vertices, vertexFloatCount, indices[i * 3]);
+				const Vector3f p1 = _GetPosition(vertices, vertexFloatCount, indices[i * 3 + 1]);
+				const Vector3f p2 = _GetPosition(vertices, vertexFloatCount, indices[i * 3 + 2]);
+				const Vector3f normal = glm::cross(p1 - p0, p2 - p0); // area weighted
+				const float area = glm::length(normal);
+				const Vector3f centroid = (p0 + p1 + p2) / 3.0f;
+
+				clusterNormals[c] += normal;
+				clusterCentroids[c] += centroid * area;
+				clusterAreas[c] += area;
+				meshCentroid += centroid * area;
+				meshArea += area;
+			}
+		}
+		if (meshArea > 0.0f)
+			meshCentroid /= meshArea;
+
+		vector<eastl::pair<float, UInt32>> sortKeys(numClusters);
+		for (UInt32 c = 0; c < numClusters; ++c)
+		{
+			float key = 0.0f;
+			const float normalLength = glm::length(clusterNormals[c]);
+			if (clusterAreas[c] > 0.0f && normalLength > 0.0f)
+				key = glm::dot(clusterCentroids[c] / clusterAreas[c] - meshCentroid, clusterNormals[c] / normalLength);
+			sortKeys[c] = { key, c };
+		}
+		eastl::sort(sortKeys.begin(), sortKeys.end(), [](const auto& lhs, const auto& rhs)
+			{ return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second; });
+
+		vector<UInt32> output;
+		output.reserve(indices.size());
+		for (const auto& sortKey : sortKeys)
+		{
+			const UInt32 c = sortKey.second;
+			output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+		}
+		indices.swap(output);
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(vector<float>& vertices, vector<UInt32>& indices, UInt32 vertexFloatCount)
+	{
+		SG_PROFILE_FUNCTION();
+
+		const UInt32 numVertices = UInt32(vertices.size() / vertexFloatCount);
+		const Size vertexSize = vertexFloatCount * sizeof(float);
+
+		vector<UInt32> remap(numVertices, INVALID_INDEX);
+		vector<float> output(vertices.size());
+		UInt32 numFetchedVertices = 0;
+		for (auto& index : indices)
+		{
+			if (remap[index] == INVALID_INDEX)
+			{
+				memcpy(output.data() + Size(numFetchedVertices) * vertexFloatCount, vertices.data() + Size(index) * vertexFloatCount, vertexSize);
+				remap[index] = numFetchedVertices++;
+			}
+			index = remap[index];
+		}
+		output.resize(Size(numFetchedVertices) * vertexFloatCount);
+		vertices.swap(output);
+	}
+
+	MeshCacheStatistics MeshOptimizer::AnalyzeVertexCache(const vector<UInt32>& indices, UInt32 numVertices, UInt32 cacheSize)
+	{
+		SG_PROFILE_FUNCTION();
+
+		MeshCacheStatistics statistics;
+		statistics.numTriangles = UInt32(indices.size() / 3);
+
+		FIFOCache cache(numVertices, cacheSize);
+		vector<bool> referenced(numVertices, false);
+		for (UInt32 i = 0; i < statistics.numTriangles * 3; ++i)
+		{
+			const UInt32 index = indices[i];
+			SG_ASSERT(index < numVertices);
+			statistics.numCacheMisses += UInt32(cache.Access(index));
+			if (!referenced[index])
+			{
+				referenced[index] = true;
+				++statistics.numVertices;
+			}
+		}
+
+		if (statistics.numTriangles > 0)
+			statistics.acmr = float(statistics.numCacheMisses) / float(statistics.numTriangles);
+		if (statistics.numVertices > 0)
+			statistics.atvr = float(statistics.numCacheMisses) / float(statistics.numVertices);
+		return statistics;
+	}
+
+}
\ No newline at end of file
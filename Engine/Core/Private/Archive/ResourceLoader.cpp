@@ -6,6 +6,8 @@
 #include "Asset/Asset.h"
 #include "Archive/TextureAssetArchive.h"
 #include "Archive/MaterialAssetArchive.h"
+#include "Archive/MeshOptimizer.h"
+#include "Platform/MappedFile.h"
 
 // redefine memory allocation for stb_image.h
 //#define STBI_MALLOC(sz)        Malloc(sz)
@@ -30,11 +32,12 @@
 #include "ktx/ktxvulkan.h"
 
 #include "Stl/string.h"
+#include "Stl/Hash.h"
 #include "Profile/Profile.h"
 
 #include "Math/MathBasic.h"
 
-#include "eastl/array.h"
+#include "EASTL/array.h"
 
 namespace SG
 {
@@ -132,10 +135,26 @@ namespace SG
 		string path = FileSystem::GetResourceFolderPath(EResourceDirectory::eMeshes, SG_ENGINE_DEBUG_BASE_OFFSET);
 		path += fullName;
 
+		// the embedded textures are not cooked, so the meshes with embedded materials have to be imported by assimp.
+		const bool bUseCookedFile = !SG_HAS_ENUM_FLAG(flag, ELoadMeshFlag::efLoadEmbeddedMaterials);
+		const string cookedName = fullName + SG_COOKED_MESH_EXTENSION;
+		UInt64 sourceHash = 0;
+		if (bUseCookedFile)
+		{
+			MappedFile sourceFile;
+			if (!sourceFile.Open(path.c_str()))
+			{
+				SG_LOG_ERROR("Failed to open mesh: %s", path.c_str());
+				return false;
+			}
+			sourceHash = HashMemory(sourceFile.GetData(), sourceFile.GetSize());
+
+			if (LoadFromCookedFile(path + SG_COOKED_MESH_EXTENSION, sourceHash, meshData))
+				return true;
+		}
+
 		Assimp::Importer importer;
 		UInt32 assimpFlag = aiProcess_CalcTangentSpace | aiProcess_RemoveRedundantMaterials;
-		if (SG_HAS_ENUM_FLAG(flag, ELoadMeshFlag::efGenerateAABB))
-			assimpFlag |= aiProcess_GenBoundingBoxes;
 		auto* scene = importer.ReadFile(path.c_str(), assimpFlag);
 
 		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
@@ -261,66 +280,63 @@ namespace SG
 
 				const aiMesh* pMesh = scene->mMeshes[i];
 				subMesh.subMeshName = pMesh->mName.C_Str();
-				if (SG_HAS_ENUM_FLAG(flag, ELoadMeshFlag::efGenerateAABB))
-				{
-					auto& aabb = pMesh->mAABB;
-					subMesh.aabb.min = { aabb.mMin.x, aabb.mMin.y, aabb.mMin.z };
-					subMesh.aabb.max = { aabb.mMax.x, aabb.mMax.y, aabb.mMax.z };
-				}
 				SG_LOG_DEBUG("    Loading submesh: %s", subMesh.subMeshName.c_str());
 
 				SG_ASSERT(pMesh->HasNormals());
 
+				// interleaved vertex: position(3), normal(3), uv(2), tangent(3)
 				const UInt32 meshNumVertices = pMesh->mNumVertices;
+				const bool bHaveUV = pMesh->HasTextureCoords(0); // default: uv channel 0 is for texture mapping
+				const bool bHaveTangent = pMesh->HasTangentsAndBitangents();
 				auto& vertices = subMesh.vertices;
+				vertices.resize(meshNumVertices * SG_MESH_VERTEX_FLOAT_COUNT);
+				AABBReset(subMesh.aabb);
+				float* pVertex = vertices.data();
 				for (UInt32 index = 0; index < meshNumVertices; ++index)
 				{
 					const aiVector3D& vertexPos = pMesh->mVertices[index];
-					vertices.emplace_back(vertexPos.x);
-					vertices.emplace_back(vertexPos.y);
-					vertices.emplace_back(vertexPos.z);
+					pVertex[0] = vertexPos.x;
+					pVertex[1] = vertexPos.y;
+					pVertex[2] = vertexPos.z;
+					subMesh.aabb.min = glm::min(subMesh.aabb.min, Vector3f(vertexPos.x, vertexPos.y, vertexPos.z));
+					subMesh.aabb.max = glm::max(subMesh.aabb.max, Vector3f(vertexPos.x, vertexPos.y, vertexPos.z));
 
 					const aiVector3D& vertexNormal = pMesh->mNormals[index];
-					vertices.emplace_back(vertexNormal.x);
-					vertices.emplace_back(vertexNormal.y);
-					vertices.emplace_back(vertexNormal.z);
+					pVertex[3] = vertexNormal.x;
+					pVertex[4] = vertexNormal.y;
+					pVertex[5] = vertexNormal.z;
 
-					if (pMesh->HasTextureCoords(0)) // default: uv channel 0 is for texture mapping
-					{
-						const aiVector3D& vertexUV = pMesh->mTextureCoords[0][index];
-						vertices.emplace_back(vertexUV.x);
-						vertices.emplace_back(vertexUV.y);
-					}
-					else
-					{
-						vertices.emplace_back(0.0f);
-						vertices.emplace_back(0.0f);
-					}
+					const aiVector3D vertexUV = bHaveUV ? pMesh->mTextureCoords[0][index] : aiVector3D(0.0f);
+					pVertex[6] = vertexUV.x;
+					pVertex[7] = vertexUV.y;
 
-					if (pMesh->HasTangentsAndBitangents())
-					{
-						const aiVector3D& vertexTangent = pMesh->mTangents[index];
-						vertices.emplace_back(vertexTangent.x);
-						vertices.emplace_back(vertexTangent.y);
-						vertices.emplace_back(vertexTangent.z);
-					}
-					else
-					{
-						vertices.emplace_back(0.0f);
-						vertices.emplace_back(0.0f);
-						vertices.emplace_back(0.0f);
-					}
+					const aiVector3D vertexTangent = bHaveTangent ? pMesh->mTangents[index] : aiVector3D(0.0f);
+					pVertex[8] = vertexTangent.x;
+					pVertex[9] = vertexTangent.y;
+					pVertex[10] = vertexTangent.z;
+
+					pVertex += SG_MESH_VERTEX_FLOAT_COUNT;
 				}
 
 				auto& indices = subMesh.indices;
+				indices.reserve(pMesh->mNumFaces * 3);
 				for (UInt32 index = 0; index < pMesh->mNumFaces; ++index)
 				{
 					const aiFace& pFace = pMesh->mFaces[index];
-					for (UInt32 j = 0; j < pFace.mNumIndices; ++j)
-					{
-						indices.emplace_back(pFace.mIndices[j]);
-					}
+					indices.insert(indices.end(), pFace.mIndices, pFace.mIndices + pFace.mNumIndices);
+				}
+
+				// the faces are not triangulated on import, a mesh mixing points, lines and polygons can still have a multiple of 3 indices.
+				MeshCacheStatistics before, after;
+				if (pMesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE)
+					SG_LOG_WARN("    Mesh is not a triangle list, not optimized: %s", subMesh.subMeshName.c_str());
+				else if (MeshOptimizer::Optimize(vertices, indices, SG_MESH_VERTEX_FLOAT_COUNT, &before, &after))
+				{
+					SG_LOG_DEBUG("    Optimized: vertices %d -> %d, vertex shader invocations %d -> %d", before.numVertices, after.numVertices, before.numCacheMisses, after.numCacheMisses);
+					SG_LOG_DEBUG("    ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f", before.acmr, after.acmr, before.atvr, after.atvr);
 				}
+				else
+					SG_LOG_WARN("    Mesh is not optimized: %s", subMesh.subMeshName.c_str());
 
 				SG_LOG_DEBUG("    Mesh Verticies: %d", vertices.size());
 				SG_LOG_DEBUG("    Mesh Indices  : %d", indices.size());
@@ -329,7 +345,169 @@ namespace SG
 		else
 			SG_LOG_WARN("Empty Mesh: %s", name);
 
+		if (bUseCookedFile && !meshData.subMeshDatas.empty() && !SG_HAS_ENUM_FLAG(flag, ELoadMeshFlag::efNoCookedFileWrite))
+			WriteCookedFile(cookedName, sourceHash, meshData);
 		return true;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// Cooked mesh
+	////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	namespace // anonymous namespace
+	{
+
+		//! Layout:
+		//!   CookedMeshHeader
+		//!   CookedSubMesh[numSubMeshes]
+		//!   vertices and indices of all the sub meshes (4 bytes aligned)
+		//!   string table (null-terminated sub mesh names)
+		//! All the offsets are from the start of the file.
+		struct CookedMeshHeader
+		{
+			UInt32 magic;
+			UInt32 version;
+			UInt64 sourceHash;
+			UInt64 fileSize;
+			UInt32 numSubMeshes;
+			UInt32 vertexFloatCount;  //!< Floats per vertex.
+			UInt64 stringTableOffset;
+			UInt64 stringTableSize;
+		};
+
+		struct CookedSubMesh
+		{
+			UInt64 verticesOffset;
+			UInt64 numVertexFloats;
+			UInt64 indicesOffset;
+			UInt64 numIndices;
+			UInt32 name;              //!< Offset in the string table.
+			UInt32 padding;
+			AABB   aabb;
+		};
+
+		enum : UInt32
+		{
+			SG_COOKED_MESH_MAGIC = 0x434d4753, // 'SGMC'
+			SG_COOKED_MESH_VERSION = 2, // 2: the meshes are optimized by the MeshOptimizer
+		};
+
+	}
+
+	bool MeshResourceLoader::LoadFromCookedFile(const string& cookedPath, UInt64 sourceHash, MeshData& meshData)
+	{
+		SG_PROFILE_FUNCTION();
+
+		MappedFile cookedFile;
+		if (!cookedFile.Open(cookedPath.c_str()))
+			return false;
+
+		const Byte* pData = cookedFile.GetData();
+		const UInt64 fileSize = cookedFile.GetSize();
+		if (fileSize < sizeof(CookedMeshHeader))
+			return false;
+
+		const auto* pHeader = reinterpret_cast<const CookedMeshHeader*>(pData);
+		if (pHeader->magic != SG_COOKED_MESH_MAGIC || pHeader->version != SG_COOKED_MESH_VERSION ||
+			pHeader->vertexFloatCount != SG_MESH_VERTEX_FLOAT_COUNT || pHeader->fileSize != fileSize)
+			return false;
+		if (pHeader->sourceHash != sourceHash) // the source file had been modified
+		{
+			SG_LOG_DEBUG("Cooked mesh is out of date: %s", cookedPath.c_str());
+			return false;
+		}
+
+		const UInt64 subMeshTableEnd = sizeof(CookedMeshHeader) + (UInt64)pHeader->numSubMeshes * sizeof(CookedSubMesh);
+		if (subMeshTableEnd > fileSize || pHeader->stringTableSize == 0 ||
+			pHeader->stringTableOffset > fileSize || pHeader->stringTableSize > fileSize - pHeader->stringTableOffset)
+			return false;
+		const char* pStringTable = reinterpret_cast<const char*>(pData + pHeader->stringTableOffset);
+		if (pStringTable[pHeader->stringTableSize - 1] != '\0')
+			return false;
+
+		// validate all the sub meshes before touching the mesh data
+		const auto* pSubMeshes = reinterpret_cast<const CookedSubMesh*>(pData + sizeof(CookedMeshHeader));
+		for (UInt32 i = 0; i < pHeader->numSubMeshes; ++i)
+		{
+			const auto& cooked = pSubMeshes[i];
+			if (cooked.name >= pHeader->stringTableSize ||
+				cooked.verticesOffset % 4 != 0 || cooked.indicesOffset % 4 != 0 ||
+				cooked.numVertexFloats > fileSize / sizeof(float) || cooked.numIndices > fileSize / sizeof(UInt32) ||
+				cooked.verticesOffset > fileSize - cooked.numVertexFloats * sizeof(float) ||
+				cooked.indicesOffset > fileSize - cooked.numIndices * sizeof(UInt32))
+				return false;
+		}
+
+		for (UInt32 i = 0; i < pHeader->numSubMeshes; ++i)
+		{
+			const auto& cooked = pSubMeshes[i];
+			auto& subMesh = meshData.subMeshDatas.emplace_back();
+			subMesh.filename = meshData.filename;
+			subMesh.bIsProceduralMesh = false;
+			subMesh.subMeshName = pStringTable + cooked.name;
+			subMesh.aabb = cooked.aabb;
+
+			const float* pVertices = reinterpret_cast<const float*>(pData + cooked.verticesOffset);
+			subMesh.vertices.assign(pVertices, pVertices + cooked.numVertexFloats);
+			const UInt32* pIndices = reinterpret_cast<const UInt32*>(pData + cooked.indicesOffset);
+			subMesh.indices.assign(pIndices, pIndices + cooked.numIndices);
+		}
+
+		SG_LOG_DEBUG("Load cooked mesh: %s (%d sub meshes)", cookedPath.c_str(), pHeader->numSubMeshes);
+		return true;
+	}
+
+	void MeshResourceLoader::WriteCookedFile(const string& cookedName, UInt64 sourceHash, const MeshData& meshData)
+	{
+		SG_PROFILE_FUNCTION();
+
+		const UInt32 numSubMeshes = (UInt32)meshData.subMeshDatas.size();
+
+		// layout the file
+		vector<CookedSubMesh> cookedSubMeshes(numSubMeshes);
+		vector<char> stringTable;
+		UInt64 offset = sizeof(CookedMeshHeader) + numSubMeshes * sizeof(CookedSubMesh);
+		for (UInt32 i = 0; i < numSubMeshes; ++i)
+		{
+			const auto& subMesh = meshData.subMeshDatas[i];
+			auto& cooked = cookedSubMeshes[i];
+			cooked = {};
+			cooked.verticesOffset = offset;
+			cooked.numVertexFloats = subMesh.vertices.size();
+			offset += subMesh.vertices.size() * sizeof(float);
+			cooked.indicesOffset = offset;
+			cooked.numIndices = subMesh.indices.size();
+			offset += subMesh.indices.size() * sizeof(UInt32);
+			cooked.name = (UInt32)stringTable.size();
+			cooked.aabb = subMesh.aabb;
+			stringTable.insert(stringTable.end(), subMesh.subMeshName.c_str(), subMesh.subMeshName.c_str() + subMesh.subMeshName.size() + 1);
+		}
+
+		CookedMeshHeader header = {};
+		header.magic = SG_COOKED_MESH_MAGIC;
+		header.version = SG_COOKED_MESH_VERSION;
+		header.sourceHash = sourceHash;
+		header.numSubMeshes = numSubMeshes;
+		header.vertexFloatCount = SG_MESH_VERTEX_FLOAT_COUNT;
+		header.stringTableOffset = offset;
+		header.stringTableSize = stringTable.size();
+		header.fileSize = offset + stringTable.size();
+
+		if (!FileSystem::Open(EResourceDirectory::eMeshes, cookedName.c_str(), EFileMode::efWrite_Binary, SG_ENGINE_DEBUG_BASE_OFFSET))
+		{
+			SG_LOG_WARN("Failed to write cooked mesh: %s", cookedName.c_str());
+			return;
+		}
+
+		FileSystem::Write(&header, sizeof(CookedMeshHeader));
+		FileSystem::Write(cookedSubMeshes.data(), numSubMeshes * sizeof(CookedSubMesh));
+		for (const auto& subMesh : meshData.subMeshDatas)
+		{
+			FileSystem::Write(subMesh.vertices.data(), subMesh.vertices.size() * sizeof(float));
+			FileSystem::Write(subMesh.indices.data(), subMesh.indices.size() * sizeof(UInt32));
+		}
+		FileSystem::Write(stringTable.data(), stringTable.size());
+		FileSystem::Close();
+	}
+
 }
\ No newline at end of file
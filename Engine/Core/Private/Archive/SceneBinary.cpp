@@ -0,0 +1,480 @@
+#include "StdAfx.h"
+#include "Archive/SceneBinary.h"
+
+#include "System/Logger.h"
+#include "Profile/Profile.h"
+
+#include "Stl/string.h"
+#include "Stl/Hash.h"
+#include "Stl/unordered_map.h"
+
+#include <string.h>
+
+namespace SG
+{
+
+	static const char* gSceneBinaryTextureNames[(UInt32)ESceneBinaryTexture::NUM_TEXTURES] =
+	{
+		"AlbedoTextureAsset",
+		"MetallicTextureAsset",
+		"RoughnessTextureAsset",
+		"NormalTextureAsset",
+		"AOTextureAsset",
+	};
+
+	static const UInt32 gSceneBinaryBlockSizes[(UInt32)ESceneBinaryBlock::NUM_BLOCKS] =
+	{
+		sizeof(SceneBinaryMesh),
+		sizeof(SceneBinaryMaterial),
+		sizeof(SceneBinaryPointLight),
+		sizeof(SceneBinaryDirectionalLight),
+		sizeof(SceneBinaryCamera),
+	};
+
+	static UInt64 _CalcChecksum(const Byte* pData, Size sizeInByte)
+	{
+		SceneBinaryHeader header = *reinterpret_cast<const SceneBinaryHeader*>(pData);
+		header.checksum = 0;
+		const UInt64 hash = HashMemory(&header, sizeof(SceneBinaryHeader));
+		return HashMemory(pData + sizeof(SceneBinaryHeader), sizeInByte - sizeof(SceneBinaryHeader), hash);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// SceneBinaryView
+	////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool SceneBinaryView::Init(const Byte* pData, Size sizeInByte)
+	{
+		SG_PROFILE_FUNCTION();
+
+		mpHeader = nullptr;
+		mpEntities = nullptr;
+		mpBlocks = nullptr;
+		mpStringTable = nullptr;
+
+		if (!pData || sizeInByte < sizeof(SceneBinaryHeader))
+			return false;
+
+		const auto* pHeader = reinterpret_cast<const SceneBinaryHeader*>(pData);
+		if (pHeader->magic != SG_SCENE_BINARY_MAGIC)
+		{
+			SG_LOG_ERROR("Not a binary scene!");
+			return false;
+		}
+		if (pHeader->version != SG_SCENE_BINARY_VERSION)
+		{
+			SG_LOG_WARN("Binary scene version mismatch (%u, expect %u)", pHeader->version, (UInt32)SG_SCENE_BINARY_VERSION);
+			return false;
+		}
+
+		// validate all the sections, use 64 bits to avoid overflow
+		const UInt64 fileSize = pHeader->fileSize;
+		const UInt64 entitiesEnd = (UInt64)pHeader->entitiesOffset + (UInt64)pHeader->numEntities * sizeof(SceneBinaryEntity);
+		const UInt64 blocksEnd = (UInt64)pHeader->blocksOffset + pHeader->blocksSize;
+		const UInt64 stringTableEnd = (UInt64)pHeader->stringTableOffset + pHeader->stringTableSize;
+		if (fileSize != sizeInByte || entitiesEnd > fileSize || blocksEnd > fileSize || stringTableEnd > fileSize ||
+			pHeader->stringTableSize == 0 || (pHeader->entitiesOffset % 4) != 0 || (pHeader->blocksOffset % 4) != 0)
+		{
+			SG_LOG_ERROR("Corrupted binary scene!");
+			return false;
+		}
+
+		if (pHeader->checksum != _CalcChecksum(pData, sizeInByte))
+		{
+			SG_LOG_ERROR("Corrupted binary scene! (checksum mismatch)");
+			return false;
+		}
+
+		const char* pStringTable = reinterpret_cast<const char*>(pData + pHeader->stringTableOffset);
+		// the table ends with '\0', so any offset inside it is a valid string
+		if (pStringTable[pHeader->stringTableSize - 1] != '\0')
+		{
+			SG_LOG_ERROR("Corrupted binary scene!");
+			return false;
+		}
+
+		auto checkString = [pHeader](UInt32 offset) { return offset < pHeader->stringTableSize; };
+
+		const auto* pEntities = reinterpret_cast<const SceneBinaryEntity*>(pData + pHeader->entitiesOffset);
+		const Byte* pBlocks = pData + pHeader->blocksOffset;
+		bool bValid = checkString(pHeader->sceneName);
+		for (UInt32 i = 0; i < pHeader->numEntities && bValid; ++i)
+		{
+			const auto& entity = pEntities[i];
+			bValid &= checkString(entity.name);
+			bValid &= (entity.parent == SG_SCENE_BINARY_INVALID || entity.parent < i); // parent first
+			for (UInt32 block = 0; block < (UInt32)ESceneBinaryBlock::NUM_BLOCKS; ++block)
+			{
+				if ((entity.blockMask & (1 << block)) == 0)
+					continue;
+				bValid &= ((UInt64)entity.blocks[block] + gSceneBinaryBlockSizes[block] <= pHeader->blocksSize) && (entity.blocks[block] % 4) == 0;
+			}
+			if (!bValid)
+				break;
+
+			if ((entity.blockMask & (1 << (UInt32)ESceneBinaryBlock::eMesh)) != 0)
+			{
+				const auto& mesh = *reinterpret_cast<const SceneBinaryMesh*>(pBlocks + entity.blocks[(UInt32)ESceneBinaryBlock::eMesh]);
+				bValid &= checkString(mesh.filename) && checkString(mesh.subMeshName);
+			}
+			if ((entity.blockMask & (1 << (UInt32)ESceneBinaryBlock::eMaterial)) != 0)
+			{
+				const auto& mat = *reinterpret_cast<const SceneBinaryMaterial*>(pBlocks + entity.blocks[(UInt32)ESceneBinaryBlock::eMaterial]);
+				bValid &= checkString(mat.assetName) && checkString(mat.filename);
+				for (UInt32 tex = 0; tex < (UInt32)ESceneBinaryTexture::NUM_TEXTURES; ++tex)
+				{
+					if ((mat.textureMask & (1 << tex)) != 0)
+						bValid &= checkString(mat.textures[tex].name) && checkString(mat.textures[tex].filename);
+				}
+			}
+		}
+
+		if (!bValid)
+		{
+			SG_LOG_ERROR("Corrupted binary scene!");
+			return false;
+		}
+
+		mpHeader = pHeader;
+		mpEntities = pEntities;
+		mpBlocks = pBlocks;
+		mpStringTable = pStringTable;
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// SceneBinary
+	////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+
+		class SceneBinaryWriter
+		{
+		public:
+			SceneBinaryWriter()
+			{
+				AddString(""); // offset 0 is always the empty string
+			}
+
+			UInt32 AddString(const string& str)
+			{
+				auto node = mStringOffsets.find(str);
+				if (node != mStringOffsets.end())
+					return node->second;
+
+				const UInt32 offset = (UInt32)mStringTable.size();
+				mStringTable.insert(mStringTable.end(), str.c_str(), str.c_str() + str.size() + 1);
+				mStringOffsets[str] = offset;
+				return offset;
+			}
+
+			template <typename T>
+			UInt32 AddBlock(const T& block)
+			{
+				SG_COMPILE_ASSERT(sizeof(T) % 4 == 0, "Binary scene blocks must keep 4 bytes alignment.");
+				const UInt32 offset = (UInt32)mBlocks.size();
+				mBlocks.resize(mBlocks.size() + sizeof(T));
+				memcpy(mBlocks.data() + offset, &block, sizeof(T));
+				return offset;
+			}
+
+			bool WriteEntity(const json& node, UInt32 parent);
+			void Finish(const string& sceneName, vector<Byte>& outData);
+		private:
+			vector<SceneBinaryEntity> mEntities;
+			vector<Byte>              mBlocks;
+			vector<char>              mStringTable;
+			unordered_map<string, UInt32> mStringOffsets;
+		};
+
+		string GetJsonString(const json& node)
+		{
+			return node.get<std::string>().c_str();
+		}
+
+		bool SceneBinaryWriter::WriteEntity(const json& node, UInt32 parent)
+		{
+			auto tagNode = node.find("TagComponent");
+			auto transNode = node.find("TransformComponent");
+			if (tagNode == node.end() || transNode == node.end())
+			{
+				SG_LOG_ERROR("Entity without TagComponent or TransformComponent!");
+				return false;
+			}
+
+			SceneBinaryEntity entity = {};
+			entity.name = AddString(GetJsonString((*tagNode)["Name"]));
+			entity.parent = parent;
+			(*transNode)["Position"].get_to(entity.position);
+			(*transNode)["Rotation"].get_to(entity.rotation);
+			(*transNode)["Scale"].get_to(entity.scale);
+
+			auto addBlock = [&entity](ESceneBinaryBlock block, UInt32 offset)
+			{
+				entity.blockMask |= (1 << (UInt32)block);
+				entity.blocks[(UInt32)block] = offset;
+			};
+
+			if (auto n = node.find("MeshComponent"); n != node.end())
+			{
+				auto& meshNode = *n;
+				SceneBinaryMesh mesh = {};
+				mesh.filename = AddString(GetJsonString(meshNode["Filename"]));
+				mesh.subMeshName = AddString(GetJsonString(meshNode["SubMeshName"]));
+				mesh.type = meshNode["Type"].get<UInt32>();
+				mesh.flags |= meshNode["IsProceduralMesh"].get<bool>() ? UInt32(SceneBinaryMesh::efProceduralMesh) : UInt32(0);
+				mesh.flags |= meshNode["HaveEmbeddedResource"].get<bool>() ? UInt32(SceneBinaryMesh::efEmbeddedResource) : UInt32(0);
+				if (auto aabbNode = meshNode.find("AABB"); aabbNode != meshNode.end())
+				{
+					aabbNode->get_to(mesh.aabb);
+					mesh.flags |= SceneBinaryMesh::efHaveAABB;
+				}
+				addBlock(ESceneBinaryBlock::eMesh, AddBlock(mesh));
+			}
+
+			if (auto n = node.find("MaterialComponent"); n != node.end())
+			{
+				auto& matNode = *n;
+				SceneBinaryMaterial mat = {};
+				mat.assetName = AddString(GetJsonString(matNode["AssetName"]));
+				mat.filename = AddString(GetJsonString(matNode["Filename"]));
+				matNode["Albedo"].get_to(mat.albedo);
+				matNode["Metallic"].get_to(mat.metallic);
+				matNode["Roughness"].get_to(mat.roughness);
+				for (UInt32 i = 0; i < (UInt32)ESceneBinaryTexture::NUM_TEXTURES; ++i)
+				{
+					auto texNode = matNode.find(gSceneBinaryTextureNames[i]);
+					if (texNode == matNode.end())
+						continue;
+
+					auto& tex = mat.textures[i];
+					tex.name = AddString(GetJsonString((*texNode)["Name"]));
+					tex.filename = AddString(GetJsonString((*texNode)["Filename"]));
+					tex.flags |= (*texNode)["NeedMipmap"].get<bool>() ? UInt32(SceneBinaryTexture::efNeedMipmap) : UInt32(0);
+					tex.flags |= (*texNode)["IsCubeMap"].get<bool>() ? UInt32(SceneBinaryTexture::efIsCubeMap) : UInt32(0);
+					mat.textureMask |= (1 << i);
+				}
+				addBlock(ESceneBinaryBlock::eMaterial, AddBlock(mat));
+			}
+
+			if (auto n = node.find("PointLightComponent"); n != node.end())
+			{
+				auto& lightNode = *n;
+				SceneBinaryPointLight light = {};
+				lightNode["Color"].get_to(light.color);
+				lightNode["Radius"].get_to(light.radius);
+				addBlock(ESceneBinaryBlock::ePointLight, AddBlock(light));
+			}
+
+			if (auto n = node.find("DirectionalLightComponent"); n != node.end())
+			{
+				auto& lightNode = *n;
+				SceneBinaryDirectionalLight light = {};
+				lightNode["Color"].get_to(light.color);
+				lightNode["ShadowMapScaleFactor"].get_to(light.shadowMapScaleFactor);
+				lightNode["zNear"].get_to(light.zNear);
+				lightNode["zFar"].get_to(light.zFar);
+				addBlock(ESceneBinaryBlock::eDirectionalLight, AddBlock(light));
+			}
+
+			if (auto n = node.find("CameraComponent"); n != node.end())
+			{
+				auto& camNode = *n;
+				SceneBinaryCamera cam = {};
+				camNode["CameraPos"].get_to(cam.position);
+				camNode["CameraMoveSpeed"].get_to(cam.moveSpeed);
+				if (camNode.find("FrontVector") != camNode.end())
+				{
+					camNode["UpVector"].get_to(cam.upVector);
+					camNode["RightVector"].get_to(cam.rightVector);
+					camNode["FrontVector"].get_to(cam.frontVector);
+					cam.flags |= SceneBinaryCamera::efHaveVectors;
+				}
+				addBlock(ESceneBinaryBlock::eCamera, AddBlock(cam));
+			}
+
+			const UInt32 index = (UInt32)mEntities.size();
+			mEntities.push_back(entity);
+
+			// children are written right after their parent
+			if (auto n = node.find("Children"); n != node.end() && n->is_array())
+			{
+				for (auto& child : *n)
+				{
+					if (!WriteEntity(child, index))
+						return false;
+				}
+			}
+			return true;
+		}
+
+		void SceneBinaryWriter::Finish(const string& sceneName, vector<Byte>& outData)
+		{
+			SceneBinaryHeader header = {};
+			header.magic = SG_SCENE_BINARY_MAGIC;
+			header.version = SG_SCENE_BINARY_VERSION;
+			header.sceneName = AddString(sceneName);
+			header.numEntities = (UInt32)mEntities.size();
+			header.entitiesOffset = sizeof(SceneBinaryHeader);
+			header.blocksOffset = header.entitiesOffset + header.numEntities * sizeof(SceneBinaryEntity);
+			header.blocksSize = (UInt32)mBlocks.size();
+			header.stringTableOffset = header.blocksOffset + header.blocksSize;
+			header.stringTableSize = (UInt32)mStringTable.size();
+			header.fileSize = header.stringTableOffset + header.stringTableSize;
+
+			outData.resize(header.fileSize);
+			Byte* pData = outData.data();
+			memcpy(pData, &header, sizeof(SceneBinaryHeader));
+			if (!mEntities.empty())
+				memcpy(pData + header.entitiesOffset, mEntities.data(), header.numEntities * sizeof(SceneBinaryEntity));
+			if (!mBlocks.empty())
+				memcpy(pData + header.blocksOffset, mBlocks.data(), header.blocksSize);
+			memcpy(pData + header.stringTableOffset, mStringTable.data(), header.stringTableSize);
+
+			const UInt64 checksum = _CalcChecksum(pData, header.fileSize);
+			memcpy(pData + offsetof(SceneBinaryHeader, checksum), &checksum, sizeof(UInt64));
+		}
+
+		void ReadEntity(const SceneBinaryView& view, UInt32 index, const vector<UInt32>& firstChilds, const vector<UInt32>& nextSiblings, json& node)
+		{
+			const auto& entity = view.GetEntity(index);
+			node["EntityID"] = "2468517968452275"; // TEMPORARY
+			node["TagComponent"]["Name"] = view.GetString(entity.name);
+
+			auto& transNode = node["TransformComponent"];
+			transNode["Position"] = entity.position;
+			transNode["Rotation"] = entity.rotation;
+			transNode["Scale"] = entity.scale;
+
+			if (view.HaveBlock(entity, ESceneBinaryBlock::eMesh))
+			{
+				const auto& mesh = view.GetBlock<SceneBinaryMesh>(entity, ESceneBinaryBlock::eMesh);
+				auto& meshNode = node["MeshComponent"];
+				meshNode["Filename"] = view.GetString(mesh.filename);
+				meshNode["SubMeshName"] = view.GetString(mesh.subMeshName);
+				meshNode["Type"] = mesh.type;
+				meshNode["IsProceduralMesh"] = (mesh.flags & SceneBinaryMesh::efProceduralMesh) != 0;
+				meshNode["HaveEmbeddedResource"] = (mesh.flags & SceneBinaryMesh::efEmbeddedResource) != 0;
+				if ((mesh.flags & SceneBinaryMesh::efHaveAABB) != 0)
+					meshNode["AABB"] = mesh.aabb;
+			}
+
+			if (view.HaveBlock(entity, ESceneBinaryBlock::eMaterial))
+			{
+				const auto& mat = view.GetBlock<SceneBinaryMaterial>(entity, ESceneBinaryBlock::eMaterial);
+				auto& matNode = node["MaterialComponent"];
+				matNode["AssetName"] = view.GetString(mat.assetName);
+				matNode["Filename"] = view.GetString(mat.filename);
+				matNode["Albedo"] = mat.albedo;
+				matNode["Metallic"] = mat.metallic;
+				matNode["Roughness"] = mat.roughness;
+				for (UInt32 i = 0; i < (UInt32)ESceneBinaryTexture::NUM_TEXTURES; ++i)
+				{
+					if ((mat.textureMask & (1 << i)) == 0)
+						continue;
+
+					const auto& tex = mat.textures[i];
+					auto& texNode = matNode[gSceneBinaryTextureNames[i]];
+					texNode["Name"] = view.GetString(tex.name);
+					texNode["Filename"] = view.GetString(tex.filename);
+					texNode["NeedMipmap"] = (tex.flags & SceneBinaryTexture::efNeedMipmap) != 0;
+					texNode["IsCubeMap"] = (tex.flags & SceneBinaryTexture::efIsCubeMap) != 0;
+				}
+			}
+
+			if (view.HaveBlock(entity, ESceneBinaryBlock::ePointLight))
+			{
+				const auto& light = view.GetBlock<SceneBinaryPointLight>(entity, ESceneBinaryBlock::ePointLight);
+				auto& lightNode = node["PointLightComponent"];
+				lightNode["Color"] = light.color;
+				lightNode["Radius"] = light.radius;
+			}
+
+			if (view.HaveBlock(entity, ESceneBinaryBlock::eDirectionalLight))
+			{
+				const auto& light = view.GetBlock<SceneBinaryDirectionalLight>(entity, ESceneBinaryBlock::eDirectionalLight);
+				auto& lightNode = node["DirectionalLightComponent"];
+				lightNode["Color"] = light.color;
+				lightNode["ShadowMapScaleFactor"] = light.shadowMapScaleFactor;
+				lightNode["zNear"] = light.zNear;
+				lightNode["zFar"] = light.zFar;
+			}
+
+			if (view.HaveBlock(entity, ESceneBinaryBlock::eCamera))
+			{
+				const auto& cam = view.GetBlock<SceneBinaryCamera>(entity, ESceneBinaryBlock::eCamera);
+				auto& camNode = node["CameraComponent"];
+				camNode["CameraPos"] = cam.position;
+				camNode["CameraMoveSpeed"] = cam.moveSpeed;
+				if ((cam.flags & SceneBinaryCamera::efHaveVectors) != 0)
+				{
+					camNode["UpVector"] = cam.upVector;
+					camNode["RightVector"] = cam.rightVector;
+					camNode["FrontVector"] = cam.frontVector;
+				}
+			}
+
+			if (firstChilds[index] != SG_SCENE_BINARY_INVALID)
+			{
+				auto& childrenNode = node["Children"];
+				childrenNode = json::array();
+				for (UInt32 child = firstChilds[index]; child != SG_SCENE_BINARY_INVALID; child = nextSiblings[child])
+					ReadEntity(view, child, firstChilds, nextSiblings, childrenNode.emplace_back());
+			}
+		}
+
+	}
+
+	bool SceneBinary::FromJson(const json& scene, vector<Byte>& outData)
+	{
+		SG_PROFILE_FUNCTION();
+
+		SceneBinaryWriter writer;
+		auto entities = scene.find("Entities");
+		if (entities != scene.end() && entities->is_array())
+		{
+			for (auto& entity : *entities)
+			{
+				if (!writer.WriteEntity(entity, SG_SCENE_BINARY_INVALID))
+					return false;
+			}
+		}
+
+		auto sceneName = scene.find("Scene");
+		writer.Finish(sceneName != scene.end() ? GetJsonString(*sceneName) : "", outData);
+		return true;
+	}
+
+	bool SceneBinary::ToJson(const Byte* pData, Size sizeInByte, json& outScene)
+	{
+		SG_PROFILE_FUNCTION();
+
+		SceneBinaryView view;
+		if (!view.Init(pData, sizeInByte))
+			return false;
+
+		// rebuild the child lists, the siblings keep the order in the file
+		const UInt32 numEntities = view.GetEntityCount();
+		vector<UInt32> firstChilds(numEntities + 1, SG_SCENE_BINARY_INVALID); // the last one is the root
+		vector<UInt32> lastChilds(numEntities + 1, SG_SCENE_BINARY_INVALID);
+		vector<UInt32> nextSiblings(numEntities, SG_SCENE_BINARY_INVALID);
+		for (UInt32 i = 0; i < numEntities; ++i)
+		{
+			const UInt32 parent = view.GetEntity(i).parent == SG_SCENE_BINARY_INVALID ? numEntities : view.GetEntity(i).parent;
+			if (lastChilds[parent] == SG_SCENE_BINARY_INVALID)
+				firstChilds[parent] = i;
+			else
+				nextSiblings[lastChilds[parent]] = i;
+			lastChilds[parent] = i;
+		}
+
+		outScene["Scene"] = view.GetSceneName();
+		auto& entities = outScene["Entities"];
+		entities = json::array();
+		for (UInt32 i = firstChilds[numEntities]; i != SG_SCENE_BINARY_INVALID; i = nextSiblings[i])
+			ReadEntity(view, i, firstChilds, nextSiblings, entities.emplace_back());
+		return true;
+	}
+
+}
@@ -1,17 +1,65 @@
 #include "StdAfx.h"
 #include "Archive/Serialization.h"
 
+#include "Archive/SceneBinary.h"
 #include "System/FileSystem.h"
 #include "Profile/Profile.h"
 
 namespace SG
 {
 
+	static bool _IsBinarySceneName(const string& sceneName)
+	{
+		const string extension = SG_SCENE_BINARY_EXTENSION;
+		return sceneName.size() > extension.size() &&
+			sceneName.compare(sceneName.size() - extension.size(), extension.size(), extension) == 0;
+	}
+
+	static string _ToBinarySceneName(const string& sceneName)
+	{
+		const Size dotPos = sceneName.find_last_of('.');
+		return (dotPos == string::npos ? sceneName : sceneName.substr(0, dotPos)) + SG_SCENE_BINARY_EXTENSION;
+	}
+
+	static bool _ReadBinaryScene(const char* sceneName, vector<Byte>& outData)
+	{
+		if (FileSystem::Open(EResourceDirectory::eScenes, sceneName, EFileMode::efRead_Binary, SG_ENGINE_DEBUG_BASE_OFFSET))
+		{
+			const Size sizeInByte = FileSystem::FileSize();
+			outData.resize(sizeInByte);
+			const Size readSize = FileSystem::Read(outData.data(), sizeInByte);
+			FileSystem::Close();
+			return readSize == sizeInByte;
+		}
+		return false;
+	}
+
+	static bool _WriteBinaryScene(const char* sceneName, const vector<Byte>& data)
+	{
+		if (FileSystem::Open(EResourceDirectory::eScenes, sceneName, EFileMode::efWrite_Binary, SG_ENGINE_DEBUG_BASE_OFFSET))
+		{
+			// a short write leaves a truncated scene, its checksum makes the next load reject it.
+			const Size writtenSize = FileSystem::Write(data.data(), data.size());
+			FileSystem::Close();
+			return writtenSize == data.size();
+		}
+		return false;
+	}
+
 	void Serializer::Serialize(RefPtr<Scene> pScene, const char* sceneName)
 	{
 		SG_PROFILE_FUNCTION();
 		SG_COMPILE_ASSERT(eastl::is_base_of<ISerializable, Scene>::value);
 
+		if (_IsBinarySceneName(sceneName))
+		{
+			vector<Byte> binary;
+			pScene->SerializeBinary(binary);
+			if (!_WriteBinaryScene(sceneName, binary))
+				SG_LOG_ERROR("Failed to save %s!", sceneName);
+			return;
+		}
+
 		ISerializable* pSerializable = pScene.get();
 
 		json newNode;
@@ -25,24 +73,77 @@ namespace SG
 		}
 	}
 
+	bool Serializer::ConvertToBinary(const char* jsonSceneName, const char* binarySceneName)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (!FileSystem::Exist(EResourceDirectory::eScenes, jsonSceneName, SG_ENGINE_DEBUG_BASE_OFFSET))
+		{
+			SG_LOG_ERROR("Failed to load %s!", jsonSceneName);
+			return false;
+		}
+
+		string jsonStr = FileSystem::ReadWholeFileAsText(EResourceDirectory::eScenes, jsonSceneName, SG_ENGINE_DEBUG_BASE_OFFSET);
+		auto node = json::parse(jsonStr.c_str());
+
+		vector<Byte> binary;
+		if (!SceneBinary::FromJson(node, binary) || !_WriteBinaryScene(binarySceneName, binary))
+		{
+			SG_LOG_ERROR("Failed to convert %s to %s!", jsonSceneName, binarySceneName);
+			return false;
+		}
+		return true;
+	}
+
 	void Deserializer::Deserialize(RefPtr<Scene> pScene, const char* sceneName)
 	{
 		SG_PROFILE_FUNCTION();
 		SG_COMPILE_ASSERT(eastl::is_base_of<ISerializable, Scene>::value);
 
-		if (FileSystem::Exist(EResourceDirectory::eScenes, sceneName, SG_ENGINE_DEBUG_BASE_OFFSET))
+		if (!FileSystem::Exist(EResourceDirectory::eScenes, sceneName, SG_ENGINE_DEBUG_BASE_OFFSET))
 		{
-			string jsonStr = FileSystem::ReadWholeFileAsText(EResourceDirectory::eScenes, sceneName, SG_ENGINE_DEBUG_BASE_OFFSET);
+			SG_LOG_ERROR("Failed to load %s!", sceneName);
+			return;
+		}
+
+		const bool bIsBinaryScene = _IsBinarySceneName(sceneName);
+		const string binarySceneName = bIsBinaryScene ? string(sceneName) : _ToBinarySceneName(sceneName);
+
+		// use the binary scene if it is not older than the json scene
+		bool bUseBinaryScene = bIsBinaryScene;
+		if (!bIsBinaryScene && FileSystem::Exist(EResourceDirectory::eScenes, binarySceneName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET))
+		{
+			TimePoint jsonTp = FileSystem::GetFileLastWriteTime(EResourceDirectory::eScenes, sceneName, SG_ENGINE_DEBUG_BASE_OFFSET);
+			TimePoint binaryTp = FileSystem::GetFileLastWriteTime(EResourceDirectory::eScenes, binarySceneName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET);
+			bUseBinaryScene = jsonTp.IsValid() && binaryTp.IsValid() && binaryTp >= jsonTp;
+		}
 
-			auto node = json::parse(jsonStr.c_str());
+		vector<Byte> binary;
+		if (bUseBinaryScene)
+		{
+			if (_ReadBinaryScene(binarySceneName.c_str(), binary) && pScene->DeserializeBinary(binary.data(), binary.size()))
+				return;
 
-			ISerializable* pSerializable = pScene.get();
-			pSerializable->Deserialize(node);
+			if (bIsBinaryScene)
+			{
+				SG_LOG_ERROR("Failed to load %s!", sceneName);
+				return;
+			}
+			SG_LOG_WARN("Binary scene %s is out of date, load from %s", binarySceneName.c_str(), sceneName);
+			binary.clear();
 		}
-		else
+
+		string jsonStr = FileSystem::ReadWholeFileAsText(EResourceDirectory::eScenes, sceneName, SG_ENGINE_DEBUG_BASE_OFFSET);
+		auto node = json::parse(jsonStr.c_str());
+
+		if (!SceneBinary::FromJson(node, binary) || !pScene->DeserializeBinary(binary.data(), binary.size()))
 		{
 			SG_LOG_ERROR("Failed to load %s!", sceneName);
+			return;
 		}
+
+		// cache the binary scene for the next load
+		_WriteBinaryScene(binarySceneName.c_str(), binary);
 	}
 
-}
\ No newline at end of file
+}
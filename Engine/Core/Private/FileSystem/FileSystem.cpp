@@ -4,6 +4,9 @@
 #ifdef SG_PLATFORM_WINDOWS
 #	include "Core/Private/Platform/Windows/StreamOp_Windows.h"
 #	include "Core/Private/Platform/Windows/FileInfo_Windows.h"
+#elif SG_PLATFORM_LINUX
+#	include "Core/Private/Platform/Linux/StreamOp_Linux.h"
+#	include "Core/Private/Platform/Linux/FileInfo_Linux.h"
 #endif
 #include "Memory/Memory.h"
 #include "Platform/OS.h"
@@ -11,8 +14,8 @@
 
 #include "Profile/Profile.h"
 
-#include "stl/string.h"
-#include "eastl/queue.h"
+#include "Stl/string.h"
+#include "EASTL/queue.h"
 #include <filesystem>
 
 namespace SG
@@ -43,6 +46,8 @@ namespace SG
 
 #ifdef SG_PLATFORM_WINDOWS
 		mpStreamOp = New(WindowsStreamOp);
+#elif SG_PLATFORM_LINUX
+		mpStreamOp = New(LinuxStreamOp);
 #endif
 		if (!mpStreamOp)
 			SG_ASSERT(false);
@@ -333,9 +338,7 @@ namespace SG
 
 		string path = GetResourceFolderPath(directory, baseOffset);
 		path += filename;
-#ifdef SG_PLATFORM_WINDOWS
 		return SG::GetFileCreateTime(path.c_str());
-#endif
 	}
 
 	TimePoint FileSystem::GetFileLastWriteTime(EResourceDirectory directory, const char* filename, UInt32 baseOffset)
@@ -344,9 +347,7 @@ namespace SG
 
 		string path = GetResourceFolderPath(directory, baseOffset);
 		path += filename;
-#ifdef SG_PLATFORM_WINDOWS
 		return SG::GetFileLastWriteTime(path.c_str());
-#endif
 	}
 
 	TimePoint FileSystem::GetFileLastReadTime(EResourceDirectory directory, const char* filename, UInt32 baseOffset)
@@ -355,9 +356,7 @@ namespace SG
 
 		string path = GetResourceFolderPath(directory, baseOffset);
 		path += filename;
-#ifdef SG_PLATFORM_WINDOWS
 		return SG::GetFileLastReadTime(path.c_str());
-#endif
 	}
 
 
@@ -49,6 +49,8 @@ namespace SG
 
 	bool Logger::NeedLogToConsole(ELogLevel logLevel)
 	{
+		if (mLogMode == ELogMode::eLog_Mode_Silent)
+			return false;
 		if (mLogMode == ELogMode::eLog_Mode_Quite || mLogMode == ELogMode::eLog_Mode_Quite_No_File)
 		{
 			if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Info | ELogLevel::efLog_Level_Debug))
@@ -119,12 +121,12 @@ namespace SG
 
 	int Logger::AddPrefix(char* pBuf)
 	{
-		return sprintf_s(pBuf, SG_MAX_TEMP_BUFFER_SIZE, "%s ", fmt::Formatter::GetFormattedString().c_str());
+		return snprintf(pBuf, SG_MAX_TEMP_BUFFER_SIZE, "%s ", fmt::Formatter::GetFormattedString().c_str());
 	}
 
 	int Logger::AddPrefix(char* pBuf, const char* file, int line)
 	{
-		return sprintf_s(pBuf, SG_MAX_TEMP_BUFFER_SIZE, "%s At file: %s, line: %d\nMessage: ", fmt::Formatter::GetFormattedString().c_str(),
+		return snprintf(pBuf, SG_MAX_TEMP_BUFFER_SIZE, "%s At file: %s, line: %d\nMessage: ", fmt::Formatter::GetFormattedString().c_str(),
 			file, line);
 	}
 
@@ -146,38 +148,52 @@ namespace SG
 		sFileLogOutCache.clear();
 	}
 
+	//! Colored console output: Windows console text attributes, ANSI escape sequences elsewhere.
+	static void _PrintColored(FILE* out, ELogLevel logLevel, const char* pBuffer)
+	{
+#ifdef SG_PLATFORM_WINDOWS
+		WORD attribute = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
+		if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Error | ELogLevel::efLog_Level_Criticle))
+			attribute = FOREGROUND_INTENSITY | FOREGROUND_RED;
+		else if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Warn))
+			attribute = FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN;
+		else if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Info))
+			attribute = FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
+		else if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Debug))
+			attribute = FOREGROUND_INTENSITY | FOREGROUND_GREEN | FOREGROUND_BLUE;
+
+		HANDLE handle = ::GetStdHandle(STD_OUTPUT_HANDLE);
+		::SetConsoleTextAttribute(handle, attribute);
+		fprintf(out, "%s", pBuffer);
+		::SetConsoleTextAttribute(handle, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+#else
+		const char* color = "\033[0m";
+		if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Error | ELogLevel::efLog_Level_Criticle))
+			color = "\033[1;31m";
+		else if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Warn))
+			color = "\033[1;33m";
+		else if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Info))
+			color = "\033[1;37m";
+		else if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Debug))
+			color = "\033[1;36m";
+
+		fprintf(out, "%s%s\033[0m", color, pBuffer);
+#endif
+	}
+
 	void Logger::LogToConsole(ELogLevel logLevel, char* pBuffer)
 	{
 		bool isError = SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Error | ELogLevel::efLog_Level_Criticle);
 		FILE* out = isError ? stderr : stdout;
-		HANDLE handle = ::GetStdHandle(STD_OUTPUT_HANDLE);
 
-		if (isError)
-		{
-			::SetConsoleTextAttribute(handle, FOREGROUND_INTENSITY | FOREGROUND_RED);
-			fprintf(out, "%s", pBuffer);
-			::SetConsoleTextAttribute(handle, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-		}
-		else if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Warn))
+		if (isError || SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Warn))
 		{
-			::SetConsoleTextAttribute(handle, FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN);
-			fprintf(out, "%s", pBuffer);
-			::SetConsoleTextAttribute(handle, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+			_PrintColored(out, logLevel, pBuffer);
 		}
 		else if (mLogMode == ELogMode::eLog_Mode_Default || mLogMode == ELogMode::eLog_Mode_No_File)
 		{
-			if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Info))
-			{
-				::SetConsoleTextAttribute(handle, FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-				fprintf(out, "%s", pBuffer);
-				::SetConsoleTextAttribute(handle, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-			}
-			else if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Debug))
-			{
-				::SetConsoleTextAttribute(handle, FOREGROUND_INTENSITY | FOREGROUND_GREEN | FOREGROUND_BLUE);
-				fprintf(out, "%s", pBuffer);
-				::SetConsoleTextAttribute(handle, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-			}
+			if (SG_HAS_ENUM_FLAG(logLevel, ELogLevel::efLog_Level_Info | ELogLevel::efLog_Level_Debug))
+				_PrintColored(out, logLevel, pBuffer);
 		}
 	}
 
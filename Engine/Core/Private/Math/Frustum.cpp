@@ -4,6 +4,38 @@
 namespace SG
 {
 
+	namespace // anonymous namespace
+	{
+		static Plane _NormalizedPlane(const Vector4f& data)
+		{
+			const float length = Sqrt(glm::dot(Vector3f(data), Vector3f(data)));
+			if (length == 0.0f) // degenerated matrix (e.g. not initialized yet), let this plane accept everything.
+				return Plane(Vector4f(0.0f, 0.0f, 0.0f, 1.0f));
+
+			Plane plane(data);
+			plane /= length;
+			return plane;
+		}
+	}
+
+	Frustum Frustum::FromViewProj(const Matrix4f& viewProj)
+	{
+		// fast way to build a frustum, the planes are the sums or the differences of the 4th row and the others.
+		const Vector4f row0 = { viewProj[0].x, viewProj[1].x, viewProj[2].x, viewProj[3].x };
+		const Vector4f row1 = { viewProj[0].y, viewProj[1].y, viewProj[2].y, viewProj[3].y };
+		const Vector4f row2 = { viewProj[0].z, viewProj[1].z, viewProj[2].z, viewProj[3].z };
+		const Vector4f row3 = { viewProj[0].w, viewProj[1].w, viewProj[2].w, viewProj[3].w };
+
+		return {
+			_NormalizedPlane(row3 - row2), // front
+			_NormalizedPlane(row3 + row2), // back
+			_NormalizedPlane(row3 - row0), // right
+			_NormalizedPlane(row3 + row0), // left
+			_NormalizedPlane(row3 - row1), // top
+			_NormalizedPlane(row3 + row1)  // bottom
+		};
+	}
+
 	Plane Frustum::GetFrontPlane() const
 	{
 		return mFrontPlane;
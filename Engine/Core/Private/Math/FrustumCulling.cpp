@@ -0,0 +1,374 @@
+#include "StdAfx.h"
+#include "Math/FrustumCulling.h"
+
+#include "Profile/Profile.h"
+
+#if SG_PLATFORM_AVX
+#	include <immintrin.h>
+#elif SG_PLATFORM_SSE2
+#	include <emmintrin.h>
+#endif
+
+namespace SG
+{
+
+	void AABBSoA::Resize(Size size)
+	{
+		centerX.resize(size);
+		centerY.resize(size);
+		centerZ.resize(size);
+		extentX.resize(size);
+		extentY.resize(size);
+		extentZ.resize(size);
+	}
+
+	void AABBSoA::Clear()
+	{
+		centerX.clear();
+		centerY.clear();
+		centerZ.clear();
+		extentX.clear();
+		extentY.clear();
+		extentZ.clear();
+	}
+
+	void AABBSoA::Set(Size index, const AABB& aabb)
+	{
+		const Vector3f center = AABBCenter(aabb);
+		const Vector3f extent = AABBExtent(aabb);
+		centerX[index] = center.x;
+		centerY[index] = center.y;
+		centerZ[index] = center.z;
+		extentX[index] = extent.x;
+		extentY[index] = extent.y;
+		extentZ[index] = extent.z;
+	}
+
+	void AABBSoA::PushBack(const AABB& aabb)
+	{
+		Resize(GetSize() + 1);
+		Set(GetSize() - 1, aabb);
+	}
+
+	void SphereSoA::Resize(Size size)
+	{
+		centerX.resize(size);
+		centerY.resize(size);
+		centerZ.resize(size);
+		radius.resize(size);
+	}
+
+	void SphereSoA::Clear()
+	{
+		centerX.clear();
+		centerY.clear();
+		centerZ.clear();
+		radius.clear();
+	}
+
+	void SphereSoA::Set(Size index, const Vector3f& center, float r)
+	{
+		centerX[index] = center.x;
+		centerY[index] = center.y;
+		centerZ[index] = center.z;
+		radius[index] = r;
+	}
+
+	void SphereSoA::PushBack(const Vector3f& center, float r)
+	{
+		Resize(GetSize() + 1);
+		Set(GetSize() - 1, center, r);
+	}
+
+	namespace // anonymous namespace
+	{
+		constexpr UInt32 NUM_FRUSTUM_PLANES = 6;
+
+		//! The planes of the frustum splatted into components, the absolute value of the normal is used by the box test.
+		struct FrustumPlanes
+		{
+			float nx[NUM_FRUSTUM_PLANES];
+			float ny[NUM_FRUSTUM_PLANES];
+			float nz[NUM_FRUSTUM_PLANES];
+			float w[NUM_FRUSTUM_PLANES];
+			float absNx[NUM_FRUSTUM_PLANES];
+			float absNy[NUM_FRUSTUM_PLANES];
+			float absNz[NUM_FRUSTUM_PLANES];
+		};
+
+		static FrustumPlanes _GetFrustumPlanes(const Frustum& frustum)
+		{
+			const Vector4f planes[NUM_FRUSTUM_PLANES] = {
+				frustum.GetFrontPlane(), frustum.GetBackPlane(),
+				frustum.GetRightPlane(), frustum.GetLeftPlane(),
+				frustum.GetTopPlane(), frustum.GetBottomPlane()
+			};
+
+			FrustumPlanes res;
+			for (UInt32 i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+			{
+				res.nx[i] = planes[i].x;
+				res.ny[i] = planes[i].y;
+				res.nz[i] = planes[i].z;
+				res.w[i] = planes[i].w;
+				res.absNx[i] = ::fabsf(planes[i].x);
+				res.absNy[i] = ::fabsf(planes[i].y);
+				res.absNz[i] = ::fabsf(planes[i].z);
+			}
+			return res;
+		}
+
+		// All the kernels below start at index and advance it to the first element they had not processed.
+		// A box is outside of a plane if the signed distance of its center plus its projected radius (dot(abs(n), extent)) is negative.
+
+#if SG_PLATFORM_AVX
+		static UInt32 _CullAABBs8(const FrustumPlanes& planes, const AABBSoA& boxes, Size& index, UInt8* pVisibility)
+		{
+			UInt32 numVisible = 0;
+			const __m256 zero = _mm256_setzero_ps();
+			for (; index + 8 <= boxes.GetSize(); index += 8)
+			{
+				const __m256 cx = _mm256_loadu_ps(boxes.centerX.data() + index);
+				const __m256 cy = _mm256_loadu_ps(boxes.centerY.data() + index);
+				const __m256 cz = _mm256_loadu_ps(boxes.centerZ.data() + index);
+				const __m256 ex = _mm256_loadu_ps(boxes.extentX.data() + index);
+				const __m256 ey = _mm256_loadu_ps(boxes.extentY.data() + index);
+				const __m256 ez = _mm256_loadu_ps(boxes.extentZ.data() + index);
+
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (UInt32 p = 0; p < NUM_FRUSTUM_PLANES; ++p)
+				{
+					__m256 dist = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(planes.nx[p])), _mm256_mul_ps(cy, _mm256_set1_ps(planes.ny[p])));
+					dist = _mm256_add_ps(dist, _mm256_mul_ps(cz, _mm256_set1_ps(planes.nz[p])));
+					dist = _mm256_add_ps(dist, _mm256_set1_ps(planes.w[p]));
+					__m256 radius = _mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(planes.absNx[p])), _mm256_mul_ps(ey, _mm256_set1_ps(planes.absNy[p])));
+					radius = _mm256_add_ps(radius, _mm256_mul_ps(ez, _mm256_set1_ps(planes.absNz[p])));
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(dist, radius), zero, _CMP_GE_OQ));
+				}
+
+				const int mask = _mm256_movemask_ps(inside);
+				for (UInt32 i = 0; i < 8; ++i)
+				{
+					const UInt8 bVisible = (mask >> i) & 1;
+					pVisibility[index + i] = bVisible;
+					numVisible += bVisible;
+				}
+			}
+			return numVisible;
+		}
+
+		static UInt32 _CullSpheres8(const FrustumPlanes& planes, const SphereSoA& spheres, Size& index, UInt8* pVisibility)
+		{
+			UInt32 numVisible = 0;
+			const __m256 zero = _mm256_setzero_ps();
+			for (; index + 8 <= spheres.GetSize(); index += 8)
+			{
+				const __m256 cx = _mm256_loadu_ps(spheres.centerX.data() + index);
+				const __m256 cy = _mm256_loadu_ps(spheres.centerY.data() + index);
+				const __m256 cz = _mm256_loadu_ps(spheres.centerZ.data() + index);
+				const __m256 r = _mm256_loadu_ps(spheres.radius.data() + index);
+
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (UInt32 p = 0; p < NUM_FRUSTUM_PLANES; ++p)
+				{
+					__m256 dist = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(planes.nx[p])), _mm256_mul_ps(cy, _mm256_set1_ps(planes.ny[p])));
+					dist = _mm256_add_ps(dist, _mm256_mul_ps(cz, _mm256_set1_ps(planes.nz[p])));
+					dist = _mm256_add_ps(dist, _mm256_set1_ps(planes.w[p]));
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(dist, r), zero, _CMP_GE_OQ));
+				}
+
+				const int mask = _mm256_movemask_ps(inside);
+				for (UInt32 i = 0; i < 8; ++i)
+				{
+					const UInt8 bVisible = (mask >> i) & 1;
+					pVisibility[index + i] = bVisible;
+					numVisible += bVisible;
+				}
+			}
+			return numVisible;
+		}
+#endif
+
+#if SG_PLATFORM_SSE2
+		static UInt32 _CullAABBs4(const FrustumPlanes& planes, const AABBSoA& boxes, Size& index, UInt8* pVisibility)
+		{
+			UInt32 numVisible = 0;
+			const __m128 zero = _mm_setzero_ps();
+			for (; index + 4 <= boxes.GetSize(); index += 4)
+			{
+				const __m128 cx = _mm_loadu_ps(boxes.centerX.data() + index);
+				const __m128 cy = _mm_loadu_ps(boxes.centerY.data() + index);
+				const __m128 cz = _mm_loadu_ps(boxes.centerZ.data() + index);
+				const __m128 ex = _mm_loadu_ps(boxes.extentX.data() + index);
+				const __m128 ey = _mm_loadu_ps(boxes.extentY.data() + index);
+				const __m128 ez = _mm_loadu_ps(boxes.extentZ.data() + index);
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (UInt32 p = 0; p < NUM_FRUSTUM_PLANES; ++p)
+				{
+					__m128 dist = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(planes.nx[p])), _mm_mul_ps(cy, _mm_set1_ps(planes.ny[p])));
+					dist = _mm_add_ps(dist, _mm_mul_ps(cz, _mm_set1_ps(planes.nz[p])));
+					dist = _mm_add_ps(dist, _mm_set1_ps(planes.w[p]));
+					__m128 radius = _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(planes.absNx[p])), _mm_mul_ps(ey, _mm_set1_ps(planes.absNy[p])));
+					radius = _mm_add_ps(radius, _mm_mul_ps(ez, _mm_set1_ps(planes.absNz[p])));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, radius), zero));
+				}
+
+				const int mask = _mm_movemask_ps(inside);
+				for (UInt32 i = 0; i < 4; ++i)
+				{
+					const UInt8 bVisible = (mask >> i) & 1;
+					pVisibility[index + i] = bVisible;
+					numVisible += bVisible;
+				}
+			}
+			return numVisible;
+		}
+
+		static UInt32 _CullSpheres4(const FrustumPlanes& planes, const SphereSoA& spheres, Size& index, UInt8* pVisibility)
+		{
+			UInt32 numVisible = 0;
+			const __m128 zero = _mm_setzero_ps();
+			for (; index + 4 <= spheres.GetSize(); index += 4)
+			{
+				const __m128 cx = _mm_loadu_ps(spheres.centerX.data() + index);
+				const __m128 cy = _mm_loadu_ps(spheres.centerY.data() + index);
+				const __m128 cz = _mm_loadu_ps(spheres.centerZ.data() + index);
+				const __m128 r = _mm_loadu_ps(spheres.radius.data() + index);
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (UInt32 p = 0; p < NUM_FRUSTUM_PLANES; ++p)
+				{
+					__m128 dist = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(planes.nx[p])), _mm_mul_ps(cy, _mm_set1_ps(planes.ny[p])));
+					dist = _mm_add_ps(dist, _mm_mul_ps(cz, _mm_set1_ps(planes.nz[p])));
+					dist = _mm_add_ps(dist, _mm_set1_ps(planes.w[p]));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, r), zero));
+				}
+
+				const int mask = _mm_movemask_ps(inside);
+				for (UInt32 i = 0; i < 4; ++i)
+				{
+					const UInt8 bVisible = (mask >> i) & 1;
+					pVisibility[index + i] = bVisible;
+					numVisible += bVisible;
+				}
+			}
+			return numVisible;
+		}
+#endif
+
+		static bool _IsAABBVisible(const FrustumPlanes& planes, float cx, float cy, float cz, float ex, float ey, float ez)
+		{
+			for (UInt32 p = 0; p < NUM_FRUSTUM_PLANES; ++p)
+			{
+				const float dist = cx * planes.nx[p] + cy * planes.ny[p] + cz * planes.nz[p] + planes.w[p];
+				const float radius = ex * planes.absNx[p] + ey * planes.absNy[p] + ez * planes.absNz[p];
+				if (!(dist + radius >= 0.0f))
+					return false;
+			}
+			return true;
+		}
+
+		static bool _IsSphereVisible(const FrustumPlanes& planes, float cx, float cy, float cz, float r)
+		{
+			for (UInt32 p = 0; p < NUM_FRUSTUM_PLANES; ++p)
+			{
+				const float dist = cx * planes.nx[p] + cy * planes.ny[p] + cz * planes.nz[p] + planes.w[p];
+				if (!(dist + r >= 0.0f))
+					return false;
+			}
+			return true;
+		}
+
+		static UInt32 _CullAABBs1(const FrustumPlanes& planes, const AABBSoA& boxes, Size& index, UInt8* pVisibility)
+		{
+			UInt32 numVisible = 0;
+			for (; index < boxes.GetSize(); ++index)
+			{
+				const UInt8 bVisible = _IsAABBVisible(planes, boxes.centerX[index], boxes.centerY[index], boxes.centerZ[index],
+					boxes.extentX[index], boxes.extentY[index], boxes.extentZ[index]) ? 1 : 0;
+				pVisibility[index] = bVisible;
+				numVisible += bVisible;
+			}
+			return numVisible;
+		}
+
+		static UInt32 _CullSpheres1(const FrustumPlanes& planes, const SphereSoA& spheres, Size& index, UInt8* pVisibility)
+		{
+			UInt32 numVisible = 0;
+			for (; index < spheres.GetSize(); ++index)
+			{
+				const UInt8 bVisible = _IsSphereVisible(planes, spheres.centerX[index], spheres.centerY[index], spheres.centerZ[index],
+					spheres.radius[index]) ? 1 : 0;
+				pVisibility[index] = bVisible;
+				numVisible += bVisible;
+			}
+			return numVisible;
+		}
+	}
+
+	ECullingKernel GetWidestCullingKernel()
+	{
+#if SG_PLATFORM_AVX
+		return ECullingKernel::eAVX;
+#elif SG_PLATFORM_SSE2
+		return ECullingKernel::eSSE2;
+#else
+		return ECullingKernel::eScalar;
+#endif
+	}
+
+	UInt32 FrustumCullAABBs(const Frustum& frustum, const AABBSoA& boxes, UInt8* pVisibility, ECullingKernel widestKernel)
+	{
+		SG_PROFILE_FUNCTION();
+
+		const FrustumPlanes planes = _GetFrustumPlanes(frustum);
+		UInt32 numVisible = 0;
+		Size index = 0;
+		// the wider kernel goes first, and the narrower ones deal with the rest.
+#if SG_PLATFORM_AVX
+		if (widestKernel >= ECullingKernel::eAVX)
+			numVisible += _CullAABBs8(planes, boxes, index, pVisibility);
+#endif
+#if SG_PLATFORM_SSE2
+		if (widestKernel >= ECullingKernel::eSSE2)
+			numVisible += _CullAABBs4(planes, boxes, index, pVisibility);
+#endif
+		numVisible += _CullAABBs1(planes, boxes, index, pVisibility);
+		return numVisible;
+	}
+
+	UInt32 FrustumCullSpheres(const Frustum& frustum, const SphereSoA& spheres, UInt8* pVisibility, ECullingKernel widestKernel)
+	{
+		SG_PROFILE_FUNCTION();
+
+		const FrustumPlanes planes = _GetFrustumPlanes(frustum);
+		UInt32 numVisible = 0;
+		Size index = 0;
+#if SG_PLATFORM_AVX
+		if (widestKernel >= ECullingKernel::eAVX)
+			numVisible += _CullSpheres8(planes, spheres, index, pVisibility);
+#endif
+#if SG_PLATFORM_SSE2
+		if (widestKernel >= ECullingKernel::eSSE2)
+			numVisible += _CullSpheres4(planes, spheres, index, pVisibility);
+#endif
+		numVisible += _CullSpheres1(planes, spheres, index, pVisibility);
+		return numVisible;
+	}
+
+	bool FrustumIntersectAABB(const Frustum& frustum, const AABB& aabb)
+	{
+		const FrustumPlanes planes = _GetFrustumPlanes(frustum);
+		const Vector3f center = AABBCenter(aabb);
+		const Vector3f extent = AABBExtent(aabb);
+		return _IsAABBVisible(planes, center.x, center.y, center.z, extent.x, extent.y, extent.z);
+	}
+
+	bool FrustumIntersectSphere(const Frustum& frustum, const Vector3f& center, float radius)
+	{
+		const FrustumPlanes planes = _GetFrustumPlanes(frustum);
+		return _IsSphereVisible(planes, center.x, center.y, center.z, radius);
+	}
+
+}
@@ -4,6 +4,11 @@
 #include "Profile/Profile.h"
 #include "Math/MathBasic.h"
 
+#ifndef SG_PLATFORM_WINDOWS
+#	include <stdlib.h>
+#	include <malloc.h> // malloc_usable_size()
+#endif
+
 // TODO: add memory tracking
 namespace SG
 {
@@ -41,7 +46,13 @@ namespace SG
 	void* Memory::Impl::MallocAlignInternal(Size size, Size alignment) noexcept
 	{
 #if SG_USE_DEFAULT_MEMORY_ALLOCATION
+#	ifdef SG_PLATFORM_WINDOWS
 		void* pNew = _aligned_malloc(size, alignment);
+#	else
+		void* pNew = nullptr;
+		if (::posix_memalign(&pNew, eastl::max(alignment, sizeof(void*)), size) != 0)
+			pNew = nullptr;
+#	endif
 #else
 		void* pNew = mi_malloc_aligned(size, alignment);
 #endif
@@ -90,7 +101,19 @@ namespace SG
 	void* Memory::Impl::ReallocAlignInternal(void* ptr, Size newSize, Size alignment) noexcept
 	{
 #if SG_USE_DEFAULT_MEMORY_ALLOCATION
+#	ifdef SG_PLATFORM_WINDOWS
 		void* pNew = _aligned_realloc(ptr, newSize, alignment);
+#	else
+		// there is no aligned realloc in posix
+		void* pNew = nullptr;
+		if (::posix_memalign(&pNew, eastl::max(alignment, sizeof(void*)), newSize) != 0)
+			pNew = nullptr;
+		else if (ptr)
+		{
+			memcpy(pNew, ptr, eastl::min(::malloc_usable_size(ptr), newSize));
+			free(ptr);
+		}
+#	endif
 #else
 		void* pNew = mi_realloc_aligned(ptr, newSize, alignment);
 #endif
@@ -129,7 +152,11 @@ namespace SG
 #endif
 		SG_NO_USE(alignment);
 #if SG_USE_DEFAULT_MEMORY_ALLOCATION
+#	ifdef SG_PLATFORM_WINDOWS
 		_aligned_free(ptr);
+#	else
+		free(ptr);
+#	endif
 #else
 		mi_free_aligned(ptr, alignment);
 #endif
@@ -0,0 +1,427 @@
+#include "StdAfx.h"
+#include "Memory/OffsetAllocator.h"
+
+#include "System/Logger.h"
+
+#include "EASTL/algorithm.h"
+#include "EASTL/sort.h"
+
+#if SG_COMPILER_MSVC
+#	include <intrin.h>
+#endif
+
+namespace SG
+{
+
+	namespace // anonymous namespace
+	{
+		constexpr UInt32 MANTISSA_BITS = 3;
+		constexpr UInt32 MANTISSA_VALUE = 1 << MANTISSA_BITS;
+		constexpr UInt32 MANTISSA_MASK = MANTISSA_VALUE - 1;
+		constexpr UInt32 NO_BIT = UInt32(-1);
+
+		SG_INLINE UInt32 _HighestSetBit(UInt32 value)
+		{
+#if SG_COMPILER_MSVC
+			unsigned long index;
+			_BitScanReverse(&index, value);
+			return index;
+#else
+			return 31 - __builtin_clz(value);
+#endif
+		}
+
+		SG_INLINE UInt32 _LowestSetBit(UInt32 value)
+		{
+#if SG_COMPILER_MSVC
+			unsigned long index;
+			_BitScanForward(&index, value);
+			return index;
+#else
+			return __builtin_ctz(value);
+#endif
+		}
+
+		//! The lowest set bit at or above startBit, NO_BIT if there is none.
+		SG_INLINE UInt32 _LowestSetBitFrom(UInt32 mask, UInt32 startBit)
+		{
+			if (startBit >= 32)
+				return NO_BIT;
+			const UInt32 bits = mask & ~((1u << startBit) - 1);
+			return bits == 0 ? NO_BIT : _LowestSetBit(bits);
+		}
+
+		//! Encode the size as a small float (exponent << 3 | mantissa), the small sizes (< 8) are stored as denormals.
+		//! Rounding up makes sure any region in the bin is large enough for the size, it is used to search the bins.
+		UInt32 _SizeToBinRoundUp(UInt32 size)
+		{
+			if (size < MANTISSA_VALUE)
+				return size;
+
+			const UInt32 mantissaStartBit = _HighestSetBit(size) - MANTISSA_BITS;
+			const UInt32 exp = mantissaStartBit + 1;
+			UInt32 mantissa = (size >> mantissaStartBit) & MANTISSA_MASK;
+			if ((size & ((1u << mantissaStartBit) - 1)) != 0)
+				++mantissa;
+			return (exp << MANTISSA_BITS) + mantissa; // the overflow of the mantissa carries into the exponent
+		}
+
+		//! Rounding down makes sure the region is at least as large as the lower bound of its bin, it is used to insert the free regions.
+		UInt32 _SizeToBinRoundDown(UInt32 size)
+		{
+			if (size < MANTISSA_VALUE)
+				return size;
+
+			const UInt32 mantissaStartBit = _HighestSetBit(size) - MANTISSA_BITS;
+			const UInt32 exp = mantissaStartBit + 1;
+			const UInt32 mantissa = (size >> mantissaStartBit) & MANTISSA_MASK;
+			return (exp << MANTISSA_BITS) | mantissa;
+		}
+	}
+
+	OffsetAllocator::OffsetAllocator()
+	{
+		Reset(0);
+	}
+
+	OffsetAllocator::OffsetAllocator(UInt32 size)
+	{
+		Reset(size);
+	}
+
+	OffsetAllocator::Allocation OffsetAllocator::Allocate(UInt32 size)
+	{
+		if (size == 0)
+			return {};
+
+		// the first non-empty bin not smaller than the request, in the same top bin first, then in the higher top bins.
+		const UInt32 minBin = _SizeToBinRoundUp(size);
+		if (minBin >= NUM_LEAF_BINS)
+			return {};
+
+		UInt32 topBin = minBin / BINS_PER_LEAF;
+		UInt32 leafBin = NO_BIT;
+		if (mUsedTopBins & (1u << topBin))
+			leafBin = _LowestSetBitFrom(mUsedLeafBins[topBin], minBin % BINS_PER_LEAF);
+		if (leafBin == NO_BIT)
+		{
+			topBin = _LowestSetBitFrom(mUsedTopBins, topBin + 1);
+			if (topBin == NO_BIT)
+				return {};
+			leafBin = _LowestSetBit(mUsedLeafBins[topBin]);
+		}
+
+		const UInt32 nodeIndex = mBinHeads[topBin * BINS_PER_LEAF + leafBin];
+		RemoveFromBin(nodeIndex);
+
+		const UInt32 remainder = mNodes[nodeIndex].size - size;
+		mNodes[nodeIndex].size = size;
+		mNodes[nodeIndex].state = ENodeState::eUsed;
+
+		// put the rest of the region back as a free neighbour.
+		if (remainder > 0)
+		{
+			const UInt32 restIndex = NewNode(mNodes[nodeIndex].offset + size, remainder);
+			auto& node = mNodes[nodeIndex];
+			auto& rest = mNodes[restIndex];
+			rest.neighborPrev = nodeIndex;
+			rest.neighborNext = node.neighborNext;
+			if (node.neighborNext != INVALID_NODE)
+				mNodes[node.neighborNext].neighborPrev = restIndex;
+			node.neighborNext = restIndex;
+			if (mLastNode == nodeIndex)
+				mLastNode = restIndex;
+			AddToBin(restIndex);
+		}
+
+		mUsedSize += size;
+		++mNumAllocations;
+		return { mNodes[nodeIndex].offset, nodeIndex };
+	}
+
+	void OffsetAllocator::Deallocate(AllocationID id)
+	{
+		if (id >= mNodes.size() || mNodes[id].state != ENodeState::eUsed)
+		{
+			SG_LOG_WARN("Try to free an allocation which is not allocated (id: %d)", id);
+			return;
+		}
+
+		mUsedSize -= mNodes[id].size;
+		--mNumAllocations;
+
+		// the node of the allocation becomes the merged free region.
+		const UInt32 prevIndex = mNodes[id].neighborPrev;
+		if (prevIndex != INVALID_NODE && mNodes[prevIndex].state == ENodeState::eFree)
+		{
+			RemoveFromBin(prevIndex);
+			auto& node = mNodes[id];
+			auto& prev = mNodes[prevIndex];
+			node.offset = prev.offset;
+			node.size += prev.size;
+			node.neighborPrev = prev.neighborPrev;
+			if (prev.neighborPrev != INVALID_NODE)
+				mNodes[prev.neighborPrev].neighborNext = id;
+			ReleaseNode(prevIndex);
+		}
+
+		const UInt32 nextIndex = mNodes[id].neighborNext;
+		if (nextIndex != INVALID_NODE && mNodes[nextIndex].state == ENodeState::eFree)
+		{
+			RemoveFromBin(nextIndex);
+			auto& node = mNodes[id];
+			auto& next = mNodes[nextIndex];
+			node.size += next.size;
+			node.neighborNext = next.neighborNext;
+			if (next.neighborNext != INVALID_NODE)
+				mNodes[next.neighborNext].neighborPrev = id;
+			if (mLastNode == nextIndex)
+				mLastNode = id;
+			ReleaseNode(nextIndex);
+		}
+
+		mNodes[id].state = ENodeState::eFree;
+		AddToBin(id);
+	}
+
+	void OffsetAllocator::Grow(UInt32 newSize)
+	{
+		if (newSize <= mSize)
+			return;
+
+		const UInt32 extraSize = newSize - mSize;
+		if (mLastNode != INVALID_NODE && mNodes[mLastNode].state == ENodeState::eFree)
+		{
+			RemoveFromBin(mLastNode);
+			mNodes[mLastNode].size += extraSize;
+			AddToBin(mLastNode);
+		}
+		else
+		{
+			const UInt32 nodeIndex = NewNode(mSize, extraSize);
+			mNodes[nodeIndex].state = ENodeState::eFree;
+			mNodes[nodeIndex].neighborPrev = mLastNode;
+			if (mLastNode != INVALID_NODE)
+				mNodes[mLastNode].neighborNext = nodeIndex;
+			mLastNode = nodeIndex;
+			AddToBin(nodeIndex);
+		}
+		mSize = newSize;
+	}
+
+	void OffsetAllocator::Reset(UInt32 size)
+	{
+		mNodes.clear();
+		mReleasedNodes.clear();
+		for (auto& head : mBinHeads)
+			head = INVALID_NODE;
+		for (auto& leafBins : mUsedLeafBins)
+			leafBins = 0;
+		mUsedTopBins = 0;
+		mLastNode = INVALID_NODE;
+
+		mSize = 0;
+		mUsedSize = 0;
+		mNumAllocations = 0;
+		Grow(size);
+	}
+
+	void OffsetAllocator::Defragment(vector<Move>& outMoves)
+	{
+		vector<UInt32> usedNodes;
+		usedNodes.reserve(mNumAllocations);
+		for (UInt32 i = 0; i < mNodes.size(); ++i)
+		{
+			if (mNodes[i].state == ENodeState::eUsed)
+				usedNodes.push_back(i);
+		}
+		eastl::sort(usedNodes.begin(), usedNodes.end(), [this](UInt32 lhs, UInt32 rhs) { return mNodes[lhs].offset < mNodes[rhs].offset; });
+
+		// drop all the free regions, then relink the allocations one after another.
+		for (UInt32 i = 0; i < mNodes.size(); ++i)
+		{
+			if (mNodes[i].state == ENodeState::eFree)
+			{
+				RemoveFromBin(i);
+				ReleaseNode(i);
+			}
+		}
+
+		UInt32 cursor = 0;
+		UInt32 prevIndex = INVALID_NODE;
+		for (auto nodeIndex : usedNodes)
+		{
+			auto& node = mNodes[nodeIndex];
+			if (node.offset != cursor)
+			{
+				outMoves.push_back({ nodeIndex, node.offset, cursor, node.size });
+				node.offset = cursor;
+			}
+			node.neighborPrev = prevIndex;
+			node.neighborNext = INVALID_NODE;
+			if (prevIndex != INVALID_NODE)
+				mNodes[prevIndex].neighborNext = nodeIndex;
+			prevIndex = nodeIndex;
+			cursor += node.size;
+		}
+		mLastNode = prevIndex;
+
+		// the free space at the end is added back as one region.
+		const UInt32 size = mSize;
+		mSize = cursor;
+		Grow(size);
+	}
+
+	UInt32 OffsetAllocator::GetOffset(AllocationID id) const
+	{
+		if (id >= mNodes.size() || mNodes[id].state != ENodeState::eUsed)
+			return INVALID_OFFSET;
+		return mNodes[id].offset;
+	}
+
+	UInt32 OffsetAllocator::GetAllocationSize(AllocationID id) const
+	{
+		if (id >= mNodes.size() || mNodes[id].state != ENodeState::eUsed)
+			return 0;
+		return mNodes[id].size;
+	}
+
+	UInt32 OffsetAllocator::GetLargestFreeRegion() const
+	{
+		if (mUsedTopBins == 0)
+			return 0;
+
+		const UInt32 topBin = _HighestSetBit(mUsedTopBins);
+		const UInt32 leafBin = _HighestSetBit(mUsedLeafBins[topBin]);
+		UInt32 largest = 0;
+		for (UInt32 nodeIndex = mBinHeads[topBin * BINS_PER_LEAF + leafBin]; nodeIndex != INVALID_NODE; nodeIndex = mNodes[nodeIndex].binListNext)
+			largest = eastl::max(largest, mNodes[nodeIndex].size);
+		return largest;
+	}
+
+	bool OffsetAllocator::Validate() const
+	{
+		// walk the neighbours from the last node to the front, they should cover the resource without gaps.
+		UInt32 numNodes = 0;
+		UInt32 usedSize = 0;
+		UInt32 numAllocations = 0;
+		UInt32 end = mSize;
+		UInt32 nextIndex = INVALID_NODE;
+		for (UInt32 nodeIndex = mLastNode; nodeIndex != INVALID_NODE; nodeIndex = mNodes[nodeIndex].neighborPrev)
+		{
+			const auto& node = mNodes[nodeIndex];
+			if (node.state == ENodeState::eReleased || node.size == 0 || node.offset + node.size != end || node.neighborNext != nextIndex)
+				return false;
+			if (node.state == ENodeState::eFree && nextIndex != INVALID_NODE && mNodes[nextIndex].state == ENodeState::eFree) // should had been merged
+				return false;
+			if (node.state == ENodeState::eUsed)
+			{
+				usedSize += node.size;
+				++numAllocations;
+			}
+			end = node.offset;
+			nextIndex = nodeIndex;
+			++numNodes;
+		}
+		if (end != 0 || usedSize != mUsedSize || numAllocations != mNumAllocations)
+			return false;
+		if (numNodes + mReleasedNodes.size() != mNodes.size())
+			return false;
+
+		// every free node should be in the bin of its size, and the bit masks should match the bins.
+		UInt32 numFreeNodes = 0;
+		for (UInt32 bin = 0; bin < NUM_LEAF_BINS; ++bin)
+		{
+			const bool bBinUsed = (mUsedLeafBins[bin / BINS_PER_LEAF] & (1u << (bin % BINS_PER_LEAF))) != 0;
+			if (bBinUsed != (mBinHeads[bin] != INVALID_NODE))
+				return false;
+
+			UInt32 prevIndex = INVALID_NODE;
+			for (UInt32 nodeIndex = mBinHeads[bin]; nodeIndex != INVALID_NODE; nodeIndex = mNodes[nodeIndex].binListNext)
+			{
+				const auto& node = mNodes[nodeIndex];
+				if (node.state != ENodeState::eFree || node.binListPrev != prevIndex || _SizeToBinRoundDown(node.size) != bin)
+					return false;
+				prevIndex = nodeIndex;
+				++numFreeNodes;
+			}
+		}
+		for (UInt32 topBin = 0; topBin < NUM_TOP_BINS; ++topBin)
+		{
+			if (((mUsedTopBins & (1u << topBin)) != 0) != (mUsedLeafBins[topBin] != 0))
+				return false;
+		}
+		return numFreeNodes + numAllocations == numNodes;
+	}
+
+	UInt32 OffsetAllocator::NewNode(UInt32 offset, UInt32 size)
+	{
+		UInt32 nodeIndex;
+		if (mReleasedNodes.empty())
+		{
+			nodeIndex = static_cast<UInt32>(mNodes.size());
+			mNodes.emplace_back();
+		}
+		else
+		{
+			nodeIndex = mReleasedNodes.back();
+			mReleasedNodes.pop_back();
+			mNodes[nodeIndex] = Node();
+		}
+		mNodes[nodeIndex].offset = offset;
+		mNodes[nodeIndex].size = size;
+		return nodeIndex;
+	}
+
+	void OffsetAllocator::ReleaseNode(UInt32 node)
+	{
+		mNodes[node].state = ENodeState::eReleased;
+		mReleasedNodes.push_back(node);
+	}
+
+	void OffsetAllocator::AddToBin(UInt32 nodeIndex)
+	{
+		auto& node = mNodes[nodeIndex];
+		const UInt32 bin = _SizeToBinRoundDown(node.size);
+		const UInt32 topBin = bin / BINS_PER_LEAF;
+		const UInt32 leafBin = bin % BINS_PER_LEAF;
+		if (mBinHeads[bin] == INVALID_NODE)
+		{
+			mUsedLeafBins[topBin] |= 1u << leafBin;
+			mUsedTopBins |= 1u << topBin;
+		}
+
+		node.state = ENodeState::eFree;
+		node.binListPrev = INVALID_NODE;
+		node.binListNext = mBinHeads[bin];
+		if (mBinHeads[bin] != INVALID_NODE)
+			mNodes[mBinHeads[bin]].binListPrev = nodeIndex;
+		mBinHeads[bin] = nodeIndex;
+	}
+
+	void OffsetAllocator::RemoveFromBin(UInt32 nodeIndex)
+	{
+		auto& node = mNodes[nodeIndex];
+		if (node.binListPrev != INVALID_NODE)
+			mNodes[node.binListPrev].binListNext = node.binListNext;
+		if (node.binListNext != INVALID_NODE)
+			mNodes[node.binListNext].binListPrev = node.binListPrev;
+
+		if (node.binListPrev == INVALID_NODE) // the head of the bin
+		{
+			const UInt32 bin = _SizeToBinRoundDown(node.size);
+			const UInt32 topBin = bin / BINS_PER_LEAF;
+			const UInt32 leafBin = bin % BINS_PER_LEAF;
+			mBinHeads[bin] = node.binListNext;
+			if (mBinHeads[bin] == INVALID_NODE)
+			{
+				mUsedLeafBins[topBin] &= ~(1u << leafBin);
+				if (mUsedLeafBins[topBin] == 0)
+					mUsedTopBins &= ~(1u << topBin);
+			}
+		}
+		node.binListPrev = INVALID_NODE;
+		node.binListNext = INVALID_NODE;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "StdAfx.h"
+#if SG_PLATFORM_LINUX
+
+#include "Platform/FileDialog.h"
+#include "System/Logger.h"
+
+namespace SG
+{
+
+namespace FileDialog
+{
+
+	// TODO: no native file dialog on linux yet (zenity or a portal?), return empty path as if the user canceled.
+	string OpenFileDialog(Window* /*pWindow*/, const char* /*filter*/)
+	{
+		SG_LOG_WARN("File dialog is not supported on linux yet");
+		return "";
+	}
+
+	string SaveFileDialog(Window* /*pWindow*/, const char* /*filter*/)
+	{
+		SG_LOG_WARN("File dialog is not supported on linux yet");
+		return "";
+	}
+
+}
+
+}
+#endif // SG_PLATFORM_LINUX
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "StdAfx.h"
+#if SG_PLATFORM_LINUX
+#include "Core/Private/Platform/Linux/FileInfo_Linux.h"
+
+#include "System/Logger.h"
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <string.h>
+#include <time.h>
+
+namespace SG
+{
+
+	enum class EFileTimeType
+	{
+		eCreate,
+		eLastWrite,
+		eLastRead,
+	};
+
+	static TimePoint _GetFileTime(const char* filename, EFileTimeType type)
+	{
+		struct stat st = {};
+		if (::stat(filename, &st) != 0) // failed to find this file
+		{
+			SG_LOG_ERROR("There is no file named: %s", filename);
+			return TimePoint();
+		}
+
+		// struct stat has no creation time, st_ctime (the last status change) is the closest one.
+		time_t fileTime = type == EFileTimeType::eCreate ? st.st_ctime :
+			type == EFileTimeType::eLastWrite ? st.st_mtime : st.st_atime;
+		struct tm time = {};
+		::localtime_r(&fileTime, &time);
+
+		TimePoint tp;
+		tp.year = time.tm_year + 1900;
+		tp.month = time.tm_mon + 1;
+		tp.day = time.tm_mday;
+		tp.hour = time.tm_hour;
+		tp.minute = time.tm_min;
+		tp.second = time.tm_sec;
+		return eastl::move(tp);
+	}
+
+	TimePoint GetFileCreateTime(const char* filename)
+	{
+		return _GetFileTime(filename, EFileTimeType::eCreate);
+	}
+
+	TimePoint GetFileLastWriteTime(const char* filename)
+	{
+		return _GetFileTime(filename, EFileTimeType::eLastWrite);
+	}
+
+	TimePoint GetFileLastReadTime(const char* filename)
+	{
+		return _GetFileTime(filename, EFileTimeType::eLastRead);
+	}
+
+	void TraverseAllFile(const char* folder, FileTraverseFunc func)
+	{
+		DIR* pDir = ::opendir(folder);
+		if (!pDir)
+		{
+			SG_LOG_WARN("No files in folder: %s", folder);
+			return;
+		}
+
+		while (struct dirent* pEntry = ::readdir(pDir))
+		{
+			if (!(strcmp(pEntry->d_name, ".") == 0 || strcmp(pEntry->d_name, "..") == 0))
+				func(pEntry->d_name);
+		}
+		::closedir(pDir);
+	}
+
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Defs/Defs.h"
+#include "Base/TimePoint.h"
+
+#if SG_PLATFORM_LINUX
+namespace SG
+{
+
+	TimePoint GetFileCreateTime(const char* filename);
+	TimePoint GetFileLastWriteTime(const char* filename);
+	TimePoint GetFileLastReadTime(const char* filename);
+
+	SG_DEPRECATED void TraverseAllFile(const char* folder, FileTraverseFunc func);
+
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "StdAfx.h"
+#if SG_PLATFORM_LINUX
+#include "Platform/MappedFile.h"
+
+#include "System/Logger.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace SG
+{
+
+	bool MappedFile::Open(const char* path)
+	{
+		Close();
+
+		int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			return false;
+
+		struct stat st = {};
+		if (::fstat(fd, &st) != 0 || st.st_size == 0) // can not map an empty file
+		{
+			::close(fd);
+			return false;
+		}
+
+		void* pData = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (pData == MAP_FAILED)
+		{
+			SG_LOG_ERROR("Failed to map file: %s", path);
+			::close(fd);
+			return false;
+		}
+		::madvise(pData, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+		mpData = reinterpret_cast<const Byte*>(pData);
+		mSize = static_cast<Size>(st.st_size);
+		mpFileHandle = reinterpret_cast<void*>(static_cast<IntPtr>(fd));
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (mpData)
+			::munmap(const_cast<Byte*>(mpData), mSize);
+		if (mpData || mpFileHandle)
+			::close(static_cast<int>(reinterpret_cast<IntPtr>(mpFileHandle)));
+
+		mpData = nullptr;
+		mSize = 0;
+		mpFileHandle = nullptr;
+		mpMappingHandle = nullptr;
+	}
+
+}
+
+#endif // SG_PLATFORM_LINUX
@@ -0,0 +1,51 @@
+#include "StdAfx.h"
+#if SG_PLATFORM_LINUX
+#include "System/System.h"
+
+#include "Profile/Profile.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+namespace SG
+{
+
+	int System::RunProcess(const string& command, const char* pOut)
+	{
+		SG_PROFILE_FUNCTION();
+
+		posix_spawn_file_actions_t fileActions;
+		if (posix_spawn_file_actions_init(&fileActions) != 0)
+			return -1;
+		if (pOut)
+		{
+			// the file is opened in the child process, so the processes run on the other threads never inherit it.
+			posix_spawn_file_actions_addopen(&fileActions, STDOUT_FILENO, pOut, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			posix_spawn_file_actions_adddup2(&fileActions, STDOUT_FILENO, STDERR_FILENO);
+		}
+
+		// let the shell split the command, the same as CreateProcessA does on windows.
+		const char* argv[] = { "sh", "-c", command.c_str(), nullptr };
+		pid_t pid = 0;
+		const int result = ::posix_spawn(&pid, "/bin/sh", &fileActions, nullptr, const_cast<char* const*>(argv), environ);
+		posix_spawn_file_actions_destroy(&fileActions);
+		if (result != 0)
+			return -1;
+
+		int status = 0;
+		while (::waitpid(pid, &status, 0) == -1)
+		{
+			if (errno != EINTR)
+				return -1;
+		}
+		return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+	}
+
+}
+
+#endif // SG_PLATFORM_LINUX
\ No newline at end of file
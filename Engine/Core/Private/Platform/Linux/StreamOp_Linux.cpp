@@ -0,0 +1,119 @@
+#include "StdAfx.h"
+#if SG_PLATFORM_LINUX
+
+#include "System/FileSystem.h"
+#include "Core/Private/Platform/Linux/StreamOp_Linux.h"
+
+namespace SG
+{
+
+	bool LinuxStreamOp::Open(const EResourceDirectory directory, const char* filename, const EFileMode filemode, FileStream* pOut, Size rootFolderOffset)
+	{
+		string outDirectory;
+		for (Size i = 0; i < rootFolderOffset; ++i)
+			outDirectory += "../";
+		if (rootFolderOffset != 0)
+			outDirectory += "Resources/";
+
+		if (directory == EResourceDirectory::eRoot)
+			outDirectory += filename;
+		else
+		{
+			outDirectory += FileSystem::sResourceDirectory[(UInt32)directory];
+			outDirectory += "/";
+			outDirectory += filename;
+		}
+
+		pOut->pFile = nullptr;
+		switch (filemode)
+		{
+		case EFileMode::efRead:
+			pOut->pFile = fopen(outDirectory.c_str(), "r"); break;
+		case EFileMode::efRead_Binary:
+			pOut->pFile = fopen(outDirectory.c_str(), "rb"); break;
+		case EFileMode::efWrite:
+			pOut->pFile = fopen(outDirectory.c_str(), "w"); break;
+		case EFileMode::efWrite_Binary:
+			pOut->pFile = fopen(outDirectory.c_str(), "wb"); break;
+		case EFileMode::efAppend:
+			pOut->pFile = fopen(outDirectory.c_str(), "a+"); break;
+		case EFileMode::efAppend_Binary:
+			pOut->pFile = fopen(outDirectory.c_str(), "a+b"); break;
+		case EFileMode::efRead_Write:
+			pOut->pFile = fopen(outDirectory.c_str(), "wt+"); break;
+		case EFileMode::efRead_Write_Binary:
+			pOut->pFile = fopen(outDirectory.c_str(), "wb+"); break;
+		case EFileMode::efBinary:
+			pOut->pFile = fopen(outDirectory.c_str(), "wb+"); break;
+		default:
+			SG_ASSERT(false && "no file mode fit!"); break;
+		}
+
+		if (pOut->pFile == nullptr)
+			return false;
+
+		pOut->filemode = filemode;
+		return true;
+	}
+
+	bool LinuxStreamOp::Close(FileStream* pStream)
+	{
+		FILE* pFile = (FILE*)pStream->pFile;
+		if (pFile)
+		{
+			fclose(pFile);
+			return true;
+		}
+		else
+			return false;
+	}
+
+	Size LinuxStreamOp::Read(FileStream* pStream, void* pInBuf, Size bufSize)
+	{
+		return fread(pInBuf, 1, bufSize, (FILE*)pStream->pFile);
+	}
+
+	Size LinuxStreamOp::Write(FileStream* pStream, const void* const pOutBuf, Size bufSize)
+	{
+		return fwrite(pOutBuf, 1, bufSize, (FILE*)pStream->pFile);
+	}
+
+	bool LinuxStreamOp::Seek(const FileStream* pStream, EFileBaseOffset baseOffset, Size offset) const
+	{
+		int bOffset = baseOffset == EFileBaseOffset::eStart ? SEEK_SET :
+			baseOffset == EFileBaseOffset::eCurrent ? SEEK_CUR : SEEK_END;
+		int ret = fseek((FILE*)pStream->pFile, (long)offset, bOffset);
+		if (ret == 0)
+			return true;
+		return false;
+	}
+
+	Size LinuxStreamOp::Tell(const FileStream* pStream) const
+	{
+		return ftell((FILE*)pStream->pFile);
+	}
+
+	Size LinuxStreamOp::FileSize(const FileStream* pStream) const
+	{
+		Size currPos = Tell(pStream);
+		Seek(pStream, EFileBaseOffset::eEOF, 0);
+		Size fileSize = Tell(pStream);
+		Seek(pStream, EFileBaseOffset::eStart, currPos);
+		return fileSize;
+	}
+
+	bool LinuxStreamOp::Flush(FileStream* pStream)
+	{
+		int ret = fflush((FILE*)pStream->pFile);
+		if (ret == 0)
+			return true;
+		return false;
+	}
+
+	bool LinuxStreamOp::IsEndOfFile(const FileStream* pStream) const
+	{
+		return feof((FILE*)pStream->pFile);
+	}
+
+}
+#endif // SG_PLATFORM_LINUX
\ No newline at end of file
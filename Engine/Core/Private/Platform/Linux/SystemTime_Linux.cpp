@@ -0,0 +1,59 @@
+#include "StdAfx.h"
+#if SG_PLATFORM_LINUX
+#include "Platform/SystemTime.h"
+
+#include <time.h>
+
+namespace SG
+{
+
+	Size GetSystemTimeHour()
+	{
+		time_t tm = time(NULL);
+		struct tm BackupTime;
+		localtime_r(&tm, &BackupTime);
+		return BackupTime.tm_hour;
+	}
+
+	Size GetSystemTimeMinute()
+	{
+		time_t tm = time(NULL);
+		struct tm BackupTime;
+		localtime_r(&tm, &BackupTime);
+		return BackupTime.tm_min;
+	}
+
+	Size GetSystemTimeSecond()
+	{
+		time_t tm = time(NULL);
+		struct tm BackupTime;
+		localtime_r(&tm, &BackupTime);
+		return BackupTime.tm_sec;
+	}
+
+	Size GetSystemTimeYear()
+	{
+		time_t tm = time(NULL);
+		struct tm BackupTime;
+		localtime_r(&tm, &BackupTime);
+		return BackupTime.tm_year + 1900;
+	}
+
+	Size GetSystemTimeMonth()
+	{
+		time_t tm = time(NULL);
+		struct tm BackupTime;
+		localtime_r(&tm, &BackupTime);
+		return BackupTime.tm_mon + 1;
+	}
+
+	Size GetSystemTimeDay()
+	{
+		time_t tm = time(NULL);
+		struct tm BackupTime;
+		localtime_r(&tm, &BackupTime);
+		return BackupTime.tm_mday;
+	}
+
+}
+#endif
\ No newline at end of file
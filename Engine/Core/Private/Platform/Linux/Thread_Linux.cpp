@@ -0,0 +1,477 @@
+#include "StdAfx.h"
+#if SG_PLATFORM_LINUX
+
+#include "Defs/Defs.h"
+#include "Thread/Thread.h"
+#include "Memory/Memory.h"
+#include "Profile/Profile.h"
+#include "System/Logger.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace SG
+{
+
+	static UInt32 _CurrThreadTid();
+
+	//! Use to forward thread's job.
+	static void* _ThreadFuncForward(void* pUser)
+	{
+		Thread* pThread = reinterpret_cast<Thread*>(pUser);
+		// publish the tid for GetThreadID(), which may already be waiting for it
+		__atomic_store_n(&pThread->id, _CurrThreadTid(), __ATOMIC_RELEASE);
+		::syscall(SYS_futex, reinterpret_cast<int*>(&pThread->id), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+		pThread->pFunc(pThread->pUser);
+		return nullptr;
+	}
+
+	static char* _CurrThreadName()
+	{
+		SG_THREAD_LOCAL static char threadName[32] = "NULL";
+		return threadName;
+	}
+
+	//! Return false if timeout.
+	static bool _FutexWait(std::atomic<int>* pAddr, int expected, UInt32 ms = UINT32_MAX)
+	{
+		timespec timeout = {};
+		timespec* pTimeout = nullptr;
+		if (ms != UINT32_MAX)
+		{
+			timeout.tv_sec = ms / 1000;
+			timeout.tv_nsec = (ms % 1000) * 1000000;
+			pTimeout = &timeout;
+		}
+		// EAGAIN (the value is changed) and EINTR are treated as spurious wake up
+		const long res = ::syscall(SYS_futex, reinterpret_cast<int*>(pAddr), FUTEX_WAIT_PRIVATE, expected, pTimeout, nullptr, 0);
+		return !(res == -1 && errno == ETIMEDOUT);
+	}
+
+	static void _FutexWake(std::atomic<int>* pAddr, int count)
+	{
+		::syscall(SYS_futex, reinterpret_cast<int*>(pAddr), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+	}
+
+	//! The tid of the current thread, cached to keep the syscall away from the locks.
+	static UInt32 _CurrThreadTid()
+	{
+		SG_THREAD_LOCAL static UInt32 tid = 0;
+		if (tid == 0)
+			tid = (UInt32)::syscall(SYS_gettid);
+		return tid;
+	}
+
+	const char* GetCurrThreadName()
+	{
+		return _CurrThreadName();
+	}
+
+	void SetCurrThreadName(const char* name)
+	{
+		strncpy(_CurrThreadName(), name, 31);
+		_CurrThreadName()[31] = '\0';
+
+		// linux only allow 16 characters (include the '\0') for a thread name
+		char shortName[16] = { 0 };
+		strncpy(shortName, name, 15);
+		::pthread_setname_np(::pthread_self(), shortName);
+		SG_PROFILE_THREAD_NAME(name);
+	}
+
+	bool ThreadCreate(Thread* pThread, ThreadFunc func, void* pUser)
+	{
+		// the thread may start before pthread_create() returns, so fill in the function first
+		pThread->pUser = pUser;
+		pThread->pFunc = func;
+		pThread->id = 0;
+
+		pthread_t handle;
+		if (::pthread_create(&handle, nullptr, _ThreadFuncForward, pThread) != 0)
+		{
+			pThread->pHandle = nullptr;
+			return false;
+		}
+		SG_COMPILE_ASSERT(sizeof(pthread_t) <= sizeof(ThreadHandle), "pthread_t can not be stored in a ThreadHandle");
+		pThread->pHandle = reinterpret_cast<ThreadHandle>(handle);
+		return true;
+	}
+
+	void ThreadRestore(Thread* pThread)
+	{
+		if (pThread->pHandle)
+		{
+			::pthread_join(reinterpret_cast<pthread_t>(pThread->pHandle), nullptr);
+			pThread->pHandle = nullptr;
+		}
+	}
+
+	void ThreadSuspend(Thread* pThread)
+	{
+		SG_NO_USE(pThread);
+		SG_LOG_WARN("ThreadSuspend() is not supported by pthread");
+	}
+
+	void ThreadJoin(Thread* pThread)
+	{
+		// a pthread can only be joined once, so the handle is released here
+		ThreadRestore(pThread);
+	}
+
+	bool ThreadSetAffinity(Thread* pThread, UInt32 coreIndex)
+	{
+		if (!pThread->pHandle || coreIndex >= CPU_SETSIZE)
+			return false;
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		CPU_SET(coreIndex, &cpuSet);
+		return ::pthread_setaffinity_np(reinterpret_cast<pthread_t>(pThread->pHandle), sizeof(cpu_set_t), &cpuSet) == 0;
+	}
+
+	bool SetCurrThreadAffinity(UInt32 coreIndex)
+	{
+		if (coreIndex >= CPU_SETSIZE)
+			return false;
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		CPU_SET(coreIndex, &cpuSet);
+		return ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+	}
+
+	UInt32 GetNumCPUCores()
+	{
+		const long numCores = ::sysconf(_SC_NPROCESSORS_ONLN);
+		return numCores > 0 ? (UInt32)numCores : 1;
+	}
+
+	void ThreadSleep(UInt32 ms)
+	{
+		if (ms == 0)
+		{
+			::sched_yield();
+			return;
+		}
+
+		timespec duration = {};
+		duration.tv_sec = ms / 1000;
+		duration.tv_nsec = (ms % 1000) * 1000000;
+		while (::nanosleep(&duration, &duration) == -1 && errno == EINTR);
+	}
+
+	UInt32 GetThreadID(Thread* pThread)
+	{
+		// pthread can not query the kernel tid of the other thread, so the thread publishes it itself when it starts
+		UInt32 tid = 0;
+		while ((tid = __atomic_load_n(&pThread->id, __ATOMIC_ACQUIRE)) == 0 && pThread->pHandle)
+			::syscall(SYS_futex, reinterpret_cast<int*>(&pThread->id), FUTEX_WAIT_PRIVATE, 0, nullptr, nullptr, 0);
+		return tid;
+	}
+
+	UInt32 GetCurrThreadID()
+	{
+		return _CurrThreadTid();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/// Mutex
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	Mutex::Mutex()
+		:mState(0), mOwner(0), mRecursion(0)
+	{
+	}
+
+	Mutex::~Mutex()
+	{
+		SG_ASSERT(mOwner.load(std::memory_order_relaxed) == 0 && "Mutex is destroyed while it is locked!");
+	}
+
+	void Mutex::Lock()
+	{
+		const UInt32 threadId = _CurrThreadTid();
+		// only the owner itself can see its own id here, so relaxed is enough
+		if (mOwner.load(std::memory_order_relaxed) == threadId)
+		{
+			++mRecursion;
+			return;
+		}
+
+		LockSlow();
+		mOwner.store(threadId, std::memory_order_relaxed);
+		mRecursion = 1;
+	}
+
+	void Mutex::LockSlow()
+	{
+		// fast path, no one is holding the lock
+		int state = 0;
+		if (mState.compare_exchange_strong(state, 1, std::memory_order_acquire))
+			return;
+
+		// spin a while before sleeping, the lock is usually held for a short time
+		for (int i = 0; i < 100; ++i)
+		{
+			state = 0;
+			if (mState.compare_exchange_weak(state, 1, std::memory_order_acquire))
+				return;
+#if defined(SG_PLATFORM_X64)
+			__builtin_ia32_pause();
+#endif
+		}
+
+		// mark the lock as contended, and sleep until the owner wake us up
+		while (mState.exchange(2, std::memory_order_acquire) != 0)
+			_FutexWait(&mState, 2);
+	}
+
+	bool Mutex::TryLock()
+	{
+		const UInt32 threadId = _CurrThreadTid();
+		if (mOwner.load(std::memory_order_relaxed) == threadId)
+		{
+			++mRecursion;
+			return true;
+		}
+
+		int state = 0;
+		if (!mState.compare_exchange_strong(state, 1, std::memory_order_acquire))
+			return false;
+		mOwner.store(threadId, std::memory_order_relaxed);
+		mRecursion = 1;
+		return true;
+	}
+
+	void Mutex::UnLock()
+	{
+		SG_ASSERT(mOwner.load(std::memory_order_relaxed) == _CurrThreadTid() && "Mutex is unlocked by a thread which do not own it!");
+		if (--mRecursion > 0)
+			return;
+
+		mOwner.store(0, std::memory_order_relaxed);
+		// only do the syscall when there may be some waiters
+		if (mState.exchange(0, std::memory_order_release) == 2)
+			_FutexWake(&mState, 1);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/// ScopeLock
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	ScopeLock::ScopeLock(Mutex& mutex)
+		:mMutex(mutex)
+	{
+		mMutex.Lock();
+	}
+
+	ScopeLock::~ScopeLock()
+	{
+		mMutex.UnLock();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/// ConditionVariable
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	bool ConditionVariable::Wait(const Mutex& mutex, UInt32 ms)
+	{
+		Mutex& m = const_cast<Mutex&>(mutex);
+		const int sequence = mSequence.load(std::memory_order_relaxed);
+
+		// release the mutex completely no matter how many times it is locked by this thread, and restore it after the wait
+		const UInt32 threadId = m.mOwner.load(std::memory_order_relaxed);
+		const UInt32 recursion = m.mRecursion;
+		SG_ASSERT(threadId == _CurrThreadTid() && "ConditionVariable must be waited with the mutex locked!");
+		m.mRecursion = 1;
+		m.UnLock();
+
+		const bool bNotTimeout = _FutexWait(&mSequence, sequence, ms);
+		// the waiter may not be the only one in the lock, so always lock it as contended
+		while (m.mState.exchange(2, std::memory_order_acquire) != 0)
+			_FutexWait(&m.mState, 2);
+		m.mOwner.store(threadId, std::memory_order_relaxed);
+		m.mRecursion = recursion;
+		return bNotTimeout;
+	}
+
+	void ConditionVariable::NotifyOne()
+	{
+		mSequence.fetch_add(1, std::memory_order_release);
+		_FutexWake(&mSequence, 1);
+	}
+
+	void ConditionVariable::NotifyAll()
+	{
+		mSequence.fetch_add(1, std::memory_order_release);
+		_FutexWake(&mSequence, INT_MAX);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/// Semaphore
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	Semaphore::InternalSemaphore::InternalSemaphore(int maximunCnt, int initCnt)
+		:mValue(initCnt)
+	{
+		SG_NO_USE(maximunCnt);
+	}
+
+	Semaphore::InternalSemaphore::~InternalSemaphore()
+	{
+	}
+
+	void Semaphore::InternalSemaphore::Acquire()
+	{
+		while (true)
+		{
+			int value = mValue.load(std::memory_order_relaxed);
+			while (value > 0)
+			{
+				if (mValue.compare_exchange_weak(value, value - 1, std::memory_order_acquire))
+					return;
+			}
+			_FutexWait(&mValue, 0);
+		}
+	}
+
+	void Semaphore::InternalSemaphore::Release()
+	{
+		mValue.fetch_add(1, std::memory_order_release);
+		_FutexWake(&mValue, 1);
+	}
+
+	Semaphore::Semaphore(int maximunCnt, int initCnt)
+		:mSemaphore(maximunCnt)
+	{
+		if (initCnt != 0)
+			mCount.Exchange(initCnt);
+	}
+
+	Semaphore::~Semaphore()
+	{
+	}
+
+	void Semaphore::Acquire()
+	{
+		// after decreased mCount, if mCount is below 0, we can acquire the internal semaphore
+		if (mCount.Decrease() < 0)
+			mSemaphore.Acquire();
+	}
+
+	void Semaphore::Release()
+	{
+		// after increased mCount, if mCount is 0 or below 0, we can release the internal semaphore
+		if (mCount.Increase() <= 0)
+			mSemaphore.Release();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/// Atomic16
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	SG::Int16 Atomic16::Increase() volatile
+	{
+		return __atomic_add_fetch(&mCount, 1, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int16 Atomic16::Decrease() volatile
+	{
+		return __atomic_sub_fetch(&mCount, 1, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int16 Atomic16::Add(Int16 num) volatile
+	{
+		return __atomic_add_fetch(&mCount, num, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int16 Atomic16::Exchange(Int16 num) volatile
+	{
+		return __atomic_exchange_n(&mCount, num, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int16 Atomic16::Or(Int16 num) volatile
+	{
+		return __atomic_fetch_or(&mCount, num, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int16 Atomic16::And(Int16 num) volatile
+	{
+		return __atomic_fetch_and(&mCount, num, __ATOMIC_SEQ_CST);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/// Atomic32
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	long Atomic32::Increase() volatile
+	{
+		return __atomic_add_fetch(&mCount, 1, __ATOMIC_SEQ_CST);
+	}
+
+	long Atomic32::Decrease() volatile
+	{
+		return __atomic_sub_fetch(&mCount, 1, __ATOMIC_SEQ_CST);
+	}
+
+	long Atomic32::Add(long num) volatile
+	{
+		return __atomic_add_fetch(&mCount, (int)num, __ATOMIC_SEQ_CST);
+	}
+
+	long Atomic32::Exchange(long num) volatile
+	{
+		return __atomic_exchange_n(&mCount, (int)num, __ATOMIC_SEQ_CST);
+	}
+
+	long Atomic32::Or(long num) volatile
+	{
+		return __atomic_fetch_or(&mCount, (int)num, __ATOMIC_SEQ_CST);
+	}
+
+	long Atomic32::And(long num) volatile
+	{
+		return __atomic_fetch_and(&mCount, (int)num, __ATOMIC_SEQ_CST);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/// Atomic64
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	SG::Int64 Atomic64::Increase() volatile
+	{
+		return __atomic_add_fetch(&mCount, 1, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int64 Atomic64::Decrease() volatile
+	{
+		return __atomic_sub_fetch(&mCount, 1, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int64 Atomic64::Add(Int64 num) volatile
+	{
+		return __atomic_add_fetch(&mCount, num, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int64 Atomic64::Exchange(Int64 num) volatile
+	{
+		return __atomic_exchange_n(&mCount, num, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int64 Atomic64::Or(Int64 num) volatile
+	{
+		return __atomic_fetch_or(&mCount, num, __ATOMIC_SEQ_CST);
+	}
+
+	SG::Int64 Atomic64::And(Int64 num) volatile
+	{
+		return __atomic_fetch_and(&mCount, num, __ATOMIC_SEQ_CST);
+	}
+
+}
+#endif // SG_PLATFORM_LINUX
@@ -60,10 +60,15 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
+#ifdef SG_PLATFORM_WINDOWS
 		POINT pos = {};
 		::GetCursorPos(&pos);
 		Vector2i p = { pos.x, pos.y };
 		return eastl::move(p);
+#else
+		// TODO: no window system on linux yet, the cursor stays at the origin.
+		return Vector2i(0, 0);
+#endif
 	}
 
 	void OperatingSystem::ShowMouseCursor()
@@ -0,0 +1,68 @@
+#include "StdAfx.h"
+#ifdef SG_PLATFORM_WINDOWS
+#include "Platform/MappedFile.h"
+
+#include "System/Logger.h"
+
+#include <windows.h>
+
+namespace SG
+{
+
+	bool MappedFile::Open(const char* path)
+	{
+		Close();
+
+		HANDLE hFile = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize = {};
+		if (!::GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) // can not map an empty file
+		{
+			::CloseHandle(hFile);
+			return false;
+		}
+
+		HANDLE hMapping = ::CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!hMapping)
+		{
+			SG_LOG_ERROR("Failed to create file mapping: %s", path);
+			::CloseHandle(hFile);
+			return false;
+		}
+
+		void* pData = ::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		if (!pData)
+		{
+			SG_LOG_ERROR("Failed to map view of file: %s", path);
+			::CloseHandle(hMapping);
+			::CloseHandle(hFile);
+			return false;
+		}
+
+		mpData = reinterpret_cast<const Byte*>(pData);
+		mSize = static_cast<Size>(fileSize.QuadPart);
+		mpFileHandle = hFile;
+		mpMappingHandle = hMapping;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (mpData)
+			::UnmapViewOfFile(mpData);
+		if (mpMappingHandle)
+			::CloseHandle(mpMappingHandle);
+		if (mpFileHandle)
+			::CloseHandle(mpFileHandle);
+
+		mpData = nullptr;
+		mSize = 0;
+		mpFileHandle = nullptr;
+		mpMappingHandle = nullptr;
+	}
+
+}
+
+#endif // SG_PLATFORM_WINDOWS
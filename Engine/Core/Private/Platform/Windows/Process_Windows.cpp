@@ -0,0 +1,62 @@
+#include "StdAfx.h"
+#ifdef SG_PLATFORM_WINDOWS
+#include "System/System.h"
+
+#include "Profile/Profile.h"
+
+#include <windows.h>
+
+namespace SG
+{
+
+	int System::RunProcess(const string& command, const char* pOut)
+	{
+		SG_PROFILE_FUNCTION();
+
+		STARTUPINFOA        startupInfo;
+		PROCESS_INFORMATION processInfo;
+		memset(&startupInfo, 0, sizeof startupInfo);
+		memset(&processInfo, 0, sizeof processInfo);
+
+		HANDLE stdOut = NULL;
+		if (pOut)
+		{
+			SECURITY_ATTRIBUTES sa;
+			sa.nLength = sizeof(sa);
+			sa.lpSecurityDescriptor = NULL;
+			sa.bInheritHandle = TRUE;
+
+			size_t   pathLength = strlen(pOut) + 1;
+			wchar_t* buffer = (wchar_t*)alloca(pathLength * sizeof(wchar_t));
+			MultiByteToWideChar(CP_UTF8, 0, pOut, (int)pathLength, buffer, (int)pathLength);
+			stdOut = CreateFileW(buffer, GENERIC_ALL, FILE_SHARE_WRITE | FILE_SHARE_READ, &sa, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		}
+
+		startupInfo.cb = sizeof(STARTUPINFO);
+		startupInfo.dwFlags |= STARTF_USESTDHANDLES;
+		startupInfo.hStdOutput = stdOut;
+		startupInfo.hStdError  = stdOut;
+
+		// create a process
+		if (!CreateProcessA(NULL, (LPSTR)command.c_str(), NULL, NULL, stdOut ? TRUE : FALSE, CREATE_NO_WINDOW, NULL, NULL, &startupInfo, &processInfo))
+		{
+			if (stdOut)
+				CloseHandle(stdOut);
+			return -1;
+		}
+
+		WaitForSingleObject(processInfo.hProcess, INFINITE);
+		DWORD exitCode = 0;
+		GetExitCodeProcess(processInfo.hProcess, &exitCode);
+
+		CloseHandle(processInfo.hProcess);
+		CloseHandle(processInfo.hThread);
+
+		if (stdOut)
+			CloseHandle(stdOut);
+		return static_cast<int>(exitCode);
+	}
+
+}
+
+#endif // SG_PLATFORM_WINDOWS
\ No newline at end of file
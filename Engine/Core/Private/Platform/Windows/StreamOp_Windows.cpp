@@ -70,12 +70,12 @@ namespace SG
 
 	Size WindowsStreamOp::Read(FileStream* pStream, void* pInBuf, Size bufSize)
 	{
-		return fread(pInBuf, bufSize, 1, (FILE*)pStream->pFile);
+		return fread(pInBuf, 1, bufSize, (FILE*)pStream->pFile);
 	}
 
 	Size WindowsStreamOp::Write(FileStream* pStream, const void* const pOutBuf, Size bufSize)
 	{
-		return fwrite(pOutBuf, bufSize, 1, (FILE*)pStream->pFile);
+		return fwrite(pOutBuf, 1, bufSize, (FILE*)pStream->pFile);
 	}
 
 	bool WindowsStreamOp::Seek(const FileStream* pStream, EFileBaseOffset baseOffset, Size offset) const
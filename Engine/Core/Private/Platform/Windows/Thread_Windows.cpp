@@ -4,6 +4,7 @@
 #include "Defs/Defs.h"
 #include "Thread/Thread.h"
 #include "Memory/Memory.h"
+#include "Profile/Profile.h"
 
 namespace SG
 {
@@ -30,20 +31,19 @@ namespace SG
 	void SetCurrThreadName(const char* name)
 	{
 		strcpy_s(_CurrThreadName(), 32, name);
+		SG_PROFILE_THREAD_NAME(name);
 	}
 
 	bool ThreadCreate(Thread* pThread, ThreadFunc func, void* pUser)
 	{
-		HANDLE pHandle = ::CreateThread(0, 0, _ThreadFuncForward, pThread, 0, 0);
-		if (!pHandle)
-			return false;
-		else
-		{
-			pThread->pUser = pUser;
-			pThread->pHandle = pHandle;
-			pThread->pFunc = func;
-			return true;
-		}
+		// the thread may start before CreateThread() returns, so fill in the function first
+		pThread->pUser = pUser;
+		pThread->pFunc = func;
+		DWORD threadId = 0;
+		HANDLE pHandle = ::CreateThread(0, 0, _ThreadFuncForward, pThread, 0, &threadId);
+		pThread->pHandle = pHandle;
+		pThread->id = (ThreadID)threadId;
+		return pHandle != nullptr;
 	}
 
 	void ThreadRestore(Thread* pThread)
@@ -66,6 +66,20 @@ namespace SG
 		::WaitForSingleObject((HANDLE)pThread->pHandle, INFINITE);
 	}
 
+	bool ThreadSetAffinity(Thread* pThread, UInt32 coreIndex)
+	{
+		if (coreIndex >= 64)
+			return false;
+		return ::SetThreadAffinityMask((HANDLE)pThread->pHandle, DWORD_PTR(1) << coreIndex) != 0;
+	}
+
+	bool SetCurrThreadAffinity(UInt32 coreIndex)
+	{
+		if (coreIndex >= 64)
+			return false;
+		return ::SetThreadAffinityMask(::GetCurrentThread(), DWORD_PTR(1) << coreIndex) != 0;
+	}
+
 	UInt32 GetNumCPUCores() 
 	{
 		_SYSTEM_INFO sysInfo = {};
@@ -80,7 +94,7 @@ namespace SG
 
 	UInt32 GetThreadID(Thread* pThread)
 	{
-		return ::GetThreadId((HANDLE)pThread->pHandle);
+		return pThread->id;
 	}
 
 	UInt32 GetCurrThreadID()
@@ -233,7 +247,7 @@ namespace SG
 
 	SG::Int16 Atomic16::And(Int16 num) volatile
 	{
-		return ::InterlockedOr16((volatile short*)&mCount, num);
+		return ::InterlockedAnd16((volatile short*)&mCount, num);
 	}
 
 	/////////////////////////////////////////////////////////////////////////////////////////
@@ -305,7 +319,7 @@ namespace SG
 
 	SG::Int64 Atomic64::And(Int64 num) volatile
 	{
-		return ::InterlockedOr64((volatile LONG64*)&mCount, num);
+		return ::InterlockedAnd64((volatile LONG64*)&mCount, num);
 	}
 
 }
@@ -3,7 +3,7 @@
 
 #include "System/Logger.h"
 
-#include <eastl/algorithm.h>
+#include <EASTL/algorithm.h>
 
 namespace SG
 {
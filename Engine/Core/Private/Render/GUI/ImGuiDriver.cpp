@@ -193,7 +193,7 @@ namespace SG
 	static ImVec2 _ImGui_Platform_GetWindowPos_Impl(ImGuiViewport* vp)
 	{
 		Window* pWindow = reinterpret_cast<Window*>(vp->PlatformHandle);
-		auto& rect = pWindow->GetCurrRect();
+		const Rect rect = pWindow->GetCurrRect();
 		return { (float)rect.left, (float)rect.top };
 	}
 
@@ -315,7 +315,7 @@ namespace SG
 		platformIO.Monitors.resize(0);
 
 		ImGuiPlatformMonitor monitor;
-		Rect& monitorRect = OperatingSystem::GetMainMonitor()->GetMonitorRect();
+		const Rect monitorRect = OperatingSystem::GetMainMonitor()->GetMonitorRect();
 		monitor.MainPos = monitor.WorkPos = { (float)monitorRect.left, (float)monitorRect.top };
 		monitor.MainSize = monitor.WorkSize = { (float)GetRectWidth(monitorRect), (float)GetRectHeight(monitorRect) };
 		platformIO.Monitors.push_back(monitor);
@@ -466,7 +466,7 @@ namespace SG
 				{
 					// Single viewport mode: mouse position in client window coordinates (io.MousePos is (0,0) when the mouse is on the upper-left corner of the app window)
 					// Multi-viewport mode: mouse position in OS absolute coordinates (io.MousePos is (0,0) when the mouse is on the upper-left of the primary monitor)
-					auto& windowRect = pWindow->GetCurrRect();
+					const Rect windowRect = pWindow->GetCurrRect();
 					mousePos[0] += windowRect.left;
 					mousePos[1] += windowRect.top;
 				}
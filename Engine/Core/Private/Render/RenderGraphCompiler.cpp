@@ -0,0 +1,263 @@
+#include "StdAfx.h"
+#include "Render/RenderGraphCompiler.h"
+
+#include "System/Logger.h"
+#include "Profile/Profile.h"
+
+#include "EASTL/algorithm.h"
+#include "EASTL/sort.h"
+
+namespace SG
+{
+
+	namespace // anonymous namespace
+	{
+		SG_INLINE bool _Contains(const vector<UInt32>& indices, UInt32 index)
+		{
+			return eastl::find(indices.begin(), indices.end(), index) != indices.end();
+		}
+
+		SG_INLINE void _PushUnique(vector<UInt32>& indices, UInt32 index)
+		{
+			if (!_Contains(indices, index))
+				indices.push_back(index);
+		}
+	}
+
+	void RenderGraphCompiler::Reset()
+	{
+		mPasses.clear();
+		mResources.clear();
+		mExecutionOrder.clear();
+	}
+
+	UInt32 RenderGraphCompiler::AddResource(bool bOutput)
+	{
+		Resource resource = {};
+		resource.bOutput = bOutput;
+		mResources.emplace_back(resource);
+		return static_cast<UInt32>(mResources.size() - 1);
+	}
+
+	UInt32 RenderGraphCompiler::AddPass(EQueueType queue, bool bEnabled)
+	{
+		Pass pass = {};
+		pass.queue = queue;
+		pass.bEnabled = bEnabled;
+		pass.assignedQueue = queue;
+		mPasses.emplace_back(pass);
+		return static_cast<UInt32>(mPasses.size() - 1);
+	}
+
+	void RenderGraphCompiler::Read(UInt32 pass, UInt32 resource)
+	{
+		SG_ASSERT(pass < mPasses.size() && resource < mResources.size());
+		_PushUnique(mPasses[pass].reads, resource);
+	}
+
+	void RenderGraphCompiler::Write(UInt32 pass, UInt32 resource)
+	{
+		SG_ASSERT(pass < mPasses.size() && resource < mResources.size());
+		_PushUnique(mPasses[pass].writes, resource);
+		_PushUnique(mResources[resource].writers, pass);
+	}
+
+	void RenderGraphCompiler::Compile(bool bAsyncCompute)
+	{
+		SG_PROFILE_FUNCTION();
+
+		BuildDependencies();
+		CullPasses();
+		SortPasses();
+		AssignQueues(bAsyncCompute);
+		ComputeLifetimes();
+	}
+
+	bool RenderGraphCompiler::GetResourceLifetime(UInt32 resource, UInt32& firstPosition, UInt32& lastPosition) const
+	{
+		const auto& record = mResources[resource];
+		if (record.firstPosition == INVALID_INDEX)
+			return false;
+
+		firstPosition = record.firstPosition;
+		lastPosition = record.lastPosition;
+		return true;
+	}
+
+	void RenderGraphCompiler::BuildDependencies()
+	{
+		vector<UInt32> lastWriters(mResources.size(), INVALID_INDEX);
+		vector<vector<UInt32>> readers(mResources.size()); // the passes which read the current content of the resource
+
+		for (UInt32 i = 0; i < mPasses.size(); ++i)
+		{
+			auto& pass = mPasses[i];
+			pass.dependencies.clear();
+
+			// read after write
+			for (auto resource : pass.reads)
+			{
+				if (lastWriters[resource] != INVALID_INDEX)
+					_PushUnique(pass.dependencies, lastWriters[resource]);
+			}
+
+			// write after write and write after read
+			for (auto resource : pass.writes)
+			{
+				if (lastWriters[resource] != INVALID_INDEX)
+					_PushUnique(pass.dependencies, lastWriters[resource]);
+				for (auto reader : readers[resource])
+				{
+					if (reader != i)
+						_PushUnique(pass.dependencies, reader);
+				}
+				lastWriters[resource] = i;
+				readers[resource].clear();
+			}
+
+			for (auto resource : pass.reads)
+			{
+				if (!_Contains(pass.writes, resource))
+					readers[resource].push_back(i);
+			}
+
+			// all the dependencies are declared before this pass
+			pass.level = 0;
+			for (auto dependency : pass.dependencies)
+				pass.level = eastl::max(pass.level, mPasses[dependency].level + 1);
+		}
+	}
+
+	void RenderGraphCompiler::CullPasses()
+	{
+		for (auto& pass : mPasses)
+			pass.bCulled = true;
+
+		// the last enabled writers of the output resources are the roots
+		for (UInt32 i = 0; i < mResources.size(); ++i)
+		{
+			if (!mResources[i].bOutput)
+				continue;
+
+			const UInt32 writer = FindEnabledWriter(i, static_cast<UInt32>(mPasses.size()));
+			if (writer != INVALID_INDEX)
+				mPasses[writer].bCulled = false;
+		}
+
+		// a live pass keeps alive the passes producing the content it reads, which are all declared before it.
+		for (UInt32 i = static_cast<UInt32>(mPasses.size()); i-- > 0;)
+		{
+			const auto& pass = mPasses[i];
+			if (pass.bCulled)
+				continue;
+
+			for (auto resource : pass.reads)
+			{
+				const UInt32 writer = FindEnabledWriter(resource, i);
+				if (writer != INVALID_INDEX)
+					mPasses[writer].bCulled = false;
+			}
+		}
+	}
+
+	void RenderGraphCompiler::SortPasses()
+	{
+		mExecutionOrder.resize(mPasses.size());
+		for (UInt32 i = 0; i < mPasses.size(); ++i)
+			mExecutionOrder[i] = i;
+
+		// a dependency always has a lower level, so the order by the levels is a topological order.
+		eastl::sort(mExecutionOrder.begin(), mExecutionOrder.end(), [this](UInt32 lhs, UInt32 rhs)
+			{
+				if (mPasses[lhs].level != mPasses[rhs].level)
+					return mPasses[lhs].level < mPasses[rhs].level;
+				return lhs < rhs;
+			});
+	}
+
+	void RenderGraphCompiler::AssignQueues(bool bAsyncCompute)
+	{
+		for (auto& pass : mPasses)
+		{
+			pass.assignedQueue = pass.queue;
+			if (pass.queue == EQueueType::eCompute && !bAsyncCompute)
+				pass.assignedQueue = EQueueType::eGraphic;
+			pass.crossQueueWaits.clear();
+		}
+
+		vector<UInt32> stack;
+		vector<UInt32> visited;
+		for (UInt32 i = 0; i < mPasses.size(); ++i)
+		{
+			auto& pass = mPasses[i];
+			if (pass.bCulled)
+				continue;
+
+			// the culled passes do nothing, wait for the live passes they depend on instead.
+			stack.assign(pass.dependencies.begin(), pass.dependencies.end());
+			visited.clear();
+			while (!stack.empty())
+			{
+				const UInt32 dependency = stack.back();
+				stack.pop_back();
+				if (_Contains(visited, dependency))
+					continue;
+				visited.push_back(dependency);
+
+				const auto& depPass = mPasses[dependency];
+				if (depPass.bCulled)
+					stack.insert(stack.end(), depPass.dependencies.begin(), depPass.dependencies.end());
+				else if (depPass.assignedQueue != pass.assignedQueue)
+					pass.crossQueueWaits.push_back(dependency);
+			}
+		}
+	}
+
+	void RenderGraphCompiler::ComputeLifetimes()
+	{
+		for (auto& resource : mResources)
+		{
+			resource.firstPosition = INVALID_INDEX;
+			resource.lastPosition = INVALID_INDEX;
+			resource.bTransient = false;
+		}
+
+		auto UseResource = [this](UInt32 resource, UInt32 position, bool bOnlyWrite)
+		{
+			auto& record = mResources[resource];
+			if (record.firstPosition == INVALID_INDEX)
+			{
+				record.firstPosition = position;
+				record.bTransient = bOnlyWrite;
+			}
+			record.lastPosition = position;
+		};
+
+		for (UInt32 position = 0; position < mExecutionOrder.size(); ++position)
+		{
+			const auto& pass = mPasses[mExecutionOrder[position]];
+			for (auto resource : pass.reads)
+				UseResource(resource, position, false);
+			for (auto resource : pass.writes)
+				UseResource(resource, position, !_Contains(pass.reads, resource));
+		}
+
+		for (auto& resource : mResources)
+		{
+			if (resource.bOutput)
+				resource.bTransient = false;
+		}
+	}
+
+	UInt32 RenderGraphCompiler::FindEnabledWriter(UInt32 resource, UInt32 pass) const
+	{
+		const auto& writers = mResources[resource].writers;
+		for (auto iter = writers.rbegin(); iter != writers.rend(); ++iter)
+		{
+			if (*iter < pass && mPasses[*iter].bEnabled)
+				return *iter;
+		}
+		return INVALID_INDEX;
+	}
+
+}
\ No newline at end of file
@@ -6,15 +6,116 @@
 #include "System/Logger.h"
 #include "Memory/Memory.h"
 #include "Render/Shader/ShaderLibrary.h"
+#include "Thread/IJobSystem.h"
 #include "Profile/Profile.h"
 
 #include "spirv-cross/spirv_cross.hpp"
 
-#include "eastl/stack.h"
+#include "Stl/Hash.h"
+#include "EASTL/stack.h"
+
+#include <string.h>
 
 namespace SG
 {
 
+	//! Options passed to the compiler for all the shaders, the includes are searched in the shader sources folder.
+	static string _GetCompileOptions()
+	{
+		string options = " -I ";
+		options += FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Sources, SG_ENGINE_DEBUG_BASE_OFFSET);
+		return options;
+	}
+
+	//! Hash the compiler and the options, all the compiled shaders are invalidated when the compiler is updated.
+	static UInt64 _HashCompiler()
+	{
+		static UInt64 sCompilerHash = 0;
+		if (sCompilerHash != 0)
+			return sCompilerHash;
+
+		const string options = _GetCompileOptions();
+		UInt64 hash = HashMemory(options.data(), options.size());
+#if SG_FORCE_USE_VULKAN_SDK
+		// the version of the sdk is in its path
+		char* vulkanSDK = nullptr;
+		Size num = 0;
+		_dupenv_s(&vulkanSDK, &num, "VULKAN_SDK");
+		if (vulkanSDK)
+		{
+			hash = HashMemory(vulkanSDK, strlen(vulkanSDK), hash);
+			free(vulkanSDK);
+		}
+#elif defined(SG_PLATFORM_WINDOWS)
+		if (FileSystem::Open(EResourceDirectory::eVendor, "glslc.exe", EFileMode::efRead_Binary, SG_ENGINE_DEBUG_BASE_OFFSET))
+		{
+			vector<Byte> compiler(FileSystem::FileSize());
+			FileSystem::Read(compiler.data(), compiler.size());
+			FileSystem::Close();
+			hash = HashMemory(compiler.data(), compiler.size(), hash);
+		}
+#else
+		// the glslc in the path is installed by the vulkan sdk, the version of the sdk is in its path
+		if (const char* vulkanSDK = getenv("VULKAN_SDK"))
+			hash = HashMemory(vulkanSDK, strlen(vulkanSDK), hash);
+#endif
+		sCompilerHash = hash;
+		return sCompilerHash;
+	}
+
+	// change it when the schema of the reflection changes, the reflections in the ShaderLibrary are made again.
+	static constexpr UInt32 SG_SHADER_REFLECTION_VERSION = 1;
+
+	static void _WriteUInt32(vector<Byte>& data, UInt32 value)
+	{
+		const Byte* pBytes = reinterpret_cast<const Byte*>(&value);
+		data.insert(data.end(), pBytes, pBytes + sizeof(UInt32));
+	}
+
+	static void _WriteString(vector<Byte>& data, const string& str)
+	{
+		_WriteUInt32(data, static_cast<UInt32>(str.size()));
+		const Byte* pBytes = reinterpret_cast<const Byte*>(str.data());
+		data.insert(data.end(), pBytes, pBytes + str.size());
+	}
+
+	namespace // anonymous namespace
+	{
+		//! Read the reflection written by ShaderCompiler::ReflectStage(), bValid is false once it reads out of the data.
+		struct ReflectionReader
+		{
+			const vector<Byte>& data;
+			Size offset = 0;
+			bool bValid = true;
+
+			UInt32 ReadUInt32()
+			{
+				UInt32 value = 0;
+				if (!bValid || sizeof(UInt32) > data.size() - offset)
+				{
+					bValid = false;
+					return 0;
+				}
+				memcpy(&value, data.data() + offset, sizeof(UInt32));
+				offset += sizeof(UInt32);
+				return value;
+			}
+
+			string ReadString()
+			{
+				const UInt32 length = ReadUInt32();
+				if (!bValid || length > data.size() - offset)
+				{
+					bValid = false;
+					return "";
+				}
+				string str(reinterpret_cast<const char*>(data.data() + offset), length);
+				offset += length;
+				return str;
+			}
+		};
+	}
+
 	static EShaderDataType _SPIRVTypeToShaderDataType(const spirv_cross::SPIRType& type)
 	{
 		if (type.basetype == spirv_cross::SPIRType::Float)
@@ -130,196 +231,245 @@ namespace SG
 		return ReflectSPIRV(pShader);
 	}
 
+	//! A stage whose SPIR-V is not in the ShaderLibrary, it is compiled by a compiler process.
+	//! The stage shared by several requests is compiled once.
+	struct ShaderCompiler::PendingStage
+	{
+		vector<UInt32> requestIndices;
+		UInt32 stage;
+		UInt64 key;
+		string actualName;
+		string compiledName;
+		string logName;
+		string logPath;
+		string command;
+		int    exitCode;
+	};
+
 	bool ShaderCompiler::CompileGLSLShader(const string& binShaderName, RefPtr<Shader> pShader)
 	{
 		SG_PROFILE_FUNCTION();
 
-		UInt8 shaderBits = 0;
-		FileSystem::ExistOrCreate(EResourceDirectory::eShader_Binarires, ""); // create ShaderBin folder if it doesn't exist
+		vector<ShaderCompileRequest> requests(1);
+		requests[0].shaderName = binShaderName;
+		requests[0].pShader = pShader;
+		return CompileGLSLShaders(requests);
+	}
 
-		string folderPath = "";
-		Size beginPos = 0;
-		Size slashPos = binShaderName.find_first_of('/', beginPos);
-		while (slashPos != string::npos) // this shader is inside a folder
-		{
-			folderPath += binShaderName.substr(beginPos, slashPos - beginPos + 1);
-			beginPos = slashPos + 1;
-			slashPos = binShaderName.find_first_of('/', beginPos);
-		}
-		FileSystem::ExistOrCreate(EResourceDirectory::eShader_Binarires, folderPath); // create folders in ShaderBin
+	bool ShaderCompiler::CompileGLSLShader(const string& vertShaderName, const string& fragShaderName, RefPtr<Shader> pShader)
+	{
+		SG_PROFILE_FUNCTION();
 
-		for (UInt32 i = 0; i < (UInt32)EShaderStage::NUM_STAGES; ++i)
+		vector<ShaderCompileRequest> requests(1);
+		requests[0].shaderName = vertShaderName;
+		requests[0].fragShaderName = fragShaderName;
+		requests[0].pShader = pShader;
+		return CompileGLSLShaders(requests);
+	}
+
+	bool ShaderCompiler::CompileGLSLShaders(vector<ShaderCompileRequest>& requests)
+	{
+		SG_PROFILE_FUNCTION();
+
+		// take the stages from the ShaderLibrary, and collect the others to compile
+		vector<PendingStage> pendings;
+		vector<UInt8> shaderBits(requests.size(), 0);
+		for (UInt32 i = 0; i < requests.size(); ++i)
 		{
-			string extension;
-			switch (i)
+			auto& request = requests[i];
+			request.bSucceeded = false;
+			request.diagnostics.clear();
+
+			if (request.fragShaderName.empty())
+			{
+				for (UInt32 stage = 0; stage < (UInt32)EShaderStage::NUM_STAGES; ++stage)
+				{
+					if (PrepareStage(request.shaderName, stage, i, request.pShader, pendings))
+						shaderBits[i] |= (1 << stage);
+				}
+			}
+			else
 			{
-			case 0: extension = ".vert"; break;
-			case 1:	extension = ".tesc"; break;
-			case 2:	extension = ".tese"; break;
-			case 3:	extension = ".geom"; break;
-			case 4:	extension = ".frag"; break;
-			case 5:	extension = ".comp"; break;
+				if (PrepareStage(request.shaderName, 0, i, request.pShader, pendings))
+					shaderBits[i] |= (1 << 0);
+				if (PrepareStage(request.fragShaderName, 4, i, request.pShader, pendings))
+					shaderBits[i] |= (1 << 4);
 			}
+		}
 
-			string actualName = binShaderName + extension;
-			if (FileSystem::Exist(EResourceDirectory::eShader_Sources, actualName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET))
+		// compile all the pending stages at the same time, a compiler process is run by each of the job workers and the main thread.
+		if (!pendings.empty())
+		{
+			auto runCompiler = [&pendings](UInt32 index)
+			{
+				auto& pending = pendings[index];
+				pending.exitCode = System::RunProcess(pending.command, pending.logPath.c_str());
+			};
+			SJobHandle handle = JobSystem::ParallelFor(static_cast<UInt32>(pendings.size()), 1, runCompiler);
+			JobSystem::CompleteAndDispose(handle);
+
+			// the diagnostics and the SPIR-V are read on this thread, the FileSystem can only open one file at a time.
+			for (auto& pending : pendings)
 			{
-				bool bForceToRecompile = false;
-				// Get the time stamp of this shader to check if this shader should force to recompile.
-				TimePoint prevTp = ShaderLibrary::GetInstance()->GetShaderTimeStamp(actualName);
-				TimePoint currTp = FileSystem::GetFileLastWriteTime(EResourceDirectory::eShader_Sources, actualName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET);
-				if (!prevTp.IsValid() || currTp > prevTp) // invalid means we can't find shader_env.ini, so you should recompile the shader anyway.
+				if (FinishStage(pending, requests))
 				{
-					bForceToRecompile = true;
-					SG_LOG_DEBUG("Force to compile: %s", actualName.c_str());
+					for (UInt32 requestIndex : pending.requestIndices)
+						shaderBits[requestIndex] |= (1 << pending.stage);
 				}
+			}
+		}
 
-				string compiledName = actualName;
-				compiledName[actualName.find('.')] = '-';
-				compiledName += ".spv";
-
-				// Skip this to force recompile shader.
-				if (!bForceToRecompile && FileSystem::Exist(EResourceDirectory::eShader_Binarires, compiledName.c_str())) // already compiled this shader once, skip it.
+		bool bAllSucceeded = true;
+		for (UInt32 i = 0; i < requests.size(); ++i)
+		{
+			auto& request = requests[i];
+			if (request.fragShaderName.empty())
+			{
+				if (shaderBits[i] == 0)
 				{
-					shaderBits |= (1 << i); // mark as exist.
+					SG_LOG_ERROR("No GLSL shader is compiled! (%s)", request.shaderName.c_str());
+					bAllSucceeded = false;
 					continue;
 				}
-
-				string pOut = FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Binarires) + binShaderName + "-" +
-					extension.substr(1, extension.size() - 1) + "-compile.log";
-
-#if SG_FORCE_USE_VULKAN_SDK
-				if (CompileShaderVkSDK(actualName, compiledName, pOut))
-#else
-				if (CompileShaderVendor(actualName, compiledName, pOut))
-#endif
+				for (UInt32 stage = 0; stage < (UInt32)EShaderStage::NUM_STAGES; ++stage)
+					request.pShader->mShaderStages[EShaderStage(1 << stage)].name = request.shaderName;
+			}
+			else
+			{
+				if ((shaderBits[i] & (1 << 0)) == 0 || (shaderBits[i] & (1 << 4)) == 0) // if vert or frag stage is missing
 				{
-					Size splitPos = pOut.find_last_of('/');
-					if (!CheckCompileError(actualName, folderPath + pOut.substr(splitPos + 1, pOut.size() - splitPos - 1)))
-						shaderBits |= (1 << i); // record what shader stage we had compiled
+					request.pShader->mShaderStages.clear();
+
+					SG_LOG_WARN("Necessary shader stages(vert or frag) is/are missing! (vert: %s, frag: %s)", request.shaderName.c_str(), request.fragShaderName.c_str());
+					bAllSucceeded = false;
+					continue;
 				}
-				else
-					SG_LOG_ERROR("Failed to run shader compiler!");
+				request.pShader->mShaderStages[EShaderStage::efVert].name = request.shaderName;
+				request.pShader->mShaderStages[EShaderStage::efFrag].name = request.fragShaderName;
 			}
-		}
-
-		if (shaderBits == 0)
-			return false;
 
-		return LoadSPIRVShader(binShaderName, pShader);
+			request.bSucceeded = ReflectSPIRV(request.pShader);
+			bAllSucceeded &= request.bSucceeded;
+		}
+		return bAllSucceeded;
 	}
 
-	bool ShaderCompiler::CompileGLSLShader(const string& vertShaderName, const string& fragShaderName, RefPtr<Shader> pShader)
+	bool ShaderCompiler::PrepareStage(const string& shaderName, UInt32 stage, UInt32 requestIndex, RefPtr<Shader> pShader, vector<PendingStage>& outPendings)
 	{
 		SG_PROFILE_FUNCTION();
 
-		UInt8 shaderBits = 0;
-		FileSystem::ExistOrCreate(EResourceDirectory::eShader_Binarires, ""); // create ShaderBin folder if it doesn't exist
-
-		string vertActualName = vertShaderName + ".vert";
-		if (FileSystem::Exist(EResourceDirectory::eShader_Sources, vertActualName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET))
+		string extension;
+		switch (stage)
 		{
-			string folderPath = "";
-			Size beginPos = 0;
-			Size slashPos = vertShaderName.find_first_of('/', beginPos);
-			while (slashPos != string::npos) // this shader is inside a folder
-			{
-				folderPath += vertShaderName.substr(beginPos, slashPos - beginPos + 1);
-				beginPos = slashPos + 1;
-				slashPos = vertShaderName.find_first_of('/', beginPos);
-			}
-			FileSystem::ExistOrCreate(EResourceDirectory::eShader_Binarires, folderPath); // create folders in ShaderBin
-
-			bool bForceToRecompile = false;
-			// Get the time stamp of this shader to check if this shader should force to recompile.
-			TimePoint prevTp = ShaderLibrary::GetInstance()->GetShaderTimeStamp(vertActualName);
-			TimePoint currTp = FileSystem::GetFileLastWriteTime(EResourceDirectory::eShader_Sources, vertActualName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET);
-			if (!prevTp.IsValid() || currTp > prevTp) // invalid means we can't find shader_env.ini, so you should recompile the shader anyway.
-			{
-				bForceToRecompile = true;
-				SG_LOG_DEBUG("Force to compile: %s", vertActualName.c_str());
-			}
+		case 0: extension = "vert"; break;
+		case 1:	extension = "tesc"; break;
+		case 2:	extension = "tese"; break;
+		case 3:	extension = "geom"; break;
+		case 4:	extension = "frag"; break;
+		case 5:	extension = "comp"; break;
+		}
 
-			string vertCompiledName = vertActualName;
-			vertCompiledName[vertActualName.find('.')] = '-';
-			vertCompiledName += ".spv";
+		const string actualName = shaderName + "." + extension;
+		if (!FileSystem::Exist(EResourceDirectory::eShader_Sources, actualName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET))
+			return false;
 
-			if (!bForceToRecompile && FileSystem::Exist(EResourceDirectory::eShader_Binarires, vertCompiledName.c_str())) // already compiled this shader once, skip it.
-			{
-				shaderBits |= (1 << 0); // mark as exist.
-			}
-			else
-			{
-				string pOut = FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Binarires) + vertShaderName + "-vert-compile.log";
+		// the stage is compiled again only if its source, the sources it includes or the compiler had changed.
+		ShaderLibrary* pLibrary = ShaderLibrary::GetInstance();
+		const UInt64 sourceHash = pLibrary->HashSourceWithIncludes(actualName);
+		if (sourceHash == 0)
+		{
+			SG_LOG_ERROR("Failed to read shader source: %s", actualName.c_str());
+			return false;
+		}
+		const UInt64 key = HashMemory(&sourceHash, sizeof(UInt64), _HashCompiler());
 
-#if SG_FORCE_USE_VULKAN_SDK
-				if (CompileShaderVkSDK(vertActualName, vertCompiledName, pOut))
-#else
-				if (CompileShaderVendor(vertActualName, vertCompiledName, pOut))
-#endif
-				{
-					Size splitPos = pOut.find_last_of('/');
-					if (!CheckCompileError(vertActualName, folderPath + pOut.substr(splitPos + 1, pOut.size() - splitPos - 1)))
-						shaderBits |= (1 << 0); // record what shader stage we had compiled
-				}
-				else
-					SG_LOG_ERROR("Failed to run shader compiler!");
-			}
+		vector<Byte> binary;
+		if (pLibrary->FindBinary(key, binary))
+		{
+			pShader->mShaderStages[(EShaderStage)(1 << stage)] = {}; // insert a null vector
+			pShader->mShaderStages[(EShaderStage)(1 << stage)].binary = eastl::move(binary);
+			return true;
 		}
 
-		string fragActualName = fragShaderName + ".frag";
-		if (FileSystem::Exist(EResourceDirectory::eShader_Sources, fragActualName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET))
+		for (auto& pending : outPendings)
 		{
-			string folderPath = "";
-			Size beginPos = 0;
-			Size slashPos = fragActualName.find_first_of('/', beginPos);
-			while (slashPos != string::npos) // this shader is inside a folder
+			if (pending.actualName == actualName) // already compiled for another request
 			{
-				folderPath += fragActualName.substr(beginPos, slashPos - beginPos + 1);
-				beginPos = slashPos + 1;
-				slashPos = fragActualName.find_first_of('/', beginPos);
+				pending.requestIndices.push_back(requestIndex);
+				return false;
 			}
-			FileSystem::ExistOrCreate(EResourceDirectory::eShader_Binarires, folderPath); // create folders in ShaderBin
+		}
 
-			bool bForceToRecompile = false;
-			// Get the time stamp of this shader to check if this shader should force to recompile.
-			TimePoint prevTp = ShaderLibrary::GetInstance()->GetShaderTimeStamp(fragActualName);
-			TimePoint currTp = FileSystem::GetFileLastWriteTime(EResourceDirectory::eShader_Sources, fragActualName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET);
-			if (currTp > prevTp)
-			{
-				bForceToRecompile = true;
-				SG_LOG_DEBUG("Force to compile: %s", fragActualName.c_str());
-			}
+		vector<string> changedSources;
+		pLibrary->GetChangedSources(actualName, changedSources);
+		string changedNames;
+		for (const auto& source : changedSources)
+			changedNames += " " + source;
+		SG_LOG_DEBUG("Compile: %s (changed:%s)", actualName.c_str(), changedNames.empty() ? " compiler" : changedNames.c_str());
 
-			string fragCompiledName = fragActualName;
-			fragCompiledName[fragActualName.find('.')] = '-';
-			fragCompiledName += ".spv";
+		string folderPath = "";
+		Size beginPos = 0;
+		Size slashPos = shaderName.find_first_of('/', beginPos);
+		while (slashPos != string::npos) // this shader is inside a folder
+		{
+			folderPath += shaderName.substr(beginPos, slashPos - beginPos + 1);
+			beginPos = slashPos + 1;
+			slashPos = shaderName.find_first_of('/', beginPos);
+		}
+		FileSystem::ExistOrCreate(EResourceDirectory::eShader_Binarires, ""); // create ShaderBin folder if it doesn't exist
+		FileSystem::ExistOrCreate(EResourceDirectory::eShader_Binarires, folderPath); // create folders in ShaderBin
 
-			if (!bForceToRecompile && FileSystem::Exist(EResourceDirectory::eShader_Binarires, fragCompiledName.c_str())) // already compiled this shader once, skip it.
-				shaderBits |= (1 << 4); // mark as exist.
-			else
-			{
-				string pOut = FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Binarires) + fragShaderName + "-frag-compile.log";
+		PendingStage pending;
+		pending.requestIndices.push_back(requestIndex);
+		pending.stage = stage;
+		pending.key = key;
+		pending.actualName = actualName;
+		pending.compiledName = shaderName + "-" + extension + ".spv";
+		pending.logName = shaderName + "-" + extension + "-compile.log";
+		pending.logPath = FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Binarires) + pending.logName;
+		pending.command = GetCompileCommand(pending.actualName, pending.compiledName);
+		pending.exitCode = -1;
+		outPendings.push_back(eastl::move(pending));
+		return false;
+	}
 
-#if SG_FORCE_USE_VULKAN_SDK
-				if (CompileShaderVkSDK(fragActualName, fragCompiledName, pOut))
-#else
-				if (CompileShaderVendor(fragActualName, fragCompiledName, pOut))
-#endif
-				{
-					Size splitPos = pOut.find_last_of('/');
-					if (!CheckCompileError(fragActualName, folderPath + pOut.substr(splitPos + 1, pOut.size() - splitPos - 1)))
-						shaderBits |= (1 << 4); // record what shader stage we had compiled
-				}
-				else
-					SG_LOG_ERROR("Failed to run shader compiler!");
-			}
+	bool ShaderCompiler::FinishStage(const PendingStage& pending, vector<ShaderCompileRequest>& requests)
+	{
+		SG_PROFILE_FUNCTION();
+
+		bool bSucceeded = false;
+		string diagnostics;
+		auto& firstRequest = requests[pending.requestIndices.front()];
+		if (pending.exitCode == -1)
+		{
+			SG_LOG_ERROR("Failed to run shader compiler! (%s)", pending.actualName.c_str());
+			diagnostics = pending.actualName + ": failed to run shader compiler\n";
+			FileSystem::RemoveFile(EResourceDirectory::eShader_Binarires, pending.logName);
+		}
+		else
+		{
+			UInt8 shaderBits = 0;
+			bSucceeded = !CheckCompileError(pending.actualName, pending.logName, pending.exitCode, diagnostics) &&
+				ReadInShaderData(pending.compiledName, pending.stage, firstRequest.pShader, shaderBits);
 		}
 
-		if (shaderBits == 0)
+		for (UInt32 requestIndex : pending.requestIndices)
+			requests[requestIndex].diagnostics += diagnostics;
+		if (!bSucceeded)
 			return false;
 
-		return LoadSPIRVShader(vertShaderName, fragShaderName, pShader);
+		const auto& binary = firstRequest.pShader->mShaderStages[(EShaderStage)(1 << pending.stage)].binary;
+		ShaderLibrary::GetInstance()->AddBinary(pending.key, binary);
+		for (UInt32 requestIndex : pending.requestIndices)
+		{
+			auto& request = requests[requestIndex];
+			if (request.pShader != firstRequest.pShader)
+			{
+				request.pShader->mShaderStages[(EShaderStage)(1 << pending.stage)] = {}; // insert a null vector
+				request.pShader->mShaderStages[(EShaderStage)(1 << pending.stage)].binary = binary;
+			}
+		}
+		return true;
 	}
 
 	bool ShaderCompiler::ReadInShaderData(const string& name, UInt32 stage, RefPtr<Shader> pShader, UInt8& checkFlag)
@@ -342,72 +492,59 @@ namespace SG
 		return false;
 	}
 
-	bool ShaderCompiler::CompileShaderVkSDK(const string& actualName, const string& compiledName, const string& pOut)
+	string ShaderCompiler::GetCompileCommand(const string& actualName, const string& compiledName)
 	{
 		SG_PROFILE_FUNCTION();
 
+#if SG_FORCE_USE_VULKAN_SDK
 		char* glslc = "";
 		Size num = 1;
 		_dupenv_s(&glslc, &num, "VULKAN_SDK");
-		string exePath = glslc;
-		exePath += "\\Bin32\\glslc.exe ";
-
-		string shaderPath = FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Sources, SG_ENGINE_DEBUG_BASE_OFFSET);
-		shaderPath += actualName;
-		string outputPath = FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Binarires) + compiledName;
-
-		exePath += shaderPath;
-		exePath += " -o ";
-		exePath += outputPath;
-
-		const char* args[3] = { shaderPath.c_str(), "-o", outputPath.c_str() };
-
-		// create a process to use vulkanSDK to compile shader sources to binary (spirv)
-		if (SSystem()->RunProcess(exePath, pOut.c_str()) != 0)
-			return false;
-		return true;
-	}
-
-	bool ShaderCompiler::CompileShaderVendor(const string& actualName, const string& compiledName, const string& pOut)
-	{
-		SG_PROFILE_FUNCTION();
-
-		string exePath = FileSystem::GetResourceFolderPath(EResourceDirectory::eVendor, SG_ENGINE_DEBUG_BASE_OFFSET);
-		exePath += "glslc.exe ";
+		string command = glslc;
+		command += "\\Bin32\\glslc.exe ";
+#elif defined(SG_PLATFORM_WINDOWS)
+		string command = FileSystem::GetResourceFolderPath(EResourceDirectory::eVendor, SG_ENGINE_DEBUG_BASE_OFFSET);
+		command += "glslc.exe ";
+#else
+		string command = "glslc "; // the vendor compiler is for windows, use the one installed by the vulkan sdk.
+#endif
 
 		string shaderPath = FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Sources, SG_ENGINE_DEBUG_BASE_OFFSET);
 		shaderPath += actualName;
 		string outputPath = FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Binarires) + compiledName;
 
-		exePath += shaderPath;
-		exePath += " -o ";
-		exePath += outputPath;
-
-		const char* args[3] = { shaderPath.c_str(), "-o", outputPath.c_str() };
-
-		// create a process to use vulkanSDK to compile shader sources to binary (spirv)
-		if (SSystem()->RunProcess(exePath, pOut.c_str()) != 0)
-			return false;
-		return true;
+		command += shaderPath;
+		command += " -o ";
+		command += outputPath;
+		command += _GetCompileOptions();
+		return command;
 	}
 
-	bool ShaderCompiler::CheckCompileError(const string& actualName, const string& outputMessage)
+	bool ShaderCompiler::CheckCompileError(const string& actualName, const string& outputMessage, int exitCode, string& outDiagnostics)
 	{
 		SG_PROFILE_FUNCTION();
 
-		bool bHaveError = false;
-		if (FileSystem::FileSize(EResourceDirectory::eShader_Binarires, outputMessage) != 0) // failed to compile shader, log out the error message
+		const bool bHaveError = (exitCode != 0);
+		if (FileSystem::FileSize(EResourceDirectory::eShader_Binarires, outputMessage) != 0) // log out the error or the warning message
 		{
-			bHaveError = true;
 			if (FileSystem::Open(EResourceDirectory::eShader_Binarires, outputMessage.c_str(), EFileMode::efRead))
 			{
 				string errorMessage = "";
 				errorMessage.resize(FileSystem::FileSize());
 				FileSystem::Read(errorMessage.data(), errorMessage.size() * sizeof(char));
-				SG_LOG_ERROR("Failed to compile shader: %s\n%s", actualName.c_str(), errorMessage.c_str());
+				if (bHaveError)
+					SG_LOG_ERROR("Failed to compile shader: %s\n%s", actualName.c_str(), errorMessage.c_str());
+				else
+					SG_LOG_WARN("Compiled shader with warnings: %s\n%s", actualName.c_str(), errorMessage.c_str());
+				outDiagnostics += actualName + ":\n" + errorMessage;
 				FileSystem::Close();
 			}
 		}
+		else if (bHaveError)
+		{
+			SG_LOG_ERROR("Failed to compile shader: %s (exit code: %d)", actualName.c_str(), exitCode);
+			outDiagnostics += actualName + ": compiler exited with code " + eastl::to_string(exitCode) + "\n";
+		}
 		if (!FileSystem::RemoveFile(EResourceDirectory::eShader_Binarires, outputMessage))
 			SG_LOG_DEBUG("Failed to remove file: %s", outputMessage.c_str());
 		return bHaveError;
@@ -417,81 +554,121 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-		for (auto& beg = pShader->mShaderStages.begin(); beg != pShader->mShaderStages.end(); ++beg)
+		ShaderLibrary* pLibrary = ShaderLibrary::GetInstance();
+		for (auto beg = pShader->mShaderStages.begin(); beg != pShader->mShaderStages.end(); ++beg)
 		{
 			auto& shaderData = beg->second;
 			if (shaderData.binary.empty())
 				continue;
 
-			spirv_cross::Compiler compiler(reinterpret_cast<const UInt32*>(shaderData.binary.data()), shaderData.binary.size() / sizeof(UInt32));
-			auto& stageData = compiler.get_entry_points_and_stages();
+			// the same SPIR-V always has the same reflection, so spirv-cross only runs on the SPIR-V never reflected.
+			const UInt32 reflectionVersion = SG_SHADER_REFLECTION_VERSION;
+			const UInt64 binaryHash = HashMemory(shaderData.binary.data(), shaderData.binary.size(), HashMemory(&reflectionVersion, sizeof(UInt32)));
+			vector<Byte> reflection;
+			if (pLibrary->FindReflection(binaryHash, reflection))
+			{
+#if SG_VALIDATE_SHADER_REFLECTION
+				vector<Byte> validReflection;
+				ReflectStage(shaderData.binary, validReflection);
+				if (validReflection != reflection)
+				{
+					SG_LOG_ERROR("Cached reflection of shader is different from the one of spirv-cross: %s", shaderData.name.c_str());
+					SG_ASSERT(false);
+					reflection = eastl::move(validReflection);
+					pLibrary->AddReflection(binaryHash, reflection);
+				}
+#endif
+			}
+			else
+			{
+				ReflectStage(shaderData.binary, reflection);
+				pLibrary->AddReflection(binaryHash, reflection);
+			}
 
-			// we only have one shader stage compile once for now.
-			spv::ExecutionModel executionModel = {};
-			for (auto& data : stageData)
+			if (!ApplyReflection(reflection, beg->first, *pShader))
 			{
-				pShader->mEntryPoint = data.name.c_str();
-				executionModel = data.execution_model;
+				SG_LOG_ERROR("Failed to read the reflection of shader: %s", shaderData.name.c_str());
+				return false;
 			}
+		}
 
-			spirv_cross::ShaderResources shaderResources = compiler.get_shader_resources();
+		return true;
+	}
 
-			// shader stage input collection
-			if (executionModel == spv::ExecutionModelVertex) // for now, we only collect the attributes of vertex stage
-			{
-				OrderSet<ShaderAttributesLayout::ElementType> orderedInputLayout;
-				for (auto& input : shaderResources.stage_inputs) // collect shader stage input info
-				{
-					const auto& type = compiler.get_type(input.type_id);
-					const auto location = compiler.get_decoration(input.id, spv::DecorationLocation);
-					orderedInputLayout.emplace(location, ShaderAttributesLayout::ElementType{ _SPIRVTypeToShaderDataType(type), input.name.c_str() });
-				}
+	void ShaderCompiler::ReflectStage(const Shader::ShaderBinaryType& binary, vector<Byte>& outReflection)
+	{
+		SG_PROFILE_FUNCTION();
+
+		spirv_cross::Compiler compiler(reinterpret_cast<const UInt32*>(binary.data()), binary.size() / sizeof(UInt32));
+		const auto stageData = compiler.get_entry_points_and_stages();
+
+		// we only have one shader stage compile once for now.
+		string entryPoint = "main";
+		spv::ExecutionModel executionModel = {};
+		for (auto& data : stageData)
+		{
+			entryPoint = data.name.c_str();
+			executionModel = data.execution_model;
+		}
+		_WriteString(outReflection, entryPoint);
+
+		spirv_cross::ShaderResources shaderResources = compiler.get_shader_resources();
 
-				for (auto& element : orderedInputLayout)
-					shaderData.stageInputLayout.Emplace(eastl::move(element.second));
+		// shader stage input collection
+		OrderSet<eastl::pair<EShaderDataType, string>> orderedInputLayout;
+		if (executionModel == spv::ExecutionModelVertex) // for now, we only collect the attributes of vertex stage
+		{
+			for (auto& input : shaderResources.stage_inputs) // collect shader stage input info
+			{
+				const auto& type = compiler.get_type(input.type_id);
+				const auto location = compiler.get_decoration(input.id, spv::DecorationLocation);
+				orderedInputLayout.emplace(location, eastl::make_pair(_SPIRVTypeToShaderDataType(type), string(input.name.c_str())));
 			}
+		}
+		_WriteUInt32(outReflection, static_cast<UInt32>(orderedInputLayout.size()));
+		for (auto& element : orderedInputLayout)
+		{
+			_WriteUInt32(outReflection, static_cast<UInt32>(element.second.first));
+			_WriteString(outReflection, element.second.second);
+		}
 
-			// shader push constants collection
-			for (auto& pushConstant : shaderResources.push_constant_buffers)
+		// shader push constants collection
+		vector<eastl::pair<EShaderDataType, string>> pushConstants;
+		for (auto& pushConstant : shaderResources.push_constant_buffers)
+		{
+			const auto& type = compiler.get_type(pushConstant.type_id);
+			if (type.basetype == spirv_cross::SPIRType::Struct)
 			{
-				const auto& type = compiler.get_type(pushConstant.type_id);
-				if (type.basetype == spirv_cross::SPIRType::Struct)
+				for (UInt32 i = 0; i < type.member_types.size(); ++i)
 				{
-					for (UInt32 i = 0; i < type.member_types.size(); ++i)
-					{
-						const auto memberTypeID = type.member_types[i];
-						const char* name = compiler.get_member_name(type.self, i).c_str();
-						const auto& memberType = compiler.get_type(memberTypeID);
-						shaderData.pushConstantLayout.Emplace(_SPIRVTypeToShaderDataType(memberType), name);
-					}
-				}
-				else
-				{
-					const char* name = compiler.get_name(pushConstant.id).c_str();
-					shaderData.pushConstantLayout.Emplace(_SPIRVTypeToShaderDataType(type), name);
+					const auto memberTypeID = type.member_types[i];
+					const auto& memberType = compiler.get_type(memberTypeID);
+					pushConstants.emplace_back(_SPIRVTypeToShaderDataType(memberType), compiler.get_member_name(type.self, i).c_str());
 				}
 			}
+			else
+				pushConstants.emplace_back(_SPIRVTypeToShaderDataType(type), compiler.get_name(pushConstant.id).c_str());
+		}
+		_WriteUInt32(outReflection, static_cast<UInt32>(pushConstants.size()));
+		for (auto& element : pushConstants)
+		{
+			_WriteUInt32(outReflection, static_cast<UInt32>(element.first));
+			_WriteString(outReflection, element.second);
+		}
 
-			// shader uniform buffers collection
-			for (auto& ubo : shaderResources.uniform_buffers)
+		// shader uniform buffers and storage buffers collection, the members of the nested structures are flatten.
+		auto writeBuffers = [&compiler, &outReflection](const spirv_cross::SmallVector<spirv_cross::Resource>& buffers)
+		{
+			_WriteUInt32(outReflection, static_cast<UInt32>(buffers.size()));
+			for (auto& buffer : buffers)
 			{
-				const auto& type = compiler.get_type(ubo.type_id);
-				const char* name = compiler.get_name(ubo.id).c_str();
-				const auto set = compiler.get_decoration(ubo.id, spv::DecorationDescriptorSet);
-				pShader->mSetIndices.emplace(set);
-				const auto binding = compiler.get_decoration(ubo.id, spv::DecorationBinding);
-				const UInt32 key = set * 10 + binding; // calculate key value for the set and binding
+				_WriteString(outReflection, compiler.get_name(buffer.id).c_str());
+				_WriteUInt32(outReflection, compiler.get_decoration(buffer.id, spv::DecorationDescriptorSet));
+				_WriteUInt32(outReflection, compiler.get_decoration(buffer.id, spv::DecorationBinding));
 
-				if (pShader->mUniformBufferLayout.Exist(name)) // may be another stage is using it, too.
-				{
-					auto& data = pShader->mUniformBufferLayout.Get(name);
-					data.stage = data.stage | beg->first;
-					continue;
-				}
-
-				ShaderAttributesLayout layout = {};
+				vector<eastl::pair<EShaderDataType, string>> members;
 				eastl::stack<spirv_cross::SPIRType> memberTypes;
-				memberTypes.push(type);
+				memberTypes.push(compiler.get_type(buffer.type_id));
 				while (!memberTypes.empty())
 				{
 					auto currentType = memberTypes.top();
@@ -500,74 +677,110 @@ namespace SG
 					for (UInt32 i = 0; i < currentType.member_types.size(); ++i)
 					{
 						const auto memberTypeID = currentType.member_types[i];
-						const char* memberName = compiler.get_member_name(currentType.self, i).c_str();
 						const auto& memberType = compiler.get_type(memberTypeID);
 
 						if (memberType.basetype != spirv_cross::SPIRType::Struct)
-							layout.Emplace(_SPIRVTypeToShaderDataType(memberType), memberName);
+							members.emplace_back(_SPIRVTypeToShaderDataType(memberType), compiler.get_member_name(currentType.self, i).c_str());
 						else
 							memberTypes.push(memberType);
 					}
 				}
 
-				pShader->mUniformBufferLayout.Emplace(name, { key, layout, beg->first });
+				_WriteUInt32(outReflection, static_cast<UInt32>(members.size()));
+				for (auto& member : members)
+				{
+					_WriteUInt32(outReflection, static_cast<UInt32>(member.first));
+					_WriteString(outReflection, member.second);
+				}
 			}
+		};
+		writeBuffers(shaderResources.uniform_buffers);
+		writeBuffers(shaderResources.storage_buffers);
+
+		// shader combine sampler image collection
+		_WriteUInt32(outReflection, static_cast<UInt32>(shaderResources.sampled_images.size()));
+		for (auto& image : shaderResources.sampled_images)
+		{
+			_WriteString(outReflection, compiler.get_name(image.id).c_str());
+			_WriteUInt32(outReflection, compiler.get_decoration(image.id, spv::DecorationDescriptorSet));
+			_WriteUInt32(outReflection, compiler.get_decoration(image.id, spv::DecorationBinding));
+		}
+	}
+
+	bool ShaderCompiler::ApplyReflection(const vector<Byte>& reflection, EShaderStage stage, Shader& shader)
+	{
+		SG_PROFILE_FUNCTION();
+
+		ReflectionReader reader = { reflection };
+		auto& shaderData = shader.mShaderStages[stage];
 
-			// shader storage buffer collection
-			for (auto& ssbo : shaderResources.storage_buffers)
+		shader.mEntryPoint = reader.ReadString();
+
+		// the layout elements only view the names, so the names are kept by the shader.
+		auto keepName = [&shader](string&& name) -> string_view
+		{
+			shader.mLayoutNames.push_back(eastl::move(name));
+			return shader.mLayoutNames.back();
+		};
+
+		const UInt32 numStageInputs = reader.ReadUInt32();
+		for (UInt32 i = 0; i < numStageInputs && reader.bValid; ++i)
+		{
+			const auto type = static_cast<EShaderDataType>(reader.ReadUInt32());
+			shaderData.stageInputLayout.Emplace(type, keepName(reader.ReadString()));
+		}
+
+		const UInt32 numPushConstants = reader.ReadUInt32();
+		for (UInt32 i = 0; i < numPushConstants && reader.bValid; ++i)
+		{
+			const auto type = static_cast<EShaderDataType>(reader.ReadUInt32());
+			shaderData.pushConstantLayout.Emplace(type, keepName(reader.ReadString()));
+		}
+
+		auto readBuffers = [&](ShaderSetBindingAttributeLayout<GPUBufferLayout>& bufferLayout)
+		{
+			const UInt32 numBuffers = reader.ReadUInt32();
+			for (UInt32 i = 0; i < numBuffers && reader.bValid; ++i)
 			{
-				const auto& type = compiler.get_type(ssbo.type_id);
-				const char* name = compiler.get_name(ssbo.id).c_str();
-				const auto set = compiler.get_decoration(ssbo.id, spv::DecorationDescriptorSet);
-				pShader->mSetIndices.emplace(set);
-				const auto binding = compiler.get_decoration(ssbo.id, spv::DecorationBinding);
+				const string name = reader.ReadString();
+				const UInt32 set = reader.ReadUInt32();
+				const UInt32 binding = reader.ReadUInt32();
+				shader.mSetIndices.emplace(set);
 				const UInt32 key = set * 10 + binding; // calculate key value for the set and binding
 
-				if (pShader->mStorageBufferLayout.Exist(name)) // may be another stage is using it, too.
+				ShaderAttributesLayout layout = {};
+				const UInt32 numMembers = reader.ReadUInt32();
+				for (UInt32 j = 0; j < numMembers && reader.bValid; ++j)
 				{
-					auto& data = pShader->mStorageBufferLayout.Get(name);
-					data.stage = data.stage | beg->first;
-					continue;
+					const auto type = static_cast<EShaderDataType>(reader.ReadUInt32());
+					layout.Emplace(type, keepName(reader.ReadString()));
 				}
 
-				ShaderAttributesLayout layout = {};
-				eastl::stack<spirv_cross::SPIRType> memberTypes;
-				memberTypes.push(type);
-				while (!memberTypes.empty())
+				if (bufferLayout.Exist(name)) // may be another stage is using it, too.
 				{
-					auto currentType = memberTypes.top();
-					memberTypes.pop();
-
-					for (UInt32 i = 0; i < currentType.member_types.size(); ++i)
-					{
-						const auto memberTypeID = currentType.member_types[i];
-						const char* memberName = compiler.get_member_name(currentType.self, i).c_str();
-						const auto& memberType = compiler.get_type(memberTypeID);
-
-						if (memberType.basetype != spirv_cross::SPIRType::Struct)
-							layout.Emplace(_SPIRVTypeToShaderDataType(memberType), memberName);
-						else
-							memberTypes.push(memberType);
-					}
+					auto& data = bufferLayout.Get(name);
+					data.stage = data.stage | stage;
+					continue;
 				}
-
-				pShader->mStorageBufferLayout.Emplace(name, { key, layout, beg->first });
+				bufferLayout.Emplace(name, { key, layout, stage });
 			}
+		};
+		readBuffers(shader.mUniformBufferLayout);
+		readBuffers(shader.mStorageBufferLayout);
 
-			// shader combine sampler image collection
-			for (auto& image : shaderResources.sampled_images)
-			{
-				const char* name = compiler.get_name(image.id).c_str();
-				const auto set = compiler.get_decoration(image.id, spv::DecorationDescriptorSet);
-				const auto binding = compiler.get_decoration(image.id, spv::DecorationBinding);
-				const UInt32 key = set * 10 + binding; // calculate key value for the set and binding
-				pShader->mSetIndices.emplace(set);
+		const UInt32 numSampledImages = reader.ReadUInt32();
+		for (UInt32 i = 0; i < numSampledImages && reader.bValid; ++i)
+		{
+			const string name = reader.ReadString();
+			const UInt32 set = reader.ReadUInt32();
+			const UInt32 binding = reader.ReadUInt32();
+			const UInt32 key = set * 10 + binding; // calculate key value for the set and binding
+			shader.mSetIndices.emplace(set);
 
-				shaderData.sampledImageLayout.Emplace(name, key);
-			}
+			shaderData.sampledImageLayout.Emplace(name, key);
 		}
 
-		return true;
+		return reader.bValid && reader.offset == reflection.size();
 	}
 
 }
\ No newline at end of file
@@ -1,74 +1,217 @@
 #include "StdAfx.h"
 #include "Render/Shader/ShaderLibrary.h"
 
+#include "Core/Config.h"
 #include "System/Logger.h"
 #include "System/FileSystem.h"
 #include "Profile/Profile.h"
 
-#include "Stl/vector.h"
+#include "Stl/Hash.h"
+#include <EASTL/sort.h>
+#include <EASTL/hash_set.h>
+
+#include <string.h>
 
 namespace SG
 {
 
+	namespace // anonymous namespace
+	{
+		enum
+		{
+			SG_SHADER_CACHE_MAGIC = 0x43534753, // 'SGSC'
+			SG_SHADER_CACHE_VERSION = 2,
+		};
+
+		//! Followed by the sources, the binaries and the reflections.
+		//! A source is { UInt64 contentHash, UInt32 nameLength, char name[nameLength] },
+		//! a binary or a reflection is { UInt64 key, UInt64 blobHash (of the key and the blob), UInt32 lastUsedRun, UInt32 size, Byte blob[size] }.
+		//! The blob hashes start from SG_BINARY_HASH_SEED or SG_REFLECTION_HASH_SEED.
+		struct ShaderCacheFileHeader
+		{
+			UInt32 magic;
+			UInt32 version;
+			UInt32 run;         //!< The run which wrote the database.
+			UInt32 numSources;
+			UInt32 numBinaries;
+			UInt32 numReflections;
+		};
+
+		constexpr UInt64 SG_BINARY_HASH_SEED     = 0x7370697276626c62; // 'spirvblb'
+		constexpr UInt64 SG_REFLECTION_HASH_SEED = 0x7265666c65637421; // 'reflect!'
+
+		//! Hashed in place of the content of the source which can not be read.
+		constexpr UInt64 SG_MISSING_SOURCE_HASH = 0x6d697373696e6721; // 'missing!'
+
+		bool _ReadBytes(const vector<Byte>& data, Size& offset, void* pOut, Size size)
+		{
+			if (size > data.size() - offset)
+				return false;
+			if (size != 0)
+				memcpy(pOut, data.data() + offset, size);
+			offset += size;
+			return true;
+		}
+
+		void _WriteBytes(vector<Byte>& data, const void* pIn, Size size)
+		{
+			const Byte* pBytes = reinterpret_cast<const Byte*>(pIn);
+			data.insert(data.end(), pBytes, pBytes + size);
+		}
+
+		//! Collapse the "./" and the "dir/../" in the path, so that a source included in different ways has one name.
+		string _NormalizePath(const string& path)
+		{
+			vector<string> folders;
+			Size beginPos = 0;
+			while (beginPos <= path.size())
+			{
+				Size slashPos = path.find_first_of('/', beginPos);
+				if (slashPos == string::npos)
+					slashPos = path.size();
+				string folder = path.substr(beginPos, slashPos - beginPos);
+				if (folder == ".." && !folders.empty() && folders.back() != "..")
+					folders.pop_back();
+				else if (!folder.empty() && folder != ".")
+					folders.push_back(eastl::move(folder));
+				beginPos = slashPos + 1;
+			}
+
+			string normalized;
+			for (Size i = 0; i < folders.size(); ++i)
+			{
+				if (i != 0)
+					normalized += '/';
+				normalized += folders[i];
+			}
+			return normalized;
+		}
+
+		//! Parse the names in the #include directives which are not commented out.
+		void _ParseIncludes(const string& source, vector<string>& outIncludes)
+		{
+			bool bInBlockComment = false;
+			Size lineBegin = 0;
+			while (lineBegin < source.size())
+			{
+				Size lineEnd = source.find_first_of('\n', lineBegin);
+				if (lineEnd == string::npos)
+					lineEnd = source.size();
+
+				Size pos = lineBegin;
+				if (bInBlockComment)
+				{
+					const Size commentEnd = source.find("*/", lineBegin);
+					if (commentEnd == string::npos || commentEnd >= lineEnd)
+					{
+						lineBegin = lineEnd + 1;
+						continue;
+					}
+					bInBlockComment = false;
+					pos = commentEnd + 2;
+				}
+
+				while (pos < lineEnd && (source[pos] == ' ' || source[pos] == '\t'))
+					++pos;
+				if (pos < lineEnd && source[pos] == '#')
+				{
+					++pos;
+					while (pos < lineEnd && (source[pos] == ' ' || source[pos] == '\t'))
+						++pos;
+					if (source.compare(pos, 7, "include") == 0)
+					{
+						pos += 7;
+						while (pos < lineEnd && (source[pos] == ' ' || source[pos] == '\t'))
+							++pos;
+						const char closing = (pos < lineEnd && source[pos] == '<') ? '>' : '"';
+						if (pos < lineEnd && (source[pos] == '"' || source[pos] == '<'))
+						{
+							const Size nameEnd = source.find_first_of(closing, pos + 1);
+							if (nameEnd != string::npos && nameEnd < lineEnd)
+								outIncludes.push_back(source.substr(pos + 1, nameEnd - pos - 1));
+						}
+					}
+				}
+
+				// the block comment which is not closed in this line hides the next lines
+				Size commentBegin = source.find("/*", pos);
+				while (commentBegin != string::npos && commentBegin < lineEnd)
+				{
+					const Size lineComment = source.find("//", pos);
+					if (lineComment != string::npos && lineComment < commentBegin)
+						break;
+					const Size commentEnd = source.find("*/", commentBegin + 2);
+					if (commentEnd == string::npos || commentEnd >= lineEnd)
+					{
+						bInBlockComment = true;
+						break;
+					}
+					pos = commentEnd + 2;
+					commentBegin = source.find("/*", pos);
+				}
+
+				lineBegin = lineEnd + 1;
+			}
+		}
+	}
+
 	void ShaderLibrary::OnInit()
 	{
 		SG_PROFILE_FUNCTION();
 
-		// if can't find shader_env.ini, just keep the map empty.
-		if (FileSystem::Open(EResourceDirectory::eRoot, "shader_env.ini", EFileMode::efRead))
+		// if can't find the database, all the shaders are compiled from scratch.
+		vector<Byte> data;
+		if (FileSystem::Open(EResourceDirectory::eShader_Binarires, SG_SHADER_CACHE_FILE_NAME, EFileMode::efRead_Binary))
 		{
-			string str;
-			str.resize(FileSystem::FileSize());
-			FileSystem::Read(str.data(), str.size() * sizeof(char));
+			data.resize(FileSystem::FileSize());
+			if (FileSystem::Read(data.data(), data.size()) != data.size())
+				data.clear();
+			FileSystem::Close();
+		}
 
-			Size leftPos = 0;
-			Size rightPos = 0;
+		mCurrRun = 1;
+		if (data.empty())
+			return;
 
-			do 
+		Size offset = 0;
+		ShaderCacheFileHeader header = {};
+		if (!_ReadBytes(data, offset, &header, sizeof(ShaderCacheFileHeader)) ||
+			header.magic != SG_SHADER_CACHE_MAGIC || header.version != SG_SHADER_CACHE_VERSION)
+		{
+			SG_LOG_WARN("Shader cache is out of date or corrupted, all the shaders will be compiled from scratch");
+			mbDirty = true;
+			return;
+		}
+		mCurrRun = header.run + 1;
+
+		// keep what is read before the data is broken
+		bool bCorrupted = false;
+		for (UInt32 i = 0; i < header.numSources && !bCorrupted; ++i)
+		{
+			UInt64 contentHash = 0;
+			UInt32 nameLength = 0;
+			string name;
+			// a damaged length must not make us allocate more than the file holds.
+			bCorrupted = !_ReadBytes(data, offset, &contentHash, sizeof(UInt64)) || !_ReadBytes(data, offset, &nameLength, sizeof(UInt32)) ||
+				nameLength > data.size() - offset;
+			if (!bCorrupted)
 			{
-				leftPos = str.find_first_of('[', leftPos);
-				if (leftPos == string::npos)
-					break;
-				rightPos = str.find_first_of(']', rightPos + 1);
-				string name = str.substr(leftPos + 1, rightPos - leftPos - 1);
-				//SG_LOG_DEBUG("%s", name.c_str());
-
-				leftPos = str.find_first_of('[', leftPos + 1);
-				rightPos = str.find_first_of(':', rightPos + 1);
-				unsigned long year = std::strtoul(str.substr(leftPos + 1, rightPos - leftPos - 1).c_str(), nullptr, 0);
-
-				leftPos = rightPos;
-				rightPos = str.find_first_of(':', rightPos + 1);
-				unsigned long month = std::strtoul(str.substr(leftPos + 1, rightPos - leftPos - 1).c_str(), nullptr, 0);
-
-				leftPos = rightPos;
-				rightPos = str.find_first_of(']', rightPos + 1);
-				unsigned long day = std::strtoul(str.substr(leftPos + 1, rightPos - leftPos - 1).c_str(), nullptr, 0);
-
-				leftPos = str.find_first_of('[', leftPos + 1);
-				rightPos = str.find_first_of(':', rightPos + 1);
-				unsigned long hour = std::strtoul(str.substr(leftPos + 1, rightPos - leftPos - 1).c_str(), nullptr, 0);
-
-				leftPos = rightPos;
-				rightPos = str.find_first_of(':', rightPos + 1);
-				unsigned long minute = std::strtoul(str.substr(leftPos + 1, rightPos - leftPos - 1).c_str(), nullptr, 0);
-
-				leftPos = rightPos;
-				rightPos = str.find_first_of(']', rightPos + 1);
-				unsigned long second = std::strtoul(str.substr(leftPos + 1, rightPos - leftPos - 1).c_str(), nullptr, 0);
-
-				TimePoint tp = {};
-				tp.year = static_cast<UInt16>(year);
-				tp.month = static_cast<UInt16>(month);
-				tp.day = static_cast<UInt16>(day);
-				tp.hour = static_cast<UInt16>(hour);
-				tp.minute = static_cast<UInt16>(minute);
-				tp.second = static_cast<UInt16>(second);
-
-				mShaderTimePointMap[name] = eastl::move(tp);
-			} while (true);
+				name.resize(nameLength);
+				bCorrupted = !_ReadBytes(data, offset, name.data(), nameLength);
+			}
+			if (!bCorrupted)
+				mPrevSourceHashes[name] = contentHash;
+		}
 
-			FileSystem::Close();
+		if (!bCorrupted)
+			bCorrupted = !ReadBlobs(data, offset, header.numBinaries, SG_BINARY_HASH_SEED, mBinaries);
+		if (!bCorrupted)
+			bCorrupted = !ReadBlobs(data, offset, header.numReflections, SG_REFLECTION_HASH_SEED, mReflections);
+
+		if (bCorrupted)
+		{
+			SG_LOG_WARN("Shader cache is corrupted, the shaders which are lost will be compiled again");
+			mbDirty = true;
 		}
 	}
 
@@ -76,54 +219,253 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (FileSystem::Open(EResourceDirectory::eRoot, "shader_env.ini", EFileMode::efWrite))
+		for (auto& node : mSources)
 		{
-			FileSystem::TraverseFileAndSubDirectoryInFolder(EResourceDirectory::eShader_Sources, "", [](const char* filename)
-				{
-					// filename
-					string writeStr = "[";
-					writeStr += filename;
-					writeStr += "]\n";
-					// last write time data
-					TimePoint tp = FileSystem::GetFileLastWriteTime(EResourceDirectory::eShader_Sources, filename, SG_ENGINE_DEBUG_BASE_OFFSET);
-					writeStr += "[" +
-						eastl::to_string(tp.year) + ":" +
-						eastl::to_string(tp.month) + ":" +
-						eastl::to_string(tp.day) + "] [" +
-						eastl::to_string(tp.hour) + ":" +
-						eastl::to_string(tp.minute) + ":" +
-						eastl::to_string(tp.second) + "]\n";
-
-					FileSystem::Write(writeStr.data(), writeStr.size() * sizeof(char));
-				}, SG_ENGINE_DEBUG_BASE_OFFSET);
-			FileSystem::Close();
+			auto pPrev = mPrevSourceHashes.find(node.first);
+			if (pPrev == mPrevSourceHashes.end() || pPrev->second != node.second.contentHash)
+			{
+				mPrevSourceHashes[node.first] = node.second.contentHash;
+				mbDirty = true;
+			}
+		}
+
+		if (!mbDirty)
+			return;
+
+		// sort the sources, so that the same cache always produces the same file
+		vector<const eastl::pair<const string, UInt64>*> sources;
+		sources.reserve(mPrevSourceHashes.size());
+		for (auto& node : mPrevSourceHashes)
+			sources.push_back(&node);
+		eastl::sort(sources.begin(), sources.end(), [](auto* lhs, auto* rhs) { return lhs->first < rhs->first; });
+
+		ShaderCacheFileHeader header = {};
+		header.magic = SG_SHADER_CACHE_MAGIC;
+		header.version = SG_SHADER_CACHE_VERSION;
+		header.run = mCurrRun;
+		header.numSources = static_cast<UInt32>(sources.size());
+		header.numBinaries = static_cast<UInt32>(mBinaries.size());
+		header.numReflections = static_cast<UInt32>(mReflections.size());
+
+		vector<Byte> data;
+		_WriteBytes(data, &header, sizeof(ShaderCacheFileHeader));
+		for (auto* pSource : sources)
+		{
+			const UInt32 nameLength = static_cast<UInt32>(pSource->first.size());
+			_WriteBytes(data, &pSource->second, sizeof(UInt64));
+			_WriteBytes(data, &nameLength, sizeof(UInt32));
+			_WriteBytes(data, pSource->first.data(), nameLength);
 		}
+		WriteBlobs(data, mBinaries, SG_BINARY_HASH_SEED);
+		WriteBlobs(data, mReflections, SG_REFLECTION_HASH_SEED);
+
+		FileSystem::ExistOrCreate(EResourceDirectory::eShader_Binarires, ""); // create ShaderBin folder if it doesn't exist
+		if (!FileSystem::Open(EResourceDirectory::eShader_Binarires, SG_SHADER_CACHE_FILE_NAME, EFileMode::efWrite_Binary))
+		{
+			SG_LOG_WARN("Failed to write shader cache: %s", SG_SHADER_CACHE_FILE_NAME);
+			return;
+		}
+		FileSystem::Write(data.data(), data.size());
+		FileSystem::Close();
+		mbDirty = false;
 	}
 
-	void ShaderLibrary::SetShaderTimeStamp(const string& shaderName, const TimePoint& tp)
+	UInt64 ShaderLibrary::HashSourceWithIncludes(const string& sourceName)
 	{
 		SG_PROFILE_FUNCTION();
 
-		auto pNode = mShaderTimePointMap.find(shaderName);
-		if (pNode == mShaderTimePointMap.end())
+		const string name = _NormalizePath(sourceName);
+		if (!ReadSource(name))
+			return 0;
+
+		vector<string> sources;
+		CollectSources(name, sources);
+
+		const UInt32 numSources = static_cast<UInt32>(sources.size());
+		UInt64 hash = HashMemory(&numSources, sizeof(UInt32));
+		for (const auto& source : sources)
 		{
-			SG_LOG_ERROR("Failed to find the time stamp of shader: %s", shaderName);
-			return;
+			const SourceRecord* pRecord = ReadSource(source);
+			const UInt64 contentHash = pRecord ? pRecord->contentHash : SG_MISSING_SOURCE_HASH;
+			hash = HashMemory(source.data(), source.size(), hash);
+			hash = HashMemory(&contentHash, sizeof(UInt64), hash);
 		}
-		mShaderTimePointMap[shaderName] = tp;
+		return hash;
 	}
 
-	TimePoint ShaderLibrary::GetShaderTimeStamp(const string& shaderName)
+	void ShaderLibrary::GetChangedSources(const string& sourceName, vector<string>& outSources)
 	{
 		SG_PROFILE_FUNCTION();
 
-		auto pNode = mShaderTimePointMap.find(shaderName);
-		if (pNode == mShaderTimePointMap.end())
+		vector<string> sources;
+		CollectSources(_NormalizePath(sourceName), sources);
+		for (auto& source : sources)
+		{
+			const SourceRecord* pRecord = ReadSource(source);
+			auto pPrev = mPrevSourceHashes.find(source);
+			if (!pRecord || pPrev == mPrevSourceHashes.end() || pPrev->second != pRecord->contentHash)
+				outSources.push_back(eastl::move(source));
+		}
+	}
+
+	bool ShaderLibrary::FindBinary(UInt64 key, vector<Byte>& outBinary)
+	{
+		return FindBlob(mBinaries, key, outBinary);
+	}
+
+	void ShaderLibrary::AddBinary(UInt64 key, const vector<Byte>& binary)
+	{
+		if (binary.empty() || binary.size() % sizeof(UInt32) != 0)
+		{
+			SG_LOG_WARN("Invalid SPIR-V binary is not cached");
+			return;
+		}
+		AddBlob(mBinaries, key, binary);
+	}
+
+	bool ShaderLibrary::FindReflection(UInt64 binaryHash, vector<Byte>& outReflection)
+	{
+		return FindBlob(mReflections, binaryHash, outReflection);
+	}
+
+	void ShaderLibrary::AddReflection(UInt64 binaryHash, const vector<Byte>& reflection)
+	{
+		AddBlob(mReflections, binaryHash, reflection);
+	}
+
+	bool ShaderLibrary::FindBlob(BlobMap& blobs, UInt64 key, vector<Byte>& outBlob)
+	{
+		auto pNode = blobs.find(key);
+		if (pNode == blobs.end())
+			return false;
+
+		if (pNode->second.lastUsedRun != mCurrRun)
+		{
+			pNode->second.lastUsedRun = mCurrRun;
+			mbDirty = true;
+		}
+		outBlob = pNode->second.data;
+		return true;
+	}
+
+	void ShaderLibrary::AddBlob(BlobMap& blobs, UInt64 key, const vector<Byte>& blob)
+	{
+		auto& cached = blobs[key];
+		cached.data = blob;
+		cached.lastUsedRun = mCurrRun;
+		mbDirty = true;
+	}
+
+	bool ShaderLibrary::ReadBlobs(const vector<Byte>& data, Size& offset, UInt32 numBlobs, UInt64 hashSeed, BlobMap& outBlobs)
+	{
+		for (UInt32 i = 0; i < numBlobs; ++i)
 		{
-			//SG_LOG_ERROR("Failed to find the time stamp of shader: %s", shaderName);
-			return TimePoint();
+			UInt64 key = 0;
+			UInt64 blobHash = 0;
+			UInt32 lastUsedRun = 0;
+			UInt32 size = 0;
+			if (!_ReadBytes(data, offset, &key, sizeof(UInt64)) || !_ReadBytes(data, offset, &blobHash, sizeof(UInt64)) ||
+				!_ReadBytes(data, offset, &lastUsedRun, sizeof(UInt32)) || !_ReadBytes(data, offset, &size, sizeof(UInt32)) ||
+				size > data.size() - offset)
+				return false;
+
+			const Byte* pBlob = data.data() + offset;
+			offset += size;
+			if (HashMemory(pBlob, size, HashMemory(&key, sizeof(UInt64), hashSeed)) != blobHash)
+				return false;
+
+			if (mCurrRun - lastUsedRun > SG_SHADER_CACHE_MAX_UNUSED_RUNS) // not used for a long time, drop it.
+			{
+				mbDirty = true;
+				continue;
+			}
+
+			auto& cached = outBlobs[key];
+			cached.data.assign(pBlob, pBlob + size);
+			cached.lastUsedRun = lastUsedRun;
+		}
+		return true;
+	}
+
+	void ShaderLibrary::WriteBlobs(vector<Byte>& data, const BlobMap& blobs, UInt64 hashSeed)
+	{
+		// sort the entries, so that the same cache always produces the same file
+		vector<UInt64> keys;
+		keys.reserve(blobs.size());
+		for (auto& node : blobs)
+			keys.push_back(node.first);
+		eastl::sort(keys.begin(), keys.end());
+
+		for (UInt64 key : keys)
+		{
+			const auto& cached = blobs.find(key)->second;
+			const UInt64 blobHash = HashMemory(cached.data.data(), cached.data.size(), HashMemory(&key, sizeof(UInt64), hashSeed));
+			const UInt32 size = static_cast<UInt32>(cached.data.size());
+			_WriteBytes(data, &key, sizeof(UInt64));
+			_WriteBytes(data, &blobHash, sizeof(UInt64));
+			_WriteBytes(data, &cached.lastUsedRun, sizeof(UInt32));
+			_WriteBytes(data, &size, sizeof(UInt32));
+			_WriteBytes(data, cached.data.data(), size);
+		}
+	}
+
+	const ShaderLibrary::SourceRecord* ShaderLibrary::ReadSource(const string& sourceName)
+	{
+		auto pNode = mSources.find(sourceName);
+		if (pNode != mSources.end())
+			return &pNode->second;
+
+		if (!FileSystem::Open(EResourceDirectory::eShader_Sources, sourceName.c_str(), EFileMode::efRead_Binary, SG_ENGINE_DEBUG_BASE_OFFSET))
+			return nullptr;
+		string source;
+		source.resize(FileSystem::FileSize());
+		const bool bRead = FileSystem::Read(source.data(), source.size()) == source.size();
+		FileSystem::Close();
+		if (!bRead)
+			return nullptr;
+
+		SourceRecord record;
+		record.contentHash = HashMemory(source.data(), source.size());
+
+		// an include is searched relative to the source first, then relative to the shader sources folder.
+		const Size slashPos = sourceName.find_last_of('/');
+		const string folderPath = (slashPos == string::npos) ? "" : sourceName.substr(0, slashPos + 1);
+		vector<string> includes;
+		_ParseIncludes(source, includes);
+		for (const auto& include : includes)
+		{
+			string includeName = _NormalizePath(folderPath + include);
+			if (!folderPath.empty() && !FileSystem::Exist(EResourceDirectory::eShader_Sources, includeName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET))
+			{
+				string rootName = _NormalizePath(include);
+				if (FileSystem::Exist(EResourceDirectory::eShader_Sources, rootName.c_str(), SG_ENGINE_DEBUG_BASE_OFFSET))
+					includeName = eastl::move(rootName);
+			}
+			record.includes.push_back(eastl::move(includeName));
+		}
+
+		return &(mSources[sourceName] = eastl::move(record));
+	}
+
+	void ShaderLibrary::CollectSources(const string& sourceName, vector<string>& outSources)
+	{
+		eastl::hash_set<string> visited;
+		vector<string> pending = { sourceName };
+		while (!pending.empty())
+		{
+			string name = eastl::move(pending.back());
+			pending.pop_back();
+			if (!visited.insert(name).second)
+				continue;
+
+			// push in reverse, so that the includes are collected in the order they are written
+			if (const SourceRecord* pRecord = ReadSource(name))
+			{
+				for (auto include = pRecord->includes.rbegin(); include != pRecord->includes.rend(); ++include)
+					pending.push_back(*include);
+			}
+			outSources.push_back(eastl::move(name));
 		}
-		return pNode->second;
 	}
 
 	ShaderLibrary* ShaderLibrary::GetInstance()
@@ -80,46 +80,7 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-		Matrix4f viewProj = mProjectionMatrix * mViewMatrix;
-
-		// fast way to build a frustum
-		Plane topPlane({
-			viewProj[0].w - viewProj[0].y,
-			viewProj[1].w - viewProj[1].y,
-			viewProj[2].w - viewProj[2].y,
-			viewProj[3].w - viewProj[3].y });
-		topPlane /= Sqrt(glm::dot(Vector3f(Vector4f(topPlane)), Vector3f(Vector4f(topPlane))));
-		Plane bottomPlane({
-			viewProj[0].w + viewProj[0].y,
-			viewProj[1].w + viewProj[1].y,
-			viewProj[2].w + viewProj[2].y,
-			viewProj[3].w + viewProj[3].y });
-		bottomPlane /= Sqrt(glm::dot(Vector3f(Vector4f(bottomPlane)), Vector3f(Vector4f(bottomPlane))));
-		Plane rightPlane({
-			viewProj[0].w - viewProj[0].x,
-			viewProj[1].w - viewProj[1].x,
-			viewProj[2].w - viewProj[2].x,
-			viewProj[3].w - viewProj[3].x });
-		rightPlane /= Sqrt(glm::dot(Vector3f(Vector4f(rightPlane)), Vector3f(Vector4f(rightPlane))));
-		Plane leftPlane({
-			viewProj[0].w + viewProj[0].x,
-			viewProj[1].w + viewProj[1].x,
-			viewProj[2].w + viewProj[2].x,
-			viewProj[3].w + viewProj[3].x });
-		leftPlane /= Sqrt(glm::dot(Vector3f(Vector4f(leftPlane)), Vector3f(Vector4f(leftPlane))));
-		Plane frontPlane({
-			viewProj[0].w - viewProj[0].z,
-			viewProj[1].w - viewProj[1].z,
-			viewProj[2].w - viewProj[2].z,
-			viewProj[3].w - viewProj[3].z });
-		frontPlane /= Sqrt(glm::dot(Vector3f(Vector4f(frontPlane)), Vector3f(Vector4f(frontPlane))));
-		Plane backPlane({
-			viewProj[0].w + viewProj[0].z,
-			viewProj[1].w + viewProj[1].z,
-			viewProj[2].w + viewProj[2].z,
-			viewProj[3].w + viewProj[3].z });
-		backPlane /= Sqrt(glm::dot(Vector3f(Vector4f(backPlane)), Vector3f(Vector4f(backPlane))));
-		mFrustum = { frontPlane, backPlane, rightPlane, leftPlane, topPlane, bottomPlane };
+		mFrustum = Frustum::FromViewProj(mProjectionMatrix * mViewMatrix);
 	}
 
 	void BasicCamera::CalcFrustumBoundingBox()
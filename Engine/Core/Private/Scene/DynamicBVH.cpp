@@ -0,0 +1,803 @@
+#include "StdAfx.h"
+#include "Scene/DynamicBVH.h"
+
+#include "System/Logger.h"
+#include "Profile/Profile.h"
+
+#include "EASTL/algorithm.h"
+
+namespace SG
+{
+
+	namespace // anonymous namespace
+	{
+		constexpr UInt32 NUM_SAH_BINS = 16;
+
+		SG_INLINE AABB _Union(const AABB& lhs, const AABB& rhs)
+		{
+			AABB res;
+			res.min = glm::min(lhs.min, rhs.min);
+			res.max = glm::max(lhs.max, rhs.max);
+			return res;
+		}
+
+		SG_INLINE float _Area(const AABB& aabb)
+		{
+			const Vector3f d = aabb.max - aabb.min;
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+
+		SG_INLINE bool _Contains(const AABB& outer, const AABB& inner)
+		{
+			return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+				outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+		}
+
+		SG_INLINE bool _Overlap(const AABB& lhs, const AABB& rhs)
+		{
+			return lhs.min.x <= rhs.max.x && lhs.max.x >= rhs.min.x &&
+				lhs.min.y <= rhs.max.y && lhs.max.y >= rhs.min.y &&
+				lhs.min.z <= rhs.max.z && lhs.max.z >= rhs.min.z;
+		}
+
+		SG_INLINE Vector3f _Centroid(const AABB& aabb)
+		{
+			return (aabb.min + aabb.max) * 0.5f;
+		}
+
+		//! Slab test of the ray segment, tEnter is the distance to the entry point, clamped to 0 if the origin is inside.
+		SG_INLINE bool _IntersectRay(const AABB& aabb, const Vector3f& origin, const Vector3f& invDirection, float maxDistance, float& tEnter)
+		{
+			const Vector3f t1 = (aabb.min - origin) * invDirection;
+			const Vector3f t2 = (aabb.max - origin) * invDirection;
+			const Vector3f tMin = glm::min(t1, t2);
+			const Vector3f tMax = glm::max(t1, t2);
+			tEnter = eastl::max(eastl::max(tMin.x, tMin.y), eastl::max(tMin.z, 0.0f));
+			const float tExit = eastl::min(eastl::min(tMax.x, tMax.y), eastl::min(tMax.z, maxDistance));
+			return tEnter <= tExit;
+		}
+
+		SG_INLINE Vector3f _InverseDirection(const Vector3f& direction)
+		{
+			// avoid 0 * inf in the slab test when the origin is on the slab.
+			return {
+				direction.x != 0.0f ? 1.0f / direction.x : SG_MAX_FLOAT_VALUE,
+				direction.y != 0.0f ? 1.0f / direction.y : SG_MAX_FLOAT_VALUE,
+				direction.z != 0.0f ? 1.0f / direction.z : SG_MAX_FLOAT_VALUE
+			};
+		}
+
+		enum class EFrustumTest
+		{
+			eOutside,
+			eIntersect,
+			eInside,
+		};
+
+		struct FrustumTestPlanes
+		{
+			Vector4f planes[6];
+			Vector3f absNormals[6];
+		};
+
+		static FrustumTestPlanes _GetFrustumTestPlanes(const Frustum& frustum)
+		{
+			FrustumTestPlanes res = { {
+				frustum.GetFrontPlane(), frustum.GetBackPlane(),
+				frustum.GetRightPlane(), frustum.GetLeftPlane(),
+				frustum.GetTopPlane(), frustum.GetBottomPlane() } };
+			for (UInt32 i = 0; i < 6; ++i)
+				res.absNormals[i] = glm::abs(Vector3f(res.planes[i]));
+			return res;
+		}
+
+		static EFrustumTest _TestFrustum(const FrustumTestPlanes& frustum, const AABB& aabb)
+		{
+			const Vector3f center = _Centroid(aabb);
+			const Vector3f extent = (aabb.max - aabb.min) * 0.5f;
+
+			EFrustumTest res = EFrustumTest::eInside;
+			for (UInt32 i = 0; i < 6; ++i)
+			{
+				const float dist = glm::dot(Vector3f(frustum.planes[i]), center) + frustum.planes[i].w;
+				const float radius = glm::dot(frustum.absNormals[i], extent);
+				if (dist + radius < 0.0f)
+					return EFrustumTest::eOutside;
+				if (dist - radius < 0.0f)
+					res = EFrustumTest::eIntersect;
+			}
+			return res;
+		}
+	}
+
+	DynamicBVH::ProxyID DynamicBVH::CreateProxy(const AABB& aabb, UInt32 userData)
+	{
+		const UInt32 leaf = AllocateNode();
+		Node& node = mNodes[leaf];
+		node.aabb = aabb;
+		node.userData = userData;
+		node.height = 0;
+
+		InsertLeaf(leaf);
+		++mNumProxies;
+		return leaf;
+	}
+
+	void DynamicBVH::DestroyProxy(ProxyID proxy)
+	{
+		SG_ASSERT(IsValid(proxy));
+
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		--mNumProxies;
+	}
+
+	void DynamicBVH::MoveProxy(ProxyID proxy, const AABB& aabb)
+	{
+		SG_ASSERT(IsValid(proxy));
+
+		const UInt32 parent = mNodes[proxy].parent;
+		if (parent != INVALID_PROXY && _Contains(mNodes[parent].aabb, aabb))
+		{
+			// small movement, the proxy stays in its subtree.
+			mNodes[proxy].aabb = aabb;
+			RefitAncestors(parent);
+		}
+		else
+		{
+			RemoveLeaf(proxy);
+			mNodes[proxy].aabb = aabb;
+			InsertLeaf(proxy);
+		}
+	}
+
+	void DynamicBVH::Clear()
+	{
+		mNodes.clear();
+		mRoot = INVALID_PROXY;
+		mFreeList = INVALID_PROXY;
+		mNumProxies = 0;
+	}
+
+	void DynamicBVH::Rebuild()
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (mRoot == INVALID_PROXY)
+			return;
+
+		vector<UInt32> leaves;
+		leaves.reserve(mNumProxies);
+		for (UInt32 i = 0; i < mNodes.size(); ++i)
+		{
+			if (mNodes[i].height == 0)
+				leaves.push_back(i);
+			else if (mNodes[i].height > 0) // internal nodes will be reallocated by the build
+				FreeNode(i);
+		}
+
+		mRoot = BuildRange(leaves.data(), static_cast<UInt32>(leaves.size()));
+		mNodes[mRoot].parent = INVALID_PROXY;
+	}
+
+	void DynamicBVH::QueryAABB(const AABB& aabb, vector<UInt32>& outUserData) const
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (mRoot == INVALID_PROXY)
+			return;
+
+		vector<UInt32> stack;
+		stack.push_back(mRoot);
+		while (!stack.empty())
+		{
+			const Node& node = mNodes[stack.back()];
+			stack.pop_back();
+
+			if (!_Overlap(node.aabb, aabb))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				outUserData.push_back(node.userData);
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	void DynamicBVH::QueryFrustum(const Frustum& frustum, vector<UInt32>& outUserData) const
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (mRoot == INVALID_PROXY)
+			return;
+
+		const FrustumTestPlanes planes = _GetFrustumTestPlanes(frustum);
+		vector<UInt32> stack;
+		stack.push_back(mRoot);
+		while (!stack.empty())
+		{
+			const UInt32 index = stack.back();
+			stack.pop_back();
+
+			const Node& node = mNodes[index];
+			const EFrustumTest res = _TestFrustum(planes, node.aabb);
+			if (res == EFrustumTest::eOutside)
+				continue;
+
+			if (node.IsLeaf())
+			{
+				outUserData.push_back(node.userData);
+			}
+			else if (res == EFrustumTest::eInside) // the whole subtree is visible, no need to test any more.
+			{
+				CollectLeaves(index, outUserData);
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	void DynamicBVH::QueryRay(const Vector3f& origin, const Vector3f& direction, float maxDistance, vector<UInt32>& outUserData) const
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (mRoot == INVALID_PROXY)
+			return;
+
+		const Vector3f invDirection = _InverseDirection(direction);
+		vector<UInt32> stack;
+		stack.push_back(mRoot);
+		while (!stack.empty())
+		{
+			const Node& node = mNodes[stack.back()];
+			stack.pop_back();
+
+			float tEnter;
+			if (!_IntersectRay(node.aabb, origin, invDirection, maxDistance, tEnter))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				outUserData.push_back(node.userData);
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	bool DynamicBVH::RayCast(const Vector3f& origin, const Vector3f& direction, float maxDistance, UInt32& outUserData, float& outDistance) const
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (mRoot == INVALID_PROXY)
+			return false;
+
+		const Vector3f invDirection = _InverseDirection(direction);
+		float tEnter;
+		if (!_IntersectRay(mNodes[mRoot].aabb, origin, invDirection, maxDistance, tEnter))
+			return false;
+
+		bool bHit = false;
+		float closest = maxDistance;
+
+		// the nodes are pushed with their entry distance, so the subtrees further than the closest hit can be skipped.
+		vector<eastl::pair<UInt32, float>> stack;
+		stack.push_back({ mRoot, tEnter });
+		while (!stack.empty())
+		{
+			const auto [index, tNode] = stack.back();
+			stack.pop_back();
+			if (tNode > closest)
+				continue;
+
+			const Node& node = mNodes[index];
+			if (node.IsLeaf())
+			{
+				closest = tNode;
+				outUserData = node.userData;
+				bHit = true;
+				continue;
+			}
+
+			float t1, t2;
+			const bool bHit1 = _IntersectRay(mNodes[node.child1].aabb, origin, invDirection, closest, t1);
+			const bool bHit2 = _IntersectRay(mNodes[node.child2].aabb, origin, invDirection, closest, t2);
+			// push the further child first, so the nearer one is visited first.
+			if (bHit1 && bHit2)
+			{
+				if (t1 < t2)
+				{
+					stack.push_back({ node.child2, t2 });
+					stack.push_back({ node.child1, t1 });
+				}
+				else
+				{
+					stack.push_back({ node.child1, t1 });
+					stack.push_back({ node.child2, t2 });
+				}
+			}
+			else if (bHit1)
+			{
+				stack.push_back({ node.child1, t1 });
+			}
+			else if (bHit2)
+			{
+				stack.push_back({ node.child2, t2 });
+			}
+		}
+
+		if (bHit)
+			outDistance = closest;
+		return bHit;
+	}
+
+	float DynamicBVH::GetAreaRatio() const
+	{
+		if (mRoot == INVALID_PROXY)
+			return 0.0f;
+
+		const float rootArea = _Area(mNodes[mRoot].aabb);
+		if (rootArea <= 0.0f)
+			return 0.0f;
+
+		float totalArea = 0.0f;
+		for (auto& node : mNodes)
+		{
+			if (node.height > 0)
+				totalArea += _Area(node.aabb);
+		}
+		return totalArea / rootArea;
+	}
+
+	bool DynamicBVH::Validate() const
+	{
+		if (mRoot == INVALID_PROXY)
+			return mNumProxies == 0;
+
+		if (mNodes[mRoot].parent != INVALID_PROXY || !ValidateNode(mRoot))
+			return false;
+
+		UInt32 numLeaves = 0;
+		for (auto& node : mNodes)
+		{
+			if (node.height == 0)
+				++numLeaves;
+		}
+		return numLeaves == mNumProxies;
+	}
+
+	UInt32 DynamicBVH::AllocateNode()
+	{
+		if (mFreeList == INVALID_PROXY)
+		{
+			mNodes.emplace_back();
+			return static_cast<UInt32>(mNodes.size() - 1);
+		}
+
+		const UInt32 node = mFreeList;
+		mFreeList = mNodes[node].parent;
+		mNodes[node] = Node();
+		return node;
+	}
+
+	void DynamicBVH::FreeNode(UInt32 node)
+	{
+		Node& freeNode = mNodes[node];
+		freeNode.parent = mFreeList;
+		freeNode.child1 = INVALID_PROXY;
+		freeNode.child2 = INVALID_PROXY;
+		freeNode.height = -1;
+		mFreeList = node;
+	}
+
+	void DynamicBVH::InsertLeaf(UInt32 leaf)
+	{
+		if (mRoot == INVALID_PROXY)
+		{
+			mRoot = leaf;
+			mNodes[leaf].parent = INVALID_PROXY;
+			return;
+		}
+
+		// go down to the sibling with the lowest cost (surface area of the new parent plus the increased area of the ancestors).
+		const AABB leafAABB = mNodes[leaf].aabb;
+		UInt32 index = mRoot;
+		while (!mNodes[index].IsLeaf())
+		{
+			const Node& node = mNodes[index];
+			const float area = _Area(node.aabb);
+			const float combinedArea = _Area(_Union(node.aabb, leafAABB));
+
+			// cost of creating a new parent for this node and the new leaf
+			const float cost = 2.0f * combinedArea;
+			// minimum cost of pushing the leaf further down the tree
+			const float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](UInt32 child)
+			{
+				const Node& childNode = mNodes[child];
+				const float newArea = _Area(_Union(childNode.aabb, leafAABB));
+				return (childNode.IsLeaf() ? newArea : newArea - _Area(childNode.aabb)) + inheritanceCost;
+			};
+			const float cost1 = childCost(node.child1);
+			const float cost2 = childCost(node.child2);
+
+			if (cost < cost1 && cost < cost2)
+				break;
+			index = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		const UInt32 sibling = index;
+		const UInt32 newParent = AllocateNode(); // may reallocate the nodes
+		const UInt32 oldParent = mNodes[sibling].parent;
+
+		Node& parentNode = mNodes[newParent];
+		parentNode.parent = oldParent;
+		parentNode.aabb = _Union(leafAABB, mNodes[sibling].aabb);
+		parentNode.height = mNodes[sibling].height + 1;
+		parentNode.child1 = sibling;
+		parentNode.child2 = leaf;
+
+		if (oldParent != INVALID_PROXY)
+		{
+			Node& oldParentNode = mNodes[oldParent];
+			if (oldParentNode.child1 == sibling)
+				oldParentNode.child1 = newParent;
+			else
+				oldParentNode.child2 = newParent;
+		}
+		else
+		{
+			mRoot = newParent;
+		}
+		mNodes[sibling].parent = newParent;
+		mNodes[leaf].parent = newParent;
+
+		RefitAncestors(newParent);
+	}
+
+	void DynamicBVH::RemoveLeaf(UInt32 leaf)
+	{
+		if (leaf == mRoot)
+		{
+			mRoot = INVALID_PROXY;
+			return;
+		}
+
+		const UInt32 parent = mNodes[leaf].parent;
+		const UInt32 grandParent = mNodes[parent].parent;
+		const UInt32 sibling = mNodes[parent].child1 == leaf ? mNodes[parent].child2 : mNodes[parent].child1;
+
+		// the sibling takes the place of the parent
+		if (grandParent != INVALID_PROXY)
+		{
+			Node& grandParentNode = mNodes[grandParent];
+			if (grandParentNode.child1 == parent)
+				grandParentNode.child1 = sibling;
+			else
+				grandParentNode.child2 = sibling;
+			mNodes[sibling].parent = grandParent;
+			FreeNode(parent);
+
+			RefitAncestors(grandParent);
+		}
+		else
+		{
+			mRoot = sibling;
+			mNodes[sibling].parent = INVALID_PROXY;
+			FreeNode(parent);
+		}
+		mNodes[leaf].parent = INVALID_PROXY;
+	}
+
+	void DynamicBVH::RefitAncestors(UInt32 node)
+	{
+		while (node != INVALID_PROXY)
+		{
+			Node& currNode = mNodes[node];
+			const Node& child1 = mNodes[currNode.child1];
+			const Node& child2 = mNodes[currNode.child2];
+			currNode.aabb = _Union(child1.aabb, child2.aabb);
+			currNode.height = 1 + eastl::max(child1.height, child2.height);
+
+			// the rotation keeps the bounds of this node, and fixes up the heights itself.
+			Rotate(node);
+			node = currNode.parent;
+		}
+	}
+
+	void DynamicBVH::Rotate(UInt32 iA)
+	{
+		//         A
+		//       /   \
+		//      B     C
+		//     / \   / \
+		//    D   E F   G
+		// B can be swapped with F or G, and C can be swapped with D or E.
+		// Only the area of the internal node which gets a new child changes, pick the swap which reduces it the most.
+		Node& A = mNodes[iA];
+		if (A.height < 2)
+			return;
+
+		const UInt32 iB = A.child1;
+		const UInt32 iC = A.child2;
+		Node& B = mNodes[iB];
+		Node& C = mNodes[iC];
+
+		enum class ERotation { eNone, eBF, eBG, eCD, eCE };
+		ERotation bestRotation = ERotation::eNone;
+		AABB aabbBG, aabbBF, aabbCE, aabbCD;
+
+		if (B.IsLeaf())
+		{
+			aabbBG = _Union(B.aabb, mNodes[C.child2].aabb);
+			aabbBF = _Union(B.aabb, mNodes[C.child1].aabb);
+			const float costBase = _Area(C.aabb);
+			const float costBF = _Area(aabbBG);
+			const float costBG = _Area(aabbBF);
+			if (costBF < costBase || costBG < costBase)
+				bestRotation = costBF < costBG ? ERotation::eBF : ERotation::eBG;
+		}
+		else if (C.IsLeaf())
+		{
+			aabbCE = _Union(C.aabb, mNodes[B.child2].aabb);
+			aabbCD = _Union(C.aabb, mNodes[B.child1].aabb);
+			const float costBase = _Area(B.aabb);
+			const float costCD = _Area(aabbCE);
+			const float costCE = _Area(aabbCD);
+			if (costCD < costBase || costCE < costBase)
+				bestRotation = costCD < costCE ? ERotation::eCD : ERotation::eCE;
+		}
+		else
+		{
+			aabbBG = _Union(B.aabb, mNodes[C.child2].aabb);
+			aabbBF = _Union(B.aabb, mNodes[C.child1].aabb);
+			aabbCE = _Union(C.aabb, mNodes[B.child2].aabb);
+			aabbCD = _Union(C.aabb, mNodes[B.child1].aabb);
+
+			const float areaB = _Area(B.aabb);
+			const float areaC = _Area(C.aabb);
+			float bestCost = areaB + areaC;
+
+			const float costs[4] = {
+				areaB + _Area(aabbBG), // B <-> F
+				areaB + _Area(aabbBF), // B <-> G
+				areaC + _Area(aabbCE), // C <-> D
+				areaC + _Area(aabbCD), // C <-> E
+			};
+			const ERotation rotations[4] = { ERotation::eBF, ERotation::eBG, ERotation::eCD, ERotation::eCE };
+			for (UInt32 i = 0; i < 4; ++i)
+			{
+				if (costs[i] < bestCost)
+				{
+					bestCost = costs[i];
+					bestRotation = rotations[i];
+				}
+			}
+		}
+
+		switch (bestRotation)
+		{
+		case ERotation::eNone:
+			break;
+		case ERotation::eBF:
+		{
+			const UInt32 iF = C.child1;
+			Node& F = mNodes[iF];
+			A.child1 = iF;
+			C.child1 = iB;
+			B.parent = iC;
+			F.parent = iA;
+			C.aabb = aabbBG;
+			C.height = 1 + eastl::max(B.height, mNodes[C.child2].height);
+			A.height = 1 + eastl::max(C.height, F.height);
+			break;
+		}
+		case ERotation::eBG:
+		{
+			const UInt32 iG = C.child2;
+			Node& G = mNodes[iG];
+			A.child1 = iG;
+			C.child2 = iB;
+			B.parent = iC;
+			G.parent = iA;
+			C.aabb = aabbBF;
+			C.height = 1 + eastl::max(B.height, mNodes[C.child1].height);
+			A.height = 1 + eastl::max(C.height, G.height);
+			break;
+		}
+		case ERotation::eCD:
+		{
+			const UInt32 iD = B.child1;
+			Node& D = mNodes[iD];
+			A.child2 = iD;
+			B.child1 = iC;
+			C.parent = iB;
+			D.parent = iA;
+			B.aabb = aabbCE;
+			B.height = 1 + eastl::max(C.height, mNodes[B.child2].height);
+			A.height = 1 + eastl::max(B.height, D.height);
+			break;
+		}
+		case ERotation::eCE:
+		{
+			const UInt32 iE = B.child2;
+			Node& E = mNodes[iE];
+			A.child2 = iE;
+			B.child2 = iC;
+			C.parent = iB;
+			E.parent = iA;
+			B.aabb = aabbCD;
+			B.height = 1 + eastl::max(C.height, mNodes[B.child1].height);
+			A.height = 1 + eastl::max(B.height, E.height);
+			break;
+		}
+		}
+	}
+
+	UInt32 DynamicBVH::BuildRange(UInt32* pLeaves, UInt32 count)
+	{
+		if (count == 1)
+			return pLeaves[0];
+
+		AABB centroidBounds;
+		AABBReset(centroidBounds);
+		for (UInt32 i = 0; i < count; ++i)
+			AABBMerge(centroidBounds, _Centroid(mNodes[pLeaves[i]].aabb));
+
+		// split along the longest axis of the centroids
+		const Vector3f extent = centroidBounds.max - centroidBounds.min;
+		int axis = 0;
+		if (extent.y > extent[axis])
+			axis = 1;
+		if (extent.z > extent[axis])
+			axis = 2;
+
+		UInt32 mid = count / 2;
+		if (extent[axis] > 0.0f)
+		{
+			struct Bin
+			{
+				AABB   aabb;
+				UInt32 count = 0;
+			};
+			Bin bins[NUM_SAH_BINS];
+			for (auto& bin : bins)
+				AABBReset(bin.aabb);
+
+			const float binScale = NUM_SAH_BINS / extent[axis];
+			auto binIndex = [&](UInt32 leaf)
+			{
+				const UInt32 index = static_cast<UInt32>((_Centroid(mNodes[leaf].aabb)[axis] - centroidBounds.min[axis]) * binScale);
+				return eastl::min(index, NUM_SAH_BINS - 1);
+			};
+
+			for (UInt32 i = 0; i < count; ++i)
+			{
+				Bin& bin = bins[binIndex(pLeaves[i])];
+				AABBMerge(bin.aabb, mNodes[pLeaves[i]].aabb);
+				++bin.count;
+			}
+
+			// sweep from the right to get the cost of the right side of each split
+			float rightCosts[NUM_SAH_BINS - 1];
+			AABB rightAABB;
+			AABBReset(rightAABB);
+			UInt32 rightCount = 0;
+			for (UInt32 i = NUM_SAH_BINS - 1; i > 0; --i)
+			{
+				AABBMerge(rightAABB, bins[i].aabb);
+				rightCount += bins[i].count;
+				rightCosts[i - 1] = rightCount == 0 ? 0.0f : rightCount * _Area(rightAABB);
+			}
+
+			// sweep from the left and find the split with the lowest cost, the split i means bins [0, i] go left
+			AABB leftAABB;
+			AABBReset(leftAABB);
+			UInt32 leftCount = 0;
+			UInt32 bestSplit = NUM_SAH_BINS;
+			float bestCost = SG_MAX_FLOAT_VALUE;
+			for (UInt32 i = 0; i < NUM_SAH_BINS - 1; ++i)
+			{
+				AABBMerge(leftAABB, bins[i].aabb);
+				leftCount += bins[i].count;
+				if (leftCount == 0 || leftCount == count)
+					continue;
+
+				const float cost = leftCount * _Area(leftAABB) + rightCosts[i];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestSplit = i;
+				}
+			}
+
+			if (bestSplit != NUM_SAH_BINS)
+			{
+				// partition the leaves, the ones in the bins [0, bestSplit] go first
+				UInt32 left = 0;
+				UInt32 right = count;
+				while (left < right)
+				{
+					if (binIndex(pLeaves[left]) <= bestSplit)
+						++left;
+					else
+						eastl::swap(pLeaves[left], pLeaves[--right]);
+				}
+				mid = left;
+			}
+		}
+
+		const UInt32 child1 = BuildRange(pLeaves, mid);
+		const UInt32 child2 = BuildRange(pLeaves + mid, count - mid);
+
+		const UInt32 node = AllocateNode();
+		Node& currNode = mNodes[node];
+		currNode.child1 = child1;
+		currNode.child2 = child2;
+		currNode.aabb = _Union(mNodes[child1].aabb, mNodes[child2].aabb);
+		currNode.height = 1 + eastl::max(mNodes[child1].height, mNodes[child2].height);
+		mNodes[child1].parent = node;
+		mNodes[child2].parent = node;
+		return node;
+	}
+
+	void DynamicBVH::CollectLeaves(UInt32 node, vector<UInt32>& outUserData) const
+	{
+		vector<UInt32> stack;
+		stack.push_back(node);
+		while (!stack.empty())
+		{
+			const Node& currNode = mNodes[stack.back()];
+			stack.pop_back();
+
+			if (currNode.IsLeaf())
+			{
+				outUserData.push_back(currNode.userData);
+			}
+			else
+			{
+				stack.push_back(currNode.child1);
+				stack.push_back(currNode.child2);
+			}
+		}
+	}
+
+	bool DynamicBVH::ValidateNode(UInt32 node) const
+	{
+		const Node& currNode = mNodes[node];
+		if (currNode.IsLeaf())
+			return currNode.height == 0 && currNode.child2 == INVALID_PROXY;
+
+		const Node& child1 = mNodes[currNode.child1];
+		const Node& child2 = mNodes[currNode.child2];
+		if (child1.parent != node || child2.parent != node)
+		{
+			SG_LOG_ERROR("DynamicBVH: broken parent link of node %d", node);
+			return false;
+		}
+		if (currNode.height != 1 + eastl::max(child1.height, child2.height))
+		{
+			SG_LOG_ERROR("DynamicBVH: wrong height of node %d", node);
+			return false;
+		}
+		if (!_Contains(currNode.aabb, child1.aabb) || !_Contains(currNode.aabb, child2.aabb))
+		{
+			SG_LOG_ERROR("DynamicBVH: node %d do not contain its children", node);
+			return false;
+		}
+		return ValidateNode(currNode.child1) && ValidateNode(currNode.child2);
+	}
+
+}
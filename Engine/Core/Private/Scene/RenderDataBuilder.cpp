@@ -5,6 +5,7 @@
 #include "Scene/Components.h"
 #include "Archive/MeshDataArchive.h"
 #include "Archive/MaterialAssetArchive.h"
+#include "Archive/AsyncResourceLoader.h"
 #include "Profile/Profile.h"
 #include "TipECS/Entity.h"
 
@@ -43,6 +44,16 @@ namespace SG
 		mbIsRenderDataReady = false;
 
 		mRenderMeshBuildDataMap.clear();
+		mMeshBounds.Clear();
+		mMeshAABBs.clear();
+		mMeshLooseUpdates.clear();
+		mMeshFlags.clear();
+		mRecalcBoundsMeshes.clear();
+
+		mObjectSlots.clear();
+		mDirtyObjects.clear();
+		mChangedInstanceMeshes.clear();
+		mbDrawCallLayoutChanged = false;
 	}
 
 	void RenderDataBuilder::LoadInNeccessaryDataFromDisk()
@@ -55,67 +66,47 @@ namespace SG
 
 		pScene->TraverseEntity([this](auto& entity)
 			{
-				// for now, only material component have asset that need to be load in.
-				if (entity.HasComponent<MaterialComponent>())
-				{
-					MaterialComponent& mat = entity.GetComponent<MaterialComponent>();
-					auto matAsset = mat.materialAsset.lock();
-					const UInt32 matTextureMask = matAsset->GetTextureMask();
-
-					// TODO: may be there is a more automatic and smarter way to load asset.
-					if ((matTextureMask & MaterialAsset::ALBEDO_TEX_MASK) != 0)
-					{
-						auto albedoTex = matAsset->GetAlbedoTexture();
-						if (mAssets.find(albedoTex->GetAssetID()) == mAssets.end())
-						{
-							mCurrentFrameNewAssets[albedoTex->GetAssetID()] = albedoTex;
-							mAssets[albedoTex->GetAssetID()] = albedoTex;
-						}
-					}
-					if ((matTextureMask & MaterialAsset::NORMAL_TEX_MASK) != 0)
-					{
-						auto normalTex = matAsset->GetNormalTexture();
-						if (mAssets.find(normalTex->GetAssetID()) == mAssets.end())
-						{
-							mCurrentFrameNewAssets[normalTex->GetAssetID()] = normalTex;
-							mAssets[normalTex->GetAssetID()] = normalTex;
-						}
-					}
-					if ((matTextureMask & MaterialAsset::METALLIC_TEX_MASK) != 0)
-					{
-						auto metallicTex = matAsset->GetMetallicTexture();
-						if (mAssets.find(metallicTex->GetAssetID()) == mAssets.end())
-						{
-							mCurrentFrameNewAssets[metallicTex->GetAssetID()] = metallicTex;
-							mAssets[metallicTex->GetAssetID()] = metallicTex;
-						}
-					}
-					if ((matTextureMask & MaterialAsset::ROUGHNESS_TEX_MASK) != 0)
-					{
-						auto roughnessTex = matAsset->GetRoughnessTexture();
-						if (mAssets.find(roughnessTex->GetAssetID()) == mAssets.end())
-						{
-							mCurrentFrameNewAssets[roughnessTex->GetAssetID()] = roughnessTex;
-							mAssets[roughnessTex->GetAssetID()] = roughnessTex;
-						}
-					}
-					if ((matTextureMask & MaterialAsset::AO_TEX_MASK) != 0)
-					{
-						auto AOTex = matAsset->GetAOTexture();
-						if (mAssets.find(AOTex->GetAssetID()) == mAssets.end())
-						{
-							mCurrentFrameNewAssets[AOTex->GetAssetID()] = AOTex;
-							mAssets[AOTex->GetAssetID()] = AOTex;
-						}
-					}
-				}
+				RequestMaterialAssets(entity);
 			});
+	}
 
-		for (auto& node : mCurrentFrameNewAssets)
-		{
-			auto pLock = node.second.lock();
-			pLock->LoadDataFromFile();
-		}
+	void RenderDataBuilder::RequestMaterialAssets(Scene::Entity& entity)
+	{
+		// for now, only material component have asset that need to be load in.
+		if (!entity.template HasComponent<MaterialComponent>())
+			return;
+
+		MaterialComponent& mat = entity.template GetComponent<MaterialComponent>();
+		auto matAsset = mat.materialAsset.lock();
+		const UInt32 matTextureMask = matAsset->GetTextureMask();
+
+		// TODO: may be there is a more automatic and smarter way to load asset.
+		// the albedo textures go first, they are the most noticeable ones while the default texture is bound.
+		if ((matTextureMask & MaterialAsset::ALBEDO_TEX_MASK) != 0)
+			RequestTextureAsset(matAsset->GetAlbedoTexture(), ELoadPriority::eHigh);
+		if ((matTextureMask & MaterialAsset::NORMAL_TEX_MASK) != 0)
+			RequestTextureAsset(matAsset->GetNormalTexture(), ELoadPriority::eNormal);
+		if ((matTextureMask & MaterialAsset::METALLIC_TEX_MASK) != 0)
+			RequestTextureAsset(matAsset->GetMetallicTexture(), ELoadPriority::eLow);
+		if ((matTextureMask & MaterialAsset::ROUGHNESS_TEX_MASK) != 0)
+			RequestTextureAsset(matAsset->GetRoughnessTexture(), ELoadPriority::eLow);
+		if ((matTextureMask & MaterialAsset::AO_TEX_MASK) != 0)
+			RequestTextureAsset(matAsset->GetAOTexture(), ELoadPriority::eLow);
+	}
+
+	void RenderDataBuilder::RequestTextureAsset(RefPtr<TextureAsset> pTextureAsset, ELoadPriority priority)
+	{
+		const UInt32 assetId = pTextureAsset->GetAssetID();
+		if (mAssets.find(assetId) != mAssets.end())
+			return;
+		mAssets[assetId] = pTextureAsset;
+
+		// the texture data will be streamed in by the AsyncResourceLoader,
+		// and the texture will be treated as a new asset in the frame it is loaded.
+		AsyncResourceLoader::LoadTexture(pTextureAsset, priority, [this](RefPtr<TextureAsset> pLoadedAsset)
+			{
+				mCurrentFrameNewAssets[pLoadedAsset->GetAssetID()] = pLoadedAsset;
+			});
 	}
 
 	void RenderDataBuilder::ResolveRenderData()
@@ -128,97 +119,35 @@ namespace SG
 
 		// reset render status
 		mRenderMeshBuildDataMap.clear();
+		mObjectSlots.clear();
+		mDirtyObjects.clear();
+		mChangedInstanceMeshes.clear();
+		mMeshBounds.Clear();
+		mMeshAABBs.clear();
+		mMeshLooseUpdates.clear();
+		mMeshFlags.clear();
+		mRecalcBoundsMeshes.clear();
 		AABBReset(mSceneAABB);
 
 		// collect instance info and set instance id.
 		pScene->TraverseEntity([this](auto& entity)
 			{
-				if (entity.HasComponent<MeshComponent>())
-				{
-					auto& meshComp = entity.GetComponent<MeshComponent>();
-					auto meshId = meshComp.meshId;
-					auto objectId = meshComp.objectId;
-					
-					AABBMerge(mSceneAABB, meshComp.aabb);
-
-					auto node = mRenderMeshBuildDataMap.find(meshId);
-					if (node == mRenderMeshBuildDataMap.end())
-					{
-						auto node = mRenderMeshBuildDataMap.insert(meshId);
-						auto& rendererBuildData = node.first->second;
-
-						rendererBuildData.objectId = objectId;
-						rendererBuildData.instanceCount = 1;
-						meshComp.instanceId = 0;
-
-						if (entity.HasComponent<MaterialComponent>())
-						{
-							MaterialComponent& matComp = entity.GetComponent<MaterialComponent>();
-							auto materialAsset = matComp.materialAsset.lock();
-
-							rendererBuildData.materialAssetName = materialAsset->GetAssetName();
-							rendererBuildData.materialTextureMask = materialAsset->GetTextureMask();
-							if ((rendererBuildData.materialTextureMask & MaterialAsset::ALBEDO_TEX_MASK) != 0)
-								rendererBuildData.albedoTexAssetName = materialAsset->GetAlbedoTexture()->GetAssetName();
-							if ((rendererBuildData.materialTextureMask & MaterialAsset::METALLIC_TEX_MASK) != 0)
-								rendererBuildData.metallicTexAssetName = materialAsset->GetMetallicTexture()->GetAssetName();
-							if ((rendererBuildData.materialTextureMask & MaterialAsset::ROUGHNESS_TEX_MASK) != 0)
-								rendererBuildData.roughnessTexAssetName = materialAsset->GetRoughnessTexture()->GetAssetName();
-							if ((rendererBuildData.materialTextureMask & MaterialAsset::NORMAL_TEX_MASK) != 0)
-								rendererBuildData.normalTexAssetName = materialAsset->GetNormalTexture()->GetAssetName();
-							if ((rendererBuildData.materialTextureMask & MaterialAsset::AO_TEX_MASK) != 0)
-								rendererBuildData.aoTexAssetName = materialAsset->GetAOTexture()->GetAssetName();
-						}
-					}
-					else // have instance
-					{
-						auto& rendererBuildData = node->second;
-						meshComp.instanceId = rendererBuildData.instanceCount;
-						rendererBuildData.instanceCount += 1;
-
-						if (entity.HasComponent<MaterialComponent>())
-						{
-							MaterialComponent& matComp = entity.GetComponent<MaterialComponent>();
-							auto materialAsset = matComp.materialAsset.lock();
-							const UInt32 oldMask = rendererBuildData.materialTextureMask;
-
-							const UInt32 textureMask = materialAsset->GetTextureMask();
-
-							if ((textureMask | oldMask) != oldMask) // it is the new maximum set
-							{
-								rendererBuildData.materialAssetName = materialAsset->GetAssetName();
-								rendererBuildData.materialTextureMask = textureMask;
-
-								if ((textureMask & MaterialAsset::ALBEDO_TEX_MASK) != 0)
-									rendererBuildData.albedoTexAssetName = materialAsset->GetAlbedoTexture()->GetAssetName();
-								if ((textureMask & MaterialAsset::METALLIC_TEX_MASK) != 0)
-									rendererBuildData.metallicTexAssetName = materialAsset->GetMetallicTexture()->GetAssetName();
-								if ((textureMask & MaterialAsset::ROUGHNESS_TEX_MASK) != 0)
-									rendererBuildData.roughnessTexAssetName = materialAsset->GetRoughnessTexture()->GetAssetName();
-								if ((textureMask & MaterialAsset::NORMAL_TEX_MASK) != 0)
-									rendererBuildData.normalTexAssetName = materialAsset->GetNormalTexture()->GetAssetName();
-								if ((textureMask & MaterialAsset::AO_TEX_MASK) != 0)
-									rendererBuildData.aoTexAssetName = materialAsset->GetAOTexture()->GetAssetName();
-							}
-						}
-					}
-
-					auto& perInstanceData = mRenderMeshBuildDataMap[meshId].perInstanceData;
-					perInstanceData.emplace_back(objectId);
-				}
+				if (entity.template HasComponent<MeshComponent>())
+					AddObject({ entity, entity.template GetComponent<TagComponent>().treeNode });
 			});
+		// the draw calls will be collected from the scratch.
+		ClearDrawCallChanges();
 
-		for (auto node : mRenderMeshBuildDataMap) // clear the memory that is not necessary
-		{
-			if (node.second.instanceCount == 1)
-				node.second.perInstanceData.set_capacity(0);
-		}
+		// the root of the mesh BVH bounds all the meshes, and it is kept up to date by the scene.
+		const auto& meshBVH = pScene->GetMeshBVH();
+		if (!meshBVH.IsEmpty())
+			mSceneAABB = meshBVH.GetRootAABB();
 
 		pScene->TraverseEntity([this](auto& entity)
 			{
-				if (entity.HasComponent<DDGIVolumnComponent>())
+				if (entity.template HasComponent<DDGIVolumnComponent>())
 				{
-					auto& ddgiComp = entity.GetComponent<DDGIVolumnComponent>();
+					auto& ddgiComp = entity.template GetComponent<DDGIVolumnComponent>();
 					ddgiComp.volumn = mSceneAABB;
 					ddgiComp.probeSpacing = CalcProbeSpacing(ddgiComp.volumn);
 				}
@@ -227,6 +156,303 @@ namespace SG
 		LogDebugInfo();
 
 		mbIsRenderDataReady = true;
+
+		for (auto& node : mRenderMeshBuildDataMap)
+			MarkMeshNeedRecalcBounds(node.first);
+		UpdateMeshBounds();
+	}
+
+	void RenderDataBuilder::ApplySceneDeltas()
+	{
+		SG_PROFILE_FUNCTION();
+
+		auto pScene = mpScene.lock();
+		if (!pScene || !mbIsRenderDataReady)
+			return;
+
+		for (auto delta : pScene->GetMeshDeltas())
+		{
+			switch (delta.type)
+			{
+			case EMeshDeltaType::eAdded:
+			{
+				// the object may had been removed later in the same frame.
+				if (!pScene->IsObjectAlive(delta.objectId, delta.objectGeneration))
+					break;
+				if (delta.objectId < mObjectSlots.size() && mObjectSlots[delta.objectId].IsInRenderData())
+				{
+					if (mObjectSlots[delta.objectId].generation == delta.objectGeneration) // already collected by ResolveRenderData()
+						break;
+					// the remove delta of the old object was missed, never let the old instance stay in the list.
+					RemoveObject(*pScene, delta.objectId, mObjectSlots[delta.objectId].generation);
+				}
+				if (delta.treeNode == SceneHierarchy::INVALID_NODE) // not in the hierarchy (e.g. the skybox)
+					break;
+				RequestMaterialAssets(delta.entity);
+				AddObject({ delta.entity, delta.treeNode });
+				break;
+			}
+			case EMeshDeltaType::eRemoved:
+				RemoveObject(*pScene, delta.objectId, delta.objectGeneration);
+				break;
+			case EMeshDeltaType::eModified:
+				OnObjectModified(*pScene, delta.objectId, delta.objectGeneration);
+				break;
+			}
+		}
+	}
+
+	const RendererBuildData* RenderDataBuilder::GetRenderData(UInt32 meshId) const
+	{
+		auto node = mRenderMeshBuildDataMap.find(meshId);
+		return node == mRenderMeshBuildDataMap.end() ? nullptr : &node->second;
+	}
+
+	void RenderDataBuilder::ClearDrawCallChanges()
+	{
+		for (auto meshId : mChangedInstanceMeshes)
+			mMeshFlags[meshId] &= ~efInstanceChanged;
+		mChangedInstanceMeshes.clear();
+		mbDrawCallLayoutChanged = false;
+	}
+
+	void RenderDataBuilder::AddObject(const Scene::EntityContext& context)
+	{
+		auto entity = context.entity;
+		auto& meshComp = entity.template GetComponent<MeshComponent>();
+		const UInt32 meshId = meshComp.meshId;
+		const UInt32 objectId = meshComp.objectId;
+
+		if (objectId >= mObjectSlots.size())
+			mObjectSlots.resize(objectId + 1);
+		if (meshId >= mMeshAABBs.size())
+			ResizeMeshBounds(meshId + 1);
+
+		auto node = mRenderMeshBuildDataMap.find(meshId);
+		const bool bNewMesh = node == mRenderMeshBuildDataMap.end();
+		if (bNewMesh)
+		{
+			node = mRenderMeshBuildDataMap.insert(meshId).first;
+			node->second.objectId = objectId;
+			node->second.instanceCount = 0;
+		}
+		auto& rendererBuildData = node->second;
+
+		if (entity.template HasComponent<MaterialComponent>())
+		{
+			MaterialComponent& matComp = entity.template GetComponent<MaterialComponent>();
+			auto materialAsset = matComp.materialAsset.lock();
+			const UInt32 oldMask = rendererBuildData.materialTextureMask;
+			const UInt32 textureMask = materialAsset->GetTextureMask();
+
+			// the first instance decides the material, the others replace it only if they have the new maximum set of textures.
+			if (bNewMesh || (textureMask | oldMask) != oldMask)
+			{
+				if (!bNewMesh && rendererBuildData.materialAssetName != materialAsset->GetAssetName())
+					mbDrawCallLayoutChanged = true;
+
+				rendererBuildData.materialAssetName = materialAsset->GetAssetName();
+				rendererBuildData.materialTextureMask = textureMask;
+				if ((textureMask & MaterialAsset::ALBEDO_TEX_MASK) != 0)
+					rendererBuildData.albedoTexAssetName = materialAsset->GetAlbedoTexture()->GetAssetName();
+				if ((textureMask & MaterialAsset::METALLIC_TEX_MASK) != 0)
+					rendererBuildData.metallicTexAssetName = materialAsset->GetMetallicTexture()->GetAssetName();
+				if ((textureMask & MaterialAsset::ROUGHNESS_TEX_MASK) != 0)
+					rendererBuildData.roughnessTexAssetName = materialAsset->GetRoughnessTexture()->GetAssetName();
+				if ((textureMask & MaterialAsset::NORMAL_TEX_MASK) != 0)
+					rendererBuildData.normalTexAssetName = materialAsset->GetNormalTexture()->GetAssetName();
+				if ((textureMask & MaterialAsset::AO_TEX_MASK) != 0)
+					rendererBuildData.aoTexAssetName = materialAsset->GetAOTexture()->GetAssetName();
+			}
+		}
+
+		auto& slot = mObjectSlots[objectId];
+		slot.context = context;
+		slot.generation = meshComp.objectGeneration;
+		slot.meshId = meshId;
+		slot.instanceIndex = rendererBuildData.instanceCount;
+		meshComp.instanceId = slot.instanceIndex;
+
+		rendererBuildData.perInstanceData.emplace_back(objectId);
+		rendererBuildData.instanceCount += 1;
+
+		// a new draw call, or the draw call becomes an instanced one.
+		if (rendererBuildData.instanceCount <= 2)
+			mbDrawCallLayoutChanged = true;
+		MarkMeshInstanceChanged(meshId);
+		MarkObjectDirty(objectId);
+
+		if (rendererBuildData.instanceCount == 1)
+		{
+			mMeshAABBs[meshId] = meshComp.aabb;
+			mMeshBounds.Set(meshId, meshComp.aabb);
+		}
+		else
+		{
+			AABBMerge(mMeshAABBs[meshId], meshComp.aabb);
+			mMeshBounds.Set(meshId, mMeshAABBs[meshId]);
+		}
+	}
+
+	void RenderDataBuilder::RemoveObject(const Scene& scene, UInt32 objectId, UInt32 generation)
+	{
+		if (objectId >= mObjectSlots.size())
+			return;
+		auto& slot = mObjectSlots[objectId];
+		if (!slot.IsInRenderData() || slot.generation != generation)
+			return;
+
+		const UInt32 meshId = slot.meshId;
+		auto& rendererBuildData = mRenderMeshBuildDataMap[meshId];
+		auto& perInstanceData = rendererBuildData.perInstanceData;
+
+		// swap-remove, only the last instance moves.
+		const UInt32 lastObjectId = perInstanceData.back().objectId;
+		if (lastObjectId != objectId)
+		{
+			auto& lastSlot = mObjectSlots[lastObjectId];
+			perInstanceData[slot.instanceIndex].objectId = lastObjectId;
+			lastSlot.instanceIndex = slot.instanceIndex;
+			// the last one may be destroyed too, and its remove delta is coming.
+			if (scene.IsObjectAlive(lastObjectId, lastSlot.generation))
+				lastSlot.context.entity.template GetComponent<MeshComponent>().instanceId = lastSlot.instanceIndex;
+			MarkObjectDirty(lastObjectId);
+		}
+		perInstanceData.pop_back();
+		rendererBuildData.instanceCount -= 1;
+		const bool bDirty = slot.bDirty; // it may still be in the dirty list
+		slot = ObjectSlot();
+		slot.bDirty = bDirty;
+
+		if (rendererBuildData.instanceCount == 0)
+		{
+			mRenderMeshBuildDataMap.erase(meshId);
+			AABBReset(mMeshAABBs[meshId]);
+			mMeshBounds.Set(meshId, mMeshAABBs[meshId]);
+			mbDrawCallLayoutChanged = true;
+			return;
+		}
+
+		rendererBuildData.objectId = perInstanceData.front().objectId;
+		// the draw call becomes a non-instanced one.
+		if (rendererBuildData.instanceCount == 1)
+			mbDrawCallLayoutChanged = true;
+		MarkMeshInstanceChanged(meshId);
+
+		// the bounds stay conservative, they are tightened once they had been loosened enough.
+		if (++mMeshLooseUpdates[meshId] > rendererBuildData.instanceCount)
+			MarkMeshNeedRecalcBounds(meshId);
+	}
+
+	void RenderDataBuilder::OnObjectModified(const Scene& scene, UInt32 objectId, UInt32 generation)
+	{
+		if (objectId >= mObjectSlots.size())
+			return;
+		auto& slot = mObjectSlots[objectId];
+		if (!slot.IsInRenderData() || slot.generation != generation || !scene.IsObjectAlive(objectId, generation))
+			return;
+
+		MarkObjectDirty(objectId);
+
+		const UInt32 meshId = slot.meshId;
+		const AABB& aabb = slot.context.entity.template GetComponent<MeshComponent>().aabb;
+		const UInt32 instanceCount = mRenderMeshBuildDataMap[meshId].instanceCount;
+		if (instanceCount == 1)
+		{
+			mMeshAABBs[meshId] = aabb;
+		}
+		else
+		{
+			AABBMerge(mMeshAABBs[meshId], aabb);
+			if (++mMeshLooseUpdates[meshId] > instanceCount)
+				MarkMeshNeedRecalcBounds(meshId);
+		}
+		mMeshBounds.Set(meshId, mMeshAABBs[meshId]);
+	}
+
+	void RenderDataBuilder::MarkObjectDirty(UInt32 objectId)
+	{
+		auto& slot = mObjectSlots[objectId];
+		if (slot.bDirty)
+			return;
+		slot.bDirty = true;
+		mDirtyObjects.push_back(objectId);
+	}
+
+	void RenderDataBuilder::MarkMeshInstanceChanged(UInt32 meshId)
+	{
+		if ((mMeshFlags[meshId] & efInstanceChanged) != 0)
+			return;
+		mMeshFlags[meshId] |= efInstanceChanged;
+		mChangedInstanceMeshes.push_back(meshId);
+	}
+
+	void RenderDataBuilder::MarkMeshNeedRecalcBounds(UInt32 meshId)
+	{
+		if ((mMeshFlags[meshId] & efNeedRecalcBounds) != 0)
+			return;
+		mMeshFlags[meshId] |= efNeedRecalcBounds;
+		mRecalcBoundsMeshes.push_back(meshId);
+	}
+
+	void RenderDataBuilder::ResizeMeshBounds(Size numMesh)
+	{
+		// the meshes not in the scene keep the reset box, which is never visible.
+		const Size oldSize = mMeshAABBs.size();
+		mMeshAABBs.resize(numMesh);
+		mMeshBounds.Resize(numMesh);
+		mMeshLooseUpdates.resize(numMesh, 0);
+		mMeshFlags.resize(numMesh, 0);
+		for (Size i = oldSize; i < numMesh; ++i)
+		{
+			AABBReset(mMeshAABBs[i]);
+			mMeshBounds.Set(i, mMeshAABBs[i]);
+		}
+	}
+
+	void RenderDataBuilder::RecalcMeshBounds(const Scene& scene, UInt32 meshId)
+	{
+		auto& aabb = mMeshAABBs[meshId];
+		AABBReset(aabb);
+
+		auto node = mRenderMeshBuildDataMap.find(meshId);
+		if (node != mRenderMeshBuildDataMap.end())
+		{
+			for (auto& instance : node->second.perInstanceData)
+			{
+				auto& slot = mObjectSlots[instance.objectId];
+				if (scene.IsObjectAlive(instance.objectId, slot.generation)) // the destroyed ones are removed in the next frame
+					AABBMerge(aabb, slot.context.entity.template GetComponent<MeshComponent>().aabb);
+			}
+		}
+		mMeshBounds.Set(meshId, aabb);
+		mMeshLooseUpdates[meshId] = 0;
+	}
+
+	void RenderDataBuilder::UpdateMeshBounds()
+	{
+		SG_PROFILE_FUNCTION();
+
+		auto pScene = mpScene.lock();
+		if (!pScene || !mbIsRenderDataReady)
+			return;
+
+		for (auto meshId : mRecalcBoundsMeshes)
+		{
+			mMeshFlags[meshId] &= ~efNeedRecalcBounds;
+			RecalcMeshBounds(*pScene, meshId);
+		}
+		mRecalcBoundsMeshes.clear();
+	}
+
+	UInt32 RenderDataBuilder::CullMeshes(const Frustum& frustum, vector<UInt8>& meshVisibility) const
+	{
+		SG_PROFILE_FUNCTION();
+
+		meshVisibility.resize(mMeshBounds.GetSize());
+		if (meshVisibility.empty())
+			return 0;
+		return FrustumCullAABBs(frustum, mMeshBounds, meshVisibility.data());
 	}
 
 }
\ No newline at end of file
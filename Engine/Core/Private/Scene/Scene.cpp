@@ -15,35 +15,54 @@ namespace SG
 	namespace // anonymous namespace
 	{
 		IDAllocator<UInt32> gObjectIdAllocator;
+		// the object ids are global, so are the deltas of them. published to the scene in Scene::OnUpdate().
+		vector<Scene::MeshDelta> gPendingMeshDeltas;
+
+		void _PushMeshDelta(EMeshDeltaType type, const Scene::Entity& entity, const MeshComponent& comp)
+		{
+			Scene::MeshDelta delta;
+			delta.type = type;
+			delta.entity = entity;
+			delta.treeNode = delta.entity.GetComponent<TagComponent>().treeNode;
+			delta.objectId = comp.objectId;
+			delta.objectGeneration = comp.objectGeneration;
+			delta.meshId = comp.meshId;
+			gPendingMeshDeltas.push_back(delta);
+		}
 	}
 
 	static void _OnMeshComponentAdded(const Scene::Entity& entity, MeshComponent& comp)
 	{
 		comp.objectId = gObjectIdAllocator.Allocate();
+		comp.objectGeneration = gObjectIdAllocator.GetGeneration(comp.objectId);
+		_PushMeshDelta(EMeshDeltaType::eAdded, entity, comp);
 	}
 
 	static void _OnMeshComponentRemoved(const Scene::Entity& entity, MeshComponent& comp)
 	{
+		_PushMeshDelta(EMeshDeltaType::eRemoved, entity, comp);
 		gObjectIdAllocator.Restore(comp.objectId);
 	}
 
+	static void _OnMeshComponentModified(const Scene::Entity& entity, MeshComponent& comp)
+	{
+		_PushMeshDelta(EMeshDeltaType::eModified, entity, comp);
+	}
+
 	Scene::Scene()
 	{
 		mEntityManager.GetComponentHooker<MeshComponent>().HookOnAdded(_OnMeshComponentAdded);
 		mEntityManager.GetComponentHooker<MeshComponent>().HookOnRemoved(_OnMeshComponentRemoved);
+		mEntityManager.GetComponentHooker<MeshComponent>().HookOnModified(_OnMeshComponentModified);
 
 		mSkyboxEntity = mEntityManager.CreateEntity();
 		mSkyboxEntity.AddComponent<TagComponent>("__skybox");
 		auto& mesh = mSkyboxEntity.AddComponent<MeshComponent>();
 		LoadMesh(EGennerateMeshType::eSkybox, mesh);
-
-		mpRootNode = New(TreeNode);
-		SG_ASSERT(mpRootNode);
 	}
 
 	Scene::~Scene()
 	{
-		ClearTreeNodes();
 	}
 
 	void Scene::OnSceneLoad()
@@ -89,6 +108,8 @@ namespace SG
 
 		// clear all the object id in the mesh.
 		gObjectIdAllocator.Reset();
+		gPendingMeshDeltas.clear();
+		mMeshDeltas.clear();
 	}
 
 	void Scene::OnUpdate(float deltaTime)
@@ -108,8 +129,13 @@ namespace SG
 
 		//totalTime += deltaTime * speed;
 
+		UpdateWorldTransforms();
 		UpdateMeshAABB();
 		mEntityManager.ReFresh();
+
+		// publish the deltas of this frame, the ones emitted after this point go to the next frame.
+		mMeshDeltas.swap(gPendingMeshDeltas);
+		gPendingMeshDeltas.clear();
 	}
 
 	Scene::Entity* Scene::CreateEntity(const string& name)
@@ -127,9 +153,7 @@ namespace SG
 		SG_PROFILE_FUNCTION();
 
 		auto* pEntityContext = CreateEntityContextWithoutTreeNode(name);
-		pEntityContext->pTreeNode = New(TreeNode, &pEntityContext->entity);
-		pEntityContext->pTreeNode->pParent = mpRootNode;
-		mpRootNode->pChilds.emplace_back(pEntityContext->pTreeNode);
+		AddTreeNode(*pEntityContext);
 
 		return pEntityContext;
 	}
@@ -139,9 +163,7 @@ namespace SG
 		SG_PROFILE_FUNCTION();
 
 		auto* pEntityContext = CreateEntityContextWithoutTreeNode(name);
-		pEntityContext->pTreeNode = New(TreeNode, &pEntityContext->entity);
-		mpRootNode->pChilds.emplace_back(pEntityContext->pTreeNode);
-		pEntityContext->pTreeNode->pParent = mpRootNode;
+		AddTreeNode(*pEntityContext);
 
 		auto& trans = pEntityContext->entity.GetComponent<TransformComponent>();
 		trans.position = pos;
@@ -182,19 +204,14 @@ namespace SG
 		}
 
 		auto* pRootContext = CreateEntityContext(name);
-		auto* pRootNode = pRootContext->pTreeNode;
+		const NodeID rootNode = pRootContext->treeNode;
 
 		for (UInt32 i = 0; i < meshData.subMeshDatas.size(); ++i) // for each sub mesh data, create an entity
 		{
 			auto& subMesh = pSubMeshData ? *pSubMeshData : meshData.subMeshDatas[i];
 
 			auto* pEntityContext = CreateEntityContextWithoutTreeNode(subMesh.subMeshName);
-			auto* pSubMeshTreeNode = New(TreeNode, &pEntityContext->entity);
-			pEntityContext->pTreeNode = pSubMeshTreeNode;
-
-			// do connect
-			pSubMeshTreeNode->pParent = pRootNode;
-			pRootNode->pChilds.emplace_back(pSubMeshTreeNode);
+			AddTreeNode(*pEntityContext, rootNode);
 
 			// add necessary components
 			auto* pSubMeshEntity = &pEntityContext->entity;
@@ -224,18 +241,61 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-		auto& tag = entity.GetComponent<TagComponent>();
-		mEntityContexts.erase(tag.name);
-		mEntityManager.DestroyEntity(entity);
+		// copy the name, the tag component will be destroyed with the entity
+		const string name = entity.GetComponent<TagComponent>().name;
+		DestroyEntityByName(name);
 	}
 
 	void Scene::DestroyEntityByName(const string& name)
 	{
 		SG_PROFILE_FUNCTION();
 
-		auto* pEntity = GetEntityByName(name);
-		mEntityManager.DestroyEntity(*pEntity);
-		mEntityContexts.erase(name);
+		auto* pEntityContext = GetEntityContextByName(name);
+		if (!pEntityContext)
+			return;
+
+		eastl::vector<Entity*> removedEntities;
+		mHierarchy.RemoveNode(pEntityContext->treeNode, &removedEntities);
+		for (auto* pEntity : removedEntities)
+		{
+			if (pEntity->HasComponent<MeshComponent>())
+			{
+				auto& mesh = pEntity->GetComponent<MeshComponent>();
+				if (mesh.bvhProxyId != DynamicBVH::INVALID_PROXY)
+					mMeshBVH.DestroyProxy(mesh.bvhProxyId);
+				// destroying the entity do not call the hooks, remove the component to give back the object id.
+				pEntity->RemoveComponent<MeshComponent>();
+			}
+
+			const string entityName = pEntity->GetComponent<TagComponent>().name;
+			mEntityManager.DestroyEntity(*pEntity);
+			mEntityContexts.erase(entityName);
+		}
+	}
+
+	bool Scene::SetParent(const string& name, const string& parentName)
+	{
+		SG_PROFILE_FUNCTION();
+
+		auto* pEntityContext = GetEntityContextByName(name);
+		if (!pEntityContext)
+			return false;
+
+		NodeID parentNode = SceneHierarchy::ROOT_NODE;
+		if (!parentName.empty())
+		{
+			auto* pParentContext = GetEntityContextByName(parentName);
+			if (!pParentContext)
+				return false;
+			parentNode = pParentContext->treeNode;
+		}
+
+		if (!mHierarchy.Reparent(pEntityContext->treeNode, parentNode))
+		{
+			SG_LOG_WARN("Can not move entity %s under its descendant %s", name.c_str(), parentName.c_str());
+			return false;
+		}
+		return true;
 	}
 
 	Scene::Entity* Scene::GetEntityByName(const string& name)
@@ -282,6 +342,13 @@ namespace SG
 		return &context;
 	}
 
+	Scene::NodeID Scene::AddTreeNode(EntityContext& context, NodeID parentNode)
+	{
+		context.treeNode = mHierarchy.AddNode(&context.entity, parentNode);
+		context.entity.GetComponent<TagComponent>().treeNode = context.treeNode;
+		return context.treeNode;
+	}
+
 	void Scene::DefaultScene()
 	{
 		SG_PROFILE_FUNCTION();
@@ -376,13 +443,15 @@ namespace SG
 		node["Scene"] = "My Default Scene";
 		node["Entities"] = {};
 
-		for (auto* pChild : mpRootNode->pChilds)
-			SerializeEntity(pChild, node["Entities"].emplace_back());
+		mHierarchy.TraverseChildren(SceneHierarchy::ROOT_NODE, [this, &node](NodeID child)
+			{
+				SerializeEntity(child, node["Entities"].emplace_back());
+			});
 	}
 
-	void Scene::SerializeEntity(Scene::TreeNode* pTreeNode, json& node)
+	void Scene::SerializeEntity(NodeID treeNode, json& node)
 	{
-		auto& entity = *pTreeNode->pEntity;
+		auto& entity = *mHierarchy.GetEntity(treeNode);
 		node["EntityID"] = "2468517968452275"; // TEMPORARY
 
 		auto& tagNode = node["TagComponent"];
@@ -499,11 +568,13 @@ namespace SG
 			}
 		}
 
-		if (!pTreeNode->pChilds.empty()) // this node have children
+		if (mHierarchy.HasChild(treeNode)) // this node have children
 		{
 			node["Children"] = {};
-			for (auto* pChild : pTreeNode->pChilds)
-				SerializeEntity(pChild, node["Children"].emplace_back());
+			mHierarchy.TraverseChildren(treeNode, [this, &node](NodeID child)
+				{
+					SerializeEntity(child, node["Children"].emplace_back());
+				});
 		}
 	}
 
@@ -511,47 +582,65 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-		string sceneName = node["Scene"].get<std::string>().c_str();
-		auto& entities = node["Entities"];
-		if (entities.is_array() && !entities.empty())
+		// json is only an import format, convert it to the binary scene and load from it
+		vector<Byte> binary;
+		if (!SceneBinary::FromJson(node, binary) || !DeserializeBinary(binary.data(), binary.size()))
+			SG_LOG_ERROR("Failed to deserialize the scene!");
+	}
+
+	void Scene::SerializeBinary(vector<Byte>& outData)
+	{
+		SG_PROFILE_FUNCTION();
+
+		json node;
+		Serialize(node);
+		SceneBinary::FromJson(node, outData);
+	}
+
+	bool Scene::DeserializeBinary(const Byte* pData, Size sizeInByte)
+	{
+		SG_PROFILE_FUNCTION();
+
+		SceneBinaryView view;
+		if (!view.Init(pData, sizeInByte))
+			return false;
+
+		// a parent is always stored before its children, so the tree can be built in one pass
+		vector<NodeID> treeNodes(view.GetEntityCount(), SceneHierarchy::INVALID_NODE);
+		for (UInt32 i = 0; i < view.GetEntityCount(); ++i)
 		{
-			for (auto& entity : entities)
-				DeserializeEntity(mpRootNode, entity);
+			const auto& entity = view.GetEntity(i);
+			const NodeID parentNode = entity.parent == SG_SCENE_BINARY_INVALID ? SceneHierarchy::ROOT_NODE : treeNodes[entity.parent];
+			treeNodes[i] = DeserializeEntity(view, entity, parentNode);
 		}
 
 		Refresh();
+		return true;
 	}
 
-	void Scene::DeserializeEntity(Scene::TreeNode* pTreeNode, json& entity)
+	Scene::NodeID Scene::DeserializeEntity(const SceneBinaryView& view, const SceneBinaryEntity& entity, NodeID parentNode)
 	{
-		auto& tagComp = entity["TagComponent"];
-		string name = tagComp["Name"].get<std::string>().c_str();
-
-		auto& transComp = entity["TransformComponent"];
-		auto* pEntityContext = CreateEntityContextWithoutTreeNode(name);
+		auto* pEntityContext = CreateEntityContextWithoutTreeNode(view.GetString(entity.name));
 		auto* pEntity = &(pEntityContext->entity);
 		auto& trans = pEntity->GetComponent<TransformComponent>();
-		transComp["Position"].get_to(trans.position);
-		transComp["Scale"].get_to(trans.scale);
-		transComp["Rotation"].get_to(trans.rotation);
+		trans.position = entity.position;
+		trans.scale = entity.scale;
+		trans.rotation = entity.rotation;
 
 		// create a tree node and do connect
-		auto* pCurrTreeNode = New(TreeNode, pEntity);
-		pEntityContext->pTreeNode = pCurrTreeNode;
-		pCurrTreeNode->pParent = pTreeNode;
-		pTreeNode->pChilds.emplace_back(pCurrTreeNode);
+		const NodeID currTreeNode = AddTreeNode(*pEntityContext, parentNode);
 
-		if (auto node = entity.find("MeshComponent"); node != entity.end())
+		if (view.HaveBlock(entity, ESceneBinaryBlock::eMesh))
 		{
-			auto& meshComp = *node;
+			const auto& meshBlock = view.GetBlock<SceneBinaryMesh>(entity, ESceneBinaryBlock::eMesh);
 
-			string filename = meshComp["Filename"].get<std::string>().c_str();
-			string subMeshName = meshComp["SubMeshName"].get<std::string>().c_str();
-			bool bIsProceduralMesh = meshComp["IsProceduralMesh"].get<bool>();
-			bool bHaveEmbeddedResource = meshComp["HaveEmbeddedResource"].get<bool>();
+			string filename = view.GetString(meshBlock.filename);
+			const char* subMeshName = view.GetString(meshBlock.subMeshName);
+			bool bHaveEmbeddedResource = (meshBlock.flags & SceneBinaryMesh::efEmbeddedResource) != 0;
+			bool bHaveAABB = (meshBlock.flags & SceneBinaryMesh::efHaveAABB) != 0;
 			auto& mesh = pEntity->AddComponent<MeshComponent>();
 
-			if (bIsProceduralMesh)
+			if ((meshBlock.flags & SceneBinaryMesh::efProceduralMesh) != 0)
 			{
 				if (filename == "_generated_grid")
 					LoadMesh(EGennerateMeshType::eGrid, mesh);
@@ -560,166 +649,112 @@ namespace SG
 			}
 			else
 			{
-				EMeshType type = (EMeshType)meshComp["Type"];
+				EMeshType type = (EMeshType)meshBlock.type;
 				ELoadMeshFlag flag = bHaveEmbeddedResource ? ELoadMeshFlag::efLoadEmbeddedMaterials : ELoadMeshFlag(0);
-				if (meshComp.find("AABB") == meshComp.end())
+				if (!bHaveAABB)
 					flag |= ELoadMeshFlag::efGenerateAABB;
-				LoadMesh(filename.c_str(), subMeshName.c_str(), type, mesh, flag);
+				LoadMesh(filename.c_str(), subMeshName, type, mesh, flag);
 
-				if (meshComp.find("AABB") != meshComp.end())
+				if (bHaveAABB)
 				{
 					auto* pSubMeshData = MeshDataArchive::GetInstance()->GetData(subMeshName);
-					meshComp["AABB"].get_to(pSubMeshData->aabb);
+					pSubMeshData->aabb = meshBlock.aabb;
 				}
 			}
 		}
 
-		if (auto node = entity.find("MaterialComponent"); node != entity.end())
+		if (view.HaveBlock(entity, ESceneBinaryBlock::eMaterial))
 		{
-			auto& matComp = *node;
+			const auto& matBlock = view.GetBlock<SceneBinaryMaterial>(entity, ESceneBinaryBlock::eMaterial);
 
 			auto& mat = pEntity->AddComponent<MaterialComponent>();
 
-			string assetName = matComp["AssetName"].get<std::string>().c_str();
-			string filename = matComp["Filename"].get<std::string>().c_str();
+			string assetName = view.GetString(matBlock.assetName);
+			string filename = view.GetString(matBlock.filename);
 
 			if (!filename.empty()) // it is a embedded material
 			{
 				mat.materialAsset = MaterialAssetArchive::GetInstance()->GetMaterialAsset(assetName);
 				auto materialAsset = mat.materialAsset.lock();
 
-				materialAsset->SetAlbedo(matComp["Albedo"].get<Vector3f>());
-				materialAsset->SetMetallic(matComp["Metallic"].get<float>());
-				materialAsset->SetRoughness(matComp["Roughness"].get<float>());
+				materialAsset->SetAlbedo(matBlock.albedo);
+				materialAsset->SetMetallic(matBlock.metallic);
+				materialAsset->SetRoughness(matBlock.roughness);
 			}
 			else // create an asset
 			{
 				auto materialAsset = MaterialAssetArchive::GetInstance()->NewMaterialAsset(assetName, filename);
 				mat.materialAsset = materialAsset;
 
-				materialAsset->SetAlbedo(matComp["Albedo"].get<Vector3f>());
-				materialAsset->SetMetallic(matComp["Metallic"].get<float>());
-				materialAsset->SetRoughness(matComp["Roughness"].get<float>());
-
-				if (auto n = matComp.find("AlbedoTextureAsset"); n != matComp.end())
-				{
-					auto& node = *n;
-					string texFilename = node["Filename"].get<std::string>().c_str();
-					if (texFilename != filename) // it is not an embedded textures, loaded it explicitly
-					{
-						materialAsset->SetAlbedoTexture(TextureAssetArchive::GetInstance()->NewTextureAsset("", texFilename));
-						materialAsset->GetAlbedoTexture()->Deserialize(node);
-					}
-					else // it is an embedded textures, check to see if it is successfully loaded
-					{
-						SG_ASSERT(materialAsset->GetAlbedoTexture()->GetFileName() == texFilename);
-					}
-				}
-
-				if (auto n = matComp.find("MetallicTextureAsset"); n != matComp.end())
-				{
-					auto& node = *n;
-					string texFilename = node["Filename"].get<std::string>().c_str();
-					if (texFilename != filename) // it is not an embedded textures, loaded it explicitly
-					{
-						materialAsset->SetMetallicTexture(TextureAssetArchive::GetInstance()->NewTextureAsset("", texFilename));
-						materialAsset->GetMetallicTexture()->Deserialize(node);
-					}
-					else // it is an embedded textures, check to see if it is successfully loaded
-					{
-						SG_ASSERT(materialAsset->GetMetallicTexture()->GetFileName() == texFilename);
-					}
-				}
-
-				if (auto n = matComp.find("RoughnessTextureAsset"); n != matComp.end())
-				{
-					auto& node = *n;
-					string texFilename = node["Filename"].get<std::string>().c_str();
-					if (texFilename != filename) // it is not an embedded textures, loaded it explicitly
-					{
-						materialAsset->SetRoughnessTexture(TextureAssetArchive::GetInstance()->NewTextureAsset("", texFilename));
-						materialAsset->GetRoughnessTexture()->Deserialize(node);
-					}
-					else // it is an embedded textures, check to see if it is successfully loaded
-					{
-						SG_ASSERT(materialAsset->GetRoughnessTexture()->GetFileName() == texFilename);
-					}
-				}
-
-				if (auto n = matComp.find("NormalTextureAsset"); n != matComp.end())
-				{
-					auto& node = *n;
-					string texFilename = node["Filename"].get<std::string>().c_str();
-					if (texFilename != filename) // it is not an embedded textures, loaded it explicitly
-					{
-						materialAsset->SetNormalTexture(TextureAssetArchive::GetInstance()->NewTextureAsset("", texFilename));
-						materialAsset->GetNormalTexture()->Deserialize(node);
-					}
-					else // it is an embedded textures, check to see if it is successfully loaded
-					{
-						SG_ASSERT(materialAsset->GetNormalTexture()->GetFileName() == texFilename);
-					}
-				}
+				materialAsset->SetAlbedo(matBlock.albedo);
+				materialAsset->SetMetallic(matBlock.metallic);
+				materialAsset->SetRoughness(matBlock.roughness);
 
-				if (auto n = matComp.find("AOTextureAsset"); n != matComp.end())
+				for (UInt32 i = 0; i < (UInt32)ESceneBinaryTexture::NUM_TEXTURES; ++i)
 				{
-					auto& node = *n;
-					string texFilename = node["Filename"].get<std::string>().c_str();
-					if (texFilename != filename) // it is not an embedded textures, loaded it explicitly
-					{
-						materialAsset->SetAOTexture(TextureAssetArchive::GetInstance()->NewTextureAsset("", texFilename));
-						materialAsset->GetAOTexture()->Deserialize(node);
-					}
-					else // it is an embedded textures, check to see if it is successfully loaded
+					if ((matBlock.textureMask & (1 << i)) == 0)
+						continue;
+
+					const auto& texBlock = matBlock.textures[i];
+					string texFilename = view.GetString(texBlock.filename);
+					if (texFilename == filename) // it is an embedded textures, it should had been loaded with the material
+						continue;
+
+					// it is not an embedded textures, loaded it explicitly
+					auto pTexAsset = TextureAssetArchive::GetInstance()->NewTextureAsset(view.GetString(texBlock.name), texFilename,
+						(texBlock.flags & SceneBinaryTexture::efNeedMipmap) != 0, (texBlock.flags & SceneBinaryTexture::efIsCubeMap) != 0);
+					switch ((ESceneBinaryTexture)i)
 					{
-						SG_ASSERT(materialAsset->GetAOTexture()->GetFileName() == texFilename);
+					case ESceneBinaryTexture::eAlbedo:    materialAsset->SetAlbedoTexture(pTexAsset); break;
+					case ESceneBinaryTexture::eMetallic:  materialAsset->SetMetallicTexture(pTexAsset); break;
+					case ESceneBinaryTexture::eRoughness: materialAsset->SetRoughnessTexture(pTexAsset); break;
+					case ESceneBinaryTexture::eNormal:    materialAsset->SetNormalTexture(pTexAsset); break;
+					case ESceneBinaryTexture::eAO:        materialAsset->SetAOTexture(pTexAsset); break;
+					default: SG_ASSERT(false); break;
 					}
 				}
 			}
 		}
 
-		if (auto node = entity.find("PointLightComponent"); node != entity.end())
+		if (view.HaveBlock(entity, ESceneBinaryBlock::ePointLight))
 		{
-			auto& pointLightComp = *node;
+			const auto& lightBlock = view.GetBlock<SceneBinaryPointLight>(entity, ESceneBinaryBlock::ePointLight);
 
 			auto& light = pEntity->AddComponent<PointLightComponent>();
-			pointLightComp["Color"].get_to<Vector3f>(light.color);
-			pointLightComp["Radius"].get_to(light.radius);
+			light.color = lightBlock.color;
+			light.radius = lightBlock.radius;
 		}
 
-		if (auto node = entity.find("DirectionalLightComponent"); node != entity.end())
+		if (view.HaveBlock(entity, ESceneBinaryBlock::eDirectionalLight))
 		{
-			auto& directionalLightComp = *node;
+			const auto& lightBlock = view.GetBlock<SceneBinaryDirectionalLight>(entity, ESceneBinaryBlock::eDirectionalLight);
 
 			auto& light = pEntity->AddComponent<DirectionalLightComponent>();
-			directionalLightComp["Color"].get_to(light.color);
-			directionalLightComp["ShadowMapScaleFactor"].get_to(light.shadowMapScaleFactor);
-			directionalLightComp["zNear"].get_to(light.zNear);
-			directionalLightComp["zFar"].get_to(light.zFar);
+			light.color = lightBlock.color;
+			light.shadowMapScaleFactor = lightBlock.shadowMapScaleFactor;
+			light.zNear = lightBlock.zNear;
+			light.zFar = lightBlock.zFar;
 		}
 
-		if (auto node = entity.find("CameraComponent"); node != entity.end())
+		if (view.HaveBlock(entity, ESceneBinaryBlock::eCamera))
 		{
-			auto& cameraComp = *node;
+			const auto& camBlock = view.GetBlock<SceneBinaryCamera>(entity, ESceneBinaryBlock::eCamera);
 			auto& cam = pEntity->AddComponent<CameraComponent>();
 
 			cam.type = ECameraType::eFirstPerson;
-			auto FPSCam = MakeRef<FirstPersonCamera>(cameraComp["CameraPos"].get<Vector3f>());
-			FPSCam->SetUpVector(cameraComp["UpVector"].get<Vector3f>());
-			FPSCam->SetRightVector(cameraComp["RightVector"].get<Vector3f>());
-			FPSCam->SetFrontVector(cameraComp["FrontVector"].get<Vector3f>());
+			auto FPSCam = MakeRef<FirstPersonCamera>(camBlock.position);
+			if ((camBlock.flags & SceneBinaryCamera::efHaveVectors) != 0)
+			{
+				FPSCam->SetUpVector(camBlock.upVector);
+				FPSCam->SetRightVector(camBlock.rightVector);
+				FPSCam->SetFrontVector(camBlock.frontVector);
+			}
 			cam.pCamera = FPSCam;
-			cam.pCamera->SetMoveSpeed(cameraComp["CameraMoveSpeed"].get<float>());
+			cam.pCamera->SetMoveSpeed(camBlock.moveSpeed);
 			mpCameraEntity = pEntity;
 		}
 
-		// if this node have child
-		auto& children = entity["Children"];
-		if (children.is_array() && !children.empty())
-		{
-			for (auto& child : children)
-				DeserializeEntity(pCurrTreeNode, child);
-		}
+		return currTreeNode;
 	}
 
 	void Scene::Refresh()
@@ -727,6 +762,8 @@ namespace SG
 		SG_PROFILE_FUNCTION();
 
 		mEntityManager.ReFresh();
+		UpdateWorldTransforms();
+		UpdateMeshAABB();
 
 		mMeshEntityCount = 0;
 		for (auto node : mEntityContexts)
@@ -737,44 +774,79 @@ namespace SG
 		}
 	}
 
-	void Scene::ClearTreeNodes()
+	void Scene::UpdateWorldTransforms()
 	{
 		SG_PROFILE_FUNCTION();
 
-		FreeTreeNode(mpRootNode);
+		// the hierarchy is stored parent-first, so one linear pass is enough.
+		// a node only need to recompute its world transform when itself or one of its ancestors had changed.
+		mHierarchy.UpdateWorldTransforms([](Entity& entity, Matrix4f& localTransform, bool bForceUpdate)
+			{
+				auto [tag, trans] = entity.GetComponent<TagComponent, TransformComponent>();
+				if (!tag.bDirty && !bForceUpdate)
+					return false;
+
+				localTransform = GetTransform(trans);
+				// let the AABB and the renderer know that the transform (or the material) of this mesh had changed.
+				// the lights are still picked up by the renderer through the dirty flag.
+				if (entity.HasComponent<MeshComponent>())
+					entity.NotifyModified<MeshComponent>();
+				tag.bDirty = entity.HasComponent<PointLightComponent>() || entity.HasComponent<DirectionalLightComponent>();
+				return true;
+			});
 	}
 
-	void Scene::FreeTreeNode(TreeNode* pTreeNode)
+	void Scene::UpdateMeshAABB()
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (pTreeNode->pChilds.empty()) // it is a leaf node
+		UInt32 numNewProxies = 0;
+		// only the meshes had been added or modified need to update their AABBs.
+		for (auto& delta : gPendingMeshDeltas)
 		{
-			Delete(pTreeNode);
-			return;
-		}
+			if (delta.type == EMeshDeltaType::eRemoved || delta.treeNode == SceneHierarchy::INVALID_NODE || // not in the hierarchy (e.g. the skybox)
+				!IsObjectAlive(delta.objectId, delta.objectGeneration))
+				continue;
 
-		for (auto* pChild : pTreeNode->pChilds)
-			FreeTreeNode(pChild);
-		Delete(pTreeNode);
-	}
+			auto& mesh = delta.entity.GetComponent<MeshComponent>();
+			const auto* pSubMeshData = MeshDataArchive::GetInstance()->GetData(mesh.meshId);
+			mesh.aabb = AABBTransform(pSubMeshData->aabb, GetWorldTransform(delta.treeNode));
 
-	void Scene::UpdateMeshAABB()
-	{
-		// update AABB for the meshes
-		auto view = View<TagComponent, TransformComponent, MeshComponent>();
-		for (auto& entity : view)
-		{
-			auto [tag, trans, mesh] = entity.GetComponent<TagComponent, TransformComponent, MeshComponent>();
-			if (tag.bDirty)
+			if (mesh.bvhProxyId == DynamicBVH::INVALID_PROXY)
+			{
+				mesh.bvhProxyId = mMeshBVH.CreateProxy(mesh.aabb, delta.treeNode);
+				++numNewProxies;
+			}
+			else
 			{
-				const auto* pSubMeshData = MeshDataArchive::GetInstance()->GetData(mesh.meshId);
-				const auto* pEntityContext = GetEntityContextByName(tag.name);
-				mesh.aabb = AABBTransform(pSubMeshData->aabb, GetTransform(pEntityContext->pTreeNode));
+				mMeshBVH.MoveProxy(mesh.bvhProxyId, mesh.aabb);
 			}
-			// here we ain't going to mark dirty flag as false, because the renderer will use it again
-			// the renderer will mark it as false
 		}
+
+		// most of the proxies are new (e.g. the scene is just loaded), a SAH build gives a better tree than the insertions.
+		if (numNewProxies > 1 && numNewProxies * 2 > mMeshBVH.GetNumProxies())
+			mMeshBVH.Rebuild();
+	}
+
+	Scene::Entity* Scene::RayCastMeshEntity(const Vector3f& origin, const Vector3f& direction, float maxDistance)
+	{
+		SG_PROFILE_FUNCTION();
+
+		UInt32 treeNode;
+		float distance;
+		if (!mMeshBVH.RayCast(origin, direction, maxDistance, treeNode, distance))
+			return nullptr;
+		return mHierarchy.GetEntity(treeNode);
+	}
+
+	void Scene::QueryMeshEntities(const Frustum& frustum, vector<NodeID>& outTreeNodes) const
+	{
+		mMeshBVH.QueryFrustum(frustum, outTreeNodes);
+	}
+
+	bool Scene::IsObjectAlive(UInt32 objectId, UInt32 objectGeneration) const
+	{
+		return gObjectIdAllocator.IsAlive(objectId, objectGeneration);
 	}
 
 }
\ No newline at end of file
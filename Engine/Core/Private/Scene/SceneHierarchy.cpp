@@ -0,0 +1,256 @@
+#include "StdAfx.h"
+#include "Scene/SceneHierarchy.h"
+
+#include "Profile/Profile.h"
+
+namespace SG
+{
+
+	SceneHierarchy::SceneHierarchy()
+	{
+		Clear();
+	}
+
+	SceneHierarchy::NodeID SceneHierarchy::AddNode(Entity* pEntity, NodeID parent)
+	{
+		SG_PROFILE_FUNCTION();
+
+		SG_ASSERT(IsValid(parent));
+
+		NodeID id = INVALID_NODE;
+		if (!mFreeIds.empty())
+		{
+			id = mFreeIds.back();
+			mFreeIds.pop_back();
+		}
+		else
+		{
+			id = (NodeID)mIdToIndex.size();
+			mIdToIndex.push_back(INVALID_NODE);
+		}
+
+		// always append to the end of the arrays, the parent is already in the arrays,
+		// so it is still stored before its children.
+		const UInt32 index = (UInt32)mEntities.size();
+		mIdToIndex[id] = index;
+		mIndexToId.push_back(id);
+		mEntities.push_back(pEntity);
+		mParents.push_back(INVALID_NODE);
+		mFirstChilds.push_back(INVALID_NODE);
+		mLastChilds.push_back(INVALID_NODE);
+		mNextSiblings.push_back(INVALID_NODE);
+		mLocalTransforms.push_back(Matrix4f(1.0f));
+		mWorldTransforms.push_back(Matrix4f(1.0f));
+		mForceUpdateFlags.push_back(1);
+		mChangedFlags.push_back(0);
+
+		LinkAsLastChild(index, mIdToIndex[parent]);
+		return id;
+	}
+
+	void SceneHierarchy::RemoveNode(NodeID node, eastl::vector<Entity*>* pRemovedEntities)
+	{
+		SG_PROFILE_FUNCTION();
+
+		SG_ASSERT(node != ROOT_NODE && IsValid(node));
+
+		const UInt32 index = mIdToIndex[node];
+		Unlink(index);
+
+		// remove the whole sub-tree, the slots are left in the arrays until the next compaction
+		eastl::vector<UInt32> nodesToRemove;
+		nodesToRemove.push_back(index);
+		while (!nodesToRemove.empty())
+		{
+			const UInt32 curr = nodesToRemove.back();
+			nodesToRemove.pop_back();
+			for (UInt32 child = mFirstChilds[curr]; child != INVALID_NODE; child = mNextSiblings[child])
+				nodesToRemove.push_back(child);
+
+			if (pRemovedEntities)
+				pRemovedEntities->push_back(mEntities[curr]);
+
+			const NodeID id = mIndexToId[curr];
+			mIdToIndex[id] = INVALID_NODE;
+			mFreeIds.push_back(id);
+
+			mIndexToId[curr] = INVALID_NODE;
+			mEntities[curr] = nullptr;
+			mFirstChilds[curr] = INVALID_NODE;
+			mLastChilds[curr] = INVALID_NODE;
+			++mNumRemovedSlots;
+		}
+
+		// amortize the cost of compaction, only do it when a lot of slots are wasted
+		if (mNumRemovedSlots > 64 && mNumRemovedSlots * 4 > mEntities.size())
+			mbNeedCompact = true;
+	}
+
+	bool SceneHierarchy::Reparent(NodeID node, NodeID newParent)
+	{
+		SG_PROFILE_FUNCTION();
+
+		SG_ASSERT(node != ROOT_NODE && IsValid(node) && IsValid(newParent));
+
+		const UInt32 index = mIdToIndex[node];
+		const UInt32 newParentIndex = mIdToIndex[newParent];
+
+		// can not move a node under itself or its descendants
+		for (UInt32 curr = newParentIndex; curr != INVALID_NODE; curr = mParents[curr])
+		{
+			if (curr == index)
+				return false;
+		}
+
+		if (mParents[index] == newParentIndex)
+			return true;
+
+		Unlink(index);
+		LinkAsLastChild(index, newParentIndex);
+		mForceUpdateFlags[index] = 1;
+
+		// the descendants of the node are all stored after it,
+		// if the new parent is stored after the node, the arrays need to be reordered.
+		if (newParentIndex > index)
+			mbNeedCompact = true;
+		return true;
+	}
+
+	void SceneHierarchy::Clear()
+	{
+		mEntities.clear();
+		mParents.clear();
+		mFirstChilds.clear();
+		mLastChilds.clear();
+		mNextSiblings.clear();
+		mLocalTransforms.clear();
+		mWorldTransforms.clear();
+		mForceUpdateFlags.clear();
+		mChangedFlags.clear();
+		mIndexToId.clear();
+		mIdToIndex.clear();
+		mFreeIds.clear();
+		mNumRemovedSlots = 0;
+		mbNeedCompact = false;
+
+		// the root node
+		mEntities.push_back(nullptr);
+		mParents.push_back(INVALID_NODE);
+		mFirstChilds.push_back(INVALID_NODE);
+		mLastChilds.push_back(INVALID_NODE);
+		mNextSiblings.push_back(INVALID_NODE);
+		mLocalTransforms.push_back(Matrix4f(1.0f));
+		mWorldTransforms.push_back(Matrix4f(1.0f));
+		mForceUpdateFlags.push_back(0);
+		mChangedFlags.push_back(0);
+		mIndexToId.push_back(ROOT_NODE);
+		mIdToIndex.push_back(ROOT_NODE);
+	}
+
+	void SceneHierarchy::Compact()
+	{
+		SG_PROFILE_FUNCTION();
+
+		const UInt32 numNodes = GetNodeCount() + 1;
+
+		// collect the nodes in depth-first order, the removed nodes are not reachable from the root
+		eastl::vector<UInt32> order;
+		order.reserve(numNodes);
+		eastl::vector<UInt32> nodesToVisit;
+		nodesToVisit.push_back(ROOT_NODE);
+		eastl::vector<UInt32> childs;
+		while (!nodesToVisit.empty())
+		{
+			const UInt32 curr = nodesToVisit.back();
+			nodesToVisit.pop_back();
+			order.push_back(curr);
+
+			// push the children reversely, so that the first child will be visited first
+			childs.clear();
+			for (UInt32 child = mFirstChilds[curr]; child != INVALID_NODE; child = mNextSiblings[child])
+				childs.push_back(child);
+			for (auto it = childs.rbegin(); it != childs.rend(); ++it)
+				nodesToVisit.push_back(*it);
+		}
+		SG_ASSERT(order.size() == numNodes);
+
+		eastl::vector<UInt32> oldToNew(mEntities.size(), INVALID_NODE);
+		for (UInt32 i = 0; i < numNodes; ++i)
+			oldToNew[order[i]] = i;
+
+		auto remap = [&oldToNew](UInt32 index) { return index == INVALID_NODE ? INVALID_NODE : oldToNew[index]; };
+
+		eastl::vector<Entity*>  entities(numNodes);
+		eastl::vector<UInt32>   parents(numNodes);
+		eastl::vector<UInt32>   firstChilds(numNodes);
+		eastl::vector<UInt32>   lastChilds(numNodes);
+		eastl::vector<UInt32>   nextSiblings(numNodes);
+		eastl::vector<Matrix4f> localTransforms(numNodes);
+		eastl::vector<Matrix4f> worldTransforms(numNodes);
+		eastl::vector<UInt8>    forceUpdateFlags(numNodes);
+		eastl::vector<UInt8>    changedFlags(numNodes);
+		eastl::vector<NodeID>   indexToId(numNodes);
+		for (UInt32 i = 0; i < numNodes; ++i)
+		{
+			const UInt32 old = order[i];
+			entities[i] = mEntities[old];
+			parents[i] = remap(mParents[old]);
+			firstChilds[i] = remap(mFirstChilds[old]);
+			lastChilds[i] = remap(mLastChilds[old]);
+			nextSiblings[i] = remap(mNextSiblings[old]);
+			localTransforms[i] = mLocalTransforms[old];
+			worldTransforms[i] = mWorldTransforms[old];
+			forceUpdateFlags[i] = mForceUpdateFlags[old];
+			changedFlags[i] = mChangedFlags[old];
+			indexToId[i] = mIndexToId[old];
+			mIdToIndex[indexToId[i]] = i;
+		}
+
+		mEntities.swap(entities);
+		mParents.swap(parents);
+		mFirstChilds.swap(firstChilds);
+		mLastChilds.swap(lastChilds);
+		mNextSiblings.swap(nextSiblings);
+		mLocalTransforms.swap(localTransforms);
+		mWorldTransforms.swap(worldTransforms);
+		mForceUpdateFlags.swap(forceUpdateFlags);
+		mChangedFlags.swap(changedFlags);
+		mIndexToId.swap(indexToId);
+
+		mNumRemovedSlots = 0;
+		mbNeedCompact = false;
+	}
+
+	void SceneHierarchy::LinkAsLastChild(UInt32 index, UInt32 parentIndex)
+	{
+		mParents[index] = parentIndex;
+		mNextSiblings[index] = INVALID_NODE;
+		if (mLastChilds[parentIndex] == INVALID_NODE)
+			mFirstChilds[parentIndex] = index;
+		else
+			mNextSiblings[mLastChilds[parentIndex]] = index;
+		mLastChilds[parentIndex] = index;
+	}
+
+	void SceneHierarchy::Unlink(UInt32 index)
+	{
+		const UInt32 parentIndex = mParents[index];
+		if (parentIndex == INVALID_NODE)
+			return;
+
+		UInt32 prev = INVALID_NODE;
+		for (UInt32 child = mFirstChilds[parentIndex]; child != index; child = mNextSiblings[child])
+			prev = child;
+
+		if (prev == INVALID_NODE)
+			mFirstChilds[parentIndex] = mNextSiblings[index];
+		else
+			mNextSiblings[prev] = mNextSiblings[index];
+		if (mLastChilds[parentIndex] == index)
+			mLastChilds[parentIndex] = prev;
+
+		mParents[index] = INVALID_NODE;
+		mNextSiblings[index] = INVALID_NODE;
+	}
+
+}
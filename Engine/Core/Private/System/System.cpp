@@ -4,6 +4,8 @@
 #include "System/FileSystem.h"
 #include "System/Logger.h"
 #include "System/Input.h"
+#include "Thread/IJobSystem.h"
+#include "Archive/AsyncResourceLoader.h"
 #include "User/IApp.h"
 #include "Event/MessageBus/MessageBus.h"
 #include "Archive/Serialization.h"
@@ -17,6 +19,10 @@
 #include "Memory/Memory.h"
 #include "Profile/Profile.h"
 
+#if SG_PLATFORM_LINUX
+#	include <unistd.h> // readlink()
+#endif
+
 namespace SG
 {
 
@@ -31,10 +37,14 @@ namespace SG
 		char abPath[SG_MAX_FILE_PATH] = { 0 };
 		::GetModuleFileNameA(NULL, abPath, sizeof(abPath));
 		string myProcessPath = abPath;
+#elif SG_PLATFORM_LINUX
+		char abPath[SG_MAX_FILE_PATH] = { 0 };
+		const ssize_t pathLength = ::readlink("/proc/self/exe", abPath, sizeof(abPath) - 1);
+		string myProcessPath = pathLength > 0 ? string(abPath, abPath + pathLength) : string(".");
 #else
 #	error Can not set the default root path in this platform.
 #endif
-		Size slashPos = myProcessPath.find_last_of('\\');
+		Size slashPos = myProcessPath.find_last_of("\\/");
 		myProcessPath = myProcessPath.substr(0, slashPos);
 		SetRootPath(myProcessPath);
 
@@ -48,6 +58,10 @@ namespace SG
 		mMainThread.pFunc = nullptr;
 		mMainThread.pHandle = nullptr;
 		mMainThread.pUser = nullptr;
+		mMainThread.id = GetCurrThreadID();
+
+		JobSystem::OnInit();
+		AsyncResourceLoader::OnInit();
 
 		if (mpCurrActiveProcess)
 			mpCurrActiveProcess->OnInit();
@@ -81,6 +95,9 @@ namespace SG
 		mp3DScene->OnSceneUnLoad();
 		mpGUIDriver->OnShutdown();
 
+		AsyncResourceLoader::OnShutdown();
+		JobSystem::OnShutdown();
+
 		OperatingSystem::OnShutdown();
 		Input::OnShutdown();
 
@@ -124,8 +141,13 @@ namespace SG
 			// update input messages
 			Input::OnUpdate(deltaTime);
 
+			// deliver the resources streamed in by the background workers
+			AsyncResourceLoader::OnUpdate();
+
 			mpGUIDriver->OnUpdate(deltaTime);
 			mp3DScene->OnUpdate(deltaTime);
+			// patch the render data with the changes of the scene in this frame before the renderer use it.
+			mpRenderDataBuilder->ApplySceneDeltas();
 
 			// modules OnUpdate()
 			mModuleManager.Update(deltaTime);
@@ -198,52 +220,6 @@ namespace SG
 		std::filesystem::current_path(path.c_str());
 	}
 
-	int System::RunProcess(const string& command, const char* pOut)
-	{
-		SG_PROFILE_FUNCTION();
-
-#ifdef SG_PLATFORM_WINDOWS
-		STARTUPINFOA        startupInfo;
-		PROCESS_INFORMATION processInfo;
-		memset(&startupInfo, 0, sizeof startupInfo);
-		memset(&processInfo, 0, sizeof processInfo);
-
-		HANDLE stdOut = NULL;
-		if (pOut)
-		{
-			SECURITY_ATTRIBUTES sa;
-			sa.nLength = sizeof(sa);
-			sa.lpSecurityDescriptor = NULL;
-			sa.bInheritHandle = TRUE;
-
-			size_t   pathLength = strlen(pOut) + 1;
-			wchar_t* buffer = (wchar_t*)alloca(pathLength * sizeof(wchar_t));
-			MultiByteToWideChar(CP_UTF8, 0, pOut, (int)pathLength, buffer, (int)pathLength);
-			stdOut = CreateFileW(buffer, GENERIC_ALL, FILE_SHARE_WRITE | FILE_SHARE_READ, &sa, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-		}
-
-		startupInfo.cb = sizeof(STARTUPINFO);
-		startupInfo.dwFlags |= STARTF_USESTDHANDLES;
-		startupInfo.hStdOutput = stdOut;
-		startupInfo.hStdError  = stdOut;
-
-		// create a process
-		if (!CreateProcessA(NULL, (LPSTR)command.c_str(), NULL, NULL, stdOut ? TRUE : FALSE, CREATE_NO_WINDOW, NULL, NULL, &startupInfo, &processInfo))
-			return -1;
-
-		WaitForSingleObject(processInfo.hProcess, INFINITE);
-		DWORD exitCode;
-		GetExitCodeProcess(processInfo.hProcess, &exitCode);
-
-		CloseHandle(processInfo.hProcess);
-		CloseHandle(processInfo.hThread);
-
-		if (stdOut)
-			CloseHandle(stdOut);
-#endif
-		return EXIT_SUCCESS;
-	}
-
 	void System::RegisterSystemMessageListener(ISystemMessageListener* pListener)
 	{
 		SG_PROFILE_FUNCTION();
@@ -3,7 +3,7 @@
 
 #include "Profile/Profile.h"
 
-#include <eastl/type_traits.h>
+#include <EASTL/type_traits.h>
 
 namespace SG
 {
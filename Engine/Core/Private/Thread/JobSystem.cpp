@@ -0,0 +1,421 @@
+#include "StdAfx.h"
+#include "Thread/IJobSystem.h"
+
+#include "System/Logger.h"
+#include "Memory/Memory.h"
+#include "Profile/Profile.h"
+
+#include "Stl/vector.h"
+
+#include <stdio.h>
+
+namespace SG
+{
+
+	namespace Impl
+	{
+		//! Dependency counter shared by a group of jobs.
+		struct JobCounter
+		{
+			Atomic32 numPendingJobs;  //!< Jobs of this counter which had not finished yet.
+			Atomic32 refCount;        //!< One for the handle, one for the scheduler.
+			SpinLock lock;            //!< Protect bFinished and continuations.
+			bool     bFinished = false;
+			eastl::vector<eastl::pair<JobDesc, JobCounter*>> continuations; //!< Jobs waiting for this counter.
+		};
+	}
+
+	namespace
+	{
+		struct Job
+		{
+			Impl::JobDesc     desc;
+			Impl::JobCounter* pCounter;
+		};
+
+		//! Fixed size ring buffer deque. The owner thread push and pop at the back,
+		//! other threads steal from the front.
+		class JobDeque
+		{
+		public:
+			enum { SG_MAX_JOBS_PER_DEQUE = 4096 };
+
+			bool PushBack(const Job& job)
+			{
+				mLock.Lock();
+				if (mBack - mFront == SG_MAX_JOBS_PER_DEQUE)
+				{
+					mLock.UnLock();
+					return false;
+				}
+				mJobs[mBack & (SG_MAX_JOBS_PER_DEQUE - 1)] = job;
+				++mBack;
+				mLock.UnLock();
+				return true;
+			}
+
+			bool PopBack(Job& job)
+			{
+				mLock.Lock();
+				if (mBack == mFront)
+				{
+					mLock.UnLock();
+					return false;
+				}
+				--mBack;
+				job = mJobs[mBack & (SG_MAX_JOBS_PER_DEQUE - 1)];
+				mLock.UnLock();
+				return true;
+			}
+
+			bool StealFront(Job& job)
+			{
+				mLock.Lock();
+				if (mBack == mFront)
+				{
+					mLock.UnLock();
+					return false;
+				}
+				job = mJobs[mFront & (SG_MAX_JOBS_PER_DEQUE - 1)];
+				++mFront;
+				mLock.UnLock();
+				return true;
+			}
+		private:
+			SpinLock mLock;
+			UInt64   mFront = 0;
+			UInt64   mBack = 0;
+			Job      mJobs[SG_MAX_JOBS_PER_DEQUE];
+		};
+
+		struct JobSystemContext
+		{
+			UInt32     numWorkers = 0;
+			eastl::vector<Thread>    workers;
+			//! numWorkers + 1 deques, the first one is for the main thread and the non-worker threads.
+			eastl::vector<JobDeque*> pDeques;
+			Semaphore* pWakeUpSemaphore = nullptr;
+			Atomic32   numSleepingWorkers;
+			Atomic32   bQuit;
+			Atomic32   stealSeed;
+		};
+
+		static JobSystemContext sContext;
+
+		//! Index of the deque owned by the current thread. Worker i owns deque i + 1.
+		static UInt32& _CurrDequeIndex()
+		{
+			SG_THREAD_LOCAL static UInt32 dequeIndex = 0;
+			return dequeIndex;
+		}
+
+		static void _ReleaseCounter(Impl::JobCounter* pCounter)
+		{
+			if (pCounter->refCount.Decrease() == 0)
+				Delete(pCounter);
+		}
+
+		static void _WakeUpWorkers(UInt32 numJobs)
+		{
+			// use an atomic operation to read, so that the push is visible to the workers before we check the sleeping workers.
+			long numSleeping = sContext.numSleepingWorkers.Add(0);
+			const long numWakeUps = numSleeping < (long)numJobs ? numSleeping : (long)numJobs;
+			for (long i = 0; i < numWakeUps; ++i)
+				sContext.pWakeUpSemaphore->Release();
+		}
+
+		static void _ExecuteJob(const Job& job);
+
+		static void _PushJob(const Job& job)
+		{
+			if (sContext.pDeques.empty() || !sContext.pDeques[_CurrDequeIndex()]->PushBack(job))
+			{
+				// the deque is full (or the job system is not running), execute it immediately.
+				_ExecuteJob(job);
+			}
+		}
+
+		static void _FinishJob(Impl::JobCounter* pCounter)
+		{
+			if (pCounter->numPendingJobs.Decrease() != 0)
+				return;
+
+			eastl::vector<eastl::pair<Impl::JobDesc, Impl::JobCounter*>> continuations;
+			pCounter->lock.Lock();
+			pCounter->bFinished = true;
+			continuations.swap(pCounter->continuations);
+			pCounter->lock.UnLock();
+
+			for (auto& continuation : continuations)
+				_PushJob({ continuation.first, continuation.second });
+			if (!continuations.empty())
+				_WakeUpWorkers((UInt32)continuations.size());
+
+			// the scheduler no longer need this counter
+			_ReleaseCounter(pCounter);
+		}
+
+		static void _ExecuteJob(const Job& job)
+		{
+			job.desc.pEntry(job.desc);
+			_FinishJob(job.pCounter);
+		}
+
+		static bool _FetchJob(Job& job)
+		{
+			const UInt32 numDeques = sContext.numWorkers + 1;
+			const UInt32 currIndex = _CurrDequeIndex();
+			if (sContext.pDeques[currIndex]->PopBack(job))
+				return true;
+
+			// steal from a random victim to avoid all the idle workers fighting on the same deque
+			const UInt32 start = (UInt32)sContext.stealSeed.Increase();
+			for (UInt32 i = 0; i < numDeques; ++i)
+			{
+				const UInt32 victim = (start + i) % numDeques;
+				if (victim != currIndex && sContext.pDeques[victim]->StealFront(job))
+					return true;
+			}
+			return false;
+		}
+
+		static void _WorkerThreadFunc(void* pUser)
+		{
+			const UInt32 workerIndex = (UInt32)(reinterpret_cast<Size>(pUser));
+			_CurrDequeIndex() = workerIndex + 1;
+
+			char threadName[32] = { 0 };
+			snprintf(threadName, sizeof(threadName), "Job Worker %u", workerIndex);
+			SetCurrThreadName(threadName);
+
+			Job job;
+			while (sContext.bQuit == 0)
+			{
+				if (_FetchJob(job))
+				{
+					_ExecuteJob(job);
+					continue;
+				}
+
+				// no job to do, go to sleep.
+				// increase the sleeping count before checking again, so that a job pushed after
+				// the check will always see this worker sleeping and wake it up.
+				sContext.numSleepingWorkers.Increase();
+				if (_FetchJob(job))
+				{
+					sContext.numSleepingWorkers.Decrease();
+					_ExecuteJob(job);
+					continue;
+				}
+				if (sContext.bQuit != 0)
+				{
+					sContext.numSleepingWorkers.Decrease();
+					break;
+				}
+				sContext.pWakeUpSemaphore->Acquire();
+				sContext.numSleepingWorkers.Decrease();
+			}
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/// SJobHandle
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	void SJobHandle::Complete()
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (!pCounter)
+			return;
+
+		while (!IsCompleted())
+		{
+			// help the workers instead of just waiting
+			if (!JobSystem::ExecuteOneJob())
+				ThreadSleep(0);
+		}
+	}
+
+	void SJobHandle::Dispose()
+	{
+		if (pCounter)
+		{
+			_ReleaseCounter(pCounter);
+			pCounter = nullptr;
+		}
+	}
+
+	bool SJobHandle::IsCompleted() const
+	{
+		if (!pCounter)
+			return true;
+		return pCounter->numPendingJobs.Add(0) == 0;
+	}
+
+	SJobStatus SJobHandle::GetStatus() const
+	{
+		SJobStatus status;
+		if (pCounter)
+		{
+			const long numPending = pCounter->numPendingJobs.Add(0);
+			status.state = numPending == 0 ? EJobState::eCompleted : EJobState::ePending;
+			status.numPendingJobs = (UInt32)numPending;
+		}
+		return status;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/// JobSystem
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	void JobSystem::OnInit(UInt32 numWorkers)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (numWorkers == 0)
+		{
+			const UInt32 numCores = GetNumCPUCores();
+			numWorkers = numCores > 1 ? numCores - 1 : 1;
+		}
+
+		sContext.numWorkers = numWorkers;
+		sContext.bQuit.Exchange(0);
+		sContext.numSleepingWorkers.Exchange(0);
+		sContext.pWakeUpSemaphore = New(Semaphore, (int)numWorkers + 1);
+		sContext.pDeques.resize(numWorkers + 1);
+		for (auto& pDeque : sContext.pDeques)
+			pDeque = New(JobDeque);
+		sContext.workers.resize(numWorkers);
+		_CurrDequeIndex() = 0;
+
+		for (UInt32 i = 0; i < numWorkers; ++i)
+		{
+			if (!ThreadCreate(&sContext.workers[i], _WorkerThreadFunc, reinterpret_cast<void*>((Size)i)))
+				SG_LOG_ERROR("Failed to create job worker thread(%d)", i);
+		}
+
+		SG_LOG_INFO("Job system initialized with %d workers", numWorkers);
+	}
+
+	void JobSystem::OnShutdown()
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (sContext.workers.empty())
+			return;
+
+		// finish all the remaining jobs on the main thread
+		while (ExecuteOneJob());
+
+		sContext.bQuit.Exchange(1);
+		for (UInt32 i = 0; i < sContext.numWorkers; ++i)
+			sContext.pWakeUpSemaphore->Release();
+		for (UInt32 i = 0; i < sContext.numWorkers; ++i)
+			ThreadRestore(&sContext.workers[i]);
+
+		for (auto* pDeque : sContext.pDeques)
+			Delete(pDeque);
+		Delete(sContext.pWakeUpSemaphore);
+		sContext.workers.clear();
+		sContext.pDeques.clear();
+		sContext.pWakeUpSemaphore = nullptr;
+		sContext.numWorkers = 0;
+	}
+
+	bool JobSystem::ExecuteOneJob()
+	{
+		if (sContext.pDeques.empty())
+			return false;
+
+		Job job;
+		if (_FetchJob(job))
+		{
+			_ExecuteJob(job);
+			return true;
+		}
+		return false;
+	}
+
+	SJobHandle JobSystem::Submit(const Impl::JobDesc* pDescs, UInt32 numDescs, SJobHandle dependency)
+	{
+		SG_PROFILE_FUNCTION();
+
+		SJobHandle handle;
+		if (numDescs == 0)
+			return handle;
+
+		handle.pCounter = New(Impl::JobCounter);
+		handle.pCounter->numPendingJobs.Exchange((long)numDescs);
+		handle.pCounter->refCount.Exchange(2);
+
+		if (dependency.pCounter)
+		{
+			Impl::JobCounter* pDependency = dependency.pCounter;
+			pDependency->lock.Lock();
+			if (!pDependency->bFinished)
+			{
+				for (UInt32 i = 0; i < numDescs; ++i)
+					pDependency->continuations.push_back({ pDescs[i], handle.pCounter });
+				pDependency->lock.UnLock();
+				return handle;
+			}
+			pDependency->lock.UnLock();
+		}
+
+		for (UInt32 i = 0; i < numDescs; ++i)
+			_PushJob({ pDescs[i], handle.pCounter });
+		_WakeUpWorkers(numDescs);
+		return handle;
+	}
+
+	SJobHandle JobSystem::Schedule(JobFunc func, void* pUser, SJobHandle dependency)
+	{
+		Impl::JobDesc desc = {};
+		desc.pEntry = [](const Impl::JobDesc& d)
+		{
+			reinterpret_cast<JobFunc>(d.pUser0)(d.pUser1);
+		};
+		desc.pUser0 = reinterpret_cast<void*>(func);
+		desc.pUser1 = pUser;
+		return Submit(&desc, 1, dependency);
+	}
+
+	SJobHandle JobSystem::ParallelFor(UInt32 count, UInt32 batchSize, ParallelForFunc func, void* pUser, SJobHandle dependency)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (count == 0)
+			return {};
+		if (batchSize == 0)
+			batchSize = 1;
+
+		const UInt32 numBatches = (count + batchSize - 1) / batchSize;
+		eastl::vector<Impl::JobDesc> descs(numBatches);
+		for (UInt32 i = 0; i < numBatches; ++i)
+		{
+			Impl::JobDesc& desc = descs[i];
+			desc.pEntry = [](const Impl::JobDesc& d)
+			{
+				reinterpret_cast<ParallelForFunc>(d.pUser0)(d.begin, d.end, d.pUser1);
+			};
+			desc.pUser0 = reinterpret_cast<void*>(func);
+			desc.pUser1 = pUser;
+			desc.pUser2 = nullptr;
+			desc.begin = i * batchSize;
+			desc.end = (i + 1) * batchSize < count ? (i + 1) * batchSize : count;
+		}
+		return Submit(descs.data(), numBatches, dependency);
+	}
+
+	UInt32 JobSystem::GetNumWorkers()
+	{
+		return sContext.numWorkers;
+	}
+
+	UInt32 JobSystem::GetCurrThreadIndex()
+	{
+		return _CurrDequeIndex();
+	}
+
+}
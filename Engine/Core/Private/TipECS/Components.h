@@ -5,85 +5,205 @@
 #include "TipECS/Registry.h"
 
 #include <tuple>
+#include <array>
+#include <new>
+#include <assert.h>
+#include <stdint.h>
 #if USE_STL
 #	include <vector>
 #else
-#	include "eastl/vector.h"
+#	include "EASTL/vector.h"
 #endif
 
 namespace TipECS
 {
 
+	namespace Impl
+	{
+#if USE_STL
+		template <typename T>
+		using Vector = std::vector<T>;
+#else
+		template <typename T>
+		using Vector = eastl::vector<T>;
+#endif
+
+		//! Size in byte of one chunk of an archetype.
+		constexpr size_t CHUNK_SIZE = 16 * 1024;
+		//! Every component column inside a chunk starts at a cache line boundary.
+		constexpr size_t CACHE_LINE_SIZE = 64;
+
+		constexpr uint32_t INVALID_ARCHETYPE = uint32_t(-1);
+
+		inline constexpr size_t AlignTo(size_t v, size_t align) { return (v + align - 1) & ~(align - 1); }
+
+		//! Type erased operations of a component, used to move the components between the archetypes.
+		struct ComponentTypeInfo
+		{
+			size_t size;
+			size_t alignment;
+			void (*pDefaultConstruct)(void* pDst);
+			void (*pMoveConstruct)(void* pDst, void* pSrc);
+			void (*pDestroy)(void* pDst);
+		};
+
+		template <typename TComponent>
+		ComponentTypeInfo MakeComponentTypeInfo() noexcept
+		{
+			ComponentTypeInfo info;
+			info.size = sizeof(TComponent);
+			info.alignment = alignof(TComponent);
+			info.pDefaultConstruct = [](void* pDst) { new (pDst) TComponent(); };
+			info.pMoveConstruct = [](void* pDst, void* pSrc) { new (pDst) TComponent(std::move(*reinterpret_cast<TComponent*>(pSrc))); };
+			info.pDestroy = [](void* pDst) { reinterpret_cast<TComponent*>(pDst)->~TComponent(); };
+			return info;
+		}
+
+		//! The owner of one row inside a chunk, used to fix up the location after a row moved.
+		struct RowOwner
+		{
+			DataIndex       dataIndex;
+			HandleDataIndex handleDataIndex;
+		};
+
+		//! Fixed size cache-line aligned memory block, stores the components of the same archetype in SoA layout.
+		//! Column layout: [RowOwner * capacity][Component0 * capacity][Component1 * capacity]...
+		struct Chunk
+		{
+			unsigned char* pMemory = nullptr;
+			uint32_t       count = 0;
+		};
+
+		//! Location of an entity's components inside the storage.
+		struct ComponentLocation
+		{
+			uint32_t archetype = INVALID_ARCHETYPE;
+			uint32_t chunk = 0;
+			uint32_t row = 0;
+		};
+	}
+
+	//! Archetype based storage of the components.
+	//! Entities with the same bitset (components and tags) are grouped in one archetype,
+	//! so that a view only need to test the bitset once per archetype, not once per entity.
 	template <typename TSettings>
 	class ComponentsStorage
 	{
 	private:
 		using Setting = TSettings;
 		using ComponentList = typename Setting::ComponentList;
+		using BitSet = typename Setting::BitSet;
+		using ComponentTuple = typename TMP::ToTuple<ComponentList>::type;
 
-		// we use sparse set to store the actual data index to prevent the memory waste scenario.
-		template <typename TComponent>
-		struct ComponentData
+		static constexpr size_t BIT_COUNT = Setting::ComponentCount() + Setting::TagCount();
+
+		struct Archetype
 		{
-#if USE_STL
-			std::vector<size_t>     dataIndices;    //! Array contain the index of the compData array.
-			std::vector<TComponent> compData;       //! Array which stores all the component data.
-			std::vector<size_t>     validCompIndex; //! Stack which contain the free index of the compData array.
-#else
-			eastl::vector<size_t>     dataIndices;    //! Array contain the index of the compData array.
-			eastl::vector<TComponent> compData;       //! Array which stores all the component data.
-			eastl::vector<size_t>     validCompIndex; //! Stack which contain the free index of the compData array.
-#endif
+			BitSet bitset;
+			uint32_t capacity = 0;  //! Row capacity of one chunk.
+			size_t chunkSize = 0;  //! Byte size of one chunk.
+			std::array<size_t, Setting::ComponentCount()> columnOffsets; //! Offset of each component column, or INVALID_INDEX if not in this archetype.
+			std::array<uint32_t, BIT_COUNT> toggleEdges; //! Cached archetype with one bit toggled.
+			Impl::Vector<Impl::Chunk> chunks;
 		};
-
-		template <typename... Ts>
-		using TupleOfVectors = std::tuple<ComponentData<Ts>...>;
-
-		// this is a std::tuple<ComponentData<Ts>...>, each component data refers to a component type.
-		// it is used for indexing the data to the packed data array.
-		using ComponentsType = typename TMP::Unpack<TupleOfVectors, ComponentList>::type;
 	public:
 		ComponentsStorage() noexcept
 		{
-			// initialized size of compData is 2.
-			// here we make sure at the start of the ECS, validCompIndex is not empty.
-			TMP::ForTuple(mComponentsData, [](auto& component)
-				{
-					component.compData.resize(2);
-					component.validCompIndex.push_back(1);
-					component.validCompIndex.push_back(0);
-				});
+			// the archetype of the entities without any component or tag.
+			GetOrCreateArchetype(BitSet{});
+		}
+
+		~ComponentsStorage() noexcept
+		{
+			Clear();
+		}
+
+		ComponentsStorage(const ComponentsStorage&) = delete;
+		ComponentsStorage& operator=(const ComponentsStorage&) = delete;
+
+		//! Put a newly created entity into the empty archetype.
+		void Insert(DataIndex idx, HandleDataIndex handleIdx) noexcept
+		{
+			assert(mLocations[idx].archetype == Impl::INVALID_ARCHETYPE);
+			mLocations[idx] = AllocateRow(0, { idx, handleIdx });
 		}
 
+		//! Destroy all the components of this entity and remove it from its archetype.
+		void Erase(DataIndex idx) noexcept
+		{
+			auto& location = mLocations[idx];
+			if (location.archetype == Impl::INVALID_ARCHETYPE)
+				return;
+
+			auto& archetype = mArchetypes[location.archetype];
+			auto& chunk = archetype.chunks[location.chunk];
+			for (size_t i = 0; i < Setting::ComponentCount(); ++i)
+			{
+				if (archetype.columnOffsets[i] != Impl::INVALID_INDEX)
+					GetTypeInfos()[i].pDestroy(GetElement(archetype, chunk, i, location.row));
+			}
+			RemoveRow(location.archetype, location.chunk, location.row);
+			location = {};
+		}
+
+		//! If the archetype of the entity have the bit of a component or a tag.
+		bool HasBit(DataIndex idx, size_t bit) const noexcept
+		{
+			const auto& location = mLocations[idx];
+			return location.archetype != Impl::INVALID_ARCHETYPE && mArchetypes[location.archetype].bitset[bit];
+		}
+
+		//! Move the entity to the archetype with TComponent and default construct it.
+		//! If the entity already have TComponent, the existing one is returned untouched.
+		//! @note All the references to the components of the entities in the old archetype may be invalidated.
 		template <typename TComponent>
 		auto& AddComponent(DataIndex idx) noexcept
 		{
 			static_assert(Setting::template IsComponent<TComponent>(), "TComponent is not registered!");
-			auto& component = std::get<ComponentData<TComponent>>(mComponentsData);
+			const size_t bit = Setting::template ComponentBitIndex<TComponent>();
+			assert(!HasBit(idx, bit) && "The entity already have this component!");
+			if (HasBit(idx, bit)) // Migrate() toggles the bit, it would remove the component instead
+				return GetComponent<TComponent>(idx);
 
-			// check to see if the compData can store more data
-			if (component.validCompIndex.empty()) // do resize
-			{
-				auto prevSize = component.compData.size();
-				component.compData.resize(prevSize * 2); // double the size
-				for (size_t i = component.compData.size() - 1; i >= prevSize; --i) // push the new index into the validCompIndex 
-					component.validCompIndex.push_back(i);
-			}
+			void* pData = Migrate(idx, bit);
+			return *new (pData) TComponent();
+		}
 
-			auto validIndex = component.validCompIndex.back();
-			component.validCompIndex.pop_back();
-			// store the valid index in the dataIndices array, so next time user can get it.
-			component.dataIndices[idx] = validIndex;
-			return component.compData[validIndex];
+		//! Move the entity to the archetype with TComponent and construct it with args.
+		//! If the entity already have TComponent, the existing one is returned untouched.
+		//! @note All the references to the components of the entities in the old archetype may be invalidated.
+		template <typename TComponent, typename... Args>
+		auto& AddComponent(DataIndex idx, Args&&... args) noexcept
+		{
+			static_assert(Setting::template IsComponent<TComponent>(), "TComponent is not registered!");
+			const size_t bit = Setting::template ComponentBitIndex<TComponent>();
+			assert(!HasBit(idx, bit) && "The entity already have this component!");
+			if (HasBit(idx, bit))
+				return GetComponent<TComponent>(idx);
+
+			void* pData = Migrate(idx, bit);
+			return *new (pData) TComponent(std::forward<Args>(args)...);
 		}
 
+		//! Move the entity to the archetype without TComponent, TComponent is destroyed.
+		//! Nothing happens if the entity do not have TComponent.
 		template <typename TComponent>
 		void RemoveComponent(DataIndex idx)
 		{
 			static_assert(Setting::template IsComponent<TComponent>(), "TComponent is not registered!");
-			auto& component = std::get<ComponentData<TComponent>>(mComponentsData);
+			const size_t bit = Setting::template ComponentBitIndex<TComponent>();
+			assert(HasBit(idx, bit) && "The entity do not have this component!");
+			if (!HasBit(idx, bit)) // Migrate() toggles the bit, it would add an uninitialized component instead
+				return;
 
-			component.validCompIndex.push_back(component.dataIndices[idx]);
+			Migrate(idx, bit);
+		}
+
+		//! Tags do not have data, but they still decide which archetype the entity belongs to.
+		void ToggleTag(DataIndex idx, size_t tagBitIndex) noexcept
+		{
+			assert(tagBitIndex >= Setting::ComponentCount() && tagBitIndex < BIT_COUNT);
+			Migrate(idx, tagBitIndex);
 		}
 
 		template <typename TComponent>
@@ -91,22 +211,255 @@ namespace TipECS
 		{
 			static_assert(Setting::template IsComponent<TComponent>(), "TComponent is not registered!");
 
-			auto& component = std::get<ComponentData<TComponent>>(mComponentsData);
-			return component.compData[component.dataIndices[idx]];
+			const auto& location = mLocations[idx];
+			assert(location.archetype != Impl::INVALID_ARCHETYPE);
+			auto& archetype = mArchetypes[location.archetype];
+			return GetColumn<TComponent>(archetype, archetype.chunks[location.chunk])[location.row];
 		}
 
 		void Reserve(size_t n)
 		{
-			std::apply([this, n](auto&... v)
+			mLocations.resize(n);
+		}
+
+		//! Destroy all the components, the archetypes are kept for the later use.
+		void Clear() noexcept
+		{
+			for (auto& archetype : mArchetypes)
+			{
+				for (auto& chunk : archetype.chunks)
+				{
+					for (size_t i = 0; i < Setting::ComponentCount(); ++i)
+					{
+						if (archetype.columnOffsets[i] == Impl::INVALID_INDEX)
+							continue;
+						for (uint32_t row = 0; row < chunk.count; ++row)
+							GetTypeInfos()[i].pDestroy(GetElement(archetype, chunk, i, row));
+					}
+					FreeChunk(chunk);
+				}
+				archetype.chunks.clear();
+			}
+			for (auto& location : mLocations)
+				location = {};
+		}
+
+		size_t ArchetypeCount() const noexcept { return mArchetypes.size(); }
+		const BitSet& GetArchetypeBitSet(size_t archetype) const noexcept { return mArchetypes[archetype].bitset; }
+		size_t ChunkCount(size_t archetype) const noexcept { return mArchetypes[archetype].chunks.size(); }
+		uint32_t ChunkSize(size_t archetype, size_t chunk) const noexcept { return mArchetypes[archetype].chunks[chunk].count; }
+
+		const Impl::RowOwner& GetRowOwner(size_t archetype, size_t chunk, uint32_t row) const noexcept
+		{
+			auto& arch = mArchetypes[archetype];
+			return reinterpret_cast<const Impl::RowOwner*>(arch.chunks[chunk].pMemory)[row];
+		}
+
+		//! Call func(Ts&...) for every row of an archetype, the columns are walked linearly.
+		template <typename... Ts, typename TFunc>
+		void ForEachRow(size_t archetype, TFunc&& func)
+		{
+			auto& arch = mArchetypes[archetype];
+			for (auto& chunk : arch.chunks)
+			{
+				std::tuple<Ts*...> columns{ GetColumn<Ts>(arch, chunk)... };
+				for (uint32_t row = 0; row < chunk.count; ++row)
+					std::apply([&func, row](Ts*... pColumns) { func(pColumns[row]...); }, columns);
+			}
+		}
+	private:
+		static const std::array<Impl::ComponentTypeInfo, Setting::ComponentCount()>& GetTypeInfos() noexcept
+		{
+			static const auto sTypeInfos = MakeTypeInfos(std::make_index_sequence<Setting::ComponentCount()>{});
+			return sTypeInfos;
+		}
+
+		template <size_t... I>
+		static std::array<Impl::ComponentTypeInfo, Setting::ComponentCount()> MakeTypeInfos(std::index_sequence<I...>) noexcept
+		{
+			return { Impl::MakeComponentTypeInfo<std::tuple_element_t<I, ComponentTuple>>()... };
+		}
+
+		template <typename TComponent>
+		static TComponent* GetColumn(Archetype& archetype, Impl::Chunk& chunk) noexcept
+		{
+			const size_t offset = archetype.columnOffsets[Setting::template ComponentBitIndex<TComponent>()];
+			assert(offset != Impl::INVALID_INDEX && "This archetype do not have this component!");
+			return reinterpret_cast<TComponent*>(chunk.pMemory + offset);
+		}
+
+		static void* GetElement(Archetype& archetype, Impl::Chunk& chunk, size_t component, uint32_t row) noexcept
+		{
+			return chunk.pMemory + archetype.columnOffsets[component] + GetTypeInfos()[component].size * row;
+		}
+
+		//! Compute the column layout of an archetype, fit as many rows as possible in one chunk.
+		static void ComputeLayout(Archetype& archetype) noexcept
+		{
+			const auto& typeInfos = GetTypeInfos();
+
+			size_t rowSize = sizeof(Impl::RowOwner);
+			for (size_t i = 0; i < Setting::ComponentCount(); ++i)
+			{
+				if (archetype.bitset[i])
+					rowSize += typeInfos[i].size;
+			}
+
+			auto layout = [&](uint32_t capacity) -> size_t
+			{
+				size_t offset = Impl::AlignTo(sizeof(Impl::RowOwner) * capacity, Impl::CACHE_LINE_SIZE);
+				for (size_t i = 0; i < Setting::ComponentCount(); ++i)
+				{
+					if (!archetype.bitset[i])
+					{
+						archetype.columnOffsets[i] = Impl::INVALID_INDEX;
+						continue;
+					}
+					assert(typeInfos[i].alignment <= Impl::CACHE_LINE_SIZE);
+					archetype.columnOffsets[i] = offset;
+					offset = Impl::AlignTo(offset + typeInfos[i].size * capacity, Impl::CACHE_LINE_SIZE);
+				}
+				return offset;
+			};
+
+			uint32_t capacity = static_cast<uint32_t>(Impl::CHUNK_SIZE / rowSize);
+			if (capacity == 0)
+				capacity = 1;
+			// the padding of the columns may exceed the chunk size, shrink it until it fits.
+			while (capacity > 1 && layout(capacity) > Impl::CHUNK_SIZE)
+				--capacity;
+
+			archetype.capacity = capacity;
+			archetype.chunkSize = layout(capacity);
+		}
+
+		uint32_t GetOrCreateArchetype(const BitSet& bitset) noexcept
+		{
+			for (size_t i = 0; i < mArchetypes.size(); ++i)
+			{
+				if (mArchetypes[i].bitset == bitset)
+					return static_cast<uint32_t>(i);
+			}
+
+			auto& archetype = mArchetypes.emplace_back();
+			archetype.bitset = bitset;
+			archetype.toggleEdges.fill(Impl::INVALID_ARCHETYPE);
+			ComputeLayout(archetype);
+			return static_cast<uint32_t>(mArchetypes.size() - 1);
+		}
+
+		uint32_t GetToggledArchetype(uint32_t archetype, size_t bit) noexcept
+		{
+			uint32_t target = mArchetypes[archetype].toggleEdges[bit];
+			if (target == Impl::INVALID_ARCHETYPE)
+			{
+				BitSet bitset = mArchetypes[archetype].bitset;
+				bitset.flip(bit);
+				target = GetOrCreateArchetype(bitset); // may reallocate mArchetypes
+				mArchetypes[archetype].toggleEdges[bit] = target;
+				mArchetypes[target].toggleEdges[bit] = archetype;
+			}
+			return target;
+		}
+
+		static void FreeChunk(Impl::Chunk& chunk) noexcept
+		{
+			::operator delete(chunk.pMemory, std::align_val_t(Impl::CACHE_LINE_SIZE));
+			chunk.pMemory = nullptr;
+			chunk.count = 0;
+		}
+
+		Impl::ComponentLocation AllocateRow(uint32_t archetypeIndex, const Impl::RowOwner& owner) noexcept
+		{
+			auto& archetype = mArchetypes[archetypeIndex];
+			if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity)
+			{
+				auto& newChunk = archetype.chunks.emplace_back();
+				newChunk.pMemory = reinterpret_cast<unsigned char*>(::operator new(archetype.chunkSize, std::align_val_t(Impl::CACHE_LINE_SIZE)));
+				newChunk.count = 0;
+			}
+
+			auto& chunk = archetype.chunks.back();
+			Impl::ComponentLocation location;
+			location.archetype = archetypeIndex;
+			location.chunk = static_cast<uint32_t>(archetype.chunks.size() - 1);
+			location.row = chunk.count++;
+			new (reinterpret_cast<Impl::RowOwner*>(chunk.pMemory) + location.row) Impl::RowOwner(owner);
+			return location;
+		}
+
+		//! Fill the hole with the last row of the archetype.
+		//! The components of the removed row must be already destroyed or moved out.
+		void RemoveRow(uint32_t archetypeIndex, uint32_t chunkIndex, uint32_t row) noexcept
+		{
+			auto& archetype = mArchetypes[archetypeIndex];
+			auto& lastChunk = archetype.chunks.back();
+			const uint32_t lastChunkIndex = static_cast<uint32_t>(archetype.chunks.size() - 1);
+			const uint32_t lastRow = lastChunk.count - 1;
+
+			if (chunkIndex != lastChunkIndex || row != lastRow)
+			{
+				auto& chunk = archetype.chunks[chunkIndex];
+				for (size_t i = 0; i < Setting::ComponentCount(); ++i)
 				{
-					using _dummy = int[];
-					(void)_dummy {
-						0, (v.dataIndices.resize(n), 0)...
-					};
-				}, mComponentsData);
+					if (archetype.columnOffsets[i] == Impl::INVALID_INDEX)
+						continue;
+					void* pLast = GetElement(archetype, lastChunk, i, lastRow);
+					GetTypeInfos()[i].pMoveConstruct(GetElement(archetype, chunk, i, row), pLast);
+					GetTypeInfos()[i].pDestroy(pLast);
+				}
+
+				const auto owner = reinterpret_cast<Impl::RowOwner*>(lastChunk.pMemory)[lastRow];
+				reinterpret_cast<Impl::RowOwner*>(chunk.pMemory)[row] = owner;
+				auto& movedLocation = mLocations[owner.dataIndex];
+				movedLocation.chunk = chunkIndex;
+				movedLocation.row = row;
+			}
+
+			if (--lastChunk.count == 0)
+			{
+				FreeChunk(lastChunk);
+				archetype.chunks.pop_back();
+			}
+		}
+
+		//! Move the entity to the archetype with the bit toggled.
+		//! @return Uninitialized memory of the newly added component, or nullptr if the bit is removed or is a tag.
+		void* Migrate(DataIndex idx, size_t bit) noexcept
+		{
+			auto location = mLocations[idx];
+			assert(location.archetype != Impl::INVALID_ARCHETYPE);
+
+			const uint32_t dstIndex = GetToggledArchetype(location.archetype, bit);
+			auto& srcArchetype = mArchetypes[location.archetype];
+			auto& dstArchetype = mArchetypes[dstIndex];
+
+			const auto owner = reinterpret_cast<Impl::RowOwner*>(srcArchetype.chunks[location.chunk].pMemory)[location.row];
+			const auto dstLocation = AllocateRow(dstIndex, owner);
+			auto& srcChunk = srcArchetype.chunks[location.chunk];
+			auto& dstChunk = dstArchetype.chunks[dstLocation.chunk];
+
+			const auto& typeInfos = GetTypeInfos();
+			for (size_t i = 0; i < Setting::ComponentCount(); ++i)
+			{
+				if (srcArchetype.columnOffsets[i] == Impl::INVALID_INDEX)
+					continue;
+				void* pSrc = GetElement(srcArchetype, srcChunk, i, location.row);
+				if (dstArchetype.columnOffsets[i] != Impl::INVALID_INDEX)
+					typeInfos[i].pMoveConstruct(GetElement(dstArchetype, dstChunk, i, dstLocation.row), pSrc);
+				typeInfos[i].pDestroy(pSrc);
+			}
+
+			RemoveRow(location.archetype, location.chunk, location.row);
+			mLocations[idx] = dstLocation;
+
+			if (bit < Setting::ComponentCount() && dstArchetype.bitset[bit])
+				return GetElement(dstArchetype, dstChunk, bit, dstLocation.row);
+			return nullptr;
 		}
 	private:
-		ComponentsType mComponentsData;
+		Impl::Vector<Archetype> mArchetypes;
+		Impl::Vector<Impl::ComponentLocation> mLocations; //! DataIndex -> location of the components.
 	};
 
-}
\ No newline at end of file
+}
@@ -73,8 +73,8 @@ namespace TMP
 	class TypeList
 	{
 	private:
-		template <typename... Ts>
-		using ThisType = std::tuple<Ts...>;
+		template <typename... Us>
+		using ThisType = std::tuple<Us...>;
 	public:
 		static constexpr size_t INVALID_INDEX = size_t(-1);
 
@@ -113,7 +113,7 @@ namespace TMP
 	template <typename... Ts>
 	struct ToTypeList<std::tuple<Ts...>>
 	{
-		using type = typename TypeList<Ts...>;
+		using type = TypeList<Ts...>;
 	};
 
 	template <template<typename...> typename Expand, typename TTypeList>
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Core/Config.h"
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+
+#include "Archive/ResourceDefs.h"
+#include "Archive/ResourceLoader.h"
+
+#include "Stl/string.h"
+#include "Stl/SmartPtr.h"
+#include "EASTL/functional.h"
+
+namespace SG
+{
+
+	class TextureAsset;
+
+	enum class ELoadPriority : UInt32
+	{
+		eLow = 0,
+		eNormal,
+		eHigh,
+	};
+
+	//! Called on the main thread when the texture asset had been loaded.
+	typedef eastl::function<void(RefPtr<TextureAsset> pTextureAsset)> TextureLoadedFunc;
+	//! Called on the main thread when the mesh data had been loaded, the mesh data is only valid in this frame.
+	typedef eastl::function<void(const MeshData& meshData)> MeshLoadedFunc;
+
+	//! Streams the disk resources in the background.
+	//! The requests are kept in a priority queue, the higher priority requests are dispatched first,
+	//! and the requests with the same priority are dispatched in the order they were made.
+	//! The decoding is done in the JobSystem workers, and the results are delivered on the main thread in OnUpdate():
+	//!   - the callback of the request is called, the loaded mesh data only goes to this callback,
+	//!   - "OnTextureAssetsLoaded" (vector<RefPtr<TextureAsset>>) is published through the MessageBus, one event for all the textures loaded in this frame.
+	//! Until a texture asset is loaded, IsDiskResourceLoaded() of it returns false and the renderer binds the default texture instead.
+	class AsyncResourceLoader
+	{
+	public:
+		//! Request to load the texture data of the asset. If the asset is already loaded, the callback is called immediately.
+		//! Requesting an asset that is already in the queue will only raise its priority and add the callback.
+		SG_CORE_API static void LoadTexture(RefPtr<TextureAsset> pTextureAsset, ELoadPriority priority = ELoadPriority::eNormal, TextureLoadedFunc&& func = nullptr);
+		//! Request to load a mesh file. The embedded materials can not be loaded in the background, so efLoadEmbeddedMaterials is not allowed.
+		//! The cooked mesh file is used if it exists, but it will not be written by the background load.
+		SG_CORE_API static void LoadMesh(const string& filename, EMeshType type, ELoadPriority priority = ELoadPriority::eNormal,
+			MeshLoadedFunc&& func = nullptr, ELoadMeshFlag flag = ELoadMeshFlag(0));
+
+		//! Number of the requests that had not been delivered yet.
+		SG_CORE_API static UInt32 GetNumPendingRequests();
+		//! Block until all the requests are done and deliver them.
+		SG_CORE_API static void   Flush();
+	private:
+		friend class System;
+
+		static void OnInit();
+		static void OnShutdown();
+		//! Dispatch the pending requests into the workers, and deliver the finished ones.
+		static void OnUpdate();
+
+		static void DeliverFinishedRequests();
+	};
+
+}
@@ -2,8 +2,10 @@
 
 #include "Core/Config.h"
 #include "Base/BasicTypes.h"
+#include "Base/Handle.h"
 
-#include "eastl/queue.h"
+#include "Stl/vector.h"
+#include "EASTL/queue.h"
 
 namespace SG
 {
@@ -20,6 +22,10 @@ namespace SG
 	class IDAllocator;
 
 	// template specialization for Restored IDAllocator
+	//! The ids stay dense so that they can index arrays (e.g. the GPU buffers), and each id have a generation
+	//! which is increased when the id is allocated and when it is restored (odd when alive, even when free).
+	//! A generational handle made by GetHandle() tells in O(1) whether the id it holds is still the same object,
+	//! an id kept after Restore() will not alias the object which reuse it.
 	template <typename IDType>
 	class IDAllocator<IDType, EIDAllocatorType::eRestored>
 	{
@@ -30,21 +36,40 @@ namespace SG
 		static constexpr TID INVALID_ID = TID(-1);
 
 		bool IsValid(TID id) const;
+		//! Is the id allocated and not restored yet.
+		bool IsAlive(TID id) const;
+		//! Is the id alive and still have the generation it was given.
+		bool IsAlive(TID id, UInt32 generation) const;
+		template <typename THandle>
+		bool IsAlive(THandle handle) const;
+
+		//! Generation of the id, only meaningful if the id had been allocated once.
+		UInt32 GetGeneration(TID id) const;
+		template <typename THandle>
+		THandle GetHandle(TID id) const;
 
 		TID  Allocate();
 		void Restore(TID id);
 
+		//! Restore all the ids, the handles made before the reset become stale.
 		void Reset();
 	private:
 		TID mCurrentAvailableId = TID(0);
 		eastl::queue<TID> mRestoredId;
+		vector<UInt32> mGenerations;
 	};
 
 	template <typename IDType>
 	void IDAllocator<IDType, EIDAllocatorType::eRestored>::Reset()
 	{
+		// keep the generations, the ids will be allocated again from 0 with newer generations.
+		for (auto& generation : mGenerations)
+		{
+			if (generation & 1u)
+				++generation;
+		}
 		mCurrentAvailableId = TID(0);
-		mRestoredId.swap(eastl::queue<TID>());
+		mRestoredId = eastl::queue<TID>();
 	}
 
 	template <typename IDType>
@@ -53,24 +78,72 @@ namespace SG
 		return id != INVALID_ID;
 	}
 
+	template <typename IDType>
+	bool IDAllocator<IDType, EIDAllocatorType::eRestored>::IsAlive(TID id) const
+	{
+		return id < mGenerations.size() && (mGenerations[id] & 1u);
+	}
+
+	template <typename IDType>
+	bool IDAllocator<IDType, EIDAllocatorType::eRestored>::IsAlive(TID id, UInt32 generation) const
+	{
+		return id < mGenerations.size() && mGenerations[id] == generation && (generation & 1u);
+	}
+
+	template <typename IDType>
+	template <typename THandle>
+	bool IDAllocator<IDType, EIDAllocatorType::eRestored>::IsAlive(THandle handle) const
+	{
+		const TID id = TID(handle.GetIndex());
+		return !handle.IsNull() && IsAlive(id) && handle.MatchGeneration(mGenerations[id]);
+	}
+
+	template <typename IDType>
+	UInt32 IDAllocator<IDType, EIDAllocatorType::eRestored>::GetGeneration(TID id) const
+	{
+		SG_ASSERT(id < mGenerations.size());
+		return mGenerations[id];
+	}
+
+	template <typename IDType>
+	template <typename THandle>
+	THandle IDAllocator<IDType, EIDAllocatorType::eRestored>::GetHandle(TID id) const
+	{
+		SG_ASSERT(IsAlive(id));
+		SG_ASSERT(id <= THandle::MAX_INDEX);
+		return THandle(typename THandle::StorageType(id), typename THandle::StorageType(mGenerations[id]));
+	}
+
 	template <typename IDType>
 	typename IDAllocator<IDType, EIDAllocatorType::eRestored>::TID IDAllocator<IDType, EIDAllocatorType::eRestored>::Allocate()
 	{
 		SG_ASSERT(IsValid(mCurrentAvailableId + 1));
+		TID id;
 		if (mRestoredId.empty())
-			return mCurrentAvailableId++;
+		{
+			id = mCurrentAvailableId++;
+			if (id == mGenerations.size())
+				mGenerations.push_back(0);
+		}
 		else
 		{
-			TID id = mRestoredId.front();
+			id = mRestoredId.front();
 			mRestoredId.pop();
-			return id;
 		}
+
+		SG_ASSERT(!IsAlive(id));
+		++mGenerations[id];
+		return id;
 	}
 
 	template <typename IDType>
 	void IDAllocator<IDType, EIDAllocatorType::eRestored>::Restore(TID id)
 	{
 		SG_ASSERT(IsValid(id));
+		// restoring a dead id twice would hand it out twice.
+		if (!IsAlive(id))
+			return;
+		++mGenerations[id];
 		mRestoredId.push(id);
 	}
 
@@ -2,7 +2,7 @@
 
 #include "Stl/string.h"
 #include "Stl/SmartPtr.h"
-#include "eastl/unordered_map.h"
+#include "EASTL/unordered_map.h"
 
 namespace SG
 {
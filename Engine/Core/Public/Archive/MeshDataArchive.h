@@ -5,7 +5,7 @@
 
 #include "Stl/vector.h"
 #include "Stl/string.h"
-#include "eastl/unordered_map.h"
+#include "EASTL/unordered_map.h"
 
 namespace SG
 {
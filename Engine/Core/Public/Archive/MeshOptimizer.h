@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Base/BasicTypes.h"
+#include "Defs/Defs.h"
+
+#include "Stl/vector.h"
+
+namespace SG
+{
+
+// the size of the FIFO post-transform cache the meshes are optimized for and analyzed with.
+#define SG_MESH_OPTIMIZE_CACHE_SIZE 16
+// the clusters are split as long as the ACMR of the splitted one is no worse than this times the ACMR of the whole cluster.
+#define SG_MESH_OPTIMIZE_OVERDRAW_THRESHOLD 1.05f
+
+	//! Post-transform cache statistics of an index buffer.
+	struct MeshCacheStatistics
+	{
+		UInt32 numTriangles = 0;
+		UInt32 numVertices = 0;    //!< Vertices referenced by the indices.
+		UInt32 numCacheMisses = 0; //!< Vertex shader invocations.
+		float  acmr = 0.0f;        //!< Average cache miss ratio, misses per triangle (0.5 is the best for a regular grid, 3.0 is the worst).
+		float  atvr = 0.0f;        //!< Average transformed vertex ratio, misses per vertex (1.0 is the best).
+	};
+
+	//! Import time optimizations of the triangle meshes.
+	//! All the functions work on an interleaved vertex buffer of vertexFloatCount floats per vertex and a triangle list.
+	class MeshOptimizer
+	{
+	public:
+		//! Run the whole pipeline: deduplicate the vertices, reorder the triangles for the post-transform cache and overdraw,
+		//! then reorder the vertices for fetching.
+		//! The meshes which are not a triangle list are left untouched.
+		//! @return If the mesh is optimized.
+		SG_CORE_API static bool Optimize(vector<float>& vertices, vector<UInt32>& indices, UInt32 vertexFloatCount,
+			MeshCacheStatistics* pOutBefore = nullptr, MeshCacheStatistics* pOutAfter = nullptr);
+
+		//! Merge the vertices with exactly the same data, and remap the indices to them.
+		SG_CORE_API static void DeduplicateVertices(vector<float>& vertices, vector<UInt32>& indices, UInt32 vertexFloatCount);
+		//! Reorder the triangles for the post-transform cache (Tipsify, Sander et al. 2007).
+		SG_CORE_API static void OptimizeVertexCache(vector<UInt32>& indices, UInt32 numVertices, UInt32 cacheSize = SG_MESH_OPTIMIZE_CACHE_SIZE);
+		//! Reorder the clusters of the cache optimized triangles from the outside in, to draw the occluders first.
+		//! Call it after OptimizeVertexCache(), the cache efficiency is kept within the threshold.
+		SG_CORE_API static void OptimizeOverdraw(vector<UInt32>& indices, const vector<float>& vertices, UInt32 vertexFloatCount,
+			float threshold = SG_MESH_OPTIMIZE_OVERDRAW_THRESHOLD, UInt32 cacheSize = SG_MESH_OPTIMIZE_CACHE_SIZE);
+		//! Reorder the vertices in the order they are first referenced by the indices, the vertices which are not referenced are dropped.
+		SG_CORE_API static void OptimizeVertexFetch(vector<float>& vertices, vector<UInt32>& indices, UInt32 vertexFloatCount);
+
+		//! Simulate a FIFO post-transform cache on the indices.
+		SG_CORE_API static MeshCacheStatistics AnalyzeVertexCache(const vector<UInt32>& indices, UInt32 numVertices, UInt32 cacheSize = SG_MESH_OPTIMIZE_CACHE_SIZE);
+	};
+
+}
\ No newline at end of file
@@ -12,10 +12,15 @@
 namespace SG
 {
 
+//! Floats per vertex of the loaded meshes: position(3), normal(3), uv(2), tangent(3).
+#define SG_MESH_VERTEX_FLOAT_COUNT 11
+#define SG_COOKED_MESH_EXTENSION ".sgmesh"
+
 	enum class ELoadMeshFlag : UInt32
 	{
 		efLoadEmbeddedMaterials = BIT(0),
-		efGenerateAABB = BIT(1),
+		efGenerateAABB = BIT(1), //! The AABB is always computed when the vertices are built, this flag is kept for compatibility.
+		efNoCookedFileWrite = BIT(2), //! Read the cooked file if it is valid, but never write it.
 	};
 	SG_ENUM_CLASS_FLAG(UInt32, ELoadMeshFlag);
 
@@ -85,6 +90,11 @@ namespace SG
 	};
 
 	//! Disk resource loader for meshes.
+	//! The first import of a mesh will write a cooked mesh file (*.sgmesh) next to the source file,
+	//! which contains the vertices, indices, AABBs and the sub mesh table, and is keyed by the content hash of the source file.
+	//! The following loads will map the cooked file directly instead of running assimp.
+	//! Meshes with embedded materials still go through assimp, because the embedded textures are not cooked.
+	//! The imported sub meshes are run through the MeshOptimizer before they are cooked, so the optimization is paid once per source.
 	class MeshResourceLoader final : public ResourceLoaderBase<EResourceTypeCategory::eMesh>
 	{
 	public:
@@ -93,6 +103,8 @@ namespace SG
 
 		SG_CORE_API bool LoadFromFile(const string& name, EMeshType type, MeshData& meshData, ELoadMeshFlag flag = ELoadMeshFlag(0));
 	private:
+		bool LoadFromCookedFile(const string& cookedPath, UInt64 sourceHash, MeshData& meshData);
+		void WriteCookedFile(const string& cookedName, UInt64 sourceHash, const MeshData& meshData);
 	};
 
 }
\ No newline at end of file
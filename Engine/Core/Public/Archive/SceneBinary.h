@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Core/Config.h"
+#include "Base/BasicTypes.h"
+#include "Math/MathBasic.h"
+#include "Math/BoundingBox.h"
+#include "Archive/ISerializable.h"
+
+#include "Stl/vector.h"
+
+namespace SG
+{
+
+#define SG_SCENE_BINARY_EXTENSION ".scenebin"
+
+	//! Binary scene format.
+	//! The whole file is one relocatable blob, there is no pointer inside it. The header stores the byte offsets of the sections,
+	//! entities refer to their component blocks by the offsets in the block section, and all the strings are referred by the offsets
+	//! in the string table. So it can be used right after it is read into memory without any parsing.
+	//!
+	//! Layout:
+	//!   SceneBinaryHeader
+	//!   SceneBinaryEntity[numEntities] (a parent always comes before its children)
+	//!   component blocks               (4 bytes aligned)
+	//!   string table                   (null-terminated strings)
+	//!
+	//! All the data is stored in little endian. The header keeps a checksum of the file, so a corrupted file is rejected
+	//! instead of loading wrong values.
+	enum : UInt32
+	{
+		SG_SCENE_BINARY_MAGIC   = 0x43534753, // 'SGSC'
+		SG_SCENE_BINARY_VERSION = 1,
+		SG_SCENE_BINARY_INVALID = UInt32(-1),
+	};
+
+	enum class ESceneBinaryBlock : UInt32
+	{
+		eMesh = 0,
+		eMaterial,
+		ePointLight,
+		eDirectionalLight,
+		eCamera,
+		NUM_BLOCKS,
+	};
+
+	enum class ESceneBinaryTexture : UInt32
+	{
+		eAlbedo = 0,
+		eMetallic,
+		eRoughness,
+		eNormal,
+		eAO,
+		NUM_TEXTURES,
+	};
+
+	struct SceneBinaryHeader
+	{
+		UInt32 magic;
+		UInt32 version;
+		UInt32 fileSize;
+		UInt32 sceneName;         //!< Offset in the string table.
+		UInt32 numEntities;
+		UInt32 entitiesOffset;
+		UInt32 blocksOffset;
+		UInt32 blocksSize;
+		UInt32 stringTableOffset;
+		UInt32 stringTableSize;
+		UInt64 checksum;          //!< FNV-1 hash of the whole file, computed with this field set to 0.
+	};
+
+	struct SceneBinaryEntity
+	{
+		UInt32   name;            //!< Offset in the string table.
+		UInt32   parent;          //!< Index of the parent entity, SG_SCENE_BINARY_INVALID if it is under the root.
+		UInt32   blockMask;       //!< Which blocks does this entity have, (1 << ESceneBinaryBlock).
+		UInt32   blocks[(UInt32)ESceneBinaryBlock::NUM_BLOCKS]; //!< Offsets in the block section.
+		Vector3f position;
+		Vector3f rotation;
+		Vector3f scale;
+	};
+
+	struct SceneBinaryMesh
+	{
+		enum : UInt32
+		{
+			efProceduralMesh = 0x01,
+			efEmbeddedResource = 0x02,
+			efHaveAABB = 0x04,
+		};
+
+		UInt32 filename;
+		UInt32 subMeshName;
+		UInt32 type;              //!< EMeshType
+		UInt32 flags;
+		AABB   aabb;
+	};
+
+	struct SceneBinaryTexture
+	{
+		enum : UInt32
+		{
+			efNeedMipmap = 0x01,
+			efIsCubeMap = 0x02,
+		};
+
+		UInt32 name;
+		UInt32 filename;
+		UInt32 flags;
+	};
+
+	struct SceneBinaryMaterial
+	{
+		UInt32   assetName;
+		UInt32   filename;
+		Vector3f albedo;
+		float    metallic;
+		float    roughness;
+		UInt32   textureMask;     //!< Which textures are valid, (1 << ESceneBinaryTexture).
+		SceneBinaryTexture textures[(UInt32)ESceneBinaryTexture::NUM_TEXTURES];
+	};
+
+	struct SceneBinaryPointLight
+	{
+		Vector3f color;
+		float    radius;
+	};
+
+	struct SceneBinaryDirectionalLight
+	{
+		Vector3f color;
+		float    shadowMapScaleFactor;
+		float    zNear;
+		float    zFar;
+	};
+
+	struct SceneBinaryCamera
+	{
+		enum : UInt32
+		{
+			efHaveVectors = 0x01,
+		};
+
+		Vector3f position;
+		float    moveSpeed;
+		Vector3f upVector;
+		Vector3f rightVector;
+		Vector3f frontVector;
+		UInt32   flags;
+	};
+
+	//! Read-only view of a binary scene in memory, it does not own the data.
+	class SceneBinaryView
+	{
+	public:
+		//! Validate the header and all the offsets, return false if the data is not a valid binary scene.
+		SG_CORE_API bool Init(const Byte* pData, Size sizeInByte);
+
+		SG_INLINE UInt32 GetEntityCount() const { return mpHeader->numEntities; }
+		SG_INLINE const SceneBinaryEntity& GetEntity(UInt32 index) const { return mpEntities[index]; }
+		SG_INLINE const char* GetSceneName() const { return GetString(mpHeader->sceneName); }
+
+		SG_INLINE const char* GetString(UInt32 offset) const { return mpStringTable + offset; }
+
+		SG_INLINE bool HaveBlock(const SceneBinaryEntity& entity, ESceneBinaryBlock block) const { return (entity.blockMask & (1 << (UInt32)block)) != 0; }
+
+		template <typename T>
+		SG_INLINE const T& GetBlock(const SceneBinaryEntity& entity, ESceneBinaryBlock block) const
+		{
+			SG_ASSERT(HaveBlock(entity, block));
+			return *reinterpret_cast<const T*>(mpBlocks + entity.blocks[(UInt32)block]);
+		}
+	private:
+		const SceneBinaryHeader* mpHeader = nullptr;
+		const SceneBinaryEntity* mpEntities = nullptr;
+		const Byte*              mpBlocks = nullptr;
+		const char*              mpStringTable = nullptr;
+	};
+
+	//! Converter between the json scene and the binary scene.
+	//! The json scene is kept as the import/export format, and the binary scene is used to load the scene fast.
+	class SceneBinary
+	{
+	public:
+		SG_CORE_API static bool FromJson(const json& scene, vector<Byte>& outData);
+		SG_CORE_API static bool ToJson(const Byte* pData, Size sizeInByte, json& outScene);
+	};
+
+}
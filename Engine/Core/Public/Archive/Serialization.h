@@ -12,7 +12,10 @@ namespace SG
 	class Serializer
 	{
 	public:
+		//! Save the scene as json, or as binary if the scene name ends with SG_SCENE_BINARY_EXTENSION.
 		SG_CORE_API static void Serialize(RefPtr<Scene> pScene, const char* sceneName);
+		//! Convert a json scene file to a binary scene file.
+		SG_CORE_API static bool ConvertToBinary(const char* jsonSceneName, const char* binarySceneName);
 	private:
 
 	};
@@ -20,9 +23,12 @@ namespace SG
 	class Deserializer
 	{
 	public:
+		//! Load the scene from a json or a binary scene file.
+		//! When loading a json scene, the binary scene next to it will be used if it is up to date,
+		//! otherwise the binary scene will be regenerated from the json scene.
 		SG_CORE_API static void Deserialize(RefPtr<Scene> pScene, const char* sceneName);
 	private:
 
 	};
 
-}
\ No newline at end of file
+}
@@ -4,7 +4,7 @@
 #include "Base/BasicTypes.h"
 
 #include "Stl/string.h"
-#include "eastl/unordered_map.h"
+#include "EASTL/unordered_map.h"
 #include "Stl/SmartPtr.h"
 
 namespace SG
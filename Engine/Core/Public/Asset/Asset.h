@@ -70,6 +70,8 @@ namespace SG
 		virtual void   LoadDataFromFile() noexcept override;
 		virtual bool   IsDiskResourceLoaded() const noexcept { return mTextureData.IsValid(); };
 	private:
+		friend class AsyncResourceLoader;
+
 		string       mFilename;
 		Raw2DTexture mTextureData; //! For now, TextureAsset only refs to 2d textures.
 		
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
 #include "Memory/Memory.h"
 
-#include "eastl/type_traits.h"
+#include "EASTL/type_traits.h"
 
 namespace SG
 {
@@ -372,4 +373,57 @@ namespace SG
 		return mMyVersionNumber == *mpVersionNumber;
 	}
 
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// GenerationalHandle
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//! Index of a slot and the generation of that slot packed into one integer.
+	//! The owner of the slots increases the generation each time a slot is allocated or freed,
+	//! so a handle kept after its slot was freed (and maybe reused) no longer matches the generation of the slot.
+	//! The check is O(1) and the handle holds no pointer, it can be copied freely and stored in the components.
+	//! The generation wraps after 2^GENERATION_BITS reuses of the same slot.
+	template <typename TStorage, UInt32 IndexBits>
+	class GenerationalHandle
+	{
+	private:
+		static_assert(eastl::is_unsigned_v<TStorage>, "TStorage must be an unsigned integer!");
+		static_assert(IndexBits > 0 && IndexBits < sizeof(TStorage) * 8, "There must be bits left for the generation!");
+		using ThisType = GenerationalHandle<TStorage, IndexBits>;
+	public:
+		using StorageType = TStorage;
+
+		static constexpr UInt32      INDEX_BITS = IndexBits;
+		static constexpr UInt32      GENERATION_BITS = sizeof(TStorage) * 8 - IndexBits;
+		static constexpr StorageType INDEX_MASK = (StorageType(1) << IndexBits) - 1;
+		static constexpr StorageType GENERATION_MASK = StorageType(-1) >> IndexBits;
+		//! The largest index is reserved, the null handle have all the bits set.
+		static constexpr StorageType MAX_INDEX = INDEX_MASK - 1;
+
+		constexpr GenerationalHandle() noexcept : mValue(StorageType(-1)) {}
+		constexpr GenerationalHandle(StorageType index, StorageType generation) noexcept
+			:mValue((index & INDEX_MASK) | ((generation & GENERATION_MASK) << IndexBits))
+		{}
+
+		static constexpr ThisType FromValue(StorageType value) noexcept { ThisType handle; handle.mValue = value; return handle; }
+
+		constexpr StorageType GetIndex()      const noexcept { return mValue & INDEX_MASK; }
+		constexpr StorageType GetGeneration() const noexcept { return mValue >> IndexBits; }
+		constexpr StorageType GetValue()      const noexcept { return mValue; }
+		//! A null handle never matches any slot, but a non-null handle may still be stale, ask the owner of the slots.
+		constexpr bool        IsNull()        const noexcept { return mValue == StorageType(-1); }
+
+		//! Check the generation of the slot (as stored by the owner) against the handle.
+		constexpr bool MatchGeneration(StorageType slotGeneration) const noexcept { return (slotGeneration & GENERATION_MASK) == GetGeneration(); }
+
+		constexpr bool operator==(const ThisType& rhs) const noexcept { return mValue == rhs.mValue; }
+		constexpr bool operator!=(const ThisType& rhs) const noexcept { return mValue != rhs.mValue; }
+	private:
+		StorageType mValue;
+	};
+
+	//! 1M slots with 4096 generations each.
+	using GenHandle32 = GenerationalHandle<UInt32, 20>;
+	//! 4G slots with 4G generations each.
+	using GenHandle64 = GenerationalHandle<UInt64, 32>;
+
 }
\ No newline at end of file
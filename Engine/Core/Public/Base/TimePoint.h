@@ -2,7 +2,7 @@
 
 #include "Base/BasicTypes.h"
 
-#include <eastl/tuple.h>
+#include <EASTL/tuple.h>
 
 namespace SG
 {
@@ -4,4 +4,4 @@
 
 #define SG_FORCE_INLINE __attribute__((always_inline)) inline
 
-#define SG_ALIGN(x)     __attribute__((aligned(bytes)))
\ No newline at end of file
+#define SG_ALIGN(x)     __attribute__((aligned(x)))
\ No newline at end of file
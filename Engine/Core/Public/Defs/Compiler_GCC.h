@@ -0,0 +1,7 @@
+#pragma once
+
+// GCC compiler specification
+
+#define SG_FORCE_INLINE __attribute__((always_inline)) inline
+
+#define SG_ALIGN(x)     __attribute__((aligned(x)))
\ No newline at end of file
@@ -29,6 +29,10 @@
 #	define EA_COMPILER_MSVC_2019 1
 #	define EA_COMPILER_MSVC16_0  1
 #	endif
+#elif defined(__GNUC__)
+#	define SG_COMPILER_GCC     1
+#	define SG_COMPILER_VERSION (__GNUC__ * 100 + __GNUC_MINOR__)
+#	define SG_COMPILER_NAME    "gcc"
 #else
 #	error Unknown compiler
 #endif
@@ -37,4 +41,6 @@
 #	include "Compiler_Windows.h"
 #elif  defined(SG_COMPILER_CLANG)
 #	include "Compiler_Clang.h"
+#elif  defined(SG_COMPILER_GCC)
+#	include "Compiler_GCC.h"
 #endif
@@ -50,7 +50,11 @@
 #endif
 
 #ifndef SG_ASSERT
-#	define SG_ASSERT(x) do { if(!(x)) __debugbreak(); } while(false)
+#	ifdef SG_COMPILER_MSVC
+#		define SG_ASSERT(x) do { if(!(x)) __debugbreak(); } while(false)
+#	else
+#		define SG_ASSERT(x) do { if(!(x)) __builtin_trap(); } while(false)
+#	endif
 #endif
 
 #ifndef SG_DEPRECATED
@@ -61,7 +65,11 @@
 
 #define SG_CONSTEXPR constexpr
 
-#define SG_THREAD_LOCAL __declspec(thread)
+#ifdef SG_COMPILER_MSVC
+#	define SG_THREAD_LOCAL __declspec(thread)
+#else
+#	define SG_THREAD_LOCAL thread_local
+#endif
 
 #ifdef SG_ALLOW_EXCEPTION
 #	define SG_ENABLE_EXCEPTION 1
@@ -72,7 +80,7 @@
 #ifndef SG_RESTRICT
 #	if defined(SG_COMPILER_MSVC) && (SG_COMPILER_VERSION >= 1400)
 #		define SG_RESTRICT __restrict
-#	elif defined(SG_COMPILER_CLANG)
+#	elif defined(SG_COMPILER_CLANG) || defined(SG_COMPILER_GCC)
 #		define SG_RESTRICT __restrict
 #	else
 #		define SG_RESTRICT
@@ -3,6 +3,9 @@
 #if defined(__x86_64__) || defined(_M_X64)
 #	define SG_PLATFORM_X64   1
 #	define SG_PLATFORM_SSE2  1
+#	if defined(__AVX__)
+#		define SG_PLATFORM_AVX  1
+#	endif
 #elif defined(__i386) || defined(_M_IX86) || defined(__arm__)
 #	error 32-bit platforms are not supported.
 #elif defined(__aarch64__)
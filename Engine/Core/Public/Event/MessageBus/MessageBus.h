@@ -8,17 +8,18 @@
 #include "Reflection/Name.h"
 #include "Stl/Utility.h"
 
-#include "eastl/vector.h"
-#include "eastl/unordered_map.h"
-#include "eastl/functional.h"
-#include "eastl/tuple.h"
-#include "eastl/string.h"
+#include "EASTL/vector.h"
+#include "EASTL/unordered_map.h"
+#include "EASTL/functional.h"
+#include "EASTL/tuple.h"
+#include "EASTL/string.h"
 
 namespace SG
 {
 
 	// forward decoration
 	class MessageBusMember;
+	class System;
 
 	typedef eastl::function<void(MessageBusMember* pMember)> TReceivedCallBackFunc;
 
@@ -102,7 +103,7 @@ namespace SG
 
 			SG_CORE_API static MessageBus* GetInstance();
 		private:
-			friend class System;
+			friend class SG::System;
 			MessageBus() = default;
 
 			void ClearEvents();
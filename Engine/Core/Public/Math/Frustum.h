@@ -15,6 +15,10 @@ namespace SG
 			:mFrontPlane(front), mBackPlane(back), mRightPlane(right), mLeftPlane(left), mTopPlane(top), mBottomPlane(bottom)
 		{}
 
+		//! Extract the frustum from a view projection matrix (Gribb-Hartmann), the planes are normalized and face inward.
+		//! A point p is inside the frustum if dot(vec4(p, 1.0), plane) >= 0 for all the planes.
+		SG_CORE_API static Frustum FromViewProj(const Matrix4f& viewProj);
+
 		SG_CORE_API Plane GetFrontPlane() const;
 		SG_CORE_API Plane GetBackPlane() const;
 		SG_CORE_API Plane GetRightPlane() const;
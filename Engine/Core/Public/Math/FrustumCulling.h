@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Math/Frustum.h"
+#include "Math/BoundingBox.h"
+
+#include "Stl/vector.h"
+
+namespace SG
+{
+
+	//! Bounding boxes stored as structure of arrays, so that the culling kernels can test several boxes at once.
+	struct AABBSoA
+	{
+		vector<float> centerX;
+		vector<float> centerY;
+		vector<float> centerZ;
+		vector<float> extentX;
+		vector<float> extentY;
+		vector<float> extentZ;
+
+		Size GetSize() const noexcept { return centerX.size(); }
+
+		SG_CORE_API void Resize(Size size);
+		SG_CORE_API void Clear();
+		SG_CORE_API void Set(Size index, const AABB& aabb);
+		SG_CORE_API void PushBack(const AABB& aabb);
+	};
+
+	//! Bounding spheres stored as structure of arrays.
+	struct SphereSoA
+	{
+		vector<float> centerX;
+		vector<float> centerY;
+		vector<float> centerZ;
+		vector<float> radius;
+
+		Size GetSize() const noexcept { return centerX.size(); }
+
+		SG_CORE_API void Resize(Size size);
+		SG_CORE_API void Clear();
+		SG_CORE_API void Set(Size index, const Vector3f& center, float r);
+		SG_CORE_API void PushBack(const Vector3f& center, float r);
+	};
+
+	//! The kernels the culling runs with, from the narrowest to the widest.
+	//! The wider kernels go first, and the narrower ones deal with the rest of the elements.
+	enum class ECullingKernel : UInt32
+	{
+		eScalar,
+		eSSE2,
+		eAVX,
+	};
+
+	//! The widest kernel built for the target, every kernel gives the same visibility as the scalar one.
+	SG_CORE_API ECullingKernel GetWidestCullingKernel();
+
+	//! Test all the boxes against the frustum, pVisibility[i] is set to 1 if the box i intersects the frustum, otherwise 0.
+	//! pVisibility must have at least boxes.GetSize() elements. Return the number of the visible boxes.
+	//! The test is conservative, a box near the corner of the frustum may be reported as visible.
+	//! The kernels wider than widestKernel are not used.
+	SG_CORE_API UInt32 FrustumCullAABBs(const Frustum& frustum, const AABBSoA& boxes, UInt8* pVisibility, ECullingKernel widestKernel = ECullingKernel::eAVX);
+	//! Test all the spheres against the frustum, the planes of the frustum must be normalized (see Frustum::FromViewProj()).
+	SG_CORE_API UInt32 FrustumCullSpheres(const Frustum& frustum, const SphereSoA& spheres, UInt8* pVisibility, ECullingKernel widestKernel = ECullingKernel::eAVX);
+
+	SG_CORE_API bool FrustumIntersectAABB(const Frustum& frustum, const AABB& aabb);
+	SG_CORE_API bool FrustumIntersectSphere(const Frustum& frustum, const Vector3f& center, float radius);
+
+}
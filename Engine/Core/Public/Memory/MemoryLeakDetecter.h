@@ -3,7 +3,7 @@
 #include "Base/BasicTypes.h"
 
 #include "Stl/string.h"
-#include "eastl/unordered_map.h"
+#include "EASTL/unordered_map.h"
 
 namespace SG
 {
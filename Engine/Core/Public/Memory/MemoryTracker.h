@@ -3,7 +3,7 @@
 #include "Core/Config.h"
 #include "Base/BasicTypes.h"
 
-#include "eastl/utility.h"
+#include "EASTL/utility.h"
 
 namespace SG
 {
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Core/Config.h"
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+
+#include "Stl/vector.h"
+
+namespace SG
+{
+
+	//! O(1) allocator of the ranges in a linear resource (i.e. a big gpu buffer), it only manages the offsets and never touches the memory.
+	//! It follows the two-level segregated fit (TLSF) scheme: the free regions are put in 256 bins indexed by a small float of their sizes
+	//! (5 bits exponent, 3 bits mantissa), and two levels of bit masks find the first non-empty bin which fits a request with two bit scans.
+	//! The freed region is merged with its free neighbours. The offsets and the sizes can be in any unit (bytes, vertices, instances).
+	class OffsetAllocator
+	{
+	public:
+		using AllocationID = UInt32;
+
+		enum : UInt32
+		{
+			INVALID_ID = UInt32(-1),
+			INVALID_OFFSET = UInt32(-1),
+		};
+
+		struct Allocation
+		{
+			UInt32       offset = INVALID_OFFSET;
+			AllocationID id = INVALID_ID; //!< Stays valid until the allocation is freed, even if Defragment() moves the allocation.
+
+			SG_INLINE bool IsValid() const noexcept { return id != INVALID_ID; }
+		};
+
+		//! An allocation moved by Defragment(), copy the old data in [srcOffset, srcOffset + size) to dstOffset.
+		struct Move
+		{
+			AllocationID id;
+			UInt32 srcOffset;
+			UInt32 dstOffset;
+			UInt32 size;
+		};
+
+		SG_CORE_API OffsetAllocator();
+		SG_CORE_API explicit OffsetAllocator(UInt32 size);
+		~OffsetAllocator() = default;
+
+		//! Return an invalid allocation if no free region can hold the size.
+		SG_CORE_API Allocation Allocate(UInt32 size);
+		SG_CORE_API void       Deallocate(AllocationID id);
+		//! Enlarge the managed resource, the new space is appended at the end and the allocations are kept.
+		SG_CORE_API void       Grow(UInt32 newSize);
+		//! Free all the allocations and manage a resource of the size.
+		SG_CORE_API void       Reset(UInt32 size);
+		//! Pack all the allocations to the front of the resource in the order of their offsets, so the free space becomes one region at the end.
+		//! The moves are appended to outMoves in the increasing order of the offsets, every move goes to a lower offset.
+		//! It is O(n log n) with the number of the allocations, call it when the free space is too scattered to hold a request.
+		SG_CORE_API void       Defragment(vector<Move>& outMoves);
+
+		SG_CORE_API UInt32 GetOffset(AllocationID id) const;
+		SG_CORE_API UInt32 GetAllocationSize(AllocationID id) const;
+
+		SG_INLINE UInt32 GetSize() const { return mSize; }
+		SG_INLINE UInt32 GetUsedSize() const { return mUsedSize; }
+		SG_INLINE UInt32 GetFreeSize() const { return mSize - mUsedSize; }
+		SG_INLINE UInt32 GetNumAllocations() const { return mNumAllocations; }
+		//! Size of the largest free region, only the nodes of the highest non-empty bin are visited.
+		SG_CORE_API UInt32 GetLargestFreeRegion() const;
+
+		//! Check the links of the nodes, the bins and the bit masks, and that the nodes cover the resource without overlapping.
+		SG_CORE_API bool Validate() const;
+	private:
+		enum : UInt32
+		{
+			NUM_TOP_BINS = 32,
+			BINS_PER_LEAF = 8,
+			NUM_LEAF_BINS = NUM_TOP_BINS * BINS_PER_LEAF,
+			INVALID_NODE = UInt32(-1),
+		};
+
+		enum class ENodeState : UInt8
+		{
+			eReleased = 0, //!< In the node free list, not a part of the resource.
+			eFree,
+			eUsed,
+		};
+
+		struct Node
+		{
+			UInt32 offset = 0;
+			UInt32 size = 0;
+			UInt32 binListPrev = INVALID_NODE;
+			UInt32 binListNext = INVALID_NODE;
+			UInt32 neighborPrev = INVALID_NODE;
+			UInt32 neighborNext = INVALID_NODE;
+			ENodeState state = ENodeState::eReleased;
+		};
+
+		UInt32 NewNode(UInt32 offset, UInt32 size);
+		void   ReleaseNode(UInt32 node);
+		void   AddToBin(UInt32 node);
+		void   RemoveFromBin(UInt32 node);
+	private:
+		vector<Node>   mNodes;
+		vector<UInt32> mReleasedNodes;
+		UInt32 mBinHeads[NUM_LEAF_BINS];
+		UInt8  mUsedLeafBins[NUM_TOP_BINS];
+		UInt32 mUsedTopBins = 0;
+		UInt32 mLastNode = INVALID_NODE; //!< The node at the end of the resource.
+
+		UInt32 mSize = 0;
+		UInt32 mUsedSize = 0;
+		UInt32 mNumAllocations = 0;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Core/Config.h"
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+
+namespace SG
+{
+
+	//! Read-only memory mapped file.
+	//! The file content is mapped into the address space, and the pages are loaded by the OS on demand.
+	class SG_CORE_API MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+		SG_CLASS_NO_COPY_ASSIGNABLE(MappedFile);
+
+		//! Map the whole file, the path is the full path of the file.
+		bool Open(const char* path);
+		void Close();
+
+		SG_INLINE bool        IsValid() const { return mpData != nullptr; }
+		SG_INLINE const Byte* GetData() const { return mpData; }
+		SG_INLINE Size        GetSize() const { return mSize; }
+	private:
+		const Byte* mpData = nullptr;
+		Size        mSize = 0;
+		void*       mpFileHandle = nullptr;    //!< HANDLE on windows, file descriptor on linux.
+		void*       mpMappingHandle = nullptr; //!< Only used on windows.
+	};
+
+}
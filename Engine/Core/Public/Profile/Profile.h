@@ -16,12 +16,14 @@ namespace SG
 #	define SG_PROFILE_FRAME_MARK() FrameMark
 #	define SG_PROFILE_ALLOC(PTR, SIZE) TracyAlloc(PTR, SIZE)
 #	define SG_PROFILE_FREE(PTR) TracyFree(PTR)
+#	define SG_PROFILE_THREAD_NAME(NAME) tracy::SetThreadName(NAME)
 #else
 #	define SG_PROFILE_FUNCTION()
 #	define SG_PROFILE_SCOPE(NAME)
 #	define SG_PROFILE_FRAME_MARK()
 #	define SG_PROFILE_ALLOC(PTR, SIZE)
 #	define SG_PROFILE_FREE(PTR, SIZE)
+#	define SG_PROFILE_THREAD_NAME(NAME)
 #endif
 
 }
\ No newline at end of file
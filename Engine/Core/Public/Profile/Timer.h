@@ -34,7 +34,7 @@ namespace SG
 		SG_CORE_API inline operator float() const  { return mPreviousDuration; }
 		SG_CORE_API inline operator double() const { return mPreviousDuration; }
 	protected:
-		std::chrono::steady_clock::time_point mLastTickPoint;
+		std::chrono::high_resolution_clock::time_point mLastTickPoint;
 		float mPreviousDuration;
 		float mLifeDuration;
 		bool  mbTimerStoped = false;
@@ -1,7 +1,7 @@
 #pragma once
 
-#include <eastl/string.h>
-#include <eastl/string_view.h>
+#include <EASTL/string.h>
+#include <EASTL/string_view.h>
 
 namespace SG
 {
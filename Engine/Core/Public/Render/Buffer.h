@@ -38,4 +38,11 @@ namespace SG
 		SG_NULLABLE UInt32 subBufferOffset = 0;
 	};
 
+	struct BufferCopyRegion
+	{
+		UInt32 srcOffset;
+		UInt32 dstOffset;
+		UInt32 size;
+	};
+
 }
\ No newline at end of file
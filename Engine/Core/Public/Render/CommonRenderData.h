@@ -4,7 +4,7 @@
 #include "Math/MathBasic.h"
 
 #include "Stl/vector.h"
-#include "eastl/array.h"
+#include "EASTL/array.h"
 
 namespace SG
 {
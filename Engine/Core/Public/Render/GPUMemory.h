@@ -32,6 +32,7 @@ namespace SG
 		efInvalid = 0,
 		efPersistent_Map = BIT(0),
 		efDedicated_Memory = BIT(1), //! Used it for big resource, e.g. attachments and images.
+		efTransient = BIT(2), //! Content only lives within a frame, the render graph may alias its memory with the other transient render targets.
 	};
 	SG_ENUM_CLASS_FLAG(UInt32, EGPUMemoryFlag);
 
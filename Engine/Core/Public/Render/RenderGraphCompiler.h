@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Core/Config.h"
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+
+#include "Render/Queue.h"
+
+#include "Stl/vector.h"
+
+namespace SG
+{
+
+	//! Backend-agnostic compiler of a render graph, it only knows which resources the passes read and write, so it runs without a gpu device.
+	//! The dependencies follow the declaration order of the passes: a read depends on the last pass which wrote the resource before it,
+	//! a write waits for the passes which read or wrote the previous content. From the dependencies it
+	//! - sorts the passes by their dependency levels, the passes of the same level do not depend on each other and keep the declaration order.
+	//! - culls the disabled passes and the passes whose results never reach an output resource.
+	//! - assigns the passes to the queues and finds the waits between the queues.
+	//! The dependencies through the resources which are not declared (i.e. the buffers written by the compute shaders) are not seen.
+	class RenderGraphCompiler
+	{
+	public:
+		enum : UInt32
+		{
+			INVALID_INDEX = UInt32(-1),
+		};
+
+		//! Remove all the passes and the resources.
+		SG_CORE_API void   Reset();
+		//! Return the index to declare the reads and the writes with.
+		//! The content of an output resource is used out of the render graph (i.e. presented), the last pass writing it is never culled.
+		SG_CORE_API UInt32 AddResource(bool bOutput = false);
+		//! Return the index of the pass, a disabled pass is culled but still sorted, so the positions of the others do not change when it is enabled again.
+		SG_CORE_API UInt32 AddPass(EQueueType queue = EQueueType::eGraphic, bool bEnabled = true);
+		SG_CORE_API void   Read(UInt32 pass, UInt32 resource);
+		//! A write which keeps the previous content (i.e. load the attachment) should be declared as a read too.
+		SG_CORE_API void   Write(UInt32 pass, UInt32 resource);
+
+		//! Sort, cull and assign the queues of the passes declared.
+		//! Without the async compute, the compute passes are assigned to the graphic queue.
+		SG_CORE_API void Compile(bool bAsyncCompute = false);
+
+		//! All the passes in the execution order, including the culled ones.
+		SG_INLINE const vector<UInt32>& GetExecutionOrder() const { return mExecutionOrder; }
+		SG_INLINE UInt32 GetNumPass() const { return static_cast<UInt32>(mPasses.size()); }
+		SG_INLINE UInt32 GetNumResource() const { return static_cast<UInt32>(mResources.size()); }
+
+		SG_INLINE bool       IsPassCulled(UInt32 pass) const { return mPasses[pass].bCulled; }
+		//! The passes of the same level do not depend on each other, they can be recorded in parallel.
+		SG_INLINE UInt32     GetPassLevel(UInt32 pass) const { return mPasses[pass].level; }
+		SG_INLINE EQueueType GetPassQueue(UInt32 pass) const { return mPasses[pass].assignedQueue; }
+		//! The passes on the other queues this pass should wait for, i.e. by semaphores.
+		SG_INLINE const vector<UInt32>& GetCrossQueueWaits(UInt32 pass) const { return mPasses[pass].crossQueueWaits; }
+
+		//! The first and the last position in the execution order of the passes using the resource, the culled passes are included.
+		//! Return false if no pass uses it.
+		SG_CORE_API bool GetResourceLifetime(UInt32 resource, UInt32& firstPosition, UInt32& lastPosition) const;
+		//! The content of the resource is not used across the frames, i.e. the first pass using it only writes it.
+		SG_INLINE bool IsResourceTransient(UInt32 resource) const { return mResources[resource].bTransient; }
+	private:
+		struct Pass
+		{
+			vector<UInt32> reads;
+			vector<UInt32> writes;
+			EQueueType     queue;
+			bool           bEnabled;
+
+			vector<UInt32> dependencies;
+			UInt32         level = 0;
+			bool           bCulled = true;
+			EQueueType     assignedQueue;
+			vector<UInt32> crossQueueWaits;
+		};
+
+		struct Resource
+		{
+			bool   bOutput;
+			vector<UInt32> writers; //!< In the declaration order.
+			UInt32 firstPosition = INVALID_INDEX;
+			UInt32 lastPosition = INVALID_INDEX;
+			bool   bTransient = false;
+		};
+
+		void BuildDependencies();
+		void CullPasses();
+		void SortPasses();
+		void AssignQueues(bool bAsyncCompute);
+		void ComputeLifetimes();
+
+		//! The last enabled pass declared before the pass which writes the resource.
+		UInt32 FindEnabledWriter(UInt32 resource, UInt32 pass) const;
+	private:
+		vector<Pass>     mPasses;
+		vector<Resource> mResources;
+		vector<UInt32>   mExecutionOrder;
+	};
+
+}
\ No newline at end of file
@@ -7,12 +7,13 @@
 #include "System/Logger.h"
 #include "Memory/Memory.h"
 
-#include <eastl/map.h>
-#include <eastl/fixed_map.h>
-#include <eastl/utility.h>
-#include <eastl/set.h>
-#include "stl/vector.h"
-#include "stl/string_view.h"
+#include <EASTL/map.h>
+#include <EASTL/fixed_map.h>
+#include <EASTL/utility.h>
+#include <EASTL/set.h>
+#include <EASTL/list.h>
+#include "Stl/vector.h"
+#include "Stl/string_view.h"
 
 namespace SG
 {
@@ -128,8 +129,8 @@ namespace SG
 	class ShaderSetBindingAttributeLayout
 	{
 	public:
-		typedef typename eastl::map<string, typename ElementType>::iterator       IteratorType;
-		typedef typename eastl::map<string, typename ElementType>::const_iterator ConstIteratorType;
+		typedef typename eastl::map<string, ElementType>::iterator       IteratorType;
+		typedef typename eastl::map<string, ElementType>::const_iterator ConstIteratorType;
 
 		bool Exist(const string& name) { return mDataMap.find(name) != mDataMap.end(); }
 		ElementType& Get(const string& name) { return mDataMap[name]; }
@@ -146,7 +147,7 @@ namespace SG
 		ConstIteratorType cend()   const { return mDataMap.cend(); }
 	private:
 		friend class ShaderCompiler;
-		eastl::map<string, typename ElementType> mDataMap;
+		eastl::map<string, ElementType> mDataMap;
 	};
 
 	struct GPUBufferLayout
@@ -230,19 +231,20 @@ namespace SG
 		friend class ShaderCompiler;
 		string mEntryPoint = "main"; // default
 		EShaderLanguage mLanguage;
+		eastl::list<string> mLayoutNames; //!< The names viewed by the elements of the layouts.
 	};
 
 	//! Helper class to keep the binding or the location ordered.
 	template <typename ElementType>
 	struct ShaderAttributesLayoutLocationComparer
 	{
-		bool operator()(const eastl::pair<UInt32, typename ElementType>& lhs,
-			const eastl::pair<UInt32, typename ElementType>& rhs)
+		bool operator()(const eastl::pair<UInt32, ElementType>& lhs,
+			const eastl::pair<UInt32, ElementType>& rhs)
 		{
 			return lhs.first < rhs.first;
 		}
 	};
 	template <typename ElementType>
-	using OrderSet = eastl::set<eastl::pair<UInt32, typename ElementType>, ShaderAttributesLayoutLocationComparer<typename ElementType>>;
+	using OrderSet = eastl::set<eastl::pair<UInt32, ElementType>, ShaderAttributesLayoutLocationComparer<ElementType>>;
 
 }
\ No newline at end of file
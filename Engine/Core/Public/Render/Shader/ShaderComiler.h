@@ -4,11 +4,23 @@
 #include "Render/Shader/Shader.h"
 
 #include "Stl/string.h"
+#include "Stl/vector.h"
 #include "Stl/SmartPtr.h"
 
 namespace SG
 {
 
+	//! A shader to compile by ShaderCompiler::CompileGLSLShaders().
+	struct ShaderCompileRequest
+	{
+		string         shaderName;     //!< Name of the shader, only the vertex stage is compiled if fragShaderName is not empty.
+		string         fragShaderName; //!< Name of the fragment shader, leave it empty to compile all the stages of shaderName.
+		RefPtr<Shader> pShader;
+
+		bool   bSucceeded = false; //!< Output, if the shader is compiled and reflected.
+		string diagnostics;        //!< Output, the messages of the compiler for each stage.
+	};
+
 	class ShaderCompiler
 	{
 	public:
@@ -29,6 +41,7 @@ namespace SG
 
 		//! Compile GLSL shaders to SPIRV shaders and load them in
 		//! The format of shaders' name should be ***.vert or ***.frag for GLSL shaders.
+		//! The stages whose sources, includes and compiler had not changed are taken from the ShaderLibrary without compiling.
 		//! @param [binShaderName] Just name of the shaders, like basic. it will try find all the basic.vert, basic.frag, etc...
 		//! @param [outStages] Output data of shader stages.
 		//! @return If it successfully load in the shaders.
@@ -41,14 +54,31 @@ namespace SG
 		//! @param [outStages] Output data of shader stages.
 		//! @return If it successfully load in the shaders.
 		SG_CORE_API static bool CompileGLSLShader(const string& vertShaderName, const string& fragShaderName, RefPtr<Shader> pShader);
+
+		//! Compile a batch of GLSL shaders and load them in, the stages to compile are run in parallel on the job workers.
+		//! A stage shared by several shaders is compiled once.
+		//! @param [requests] The shaders to compile, the results and the diagnostics are written back.
+		//! @return If all the shaders are successfully compiled.
+		SG_CORE_API static bool CompileGLSLShaders(vector<ShaderCompileRequest>& requests);
 	private:
+		struct PendingStage;
+
+		//! Take the stage from the ShaderLibrary into the shader, or add it to the pendings to compile.
+		//! @return If the stage is taken from the ShaderLibrary.
+		static bool PrepareStage(const string& shaderName, UInt32 stage, UInt32 requestIndex, RefPtr<Shader> pShader, vector<PendingStage>& outPendings);
+		//! Check the result of the compiled stage, load it into the shaders and the ShaderLibrary.
+		static bool FinishStage(const PendingStage& pending, vector<ShaderCompileRequest>& requests);
 		static bool ReadInShaderData(const string& name, UInt32 stage, RefPtr<Shader> pShader, UInt8& checkFlag);
-		static bool CompileShaderVkSDK(const string& actualName, const string& compiledName, const string& pOut);
-		static bool CompileShaderVendor(const string& actualName, const string& compiledName, const string& pOut);
-		static bool CheckCompileError(const string& actualName, const string& outputMessage);
+		static string GetCompileCommand(const string& actualName, const string& compiledName);
+		static bool CheckCompileError(const string& actualName, const string& outputMessage, int exitCode, string& outDiagnostics);
 
-		//! Use spirv-cross to reflect shader info from .spv(compiled shader).
+		//! Reflect shader info from .spv(compiled shader), the reflections are cached in the ShaderLibrary by the hash of the SPIR-V.
+		//! If SG_VALIDATE_SHADER_REFLECTION is on, the cached reflections are checked against spirv-cross.
 		static bool ReflectSPIRV(RefPtr<Shader> pShader);
+		//! Use spirv-cross to reflect a stage into a compact blob.
+		static void ReflectStage(const Shader::ShaderBinaryType& binary, vector<Byte>& outReflection);
+		//! Read the blob of ReflectStage() into the shader.
+		static bool ApplyReflection(const vector<Byte>& reflection, EShaderStage stage, Shader& shader);
 	};
 
 }
\ No newline at end of file
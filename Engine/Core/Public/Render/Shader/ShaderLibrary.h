@@ -1,32 +1,86 @@
 #pragma once
 
-#include "Base/TimePoint.h"
+#include "Base/BasicTypes.h"
 
-#include <eastl/unordered_map.h>
+#include "Stl/vector.h"
+#include "Stl/string.h"
+#include <EASTL/unordered_map.h>
 
 namespace SG
 {
 
+// the database of the compiled shaders in the shader binaries folder.
+#define SG_SHADER_CACHE_FILE_NAME "shader_cache.bin"
+// the compiled shaders which are not used in this number of runs are dropped from the database.
+#define SG_SHADER_CACHE_MAX_UNUSED_RUNS 16
+
 	//! Singleton class.
+	//! Content addressed cache of the compiled shaders.
+	//! A shader stage is keyed by the hash of its source, all the sources it includes and how it is compiled,
+	//! so it is compiled again only if something it is compiled from had changed, no matter when the files were touched.
 	class ShaderLibrary
 	{
 	public:
 		~ShaderLibrary() = default;
 
-		void      SetShaderTimeStamp(const string& shaderName, const TimePoint& tp);
-		TimePoint GetShaderTimeStamp(const string& shaderName);
+		//! Hash the source and all the sources it includes directly or not, the include graph is updated by the sources read.
+		//! @return 0 if the source can not be read.
+		UInt64 HashSourceWithIncludes(const string& sourceName);
+		//! Get the sources the source is compiled from (itself and its includes) which had changed since the last run.
+		//! Call it after HashSourceWithIncludes().
+		void   GetChangedSources(const string& sourceName, vector<string>& outSources);
+
+		//! Find the SPIR-V compiled with the key.
+		bool FindBinary(UInt64 key, vector<Byte>& outBinary);
+		void AddBinary(UInt64 key, const vector<Byte>& binary);
+
+		//! Find the reflection of the SPIR-V, keyed by the hash of the SPIR-V.
+		//! The reflection is an opaque blob written and read by the ShaderCompiler.
+		bool FindReflection(UInt64 binaryHash, vector<Byte>& outReflection);
+		void AddReflection(UInt64 binaryHash, const vector<Byte>& reflection);
 
 		static ShaderLibrary* GetInstance();
 	private:
 		ShaderLibrary() = default;
 		friend class System;
+		friend class ShaderLibraryTestScope; //!< The unit tests run the library on a sandbox folder.
 
-		//! Read in shader_env.ini.
+		//! Read in the shader cache database.
 		void OnInit();
-		//! Write shader_env.ini.
+		//! Write the shader cache database if it had changed.
 		void OnShutdown();
+
+		struct SourceRecord
+		{
+			UInt64         contentHash;
+			vector<string> includes; //!< Names of the included sources, relative to the shader sources folder.
+		};
+
+		//! Read the source and parse its includes once in a run, return nullptr if it can not be read.
+		const SourceRecord* ReadSource(const string& sourceName);
+		//! Collect the source and all the sources it includes in a deterministic order, each source is collected once.
+		void CollectSources(const string& sourceName, vector<string>& outSources);
+
+		struct CachedBlob
+		{
+			vector<Byte> data;
+			UInt32       lastUsedRun;
+		};
+		typedef eastl::unordered_map<UInt64, CachedBlob> BlobMap;
+
+		bool FindBlob(BlobMap& blobs, UInt64 key, vector<Byte>& outBlob);
+		void AddBlob(BlobMap& blobs, UInt64 key, const vector<Byte>& blob);
+		//! Read the blobs until the data is broken, return false if it is broken.
+		//! The hashes of the binaries and the reflections have different seeds, so that one is never read as the other.
+		bool ReadBlobs(const vector<Byte>& data, Size& offset, UInt32 numBlobs, UInt64 hashSeed, BlobMap& outBlobs);
+		void WriteBlobs(vector<Byte>& data, const BlobMap& blobs, UInt64 hashSeed);
 	private:
-		eastl::unordered_map<string, TimePoint> mShaderTimePointMap;
+		eastl::unordered_map<string, SourceRecord> mSources;          //!< The include graph of the sources read in this run.
+		eastl::unordered_map<string, UInt64>       mPrevSourceHashes;  //!< Content hashes of the sources read in the previous runs.
+		BlobMap mBinaries;    //!< SPIR-V keyed by the sources and the compiler.
+		BlobMap mReflections; //!< Reflections keyed by the hash of the SPIR-V.
+		UInt32 mCurrRun = 0;
+		bool   mbDirty = false;
 	};
 
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "Archive/MeshDataArchive.h"
 #include "Archive/MaterialAssetArchive.h"
 #include "Render/MeshGenerate/MeshGenerator.h"
+#include "Scene/Camera/ICamera.h"
 #include "Asset/Asset.h"
 #include "Profile/Profile.h"
 
@@ -27,6 +28,7 @@ namespace SG
 	{
 		string name;
 		bool   bDirty = true;
+		UInt32 treeNode = UInt32(-1); //! Node of the entity in the SceneHierarchy, managed by the scene. UInt32(-1) if the entity is not in the hierarchy.
 
 		TagComponent() = default;
 		explicit TagComponent(const char* n)
@@ -72,6 +74,8 @@ namespace SG
 		UInt32    meshId     = UInt32(-1); //! Used to reference mesh data.
 		UInt32    instanceId = 0;          //! Used to identify instance, if this mesh do not have instance, the default is 0. Because one object can be seen as one instance.
 		UInt32    objectId   = UInt32(-1); //! Used as UUID(or GUID) in Object System.
+		UInt32    objectGeneration = 0;    //! Generation of the objectId, a copy of this component kept after the object is destroyed fails Scene::IsObjectAlive().
+		UInt32    bvhProxyId = UInt32(-1); //! Proxy of this mesh in the mesh BVH of the scene, managed by the scene.
 
 		AABB aabb;
 
@@ -279,12 +283,16 @@ END(LightTag)
 	using Signature3 = TipECS::Signature<LightTag>;
 	using Signature4 = TipECS::Signature<TransformComponent, CameraComponent>;
 	using Signature5 = TipECS::Signature<TagComponent, TransformComponent, MeshComponent>;
+	using Signature6 = TipECS::Signature<TagComponent, TransformComponent, PointLightComponent>;
+	using Signature7 = TipECS::Signature<TagComponent, TransformComponent, DirectionalLightComponent>;
 
 #define SIGNATURES(F, END) \
 F(Signature1) \
 F(Signature3) \
 F(Signature4) \
 F(Signature5) \
+F(Signature6) \
+F(Signature7) \
 END(Signature2)
 
 #define MACRO_EXPAND(NAME) NAME,
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Core/Config.h"
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+#include "Math/MathBasic.h"
+#include "Math/BoundingBox.h"
+#include "Math/Frustum.h"
+
+#include "Stl/vector.h"
+
+namespace SG
+{
+
+	//! Dynamic bounding volume hierarchy over AABBs.
+	//! Each AABB is a leaf (a proxy) which carries a user data, the proxy id is stable until the proxy is removed.
+	//! The tree is built top-down with the surface area heuristic (SAH) by Rebuild(), the proxies inserted afterwards
+	//! go down to the sibling with the lowest SAH cost, and the ancestors are refitted and rotated to keep the tree tight.
+	//! The nodes are stored in one array and linked by indices.
+	class DynamicBVH
+	{
+	public:
+		using ProxyID = UInt32;
+
+		enum : UInt32
+		{
+			INVALID_PROXY = UInt32(-1),
+		};
+
+		SG_CORE_API DynamicBVH() = default;
+		~DynamicBVH() = default;
+
+		SG_CORE_API ProxyID CreateProxy(const AABB& aabb, UInt32 userData);
+		SG_CORE_API void    DestroyProxy(ProxyID proxy);
+		//! Update the bounds of a moved proxy. If the new bounds are still inside the bounds of its parent, the ancestors are refitted in place,
+		//! otherwise the proxy is reinserted at the best place.
+		SG_CORE_API void    MoveProxy(ProxyID proxy, const AABB& aabb);
+		SG_CORE_API void    Clear();
+
+		//! Rebuild the whole tree top-down with binned SAH, the proxy ids are kept.
+		//! It is cheaper and gives a better tree than inserting the proxies one by one when a lot of proxies are created at once.
+		SG_CORE_API void Rebuild();
+
+		//! Append the user data of the proxies overlapped with the aabb into outUserData.
+		SG_CORE_API void QueryAABB(const AABB& aabb, vector<UInt32>& outUserData) const;
+		//! Append the user data of the proxies intersected with the frustum into outUserData, the test is conservative as FrustumCullAABBs().
+		SG_CORE_API void QueryFrustum(const Frustum& frustum, vector<UInt32>& outUserData) const;
+		//! Append the user data of the proxies hit by the ray segment [origin, origin + direction * maxDistance] into outUserData.
+		SG_CORE_API void QueryRay(const Vector3f& origin, const Vector3f& direction, float maxDistance, vector<UInt32>& outUserData) const;
+		//! Find the nearest proxy hit by the ray, return false if nothing is hit.
+		//! The distance is measured to the entry point of the proxy bounds (0 if the origin is inside), in the unit of the direction.
+		SG_CORE_API bool RayCast(const Vector3f& origin, const Vector3f& direction, float maxDistance, UInt32& outUserData, float& outDistance) const;
+
+		SG_INLINE bool IsValid(ProxyID proxy) const { return proxy < mNodes.size() && mNodes[proxy].height == 0; }
+
+		SG_INLINE const AABB& GetAABB(ProxyID proxy) const { return mNodes[proxy].aabb; }
+		SG_INLINE UInt32 GetUserData(ProxyID proxy) const { return mNodes[proxy].userData; }
+
+		SG_INLINE UInt32 GetNumProxies() const { return mNumProxies; }
+		SG_INLINE bool   IsEmpty() const { return mRoot == INVALID_PROXY; }
+		//! The bounds of all the proxies, only valid if the tree is not empty.
+		SG_INLINE const AABB& GetRootAABB() const { return mNodes[mRoot].aabb; }
+		//! Height of the tree, a tree with only one leaf have height 0.
+		SG_INLINE Int32 GetHeight() const { return mRoot == INVALID_PROXY ? 0 : mNodes[mRoot].height; }
+
+		//! Sum of the surface area of the internal nodes divide by the area of the root, lower is better.
+		SG_CORE_API float GetAreaRatio() const;
+		//! Check the links, the heights and the bounds of all the nodes.
+		SG_CORE_API bool  Validate() const;
+	private:
+		struct Node
+		{
+			AABB   aabb;
+			UInt32 parent = INVALID_PROXY; //!< Next free node if this node is in the free list.
+			UInt32 child1 = INVALID_PROXY;
+			UInt32 child2 = INVALID_PROXY;
+			UInt32 userData = 0;
+			Int32  height = -1;            //!< 0 for the leaves, -1 for the free nodes.
+
+			SG_INLINE bool IsLeaf() const { return child1 == INVALID_PROXY; }
+		};
+
+		UInt32 AllocateNode();
+		void   FreeNode(UInt32 node);
+
+		void InsertLeaf(UInt32 leaf);
+		void RemoveLeaf(UInt32 leaf);
+		//! Refit the bounds and the heights from the node up to the root, and rotate the nodes on the way.
+		void RefitAncestors(UInt32 node);
+		//! Swap a child with a grandchild if it reduces the surface area of the children.
+		void Rotate(UInt32 node);
+
+		UInt32 BuildRange(UInt32* pLeaves, UInt32 count);
+
+		void CollectLeaves(UInt32 node, vector<UInt32>& outUserData) const;
+		bool ValidateNode(UInt32 node) const;
+	private:
+		vector<Node> mNodes;
+		UInt32 mRoot = INVALID_PROXY;
+		UInt32 mFreeList = INVALID_PROXY;
+		UInt32 mNumProxies = 0;
+	};
+
+}
@@ -4,20 +4,22 @@
 #include "Render/CommonRenderData.h"
 #include "Render/Buffer.h"
 #include "Math/BoundingBox.h"
+#include "Math/FrustumCulling.h"
+#include "Archive/AsyncResourceLoader.h"
 
 #include "Stl/vector.h"
 #include "Stl/SmartPtr.h"
-#include "eastl/unordered_map.h"
-#include "eastl/map.h"
+#include "EASTL/unordered_map.h"
+#include "EASTL/map.h"
 
 namespace SG
 {
 
 	struct RendererBuildData
 	{
-		UInt32 objectId = UInt32(-1); //! Object id to get the ObjcetRenderData.
+		UInt32 objectId = UInt32(-1); //! Object id to get the ObjcetRenderData, the object of the first instance.
 		UInt32 instanceCount = 1; //! Instance count of this draw call, used to decide whether this draw call should be instance draw.
-		vector<PerInstanceData> perInstanceData = {}; // Object ids of instance data.
+		vector<PerInstanceData> perInstanceData = {}; // Object ids of instance data, MeshComponent::instanceId is the index in it.
 
 		// binded texture assets
 		UInt32 materialTextureMask = 0;
@@ -38,8 +40,13 @@ namespace SG
 		RenderDataBuilder(WeakRefPtr<Scene> pScene);
 
 		void SetScene(WeakRefPtr<Scene> pScene);
+		//! Request the assets used by the scene. The texture data is streamed in by the AsyncResourceLoader,
+		//! the textures already in memory (e.g. the embedded ones) are new assets of this frame, the others are new assets of the frame they are loaded.
 		void LoadInNeccessaryDataFromDisk();
 		void ResolveRenderData();
+		//! Patch the render data with the mesh deltas published by the scene in this frame, should be called after Scene::OnUpdate().
+		//! The instance lists are patched by append and swap-remove, so a moved or a removed object costs O(1) instead of a rebuild.
+		void ApplySceneDeltas();
 
 		void OnUpdate(float deltaTime);
 
@@ -48,10 +55,61 @@ namespace SG
 
 		AABB GetSceneAABB() const noexcept { SG_ASSERT(mbIsRenderDataReady); return mSceneAABB; }
 
+		//! The bounds of a mesh merge the world bounds of all its instances. A moved instance is merged into the old bounds,
+		//! the bounds are recalculated here once they had been loosened by as many updates as the instances of the mesh.
+		void UpdateMeshBounds();
+		//! Cull the meshes against the frustum, meshVisibility[meshId] is 1 if the mesh (or any of its instances) may be visible.
+		//! Return the number of the visible meshes.
+		UInt32 CullMeshes(const Frustum& frustum, vector<UInt8>& meshVisibility) const;
+
 		template <typename Func>
 		void TraverseRenderData(Func&& func);
+		//! Return nullptr if no entity in the scene use this mesh.
+		const RendererBuildData* GetRenderData(UInt32 meshId) const;
+
+		//! Had the draw calls been added or removed since the last ClearDrawCallChanges(), i.e. a mesh is new to the scene or have no instance left,
+		//! or it changes between instanced and non-instanced.
+		bool IsDrawCallLayoutChanged() const noexcept { return mbDrawCallLayoutChanged; }
+		//! The meshes whose instance list had changed since the last ClearDrawCallChanges().
+		const vector<UInt32>& GetChangedInstanceMeshes() const noexcept { return mChangedInstanceMeshes; }
+		void ClearDrawCallChanges();
+
+		//! Upper bound of the object ids in the render data, i.e. the number of the objects the per object buffer should hold.
+		UInt32 GetObjectCapacity() const noexcept { return static_cast<UInt32>(mObjectSlots.size()); }
+		//! Call func(Scene::EntityContext& context) on each alive object whose render data need to be uploaded, and forget them.
+		template <typename Func>
+		void FlushDirtyObjects(Func&& func);
 	private:
+		enum EMeshFlag : UInt8
+		{
+			efInstanceChanged = 1 << 0,
+			efNeedRecalcBounds = 1 << 1,
+		};
+
+		struct ObjectSlot
+		{
+			Scene::EntityContext context = {}; //! The tree node is SceneHierarchy::INVALID_NODE if the object is not in the render data.
+			UInt32 generation = 0;
+			UInt32 meshId = UInt32(-1);
+			UInt32 instanceIndex = 0;
+			bool   bDirty = false;
+
+			bool IsInRenderData() const { return context.treeNode != SceneHierarchy::INVALID_NODE; }
+		};
+
+		void RequestTextureAsset(RefPtr<TextureAsset> pTextureAsset, ELoadPriority priority);
+		void RequestMaterialAssets(Scene::Entity& entity);
 		void LogDebugInfo() const;
+
+		void AddObject(const Scene::EntityContext& context);
+		void RemoveObject(const Scene& scene, UInt32 objectId, UInt32 generation);
+		void OnObjectModified(const Scene& scene, UInt32 objectId, UInt32 generation);
+
+		void MarkObjectDirty(UInt32 objectId);
+		void MarkMeshInstanceChanged(UInt32 meshId);
+		void MarkMeshNeedRecalcBounds(UInt32 meshId);
+		void ResizeMeshBounds(Size numMesh);
+		void RecalcMeshBounds(const Scene& scene, UInt32 meshId);
 	private:
 		WeakRefPtr<Scene> mpScene;
 		eastl::map<UInt32, RendererBuildData> mRenderMeshBuildDataMap; // meshId -> RenderMeshBuildData (ordered with meshId)
@@ -59,8 +117,18 @@ namespace SG
 		eastl::unordered_map<UInt32, WeakRefPtr<IAsset>> mAssets; // assetId -> IAsset
 
 		AABB mSceneAABB;
+		AABBSoA mMeshBounds; // meshId -> world bounds of all its instances
+		vector<AABB> mMeshAABBs; // meshId -> merged AABB
+		vector<UInt32> mMeshLooseUpdates; // meshId -> number of the updates merged into the bounds since the last recalculation
+		vector<UInt8> mMeshFlags; // meshId -> EMeshFlag
+		vector<UInt32> mRecalcBoundsMeshes;
+
+		vector<ObjectSlot> mObjectSlots; // objectId -> ObjectSlot
+		vector<UInt32> mDirtyObjects;
+		vector<UInt32> mChangedInstanceMeshes;
 
 		bool mbIsRenderDataReady = false;
+		bool mbDrawCallLayoutChanged = false;
 	};
 
 	template <typename Func>
@@ -78,4 +146,18 @@ namespace SG
 		}
 	}
 
+	template <typename Func>
+	void RenderDataBuilder::FlushDirtyObjects(Func&& func)
+	{
+		auto pScene = mpScene.lock();
+		for (auto objectId : mDirtyObjects)
+		{
+			auto& slot = mObjectSlots[objectId];
+			slot.bDirty = false;
+			if (slot.IsInRenderData() && pScene && pScene->IsObjectAlive(objectId, slot.generation))
+				func(slot.context);
+		}
+		mDirtyObjects.clear();
+	}
+
 }
\ No newline at end of file
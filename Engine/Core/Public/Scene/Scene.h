@@ -2,16 +2,19 @@
 
 #include "Archive/IDAllocator.h"
 #include "Archive/ISerializable.h"
+#include "Archive/SceneBinary.h"
 #include "Scene/Camera/ICamera.h"
 #include "Scene/Components.h"
+#include "Scene/SceneHierarchy.h"
+#include "Scene/DynamicBVH.h"
 
 #include "TipECS/EntityManager.h"
 
 #include "Stl/string.h"
 #include "Stl/vector.h"
 #include "Stl/unordered_map.h"
-#include "eastl/array.h"
-#include "eastl/list.h"
+#include "EASTL/array.h"
+#include "EASTL/list.h"
 #include "Stl/SmartPtr.h"
 
 namespace SG
@@ -21,34 +24,41 @@ namespace SG
 	// so, 10 point light is enough.
 #define SG_MAX_NUM_POINT_LIGHT 10
 
+	enum class EMeshDeltaType
+	{
+		eAdded = 0,
+		eRemoved,
+		eModified, //!< The world transform or the material of the mesh entity had changed.
+	};
+
 	class Scene final : public ISerializable
 	{
 	public:
 		using EntityManager = typename TipECS::EntityManager<SGECSSetting>;
 		using Entity = typename TipECS::Entity<SGECSSetting>;
 
-		struct SceneTreeNode
-		{
-			Entity* pEntity = nullptr;
-			SceneTreeNode* pParent = nullptr;
-			eastl::vector<SceneTreeNode*> pChilds;
-
-			SceneTreeNode() = default;
-			SceneTreeNode(Entity* ptr)
-				:pEntity(ptr), pParent(nullptr)
-			{}
-			~SceneTreeNode() = default;
-		};
-
-		using TreeNode = SceneTreeNode;
+		using NodeID = SceneHierarchy::NodeID;
 
 		struct EntityContext
 		{
-			Entity    entity = {};
-			TreeNode* pTreeNode = nullptr;
+			Entity entity = {};
+			NodeID treeNode = SceneHierarchy::INVALID_NODE;
 		};
 
 		using EntityContext = EntityContext;
+
+		//! A change of a mesh entity, emitted by the hooks of the MeshComponent.
+		//! The meshId is only meaningful for eRemoved, for the others read the MeshComponent of the entity.
+		//! The treeNode is SceneHierarchy::INVALID_NODE if the entity is not in the hierarchy (e.g. the skybox).
+		struct MeshDelta
+		{
+			EMeshDeltaType type = EMeshDeltaType::eModified;
+			Entity entity = {};
+			NodeID treeNode = SceneHierarchy::INVALID_NODE;
+			UInt32 objectId = UInt32(-1);
+			UInt32 objectGeneration = 0;
+			UInt32 meshId = UInt32(-1);
+		};
 	public:
 		Scene();
 		~Scene();
@@ -64,9 +74,13 @@ namespace SG
 
 		SG_CORE_API Entity* CreateEntityWithMesh(const string& name, const string& filename, EMeshType type, ELoadMeshFlag flag = ELoadMeshFlag(0));
 
+		//! Destroy the entity and all its descendants.
 		SG_CORE_API void    DestroyEntity(Entity& entity);
 		SG_CORE_API void    DestroyEntityByName(const string& name);
 
+		//! Move the entity (with its descendants) to be a child of the parent. Use an empty parent name to move it to the root.
+		SG_CORE_API bool    SetParent(const string& name, const string& parentName);
+
 		SG_CORE_API EntityContext* GetEntityContextByName(const string& name);
 		SG_CORE_API Entity* GetEntityByName(const string& name);
 
@@ -77,7 +91,32 @@ namespace SG
 		SG_CORE_API Size GetMeshEntityCount() const { return mMeshEntityCount; }
 		SG_CORE_API Size GetEntityCount()     const { return mEntityContexts.size(); }
 
-		SG_CORE_API TreeNode* GetTreeRepresentation() const { return mpRootNode; };
+		SG_CORE_API const SceneHierarchy& GetTreeRepresentation() const { return mHierarchy; };
+
+		//! Get the world transform of the tree node, it is cached and updated once per frame in OnUpdate().
+		const Matrix4f& GetWorldTransform(NodeID treeNode) const { return mHierarchy.GetWorldTransform(treeNode); }
+
+		//! BVH over the world AABBs of the mesh entities, the user data of the proxies are the tree nodes of the entities.
+		//! It is updated once per frame in OnUpdate().
+		SG_CORE_API const DynamicBVH& GetMeshBVH() const { return mMeshBVH; }
+		//! Find the nearest mesh entity whose AABB is hit by the ray, return nullptr if nothing is hit.
+		SG_CORE_API Entity* RayCastMeshEntity(const Vector3f& origin, const Vector3f& direction, float maxDistance = SG_MAX_FLOAT_VALUE);
+		//! Append the tree nodes of the mesh entities intersected with the frustum.
+		SG_CORE_API void    QueryMeshEntities(const Frustum& frustum, vector<NodeID>& outTreeNodes) const;
+
+		//! Is the object id (MeshComponent::objectId) still owned by the same mesh, it is false once the mesh component is removed
+		//! even if the id is reused by another mesh.
+		SG_CORE_API bool IsObjectAlive(UInt32 objectId, UInt32 objectGeneration) const;
+		SG_CORE_API bool IsObjectAlive(const MeshComponent& mesh) const { return IsObjectAlive(mesh.objectId, mesh.objectGeneration); }
+
+		//! The changes of the mesh entities since the last OnUpdate(), in the order they happened.
+		//! The same object may appear several times, and the entity of a delta may had been destroyed afterwards,
+		//! so the consumers should check IsObjectAlive() before touching the entity.
+		const vector<MeshDelta>& GetMeshDeltas() const { return mMeshDeltas; }
+
+		//! Save and load the scene in the binary format (see Archive/SceneBinary.h), which can be loaded without parsing.
+		SG_CORE_API void SerializeBinary(vector<Byte>& outData);
+		SG_CORE_API bool DeserializeBinary(const Byte* pData, Size sizeInByte);
 
 		template <typename... Ts>
 		SG_INLINE auto View()
@@ -88,19 +127,27 @@ namespace SG
 		template <typename Func>
 		SG_INLINE void TraverseEntity(Func&& func)
 		{
-			for (auto node : mEntityContexts)
-				func(node.second.entity);
+			mHierarchy.Traverse([&func](NodeID, Entity& entity) { func(entity); });
+		}
+
+		//! Walk the component columns of the entities match the signature, func is called with the components of the signature.
+		template <typename TSignature, typename Func>
+		SG_INLINE void TraverseEntityMatchSignature(Func&& func)
+		{
+			mEntityManager.TraverseEntityMatchSignature<TSignature>(func);
 		}
 
 		template <typename Func>
 		SG_INLINE void TraverseEntityContext(Func&& func)
 		{
-			for (auto node : mEntityContexts)
+			for (auto& node : mEntityContexts)
 				func(node.second);
 		}
 	private:
 		// entity creation and destruction
 		EntityContext* CreateEntityContextWithoutTreeNode(const string& name);
+		//! Put the entity into the hierarchy, the tree node is also kept in its TagComponent so that the passes over the components do not look it up by name.
+		NodeID AddTreeNode(EntityContext& context, NodeID parentNode = SceneHierarchy::ROOT_NODE);
 
 		EntityContext* CreateEntityContext(const string& name);
 		EntityContext* CreateEntityContext(const string& name, const Vector3f& pos, const Vector3f& scale, const Vector3f& rot);
@@ -111,40 +158,29 @@ namespace SG
 		void MaterialScene();
 		void MaterialTexturedScene();
 
+		void UpdateWorldTransforms();
 		void UpdateMeshAABB();
 
 		virtual void Serialize(json& node) override;
 		virtual void Deserialize(json& node) override;
-		void SerializeEntity(Scene::TreeNode* pTreeNode, json& node);
-		void DeserializeEntity(Scene::TreeNode* pTreeNode, json& entity);
+		void SerializeEntity(NodeID treeNode, json& node);
+		NodeID DeserializeEntity(const SceneBinaryView& view, const SceneBinaryEntity& entity, NodeID parentNode);
 
 		void Refresh();
-
-		void ClearTreeNodes();
-		void FreeTreeNode(TreeNode* pTreeNode);
 	private:
 		Entity  mSkyboxEntity;
 		Entity* mpCameraEntity;  // TODO: support multiply switchable camera
 
 		Size mMeshEntityCount = 0;
+		vector<MeshDelta> mMeshDeltas; //! The mesh deltas published in the last OnUpdate().
 		unordered_map<string, EntityContext> mEntityContexts; //! Contain all the entities' contexts in the scene. name -> EntityContext
 
 		//! Tree representation of the scene.
-		TreeNode* mpRootNode;
+		SceneHierarchy mHierarchy;
+		//! Spatial representation of the mesh entities.
+		DynamicBVH     mMeshBVH;
 
 		EntityManager mEntityManager;
 	};
 
-	// helper functions
-
-	static Matrix4f GetTransform(Scene::TreeNode* pTreeNode)
-	{
-		if (!pTreeNode->pParent->pEntity)
-			return GetTransform(pTreeNode->pEntity->GetComponent<TransformComponent>());
-		
-		if (pTreeNode->pParent)
-			return GetTransform(pTreeNode->pParent) * GetTransform(pTreeNode->pEntity->GetComponent<TransformComponent>());
-		return Matrix4f(1.0f);
-	}
-
 }
\ No newline at end of file
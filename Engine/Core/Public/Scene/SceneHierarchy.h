@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Core/Config.h"
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+#include "Math/MathBasic.h"
+
+#include "Scene/Components.h"
+#include "TipECS/EntityManager.h"
+
+#include "Stl/vector.h"
+
+namespace SG
+{
+
+	//! Flat scene hierarchy.
+	//! All the nodes are stored in arrays (structure of arrays), and a parent is always stored before its children,
+	//! so the world transforms can be updated in one linear pass through memory.
+	//! The node 0 is the root node, it have no entity and its world transform is always identity.
+	//! Nodes are referenced by NodeID, which will not change when the nodes are moved in the arrays.
+	class SceneHierarchy
+	{
+	public:
+		using Entity = TipECS::Entity<SGECSSetting>;
+		using NodeID = UInt32;
+
+		enum : UInt32
+		{
+			ROOT_NODE = 0,
+			INVALID_NODE = UInt32(-1),
+		};
+
+		SG_CORE_API SceneHierarchy();
+		~SceneHierarchy() = default;
+
+		//! Add a node as the last child of the parent.
+		SG_CORE_API NodeID AddNode(Entity* pEntity, NodeID parent = ROOT_NODE);
+		//! Remove the node and all its descendants, the entities of the removed nodes will be returned in pRemovedEntities.
+		SG_CORE_API void   RemoveNode(NodeID node, eastl::vector<Entity*>* pRemovedEntities = nullptr);
+		//! Move the node and its descendants to be the last child of the new parent.
+		//! Return false if the new parent is the node itself or one of its descendants.
+		SG_CORE_API bool   Reparent(NodeID node, NodeID newParent);
+		SG_CORE_API void   Clear();
+
+		//! Rebuild the arrays in depth-first order, and drop the removed nodes.
+		SG_CORE_API void   Compact();
+
+		SG_INLINE bool IsValid(NodeID node) const { return node < mIdToIndex.size() && mIdToIndex[node] != INVALID_NODE; }
+
+		SG_INLINE Entity* GetEntity(NodeID node) const { return mEntities[mIdToIndex[node]]; }
+		SG_INLINE NodeID  GetParent(NodeID node) const { return ToNodeID(mParents[mIdToIndex[node]]); }
+		SG_INLINE NodeID  GetFirstChild(NodeID node) const { return ToNodeID(mFirstChilds[mIdToIndex[node]]); }
+		SG_INLINE NodeID  GetNextSibling(NodeID node) const { return ToNodeID(mNextSiblings[mIdToIndex[node]]); }
+		SG_INLINE bool    HasChild(NodeID node) const { return mFirstChilds[mIdToIndex[node]] != INVALID_NODE; }
+
+		SG_INLINE const Matrix4f& GetLocalTransform(NodeID node) const { return mLocalTransforms[mIdToIndex[node]]; }
+		SG_INLINE const Matrix4f& GetWorldTransform(NodeID node) const { return mWorldTransforms[mIdToIndex[node]]; }
+
+		//! Number of the nodes in the hierarchy, the root node is not included.
+		SG_INLINE UInt32 GetNodeCount() const { return (UInt32)mEntities.size() - mNumRemovedSlots - 1; }
+
+		//! func(NodeID child)
+		template <typename Func>
+		void TraverseChildren(NodeID node, Func&& func) const;
+
+		//! Linearly traverse all the nodes except the root, a parent is always visited before its children.
+		//! func(NodeID node, Entity& entity)
+		template <typename Func>
+		void Traverse(Func&& func);
+
+		//! Update all the world transforms in one pass.
+		//! bool func(Entity& entity, Matrix4f& localTransform, bool bForceUpdate)
+		//! The func should update the local transform if needed, and return true if the local transform had changed.
+		//! bForceUpdate is true when the node is new, reparented or one of its ancestors had changed.
+		template <typename Func>
+		void UpdateWorldTransforms(Func&& func);
+	private:
+		SG_INLINE NodeID ToNodeID(UInt32 index) const { return index == INVALID_NODE ? INVALID_NODE : mIndexToId[index]; }
+
+		void LinkAsLastChild(UInt32 index, UInt32 parentIndex);
+		void Unlink(UInt32 index);
+	private:
+		// per node data, indexed by the index in the arrays
+		eastl::vector<Entity*>  mEntities;
+		eastl::vector<UInt32>   mParents;
+		eastl::vector<UInt32>   mFirstChilds;
+		eastl::vector<UInt32>   mLastChilds;
+		eastl::vector<UInt32>   mNextSiblings;
+		eastl::vector<Matrix4f> mLocalTransforms;
+		eastl::vector<Matrix4f> mWorldTransforms;
+		eastl::vector<UInt8>    mForceUpdateFlags;
+		eastl::vector<UInt8>    mChangedFlags;  //!< Had the world transform changed in this update.
+		eastl::vector<NodeID>   mIndexToId;     //!< INVALID_NODE if the node had been removed.
+
+		eastl::vector<UInt32>   mIdToIndex;     //!< Indexed by NodeID.
+		eastl::vector<NodeID>   mFreeIds;
+
+		UInt32 mNumRemovedSlots = 0;
+		bool   mbNeedCompact = false;
+	};
+
+	template <typename Func>
+	void SceneHierarchy::TraverseChildren(NodeID node, Func&& func) const
+	{
+		for (UInt32 child = mFirstChilds[mIdToIndex[node]]; child != INVALID_NODE; child = mNextSiblings[child])
+			func(mIndexToId[child]);
+	}
+
+	template <typename Func>
+	void SceneHierarchy::Traverse(Func&& func)
+	{
+		if (mbNeedCompact)
+			Compact();
+
+		for (UInt32 i = 1; i < mEntities.size(); ++i)
+		{
+			if (mIndexToId[i] != INVALID_NODE)
+				func(mIndexToId[i], *mEntities[i]);
+		}
+	}
+
+	template <typename Func>
+	void SceneHierarchy::UpdateWorldTransforms(Func&& func)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (mbNeedCompact)
+			Compact();
+
+		mChangedFlags[ROOT_NODE] = 0;
+		for (UInt32 i = 1; i < mEntities.size(); ++i)
+		{
+			if (mIndexToId[i] == INVALID_NODE) // removed node, wait for compaction
+				continue;
+
+			const UInt32 parent = mParents[i];
+			const bool bForceUpdate = mForceUpdateFlags[i] || mChangedFlags[parent];
+			const bool bChanged = func(*mEntities[i], mLocalTransforms[i], bForceUpdate) || bForceUpdate;
+			if (bChanged)
+				mWorldTransforms[i] = mWorldTransforms[parent] * mLocalTransforms[i];
+			mChangedFlags[i] = bChanged ? 1 : 0;
+			mForceUpdateFlags[i] = 0;
+		}
+	}
+
+}
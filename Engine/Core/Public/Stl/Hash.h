@@ -3,7 +3,7 @@
 #include "Base/BasicTypes.h"
 #include "Defs/Defs.h"
 
-#include <eastl/functional.h>
+#include <EASTL/functional.h>
 
 namespace SG
 {
@@ -13,7 +13,7 @@ namespace SG
 	void HashTypes(Size& seed, const T& value, const Ts&... otherValues)
 	{
 		seed ^= eastl::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-		(HashTypes(seed, otherValue), ...); // expand the rest types
+		(HashTypes(seed, otherValues), ...); // expand the rest types
 	}
 
 	// FNV-1 hash for memory
@@ -29,6 +29,19 @@ namespace SG
 		return hash;
 	}
 
+	// FNV-1 hash for a block of memory
+	SG_INLINE UInt64 HashMemory(const void* pData, Size sizeInByte, UInt64 prevHash = 14695981039346656037u)
+	{
+		UInt64 hash = prevHash;
+		auto* perByteAddr = reinterpret_cast<const UInt8*>(pData);
+		for (Size i = 0; i < sizeInByte; ++i) // for each byte
+		{
+			hash = hash * 1099511628211u;
+			hash = hash ^ *(perByteAddr + i);
+		}
+		return hash;
+	}
+
 	SG_INLINE UInt64 HashMemory32(const UInt32* address, UInt64 prevHash = 2166136261u)
 	{
 		UInt64 hash = prevHash;
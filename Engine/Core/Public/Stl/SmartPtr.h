@@ -1,8 +1,8 @@
 #pragma once
 
-#include "eastl/unique_ptr.h"
-#include "eastl/shared_ptr.h"
-#include "eastl/weak_ptr.h"
+#include "EASTL/unique_ptr.h"
+#include "EASTL/shared_ptr.h"
+#include "EASTL/weak_ptr.h"
 
 namespace SG
 {
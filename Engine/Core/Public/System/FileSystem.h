@@ -4,8 +4,8 @@
 #include "Base/BasicTypes.h"
 #include "Base/TimePoint.h"
 
-#include "stl/string.h"
-#include "eastl/variant.h"
+#include "Stl/string.h"
+#include "EASTL/variant.h"
 
 namespace SG
 {
@@ -104,7 +104,9 @@ namespace SG
 
 		SG_CORE_API static bool Open(const EResourceDirectory directory, const char* filename, const EFileMode filemode, Size rootFolderOffset = 0);
 		SG_CORE_API static bool Close();
+		//! Return the number of the bytes read, it is less than bufSizeInByte if the file ends or an error occurs.
 		SG_CORE_API static Size Read(void* pInBuf, Size bufSizeInByte);
+		//! Return the number of the bytes written.
 		SG_CORE_API static Size Write(const void* const pOutBuf, Size bufSizeInByte);
 		SG_CORE_API static bool Seek(EFileBaseOffset baseOffset, Size offset);
 		SG_CORE_API static Size Tell();
@@ -140,12 +142,15 @@ namespace SG
 		SG_CORE_API static bool CreateFolder(const EResourceDirectory directory, const char* folderName, Size rootFolderOffset);
 	private:
 		friend class System;
+		friend class FileSystemTestScope; //!< The unit tests set up the stream ops.
 
 		static void OnInit();
 		static void OnShutdown();
 	private:
 #ifdef SG_PLATFORM_WINDOWS
 		friend struct WindowsStreamOp;
+#elif SG_PLATFORM_LINUX
+		friend struct LinuxStreamOp;
 #endif
 		// implementation of stream operations
 		static IStreamOps* mpStreamOp;
@@ -3,16 +3,18 @@
 #include "Core/Config.h"
 #include "Base/BasicTypes.h"
 
-#ifndef WIN32_LEAN_AND_MEAN
-#	define WIN32_LEAN_AND_MEAN
-#	include <windows.h>
+#ifdef SG_PLATFORM_WINDOWS
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#		include <windows.h>
+#	endif
 #endif
 
 #include "Stl/vector.h"
-#include <eastl/vector_multiset.h>
-#include <eastl/utility.h>
-#include <eastl/array.h>
-#include <eastl/map.h>
+#include <EASTL/vector_multiset.h>
+#include <EASTL/utility.h>
+#include <EASTL/array.h>
+#include <EASTL/map.h>
 
 #include "Math/MathBasic.h"
 
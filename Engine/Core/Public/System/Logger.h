@@ -6,8 +6,8 @@
 
 #include "Core/Private/Logger/Formatter.h"
 
-#include "eastl/string.h"
-#include "eastl/string_view.h"
+#include "EASTL/string.h"
+#include "EASTL/string_view.h"
 
 namespace SG
 {
@@ -18,6 +18,7 @@ namespace SG
 		eLog_Mode_No_File,       //! Do not log out as file.
 		eLog_Mode_Quite,         //! Only log out the warn, error and critical message.
 		eLog_Mode_Quite_No_File,
+		eLog_Mode_Silent,        //! Log out nothing, for the tests feeding bad data on purpose.
 	};
 
 	enum class ELogLevel : UInt32
@@ -44,6 +45,7 @@ namespace SG
 		SG_CORE_API static void FlushToDisk();
 
 		static void SetLogMode(ELogMode logMode) { mLogMode = logMode; }
+		static ELogMode GetLogMode() { return mLogMode; }
 	private:
 		friend class System;
 
@@ -106,7 +108,7 @@ namespace impl
 	template<class T>
 	static eastl::string PrintMathTypes(const T& types, const string& prefix)
 	{
-		SG_COMPILE_ASSERT(false, "Please log out a math type!");
+		SG_COMPILE_ASSERT(sizeof(T) == 0, "Please log out a math type!"); // dependent false, only fire when it is instantiated
 		return eastl::string();
 	}
 
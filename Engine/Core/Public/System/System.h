@@ -14,7 +14,7 @@
 
 #include "Stl/string.h"
 #include "Stl/SmartPtr.h"
-#include <eastl/set.h>
+#include <EASTL/set.h>
 
 #ifdef SG_PLATFORM_WINDOWS
 #	ifndef WIN32_LEAN_AND_MEAN
@@ -74,7 +74,10 @@ namespace SG
 
 		SG_CORE_API void SetRootPath(const string& path);
 
-		SG_CORE_API int  RunProcess(const string& command, const char* pOut);
+		//! Run the command in a new process and wait for it to exit, its stdout and stderr are written to the file pOut if it is not null.
+		//! Processes can be run on different threads at the same time.
+		//! @return The exit code of the process, or -1 if the process can not be run.
+		SG_CORE_API static int RunProcess(const string& command, const char* pOut);
 
 		SG_CORE_API void RegisterSystemMessageListener(ISystemMessageListener* pListener);
 		SG_CORE_API void RemoveSystemMessageListener(ISystemMessageListener* pListener);
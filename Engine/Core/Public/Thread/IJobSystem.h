@@ -1,22 +1,62 @@
 #pragma once
 
+#include "Core/Config.h"
 #include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
 #include "Thread/Thread.h"
 
 namespace SG
 {
 
-	//! A handle to a job, be used to establish dependency,
-	//! do synchronization and job data deletion.
-	struct SJobHandle
+	namespace Impl
+	{
+		struct JobCounter;
+		struct JobDesc;
+
+		typedef void (*JobEntryFunc)(const JobDesc& desc);
+
+		//! Internal description of a job. All the user data is passed by pointer,
+		//! so it must be kept alive until the job is completed.
+		struct JobDesc
+		{
+			JobEntryFunc pEntry;
+			void*        pUser0;
+			void*        pUser1;
+			void*        pUser2;
+			UInt32       begin;
+			UInt32       end;
+		};
+	}
+
+	enum class EJobState
 	{
-		void Complete();
-		void Dispose();
+		eInvalid = 0, //!< The handle is not referring to any job.
+		ePending,     //!< Some of the jobs is waiting for its dependency or is running.
+		eCompleted,   //!< All the jobs of this handle are done.
 	};
 
 	struct SJobStatus
 	{
-		
+		EJobState state = EJobState::eInvalid;
+		UInt32    numPendingJobs = 0;
+	};
+
+	//! A handle to a job, be used to establish dependency,
+	//! do synchronization and job data deletion.
+	//! A default constructed handle is treated as a completed job.
+	struct SJobHandle
+	{
+		Impl::JobCounter* pCounter = nullptr;
+
+		//! Wait until all the jobs of this handle are done.
+		//! The calling thread will help to execute the pending jobs while waiting.
+		SG_CORE_API void Complete();
+		//! Release the job data of this handle. The handle can not be used as a dependency after disposed.
+		//! It is safe to dispose a handle whose jobs are still running.
+		SG_CORE_API void Dispose();
+
+		SG_CORE_API bool       IsCompleted() const;
+		SG_CORE_API SJobStatus GetStatus() const;
 	};
 
 	/// maybe we want a decorator to be a simple wrapper to IJob
@@ -29,4 +69,78 @@ namespace SG
 		virtual void Execute(const InData& inData, OutData& outData) = 0;
 	};
 
-}
\ No newline at end of file
+	typedef void (*JobFunc)(void* pUser);
+	typedef void (*ParallelForFunc)(UInt32 begin, UInt32 end, void* pUser);
+
+	//! Task based work-stealing job system.
+	//! Every worker thread owns a deque, the owner push and pop jobs at the back of the deque,
+	//! the idle workers steal jobs from the front of the other deques.
+	//! The main thread owns a deque too, and it can only execute jobs when waiting on a handle.
+	class JobSystem
+	{
+	public:
+		//! Schedule a single job. The job will not be executed until the dependency is completed.
+		SG_CORE_API static SJobHandle Schedule(JobFunc func, void* pUser, SJobHandle dependency = {});
+
+		template <class InData, class OutData>
+		static SJobHandle Schedule(IJob<InData, OutData>& job, const InData& inData, OutData& outData, SJobHandle dependency = {});
+
+		//! Split [0, count) into batches with batchSize elements, and dispatch all the batches into the workers.
+		SG_CORE_API static SJobHandle ParallelFor(UInt32 count, UInt32 batchSize, ParallelForFunc func, void* pUser, SJobHandle dependency = {});
+
+		//! Call func(index) for every index in [0, count).
+		//! The func is referenced by the jobs, the caller must wait on the handle before func is out of scope.
+		template <class Func>
+		static SJobHandle ParallelFor(UInt32 count, UInt32 batchSize, Func& func, SJobHandle dependency = {});
+
+		//! Schedule a group of jobs sharing one handle.
+		SG_CORE_API static SJobHandle Submit(const Impl::JobDesc* pDescs, UInt32 numDescs, SJobHandle dependency = {});
+
+		//! Wait on the handle and dispose it.
+		SG_INLINE static void CompleteAndDispose(SJobHandle& handle) { handle.Complete(); handle.Dispose(); }
+
+		//! Get the number of worker threads, the main thread is not included.
+		SG_CORE_API static UInt32 GetNumWorkers();
+		//! Get the index of the calling thread in [0, GetNumWorkers()], 0 for the main thread and the threads not owned by the job system.
+		//! Use it to index the per thread data of the jobs.
+		SG_CORE_API static UInt32 GetCurrThreadIndex();
+	private:
+		friend class System;
+		friend struct SJobHandle;
+		friend class JobSystemTestScope; //!< The unit tests start and stop the workers.
+
+		//! If numWorkers is 0, use (number of cores - 1) workers.
+		static void OnInit(UInt32 numWorkers = 0);
+		static void OnShutdown();
+
+		//! Try to execute one job on the calling thread.
+		static bool ExecuteOneJob();
+	};
+
+	template <class InData, class OutData>
+	SJobHandle JobSystem::Schedule(IJob<InData, OutData>& job, const InData& inData, OutData& outData, SJobHandle dependency)
+	{
+		Impl::JobDesc desc = {};
+		desc.pEntry = [](const Impl::JobDesc& d)
+		{
+			auto* pJob = reinterpret_cast<IJob<InData, OutData>*>(d.pUser0);
+			pJob->Execute(*reinterpret_cast<const InData*>(d.pUser1), *reinterpret_cast<OutData*>(d.pUser2));
+		};
+		desc.pUser0 = &job;
+		desc.pUser1 = const_cast<InData*>(&inData);
+		desc.pUser2 = &outData;
+		return Submit(&desc, 1, dependency);
+	}
+
+	template <class Func>
+	SJobHandle JobSystem::ParallelFor(UInt32 count, UInt32 batchSize, Func& func, SJobHandle dependency)
+	{
+		return ParallelFor(count, batchSize, [](UInt32 begin, UInt32 end, void* pUser)
+		{
+			Func& f = *reinterpret_cast<Func*>(pUser);
+			for (UInt32 i = begin; i < end; ++i)
+				f(i);
+		}, const_cast<void*>(reinterpret_cast<const void*>(&func)), dependency);
+	}
+
+}
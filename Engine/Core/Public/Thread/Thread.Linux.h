@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Core/Config.h"
+
+#include <atomic>
+
+namespace SG
+{
+
+	//! Mutex implemented by futex.
+	//! mState: 0 means unlocked, 1 means locked, 2 means locked and there may be some waiters.
+	//! It is recursive like the CriticalSection on windows, the owner thread can lock it again
+	//! and it is released after the same number of UnLock().
+	class SG_CORE_API Mutex
+	{
+	public:
+		Mutex();
+		~Mutex();
+		SG_CLASS_NO_COPY_ASSIGNABLE(Mutex);
+
+		void Lock();
+		bool TryLock();
+		void UnLock();
+	private:
+		friend class ConditionVariable;
+
+		//! Acquire the futex, the caller is not the owner.
+		void LockSlow();
+	private:
+		std::atomic<int>    mState;
+		std::atomic<UInt32> mOwner;      //!< Thread id of the owner, 0 if no one own it.
+		UInt32              mRecursion;  //!< Only touched by the owner.
+	};
+
+	//! Condition variable implemented by futex, the waiters sleep on a sequence number
+	//! which will be increased on every notification.
+	class SG_CORE_API ConditionVariable
+	{
+	public:
+		ConditionVariable() = default;
+		SG_CLASS_NO_COPY_ASSIGNABLE(ConditionVariable);
+
+		enum { SG_MAX_WAIT_TIME = 0xffffffffu };
+
+		//! Return false if timeout.
+		bool Wait(const Mutex& mutex, UInt32 ms = SG_MAX_WAIT_TIME);
+
+		void NotifyOne();
+		void NotifyAll();
+	private:
+		std::atomic<int> mSequence = { 0 };
+	};
+
+	class SG_CORE_API Atomic16
+	{
+	public:
+		Atomic16()
+			: mCount(0)
+		{}
+		~Atomic16() = default;
+
+		Int16 Increase() volatile;
+		Int16 Decrease() volatile;
+		Int16 Add(Int16 num) volatile;
+		Int16 Exchange(Int16 num) volatile;
+		Int16 Or(Int16 num) volatile;
+		Int16 And(Int16 num) volatile;
+
+		operator Int16() { return __atomic_load_n(&mCount, __ATOMIC_ACQUIRE); }
+	private:
+		volatile Int16 mCount;
+	};
+
+	class SG_CORE_API Atomic32
+	{
+	public:
+		Atomic32()
+			:mCount(0)
+		{}
+		~Atomic32() = default;
+
+		long Increase() volatile;
+		long Decrease() volatile;
+		long Add(long num) volatile;
+		long Exchange(long num) volatile;
+		long Or(long num) volatile;
+		long And(long num) volatile;
+
+		operator int() { return __atomic_load_n(&mCount, __ATOMIC_ACQUIRE); }
+	private:
+		volatile int mCount;
+ 	};
+
+	class SG_CORE_API Atomic64
+	{
+	public:
+		Atomic64()
+			:mCount(0)
+		{}
+		~Atomic64() = default;
+
+		Int64 Increase() volatile;
+		Int64 Decrease() volatile;
+		Int64 Add(Int64 num) volatile;
+		Int64 Exchange(Int64 num) volatile;
+		Int64 Or(Int64 num) volatile;
+		Int64 And(Int64 num) volatile;
+
+		operator Int64() { return __atomic_load_n(&mCount, __ATOMIC_ACQUIRE); }
+	private:
+		volatile Int64 mCount;
+	};
+
+	class SG_CORE_API Semaphore
+	{
+	public:
+		Semaphore(int maximunCnt, int initCnt = 0);
+		~Semaphore();
+
+		void Acquire();
+		void Release();
+	private:
+		//! Futex based semaphore, only touched when some threads have to wait.
+		struct SG_CORE_API InternalSemaphore
+		{
+			InternalSemaphore(int maximunCnt, int initCnt = 0);
+			~InternalSemaphore();
+
+			void Acquire();
+			void Release();
+
+			std::atomic<int> mValue;
+		};
+	private:
+		InternalSemaphore mSemaphore;
+		Atomic32 mCount;
+	};
+
+	class SG_CORE_API SpinLock
+	{
+	public:
+		SpinLock() = default;
+		~SpinLock() = default;
+		SG_CLASS_NO_COPY_ASSIGNABLE(SpinLock);
+
+		SG_INLINE void Lock()
+		{
+			while (mFlag.test_and_set(std::memory_order_acquire))
+			{
+#if defined(SG_PLATFORM_X64)
+				__builtin_ia32_pause();
+#endif
+			}
+		}
+		SG_INLINE void UnLock()
+		{
+			mFlag.clear(std::memory_order_release);
+		}
+	private:
+		std::atomic_flag mFlag = ATOMIC_FLAG_INIT;
+	};
+
+}
@@ -18,6 +18,7 @@ namespace SG
 		ThreadHandle  pHandle;
 		ThreadFunc    pFunc;
 		void*         pUser;
+		ThreadID      id;      //!< The same id GetCurrThreadID() returns in the thread, use GetThreadID() to read it.
 	} Thread;
 
 	SG_CORE_API bool        ThreadCreate(Thread* pThread, ThreadFunc func, void* pUser);
@@ -26,9 +27,14 @@ namespace SG
 	SG_CORE_API void        ThreadSuspend(Thread* pThread);
 	SG_CORE_API void        ThreadJoin(Thread* pThread);
 
+	//! Bind the thread to a logical core, return false if failed.
+	SG_CORE_API bool        ThreadSetAffinity(Thread* pThread, UInt32 coreIndex);
+	SG_CORE_API bool        SetCurrThreadAffinity(UInt32 coreIndex);
+
 	SG_CORE_API UInt32      GetNumCPUCores();
 	SG_CORE_API void        ThreadSleep(UInt32 ms); 	//!< Thread sleep in milliseconds.
 
+	//! The id of a created thread, it is the one GetCurrThreadID() returns in that thread.
 	SG_CORE_API UInt32      GetThreadID(Thread* pThread);
 	SG_CORE_API UInt32      GetCurrThreadID();
 
@@ -50,4 +56,6 @@ namespace SG
 
 #ifdef SG_PLATFORM_WINDOWS
 #	include "Thread/Thread.Windows.h"
+#elif SG_PLATFORM_LINUX
+#	include "Thread/Thread.Linux.h"
 #endif
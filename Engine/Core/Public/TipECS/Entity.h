@@ -55,49 +55,55 @@ namespace TipECS
 		template <typename TComponent>
 		inline bool HasComponent() const noexcept
 		{
-			return pManager->HasComponent<TComponent>(*this);
+			return pManager->template HasComponent<TComponent>(*this);
 		}
 
 		template <typename TComponent>
 		inline auto& AddComponent() noexcept
 		{
-			return pManager->AddComponent<TComponent>(*this);
+			return pManager->template AddComponent<TComponent>(*this);
 		}
 
 		template <typename TComponent, typename... Args>
 		inline auto& AddComponent(Args&&... args) noexcept
 		{
-			return pManager->AddComponent<TComponent>(*this, FWD(args)...);
+			return pManager->template AddComponent<TComponent>(*this, FWD(args)...);
 		}
 
 		template <typename TComponent>
 		inline void RemoveComponent() noexcept
 		{
-			pManager->RemoveComponent<TComponent>(*this);
+			pManager->template RemoveComponent<TComponent>(*this);
+		}
+
+		template <typename TComponent>
+		inline void NotifyModified() noexcept
+		{
+			pManager->template NotifyComponentModified<TComponent>(*this);
 		}
 
 		template <typename... Ts>
 		inline decltype(auto) GetComponent() noexcept
 		{
-			return pManager->GetComponent<Ts...>(*this);
+			return pManager->template GetComponent<Ts...>(*this);
 		}
 
 		template <typename TTag>
 		bool HasTag() const noexcept
 		{
-			return pManager->HasTag<TTag>(*this);
+			return pManager->template HasTag<TTag>(*this);
 		}
 
 		template <typename TTag>
 		void AddTag() noexcept
 		{
-			pManager->AddTag<TTag>(*this);
+			pManager->template AddTag<TTag>(*this);
 		}
 
 		template <typename TTag>
 		void RemoveTag() noexcept
 		{
-			pManager->RemoveTag<TTag>(*this);
+			pManager->template RemoveTag<TTag>(*this);
 		}
 
 		inline bool IsAlive() const
@@ -122,7 +128,7 @@ namespace TipECS
 		struct EntityPrivateAccessor
 		{
 			using Setting = TSetting;
-			using Entity = Entity<Setting>;
+			using Entity = TipECS::Entity<Setting>;
 
 			auto& GetHandleDataIndex(Entity& entity) { return entity.handleDataIndex; }
 			auto& GetCounterIndex(Entity& entity) { return entity.counter; }
@@ -25,11 +25,12 @@ namespace TipECS
 		static_assert(Setting::template IsComponent<TComponent>(), "TComponent is not a registered component!");
 		using TComp = TComponent;
 	public:
-		using Entity = Entity<Setting>;
+		using Entity = TipECS::Entity<Setting>;
 		typedef void(*ComponentHookFunc)(const Entity& entity, TComp& comp);
 
 		inline void HookOnAdded(ComponentHookFunc func) noexcept { if (func) mOnAddedFunc = func; }
 		inline void HookOnRemoved(ComponentHookFunc func) noexcept { if (func) mOnRemovedFunc = func; }
+		inline void HookOnModified(ComponentHookFunc func) noexcept { if (func) mOnModifiedFunc = func; }
 	private:
 		friend class EntityHookerContainer<Setting>;
 		friend class EntityManager<Setting>;
@@ -44,9 +45,16 @@ namespace TipECS
 			if (mOnRemovedFunc)
 				mOnRemovedFunc(entity, comp);
 		}
+
+		inline void OnComponentModified(const Entity& entity, TComp& comp) noexcept
+		{
+			if (mOnModifiedFunc)
+				mOnModifiedFunc(entity, comp);
+		}
 	private:
 		ComponentHookFunc mOnAddedFunc = nullptr;
 		ComponentHookFunc mOnRemovedFunc = nullptr;
+		ComponentHookFunc mOnModifiedFunc = nullptr;
 	};
 
 	template <typename TSetting, typename TTag>
@@ -57,7 +65,7 @@ namespace TipECS
 		static_assert(Setting::template IsTag<TTag>(), "TTag is not a registered tag!");
 		using Tag = TTag;
 	public:
-		using Entity = Entity<Setting>;
+		using Entity = TipECS::Entity<Setting>;
 		typedef void(*TagHookFunc)(const Entity& entity);
 
 		inline void HookOnAdded(TagHookFunc func) noexcept { if (func) mOnAddedFunc = func; }
@@ -9,7 +9,7 @@
 #if USE_STL
 #	include <vector>
 #else
-#	include "eastl/vector.h"
+#	include "EASTL/vector.h"
 #endif
 #include <assert.h>
 
@@ -25,30 +25,32 @@ namespace TipECS
 		using HandleData = Impl::HandleData;
 		using EntityPrivateAccessor = Impl::EntityPrivateAccessor<Setting>;
 		using SignatureBitSetsStorage = typename Setting::SignatureBitSetsStorage;
-		using ComponentsStorage = typename ComponentsStorage<Setting>;
-		using EntityHookerContainer = typename EntityHookerContainer<Setting>;
+		using ComponentsStorage = TipECS::ComponentsStorage<Setting>;
+		using EntityHookerContainer = TipECS::EntityHookerContainer<Setting>;
 		using ThisType = EntityManager<Setting>;
 	public:
-		using Entity = Entity<Setting>;
+		using Entity = TipECS::Entity<Setting>;
 
-		template <typename TSetting, typename TSignature>
+		//! Iterate the entities by archetypes, only the archetypes matching the signature are visited,
+		//! and the entities inside one archetype are stored contiguously in chunks.
+		template <typename TIteratorSetting, typename TSignature>
 		class SignatureIterator
 		{
 		private:
-			using Setting = TSetting;
+			using Setting = TIteratorSetting;
 			using Signature = TSignature;
-			using EntityManager = EntityManager<Setting>;
+			using EntityManager = TipECS::EntityManager<Setting>;
 			using Entity = typename EntityManager::Entity;
 			using ThisType = SignatureIterator<Setting, Signature>;
 		public:
 			SignatureIterator(EntityManager& manager)
-				:mEntityManager(manager)
+				:mEntityManager(manager), mArchetypes(manager.template GetMatchedArchetypes<Signature>())
 			{
 			}
 
 			bool operator==(const SignatureIterator& rhs) const
 			{
-				return mCurrEntityID == rhs.mCurrEntityID;
+				return mCurrArchetype == rhs.mCurrArchetype && mCurrChunk == rhs.mCurrChunk && mCurrRow == rhs.mCurrRow;
 			}
 
 			bool operator!=(const SignatureIterator& rhs) const
@@ -58,9 +60,10 @@ namespace TipECS
 
 			Entity operator*() const
 			{
+				const auto& owner = mEntityManager.mComponentsStorage.GetRowOwner(mArchetypes[mCurrArchetype], mCurrChunk, mCurrRow);
 				Entity entity = {};
-				mEntityManager.mEntityPrivateAccessor.GetHandleDataIndex(entity) = mEntityManager.GetEntityHandle(mCurrEntityID).handleDataIndex;
-				mEntityManager.mEntityPrivateAccessor.GetCounterIndex(entity) = mEntityManager.GetHandleData(mCurrEntityID).counter;
+				mEntityManager.mEntityPrivateAccessor.GetHandleDataIndex(entity) = owner.handleDataIndex;
+				mEntityManager.mEntityPrivateAccessor.GetCounterIndex(entity) = mEntityManager.GetHandleData(owner.handleDataIndex).counter;
 				mEntityManager.mEntityPrivateAccessor.SetManagerPtr(entity, &mEntityManager);
 				return entity;
 			}
@@ -73,38 +76,57 @@ namespace TipECS
 
 			const ThisType begin() const
 			{
-				PreAdvance();
+				mCurrArchetype = 0;
+				mCurrChunk = 0;
+				mCurrRow = 0;
+				SkipEmpty();
 				return *this;
 			}
 
 			const ThisType end() const
 			{
-				mCurrEntityID = mEntityManager.mSizeNext;
+				mCurrArchetype = mArchetypes.size();
+				mCurrChunk = 0;
+				mCurrRow = 0;
 				return *this;
 			}
 		private:
-			void PreAdvance() const
+			//! Move to the next valid row if the current chunk or archetype is exhausted.
+			void SkipEmpty() const
 			{
-				while (!mEntityManager.IsAlive(mCurrEntityID) || !mEntityManager.MatchSignature<Signature>(mCurrEntityID))
+				const auto& storage = mEntityManager.mComponentsStorage;
+				while (mCurrArchetype < mArchetypes.size())
 				{
-					++mCurrEntityID;
-					if (mCurrEntityID == mEntityManager.mSizeNext)
-						break;
-				};
+					const size_t archetype = mArchetypes[mCurrArchetype];
+					if (mCurrChunk < storage.ChunkCount(archetype))
+					{
+						if (mCurrRow < storage.ChunkSize(archetype, mCurrChunk))
+							return;
+						++mCurrChunk;
+						mCurrRow = 0;
+					}
+					else
+					{
+						++mCurrArchetype;
+						mCurrChunk = 0;
+						mCurrRow = 0;
+					}
+				}
+				mCurrChunk = 0;
+				mCurrRow = 0;
 			}
 
 			void Advance() const
 			{
-				do
-				{
-					++mCurrEntityID;
-					if (mCurrEntityID == mEntityManager.mSizeNext)
-						break;
-				} while (!mEntityManager.IsAlive(mCurrEntityID) || !mEntityManager.MatchSignature<Signature>(mCurrEntityID));
+				++mCurrRow;
+				SkipEmpty();
 			}
 		private:
 			EntityManager& mEntityManager;
-			mutable EntityID mCurrEntityID{ 0 };
+			const Impl::Vector<size_t>& mArchetypes;
+			mutable size_t   mCurrArchetype = 0;
+			mutable size_t   mCurrChunk = 0;
+			mutable uint32_t mCurrRow = 0;
 		};
 	public:
 		EntityManager()
@@ -160,11 +182,12 @@ namespace TipECS
 		{
 			static_assert(Setting::template IsSignature<TSignature>(), "It is a not registered signature!");
 
-			TraverseEntity([this, &func](const Entity& entity)
-				{
-					if (MatchSignature<TSignature>(GetEntityID(entity)))
-						ExpandSignatureCall<TSignature>(entity, std::forward<TFunc>(func));
-				});
+			using SignatureComponents = typename Setting::SignatureBitSets::template SignatureComponents<TSignature>;
+			using UnpackedComponents = typename TMP::Unpack<UnpackedSignatureComponents, SignatureComponents>::type;
+
+			// walk the component columns of the matched archetypes linearly.
+			for (auto archetype : GetMatchedArchetypes<TSignature>())
+				UnpackedComponents::CallArchetype(archetype, *this, std::forward<TFunc>(func));
 		}
 
 		template <typename... Ts>
@@ -184,16 +207,20 @@ namespace TipECS
 		template <typename TComponent>
 		auto& AddComponent(const Entity& entity) noexcept
 		{
+			const bool bAlreadyAdded = HasComponent<TComponent>(entity);
 			auto& comp = AddComponent<TComponent>(GetEntityID(entity));
-			GetComponentHooker<TComponent>().OnComponentAdded(entity, comp);
+			if (!bAlreadyAdded)
+				GetComponentHooker<TComponent>().OnComponentAdded(entity, comp);
 			return comp;
 		}
 
 		template <typename TComponent, typename... Args>
 		auto& AddComponent(const Entity& entity, Args&&... args) noexcept
 		{
+			const bool bAlreadyAdded = HasComponent<TComponent>(entity);
 			auto& comp = AddComponent<TComponent>(GetEntityID(entity), FWD(args)...);
-			GetComponentHooker<TComponent>().OnComponentAdded(entity, comp);
+			if (!bAlreadyAdded)
+				GetComponentHooker<TComponent>().OnComponentAdded(entity, comp);
 			return comp;
 		}
 
@@ -218,15 +245,27 @@ namespace TipECS
 		template <typename TComponent>
 		void RemoveComponent(const Entity& entity) noexcept
 		{
+			assert(HasComponent<TComponent>(entity) && "The entity do not have this component!");
+			if (!HasComponent<TComponent>(entity))
+				return;
+
 			auto& comp = GetComponent<TComponent>(entity);
 			GetComponentHooker<TComponent>().OnComponentRemoved(entity, comp);
 			RemoveComponent<TComponent>(GetEntityID(entity));
 		}
 
+		//! The ECS do not know when a component is written, the user call this to fire the modified hook of the component.
+		template <typename TComponent>
+		void NotifyComponentModified(const Entity& entity) noexcept
+		{
+			auto& comp = GetComponent<TComponent>(entity);
+			GetComponentHooker<TComponent>().OnComponentModified(entity, comp);
+		}
+
 		template <typename TComponent>
 		auto& GetComponentHooker() noexcept
 		{
-			return mEntityHookerContainer.GetComponentHooker<TComponent>();
+			return mEntityHookerContainer.template GetComponentHooker<TComponent>();
 		}
 
 		template <typename TTag>
@@ -252,12 +291,13 @@ namespace TipECS
 		template <typename TComponent>
 		auto& GetTagHooker() noexcept
 		{
-			return mEntityHookerContainer.GetTagHooker<TComponent>();
+			return mEntityHookerContainer.template GetTagHooker<TComponent>();
 		}
 
 		//! Clear all the entities and reset the status.
 		void Clear() noexcept
 		{
+			mComponentsStorage.Clear();
 			for (size_t i = 0; i < mCapacity; ++i)
 			{
 				auto& entityHandle = mEntityHandles[i];
@@ -266,8 +306,9 @@ namespace TipECS
 				entityHandle.dataIndex = i;
 				entityHandle.handleDataIndex = i;
 
+				// keep the counters growing, so the entities created before the clear stay invalid.
 				auto& handleData = mHandleDatas[i];
-				handleData.counter = 0;
+				++handleData.counter;
 				handleData.id = i;
 			}
 			mSize = mSizeNext = 0;
@@ -360,7 +401,7 @@ namespace TipECS
 				auto dataIndex = thisType.GetEntityHandle(id).dataIndex;
 				func(
 					id,
-					thisType.mComponentsStorage.GetComponent<Ts>(dataIndex)... // expand the components inside the function parameter list.
+					thisType.mComponentsStorage.template GetComponent<Ts>(dataIndex)... // expand the components inside the function parameter list.
 				);
 			}
 
@@ -369,11 +410,36 @@ namespace TipECS
 			{
 				auto dataIndex = thisType.GetEntityHandle(thisType.GetEntityID(entity)).dataIndex;
 				func(
-					thisType.mComponentsStorage.GetComponent<Ts>(dataIndex)... // expand the components inside the function parameter list.
+					thisType.mComponentsStorage.template GetComponent<Ts>(dataIndex)... // expand the components inside the function parameter list.
 				);
 			}
+
+			template <typename TFunc>
+			constexpr static void CallArchetype(size_t archetype, ThisType& thisType, TFunc&& func)
+			{
+				thisType.mComponentsStorage.template ForEachRow<Ts...>(archetype, std::forward<TFunc>(func));
+			}
 		};
 
+		//! Return all the archetypes matching the signature.
+		//! Archetypes are never removed, so only the newly created ones since the last call need to be tested.
+		template <typename TSignature>
+		const Impl::Vector<size_t>& GetMatchedArchetypes() noexcept
+		{
+			static_assert(Setting::template IsSignature<TSignature>(), "It is a not registered signature!");
+			constexpr size_t signatureId = Setting::template SignatureID<TSignature>();
+
+			auto& matched = mMatchedArchetypes[signatureId];
+			auto& testedCount = mTestedArchetypeCount[signatureId];
+			const auto& signatureBitset = mSignatureBitSets.template GetSignatureBitSet<TSignature>();
+			for (; testedCount < mComponentsStorage.ArchetypeCount(); ++testedCount)
+			{
+				if ((mComponentsStorage.GetArchetypeBitSet(testedCount) & signatureBitset) == signatureBitset)
+					matched.push_back(testedCount);
+			}
+			return matched;
+		}
+
 		//! Reorder algorithm implemented here.
 		//! @return size of the current entities.
 		EntityID ReFreshImpl() noexcept
@@ -396,8 +462,6 @@ namespace TipECS
 				{
 					if (mEntityHandles[indexDead].bAlive)
 						break;
-					// invalidate the dead entity handle data
-					InvalidateEntity(indexDead);
 					if (indexDead <= indexAlive)
 						return indexAlive;
 					--indexDead;
@@ -407,8 +471,8 @@ namespace TipECS
 				assert(mEntityHandles[indexDead].bAlive);
 
 				std::swap(mEntityHandles[indexAlive], mEntityHandles[indexDead]);
+				// the dead entity handle data had been invalidated in DestroyEntity().
 				RefreshEntity(indexAlive);
-				InvalidateEntity(indexDead);
 				RefreshEntity(indexDead);
 
 				++indexAlive;
@@ -524,6 +588,7 @@ namespace TipECS
 			auto& entity = GetEntityHandle(availableIndex);
 			entity.bAlive = true;
 			entity.bitset.reset();
+			mComponentsStorage.Insert(entity.dataIndex, entity.handleDataIndex);
 
 			return availableIndex;
 		}
@@ -552,7 +617,7 @@ namespace TipECS
 		{
 			static_assert(Setting::template IsSignature<TSignature>(), "It is a not registered signature!");
 			const auto& entityBitset = GetEntityHandle(id).bitset;
-			const auto& signatureBitset = mSignatureBitSets.GetSignatureBitSet<TSignature>();
+			const auto& signatureBitset = mSignatureBitSets.template GetSignatureBitSet<TSignature>();
 
 			return (entityBitset & signatureBitset) == signatureBitset;
 		}
@@ -577,8 +642,13 @@ private:
 
 		void DestroyEntity(EntityID id) noexcept
 		{
-			// just mark it as dead, let the Refresh do its job.
-			GetEntityHandle(id).bAlive = false;
+			// mark it as dead and release its components, let the Refresh do the rest of the job.
+			// the handle data is invalidated right now, so the copies of the entity are invalid before the refresh.
+			InvalidateEntity(id);
+			auto& entity = GetEntityHandle(id);
+			entity.bAlive = false;
+			entity.bitset.reset();
+			mComponentsStorage.Erase(entity.dataIndex);
 		}
 
 		template <typename TComponent>
@@ -592,27 +662,28 @@ private:
 		auto& AddComponent(EntityID id) noexcept
 		{
 			static_assert(Setting::template IsComponent<TComponent>(), "It is a not registered component!");
-			assert(!HasComponent<TComponent>(id));
+			assert(!HasComponent<TComponent>(id) && "The entity already have this component!");
+			if (HasComponent<TComponent>(id))
+				return GetComponent<TComponent>(id);
 
 			auto& entity = GetEntityHandle(id);
 			entity.bitset[Setting::template ComponentBitIndex<TComponent>()] = true;
 
-			return mComponentsStorage.AddComponent<TComponent>(entity.dataIndex);
+			return mComponentsStorage.template AddComponent<TComponent>(entity.dataIndex);
 		}
 
 		template <typename TComponent, typename... Args>
 		auto& AddComponent(EntityID id, Args&&... args) noexcept
 		{
 			static_assert(Setting::template IsComponent<TComponent>(), "It is a not registered component!");
-			assert(!HasComponent<TComponent>(id));
+			assert(!HasComponent<TComponent>(id) && "The entity already have this component!");
+			if (HasComponent<TComponent>(id))
+				return GetComponent<TComponent>(id);
 
 			auto& entity = GetEntityHandle(id);
 			entity.bitset[Setting::template ComponentBitIndex<TComponent>()] = true;
 
-			auto& compData = mComponentsStorage.AddComponent<TComponent>(entity.dataIndex);
-			// placement new to initialize the data
-			new (&compData) TComponent(std::forward<Args>(args)...);
-			return compData;
+			return mComponentsStorage.template AddComponent<TComponent>(entity.dataIndex, std::forward<Args>(args)...);
 		}
 
 		template <typename TComponent>
@@ -621,15 +692,18 @@ private:
 			static_assert(Setting::template IsComponent<TComponent>(), "It is a not registered component!");
 			assert(HasComponent<TComponent>(id));
 
-			return mComponentsStorage.GetComponent<TComponent>(GetEntityHandle(id).dataIndex);
+			return mComponentsStorage.template GetComponent<TComponent>(GetEntityHandle(id).dataIndex);
 		}
 
 		template <typename TComponent>
 		void RemoveComponent(EntityID id) noexcept
 		{
 			static_assert(Setting::template IsComponent<TComponent>(), "It is a not registered component!");
+			assert(HasComponent<TComponent>(id) && "The entity do not have this component!");
+			if (!HasComponent<TComponent>(id))
+				return;
 			GetEntityHandle(id).bitset[Setting::template ComponentBitIndex<TComponent>()] = false;
-			mComponentsStorage.RemoveComponent<TComponent>(GetEntityHandle(id).dataIndex);
+			mComponentsStorage.template RemoveComponent<TComponent>(GetEntityHandle(id).dataIndex);
 		}
 
 		template <typename TTag>
@@ -643,14 +717,20 @@ private:
 		void AddTag(EntityID id) noexcept
 		{
 			static_assert(Setting::template IsTag<TTag>(), "It is a not registered tag!");
+			if (HasTag<TTag>(id))
+				return;
 			GetEntityHandle(id).bitset[Setting::template TagBitIndex<TTag>()] = true;
+			mComponentsStorage.ToggleTag(GetEntityHandle(id).dataIndex, Setting::template TagBitIndex<TTag>());
 		}
 
 		template <typename TTag>
 		void RemoveTag(EntityID id) noexcept
 		{
 			static_assert(Setting::template IsTag<TTag>(), "It is a not registered tag!");
+			if (!HasTag<TTag>(id))
+				return;
 			GetEntityHandle(id).bitset[Setting::template TagBitIndex<TTag>()] = false;
+			mComponentsStorage.ToggleTag(GetEntityHandle(id).dataIndex, Setting::template TagBitIndex<TTag>());
 		}
 	private:
 		//! Current capacity of the entity.
@@ -679,6 +759,10 @@ private:
 		EntityPrivateAccessor mEntityPrivateAccessor;
 		//! Used to hook some user custom callback events.
 		EntityHookerContainer mEntityHookerContainer;
+		//! Archetypes matching each signature, updated lazily when a view is requested.
+		std::array<Impl::Vector<size_t>, Setting::SignatureCount()> mMatchedArchetypes;
+		//! Count of the archetypes already tested for each signature.
+		std::array<size_t, Setting::SignatureCount()> mTestedArchetypeCount = {};
 		//! Used to do some optimization.
 		bool mbCurrentFrameModified;
 	};
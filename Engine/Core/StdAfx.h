@@ -1,5 +1,8 @@
 #pragma once
 
+// the export macros first, the headers of eastl pull in our allocator.
+#include "Core/Config.h"
+
 #include <mimalloc/include/mimalloc.h>
 
 #ifdef SG_PLATFORM_WINDOWS
@@ -15,14 +18,18 @@
 #include "Stl/string_view.h"
 #include <EASTL/utility.h>
 
-#include <shlwapi.h> // for win32 directory manipulation
-#pragma comment(lib, "shlwapi.lib")
+#ifdef SG_PLATFORM_WINDOWS
+#	include <shlwapi.h> // for win32 directory manipulation
+#	pragma comment(lib, "shlwapi.lib")
 
-#include <direct.h> // _chdir()
+#	include <direct.h> // _chdir()
+#endif
 
 #include <fstream>
 #include <sstream>
 
 #include <stdio.h>
 #include <ctime>    // SystemTimeWindows.cpp
-#include <io.h>     // _access() in FileSystem
\ No newline at end of file
+#ifdef SG_PLATFORM_WINDOWS
+#	include <io.h>  // _access() in FileSystem
+#endif
\ No newline at end of file
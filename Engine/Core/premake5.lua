@@ -28,6 +28,7 @@ project "SCore"
 
     includedirs
     {
+        "./", -- StdAfx.h for the sources in the sub folders on gcc
         "../",
         "../../Libs/",
         "../../Libs/eastl/include/",
@@ -55,6 +56,10 @@ project "SCore"
     systemversion "latest"
     defines "SG_PLATFORM_WINDOWS"
 
+    filter "system:linux"
+    defines "SG_PLATFORM_LINUX=1"
+    links "pthread"
+
 filter "configurations:Debug"
     kind "SharedLib"
     runtime "Debug"
@@ -71,6 +76,7 @@ filter "configurations:Debug"
     -- enable if you want to build a dll
     postbuildcommands
     {
+        ("{MKDIR} \"../../bin/" .. outputdir .. "/Sandbox/\""),
         ("{COPY} %{cfg.buildtarget.relpath} \"../../bin/" .. outputdir .. "/Sandbox/\"")
     }
 
@@ -95,5 +101,6 @@ filter "configurations:Release"
     }
     postbuildcommands
     {
+        ("{MKDIR} \"../../bin/" .. outputdir .. "/Sandbox/\""),
         ("{COPY} %{cfg.buildtarget.relpath} \"../../bin/" .. outputdir .. "/Sandbox/\"")
     }
\ No newline at end of file
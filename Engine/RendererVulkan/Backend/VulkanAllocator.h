@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Base/BasicTypes.h"
+
 #include "VulkanConfig.h"
 
 #include "volk.h"
@@ -9,4 +11,20 @@
 #	define VK_API_VERSION_MINOR(version) (((uint32_t)(version) >> 12) & 0x3FFU)
 #	define VK_API_VERSION_PATCH(version) ((uint32_t)(version) & 0xFFFU)
 #	include "vma/vk_mem_alloc.h"
-#endif
\ No newline at end of file
+#endif
+
+namespace SG
+{
+
+	//! A range of a memory block shared by several resources, i.e. the aliased transient render targets.
+	struct VulkanMemoryPlacement
+	{
+#if SG_USE_VULKAN_MEMORY_ALLOCATOR
+		VmaAllocation  allocation = nullptr;
+#else
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+#endif
+		UInt64         offset = 0;
+	};
+
+}
\ No newline at end of file
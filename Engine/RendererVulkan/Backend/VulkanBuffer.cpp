@@ -5,6 +5,7 @@
 #include "Memory/Memory.h"
 
 #include "VulkanContext.h"
+#include "VulkanDescriptorCache.h"
 
 #include "RendererVulkan/Utils/VkConvert.h"
 
@@ -12,7 +13,7 @@ namespace SG
 {
 
 	VulkanBuffer::VulkanBuffer(VulkanContext& c, const BufferCreateDesc& CI)
-		:context(c)
+		:context(c), uniqueId(VulkanDescriptorCache::NewResourceId())
 	{
 		SG_ASSERT(CI.memoryUsage != EGPUMemoryUsage::eInvalid);
 
@@ -24,6 +24,9 @@ namespace SG
 		bool   UploadData(const void* pData, UInt32 size, UInt32 offset);
 		UInt32 SizeCPU() const { return size; }
 		UInt32 SizeGPU() const;
+		EBufferType     GetType() const { return type; }
+		EGPUMemoryUsage GetMemoryUsage() const { return memoryUsage; }
+		EGPUMemoryFlag  GetMemoryFlag() const { return memoryFlag; }
 		static VulkanBuffer* Create(VulkanContext& c, const BufferCreateDesc& CI);
 
 		template <typename DataType>
@@ -33,6 +36,7 @@ namespace SG
 		friend class VulkanCommandBuffer;
 		friend class VulkanDescriptorDataBinder;
 		VulkanContext& context;
+		UInt32         uniqueId; //!< Never reused, unlike the handle.
 
 #if SG_USE_VULKAN_MEMORY_ALLOCATOR
 		VmaAllocation  vmaAllocation;
@@ -16,6 +16,63 @@
 namespace SG
 {
 
+	namespace // anonymous namespace
+	{
+		//! The accesses and the pipeline stages an image is used in with the layout.
+		void _GetImageLayoutAccess(VkImageLayout layout, VkAccessFlags& access, VkPipelineStageFlags& stage)
+		{
+			switch (layout)
+			{
+			case VK_IMAGE_LAYOUT_UNDEFINED:
+				access = 0;
+				stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+				break;
+			case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+				access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+				stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+				break;
+			case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+				access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+				stage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+				break;
+			case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL:
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+				access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+				stage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+				break;
+			case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+				access = VK_ACCESS_SHADER_READ_BIT;
+				stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+				break;
+			case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+				access = VK_ACCESS_TRANSFER_READ_BIT;
+				stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+				break;
+			case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+				access = VK_ACCESS_TRANSFER_WRITE_BIT;
+				stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+				break;
+			case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+				access = 0;
+				stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+				break;
+			default: // general and the others, be conservative
+				access = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+				stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+				break;
+			}
+		}
+
+		bool _IsDepthLayout(VkImageLayout layout)
+		{
+			return layout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL ||
+				layout == VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL ||
+				layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL ||
+				layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		}
+	}
+
 	//////////////////////////////////////////////////////////////////////////////////////////////////
 	/// VulkanCommandPool
 	//////////////////////////////////////////////////////////////////////////////////////////////////
@@ -102,10 +159,6 @@ namespace SG
 	/// VulkanCommandPool
 	//////////////////////////////////////////////////////////////////////////////////////////////////
 
-	// global static variable
-	static VulkanRenderPass* gpCurrRenderPass = nullptr; // used to judge whether this is a valid BeginRenderPass().
-	static EPipelineType gCurrCmdType = EPipelineType::MAX_COUNT;
-
 	void VulkanCommandBuffer::BeginRecord(bool bPermanent)
 	{
 		SG_PROFILE_FUNCTION();
@@ -119,7 +172,26 @@ namespace SG
 			cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &cmdBufInfo),
 			SG_LOG_ERROR("Failed to begin command buffer!"); SG_ASSERT(false););
-		gCurrCmdType = type;
+	}
+
+	void VulkanCommandBuffer::BeginSecondaryRecord(VulkanFrameBuffer* pFrameBuffer)
+	{
+		SG_PROFILE_FUNCTION();
+
+		VkCommandBufferInheritanceInfo inheritanceInfo = {};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = pFrameBuffer->pRenderPass->renderPass;
+		inheritanceInfo.subpass = 0;
+		inheritanceInfo.framebuffer = pFrameBuffer->frameBuffer;
+
+		VkCommandBufferBeginInfo cmdBufInfo = {};
+		cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cmdBufInfo.pNext = nullptr;
+		cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		cmdBufInfo.pInheritanceInfo = &inheritanceInfo;
+		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &cmdBufInfo),
+			SG_LOG_ERROR("Failed to begin secondary command buffer!"); SG_ASSERT(false););
+		pCurrRenderPass = pFrameBuffer->pRenderPass;
 	}
 
 	void VulkanCommandBuffer::EndRecord()
@@ -128,7 +200,7 @@ namespace SG
 
 		VK_CHECK(vkEndCommandBuffer(commandBuffer),
 			SG_LOG_ERROR("Failed to end command buffer!"); SG_ASSERT(false););
-		gCurrCmdType = EPipelineType::MAX_COUNT;
+		pCurrRenderPass = nullptr;
 	}
 
 	void VulkanCommandBuffer::Reset(bool bReleaseResource)
@@ -138,7 +210,7 @@ namespace SG
 		vkResetCommandBuffer(commandBuffer, bReleaseResource ? VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT : 0);
 	}
 
-	void VulkanCommandBuffer::BeginRenderPass(VulkanFrameBuffer* pFrameBuffer, const ClearValue* pClearValues, UInt32 numClearValue)
+	void VulkanCommandBuffer::BeginRenderPass(VulkanFrameBuffer* pFrameBuffer, const ClearValue* pClearValues, UInt32 numClearValue, bool bSecondaryContents)
 	{
 		SG_PROFILE_FUNCTION();
 
@@ -156,15 +228,15 @@ namespace SG
 		renderPassBeginInfo.renderPass = pFrameBuffer->pRenderPass->renderPass;
 		renderPassBeginInfo.framebuffer = pFrameBuffer->frameBuffer;
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-		gpCurrRenderPass = pFrameBuffer->pRenderPass;
+		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, bSecondaryContents ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+		pCurrRenderPass = pFrameBuffer->pRenderPass;
 	}
 
 	void VulkanCommandBuffer::EndRenderPass()
 	{
 		SG_PROFILE_FUNCTION();
 
-		//for (auto& trans : gpCurrRenderPass->transitions)
+		//for (auto& trans : pCurrRenderPass->transitions)
 		//{
 		//	if (trans.srcLayout != VK_IMAGE_LAYOUT_UNDEFINED && trans.pRenderTarget->currLayouts[0] != trans.srcLayout)
 		//	{
@@ -175,7 +247,20 @@ namespace SG
 		//		trans.pRenderTarget->currLayouts[0] = trans.dstLayout;
 		//}
 		vkCmdEndRenderPass(commandBuffer);
-		gpCurrRenderPass = nullptr;
+		pCurrRenderPass = nullptr;
+	}
+
+	void VulkanCommandBuffer::ExecuteCommands(const vector<VulkanCommandBuffer*>& pSecondaryCmdBufs)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (pSecondaryCmdBufs.empty())
+			return;
+
+		vector<VkCommandBuffer> secondaryCmdBufs(pSecondaryCmdBufs.size());
+		for (UInt32 i = 0; i < pSecondaryCmdBufs.size(); ++i)
+			secondaryCmdBufs[i] = pSecondaryCmdBufs[i]->commandBuffer;
+		vkCmdExecuteCommands(commandBuffer, static_cast<UInt32>(secondaryCmdBufs.size()), secondaryCmdBufs.data());
 	}
 
 	void VulkanCommandBuffer::SetViewport(float width, float height, float minDepth, float maxDepth)
@@ -347,6 +432,27 @@ namespace SG
 		vkCmdCopyBuffer(commandBuffer, srcBuffer.buffer, dstBuffer.buffer, 1, &copyRegion);
 	}
 
+	void VulkanCommandBuffer::CopyBuffer(VulkanBuffer& srcBuffer, VulkanBuffer& dstBuffer, const vector<BufferCopyRegion>& region)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (region.empty())
+			return;
+
+		vector<VkBufferCopy> bufferCopyRegions;
+		bufferCopyRegions.resize(region.size());
+		for (UInt32 i = 0; i < region.size(); ++i)
+		{
+			VkBufferCopy copyRegion = {};
+			copyRegion.srcOffset = region[i].srcOffset;
+			copyRegion.dstOffset = region[i].dstOffset;
+			copyRegion.size = region[i].size;
+			bufferCopyRegions[i] = copyRegion;
+		}
+
+		vkCmdCopyBuffer(commandBuffer, srcBuffer.buffer, dstBuffer.buffer, static_cast<UInt32>(bufferCopyRegions.size()), bufferCopyRegions.data());
+	}
+
 	void VulkanCommandBuffer::CopyBufferToImage(VulkanBuffer& srcBuffer, VulkanTexture& dstTexture, const vector<TextureCopyRegion>& region)
 	{
 		SG_PROFILE_FUNCTION();
@@ -602,6 +708,58 @@ namespace SG
 		}
 	}
 
+	void VulkanCommandBuffer::ImageBarriers(const vector<ImageTransition>& transitions)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (transitions.empty())
+			return;
+
+		vector<VkImageMemoryBarrier> barriers;
+		barriers.reserve(transitions.size());
+		VkPipelineStageFlags srcStages = 0;
+		VkPipelineStageFlags dstStages = 0;
+		for (auto& transition : transitions)
+		{
+			VulkanTexture* pTex = transition.pTexture;
+
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.oldLayout = ToVkImageLayout(transition.oldBarrier);
+			barrier.newLayout = ToVkImageLayout(transition.newBarrier);
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = pTex->image;
+			barrier.subresourceRange.aspectMask = (_IsDepthLayout(barrier.oldLayout) || _IsDepthLayout(barrier.newLayout)) ?
+				VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+			barrier.subresourceRange.baseMipLevel = 0;
+			barrier.subresourceRange.levelCount = pTex->mipLevel;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = pTex->array;
+
+			VkPipelineStageFlags srcStage, dstStage;
+			_GetImageLayoutAccess(barrier.oldLayout, barrier.srcAccessMask, srcStage);
+			_GetImageLayoutAccess(barrier.newLayout, barrier.dstAccessMask, dstStage);
+			if (transition.bAliasing)
+			{
+				barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+				srcStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			}
+			srcStages |= srcStage;
+			dstStages |= dstStage;
+
+			barriers.emplace_back(barrier);
+
+			for (auto& layout : pTex->currLayouts)
+				layout = barrier.newLayout;
+		}
+
+		vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<UInt32>(barriers.size()), barriers.data());
+	}
+
 	void VulkanCommandBuffer::BufferBarrier(VulkanBuffer* pBuf, EPipelineStageAccess oldStage, EPipelineStageAccess newStage,
 		EPipelineType srcType, EPipelineType dstType)
 	{
@@ -672,6 +830,27 @@ namespace SG
 			srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 			dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 		}
+		else if (newStage == EPipelineStageAccess::efTransfer_Write ||
+			oldStage == EPipelineStageAccess::efTransfer_Write)
+		{
+			// an upload after the draws reading the buffer, or the draws after an upload.
+			const EPipelineStageAccess readStage = (newStage == EPipelineStageAccess::efTransfer_Write) ? oldStage : newStage;
+			VkPipelineStageFlags readPipelineStages = 0;
+			if (SG_HAS_ENUM_FLAG(readStage, EPipelineStageAccess::efIndirect_Read))
+				readPipelineStages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+			if (SG_HAS_ENUM_FLAG(readStage, EPipelineStageAccess::efIndex_Read | EPipelineStageAccess::efVertex_Read))
+				readPipelineStages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+			if (SG_HAS_ENUM_FLAG(readStage, EPipelineStageAccess::efUniforn_Read | EPipelineStageAccess::efShader_Read))
+				readPipelineStages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			if (readPipelineStages == 0)
+			{
+				SG_LOG_ERROR("Unsupported pipeline stage transition!");
+				return;
+			}
+
+			srcStage = (newStage == EPipelineStageAccess::efTransfer_Write) ? readPipelineStages : VK_PIPELINE_STAGE_TRANSFER_BIT;
+			dstStage = (newStage == EPipelineStageAccess::efTransfer_Write) ? VK_PIPELINE_STAGE_TRANSFER_BIT : readPipelineStages;
+		}
 		else
 		{
 			SG_LOG_ERROR("Unsupported pipeline stage transition!");
@@ -743,7 +922,7 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (!gpCurrRenderPass && gCurrCmdType != EPipelineType::eCompute)
+		if (!pCurrRenderPass && type != EPipelineType::eCompute)
 		{
 			SG_LOG_WARN("Did you forget to call BeginRenderPass()?");
 			return false;
@@ -1,8 +1,9 @@
 #pragma once
 
 #include "Base/BasicTypes.h"
+#include "Render/Buffer.h"
 #include "Render/FrameBuffer.h"
-#include "Render/Swapchain.h"
+#include "Render/SwapChain.h"
 #include "Render/ResourceBarriers.h"
 
 #include "VulkanDevice.h"
@@ -24,15 +25,28 @@ namespace SG
 
 	class VulkanQueryPool;
 
+	//! Layout transition of all the mipmaps of a texture, the transitions are batched into one pipeline barrier.
+	struct ImageTransition
+	{
+		VulkanTexture*   pTexture;
+		EResourceBarrier oldBarrier;
+		EResourceBarrier newBarrier;
+		bool             bAliasing = false; //!< The memory was used by another texture before, wait for all the previous work on it.
+	};
+
 	class VulkanCommandBuffer
 	{
 	public:
 		void BeginRecord(bool bPermanent = false);
+		//! Begin to record a secondary command buffer which is executed inside the render pass of the frame buffer.
+		void BeginSecondaryRecord(VulkanFrameBuffer* pFrameBuffer);
 		void EndRecord();
 		void Reset(bool bReleaseResource = false);
 
-		void BeginRenderPass(VulkanFrameBuffer* pFrameBuffer, const ClearValue* pClearValues, UInt32 numClearValue);
+		//! If bSecondaryContents is true, the commands of the render pass are only recorded by ExecuteCommands().
+		void BeginRenderPass(VulkanFrameBuffer* pFrameBuffer, const ClearValue* pClearValues, UInt32 numClearValue, bool bSecondaryContents = false);
 		void EndRenderPass();
+		void ExecuteCommands(const vector<VulkanCommandBuffer*>& pSecondaryCmdBufs);
 
 		void SetViewport(float width, float height, float minDepth, float maxDepth);
 		void SetScissor(const Rect& rect);
@@ -53,12 +67,15 @@ namespace SG
 
 		// transfer
 		void CopyBuffer(VulkanBuffer& srcBuffer, VulkanBuffer& dstBuffer, UInt64 srcOffset = 0, UInt64 dstOffset = 0);
+		void CopyBuffer(VulkanBuffer& srcBuffer, VulkanBuffer& dstBuffer, const vector<BufferCopyRegion>& region);
 		void CopyBufferToImage(VulkanBuffer& srcBuffer, VulkanTexture& dstTexture, const vector<TextureCopyRegion>& region);
 		void CopyImage(VulkanTexture& srcTexture, VulkanTexture& dstTexture, const TextureCopyRegion& region);
 		void BlitImage(VulkanTexture& srcTexture, VulkanTexture& dstTexture, const TextureBlitRegion& region, EFilterMode mode);
 
 		//void BufferBarrier();
 		void ImageBarrier(VulkanTexture* pTex, EResourceBarrier oldBarrier, EResourceBarrier newBarrier, int mipLevel = -1);
+		//! Record all the transitions in one vkCmdPipelineBarrier, the access masks and the stages are derived from the layouts.
+		void ImageBarriers(const vector<ImageTransition>& transitions);
 		void BufferBarrier(VulkanBuffer* pBuf, EPipelineStageAccess oldStage, EPipelineStageAccess newStage, EPipelineType srcType = EPipelineType::eGraphic, EPipelineType dstType = EPipelineType::eGraphic);
 		//void MemoryBarrier();
 
@@ -82,6 +99,7 @@ namespace SG
 		VkCommandBuffer commandBuffer;
 		UInt32          queueFamilyIndex; // which queue this command buffer should submit to.
 		EPipelineType   type;
+		VulkanRenderPass* pCurrRenderPass = nullptr; // used to judge whether this is a valid BeginRenderPass().
 	};
 
 	class VulkanCommandPool
@@ -8,12 +8,13 @@
 #include "VulkanCommand.h"
 #include "VulkanQueue.h"
 #include "VulkanDescriptor.h"
+#include "VulkanDescriptorCache.h"
 #include "VulkanSynchronizePrimitive.h"
 #include "VulkanFrameBuffer.h"
 #include "VulkanTexture.h"
 #include "VulkanQueryPool.h"
 
-#include <eastl/array.h>
+#include <EASTL/array.h>
 
 namespace SG
 {
@@ -166,21 +167,7 @@ namespace SG
 				SG_LOG_ERROR("Failed to create default compute command pool!");
 		}
 
-		pDefaultDescriptorPool = VulkanDescriptorPool::Builder()
-			.AddPoolElement(EDescriptorType::eUniform_Buffer, 1000)
-			.AddPoolElement(EDescriptorType::eStorage_Buffer, 1000)
-			.AddPoolElement(EDescriptorType::eSampler, 1000)
-			.AddPoolElement(EDescriptorType::eCombine_Image_Sampler, 1000)
-			.AddPoolElement(EDescriptorType::eInput_Attachment, 1000)
-			.AddPoolElement(EDescriptorType::eSampled_Image, 1000)
-			.AddPoolElement(EDescriptorType::eStorage_Image, 1000)
-			.AddPoolElement(EDescriptorType::eUniform_Buffer_Dynamic, 1000)
-			.AddPoolElement(EDescriptorType::eStorage_Buffer_Dynamic, 1000)
-			.SetMaxSets(9 * 1000)
-			.Build(device);
-
-		if (!pDefaultDescriptorPool)
-			SG_LOG_ERROR("Failed to create default descriptor pool!");
+		pDescriptorCache = New(VulkanDescriptorCache, device, pSwapchain->imageCount);
 
 		pFences.resize(pSwapchain->imageCount);
 		for (Size i = 0; i < pSwapchain->imageCount; ++i)
@@ -229,7 +216,7 @@ namespace SG
 		for (auto* pFence : pFences)
 			Delete(pFence);
 
-		Delete(pDefaultDescriptorPool);
+		Delete(pDescriptorCache);
 		if (pComputeCommandPool && device.queueFamilyIndices.graphics != device.queueFamilyIndices.compute)
 			Delete(pComputeCommandPool);
 		if (pTransferCommandPool && device.queueFamilyIndices.graphics != device.queueFamilyIndices.transfer)
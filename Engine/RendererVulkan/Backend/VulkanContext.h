@@ -14,7 +14,7 @@
 namespace SG
 {
 
-	class VulkanDescriptorPool;
+	class VulkanDescriptorCache;
 	class VulkanCommandPool;
 	class VulkanRenderPass;
 	class VulkanSemaphore;
@@ -61,7 +61,7 @@ namespace SG
 		// [CPU To GPU Synchronization]
 		vector<VulkanFence*> pFences;
 
-		VulkanDescriptorPool* pDefaultDescriptorPool;
+		VulkanDescriptorCache* pDescriptorCache; //!< All the descriptor sets are allocated from it.
 
 		vector<VulkanRenderTarget*> colorRts;
 		VulkanRenderTarget*         depthRt;
@@ -7,6 +7,7 @@
 #include "VulkanConfig.h"
 #include "VulkanBuffer.h"
 #include "VulkanTexture.h"
+#include "VulkanDescriptorCache.h"
 
 #include "RendererVulkan/Utils/VkConvert.h"
 
@@ -14,7 +15,12 @@
 
 namespace SG
 {
-	
+
+	namespace // anonymous namespace
+	{
+		UInt32 gNextDescriptorSetLayoutId = 0;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// VulkanDescriptorPool
 	////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -35,6 +41,12 @@ namespace SG
 		return *this;
 	}
 
+	VulkanDescriptorPool::Builder& VulkanDescriptorPool::Builder::SetFreeDescriptorSet()
+	{
+		flags |= VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		return *this;
+	}
+
 	VulkanDescriptorPool* VulkanDescriptorPool::Builder::Build(VulkanDevice& d)
 	{
 		if (poolSizes.size() == 0)
@@ -43,10 +55,10 @@ namespace SG
 			return nullptr;
 		}
 
-		return New(VulkanDescriptorPool, d, poolSizes, maxSets);
+		return New(VulkanDescriptorPool, d, poolSizes, maxSets, flags);
 	}
 
-	VulkanDescriptorPool::VulkanDescriptorPool(VulkanDevice& d, const vector<VkDescriptorPoolSize>& poolSizes, UInt32 maxSets)
+	VulkanDescriptorPool::VulkanDescriptorPool(VulkanDevice& d, const vector<VkDescriptorPoolSize>& poolSizes, UInt32 maxSets, VkDescriptorPoolCreateFlags flags)
 		:device(d)
 	{
 		VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
@@ -55,6 +67,7 @@ namespace SG
 		descriptorPoolInfo.poolSizeCount = static_cast<UInt32>(poolSizes.size());
 		descriptorPoolInfo.pPoolSizes = poolSizes.data();
 		descriptorPoolInfo.maxSets = maxSets;
+		descriptorPoolInfo.flags = flags;
 
 		VK_CHECK(vkCreateDescriptorPool(device.logicalDevice, &descriptorPoolInfo, nullptr, &pool),
 			SG_LOG_ERROR("Failed to create descriptor pool!"););
@@ -93,7 +106,7 @@ namespace SG
 	////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	VulkanDescriptorSetLayout::VulkanDescriptorSetLayout(VulkanDevice& d, const eastl::unordered_map<UInt32, VkDescriptorSetLayoutBinding>& layouts)
-		:device(d), bindingsMap(layouts)
+		:device(d), id(gNextDescriptorSetLayoutId++), bindingsMap(layouts)
 	{
 		vector<VkDescriptorSetLayoutBinding> bindings;
 		for (auto& kv : bindingsMap)
@@ -138,87 +151,79 @@ namespace SG
 		return MakeRef<VulkanDescriptorSetLayout>(device, eastl::move(bindingsMap));
 	}
 
+	////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// VulkanDescriptorBinding
+	////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool VulkanDescriptorBinding::operator==(const VulkanDescriptorBinding& rhs) const
+	{
+		return binding == rhs.binding && type == rhs.type && count == rhs.count && resourceId == rhs.resourceId && samplerId == rhs.samplerId &&
+			bufferInfo.buffer == rhs.bufferInfo.buffer && bufferInfo.offset == rhs.bufferInfo.offset && bufferInfo.range == rhs.bufferInfo.range &&
+			imageInfo.sampler == rhs.imageInfo.sampler && imageInfo.imageView == rhs.imageInfo.imageView && imageInfo.imageLayout == rhs.imageInfo.imageLayout;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// VulkanDescriptorDataBinder
 	////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	VulkanDescriptorDataBinder::VulkanDescriptorDataBinder(VulkanDescriptorPool& p, VulkanDescriptorSetLayout& l)
-		:pool(p), layout(l)
+	VulkanDescriptorDataBinder::VulkanDescriptorDataBinder(VulkanDescriptorCache& c, VulkanDescriptorSetLayout& l)
+		:cache(c), layout(l)
 	{
 	}
 
 	VulkanDescriptorDataBinder& VulkanDescriptorDataBinder::BindBuffer(UInt32 binding, const VulkanBuffer* pBuf)
 	{
-		if (layout.bindingsMap.count(binding) == 0)
+		auto node = layout.bindingsMap.find(binding);
+		if (node == layout.bindingsMap.end())
 		{
-			SG_LOG_WARN("No binding %d in descriptorSet layout!");
+			SG_LOG_WARN("No binding %d in descriptorSet layout!", binding);
 			return *this;
 		}
 
-		auto& bindingInfo = layout.bindingsMap[binding];
-
-		VkDescriptorBufferInfo bufferInfo = {};
-		bufferInfo.buffer = pBuf->buffer;
-		bufferInfo.range = pBuf->size;
-		bufferInfo.offset = 0;
-		offset += pBuf->size;
-
-		bufferInfos[currentBufferIndex] = eastl::move(bufferInfo);
-
-		VkWriteDescriptorSet write = {};
-		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		write.descriptorType = bindingInfo.descriptorType;
-		write.dstBinding = binding;
-		write.pBufferInfo = &bufferInfos[currentBufferIndex++];
-		write.dstArrayElement = 0;
-		write.descriptorCount = bindingInfo.descriptorCount;
+		VulkanDescriptorBinding descriptorBinding = {};
+		descriptorBinding.binding = binding;
+		descriptorBinding.type = node->second.descriptorType;
+		descriptorBinding.count = node->second.descriptorCount;
+		descriptorBinding.bufferInfo.buffer = pBuf->buffer;
+		descriptorBinding.bufferInfo.range = pBuf->size;
+		descriptorBinding.bufferInfo.offset = 0;
+		descriptorBinding.resourceId = pBuf->uniqueId;
 
-		writes.push_back(eastl::move(write));
+		bindings.push_back(descriptorBinding);
 		return *this;
 	}
 
 	VulkanDescriptorDataBinder& VulkanDescriptorDataBinder::BindImage(UInt32 binding, const VulkanSampler* pSampler, const VulkanTexture* pTexture)
 	{
-		if (layout.bindingsMap.count(binding) == 0)
+		auto node = layout.bindingsMap.find(binding);
+		if (node == layout.bindingsMap.end())
 		{
-			SG_LOG_WARN("No binding %d in descriptorSet layout!");
+			SG_LOG_WARN("No binding %d in descriptorSet layout!", binding);
 			return *this;
 		}
 
-		auto& bindingInfo = layout.bindingsMap[binding];
-
-		VkDescriptorImageInfo imageInfo = {};
-		imageInfo.sampler = pSampler->sampler;
-		imageInfo.imageView = pTexture->imageView;
-		imageInfo.imageLayout = pTexture->currLayouts[0];
-
-		imageInfos[currentImageIndex] = eastl::move(imageInfo);
-
-		VkWriteDescriptorSet write = {};
-		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		write.descriptorType = bindingInfo.descriptorType;
-		write.dstBinding = binding;
-		write.dstArrayElement = 0;
-		write.pImageInfo = &imageInfos[currentImageIndex++];
-		write.descriptorCount = bindingInfo.descriptorCount;
-
-		writes.emplace_back(eastl::move(write));
+		VulkanDescriptorBinding descriptorBinding = {};
+		descriptorBinding.binding = binding;
+		descriptorBinding.type = node->second.descriptorType;
+		descriptorBinding.count = node->second.descriptorCount;
+		descriptorBinding.imageInfo.sampler = pSampler->sampler;
+		descriptorBinding.imageInfo.imageView = pTexture->imageView;
+		descriptorBinding.imageInfo.imageLayout = pTexture->currLayouts[0];
+		descriptorBinding.resourceId = pTexture->uniqueId;
+		descriptorBinding.samplerId = pSampler->uniqueId;
+
+		bindings.push_back(descriptorBinding);
 		return *this;
 	}
 
 	bool VulkanDescriptorDataBinder::Bind(VulkanDescriptorSet& set)
 	{
-		if (!pool.AllocateDescriptorSet(layout.descriptorSetLayout, set))
-			return false;
-		OverWriteData(set);
-		return true;
+		return cache.Acquire(layout, bindings, set);
 	}
 
 	void VulkanDescriptorDataBinder::OverWriteData(VulkanDescriptorSet& set)
 	{
-		for (auto& w : writes) // all the data bind to this set
-			w.dstSet = set.set;
-		vkUpdateDescriptorSets(pool.device.logicalDevice, static_cast<UInt32>(writes.size()), writes.data(), 0, nullptr);
+		cache.Overwrite(bindings, set);
 	}
 
 }
\ No newline at end of file
@@ -9,18 +9,19 @@
 
 #include "Stl/SmartPtr.h"
 #include "Stl/vector.h"
-#include "eastl/array.h"
-#include <eastl/unordered_map.h>
+#include "EASTL/array.h"
+#include <EASTL/unordered_map.h>
 
 namespace SG
 {
 
 	class VulkanDescriptorSet;
+	class VulkanDescriptorCache;
 
 	class VulkanDescriptorPool
 	{
 	public:
-		VulkanDescriptorPool(VulkanDevice& d, const vector<VkDescriptorPoolSize>& poolSizes, UInt32 maxSets);
+		VulkanDescriptorPool(VulkanDevice& d, const vector<VkDescriptorPoolSize>& poolSizes, UInt32 maxSets, VkDescriptorPoolCreateFlags flags = 0);
 		~VulkanDescriptorPool();
 		SG_CLASS_NO_COPY_ASSIGNABLE(VulkanDescriptorPool);
 
@@ -31,16 +32,19 @@ namespace SG
 		public:
 			Builder& AddPoolElement(EDescriptorType type, UInt32 count);
 			Builder& SetMaxSets(UInt32 max);
+			//! Allow the sets to be freed one by one by FreeDescriptorSet().
+			Builder& SetFreeDescriptorSet();
 			VulkanDescriptorPool* Build(VulkanDevice& d);
 		private:
 			vector<VkDescriptorPoolSize> poolSizes;
 			UInt32 maxSets;
+			VkDescriptorPoolCreateFlags flags = 0;
 		};
 	private:
 		bool AllocateDescriptorSet(const VkDescriptorSetLayout& layout, VulkanDescriptorSet& set);
 		void Reset();
 	private:
-		friend class VulkanDescriptorDataBinder;
+		friend class VulkanDescriptorCache;
 
 		VulkanDevice&    device;
 		VkDescriptorPool pool;
@@ -67,9 +71,11 @@ namespace SG
 	private:
 		friend class VulkanPipelineLayout;
 		friend class VulkanDescriptorDataBinder;
+		friend class VulkanDescriptorCache;
 
 		VulkanDevice&         device;
 		VkDescriptorSetLayout descriptorSetLayout;
+		UInt32                id; //!< Unique among all the layouts ever created.
 		eastl::unordered_map<UInt32, VkDescriptorSetLayoutBinding> bindingsMap;
 	};
 
@@ -83,9 +89,26 @@ namespace SG
 		friend class VulkanDescriptorPool;
 		friend class VulkanPipelineSignature;
 		friend class VulkanDescriptorDataBinder;
+		friend class VulkanDescriptorCache;
 		friend class VulkanCommandBuffer;
-		VkDescriptorSet set;
+		VkDescriptorSet set = VK_NULL_HANDLE;
 		UInt32          belongingSet = 0;
+		UInt32          cacheIndex = UInt32(-1); //!< The entry in VulkanDescriptorCache this set refers to.
+	};
+
+	//! The resource written to one binding of a descriptor set.
+	struct VulkanDescriptorBinding
+	{
+		UInt32                 binding;
+		VkDescriptorType       type;
+		UInt32                 count;
+		VkDescriptorBufferInfo bufferInfo = {};
+		VkDescriptorImageInfo  imageInfo = {};
+		UInt32                 resourceId = UInt32(-1); //!< Unique id of the buffer or the texture, see VulkanDescriptorCache::NewResourceId().
+		UInt32                 samplerId = UInt32(-1);
+
+		bool operator==(const VulkanDescriptorBinding& rhs) const;
+		bool operator!=(const VulkanDescriptorBinding& rhs) const { return !(*this == rhs); }
 	};
 
 	class VulkanBuffer;
@@ -95,25 +118,21 @@ namespace SG
 	class VulkanDescriptorDataBinder
 	{
 	public:
-		VulkanDescriptorDataBinder(VulkanDescriptorPool& pool, VulkanDescriptorSetLayout& layout);
+		VulkanDescriptorDataBinder(VulkanDescriptorCache& cache, VulkanDescriptorSetLayout& layout);
 		SG_CLASS_NO_COPY_ASSIGNABLE(VulkanDescriptorDataBinder);
 
 		VulkanDescriptorDataBinder& BindBuffer(UInt32 binding, const VulkanBuffer* info);
 		VulkanDescriptorDataBinder& BindImage(UInt32 binding, const VulkanSampler* pSampler, const VulkanTexture* pTexture);
 
+		//! Point the set to a set holding the bound data. A new set is only allocated and written if no cached set holds the same data.
 		bool Bind(VulkanDescriptorSet& set);
-	private:
+		//! Write the bound data into the set, only the bindings added to this binder are overwritten.
+		//! The sets sharing the data with this set are overwritten too.
 		void OverWriteData(VulkanDescriptorSet& set);
 	private:
-		VulkanDescriptorPool&        pool;
-		VulkanDescriptorSetLayout&   layout;
-		UInt32                       offset = 0;
-		vector<VkWriteDescriptorSet> writes;
-
-		eastl::array<VkDescriptorBufferInfo, 10> bufferInfos;
-		UInt32                                   currentBufferIndex = 0;
-		eastl::array<VkDescriptorImageInfo, 10>  imageInfos;
-		UInt32                                   currentImageIndex = 0;
+		VulkanDescriptorCache&          cache;
+		VulkanDescriptorSetLayout&      layout;
+		vector<VulkanDescriptorBinding> bindings;
 	};
 
 }
\ No newline at end of file
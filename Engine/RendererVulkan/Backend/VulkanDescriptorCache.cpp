@@ -0,0 +1,356 @@
+#include "StdAfx.h"
+#include "VulkanDescriptorCache.h"
+
+#include "System/Logger.h"
+#include "Memory/Memory.h"
+#include "Profile/Profile.h"
+
+#include "VulkanConfig.h"
+#include "VulkanDevice.h"
+
+#include "Stl/Hash.h"
+#include "Thread/Thread.h"
+
+namespace SG
+{
+
+	namespace // anonymous namespace
+	{
+		Atomic32 gNextResourceId; // the resources may be created on the job workers
+		bool _IsImageDescriptor(VkDescriptorType type)
+		{
+			return type == VK_DESCRIPTOR_TYPE_SAMPLER || type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+				type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+				type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		}
+
+		//! Insert the bindings of src into dst which is sorted by the binding, the same bindings in dst are replaced.
+		void _MergeBindings(vector<VulkanDescriptorBinding>& dst, const vector<VulkanDescriptorBinding>& src)
+		{
+			for (auto& binding : src)
+			{
+				auto pos = dst.begin();
+				while (pos != dst.end() && pos->binding < binding.binding)
+					++pos;
+				if (pos != dst.end() && pos->binding == binding.binding)
+					*pos = binding;
+				else
+					dst.insert(pos, binding);
+			}
+		}
+
+		Size _HashBindings(UInt32 layoutId, const vector<VulkanDescriptorBinding>& bindings)
+		{
+			Size hash = 0;
+			HashTypes(hash, layoutId);
+			for (auto& binding : bindings)
+			{
+				HashTypes(hash, binding.binding, (UInt32)binding.type, binding.count, binding.resourceId, binding.samplerId);
+				if (_IsImageDescriptor(binding.type))
+					HashTypes(hash, (UInt64)binding.imageInfo.sampler, (UInt64)binding.imageInfo.imageView, (UInt32)binding.imageInfo.imageLayout);
+				else
+					HashTypes(hash, (UInt64)binding.bufferInfo.buffer, (UInt64)binding.bufferInfo.offset, (UInt64)binding.bufferInfo.range);
+			}
+			return hash;
+		}
+	}
+
+	VulkanDescriptorCache::VulkanDescriptorCache(VulkanDevice& d, UInt32 numFrameInFlight)
+		:mDevice(d), mNumFrameInFlight(numFrameInFlight)
+	{
+	}
+
+	VulkanDescriptorCache::~VulkanDescriptorCache()
+	{
+		// the sets are freed with their pools
+		for (auto* pPool : mpPools)
+			Delete(pPool);
+
+		SG_LOG_DEBUG("Descriptor cache: %d sets written, %d bindings reused a cached set", mNumWrite, mNumHit);
+	}
+
+	bool VulkanDescriptorCache::Acquire(const VulkanDescriptorSetLayout& layout, const vector<VulkanDescriptorBinding>& bindings, VulkanDescriptorSet& set)
+	{
+		SG_PROFILE_FUNCTION();
+
+		vector<VulkanDescriptorBinding> sortedBindings;
+		_MergeBindings(sortedBindings, bindings);
+
+		// rebinding the same data to the set
+		if (set.cacheIndex != UInt32(-1))
+		{
+			const Entry& currEntry = mEntries[set.cacheIndex];
+			if (currEntry.layoutId == layout.id && currEntry.bindings == sortedBindings)
+			{
+				++mNumHit;
+				return true;
+			}
+		}
+
+		const Size hash = _HashBindings(layout.id, sortedBindings);
+		UInt32 index = UInt32(-1);
+		if (auto node = mHashedEntries.find(hash); node != mHashedEntries.end())
+		{
+			const Entry& entry = mEntries[node->second];
+			if (entry.layoutId == layout.id && entry.bindings == sortedBindings)
+			{
+				index = node->second;
+				++mNumHit;
+			}
+		}
+
+		if (index == UInt32(-1))
+		{
+			index = NewEntry(layout, eastl::move(sortedBindings), hash);
+			if (index == UInt32(-1))
+				return false;
+		}
+
+		Entry& entry = mEntries[index];
+		if (entry.refCount++ == 0 && entry.releasedFrame != 0)
+			UnlinkUnused(index);
+
+		Release(set);
+		set.set = entry.set;
+		set.cacheIndex = index;
+		return true;
+	}
+
+	void VulkanDescriptorCache::Overwrite(const vector<VulkanDescriptorBinding>& bindings, VulkanDescriptorSet& set)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (set.cacheIndex == UInt32(-1))
+		{
+			SG_LOG_WARN("Try to overwrite a descriptor set which had not been bound!");
+			return;
+		}
+
+		Entry& entry = mEntries[set.cacheIndex];
+		vector<VulkanDescriptorBinding> mergedBindings = entry.bindings;
+		_MergeBindings(mergedBindings, bindings);
+		if (mergedBindings == entry.bindings) // another set sharing this entry had overwritten it
+			return;
+
+		WriteSet(entry.set, bindings);
+
+		// find the entry by its new bindings
+		if (entry.bHashed)
+			mHashedEntries.erase(entry.hash);
+		entry.bindings = eastl::move(mergedBindings);
+		entry.hash = _HashBindings(entry.layoutId, entry.bindings);
+		entry.bHashed = mHashedEntries.find(entry.hash) == mHashedEntries.end();
+		if (entry.bHashed)
+			mHashedEntries[entry.hash] = set.cacheIndex;
+	}
+
+	void VulkanDescriptorCache::Release(VulkanDescriptorSet& set)
+	{
+		if (set.cacheIndex == UInt32(-1))
+			return;
+
+		Entry& entry = mEntries[set.cacheIndex];
+		SG_ASSERT(entry.refCount > 0);
+		if (--entry.refCount == 0)
+		{
+			// the command buffers of this frame may still use it
+			entry.releasedFrame = mCurrFrame + 1;
+			LinkUnused(set.cacheIndex);
+		}
+
+		set.set = VK_NULL_HANDLE;
+		set.cacheIndex = UInt32(-1);
+	}
+
+	UInt32 VulkanDescriptorCache::NewResourceId()
+	{
+		return static_cast<UInt32>(gNextResourceId.Increase());
+	}
+
+	void VulkanDescriptorCache::NextFrame()
+	{
+		++mCurrFrame;
+		EvictUnused(SG_MAX_UNUSED_DESCRIPTOR_SET);
+	}
+
+	UInt32 VulkanDescriptorCache::NewEntry(const VulkanDescriptorSetLayout& layout, vector<VulkanDescriptorBinding>&& bindings, Size hash)
+	{
+		Entry entry;
+		entry.layoutId = layout.id;
+		if (!AllocateSet(layout.descriptorSetLayout, entry))
+			return UInt32(-1);
+
+		WriteSet(entry.set, bindings);
+		entry.bindings = eastl::move(bindings);
+		entry.hash = hash;
+
+		UInt32 index;
+		if (!mFreeEntries.empty())
+		{
+			index = mFreeEntries.back();
+			mFreeEntries.pop_back();
+			mEntries[index] = eastl::move(entry);
+		}
+		else
+		{
+			index = static_cast<UInt32>(mEntries.size());
+			mEntries.push_back(eastl::move(entry));
+		}
+
+		// two different bindings may have the same hash, the later one can only be used by the sets bound to it.
+		auto& newEntry = mEntries[index];
+		newEntry.bHashed = mHashedEntries.find(hash) == mHashedEntries.end();
+		if (newEntry.bHashed)
+			mHashedEntries[hash] = index;
+		return index;
+	}
+
+	bool VulkanDescriptorCache::AllocateSet(VkDescriptorSetLayout layout, Entry& entry)
+	{
+		for (UInt32 i = 0; i < mpPools.size(); ++i)
+		{
+			const UInt32 poolIndex = (mCurrPool + i) % mpPools.size();
+			if (TryAllocateSet(poolIndex, layout, entry))
+			{
+				mCurrPool = poolIndex;
+				return true;
+			}
+		}
+
+		// all the pools are full, free the sets which are no longer used first
+		if (EvictUnused(0) != 0)
+		{
+			for (UInt32 i = 0; i < mpPools.size(); ++i)
+			{
+				if (TryAllocateSet(i, layout, entry))
+				{
+					mCurrPool = i;
+					return true;
+				}
+			}
+		}
+
+		auto* pPool = VulkanDescriptorPool::Builder()
+			.AddPoolElement(EDescriptorType::eUniform_Buffer, SG_DESCRIPTOR_POOL_MAX_SETS)
+			.AddPoolElement(EDescriptorType::eStorage_Buffer, SG_DESCRIPTOR_POOL_MAX_SETS)
+			.AddPoolElement(EDescriptorType::eSampler, SG_DESCRIPTOR_POOL_MAX_SETS)
+			.AddPoolElement(EDescriptorType::eCombine_Image_Sampler, SG_DESCRIPTOR_POOL_MAX_SETS)
+			.AddPoolElement(EDescriptorType::eInput_Attachment, SG_DESCRIPTOR_POOL_MAX_SETS)
+			.AddPoolElement(EDescriptorType::eSampled_Image, SG_DESCRIPTOR_POOL_MAX_SETS)
+			.AddPoolElement(EDescriptorType::eStorage_Image, SG_DESCRIPTOR_POOL_MAX_SETS)
+			.AddPoolElement(EDescriptorType::eUniform_Buffer_Dynamic, SG_DESCRIPTOR_POOL_MAX_SETS)
+			.AddPoolElement(EDescriptorType::eStorage_Buffer_Dynamic, SG_DESCRIPTOR_POOL_MAX_SETS)
+			.SetMaxSets(SG_DESCRIPTOR_POOL_MAX_SETS)
+			.SetFreeDescriptorSet()
+			.Build(mDevice);
+		if (!pPool)
+		{
+			SG_LOG_ERROR("Failed to create descriptor pool!");
+			return false;
+		}
+
+		mpPools.push_back(pPool);
+		mCurrPool = static_cast<UInt32>(mpPools.size() - 1);
+		if (!TryAllocateSet(mCurrPool, layout, entry))
+		{
+			SG_LOG_ERROR("Failed to allocate descriptor set!");
+			return false;
+		}
+		return true;
+	}
+
+	bool VulkanDescriptorCache::TryAllocateSet(UInt32 poolIndex, VkDescriptorSetLayout layout, Entry& entry)
+	{
+		VkDescriptorSetAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = mpPools[poolIndex]->pool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &layout;
+
+		// the pool is full (VK_ERROR_OUT_OF_POOL_MEMORY or VK_ERROR_FRAGMENTED_POOL), try another one.
+		if (vkAllocateDescriptorSets(mDevice.logicalDevice, &allocInfo, &entry.set) != VK_SUCCESS)
+			return false;
+		entry.poolIndex = poolIndex;
+		return true;
+	}
+
+	void VulkanDescriptorCache::WriteSet(VkDescriptorSet set, const vector<VulkanDescriptorBinding>& bindings)
+	{
+		vector<VkWriteDescriptorSet> writes(bindings.size());
+		for (UInt32 i = 0; i < bindings.size(); ++i)
+		{
+			auto& binding = bindings[i];
+			VkWriteDescriptorSet& write = writes[i];
+			write = {};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = set;
+			write.dstBinding = binding.binding;
+			write.dstArrayElement = 0;
+			write.descriptorType = binding.type;
+			write.descriptorCount = binding.count;
+			if (_IsImageDescriptor(binding.type))
+				write.pImageInfo = &binding.imageInfo;
+			else
+				write.pBufferInfo = &binding.bufferInfo;
+		}
+		vkUpdateDescriptorSets(mDevice.logicalDevice, static_cast<UInt32>(writes.size()), writes.data(), 0, nullptr);
+		++mNumWrite;
+	}
+
+	void VulkanDescriptorCache::LinkUnused(UInt32 index)
+	{
+		Entry& entry = mEntries[index];
+		entry.prevUnused = mLastUnused;
+		entry.nextUnused = UInt32(-1);
+		if (mLastUnused != UInt32(-1))
+			mEntries[mLastUnused].nextUnused = index;
+		else
+			mFirstUnused = index;
+		mLastUnused = index;
+		++mNumUnused;
+	}
+
+	void VulkanDescriptorCache::UnlinkUnused(UInt32 index)
+	{
+		Entry& entry = mEntries[index];
+		if (entry.prevUnused != UInt32(-1))
+			mEntries[entry.prevUnused].nextUnused = entry.nextUnused;
+		else
+			mFirstUnused = entry.nextUnused;
+		if (entry.nextUnused != UInt32(-1))
+			mEntries[entry.nextUnused].prevUnused = entry.prevUnused;
+		else
+			mLastUnused = entry.prevUnused;
+		entry.prevUnused = entry.nextUnused = UInt32(-1);
+		--mNumUnused;
+	}
+
+	UInt32 VulkanDescriptorCache::EvictUnused(UInt32 maxUnused)
+	{
+		UInt32 numEvicted = 0;
+		while (mNumUnused > maxUnused)
+		{
+			// the entries are released in order, if the first one is still in flight, so are the others.
+			const UInt32 index = mFirstUnused;
+			if (mEntries[index].releasedFrame + mNumFrameInFlight > mCurrFrame)
+				break;
+
+			UnlinkUnused(index);
+			FreeEntry(index);
+			++numEvicted;
+		}
+		return numEvicted;
+	}
+
+	void VulkanDescriptorCache::FreeEntry(UInt32 index)
+	{
+		Entry& entry = mEntries[index];
+		vkFreeDescriptorSets(mDevice.logicalDevice, mpPools[entry.poolIndex]->pool, 1, &entry.set);
+
+		if (entry.bHashed)
+			mHashedEntries.erase(entry.hash);
+		entry = Entry();
+		mFreeEntries.push_back(index);
+	}
+
+}
\ No newline at end of file
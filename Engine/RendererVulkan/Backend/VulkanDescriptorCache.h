@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+
+#include "VulkanDescriptor.h"
+
+#include "volk.h"
+
+#include "Stl/vector.h"
+#include "EASTL/hash_map.h"
+
+namespace SG
+{
+
+// number of the sets a descriptor pool of the cache can allocate, a new pool is created when all the pools are full.
+#define SG_DESCRIPTOR_POOL_MAX_SETS 1000
+// the most sets which are no longer referenced to be kept for reuse, the least recently released ones are freed beyond it.
+#define SG_MAX_UNUSED_DESCRIPTOR_SET 256
+
+	class VulkanDevice;
+
+	//! Descriptor sets shared by the same layout and the same bound resources.
+	//! A set is found by the hash of its layout and its bindings, so binding the same resources again neither allocates nor writes a set.
+	//! The sets which are no longer referenced stay in the cache to be reused, the least recently released ones are freed
+	//! when the pools are full or there are too many of them, once the frames in flight which may use them had finished.
+	class VulkanDescriptorCache
+	{
+	public:
+		VulkanDescriptorCache(VulkanDevice& d, UInt32 numFrameInFlight);
+		~VulkanDescriptorCache();
+		SG_CLASS_NO_COPY_ASSIGNABLE(VulkanDescriptorCache);
+
+		//! Point the set to the cached set holding the bindings, allocate and write one if there is not.
+		//! The cached set the set referred to before is released.
+		bool Acquire(const VulkanDescriptorSetLayout& layout, const vector<VulkanDescriptorBinding>& bindings, VulkanDescriptorSet& set);
+		//! Overwrite some bindings of the cached set the set refers to, all the sets sharing it see the new bindings.
+		void Overwrite(const vector<VulkanDescriptorBinding>& bindings, VulkanDescriptorSet& set);
+		//! The set no longer refers to the cached set, the cached set can be reused or freed.
+		void Release(VulkanDescriptorSet& set);
+
+		//! Unique among all the buffers, the textures and the samplers ever created. The cached sets are found by these ids
+		//! instead of the handles, as the handles of the destroyed resources may be reused by the new ones.
+		static UInt32 NewResourceId();
+
+		//! Call it once a frame after the fence of the frame had been waited.
+		//! The cached sets released a number of frames in flight ago are not used by the GPU anymore, and can be freed.
+		void NextFrame();
+	private:
+		struct Entry
+		{
+			VkDescriptorSet                 set = VK_NULL_HANDLE;
+			UInt32                          layoutId = UInt32(-1); //!< The handles of the destroyed layouts may be reused, so use the id.
+			UInt32                          poolIndex = 0;
+			Size                            hash = 0;
+			bool                            bHashed = false; //!< Can be found by the hash. It can not if another entry had the same hash.
+			vector<VulkanDescriptorBinding> bindings;        //!< Sorted by the binding.
+			UInt32                          refCount = 0;
+			UInt64                          releasedFrame = 0;
+			UInt32                          prevUnused = UInt32(-1); //!< Links of the unreferenced entries, from the least recently released one.
+			UInt32                          nextUnused = UInt32(-1);
+		};
+
+		UInt32 NewEntry(const VulkanDescriptorSetLayout& layout, vector<VulkanDescriptorBinding>&& bindings, Size hash);
+		bool   AllocateSet(VkDescriptorSetLayout layout, Entry& entry);
+		bool   TryAllocateSet(UInt32 poolIndex, VkDescriptorSetLayout layout, Entry& entry);
+		void   WriteSet(VkDescriptorSet set, const vector<VulkanDescriptorBinding>& bindings);
+
+		void   LinkUnused(UInt32 index);
+		void   UnlinkUnused(UInt32 index);
+		//! Free the least recently released entries until at most maxUnused of them are left.
+		//! Return the number of the entries freed, the ones may still be used by the GPU are never freed.
+		UInt32 EvictUnused(UInt32 maxUnused);
+		void   FreeEntry(UInt32 index);
+	private:
+		VulkanDevice& mDevice;
+		UInt32        mNumFrameInFlight;
+		UInt64        mCurrFrame = 0;
+
+		vector<VulkanDescriptorPool*> mpPools;
+		UInt32                        mCurrPool = 0;
+
+		vector<Entry>                  mEntries;
+		vector<UInt32>                 mFreeEntries;    //!< Indices of the slots of the freed entries.
+		eastl::hash_map<Size, UInt32>  mHashedEntries;  //!< Hash of layout and bindings -> entry.
+		UInt32                         mFirstUnused = UInt32(-1);
+		UInt32                         mLastUnused = UInt32(-1);
+		UInt32                         mNumUnused = 0;
+
+		UInt32 mNumHit = 0;
+		UInt32 mNumWrite = 0;
+	};
+
+}
\ No newline at end of file
@@ -8,10 +8,11 @@
 #include "VulkanBuffer.h"
 #include "VulkanCommand.h"
 #include "VulkanQueue.h"
+#include "VulkanPipelineCache.h"
 #include "RendererVulkan/Utils/VkConvert.h"
 
 #include "Stl/vector.h"
-#include <eastl/array.h>
+#include <EASTL/array.h>
 
 namespace SG
 {
@@ -41,10 +42,18 @@ namespace SG
 		CreateLogicalDevice(nullptr);
 
 		volkLoadDevice(logicalDevice);
+
+		PipelineCacheDeviceInfo pipelineCacheDeviceInfo = {};
+		pipelineCacheDeviceInfo.vendorID = physicalDeviceProps.vendorID;
+		pipelineCacheDeviceInfo.deviceID = physicalDeviceProps.deviceID;
+		pipelineCacheDeviceInfo.driverVersion = physicalDeviceProps.driverVersion;
+		memcpy(pipelineCacheDeviceInfo.pipelineCacheUUID, physicalDeviceProps.pipelineCacheUUID, VK_UUID_SIZE);
+		pPipelineCache = New(VulkanPipelineCache, *this, pipelineCacheDeviceInfo);
 	}
 
 	VulkanDevice::~VulkanDevice()
 	{
+		Delete(pPipelineCache);
 		if (logicalDevice != VK_NULL_HANDLE)
 			DestroyLogicalDevice();
 	}
@@ -12,7 +12,7 @@
 
 #include <Stl/vector.h>
 #include <Stl/string.h>
-#include "eastl/list.h"
+#include "EASTL/list.h"
 
 namespace SG
 {
@@ -22,6 +22,7 @@ namespace SG
 	class VulkanRenderTarget;
 	class VulkanRenderContext;
 	class VulkanQueue;
+	class VulkanPipelineCache;
 
 	//! @brief All the device relative data are stored in here.
 	//! Should be initialized by VulkanInstace.
@@ -39,6 +40,9 @@ namespace SG
 		VkPhysicalDeviceLimits          physicalDeviceLimits;
 		VkPhysicalDeviceFeatures        physicalDeviceFeatures;
 
+		//! Shared by all the pipelines created on this device, persisted between the runs.
+		VulkanPipelineCache*            pPipelineCache = nullptr;
+
 		struct
 		{
 			UInt32 graphics;
@@ -8,6 +8,7 @@
 #include "RendererVulkan/Utils/VkConvert.h"
 
 #include "Stl/vector.h"
+#include "Stl/Hash.h"
 
 namespace SG
 {
@@ -32,6 +33,36 @@ namespace SG
 			attachDesc.finalLayout   = ToVkImageLayout(dstStatus);
 
 			//transitions.emplace_back(pRenderTarget, attachDesc.initialLayout, attachDesc.finalLayout);
+
+			// the implicit external dependencies of a render pass do not wait for the shaders, nor make the writes visible to them.
+			// the render graph brings the attachment from or to its shader read status by the render pass itself,
+			// so the render pass has to wait for the shaders reading the old content, and the shaders reading the new content have to wait for the render pass.
+			const VkAccessFlags srcAccess = ToVkAccessFlags(initStatus) & VK_ACCESS_SHADER_READ_BIT;
+			if (srcAccess != 0)
+			{
+				VkSubpassDependency dependency = {};
+				dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+				dependency.dstSubpass = 0;
+				dependency.srcStageMask = ToVkPipelineStageFlags(srcAccess, EQueueType::eGraphic);
+				dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+				dependency.srcAccessMask = 0; // write after read, only the execution needs to be ordered
+				dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+				AddDependency(dependency);
+			}
+
+			const VkAccessFlags dstAccess = ToVkAccessFlags(dstStatus) & VK_ACCESS_SHADER_READ_BIT;
+			if (dstAccess != 0)
+			{
+				VkSubpassDependency dependency = {};
+				dependency.srcSubpass = 0;
+				dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+				dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+				dependency.dstStageMask = ToVkPipelineStageFlags(dstAccess, EQueueType::eGraphic);
+				dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+				dependency.dstAccessMask = dstAccess;
+				AddDependency(dependency);
+			}
+
 			attachments.emplace_back(eastl::move(attachDesc));
 		}
 		else // depth render target
@@ -81,6 +112,17 @@ namespace SG
 		return *this;
 	}
 
+	void VulkanRenderPass::Builder::AddDependency(const VkSubpassDependency& dependency)
+	{
+		// the color attachments of a render pass share the same dependencies
+		for (auto& dep : dependencies)
+		{
+			if (memcmp(&dep, &dependency, sizeof(VkSubpassDependency)) == 0)
+				return;
+		}
+		dependencies.emplace_back(dependency);
+	}
+
 	VulkanRenderPass::Builder& VulkanRenderPass::Builder::CombineAsSubpass()
 	{
 		UInt32 index = 0;
@@ -150,6 +192,19 @@ namespace SG
 
 		VK_CHECK(vkCreateRenderPass(device.logicalDevice, &renderPassInfo, nullptr, &renderPass),
 			SG_LOG_ERROR("Failed to create renderPass!"););
+
+		// the render passes are compatible if their attachments have the same formats and sample counts and their subpasses are the same
+		compatibleHash = HashMemory(&renderPassInfo.attachmentCount, sizeof(UInt32));
+		for (auto& attachment : attachments)
+		{
+			const UInt32 attachmentData[2] = { (UInt32)attachment.format, (UInt32)attachment.samples };
+			compatibleHash = HashMemory(attachmentData, sizeof(attachmentData), compatibleHash);
+		}
+		for (auto& subpass : subpasses)
+		{
+			const UInt32 subpassData[3] = { subpass.inputAttachmentCount, subpass.colorAttachmentCount, subpass.pDepthStencilAttachment ? 1u : 0u };
+			compatibleHash = HashMemory(subpassData, sizeof(subpassData), compatibleHash);
+		}
 	}
 
 	VulkanRenderPass::~VulkanRenderPass()
@@ -42,6 +42,8 @@ namespace SG
 			 */
 			Builder& CombineAsSubpass(); // TODO: support multiple subpass (better for mobile GPU)
 			VulkanRenderPass* Build();
+		private:
+			void AddDependency(const VkSubpassDependency& dependency);
 		private:
 			VulkanDevice& device;
 			vector<VkAttachmentDescription> attachments;
@@ -54,10 +56,12 @@ namespace SG
 	private:
 		friend class VulkanCommandBuffer;
 		friend class VulkanPipeline;
+		friend class VulkanPipelineCache;
 		friend class VulkanFrameBuffer;
 
 		VulkanDevice& device;
 		VkRenderPass  renderPass;
+		UInt64        compatibleHash; //!< Hash of the states a pipeline depends on, the pipelines are compatible with the render passes of the same hash.
 	};
 
 	class VulkanFrameBuffer
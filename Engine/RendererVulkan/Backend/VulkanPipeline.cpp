@@ -1,20 +1,20 @@
-#include "Stdafx.h"
+#include "StdAfx.h"
 #include "VulkanPipeline.h"
 
 #include "VulkanConfig.h"
 #include "VulkanDescriptor.h"
 #include "VulkanFrameBuffer.h"
 #include "VulkanShader.h"
+#include "VulkanPipelineCache.h"
 
 #include "Render/Buffer.h"
 #include "System/Logger.h"
 #include "Memory/Memory.h"
+#include "Stl/Hash.h"
 
 namespace SG
 {
 
-	static VkPipelineCache gCommonPipelineCache = VK_NULL_HANDLE;
-
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// VulkanPipelineLayout
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -22,7 +22,19 @@ namespace SG
 	VulkanPipelineLayout::Builder& VulkanPipelineLayout::Builder::AddDescriptorSetLayout(VulkanDescriptorSetLayout* layout)
 	{
 		if (layout)
+		{
 			descriptorLayouts.emplace_back(layout->descriptorSetLayout);
+
+			// the bindings map is not ordered, sum the hash of the bindings up
+			UInt64 setHash = 0;
+			for (auto& binding : layout->bindingsMap)
+			{
+				const UInt32 bindingData[4] = { binding.second.binding, (UInt32)binding.second.descriptorType,
+					binding.second.descriptorCount, (UInt32)binding.second.stageFlags };
+				setHash += HashMemory(bindingData, sizeof(bindingData));
+			}
+			hash = HashMemory(&setHash, sizeof(UInt64), hash);
+		}
 		return *this;
 	}
 
@@ -50,16 +62,17 @@ namespace SG
 		pushConstantRange.stageFlags = ToVkShaderStageFlags(stage);
 
 		pushConstantRanges.emplace_back(pushConstantRange);
+		hash = HashMemory(&pushConstantRange, sizeof(VkPushConstantRange), hash);
 		return *this;
 	}
 
 	RefPtr<VulkanPipelineLayout> VulkanPipelineLayout::Builder::Build()
 	{
-		return MakeRef<VulkanPipelineLayout>(device, descriptorLayouts, pushConstantRanges);
+		return MakeRef<VulkanPipelineLayout>(device, descriptorLayouts, pushConstantRanges, hash);
 	}
 
-	VulkanPipelineLayout::VulkanPipelineLayout(VulkanDevice& d, const vector<VkDescriptorSetLayout>& layouts, const vector<VkPushConstantRange>& pushConstant)
-		:device(d)
+	VulkanPipelineLayout::VulkanPipelineLayout(VulkanDevice& d, const vector<VkDescriptorSetLayout>& layouts, const vector<VkPushConstantRange>& pushConstant, UInt64 h)
+		:device(d), hash(h)
 	{
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -82,15 +95,15 @@ namespace SG
 	/// VulkanPipeline
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	VulkanPipeline::VulkanPipeline(VulkanDevice& d, const GraphicPipelineCreateInfo& CI, RefPtr<VulkanPipelineLayout> pLayout, VulkanRenderPass* pRenderPass, RefPtr<VulkanShader> pShader)
+	VulkanPipeline::VulkanPipeline(VulkanDevice& d, const GraphicPipelineCreateInfo& CI, RefPtr<VulkanPipelineLayout> pLayout, VulkanRenderPass* pRenderPass, RefPtr<VulkanShader> pShader, UInt64 key)
 		:device(d), pipelineType(EPipelineType::eGraphic)
 	{
-		if (gCommonPipelineCache == VK_NULL_HANDLE)
+		device.pPipelineCache->RecordPipeline(key);
+		pipeline = device.pPipelineCache->TakePrewarmed(key);
+		if (pipeline != VK_NULL_HANDLE)
 		{
-			VkPipelineCacheCreateInfo createInfo = {};
-			createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-			VK_CHECK(vkCreatePipelineCache(device.logicalDevice, &createInfo, nullptr, &gCommonPipelineCache),
-				SG_LOG_ERROR("Failed to create pipeline cache!"); gCommonPipelineCache = VK_NULL_HANDLE;);
+			pShader->ReleaseShaderBinary();
+			return;
 		}
 
 		VkGraphicsPipelineCreateInfo graphicPipelineCreateInfo = {};
@@ -115,21 +128,21 @@ namespace SG
 		graphicPipelineCreateInfo.pDynamicState       = &CI.dynamicStateCI;
 		graphicPipelineCreateInfo.subpass = 0;
 
-		VK_CHECK(vkCreateGraphicsPipelines(device.logicalDevice, gCommonPipelineCache, 1, &graphicPipelineCreateInfo, nullptr, &pipeline),
+		VK_CHECK(vkCreateGraphicsPipelines(device.logicalDevice, device.pPipelineCache->GetHandle(), 1, &graphicPipelineCreateInfo, nullptr, &pipeline),
 			SG_LOG_ERROR("Failed to create graphics pipeline!"););
 
 		pShader->DestroyPipelineShader();
 	}
 
-	VulkanPipeline::VulkanPipeline(VulkanDevice& d, RefPtr<VulkanPipelineLayout> pLayout, RefPtr<VulkanShader> pShader)
+	VulkanPipeline::VulkanPipeline(VulkanDevice& d, RefPtr<VulkanPipelineLayout> pLayout, RefPtr<VulkanShader> pShader, UInt64 key)
 		:device(d), pipelineType(EPipelineType::eCompute)
 	{
-		if (gCommonPipelineCache == VK_NULL_HANDLE)
+		device.pPipelineCache->RecordPipeline(key);
+		pipeline = device.pPipelineCache->TakePrewarmed(key);
+		if (pipeline != VK_NULL_HANDLE)
 		{
-			VkPipelineCacheCreateInfo createInfo = {};
-			createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-			VK_CHECK(vkCreatePipelineCache(device.logicalDevice, &createInfo, nullptr, &gCommonPipelineCache),
-				SG_LOG_ERROR("Failed to create pipeline cache!"); gCommonPipelineCache = VK_NULL_HANDLE;);
+			pShader->ReleaseShaderBinary();
+			return;
 		}
 
 		VkComputePipelineCreateInfo computePipelineCreateInfo = {};
@@ -140,7 +153,7 @@ namespace SG
 		pShader->CreatePipelineShader();
 
 		computePipelineCreateInfo.stage = pShader->GetShaderStagesCI()[0];
-		VK_CHECK(vkCreateComputePipelines(device.logicalDevice, gCommonPipelineCache, 1, &computePipelineCreateInfo, nullptr, &pipeline),
+		VK_CHECK(vkCreateComputePipelines(device.logicalDevice, device.pPipelineCache->GetHandle(), 1, &computePipelineCreateInfo, nullptr, &pipeline),
 			SG_LOG_ERROR("Failed to create compute pipeline!"););
 
 		pShader->DestroyPipelineShader();
@@ -148,11 +161,6 @@ namespace SG
 
 	VulkanPipeline::~VulkanPipeline()
 	{
-		if (gCommonPipelineCache != VK_NULL_HANDLE)
-		{
-			vkDestroyPipelineCache(device.logicalDevice, gCommonPipelineCache, nullptr);
-			gCommonPipelineCache = VK_NULL_HANDLE;
-		}
 		vkDestroyPipeline(device.logicalDevice, pipeline, nullptr);
 	}
 
@@ -364,23 +372,48 @@ namespace SG
 		return *this;
 	}
 
-	VulkanPipeline* VulkanPipeline::Builder::Build()
+	UInt64 VulkanPipeline::Builder::Finalize()
 	{
 		if (pipelineType == EPipelineType::eGraphic)
 		{
-			VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = {};
-			pipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-			pipelineColorBlendStateCreateInfo.attachmentCount = static_cast<UInt32>(createInfos.colorBlends.size());
-			pipelineColorBlendStateCreateInfo.pAttachments = createInfos.colorBlends.data();
+			if (!bFinalized) // the vertex layout can only be appended once
+			{
+				VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = {};
+				pipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+				pipelineColorBlendStateCreateInfo.attachmentCount = static_cast<UInt32>(createInfos.colorBlends.size());
+				pipelineColorBlendStateCreateInfo.pAttachments = createInfos.colorBlends.data();
+
+				createInfos.colorBlendCI = eastl::move(pipelineColorBlendStateCreateInfo);
+
+				SetVertexLayout(pShader->GetAttributesLayout(EShaderStage::efVert));
+				bFinalized = true;
+			}
+			return VulkanPipelineCache::HashGraphicPipeline(createInfos, pShader->GetBinaryHash(), pLayout->hash, pRenderPass->compatibleHash);
+		}
+		return VulkanPipelineCache::HashComputePipeline(pShader->GetBinaryHash(), pLayout->hash);
+	}
 
-			createInfos.colorBlendCI = eastl::move(pipelineColorBlendStateCreateInfo);
+	VulkanPipeline::Builder& VulkanPipeline::Builder::Prewarm()
+	{
+		const UInt64 key = Finalize();
+		if (pipelineType == EPipelineType::eGraphic)
+			device.pPipelineCache->PrewarmGraphic(key, createInfos, pLayout, pRenderPass, pShader);
+		else if (pipelineType == EPipelineType::eCompute)
+			device.pPipelineCache->PrewarmCompute(key, pLayout, pShader);
+		return *this;
+	}
 
-			SetVertexLayout(pShader->GetAttributesLayout(EShaderStage::efVert));
-			return New(VulkanPipeline, device, createInfos, pLayout, pRenderPass, pShader);
+	VulkanPipeline* VulkanPipeline::Builder::Build()
+	{
+		if (pipelineType == EPipelineType::eGraphic)
+		{
+			const UInt64 key = Finalize();
+			return New(VulkanPipeline, device, createInfos, pLayout, pRenderPass, pShader, key);
 		}
 		else if (pipelineType == EPipelineType::eCompute)
 		{
-			return New(VulkanPipeline, device, pLayout, pShader);
+			const UInt64 key = Finalize();
+			return New(VulkanPipeline, device, pLayout, pShader, key);
 		}
 		return nullptr;
 	}
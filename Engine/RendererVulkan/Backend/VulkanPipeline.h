@@ -9,7 +9,7 @@
 
 #include "Stl/vector.h"
 #include "Stl/SmartPtr.h"
-#include <eastl/utility.h>
+#include <EASTL/utility.h>
 
 namespace SG
 {
@@ -20,7 +20,7 @@ namespace SG
 	class VulkanPipelineLayout
 	{
 	public:
-		VulkanPipelineLayout(VulkanDevice& d, const vector<VkDescriptorSetLayout>& layouts, const vector<VkPushConstantRange>& pushConstant);
+		VulkanPipelineLayout(VulkanDevice& d, const vector<VkDescriptorSetLayout>& layouts, const vector<VkPushConstantRange>& pushConstant, UInt64 hash);
 		~VulkanPipelineLayout();
 
 		class Builder
@@ -36,13 +36,16 @@ namespace SG
 			VulkanDevice& device;
 			vector<VkDescriptorSetLayout> descriptorLayouts;
 			vector<VkPushConstantRange>   pushConstantRanges;
+			UInt64                        hash = 0;
 		};
 	private:
 		friend class VulkanPipeline;
+		friend class VulkanPipelineCache;
 		friend class VulkanCommandBuffer;
 
 		VulkanDevice&    device;
 		VkPipelineLayout layout;
+		UInt64           hash; //!< Hash of the bindings of the set layouts and the push constant ranges, stable between the runs.
 	};
 
 	class VulkanShader;
@@ -67,8 +70,8 @@ namespace SG
 			VkPipelineDynamicStateCreateInfo       dynamicStateCI;
 		};
 
-		VulkanPipeline(VulkanDevice& d, const GraphicPipelineCreateInfo& CI, RefPtr<VulkanPipelineLayout> pLayout, VulkanRenderPass* pRenderPass, RefPtr<VulkanShader> pShader);
-		VulkanPipeline(VulkanDevice& d, RefPtr<VulkanPipelineLayout> pLayout, RefPtr<VulkanShader> pShader);
+		VulkanPipeline(VulkanDevice& d, const GraphicPipelineCreateInfo& CI, RefPtr<VulkanPipelineLayout> pLayout, VulkanRenderPass* pRenderPass, RefPtr<VulkanShader> pShader, UInt64 key);
+		VulkanPipeline(VulkanDevice& d, RefPtr<VulkanPipelineLayout> pLayout, RefPtr<VulkanShader> pShader, UInt64 key);
 		~VulkanPipeline();
 
 		class Builder
@@ -94,9 +97,14 @@ namespace SG
 			Builder& BindSignature(RefPtr<VulkanPipelineSignature> pSignature, bool bWithDifferentShader = false);
 			Builder& BindShader(RefPtr<VulkanShader> pShader);
 
+			//! Start to build the pipeline on the job workers, Build() with the same states takes it instead of building another one.
+			//! Use it to build several pipelines at the same time.
+			Builder& Prewarm();
 			VulkanPipeline* Build();
 		private:
 			Builder& SetVertexLayout(const ShaderAttributesLayout& layout);
+			//! Fill the states depending on the others, and return the key of the pipeline in the pipeline cache.
+			UInt64   Finalize();
 		private:
 			VulkanDevice& device;
 			GraphicPipelineCreateInfo createInfos;
@@ -104,6 +112,7 @@ namespace SG
 			VulkanRenderPass*     pRenderPass;
 			RefPtr<VulkanShader>  pShader = nullptr;
 			EPipelineType         pipelineType;
+			bool                  bFinalized = false;
 		};
 	private:
 		friend class VulkanCommandBuffer;
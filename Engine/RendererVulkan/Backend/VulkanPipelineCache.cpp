@@ -0,0 +1,260 @@
+#include "StdAfx.h"
+#include "VulkanPipelineCache.h"
+
+#include "System/Logger.h"
+#include "System/FileSystem.h"
+#include "Memory/Memory.h"
+#include "Profile/Profile.h"
+
+#include "VulkanConfig.h"
+#include "VulkanDevice.h"
+#include "VulkanFrameBuffer.h"
+#include "VulkanShader.h"
+
+#include <EASTL/sort.h>
+
+namespace SG
+{
+
+	namespace // anonymous namespace
+	{
+		//! The create infos point to their own vectors, repoint them after copied.
+		void _RepointCreateInfos(VulkanPipeline::GraphicPipelineCreateInfo& CI)
+		{
+			if (CI.vertexInputCI.vertexBindingDescriptionCount != 0)
+				CI.vertexInputCI.pVertexBindingDescriptions = CI.vertexInputBindingDesc.data();
+			CI.vertexInputCI.pVertexAttributeDescriptions = CI.vertexInputAttributs.data();
+			CI.colorBlendCI.pAttachments = CI.colorBlends.data();
+			CI.dynamicStateCI.pDynamicStates = CI.dynamicStates.data();
+		}
+	}
+
+	VulkanPipelineCache::VulkanPipelineCache(VulkanDevice& d, const PipelineCacheDeviceInfo& deviceInfo)
+		:mDevice(d), mDeviceInfo(deviceInfo)
+	{
+		SG_PROFILE_FUNCTION();
+
+		Load();
+	}
+
+	VulkanPipelineCache::~VulkanPipelineCache()
+	{
+		SG_PROFILE_FUNCTION();
+
+		// the prewarmed pipelines which are never taken
+		for (auto& node : mPrewarmJobs)
+		{
+			PrewarmJob* pJob = node.second;
+			JobSystem::CompleteAndDispose(pJob->handle);
+			if (pJob->pipeline != VK_NULL_HANDLE)
+				vkDestroyPipeline(mDevice.logicalDevice, pJob->pipeline, nullptr);
+			Delete(pJob);
+		}
+		mPrewarmJobs.clear();
+
+		Save();
+		SG_LOG_INFO("Pipeline cache: %d of %d pipelines had been built in the previous runs", mNumWarmBuilt, mNumWarmBuilt + mNumColdBuilt);
+
+		if (mPipelineCache != VK_NULL_HANDLE)
+			vkDestroyPipelineCache(mDevice.logicalDevice, mPipelineCache, nullptr);
+	}
+
+	bool VulkanPipelineCache::RecordPipeline(UInt64 key)
+	{
+		const bool bWarm = mWarmKeys.find(key) != mWarmKeys.end();
+		if (mBuiltKeys.insert(key).second)
+		{
+			if (bWarm)
+				++mNumWarmBuilt;
+			else
+				++mNumColdBuilt;
+		}
+		return bWarm;
+	}
+
+	void VulkanPipelineCache::PrewarmGraphic(UInt64 key, const VulkanPipeline::GraphicPipelineCreateInfo& CI, RefPtr<VulkanPipelineLayout> pLayout, VulkanRenderPass* pRenderPass, RefPtr<VulkanShader> pShader)
+	{
+		if (mPrewarmJobs.find(key) != mPrewarmJobs.end()) // already prewarming
+			return;
+
+		PrewarmJob* pJob = New(PrewarmJob);
+		pJob->pipelineType = EPipelineType::eGraphic;
+		pJob->createInfos = CI;
+		_RepointCreateInfos(pJob->createInfos);
+		pJob->pLayout = pLayout;
+		pJob->renderPass = pRenderPass->renderPass;
+		pJob->pShader = pShader;
+		SchedulePrewarm(key, pJob);
+	}
+
+	void VulkanPipelineCache::PrewarmCompute(UInt64 key, RefPtr<VulkanPipelineLayout> pLayout, RefPtr<VulkanShader> pShader)
+	{
+		if (mPrewarmJobs.find(key) != mPrewarmJobs.end()) // already prewarming
+			return;
+
+		PrewarmJob* pJob = New(PrewarmJob);
+		pJob->pipelineType = EPipelineType::eCompute;
+		pJob->pLayout = pLayout;
+		pJob->renderPass = VK_NULL_HANDLE;
+		pJob->pShader = pShader;
+		SchedulePrewarm(key, pJob);
+	}
+
+	VkPipeline VulkanPipelineCache::TakePrewarmed(UInt64 key)
+	{
+		auto node = mPrewarmJobs.find(key);
+		if (node == mPrewarmJobs.end())
+			return VK_NULL_HANDLE;
+
+		PrewarmJob* pJob = node->second;
+		mPrewarmJobs.erase(node);
+
+		JobSystem::CompleteAndDispose(pJob->handle);
+		VkPipeline pipeline = pJob->pipeline;
+		if (pipeline == VK_NULL_HANDLE)
+			SG_LOG_WARN("Failed to prewarm the pipeline, build it again");
+		Delete(pJob);
+		return pipeline;
+	}
+
+	void VulkanPipelineCache::SchedulePrewarm(UInt64 key, PrewarmJob* pJob)
+	{
+		SG_PROFILE_FUNCTION();
+
+		pJob->pDevice = &mDevice;
+		pJob->pipelineCache = mPipelineCache;
+		// create the shader modules on this thread, the binary of the shader may be released by the pipelines built here while the job is running.
+		pJob->pShader->CreateShaderModules(pJob->shaderModules, pJob->shaderStagesCI);
+
+		pJob->handle = JobSystem::Schedule(BuildPrewarmPipeline, pJob);
+		mPrewarmJobs[key] = pJob;
+	}
+
+	void VulkanPipelineCache::BuildPrewarmPipeline(void* pUser)
+	{
+		SG_PROFILE_FUNCTION();
+
+		auto* pJob = reinterpret_cast<PrewarmJob*>(pUser);
+		VkDevice device = pJob->pDevice->logicalDevice;
+
+		if (pJob->pipelineType == EPipelineType::eGraphic)
+		{
+			const auto& CI = pJob->createInfos;
+
+			VkGraphicsPipelineCreateInfo graphicPipelineCreateInfo = {};
+			graphicPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			graphicPipelineCreateInfo.layout = pJob->pLayout->layout;
+			graphicPipelineCreateInfo.renderPass = pJob->renderPass;
+			graphicPipelineCreateInfo.stageCount = static_cast<UInt32>(pJob->shaderStagesCI.size());
+			graphicPipelineCreateInfo.pStages = pJob->shaderStagesCI.data();
+			graphicPipelineCreateInfo.pVertexInputState   = &CI.vertexInputCI;
+			graphicPipelineCreateInfo.pInputAssemblyState = &CI.inputAssemblyCI;
+			graphicPipelineCreateInfo.pRasterizationState = &CI.rasterizeStateCI;
+			graphicPipelineCreateInfo.pColorBlendState    = &CI.colorBlendCI;
+			graphicPipelineCreateInfo.pMultisampleState   = &CI.multiSampleStateCI;
+			graphicPipelineCreateInfo.pViewportState      = &CI.viewportStateCI;
+			graphicPipelineCreateInfo.pDepthStencilState  = &CI.depthStencilCI;
+			graphicPipelineCreateInfo.pDynamicState       = &CI.dynamicStateCI;
+			graphicPipelineCreateInfo.subpass = 0;
+
+			VK_CHECK(vkCreateGraphicsPipelines(device, pJob->pipelineCache, 1, &graphicPipelineCreateInfo, nullptr, &pJob->pipeline),
+				pJob->pipeline = VK_NULL_HANDLE;);
+		}
+		else if (pJob->pipelineType == EPipelineType::eCompute && !pJob->shaderStagesCI.empty())
+		{
+			VkComputePipelineCreateInfo computePipelineCreateInfo = {};
+			computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			computePipelineCreateInfo.layout = pJob->pLayout->layout;
+			computePipelineCreateInfo.stage = pJob->shaderStagesCI[0];
+
+			VK_CHECK(vkCreateComputePipelines(device, pJob->pipelineCache, 1, &computePipelineCreateInfo, nullptr, &pJob->pipeline),
+				pJob->pipeline = VK_NULL_HANDLE;);
+		}
+
+		for (auto& shaderModule : pJob->shaderModules)
+			vkDestroyShaderModule(device, shaderModule, nullptr);
+		pJob->shaderModules.clear();
+		pJob->shaderStagesCI.clear();
+	}
+
+	void VulkanPipelineCache::Load()
+	{
+		SG_PROFILE_FUNCTION();
+
+		vector<Byte> blob;
+		if (FileSystem::Open(EResourceDirectory::eShader_Binarires, SG_PIPELINE_CACHE_FILE_NAME, EFileMode::efRead_Binary))
+		{
+			blob.resize(FileSystem::FileSize());
+			if (FileSystem::Read(blob.data(), blob.size()) != blob.size())
+				blob.clear();
+			FileSystem::Close();
+		}
+
+		const Byte*   pDriverData = nullptr;
+		Size          driverDataSize = 0;
+		const UInt64* pKeys = nullptr;
+		UInt32        numKeys = 0;
+		if (!blob.empty() && !ValidateBlob(mDeviceInfo, blob.data(), blob.size(), pDriverData, driverDataSize, pKeys, numKeys))
+		{
+			SG_LOG_WARN("Pipeline cache is out of date or corrupted, all the pipelines will be built from scratch");
+			pDriverData = nullptr;
+			driverDataSize = 0;
+			numKeys = 0;
+		}
+
+		for (UInt32 i = 0; i < numKeys; ++i)
+			mWarmKeys.insert(pKeys[i]);
+
+		VkPipelineCacheCreateInfo createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		createInfo.initialDataSize = driverDataSize;
+		createInfo.pInitialData = pDriverData;
+		if (vkCreatePipelineCache(mDevice.logicalDevice, &createInfo, nullptr, &mPipelineCache) != VK_SUCCESS && driverDataSize != 0)
+		{
+			SG_LOG_WARN("Driver refused the pipeline cache data, all the pipelines will be built from scratch");
+			mWarmKeys.clear();
+			createInfo.initialDataSize = 0;
+			createInfo.pInitialData = nullptr;
+			VK_CHECK(vkCreatePipelineCache(mDevice.logicalDevice, &createInfo, nullptr, &mPipelineCache),
+				SG_LOG_ERROR("Failed to create pipeline cache!"); mPipelineCache = VK_NULL_HANDLE;);
+		}
+	}
+
+	void VulkanPipelineCache::Save()
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (mPipelineCache == VK_NULL_HANDLE)
+			return;
+
+		Size driverDataSize = 0;
+		VK_CHECK(vkGetPipelineCacheData(mDevice.logicalDevice, mPipelineCache, &driverDataSize, nullptr),
+			SG_LOG_WARN("Failed to get the pipeline cache data!"); return;);
+		vector<Byte> driverData(driverDataSize);
+		VK_CHECK(vkGetPipelineCacheData(mDevice.logicalDevice, mPipelineCache, &driverDataSize, driverData.data()),
+			SG_LOG_WARN("Failed to get the pipeline cache data!"); return;);
+
+		// the pipelines built in the previous runs are still in the driver data
+		vector<UInt64> keys;
+		keys.reserve(mWarmKeys.size() + mBuiltKeys.size());
+		keys.insert(keys.end(), mWarmKeys.begin(), mWarmKeys.end());
+		for (UInt64 key : mBuiltKeys)
+		{
+			if (mWarmKeys.find(key) == mWarmKeys.end())
+				keys.push_back(key);
+		}
+		eastl::sort(keys.begin(), keys.end());
+
+		const vector<Byte> blob = SerializeBlob(mDeviceInfo, keys, driverData.data(), driverDataSize);
+
+		FileSystem::ExistOrCreate(EResourceDirectory::eShader_Binarires, ""); // create ShaderBin folder if it doesn't exist
+		if (!FileSystem::Open(EResourceDirectory::eShader_Binarires, SG_PIPELINE_CACHE_FILE_NAME, EFileMode::efWrite_Binary))
+		{
+			SG_LOG_WARN("Failed to write pipeline cache: %s", SG_PIPELINE_CACHE_FILE_NAME);
+			return;
+		}
+		FileSystem::Write(blob.data(), blob.size());
+		FileSystem::Close();
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+#include "Thread/IJobSystem.h"
+
+#include "VulkanPipeline.h"
+
+#include "volk.h"
+
+#include "Stl/vector.h"
+#include "Stl/SmartPtr.h"
+#include "EASTL/hash_map.h"
+#include "EASTL/hash_set.h"
+
+namespace SG
+{
+
+// the pipeline cache file in the shader binaries folder, it is only valid for the driver which wrote it.
+#define SG_PIPELINE_CACHE_FILE_NAME "pipeline_cache.bin"
+
+	class VulkanDevice;
+	class VulkanRenderPass;
+	class VulkanShader;
+
+	//! The driver which produced a pipeline cache blob, the blob can only be fed back to the same driver.
+	struct PipelineCacheDeviceInfo
+	{
+		UInt32 vendorID;
+		UInt32 deviceID;
+		UInt32 driverVersion;
+		UInt8  pipelineCacheUUID[VK_UUID_SIZE];
+	};
+
+	//! Persistent VkPipelineCache shared by all the pipelines of the device.
+	//! The driver data is loaded from the disk when the device is created and written back when it is destroyed.
+	//! Pipelines are keyed by the hash of their states, their shaders' SPIR-V, their layout and the render pass they are compatible with.
+	//! The keys built are saved along with the driver data, so a pipeline is known to be warm if it was built in the previous runs.
+	class VulkanPipelineCache
+	{
+	public:
+		VulkanPipelineCache(VulkanDevice& d, const PipelineCacheDeviceInfo& deviceInfo);
+		~VulkanPipelineCache();
+		SG_CLASS_NO_COPY_ASSIGNABLE(VulkanPipelineCache);
+
+		VkPipelineCache GetHandle() const { return mPipelineCache; }
+
+		//! Record that the pipeline of the key is built, return true if it was built in the previous runs.
+		bool RecordPipeline(UInt64 key);
+
+		//! Start to build a pipeline on the job workers, the pipeline is taken by the VulkanPipeline built with the same key.
+		//! The layout, the render pass and the shader must be kept alive until the pipeline is taken.
+		void PrewarmGraphic(UInt64 key, const VulkanPipeline::GraphicPipelineCreateInfo& CI, RefPtr<VulkanPipelineLayout> pLayout, VulkanRenderPass* pRenderPass, RefPtr<VulkanShader> pShader);
+		void PrewarmCompute(UInt64 key, RefPtr<VulkanPipelineLayout> pLayout, RefPtr<VulkanShader> pShader);
+		//! Wait for the prewarmed pipeline of the key and take it, return VK_NULL_HANDLE if it had not been prewarmed.
+		//! Prewarm and take the pipelines on the same thread.
+		VkPipeline TakePrewarmed(UInt64 key);
+
+		//! Write the driver data and the keys built to the disk.
+		void Save();
+
+		//! The functions below do not touch the device, so they can be used without one.
+
+		static UInt64 HashGraphicPipeline(const VulkanPipeline::GraphicPipelineCreateInfo& CI, UInt64 shaderHash, UInt64 layoutHash, UInt64 renderPassHash);
+		static UInt64 HashComputePipeline(UInt64 shaderHash, UInt64 layoutHash);
+
+		//! Pack the driver data and the keys into a blob to be written to the disk.
+		static vector<Byte> SerializeBlob(const PipelineCacheDeviceInfo& deviceInfo, const vector<UInt64>& keys, const void* pDriverData, Size driverDataSize);
+		//! Check the blob is written by this version of the cache for the same driver, and its data is not corrupted.
+		//! The driver data and the keys point into the blob.
+		static bool ValidateBlob(const PipelineCacheDeviceInfo& deviceInfo, const Byte* pBlob, Size blobSize,
+			const Byte*& pDriverData, Size& driverDataSize, const UInt64*& pKeys, UInt32& numKeys);
+	private:
+		struct PrewarmJob
+		{
+			VulkanDevice*   pDevice;
+			VkPipelineCache pipelineCache;
+			EPipelineType   pipelineType;
+			VulkanPipeline::GraphicPipelineCreateInfo createInfos;
+			RefPtr<VulkanPipelineLayout> pLayout;
+			VkRenderPass    renderPass;
+			RefPtr<VulkanShader> pShader;
+			vector<VkShaderModule>                  shaderModules;
+			vector<VkPipelineShaderStageCreateInfo> shaderStagesCI;
+
+			VkPipeline      pipeline = VK_NULL_HANDLE;
+			SJobHandle      handle;
+		};
+
+		void Load();
+		void SchedulePrewarm(UInt64 key, PrewarmJob* pJob);
+		static void BuildPrewarmPipeline(void* pUser);
+	private:
+		VulkanDevice&           mDevice;
+		PipelineCacheDeviceInfo mDeviceInfo;
+		VkPipelineCache         mPipelineCache = VK_NULL_HANDLE;
+
+		eastl::hash_set<UInt64> mWarmKeys;  //!< Keys loaded from the disk.
+		eastl::hash_set<UInt64> mBuiltKeys; //!< Keys built in this run.
+		eastl::hash_map<UInt64, PrewarmJob*> mPrewarmJobs;
+
+		UInt32 mNumWarmBuilt = 0;
+		UInt32 mNumColdBuilt = 0;
+	};
+
+}
\ No newline at end of file
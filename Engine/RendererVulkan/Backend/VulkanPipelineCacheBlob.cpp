@@ -0,0 +1,166 @@
+#include "StdAfx.h"
+#include "VulkanPipelineCache.h"
+
+#include "Stl/Hash.h"
+
+#include <string.h>
+
+// the keys and the blobs of the pipeline cache, nothing here touches the device.
+namespace SG
+{
+
+	namespace // anonymous namespace
+	{
+		enum
+		{
+			SG_PIPELINE_CACHE_MAGIC = 0x43504753, // 'SGPC'
+			SG_PIPELINE_CACHE_VERSION = 1,
+		};
+
+		//! Followed by the keys and the driver data.
+		struct PipelineCacheFileHeader
+		{
+			UInt32 magic;
+			UInt32 version;
+			UInt32 vendorID;
+			UInt32 deviceID;
+			UInt32 driverVersion;
+			UInt32 numKeys;
+			UInt8  pipelineCacheUUID[VK_UUID_SIZE];
+			UInt64 driverDataSize;
+			UInt64 contentHash; //!< Hash of the keys and the driver data.
+		};
+		static_assert(sizeof(PipelineCacheFileHeader) % sizeof(UInt64) == 0, "The keys after the header must be aligned");
+
+		//! The header the driver puts in front of its data, the layout is given by the spec (VkPipelineCacheHeaderVersionOne).
+		struct DriverPipelineCacheHeader
+		{
+			UInt32 headerSize;
+			UInt32 headerVersion;
+			UInt32 vendorID;
+			UInt32 deviceID;
+			UInt8  pipelineCacheUUID[VK_UUID_SIZE];
+		};
+
+		template <typename T>
+		UInt64 _HashVector(const vector<T>& v, UInt64 prevHash)
+		{
+			const UInt32 count = static_cast<UInt32>(v.size());
+			prevHash = HashMemory(&count, sizeof(UInt32), prevHash);
+			return v.empty() ? prevHash : HashMemory(v.data(), v.size() * sizeof(T), prevHash);
+		}
+	}
+
+	UInt64 VulkanPipelineCache::HashGraphicPipeline(const VulkanPipeline::GraphicPipelineCreateInfo& CI, UInt64 shaderHash, UInt64 layoutHash, UInt64 renderPassHash)
+	{
+		const UInt64 pipelineData[4] = { (UInt64)EPipelineType::eGraphic, shaderHash, layoutHash, renderPassHash };
+		UInt64 hash = HashMemory(pipelineData, sizeof(pipelineData));
+
+		// only the states, the pointers and the structure types are left out
+		hash = _HashVector(CI.vertexInputBindingDesc, hash);
+		hash = _HashVector(CI.vertexInputAttributs, hash);
+		hash = _HashVector(CI.colorBlends, hash);
+		hash = _HashVector(CI.dynamicStates, hash);
+
+		const UInt32 stateData[] = {
+			CI.vertexInputCI.vertexBindingDescriptionCount,
+			(UInt32)CI.inputAssemblyCI.topology, CI.inputAssemblyCI.primitiveRestartEnable,
+			CI.rasterizeStateCI.depthClampEnable, CI.rasterizeStateCI.rasterizerDiscardEnable, (UInt32)CI.rasterizeStateCI.polygonMode,
+			(UInt32)CI.rasterizeStateCI.cullMode, (UInt32)CI.rasterizeStateCI.frontFace, CI.rasterizeStateCI.depthBiasEnable,
+			CI.colorBlendCI.logicOpEnable, (UInt32)CI.colorBlendCI.logicOp,
+			CI.viewportStateCI.viewportCount, CI.viewportStateCI.scissorCount,
+			CI.depthStencilCI.depthTestEnable, CI.depthStencilCI.depthWriteEnable, (UInt32)CI.depthStencilCI.depthCompareOp,
+			CI.depthStencilCI.depthBoundsTestEnable, CI.depthStencilCI.stencilTestEnable,
+			(UInt32)CI.multiSampleStateCI.rasterizationSamples, CI.multiSampleStateCI.sampleShadingEnable,
+			CI.multiSampleStateCI.alphaToCoverageEnable, CI.multiSampleStateCI.alphaToOneEnable,
+		};
+		hash = HashMemory(stateData, sizeof(stateData), hash);
+
+		const float factorData[] = {
+			CI.rasterizeStateCI.depthBiasConstantFactor, CI.rasterizeStateCI.depthBiasClamp, CI.rasterizeStateCI.depthBiasSlopeFactor, CI.rasterizeStateCI.lineWidth,
+			CI.colorBlendCI.blendConstants[0], CI.colorBlendCI.blendConstants[1], CI.colorBlendCI.blendConstants[2], CI.colorBlendCI.blendConstants[3],
+			CI.depthStencilCI.minDepthBounds, CI.depthStencilCI.maxDepthBounds,
+			CI.multiSampleStateCI.minSampleShading,
+		};
+		hash = HashMemory(factorData, sizeof(factorData), hash);
+
+		hash = HashMemory(&CI.depthStencilCI.front, sizeof(VkStencilOpState), hash);
+		hash = HashMemory(&CI.depthStencilCI.back, sizeof(VkStencilOpState), hash);
+		return hash;
+	}
+
+	UInt64 VulkanPipelineCache::HashComputePipeline(UInt64 shaderHash, UInt64 layoutHash)
+	{
+		const UInt64 pipelineData[3] = { (UInt64)EPipelineType::eCompute, shaderHash, layoutHash };
+		return HashMemory(pipelineData, sizeof(pipelineData));
+	}
+
+	vector<Byte> VulkanPipelineCache::SerializeBlob(const PipelineCacheDeviceInfo& deviceInfo, const vector<UInt64>& keys, const void* pDriverData, Size driverDataSize)
+	{
+		const Size keysSize = keys.size() * sizeof(UInt64);
+
+		PipelineCacheFileHeader header = {};
+		header.magic = SG_PIPELINE_CACHE_MAGIC;
+		header.version = SG_PIPELINE_CACHE_VERSION;
+		header.vendorID = deviceInfo.vendorID;
+		header.deviceID = deviceInfo.deviceID;
+		header.driverVersion = deviceInfo.driverVersion;
+		header.numKeys = static_cast<UInt32>(keys.size());
+		memcpy(header.pipelineCacheUUID, deviceInfo.pipelineCacheUUID, VK_UUID_SIZE);
+		header.driverDataSize = driverDataSize;
+		header.contentHash = HashMemory(pDriverData, driverDataSize, HashMemory(keys.data(), keysSize));
+
+		vector<Byte> blob(sizeof(PipelineCacheFileHeader) + keysSize + driverDataSize);
+		memcpy(blob.data(), &header, sizeof(PipelineCacheFileHeader));
+		if (keysSize != 0)
+			memcpy(blob.data() + sizeof(PipelineCacheFileHeader), keys.data(), keysSize);
+		if (driverDataSize != 0)
+			memcpy(blob.data() + sizeof(PipelineCacheFileHeader) + keysSize, pDriverData, driverDataSize);
+		return blob;
+	}
+
+	bool VulkanPipelineCache::ValidateBlob(const PipelineCacheDeviceInfo& deviceInfo, const Byte* pBlob, Size blobSize,
+		const Byte*& pDriverData, Size& driverDataSize, const UInt64*& pKeys, UInt32& numKeys)
+	{
+		if (blobSize < sizeof(PipelineCacheFileHeader))
+			return false;
+
+		PipelineCacheFileHeader header;
+		memcpy(&header, pBlob, sizeof(PipelineCacheFileHeader));
+		if (header.magic != SG_PIPELINE_CACHE_MAGIC || header.version != SG_PIPELINE_CACHE_VERSION)
+			return false;
+		// the driver data is only valid for the driver which wrote it
+		if (header.vendorID != deviceInfo.vendorID || header.deviceID != deviceInfo.deviceID || header.driverVersion != deviceInfo.driverVersion ||
+			memcmp(header.pipelineCacheUUID, deviceInfo.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+			return false;
+
+		const UInt64 keysSize = (UInt64)header.numKeys * sizeof(UInt64);
+		const UInt64 contentSize = blobSize - sizeof(PipelineCacheFileHeader);
+		if (keysSize > contentSize || header.driverDataSize != contentSize - keysSize)
+			return false;
+
+		const Byte* pContent = pBlob + sizeof(PipelineCacheFileHeader);
+		if (HashMemory(pContent + keysSize, (Size)header.driverDataSize, HashMemory(pContent, (Size)keysSize)) != header.contentHash)
+			return false;
+
+		if (header.driverDataSize != 0)
+		{
+			DriverPipelineCacheHeader driverHeader;
+			if (header.driverDataSize < sizeof(DriverPipelineCacheHeader))
+				return false;
+			memcpy(&driverHeader, pContent + keysSize, sizeof(DriverPipelineCacheHeader));
+			if (driverHeader.headerSize < sizeof(DriverPipelineCacheHeader) || driverHeader.headerSize > header.driverDataSize ||
+				driverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+				driverHeader.vendorID != deviceInfo.vendorID || driverHeader.deviceID != deviceInfo.deviceID ||
+				memcmp(driverHeader.pipelineCacheUUID, deviceInfo.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+				return false;
+		}
+
+		pKeys = reinterpret_cast<const UInt64*>(pContent);
+		numKeys = header.numKeys;
+		pDriverData = pContent + keysSize;
+		driverDataSize = (Size)header.driverDataSize;
+		return true;
+	}
+
+}
\ No newline at end of file
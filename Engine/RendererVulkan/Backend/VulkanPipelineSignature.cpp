@@ -2,17 +2,52 @@
 #include "VulkanPipelineSignature.h"
 
 #include "Render/Shader/Shader.h"
+#include "Profile/Profile.h"
 
 #include "RendererVulkan/Backend/VulkanContext.h"
 #include "RendererVulkan/Backend/VulkanShader.h"
 #include "RendererVulkan/Backend/VulkanDescriptor.h"
+#include "RendererVulkan/Backend/VulkanDescriptorCache.h"
 #include "RendererVulkan/Backend/VulkanPipeline.h"
 #include "RendererVulkan/Backend/VulkanTexture.h"
+#include "RendererVulkan/Backend/VulkanBuffer.h"
 #include "RendererVulkan/Resource/RenderResourceRegistry.h"
 
+#include "EASTL/algorithm.h"
+
 namespace SG
 {
 
+	namespace // anonymous namespace
+	{
+		//! All the alive pipeline signatures, to rebind the buffers which are recreated.
+		vector<VulkanPipelineSignature*> gAlivePipelineSignatures;
+
+		bool _FindBufferBinding(VulkanShader& shader, const string& name, UInt32 setIndex, UInt32& outBinding)
+		{
+			auto& uboLayout = shader.GetUniformBufferLayout();
+			for (auto& uboData : uboLayout)
+			{
+				if (uboData.first == name && GetSet(uboData.second.setbinding) == setIndex)
+				{
+					outBinding = GetBinding(uboData.second.setbinding);
+					return true;
+				}
+			}
+
+			auto& ssboLayout = shader.GetStorageBufferLayout();
+			for (auto& ssboData : ssboLayout)
+			{
+				if (ssboData.first == name && GetSet(ssboData.second.setbinding) == setIndex)
+				{
+					outBinding = GetBinding(ssboData.second.setbinding);
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+
 	VulkanPipelineSignature::Builder& VulkanPipelineSignature::Builder::AddCombindSamplerImage(const char* samplerName, const char* textureName)
 	{
 		mCombineImages.emplace_back(samplerName, textureName);
@@ -223,6 +258,72 @@ namespace SG
 		{
 			SG_LOG_WARN("The number of textures pass in the shader do not match the number of the bindings!");
 		}
+
+		gAlivePipelineSignatures.push_back(this);
+	}
+
+	VulkanPipelineSignature::~VulkanPipelineSignature()
+	{
+		for (auto& setData : mDescriptorSetData)
+		{
+			for (auto& descriptorSet : setData.second.descriptorSets)
+				mContext.pDescriptorCache->Release(descriptorSet);
+		}
+
+		auto node = eastl::find(gAlivePipelineSignatures.begin(), gAlivePipelineSignatures.end(), this);
+		if (node != gAlivePipelineSignatures.end())
+			gAlivePipelineSignatures.erase(node);
+	}
+
+	void VulkanPipelineSignature::RebindBuffer(const string& name)
+	{
+		SG_PROFILE_FUNCTION();
+
+		VulkanBuffer* pBuffer = VK_RESOURCE()->GetBuffer(name);
+		if (!pBuffer)
+		{
+			SG_LOG_WARN("Try to rebind a buffer which does not exist: %s", name.c_str());
+			return;
+		}
+
+		for (auto* pPipelineSignature : gAlivePipelineSignatures)
+			pPipelineSignature->OverWriteBufferBinding(name, pBuffer);
+	}
+
+	void VulkanPipelineSignature::OverWriteBufferBinding(const string& name, VulkanBuffer* pBuffer)
+	{
+		for (auto& setData : mDescriptorSetData)
+		{
+			const UInt32 setIndex = setData.first;
+			auto& setDescriptorsData = setData.second;
+
+			UInt32 binding = 0;
+			if (!_FindBufferBinding(*mpShader, name, setIndex, binding))
+				continue;
+
+			VulkanDescriptorDataBinder dataBinder(*mContext.pDescriptorCache, *setDescriptorsData.descriptorSetLayout);
+			dataBinder.BindBuffer(binding, pBuffer);
+
+			if (auto node = setDescriptorsData.setIndexMap.find(name); node != setDescriptorsData.setIndexMap.end()) // dynamic buffer have its own descriptor set
+			{
+				auto& descriptorSet = setDescriptorsData.descriptorSets[node->second];
+				if (descriptorSet.set != VK_NULL_HANDLE)
+					dataBinder.OverWriteData(descriptorSet);
+				continue;
+			}
+
+			// the non-dynamic buffers are in the default descriptor set and in the ones created by BindNew() (i.e. the material sets).
+			for (auto& setIndexData : setDescriptorsData.setIndexMap)
+			{
+				UInt32 dynamicBinding = 0;
+				if (_FindBufferBinding(*mpShader, setIndexData.first, setIndex, dynamicBinding))
+					continue;
+
+				auto& descriptorSet = setDescriptorsData.descriptorSets[setIndexData.second];
+				if (descriptorSet.set != VK_NULL_HANDLE)
+					dataBinder.OverWriteData(descriptorSet);
+			}
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -231,7 +332,7 @@ namespace SG
 
 	VulkanPipelineSignature::SetDataBinder::SetDataBinder(RefPtr<VulkanPipelineSignature> pipelineSignature, UInt32 set)
 		:mContext(pipelineSignature->mContext), mPipelineSignature(*pipelineSignature),
-		mSet(set), mDataBinder(*mContext.pDefaultDescriptorPool, *pipelineSignature->mDescriptorSetData[set].descriptorSetLayout)
+		mSet(set), mDataBinder(*mContext.pDescriptorCache, *pipelineSignature->mDescriptorSetData[set].descriptorSetLayout)
 	{
 	}
 
@@ -252,7 +353,7 @@ namespace SG
 
 	void VulkanPipelineSignature::SetDataBinder::Rebind(VulkanDescriptorSet& set)
 	{
-		//mContext.pDefaultDescriptorPool->FreeDescriptorSet(set);
+		// the set previously bound is released by the descriptor cache
 		Bind(set);
 	}
 
@@ -291,7 +392,7 @@ namespace SG
 
 	void VulkanPipelineSignature::ShaderDataBinder::ReBind(VulkanDescriptorSet& set)
 	{
-		//mContext.pDefaultDescriptorPool->FreeDescriptorSet(set);
+		// the set previously bound is released by the descriptor cache
 		BindSet(set);
 	}
 
@@ -327,7 +428,7 @@ namespace SG
 				nonDynamicBuffers.emplace_back(uboData);
 			else // bind dynamic descriptors
 			{
-				VulkanDescriptorDataBinder setDataBinder(*mContext.pDefaultDescriptorPool, *setDescriptorsData.descriptorSetLayout);
+				VulkanDescriptorDataBinder setDataBinder(*mContext.pDescriptorCache, *setDescriptorsData.descriptorSetLayout);
 				setDataBinder.BindBuffer(GetBinding(uboData.second.setbinding), VK_RESOURCE()->GetBuffer(uboData.first));
 				auto& descriptorSet = setDescriptorsData.descriptorSets[setDescriptorsData.setIndexMap[uboData.first]];
 				setDataBinder.Bind(descriptorSet); // bind the corresponding descriptor set
@@ -345,7 +446,7 @@ namespace SG
 				nonDynamicBuffers.emplace_back(ssboData);
 			else // bind dynamic descriptors
 			{
-				VulkanDescriptorDataBinder setDataBinder(*mContext.pDefaultDescriptorPool, *setDescriptorsData.descriptorSetLayout);
+				VulkanDescriptorDataBinder setDataBinder(*mContext.pDescriptorCache, *setDescriptorsData.descriptorSetLayout);
 				setDataBinder.BindBuffer(GetBinding(ssboData.second.setbinding), VK_RESOURCE()->GetBuffer(ssboData.first));
 				auto& descriptorSet = setDescriptorsData.descriptorSets[setDescriptorsData.setIndexMap[ssboData.first]];
 				setDataBinder.Bind(descriptorSet); // bind the corresponding descriptor set
@@ -357,7 +458,7 @@ namespace SG
 		if (!nonDynamicBuffers.empty() || !combineImageLayout.Empty())
 		{
 			// bind non-dynamic descriptors
-			VulkanDescriptorDataBinder setDataBinder(*mContext.pDefaultDescriptorPool, *setDescriptorsData.descriptorSetLayout);
+			VulkanDescriptorDataBinder setDataBinder(*mContext.pDescriptorCache, *setDescriptorsData.descriptorSetLayout);
 			for (auto& bufferLayout : nonDynamicBuffers)
 				setDataBinder.BindBuffer(GetBinding(bufferLayout.second.setbinding), VK_RESOURCE()->GetBuffer(bufferLayout.first));
 
@@ -21,7 +21,7 @@ namespace SG
 	public:
 		VulkanPipelineSignature(VulkanContext& context, RefPtr<VulkanShader> pShader, const vector<eastl::pair<const char*, const char*>>& combineImages,
 			const unordered_map<string, EDescriptorType>& overrides);
-		~VulkanPipelineSignature() = default;
+		~VulkanPipelineSignature();
 
 		//! One descriptor set layout can contain different descriptor set.
 		struct SetDescriptorsData
@@ -95,6 +95,12 @@ namespace SG
 
 		static RefPtr<VulkanPipelineSignature> Create(VulkanContext& context, RefPtr<VulkanShader> pShader, 
 			const vector<eastl::pair<const char*, const char*>>& combineImages, const unordered_map<string, EDescriptorType>& overrides);
+
+		//! Point the descriptors of all the alive pipeline signatures which bind the buffer to the current buffer with this name.
+		//! Call it after the buffer is recreated (i.e. resized), the descriptor sets must not be in use by the gpu.
+		static void RebindBuffer(const string& name);
+	private:
+		void OverWriteBufferBinding(const string& name, VulkanBuffer* pBuffer);
 	private:
 		friend class VulkanCommandBuffer;
 		friend class VulkanPipeline;
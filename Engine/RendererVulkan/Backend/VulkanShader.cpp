@@ -3,6 +3,8 @@
 
 #include "VulkanDevice.h"
 
+#include "Stl/Hash.h"
+
 namespace SG
 {
 
@@ -12,6 +14,13 @@ namespace SG
 	}
 
 	void VulkanShader::CreatePipelineShader()
+	{
+		GetBinaryHash(); // keep the hash before the binary is released
+		CreateShaderModules(mShaderModules, mShaderStagesCI);
+		ReleaseBinary();
+	}
+
+	void VulkanShader::CreateShaderModules(vector<VkShaderModule>& shaderModules, vector<VkPipelineShaderStageCreateInfo>& shaderStagesCI)
 	{
 		for (auto& beg = mShaderStages.begin(); beg != mShaderStages.end(); ++beg)
 		{
@@ -37,14 +46,31 @@ namespace SG
 			moduleCreateInfo.codeSize = beg->second.binary.size();
 			moduleCreateInfo.pCode = reinterpret_cast<UInt32*>(beg->second.binary.data());
 			vkCreateShaderModule(mDevice.logicalDevice, &moduleCreateInfo, nullptr, &shaderModule);
-			mShaderModules.push_back(shaderModule);
+			shaderModules.push_back(shaderModule);
 
 			createInfo.module = shaderModule;
 			createInfo.pName = GetEntryPoint().c_str();
 
-			mShaderStagesCI.push_back(createInfo);
+			shaderStagesCI.push_back(createInfo);
 		}
-		ReleaseBinary();
+	}
+
+	UInt64 VulkanShader::GetBinaryHash()
+	{
+		if (mBinaryHash != 0)
+			return mBinaryHash;
+
+		UInt64 hash = HashMemory(GetEntryPoint().c_str(), GetEntryPoint().size());
+		for (auto& stage : mShaderStages)
+		{
+			if (stage.second.binary.empty())
+				continue;
+			const UInt32 stageBit = (UInt32)stage.first;
+			hash = HashMemory(&stageBit, sizeof(UInt32), hash);
+			hash = HashMemory(stage.second.binary.data(), stage.second.binary.size(), hash);
+		}
+		mBinaryHash = hash;
+		return mBinaryHash;
 	}
 
 	void VulkanShader::DestroyPipelineShader()
@@ -21,11 +21,19 @@ namespace SG
 		static RefPtr<VulkanShader> Create(VulkanDevice& context);
 	private:
 		friend class VulkanPipeline;
+		friend class VulkanPipelineCache;
 		void CreatePipelineShader();
 		void DestroyPipelineShader();
 		const vector<VkPipelineShaderStageCreateInfo>& GetShaderStagesCI() const { return mShaderStagesCI; }
+
+		//! Create the shader modules of the stages without releasing the binary.
+		void CreateShaderModules(vector<VkShaderModule>& shaderModules, vector<VkPipelineShaderStageCreateInfo>& shaderStagesCI);
+		void ReleaseShaderBinary() { ReleaseBinary(); }
+		//! Hash of the SPIR-V of all the stages, it is kept after the binary is released.
+		UInt64 GetBinaryHash();
 	private:
 		VulkanDevice& mDevice;
+		UInt64        mBinaryHash = 0;
 		// after the pipeline creation, these data all will be eliminated.
 		vector<VkPipelineShaderStageCreateInfo> mShaderStagesCI;
 		vector<VkShaderModule>                  mShaderModules;
@@ -5,6 +5,7 @@
 
 #include "VulkanConfig.h"
 #include "VulkanContext.h"
+#include "VulkanDescriptorCache.h"
 #include "VulkanDevice.h"
 #include "RendererVulkan/Utils/VkConvert.h"
 
@@ -16,7 +17,7 @@ namespace SG
 	/////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	VulkanSampler::VulkanSampler(VulkanDevice& d, const SamplerCreateDesc& CI)
-		: device(d)
+		: device(d), uniqueId(VulkanDescriptorCache::NewResourceId())
 	{
 		VkSamplerCreateInfo samplerCI = {};
 		samplerCI.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -65,8 +66,13 @@ namespace SG
 
 	IDAllocator<UInt32> VulkanTexture::msIdAllocator;
 
-	VulkanTexture::VulkanTexture(VulkanContext& c, const TextureCreateDesc& CI)
-		:context(c)
+	VulkanTexture::VulkanTexture(VulkanContext& c)
+		:context(c), uniqueId(VulkanDescriptorCache::NewResourceId())
+	{
+	}
+
+	VulkanTexture::VulkanTexture(VulkanContext& c, const TextureCreateDesc& CI, const VulkanMemoryPlacement* pPlacement)
+		:context(c), uniqueId(VulkanDescriptorCache::NewResourceId())
 	{
 		if (!IsValidImageFormat(CI.format))
 			SG_ASSERT(false);
@@ -83,6 +89,8 @@ namespace SG
 		type = CI.type;
 		sample = CI.sample;
 		usage = CI.usage;
+		memoryFlag = CI.memoryFlag;
+		bAliased = (pPlacement != nullptr);
 
 		currLayouts.resize(mipLevel);
 		for (auto& layout : currLayouts)
@@ -104,31 +112,51 @@ namespace SG
 			imageCI.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 
 #if SG_USE_VULKAN_MEMORY_ALLOCATOR
-		VmaAllocationCreateInfo vmaAllocationCI = {};
-		vmaAllocationCI.flags = VMA_ALLOCATION_CREATE_STRATEGY_BEST_FIT_BIT;
-		if (SG_HAS_ENUM_FLAG(CI.memoryFlag, EGPUMemoryFlag::efDedicated_Memory))
-			vmaAllocationCI.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+		if (bAliased)
+		{
+			// the memory is owned by the one who places this texture
+			vmaAllocation = nullptr;
+			VK_CHECK(vkCreateImage(context.device.logicalDevice, &imageCI, nullptr, &image),
+				SG_LOG_ERROR("Failed to create vulkan texture!"););
+			VK_CHECK(vmaBindImageMemory2(context.vmaAllocator, pPlacement->allocation, pPlacement->offset, image, nullptr),
+				SG_LOG_ERROR("Failed to bind vulkan texture to the aliased memory!"););
+		}
+		else
+		{
+			VmaAllocationCreateInfo vmaAllocationCI = {};
+			vmaAllocationCI.flags = VMA_ALLOCATION_CREATE_STRATEGY_BEST_FIT_BIT;
+			if (SG_HAS_ENUM_FLAG(CI.memoryFlag, EGPUMemoryFlag::efDedicated_Memory))
+				vmaAllocationCI.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
 		 
-		// for now, all textures are host invisible.
-		vmaAllocationCI.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+			// for now, all textures are host invisible.
+			vmaAllocationCI.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 
-		VmaAllocationInfo allocInfo = {};
-		VK_CHECK(vmaCreateImage(context.vmaAllocator, &imageCI, &vmaAllocationCI, &image, &vmaAllocation, &allocInfo),
-			SG_LOG_ERROR("Failed to create vulkan texture!"););
+			VmaAllocationInfo allocInfo = {};
+			VK_CHECK(vmaCreateImage(context.vmaAllocator, &imageCI, &vmaAllocationCI, &image, &vmaAllocation, &allocInfo),
+				SG_LOG_ERROR("Failed to create vulkan texture!"););
+		}
 #else
 		VK_CHECK(vkCreateImage(context.device.logicalDevice, &imageCI, nullptr, &image),
 			SG_LOG_ERROR("Failed to create vulkan texture!"););
 
-		VkMemoryRequirements memReqs = {};
-		vkGetImageMemoryRequirements(context.device.logicalDevice, image, &memReqs);
-
-		VkMemoryAllocateInfo memAllloc = {};
-		memAllloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		memAllloc.allocationSize = memReqs.size;
-		memAllloc.memoryTypeIndex = context.device.GetMemoryType(memReqs.memoryTypeBits, bLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT :
-			(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
-		vkAllocateMemory(context.device.logicalDevice, &memAllloc, nullptr, &memory);
-		vkBindImageMemory(context.device.logicalDevice, image, memory, 0);
+		if (bAliased)
+		{
+			memory = VK_NULL_HANDLE;
+			vkBindImageMemory(context.device.logicalDevice, image, pPlacement->memory, pPlacement->offset);
+		}
+		else
+		{
+			VkMemoryRequirements memReqs = {};
+			vkGetImageMemoryRequirements(context.device.logicalDevice, image, &memReqs);
+
+			VkMemoryAllocateInfo memAllloc = {};
+			memAllloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			memAllloc.allocationSize = memReqs.size;
+			memAllloc.memoryTypeIndex = context.device.GetMemoryType(memReqs.memoryTypeBits, bLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT :
+				(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+			vkAllocateMemory(context.device.logicalDevice, &memAllloc, nullptr, &memory);
+			vkBindImageMemory(context.device.logicalDevice, image, memory, 0);
+		}
 #endif
 
 		VkImageViewCreateInfo imageViewCI = {};
@@ -157,14 +185,19 @@ namespace SG
 
 	VulkanTexture::~VulkanTexture()
 	{
+		if (bAliased) // the shared memory is freed by its owner
+		{
+			vkDestroyImageView(context.device.logicalDevice, imageView, nullptr);
+			vkDestroyImage(context.device.logicalDevice, image, nullptr);
+		}
 #if SG_USE_VULKAN_MEMORY_ALLOCATOR
-		if (vmaAllocation)
+		else if (vmaAllocation)
 		{
 			vkDestroyImageView(context.device.logicalDevice, imageView, nullptr);
 			vmaDestroyImage(context.vmaAllocator, image, vmaAllocation);
 		}
 #else
-		if (memory != 0)
+		else if (memory != 0)
 		{
 			vkDestroyImageView(context.device.logicalDevice, imageView, nullptr);
 			vkDestroyImage(context.device.logicalDevice, image, nullptr);
@@ -174,6 +207,13 @@ namespace SG
 		msIdAllocator.Restore(id);
 	}
 
+	VkMemoryRequirements VulkanTexture::GetMemoryRequirements() const
+	{
+		VkMemoryRequirements memReqs = {};
+		vkGetImageMemoryRequirements(context.device.logicalDevice, image, &memReqs);
+		return memReqs;
+	}
+
 	VulkanTexture* VulkanTexture::Create(VulkanContext& c, const TextureCreateDesc& CI)
 	{
 		if (!IsPowerOfTwo(CI.width) || !IsPowerOfTwo(CI.height))
@@ -189,9 +229,9 @@ namespace SG
 	/// VulkanRenderTarget
 	/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	VulkanRenderTarget* VulkanRenderTarget::Create(VulkanContext& c, const TextureCreateDesc& CI, bool isDepth)
+	VulkanRenderTarget* VulkanRenderTarget::Create(VulkanContext& c, const TextureCreateDesc& CI, bool isDepth, const VulkanMemoryPlacement* pPlacement)
 	{
-		return New(VulkanRenderTarget, c, CI, isDepth);
+		return New(VulkanRenderTarget, c, CI, isDepth, pPlacement);
 	}
 
 }
\ No newline at end of file
@@ -24,6 +24,7 @@ namespace SG
 		friend class VulkanDescriptorDataBinder;
 
 		VulkanDevice& device;
+		UInt32        uniqueId; //!< Never reused, unlike the handle.
 		VkSampler     sampler;
 	};
 
@@ -32,8 +33,9 @@ namespace SG
 	class VulkanTexture
 	{
 	public:
-		VulkanTexture(VulkanContext& c) : context(c) {}
-		VulkanTexture(VulkanContext& c, const TextureCreateDesc& CI);
+		VulkanTexture(VulkanContext& c);
+		//! If pPlacement is not null, the texture is bound to the range of the shared memory instead of having its own memory.
+		VulkanTexture(VulkanContext& c, const TextureCreateDesc& CI, const VulkanMemoryPlacement* pPlacement = nullptr);
 		~VulkanTexture();
 
 		static VulkanTexture* Create(VulkanContext& c, const TextureCreateDesc& CI);
@@ -48,6 +50,10 @@ namespace SG
 		ESampleCount GetSample() const { return sample; }
 		EImageType   GetType()   const { return type; }
 		EImageUsage  GetUsage()  const { return usage; }
+		EGPUMemoryFlag GetMemoryFlag() const { return memoryFlag; }
+		//! The memory of this texture may be shared with other textures.
+		bool IsAliased() const { return bAliased; }
+		VkMemoryRequirements GetMemoryRequirements() const;
 
 		// TODO: make a complete id system
 		UInt32       GetID()     const { return id; }
@@ -56,7 +62,9 @@ namespace SG
 	protected:
 		friend class VulkanCommandBuffer;
 		friend class VulkanDescriptorDataBinder;
+		friend class RGResourceStatusKeeper;
 		VulkanContext& context;
+		UInt32         uniqueId; //!< Never reused, unlike the id and the handles.
 
 		VkImage        image;
 		VkImageView    imageView;
@@ -78,6 +86,8 @@ namespace SG
 		EImageFormat format;
 		ESampleCount sample;
 		EImageUsage  usage;
+		EGPUMemoryFlag memoryFlag = EGPUMemoryFlag::efInvalid;
+		bool         bAliased = false;
 
 		UInt32 id;
 		void* pUserData;
@@ -92,13 +102,13 @@ namespace SG
 		VulkanRenderTarget(VulkanContext& c, bool isDepth = false)
 			: VulkanTexture(c), mbIsDepth(isDepth)
 		{}
-		VulkanRenderTarget(VulkanContext& c, const TextureCreateDesc& CI, bool isDepth = false)
-			: VulkanTexture(c, CI), mbIsDepth(isDepth)
+		VulkanRenderTarget(VulkanContext& c, const TextureCreateDesc& CI, bool isDepth = false, const VulkanMemoryPlacement* pPlacement = nullptr)
+			: VulkanTexture(c, CI, pPlacement), mbIsDepth(isDepth)
 		{}
 
 		bool IsDepth() const { return mbIsDepth; }
 
-		static VulkanRenderTarget* Create(VulkanContext& c, const TextureCreateDesc& CI, bool isDepth = false);
+		static VulkanRenderTarget* Create(VulkanContext& c, const TextureCreateDesc& CI, bool isDepth = false, const VulkanMemoryPlacement* pPlacement = nullptr);
 	private:
 		friend class VulkanSwapchain;
 		friend class VulkanFrameBuffer;
@@ -1,11 +1,13 @@
 #pragma once
 
-#if defined(SG_BUILD_DLL) // If this module is a dll
+#if defined(SG_BUILD_DLL) && defined(SG_PLATFORM_WINDOWS) // If this module is a dll
 #	if defined(SG_MODULE)
 #		define SG_RENDERER_VK_API __declspec(dllexport)
 #	else
 #		define SG_RENDERER_VK_API __declspec(dllimport)
 #	endif
+#elif defined(SG_BUILD_DLL) // the shared object on linux
+#	define SG_RENDERER_VK_API __attribute__((visibility("default")))
 #else
 #	define SG_RENDERER_VK_API
 #endif
@@ -17,4 +19,7 @@
 
 #define SG_ENABLE_DEFERRED_SHADING 0
 
-#define SG_ENABLE_GPU_CULLING 0
\ No newline at end of file
+#define SG_ENABLE_GPU_CULLING 0
+
+//! How many draw calls of a render graph node are recorded into one secondary command buffer on a job worker.
+#define SG_DRAW_CALLS_PER_RECORD_BATCH 256
\ No newline at end of file
@@ -39,12 +39,12 @@ namespace SG
 				const UInt64 vbSize = pMeshData->vertices.size() * sizeof(float);
 				const UInt64 ibSize = pMeshData->indices.size() * sizeof(UInt32);
 
-				if (mPackedVBCurrOffset + vbSize > SG_MAX_PACKED_VERTEX_BUFFER_SIZE)
+				if (mPackedVBCurrOffset + vbSize > SG_DEFAULT_PACKED_VERTEX_BUFFER_SIZE)
 				{
 					SG_LOG_ERROR("Vertex buffer exceed boundary!");
 					SG_ASSERT(false);
 				}
-				if (mPackedIBCurrOffset + ibSize > SG_MAX_PACKED_INDEX_BUFFER_SIZE)
+				if (mPackedIBCurrOffset + ibSize > SG_DEFAULT_PACKED_INDEX_BUFFER_SIZE)
 				{
 					SG_LOG_ERROR("Index buffer exceed boundary!");
 					SG_ASSERT(false);
@@ -53,7 +53,7 @@ namespace SG
 				// create one big vertex buffer
 				BufferCreateDesc vbCI = {};
 				vbCI.name = "packed_vertex_buffer_0";
-				vbCI.bufferSize = SG_MAX_PACKED_VERTEX_BUFFER_SIZE;
+				vbCI.bufferSize = SG_DEFAULT_PACKED_VERTEX_BUFFER_SIZE;
 				vbCI.type = EBufferType::efVertex;
 				vbCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
 				vbCI.pInitData = pMeshData->vertices.data();
@@ -65,7 +65,7 @@ namespace SG
 				// create one big index buffer
 				BufferCreateDesc ibCI = {};
 				ibCI.name = "packed_index_buffer_0";
-				ibCI.bufferSize = SG_MAX_PACKED_INDEX_BUFFER_SIZE;
+				ibCI.bufferSize = SG_DEFAULT_PACKED_INDEX_BUFFER_SIZE;
 				ibCI.type = EBufferType::efIndex;
 				ibCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
 				ibCI.pInitData = pMeshData->indices.data();
@@ -7,7 +7,7 @@
 #include "RendererVulkan/Backend/VulkanCommand.h"
 
 #include "Stl/SmartPtr.h"
-#include "eastl/fixed_map.h"
+#include "EASTL/fixed_map.h"
 
 namespace SG
 {
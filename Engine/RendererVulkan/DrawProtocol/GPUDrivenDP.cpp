@@ -20,18 +20,36 @@ namespace SG
 {
 
 	VulkanContext* GPUDrivenDP::mpContext = nullptr;
-	VulkanCommandBuffer* GPUDrivenDP::mpCmdBuf = nullptr;
 	UInt32 GPUDrivenDP::mCurrFrameIndex = 0;
 
 	//VulkanQueryPool* GPUDrivenDP::pComputeResetQueryPool = nullptr;
 	//VulkanQueryPool* GPUDrivenDP::pComputeCullingQueryPool = nullptr;
 
 	eastl::fixed_map<EMeshPass, vector<IndirectDrawCall>, (UInt32)EMeshPass::NUM_MESH_PASS> GPUDrivenDP::mDrawCallMap;
-	UInt32 GPUDrivenDP::mPackedVBCurrOffset = 0;
-	UInt32 GPUDrivenDP::mPackedVIBCurrOffset = 0;
-	UInt32 GPUDrivenDP::mPackedIBCurrOffset = 0;
+	OffsetAllocator GPUDrivenDP::mPackedVBAllocator;
+	OffsetAllocator GPUDrivenDP::mPackedVIBAllocator;
+	OffsetAllocator GPUDrivenDP::mPackedIBAllocator;
 	UInt32 GPUDrivenDP::mCurrDrawCallIndex = 0;
 
+	vector<GPUDrivenDP::InstanceRange> GPUDrivenDP::mInstanceRanges;
+	vector<GPUDrivenDP::MeshResidency> GPUDrivenDP::mMeshResidencies;
+	vector<DrawIndexedIndirectCommand> GPUDrivenDP::mIndirectCommands;
+
+	vector<UInt8> GPUDrivenDP::mMeshVisibility[(UInt32)ECullingView::NUM_CULLING_VIEW];
+
+	vector<GPUDrivenDP::PendingUpload> GPUDrivenDP::mPendingUploads;
+	vector<UInt32> GPUDrivenDP::mPendingUploadIndices;
+	vector<Byte> GPUDrivenDP::mPendingInstanceData;
+	vector<BufferHandle> GPUDrivenDP::mUploadStagingBuffers;
+
+	BufferHandle GPUDrivenDP::mPackedVertexBuffer;
+	BufferHandle GPUDrivenDP::mPackedIndexBuffer;
+	BufferHandle GPUDrivenDP::mIndirectBuffer;
+	BufferHandle GPUDrivenDP::mIndirectReadBackBuffer;
+	BufferHandle GPUDrivenDP::mInstanceBuffer;
+	BufferHandle GPUDrivenDP::mInstanceOutputBuffer;
+	BufferHandle GPUDrivenDP::mInstanceSumTableBuffer;
+
 	vector<VulkanCommandBuffer> GPUDrivenDP::mResetCommands;
 	vector<VulkanCommandBuffer> GPUDrivenDP::mCullingCommands;
 	vector<VulkanCommandBuffer> GPUDrivenDP::mTransferCommands;
@@ -54,6 +72,19 @@ namespace SG
 	bool GPUDrivenDP::mbBeginDraw = false;
 	bool GPUDrivenDP::mbDrawCallReady = false;
 
+	namespace // anonymous namespace
+	{
+		//! The textures must be added in the order written in the shader.
+		void _AddMaterialTextures(VulkanPipelineSignature::ShaderDataBinder& setBinder, const RendererBuildData& buildData)
+		{
+			setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.albedoTexAssetName.c_str());
+			setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.metallicTexAssetName.c_str());
+			setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.roughnessTexAssetName.c_str());
+			setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.aoTexAssetName.c_str());
+			setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.normalTexAssetName.c_str());
+		}
+	}
+
 	void GPUDrivenDP::OnInit(VulkanContext& context)
 	{
 		SG_PROFILE_FUNCTION();
@@ -62,54 +93,86 @@ namespace SG
 
 		BufferCreateDesc indirectCI = {};
 		indirectCI.name = "indirectBuffer";
-		indirectCI.bufferSize = sizeof(DrawIndexedIndirectCommand) * SG_MAX_DRAW_CALL;
+		indirectCI.bufferSize = sizeof(DrawIndexedIndirectCommand) * SG_DEFAULT_NUM_DRAW_CALL;
 		indirectCI.type = EBufferType::efIndirect | EBufferType::efStorage | EBufferType::efTransfer_Src;
 		indirectCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
-		if (!VK_RESOURCE()->CreateBuffer(indirectCI))
+		mIndirectBuffer = VK_RESOURCE()->CreateBuffer(indirectCI);
+		if (!mIndirectBuffer)
 			return;
 
 		BufferCreateDesc indirectReadBackCI = {};
 		indirectReadBackCI.name = "indirectBuffer_read_back";
-		indirectReadBackCI.bufferSize = sizeof(DrawIndexedIndirectCommand) * SG_MAX_DRAW_CALL;
+		indirectReadBackCI.bufferSize = sizeof(DrawIndexedIndirectCommand) * SG_DEFAULT_NUM_DRAW_CALL;
 		indirectReadBackCI.type = EBufferType::efStorage | EBufferType::efTransfer_Dst;
 		indirectReadBackCI.memoryUsage = EGPUMemoryUsage::eGPU_To_CPU;
 		indirectReadBackCI.memoryFlag = EGPUMemoryFlag::efPersistent_Map;
-		if (!VK_RESOURCE()->CreateBuffer(indirectReadBackCI))
+		mIndirectReadBackBuffer = VK_RESOURCE()->CreateBuffer(indirectReadBackCI);
+		if (!mIndirectReadBackBuffer)
+			return;
+
+		// the packed buffers can be copied, so that they keep the data when they grow.
+		BufferCreateDesc vbCI = {};
+		vbCI.name = "packed_vertex_buffer_0";
+		vbCI.bufferSize = SG_DEFAULT_PACKED_VERTEX_BUFFER_SIZE;
+		vbCI.type = EBufferType::efVertex | EBufferType::efTransfer_Src;
+		vbCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
+		mPackedVertexBuffer = VK_RESOURCE()->CreateBuffer(vbCI);
+		if (!mPackedVertexBuffer)
+			return;
+
+		BufferCreateDesc ibCI = {};
+		ibCI.name = "packed_index_buffer_0";
+		ibCI.bufferSize = SG_DEFAULT_PACKED_INDEX_BUFFER_SIZE;
+		ibCI.type = EBufferType::efIndex | EBufferType::efTransfer_Src;
+		ibCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
+		mPackedIndexBuffer = VK_RESOURCE()->CreateBuffer(ibCI);
+		if (!mPackedIndexBuffer)
 			return;
 
-		// create one big vertex buffer
 		BufferCreateDesc vibCI = {};
 		vibCI.name = "instanceBuffer";
-		vibCI.bufferSize = SG_MAX_PACKED_INSTANCE_BUFFER_SIZE;
-		vibCI.type = EBufferType::efVertex | EBufferType::efStorage;
+		vibCI.bufferSize = SG_DEFAULT_PACKED_INSTANCE_BUFFER_SIZE;
+		vibCI.type = EBufferType::efVertex | EBufferType::efStorage | EBufferType::efTransfer_Src;
 		vibCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
-		if (!VK_RESOURCE()->CreateBuffer(vibCI))
+		mInstanceBuffer = VK_RESOURCE()->CreateBuffer(vibCI);
+		if (!mInstanceBuffer)
 			return;
 
+		mPackedVBAllocator.Reset(SG_DEFAULT_PACKED_VERTEX_BUFFER_SIZE / sizeof(float));
+		mPackedIBAllocator.Reset(SG_DEFAULT_PACKED_INDEX_BUFFER_SIZE / sizeof(UInt32));
+		mPackedVIBAllocator.Reset(SG_DEFAULT_PACKED_INSTANCE_BUFFER_SIZE / sizeof(PerInstanceData));
+		mMeshResidencies.clear();
+
 #if SG_ENABLE_GPU_CULLING
 		BufferCreateDesc insOutCI = {};
 		insOutCI.name = "instanceOutput";
-		insOutCI.bufferSize = SG_MAX_NUM_OBJECT * sizeof(InstanceOutputData);
-		insOutCI.type = EBufferType::efStorage;
+		insOutCI.bufferSize = SG_DEFAULT_NUM_OBJECT * sizeof(InstanceOutputData);
+		insOutCI.type = EBufferType::efStorage | EBufferType::efTransfer_Src;
 		insOutCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
-		if (!VK_RESOURCE()->CreateBuffer(insOutCI))
+		mInstanceOutputBuffer = VK_RESOURCE()->CreateBuffer(insOutCI);
+		if (!mInstanceOutputBuffer)
 			return;
 
 		BufferCreateDesc instanceSumTableCI = {};
 		instanceSumTableCI.name = "instanceSumTable";
-		instanceSumTableCI.bufferSize = sizeof(UInt32) * SG_MAX_DRAW_CALL;
-		instanceSumTableCI.type = EBufferType::efStorage;
+		instanceSumTableCI.bufferSize = sizeof(UInt32) * SG_DEFAULT_NUM_DRAW_CALL;
+		instanceSumTableCI.type = EBufferType::efStorage | EBufferType::efTransfer_Src;
 		instanceSumTableCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
-		if (!VK_RESOURCE()->CreateBuffer(instanceSumTableCI))
+		mInstanceSumTableBuffer = VK_RESOURCE()->CreateBuffer(instanceSumTableCI);
+		if (!mInstanceSumTableBuffer)
 			return;
 
 		mpGPUCullingShader = VulkanShader::Create(mpContext->device);
 		mpDrawCallCompactShader = VulkanShader::Create(mpContext->device);
 		mpResetCullingShader = VulkanShader::Create(mpContext->device);
-		ShaderCompiler compiler;
-		compiler.CompileGLSLShader("culling/culling", mpGPUCullingShader);
-		compiler.CompileGLSLShader("culling/drawcall_compact", mpDrawCallCompactShader);
-		compiler.CompileGLSLShader("culling/culling_reset", mpResetCullingShader);
+		vector<ShaderCompileRequest> shaderRequests(3);
+		shaderRequests[0].shaderName = "culling/culling";
+		shaderRequests[0].pShader = mpGPUCullingShader;
+		shaderRequests[1].shaderName = "culling/drawcall_compact";
+		shaderRequests[1].pShader = mpDrawCallCompactShader;
+		shaderRequests[2].shaderName = "culling/culling_reset";
+		shaderRequests[2].pShader = mpResetCullingShader;
+		ShaderCompiler::CompileGLSLShaders(shaderRequests);
 
 		mpWaitResetSemaphore = VulkanSemaphore::Create(mpContext->device);
 		mTransferFences.resize(mpContext->pSwapchain->imageCount);
@@ -175,15 +238,25 @@ namespace SG
 		VK_RESOURCE()->DeleteBuffer("instanceBuffer");
 		VK_RESOURCE()->DeleteBuffer("packed_vertex_buffer_0");
 		VK_RESOURCE()->DeleteBuffer("packed_index_buffer_0");
+		for (auto handle : mUploadStagingBuffers)
+			VK_RESOURCE()->DeleteBuffer(handle);
+		mUploadStagingBuffers.clear();
+		mPendingUploads.clear();
+		mPendingUploadIndices.clear();
+		mPendingInstanceData.clear();
 
 		mDrawCallMap.clear();
+		for (auto& visibility : mMeshVisibility)
+			visibility.clear();
+		mInstanceRanges.clear();
+		mMeshResidencies.clear();
+		mIndirectCommands.clear();
 
 		mCurrDrawCallIndex = 0;
-		mPackedVBCurrOffset = 0;
-		mPackedVIBCurrOffset = 0;
-		mPackedIBCurrOffset = 0;
+		mPackedVBAllocator.Reset(0);
+		mPackedVIBAllocator.Reset(0);
+		mPackedIBAllocator.Reset(0);
 
-		mpCmdBuf = nullptr;
 		mpContext = nullptr;
 
 		mbRendererInit = false;
@@ -195,10 +268,14 @@ namespace SG
 
 		// clear all the old data and reset status
 		mDrawCallMap.clear();
+		for (auto& visibility : mMeshVisibility)
+			visibility.clear();
+		mInstanceRanges.clear();
 		mCurrDrawCallIndex = 0;
-		mPackedVBCurrOffset = 0;
-		mPackedVIBCurrOffset = 0;
-		mPackedIBCurrOffset = 0;
+		// the collected data is uploaded as a whole after the device is idle, the staged one is out of date.
+		mPendingUploads.clear();
+		mPendingUploadIndices.clear();
+		mPendingInstanceData.clear();
 
 		if (!mbRendererInit)
 		{
@@ -206,14 +283,33 @@ namespace SG
 			return;
 		}
 
+		// all the instances are uploaded again, the geometry of the meshes which are still drawn stays in the packed buffers.
+		mPackedVIBAllocator.Reset(VK_RESOURCE()->GetBuffer(mInstanceBuffer)->SizeCPU() / sizeof(PerInstanceData));
+
+		// one indirect command for each mesh, indexed by the meshId.
+		const UInt32 numMeshData = MeshDataArchive::GetInstance()->GetNumMeshData();
+		mMeshResidencies.resize(numMeshData);
+		{
+			vector<UInt8> usedMeshes(numMeshData, 0);
+			pRenderDataBuilder->TraverseRenderData([&usedMeshes](UInt32 meshId, const RendererBuildData& buildData)
+				{
+					usedMeshes[meshId] = 1;
+				});
+			ReclaimMeshResidencies(usedMeshes);
+		}
+		ReserveBuffer(mIndirectBuffer, static_cast<UInt32>(sizeof(DrawIndexedIndirectCommand) * numMeshData));
+		ReserveBuffer(mIndirectReadBackBuffer, static_cast<UInt32>(sizeof(DrawIndexedIndirectCommand) * numMeshData));
+
+#if SG_ENABLE_GPU_CULLING
 		vector<UInt32> instanceSumTable;
-		for (UInt32 i = 0; i < MeshDataArchive::GetInstance()->GetNumMeshData(); ++i)
+		for (UInt32 i = 0; i < numMeshData; ++i)
 			instanceSumTable.emplace_back(MeshDataArchive::GetInstance()->GetInstanceSumOffset(i));
 
+		ReserveBuffer(mInstanceSumTableBuffer, static_cast<UInt32>(sizeof(UInt32) * instanceSumTable.size()));
 		BufferCreateDesc instanceSumTableCI = {};
 		instanceSumTableCI.name = "instanceSumTable";
-		instanceSumTableCI.bufferSize = sizeof(UInt32) * SG_MAX_DRAW_CALL;
-		instanceSumTableCI.type = EBufferType::efStorage;
+		instanceSumTableCI.bufferSize = VK_RESOURCE()->GetBuffer(mInstanceSumTableBuffer)->SizeCPU();
+		instanceSumTableCI.type = EBufferType::efStorage | EBufferType::efTransfer_Src;
 		instanceSumTableCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
 		instanceSumTableCI.pInitData = instanceSumTable.data();
 		instanceSumTableCI.subBufferSize = static_cast<UInt32>(sizeof(UInt32) * instanceSumTable.size());
@@ -221,10 +317,13 @@ namespace SG
 		instanceSumTableCI.bSubBuffer = true;
 		if (!VK_RESOURCE()->CreateBuffer(instanceSumTableCI))
 			return;
+#endif
 
 		vector<InstanceOutputData> instanceOutputData;
-		vector<DrawIndexedIndirectCommand> indirectCommands;
-		indirectCommands.resize(MeshDataArchive::GetInstance()->GetNumMeshData());
+		auto& indirectCommands = mIndirectCommands;
+		indirectCommands.clear();
+		indirectCommands.resize(numMeshData);
+		mInstanceRanges.resize(numMeshData);
 
 		auto pScene = SSystem()->GetMainScene();
 		pRenderDataBuilder->TraverseRenderData([&](UInt32 meshId, const RendererBuildData& buildData)
@@ -232,21 +331,20 @@ namespace SG
 				if (buildData.instanceCount > 1) // move it to the Forward Instance Mesh Pass
 				{
 					const UInt64 ivbSize = sizeof(PerInstanceData) * buildData.instanceCount;
-					if (mPackedVIBCurrOffset + ivbSize > SG_MAX_PACKED_INSTANCE_BUFFER_SIZE)
-					{
-						SG_LOG_ERROR("Instance buffer exceed boundary!");
-						SG_ASSERT(false);
-					}
 
-					// create one big vertex buffer
+					// leave some spare slots, so that the new instances can be patched in by UpdateRenderData().
+					auto& instanceRange = mInstanceRanges[meshId];
+					instanceRange.capacity = buildData.instanceCount + buildData.instanceCount / 2;
+					instanceRange.allocation = AllocatePackedRange(mPackedVIBAllocator, mInstanceBuffer, instanceRange.capacity, sizeof(PerInstanceData));
+
 					BufferCreateDesc vibCI = {};
 					vibCI.name = "instanceBuffer";
-					vibCI.bufferSize = SG_MAX_PACKED_INSTANCE_BUFFER_SIZE;
-					vibCI.type = EBufferType::efVertex | EBufferType::efStorage;
+					vibCI.bufferSize = static_cast<UInt32>(sizeof(PerInstanceData) * mPackedVIBAllocator.GetSize());
+					vibCI.type = EBufferType::efVertex | EBufferType::efStorage | EBufferType::efTransfer_Src;
 					vibCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
 					vibCI.pInitData = buildData.perInstanceData.data();
 					vibCI.subBufferSize = static_cast<UInt32>(ivbSize);
-					vibCI.subBufferOffset = static_cast<UInt32>(mPackedVIBCurrOffset);
+					vibCI.subBufferOffset = static_cast<UInt32>(sizeof(PerInstanceData) * instanceRange.allocation.offset);
 					vibCI.bSubBuffer = true;
 					VK_RESOURCE()->CreateBuffer(vibCI);
 					SG_LOG_DEBUG("Have instance!");
@@ -263,79 +361,67 @@ namespace SG
 				const UInt64 vbSize = pMeshData->vertices.size() * sizeof(float);
 				const UInt64 ibSize = pMeshData->indices.size() * sizeof(UInt32);
 
-				if (mPackedVBCurrOffset + vbSize > SG_MAX_PACKED_VERTEX_BUFFER_SIZE)
+				// only upload the geometry of the meshes which are not in the packed buffers yet.
+				auto& residency = mMeshResidencies[meshId];
+				if (!residency.vertex.IsValid() && !pMeshData->vertices.empty())
 				{
-					SG_LOG_ERROR("Vertex buffer exceed boundary!");
-					SG_ASSERT(false);
+					residency.vertex = AllocatePackedRange(mPackedVBAllocator, mPackedVertexBuffer, static_cast<UInt32>(pMeshData->vertices.size()), sizeof(float));
+
+					BufferCreateDesc vbCI = {};
+					vbCI.name = "packed_vertex_buffer_0";
+					vbCI.bufferSize = static_cast<UInt32>(sizeof(float) * mPackedVBAllocator.GetSize());
+					vbCI.type = EBufferType::efVertex | EBufferType::efTransfer_Src;
+					vbCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
+					vbCI.pInitData = pMeshData->vertices.data();
+					vbCI.subBufferSize = static_cast<UInt32>(vbSize);
+					vbCI.subBufferOffset = static_cast<UInt32>(sizeof(float) * residency.vertex.offset);
+					vbCI.bSubBuffer = true;
+					VK_RESOURCE()->CreateBuffer(vbCI);
 				}
-				if (mPackedIBCurrOffset + ibSize > SG_MAX_PACKED_INDEX_BUFFER_SIZE)
+				if (!residency.index.IsValid() && !pMeshData->indices.empty())
 				{
-					SG_LOG_ERROR("Index buffer exceed boundary!");
-					SG_ASSERT(false);
+					residency.index = AllocatePackedRange(mPackedIBAllocator, mPackedIndexBuffer, static_cast<UInt32>(pMeshData->indices.size()), sizeof(UInt32));
+
+					BufferCreateDesc ibCI = {};
+					ibCI.name = "packed_index_buffer_0";
+					ibCI.bufferSize = static_cast<UInt32>(sizeof(UInt32) * mPackedIBAllocator.GetSize());
+					ibCI.type = EBufferType::efIndex | EBufferType::efTransfer_Src;
+					ibCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
+					ibCI.pInitData = pMeshData->indices.data();
+					ibCI.subBufferSize = static_cast<UInt32>(ibSize);
+					ibCI.subBufferOffset = static_cast<UInt32>(sizeof(UInt32) * residency.index.offset);
+					ibCI.bSubBuffer = true;
+					VK_RESOURCE()->CreateBuffer(ibCI);
 				}
-
-				// create one big vertex buffer
-				BufferCreateDesc vbCI = {};
-				vbCI.name = "packed_vertex_buffer_0";
-				vbCI.bufferSize = SG_MAX_PACKED_VERTEX_BUFFER_SIZE;
-				vbCI.type = EBufferType::efVertex;
-				vbCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
-				vbCI.pInitData = pMeshData->vertices.data();
-				vbCI.subBufferSize = static_cast<UInt32>(vbSize);
-				vbCI.subBufferOffset = static_cast<UInt32>(mPackedVBCurrOffset);
-				vbCI.bSubBuffer = true;
-				VK_RESOURCE()->CreateBuffer(vbCI);
-
-				// create one big index buffer
-				BufferCreateDesc ibCI = {};
-				ibCI.name = "packed_index_buffer_0";
-				ibCI.bufferSize = SG_MAX_PACKED_INDEX_BUFFER_SIZE;
-				ibCI.type = EBufferType::efIndex;
-				ibCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
-				ibCI.pInitData = pMeshData->indices.data();
-				ibCI.subBufferSize = static_cast<UInt32>(ibSize);
-				ibCI.subBufferOffset = static_cast<UInt32>(mPackedIBCurrOffset);
-				ibCI.bSubBuffer = true;
-				VK_RESOURCE()->CreateBuffer(ibCI);
 				VK_RESOURCE()->FlushBuffers();
 
+				// the buffers and the offsets are filled by RefreshDrawCallBuffers(), after all the packed buffers had grown or defragmented.
 				IndirectDrawCall indirectDc;
-				indirectDc.drawMesh.pVertexBuffer = VK_RESOURCE()->GetBuffer("packed_vertex_buffer_0");
+				indirectDc.drawMesh.pVertexBuffer = nullptr;
 				indirectDc.drawMesh.vBSize = vbSize;
-				indirectDc.drawMesh.vBOffset = mPackedVBCurrOffset;
-				indirectDc.drawMesh.pIndexBuffer = VK_RESOURCE()->GetBuffer("packed_index_buffer_0");;
+				indirectDc.drawMesh.vBOffset = 0;
+				indirectDc.drawMesh.pIndexBuffer = nullptr;
 				indirectDc.drawMesh.iBSize = ibSize;
-				indirectDc.drawMesh.iBOffset = mPackedIBCurrOffset;
+				indirectDc.drawMesh.iBOffset = 0;
 				indirectDc.drawMesh.pInstanceBuffer = nullptr;
 				indirectDc.drawMesh.instanceOffset = 0;
 
 				auto* pPipelineSignature = mpContext->pTempPipelineSignature;
 				indirectDc.drawMaterial.pPipelineSignature = pPipelineSignature;
 				VulkanPipelineSignature::ShaderDataBinder setBinder(pPipelineSignature, mpContext->pShader, 1);
-				setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.albedoTexAssetName.c_str());
-				setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.metallicTexAssetName.c_str());
-				setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.roughnessTexAssetName.c_str());
-				setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.aoTexAssetName.c_str());
-				setBinder.AddCombindSamplerImage("texture_1k_mipmap_sampler", buildData.normalTexAssetName.c_str());
+				_AddMaterialTextures(setBinder, buildData);
 				auto& descriptorSet = setBinder.BindNew(buildData.materialAssetName);
 
 				indirectDc.drawMaterial.materialAssetName = buildData.materialAssetName;
 
 				indirectDc.count = 1;
 				indirectDc.first = meshId;
-				indirectDc.pIndirectBuffer = VK_RESOURCE()->GetBuffer("indirectBuffer");
+				indirectDc.pIndirectBuffer = nullptr;
 
 				if (buildData.instanceCount == 1)
-				{
 					mDrawCallMap[EMeshPass::eForward].emplace_back(eastl::move(indirectDc));
-				}
 				else
-				{
-					indirectDc.drawMesh.pInstanceBuffer = VK_RESOURCE()->GetBuffer("instanceBuffer");
-					indirectDc.drawMesh.instanceOffset = mPackedVIBCurrOffset;
-					mPackedVIBCurrOffset += static_cast<UInt32>(sizeof(PerInstanceData) * buildData.instanceCount);
 					mDrawCallMap[EMeshPass::eForwardInstanced].emplace_back(eastl::move(indirectDc));
-				}
 
 				DrawIndexedIndirectCommand indirect;
 				//indirect.firstIndex = mPackedIBCurrOffset / sizeof(UInt32);
@@ -347,17 +433,15 @@ namespace SG
 				//indirect.vertexOffset = mPackedVBCurrOffset / (sizeof(float) * 6);
 
 				indirectCommands[meshId] = eastl::move(indirect);
-
-				mPackedVBCurrOffset += static_cast<UInt32>(vbSize);
-				mPackedIBCurrOffset += static_cast<UInt32>(ibSize);
 			});
+		RefreshDrawCallBuffers();
 
 		//SG_ASSERT(instanceOutputData.size() == SSystem()->GetMainScene()->GetMeshEntityCount() + 1);
 
 		BufferCreateDesc indirectCI = {};
 		indirectCI.name = "indirectBuffer";
-		indirectCI.bufferSize = sizeof(DrawIndexedIndirectCommand) * SG_MAX_DRAW_CALL;
-		indirectCI.type = EBufferType::efIndirect | EBufferType::efStorage;
+		indirectCI.bufferSize = VK_RESOURCE()->GetBuffer(mIndirectBuffer)->SizeCPU();
+		indirectCI.type = EBufferType::efIndirect | EBufferType::efStorage | EBufferType::efTransfer_Src;
 		indirectCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
 		indirectCI.pInitData = indirectCommands.data();
 		indirectCI.subBufferSize = static_cast<UInt32>(sizeof(DrawIndexedIndirectCommand) * indirectCommands.size());
@@ -378,10 +462,11 @@ namespace SG
 #if SG_ENABLE_GPU_CULLING
 		if (!instanceOutputData.empty())
 		{
+			ReserveBuffer(mInstanceOutputBuffer, static_cast<UInt32>(sizeof(InstanceOutputData) * instanceOutputData.size()));
 			BufferCreateDesc insOutputCI = {};
 			insOutputCI.name = "instanceOutput";
-			insOutputCI.type = EBufferType::efStorage;
-			insOutputCI.bufferSize = SG_MAX_NUM_OBJECT * sizeof(InstanceOutputData);
+			insOutputCI.type = EBufferType::efStorage | EBufferType::efTransfer_Src;
+			insOutputCI.bufferSize = VK_RESOURCE()->GetBuffer(mInstanceOutputBuffer)->SizeCPU();
 			insOutputCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
 			insOutputCI.pInitData = instanceOutputData.data();
 			insOutputCI.subBufferSize = static_cast<UInt32>(sizeof(InstanceOutputData) * instanceOutputData.size());
@@ -420,9 +505,190 @@ namespace SG
 
 		LogDebugInfo();
 
+		// all the changes of the render data had been collected.
+		pRenderDataBuilder->ClearDrawCallChanges();
 		mbDrawCallReady = true;
 	}
 
+	bool GPUDrivenDP::UpdateRenderData(RefPtr<RenderDataBuilder> pRenderDataBuilder)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (!mbDrawCallReady)
+			return true;
+		if (pRenderDataBuilder->IsDrawCallLayoutChanged())
+			return false;
+
+		const auto& changedMeshes = pRenderDataBuilder->GetChangedInstanceMeshes();
+		if (changedMeshes.empty())
+			return true;
+
+		// the meshes reach here are instanced ones before and after the changes.
+		for (auto meshId : changedMeshes)
+		{
+			const auto* pBuildData = pRenderDataBuilder->GetRenderData(meshId);
+			if (!pBuildData || meshId >= mInstanceRanges.size())
+				return false;
+		}
+
+		if (mPendingUploadIndices.size() < mInstanceRanges.size())
+			mPendingUploadIndices.resize(mInstanceRanges.size(), UInt32(-1));
+
+		bool bInstanceRangeMoved = false;
+		for (auto meshId : changedMeshes)
+		{
+			const auto* pBuildData = pRenderDataBuilder->GetRenderData(meshId);
+			auto& instanceRange = mInstanceRanges[meshId];
+
+			// all the instances are uploaded below, free the full range first so that it can be merged into the new one.
+			if (pBuildData->instanceCount > instanceRange.capacity)
+			{
+				if (instanceRange.allocation.IsValid())
+					mPackedVIBAllocator.Deallocate(instanceRange.allocation.id);
+				instanceRange.capacity = pBuildData->instanceCount + pBuildData->instanceCount / 2;
+				instanceRange.allocation = AllocatePackedRange(mPackedVIBAllocator, mInstanceBuffer, instanceRange.capacity, sizeof(PerInstanceData));
+				bInstanceRangeMoved = true;
+			}
+
+			// a mesh changed again before its last change was recorded (i.e. the window is minimized) reuses the staged bytes.
+			const UInt32 dataSize = static_cast<UInt32>(sizeof(PerInstanceData) * pBuildData->instanceCount);
+			UInt32& pendingIndex = mPendingUploadIndices[meshId];
+			if (pendingIndex == UInt32(-1))
+			{
+				pendingIndex = static_cast<UInt32>(mPendingUploads.size());
+				mPendingUploads.push_back({ meshId, 0, 0, false });
+			}
+			auto& upload = mPendingUploads[pendingIndex];
+			if (dataSize > sizeof(PerInstanceData) * upload.instanceCount)
+			{
+				upload.dataOffset = static_cast<UInt32>(mPendingInstanceData.size());
+				mPendingInstanceData.resize(mPendingInstanceData.size() + dataSize);
+			}
+			upload.instanceCount = pBuildData->instanceCount;
+			if (dataSize > 0)
+				memcpy(mPendingInstanceData.data() + upload.dataOffset, pBuildData->perInstanceData.data(), dataSize);
+
+			auto& indirect = mIndirectCommands[meshId];
+			if (indirect.instanceCount == pBuildData->instanceCount)
+				continue;
+			indirect.instanceCount = pBuildData->instanceCount;
+			upload.bIndirectChanged = true;
+		}
+		if (bInstanceRangeMoved) // the instance buffer may had grown or defragmented
+			RefreshDrawCallBuffers();
+
+		pRenderDataBuilder->ClearDrawCallChanges();
+		return true;
+	}
+
+	void GPUDrivenDP::RecordUploads(VulkanCommandBuffer& cmdBuf, UInt32 frameIndex)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (mPendingUploads.empty())
+			return;
+
+		// the staging buffer holds the instance data, followed by the changed indirect commands.
+		// the ranges are resolved now, they may had moved since the data was staged.
+		const UInt32 instanceDataSize = static_cast<UInt32>(mPendingInstanceData.size());
+		vector<DrawIndexedIndirectCommand> indirectCommands;
+		vector<BufferCopyRegion> instanceRegions;
+		vector<BufferCopyRegion> indirectRegions;
+		for (auto& upload : mPendingUploads)
+		{
+			mPendingUploadIndices[upload.meshId] = UInt32(-1);
+			if (upload.instanceCount > 0)
+			{
+				const UInt32 dstOffset = static_cast<UInt32>(sizeof(PerInstanceData) * mPackedVIBAllocator.GetOffset(mInstanceRanges[upload.meshId].allocation.id));
+				instanceRegions.push_back({ upload.dataOffset, dstOffset, static_cast<UInt32>(sizeof(PerInstanceData) * upload.instanceCount) });
+			}
+			if (upload.bIndirectChanged)
+			{
+				const UInt32 srcOffset = instanceDataSize + static_cast<UInt32>(sizeof(DrawIndexedIndirectCommand) * indirectCommands.size());
+				indirectRegions.push_back({ srcOffset, static_cast<UInt32>(sizeof(DrawIndexedIndirectCommand) * upload.meshId), sizeof(DrawIndexedIndirectCommand) });
+				indirectCommands.push_back(mIndirectCommands[upload.meshId]);
+			}
+		}
+		const UInt32 indirectDataSize = static_cast<UInt32>(sizeof(DrawIndexedIndirectCommand) * indirectCommands.size());
+		mPendingUploads.clear();
+		mPendingInstanceData.clear();
+
+		// one staging buffer for each frame in flight, the fence of this frame had been waited, so its buffer is free.
+		if (frameIndex >= mUploadStagingBuffers.size())
+			mUploadStagingBuffers.resize(frameIndex + 1);
+		auto* pStagingBuffer = VK_RESOURCE()->GetBuffer(mUploadStagingBuffers[frameIndex]);
+		if (!pStagingBuffer || pStagingBuffer->SizeCPU() < instanceDataSize + indirectDataSize)
+		{
+			const UInt32 newSize = eastl::max(instanceDataSize + indirectDataSize, pStagingBuffer ? pStagingBuffer->SizeCPU() * 2 : 0u);
+			VK_RESOURCE()->DeleteBuffer(mUploadStagingBuffers[frameIndex]);
+
+			const string name = "gpu_driven_upload_staging_" + eastl::to_string(frameIndex);
+			BufferCreateDesc stagingCI = {};
+			stagingCI.name = name.c_str();
+			stagingCI.bufferSize = newSize;
+			stagingCI.type = EBufferType::efTransfer_Src;
+			stagingCI.memoryUsage = EGPUMemoryUsage::eCPU_To_GPU;
+			mUploadStagingBuffers[frameIndex] = VK_RESOURCE()->CreateBuffer(stagingCI);
+			pStagingBuffer = VK_RESOURCE()->GetBuffer(mUploadStagingBuffers[frameIndex]);
+			if (!pStagingBuffer)
+			{
+				SG_LOG_ERROR("Failed to create the upload staging buffer!");
+				return;
+			}
+		}
+		if (instanceDataSize > 0)
+			pStagingBuffer->UploadData(mPendingInstanceData.data(), instanceDataSize, 0);
+		if (indirectDataSize > 0)
+			pStagingBuffer->UploadData(indirectCommands.data(), indirectDataSize, instanceDataSize);
+
+		// the frames submitted before may still read the ranges, the copies wait for them on the graphic queue.
+		auto* pInstanceBuffer = VK_RESOURCE()->GetBuffer(mInstanceBuffer);
+		if (!instanceRegions.empty())
+		{
+			cmdBuf.BufferBarrier(pInstanceBuffer, EPipelineStageAccess::efVertex_Read | EPipelineStageAccess::efShader_Read, EPipelineStageAccess::efTransfer_Write);
+			cmdBuf.CopyBuffer(*pStagingBuffer, *pInstanceBuffer, instanceRegions);
+			cmdBuf.BufferBarrier(pInstanceBuffer, EPipelineStageAccess::efTransfer_Write, EPipelineStageAccess::efVertex_Read | EPipelineStageAccess::efShader_Read);
+		}
+		auto* pIndirectBuffer = VK_RESOURCE()->GetBuffer(mIndirectBuffer);
+		if (!indirectRegions.empty())
+		{
+			cmdBuf.BufferBarrier(pIndirectBuffer, EPipelineStageAccess::efIndirect_Read | EPipelineStageAccess::efShader_Read, EPipelineStageAccess::efTransfer_Write);
+			cmdBuf.CopyBuffer(*pStagingBuffer, *pIndirectBuffer, indirectRegions);
+			cmdBuf.BufferBarrier(pIndirectBuffer, EPipelineStageAccess::efTransfer_Write, EPipelineStageAccess::efIndirect_Read | EPipelineStageAccess::efShader_Read);
+		}
+	}
+
+	void GPUDrivenDP::RebindMaterialTextures(RefPtr<RenderDataBuilder> pRenderDataBuilder)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (!mbDrawCallReady)
+			return;
+
+		auto* pPipelineSignature = mpContext->pTempPipelineSignature;
+		pRenderDataBuilder->TraverseRenderData([pPipelineSignature](UInt32 meshId, const RendererBuildData& buildData)
+			{
+				if (buildData.materialTextureMask == 0)
+					return;
+
+				VulkanPipelineSignature::ShaderDataBinder setBinder(pPipelineSignature, mpContext->pShader, 1);
+				_AddMaterialTextures(setBinder, buildData);
+				setBinder.ReBind(pPipelineSignature->GetDescriptorSet(1, buildData.materialAssetName));
+			});
+	}
+
+	void GPUDrivenDP::CullDrawCalls(RefPtr<RenderDataBuilder> pRenderDataBuilder, const Frustum& cameraFrustum, const Frustum& lightFrustum)
+	{
+		SG_PROFILE_FUNCTION();
+
+		if (!mbDrawCallReady)
+			return;
+
+		pRenderDataBuilder->UpdateMeshBounds();
+		pRenderDataBuilder->CullMeshes(cameraFrustum, mMeshVisibility[(UInt32)ECullingView::eCamera]);
+		pRenderDataBuilder->CullMeshes(lightFrustum, mMeshVisibility[(UInt32)ECullingView::eLight]);
+	}
+
 	void GPUDrivenDP::Begin(DrawInfo& drawInfo)
 	{
 		SG_PROFILE_FUNCTION();
@@ -439,7 +705,6 @@ namespace SG
 		}
 
 		mbBeginDraw = true;
-		mpCmdBuf = drawInfo.pCmd;
 		mCurrFrameIndex = drawInfo.frameIndex;
 	}
 
@@ -454,7 +719,6 @@ namespace SG
 		}
 
 		mbBeginDraw = false;
-		mpCmdBuf = nullptr;
 		mCurrFrameIndex = UInt32(-1);
 	}
 
@@ -505,7 +769,7 @@ namespace SG
 			//	EPipelineType::eGraphic, EPipelineType::eCompute);
 
 			// [Data Hazard] barrier to prevent instanceOutput RAW(Read After Write) scenario
-			cmd.BufferBarrier(VK_RESOURCE()->GetBuffer("instanceOutput"), EPipelineStageAccess::efShader_Read, EPipelineStageAccess::efShader_Write,
+			cmd.BufferBarrier(VK_RESOURCE()->GetBuffer(mInstanceOutputBuffer), EPipelineStageAccess::efShader_Read, EPipelineStageAccess::efShader_Write,
 				EPipelineType::eCompute, EPipelineType::eCompute);
 
 			cmd.BindPipeline(mpGPUCullingPipeline);
@@ -513,12 +777,13 @@ namespace SG
 			UInt32 numGroup = (UInt32)(SSystem()->GetMainScene()->GetMeshEntityCount() / 128) + 1;
 			cmd.Dispatch(numGroup, 1, 1);
 
-			cmd.BufferBarrier(VK_RESOURCE()->GetBuffer("instanceOutput"), EPipelineStageAccess::efShader_Write, EPipelineStageAccess::efShader_Read,
+			cmd.BufferBarrier(VK_RESOURCE()->GetBuffer(mInstanceOutputBuffer), EPipelineStageAccess::efShader_Write, EPipelineStageAccess::efShader_Read,
 				EPipelineType::eCompute, EPipelineType::eCompute);
 
 			cmd.BindPipeline(mpDrawCallCompactPipeline);
 			cmd.BindPipelineSignatureNonDynamic(mpDrawCallCompactPipelineSignature.get(), EPipelineType::eCompute);
-			cmd.Dispatch(1, 1, 1);
+			numGroup = (UInt32)(MeshDataArchive::GetInstance()->GetNumMeshData() / 16) + 1;
+			cmd.Dispatch(numGroup, 1, 1);
 
 			// We use semaphore to ensure that out compute command is finish before the graphic queue begin to draw,
 			// So i think we don't need the buffer barrier here!
@@ -540,6 +805,11 @@ namespace SG
 #endif
 	}
 
+	VulkanBuffer* GPUDrivenDP::GetIndirectReadBackBuffer()
+	{
+		return VK_RESOURCE()->GetBuffer(mIndirectReadBackBuffer);
+	}
+
 	void GPUDrivenDP::CopyStatisticsData()
 	{
 		SG_PROFILE_FUNCTION();
@@ -549,7 +819,7 @@ namespace SG
 		cmd.Reset();
 		cmd.BeginRecord();
 		{
-			cmd.CopyBuffer(*VK_RESOURCE()->GetBuffer("indirectBuffer"), *VK_RESOURCE()->GetBuffer("indirectBuffer_read_back"), 0, 0);
+			cmd.CopyBuffer(*VK_RESOURCE()->GetBuffer(mIndirectBuffer), *VK_RESOURCE()->GetBuffer(mIndirectReadBackBuffer), 0, 0);
 		}
 		cmd.EndRecord();
 
@@ -564,50 +834,190 @@ namespace SG
 #endif
 	}
 
-	void GPUDrivenDP::Draw(EMeshPass meshPass)
+	UInt32 GPUDrivenDP::GetNumDrawCall(EMeshPass meshPass)
+	{
+		return static_cast<UInt32>(GetDrawCalls(meshPass).size());
+	}
+
+	void GPUDrivenDP::Draw(VulkanCommandBuffer& cmdBuf, EMeshPass meshPass, ECullingView view, UInt32 begin, UInt32 end)
 	{
 		SG_PROFILE_FUNCTION();
 
-		for (auto& dc : mDrawCallMap[meshPass])
+		const auto& drawCalls = GetDrawCalls(meshPass);
+		end = eastl::min(end, static_cast<UInt32>(drawCalls.size()));
+		for (UInt32 i = begin; i < end; ++i)
 		{
-			BindMesh(dc.drawMesh); // bind vertex buffer, index buffer and instance buffer (if exists)
-			BindMaterial(dc.drawMaterial); // bind descriptor set (i.e. bind resources into the pipeline layout)
+			auto& dc = drawCalls[i];
+			if (!IsDrawCallVisible(dc, view))
+				continue;
+
+			BindMesh(cmdBuf, dc.drawMesh); // bind vertex buffer, index buffer and instance buffer (if exists)
+			BindMaterial(cmdBuf, dc.drawMaterial); // bind descriptor set (i.e. bind resources into the pipeline layout)
 
-			mpCmdBuf->DrawIndexedIndirect(dc.pIndirectBuffer, dc.first * sizeof(DrawIndexedIndirectCommand), 1, sizeof(DrawIndexedIndirectCommand));
+			cmdBuf.DrawIndexedIndirect(dc.pIndirectBuffer, dc.first * sizeof(DrawIndexedIndirectCommand), 1, sizeof(DrawIndexedIndirectCommand));
 		}
 	}
 
-	void GPUDrivenDP::DrawWithoutBindMaterial(EMeshPass meshPass)
+	void GPUDrivenDP::DrawWithoutBindMaterial(VulkanCommandBuffer& cmdBuf, EMeshPass meshPass, ECullingView view, UInt32 begin, UInt32 end)
 	{
 		SG_PROFILE_FUNCTION();
 
-		for (auto& dc : mDrawCallMap[meshPass])
+		const auto& drawCalls = GetDrawCalls(meshPass);
+		end = eastl::min(end, static_cast<UInt32>(drawCalls.size()));
+		for (UInt32 i = begin; i < end; ++i)
+		{
+			auto& dc = drawCalls[i];
+			if (!IsDrawCallVisible(dc, view))
+				continue;
+
+			BindMesh(cmdBuf, dc.drawMesh); // bind vertex buffer, index buffer and instance buffer (if exists)
+
+			cmdBuf.DrawIndexedIndirect(dc.pIndirectBuffer, dc.first * sizeof(DrawIndexedIndirectCommand), 1, sizeof(DrawIndexedIndirectCommand));
+		}
+	}
+
+	const vector<IndirectDrawCall>& GPUDrivenDP::GetDrawCalls(EMeshPass meshPass)
+	{
+		// operator[] would insert the missing mesh pass, which is not safe when the draw calls are recorded by the job workers.
+		static const vector<IndirectDrawCall> sEmptyDrawCalls;
+		auto node = mDrawCallMap.find(meshPass);
+		return node == mDrawCallMap.end() ? sEmptyDrawCalls : node->second;
+	}
+
+	bool GPUDrivenDP::IsDrawCallVisible(const IndirectDrawCall& drawCall, ECullingView view)
+	{
+		const auto& visibility = mMeshVisibility[(UInt32)view];
+		if (drawCall.first >= visibility.size()) // not culled
+			return true;
+		return visibility[drawCall.first] != 0;
+	}
+
+	OffsetAllocator::Allocation GPUDrivenDP::AllocatePackedRange(OffsetAllocator& allocator, BufferHandle buffer, UInt32 size, UInt32 stride)
+	{
+		auto allocation = allocator.Allocate(size);
+		if (allocation.IsValid())
+			return allocation;
+
+		// the free regions are binned by rounding down their sizes (3 mantissa bits), a region with this slack is always found.
+		const UInt32 requiredSize = size + size / 8 + 1;
+		if (allocator.GetFreeSize() >= requiredSize)
 		{
-			BindMesh(dc.drawMesh); // bind vertex buffer, index buffer and instance buffer (if exists)
+			// the free space is enough but scattered, pack the allocations to the front.
+			// the ranges can not be copied within the same buffer, so the moved ones are copied to a new buffer.
+			vector<OffsetAllocator::Move> moves;
+			allocator.Defragment(moves);
+
+			// the allocations which are not moved are copied as well.
+			vector<BufferCopyRegion> regions;
+			UInt32 cursor = 0;
+			for (auto& move : moves)
+			{
+				if (move.dstOffset > cursor)
+					regions.push_back({ cursor * stride, cursor * stride, (move.dstOffset - cursor) * stride });
+				regions.push_back({ move.srcOffset * stride, move.dstOffset * stride, move.size * stride });
+				cursor = move.dstOffset + move.size;
+			}
+			const UInt32 usedSize = allocator.GetUsedSize();
+			if (usedSize > cursor)
+				regions.push_back({ cursor * stride, cursor * stride, (usedSize - cursor) * stride });
 
-			mpCmdBuf->DrawIndexedIndirect(dc.pIndirectBuffer, dc.first * sizeof(DrawIndexedIndirectCommand), 1, sizeof(DrawIndexedIndirectCommand));
+			SG_LOG_DEBUG("Defragment packed buffer, %d ranges moved", static_cast<UInt32>(moves.size()));
+			if (!VK_RESOURCE()->RelocateBuffer(buffer, allocator.GetSize() * stride, regions))
+			{
+				SG_LOG_ERROR("Failed to defragment the packed buffer!");
+				SG_ASSERT(false);
+			}
+		}
+		else
+		{
+			// double the buffer, the free space at the end is merged with the grown one.
+			UInt32 newSize = eastl::max(allocator.GetSize(), 1u);
+			while (newSize - allocator.GetSize() < requiredSize)
+				newSize *= 2;
+			SG_LOG_DEBUG("Grow packed buffer to %d bytes", newSize * stride);
+			if (!VK_RESOURCE()->ResizeBuffer(buffer, newSize * stride))
+			{
+				SG_LOG_ERROR("Failed to grow the packed buffer!");
+				SG_ASSERT(false);
+			}
+			allocator.Grow(newSize);
+		}
+
+		allocation = allocator.Allocate(size);
+		SG_ASSERT(allocation.IsValid());
+		return allocation;
+	}
+
+	void GPUDrivenDP::ReclaimMeshResidencies(const vector<UInt8>& usedMeshes)
+	{
+		for (UInt32 meshId = 0; meshId < mMeshResidencies.size(); ++meshId)
+		{
+			if (usedMeshes[meshId])
+				continue;
+
+			auto& residency = mMeshResidencies[meshId];
+			if (residency.vertex.IsValid())
+				mPackedVBAllocator.Deallocate(residency.vertex.id);
+			if (residency.index.IsValid())
+				mPackedIBAllocator.Deallocate(residency.index.id);
+			residency = {};
+		}
+	}
+
+	void GPUDrivenDP::ReserveBuffer(BufferHandle buffer, UInt32 size)
+	{
+		const UInt32 currSize = VK_RESOURCE()->GetBuffer(buffer)->SizeCPU();
+		if (size <= currSize)
+			return;
+		if (!VK_RESOURCE()->ResizeBuffer(buffer, eastl::max(size, currSize * 2)))
+		{
+			SG_LOG_ERROR("Failed to grow the buffer!");
+			SG_ASSERT(false);
+		}
+	}
+
+	void GPUDrivenDP::RefreshDrawCallBuffers()
+	{
+		auto* pVertexBuffer = VK_RESOURCE()->GetBuffer(mPackedVertexBuffer);
+		auto* pIndexBuffer = VK_RESOURCE()->GetBuffer(mPackedIndexBuffer);
+		auto* pInstanceBuffer = VK_RESOURCE()->GetBuffer(mInstanceBuffer);
+		auto* pIndirectBuffer = VK_RESOURCE()->GetBuffer(mIndirectBuffer);
+		for (auto& node : mDrawCallMap)
+		{
+			const bool bInstanced = node.first == EMeshPass::eForwardInstanced;
+			for (auto& dc : node.second)
+			{
+				const auto& residency = mMeshResidencies[dc.first];
+				dc.drawMesh.pVertexBuffer = pVertexBuffer;
+				dc.drawMesh.vBOffset = residency.vertex.IsValid() ? sizeof(float) * mPackedVBAllocator.GetOffset(residency.vertex.id) : 0;
+				dc.drawMesh.pIndexBuffer = pIndexBuffer;
+				dc.drawMesh.iBOffset = residency.index.IsValid() ? sizeof(UInt32) * mPackedIBAllocator.GetOffset(residency.index.id) : 0;
+				dc.drawMesh.pInstanceBuffer = bInstanced ? pInstanceBuffer : nullptr;
+				dc.drawMesh.instanceOffset = bInstanced ? sizeof(PerInstanceData) * mPackedVIBAllocator.GetOffset(mInstanceRanges[dc.first].allocation.id) : 0;
+				dc.pIndirectBuffer = pIndirectBuffer;
+			}
 		}
 	}
 
-	void GPUDrivenDP::BindMesh(const DrawMesh& drawMesh)
+	void GPUDrivenDP::BindMesh(VulkanCommandBuffer& cmdBuf, const DrawMesh& drawMesh)
 	{
 		SG_PROFILE_FUNCTION();
 
-		mpCmdBuf->BindVertexBuffer(0, 1, *drawMesh.pVertexBuffer, &drawMesh.vBOffset);
+		cmdBuf.BindVertexBuffer(0, 1, *drawMesh.pVertexBuffer, &drawMesh.vBOffset);
 		if (drawMesh.pInstanceBuffer)
-			mpCmdBuf->BindVertexBuffer(1, 1, *drawMesh.pInstanceBuffer, &drawMesh.instanceOffset);
-		mpCmdBuf->BindIndexBuffer(*drawMesh.pIndexBuffer, drawMesh.iBOffset);
+			cmdBuf.BindVertexBuffer(1, 1, *drawMesh.pInstanceBuffer, &drawMesh.instanceOffset);
+		cmdBuf.BindIndexBuffer(*drawMesh.pIndexBuffer, drawMesh.iBOffset);
 	}
 
-	void GPUDrivenDP::BindMaterial(const DrawMaterial& drawMaterial)
+	void GPUDrivenDP::BindMaterial(VulkanCommandBuffer& cmdBuf, const DrawMaterial& drawMaterial)
 	{
 		SG_PROFILE_FUNCTION();
 
-		mpCmdBuf->BindPipelineSignatureNonDynamic(drawMaterial.pPipelineSignature, 0); // bind necessary resource first
+		cmdBuf.BindPipelineSignatureNonDynamic(drawMaterial.pPipelineSignature, 0); // bind necessary resource first
 		if (!drawMaterial.materialAssetName.empty())
 		{
 			auto& descriptorSet = drawMaterial.pPipelineSignature->GetDescriptorSet(1, drawMaterial.materialAssetName);
-			mpCmdBuf->BindDescriptorSet(drawMaterial.pPipelineSignature, 1, &descriptorSet); // set index 1 for custom user resource bind.
+			cmdBuf.BindDescriptorSet(drawMaterial.pPipelineSignature, 1, &descriptorSet); // set index 1 for custom user resource bind.
 		}
 	}
 
@@ -1,19 +1,22 @@
 #pragma once
 
 #include "Scene/RenderDataBuilder.h"
+#include "Memory/OffsetAllocator.h"
 
 #include "RendererVulkan/RenderGraph/RenderInfo.h"
 #include "RendererVulkan/RenderDevice/MeshPass.h"
 #include "RendererVulkan/RenderDevice/DrawCall.h"
+#include "RendererVulkan/Resource/ResourceTable.h"
 
 #include "Stl/SmartPtr.h"
 #include "Stl/unordered_map.h"
-#include "eastl/fixed_map.h"
+#include "EASTL/fixed_map.h"
 
 namespace SG
 {
 
-#define SG_MAX_DRAW_CALL 100
+// initial number of the draw calls, the indirect buffers grow when the scene have more meshes.
+#define SG_DEFAULT_NUM_DRAW_CALL 128
 
 	class VulkanContext;
 	class VulkanCommandBuffer;
@@ -23,6 +26,14 @@ namespace SG
 	class VulkanPipelineSignature;
 	class VulkanShader;
 
+	//! The view the draw calls are culled against on the cpu side.
+	enum class ECullingView
+	{
+		eCamera = 0,
+		eLight,
+		NUM_CULLING_VIEW,
+	};
+
 	//! State machine, a functionality class to record draw command, and persist the render context.
 	class GPUDrivenDP
 	{
@@ -31,34 +42,111 @@ namespace SG
 		static void OnShutdown();
 		//! Collect the render data from RenderDataBuilder, make render resource and packed to drawcall.
 		static void CollectRenderData(RefPtr<RenderDataBuilder> pRenderDataBuilder);
-
+		//! Rebind the material textures of the draw calls, called when the streamed in textures are created.
+		//! The textures which had not been created are bound as the default texture.
+		static void RebindMaterialTextures(RefPtr<RenderDataBuilder> pRenderDataBuilder);
+		//! Patch the instance ranges and the indirect commands of the meshes whose instances had changed in this frame.
+		//! A full instance range is moved to a bigger free range of the instance buffer.
+		//! The new data is only staged here, the frames in flight may still read the buffers, RecordUploads() copies it.
+		//! Return false if the draw calls need to be collected again, i.e. the layout of the draw calls had changed.
+		static bool UpdateRenderData(RefPtr<RenderDataBuilder> pRenderDataBuilder);
+		//! Record the copies of the data staged by UpdateRenderData() into the graphic command buffer of the frame, before any draw.
+		//! The fence of the frame must had been waited, the staging buffer of the frame is reused.
+		static void RecordUploads(VulkanCommandBuffer& cmdBuf, UInt32 frameIndex);
+
+		//! Begin to submit the culling of the frame, the draw calls are recorded into the command buffers passed to Draw().
 		static void Begin(DrawInfo& drawInfo);
 		static void End();
 
+		//! Cull the meshes against the frustums of the views on the cpu side, the invisible draw calls are skipped in Draw().
+		//! The instanced draw call is culled by the merged bounds of all its instances.
+		static void CullDrawCalls(RefPtr<RenderDataBuilder> pRenderDataBuilder, const Frustum& cameraFrustum, const Frustum& lightFrustum);
+
 		static void CullingReset();
 		static void DoCulling();
 		static void CopyStatisticsData();
 		static void WaitForStatisticsCopyed();
-
-		static void Draw(EMeshPass meshPass);
+		//! The indirect commands copied back to the cpu side by CopyStatisticsData().
+		static VulkanBuffer* GetIndirectReadBackBuffer();
+
+		//! Number of the draw calls of the mesh pass, the visible ones are not known until they are drawn.
+		static UInt32 GetNumDrawCall(EMeshPass meshPass);
+		//! Record the visible draw calls in [begin, end) of the mesh pass, end is clamped to the number of the draw calls.
+		//! The draw calls are only read here, so the ranges can be recorded into different command buffers on the job workers at the same time.
+		static void Draw(VulkanCommandBuffer& cmdBuf, EMeshPass meshPass, ECullingView view = ECullingView::eCamera, UInt32 begin = 0, UInt32 end = UInt32(-1));
 		// temp
-		static void DrawWithoutBindMaterial(EMeshPass meshPass);
+		static void DrawWithoutBindMaterial(VulkanCommandBuffer& cmdBuf, EMeshPass meshPass, ECullingView view = ECullingView::eCamera, UInt32 begin = 0, UInt32 end = UInt32(-1));
 	private:
-		static void BindMesh(const DrawMesh& drawMesh);
-		static void BindMaterial(const DrawMaterial& drawMaterial);
+		//! Instances of an instanced mesh in the packed instance buffer, there are spare slots for the new instances.
+		struct InstanceRange
+		{
+			OffsetAllocator::Allocation allocation; //!< In instances.
+			UInt32 capacity = 0; //!< In instances, 0 for the non-instanced meshes.
+		};
+
+		//! Geometry of a mesh in the packed buffers, it stays there until no draw call uses the mesh.
+		struct MeshResidency
+		{
+			OffsetAllocator::Allocation vertex; //!< In floats.
+			OffsetAllocator::Allocation index;  //!< In indices.
+		};
+
+		//! The instances of a mesh waiting for RecordUploads(), the destination is resolved there since the ranges may move before.
+		struct PendingUpload
+		{
+			UInt32 meshId;
+			UInt32 dataOffset;    //!< In bytes, of the instance data in mPendingInstanceData.
+			UInt32 instanceCount;
+			bool   bIndirectChanged;
+		};
+
+		static void BindMesh(VulkanCommandBuffer& cmdBuf, const DrawMesh& drawMesh);
+		static void BindMaterial(VulkanCommandBuffer& cmdBuf, const DrawMaterial& drawMaterial);
+		//! The draw calls of the mesh pass, empty if the mesh pass had not been collected.
+		static const vector<IndirectDrawCall>& GetDrawCalls(EMeshPass meshPass);
+
+		static bool IsDrawCallVisible(const IndirectDrawCall& drawCall, ECullingView view);
+
+		//! Allocate a range of the elements in a packed buffer. If the free space is enough but scattered, the allocations are defragmented
+		//! and the moved ranges are copied to a new buffer, otherwise the buffer grows. The offsets of the allocations may change, use their ids.
+		static OffsetAllocator::Allocation AllocatePackedRange(OffsetAllocator& allocator, BufferHandle buffer, UInt32 size, UInt32 stride);
+		//! Free the geometry of the meshes which are no longer drawn, so that the space can be reused by the streamed in meshes.
+		static void   ReclaimMeshResidencies(const vector<UInt8>& usedMeshes);
+		//! Grow the buffer to hold at least the size in bytes.
+		static void   ReserveBuffer(BufferHandle buffer, UInt32 size);
+		//! The buffers are recreated when they grow or defragment, point the draw calls to the current buffers and the current offsets of their ranges.
+		static void   RefreshDrawCallBuffers();
 
 		static void LogDebugInfo();
 	private:
 		static VulkanContext* mpContext;
-		static VulkanCommandBuffer* mpCmdBuf;
 		static UInt32 mCurrFrameIndex;
 
 		static eastl::fixed_map<EMeshPass, vector<IndirectDrawCall>, (UInt32)EMeshPass::NUM_MESH_PASS> mDrawCallMap;
-		static UInt32 mPackedVBCurrOffset;
-		static UInt32 mPackedVIBCurrOffset;
-		static UInt32 mPackedIBCurrOffset;
+		static OffsetAllocator mPackedVBAllocator;
+		static OffsetAllocator mPackedVIBAllocator;
+		static OffsetAllocator mPackedIBAllocator;
 		static UInt32 mCurrDrawCallIndex;
 
+		static vector<InstanceRange> mInstanceRanges;                  // meshId -> instance range
+		static vector<MeshResidency> mMeshResidencies;                 // meshId -> geometry in the packed buffers, kept between the collections
+		static vector<DrawIndexedIndirectCommand> mIndirectCommands;   // meshId -> indirect command in the indirect buffer
+
+		static vector<UInt8> mMeshVisibility[(UInt32)ECullingView::NUM_CULLING_VIEW]; // meshId -> visible or not, empty if not culled yet
+
+		static vector<PendingUpload> mPendingUploads;
+		static vector<UInt32>        mPendingUploadIndices;  // meshId -> index of its pending upload, UInt32(-1) if none
+		static vector<Byte>          mPendingInstanceData;
+		static vector<BufferHandle>  mUploadStagingBuffers;  // one for each frame in flight
+
+		static BufferHandle mPackedVertexBuffer;
+		static BufferHandle mPackedIndexBuffer;
+		static BufferHandle mIndirectBuffer;
+		static BufferHandle mIndirectReadBackBuffer;
+		static BufferHandle mInstanceBuffer;
+		static BufferHandle mInstanceOutputBuffer;
+		static BufferHandle mInstanceSumTableBuffer;
+
 		static vector<VulkanCommandBuffer> mResetCommands;
 		static vector<VulkanCommandBuffer> mCullingCommands;
 		static vector<VulkanCommandBuffer> mTransferCommands;
@@ -26,7 +26,7 @@ namespace SG
 	}
 
 	DockSpaceLayer::DockSpaceLayer()
-		:ILayer("Dockspace"), mpSelectedEntityNode(nullptr)
+		:ILayer("Dockspace"), mpSelectedEntity(nullptr)
 	{
 		Input::RegisterListener(EListenerPriority::eLevel0, this);
 	}
@@ -265,6 +265,11 @@ namespace SG
 		DrawGUIDragFloat("Gamma", compositionUbo.gamma, 2.2f, 0.05f, 1.0f, 10.0f);
 		DrawGUIDragFloat("Exposure", compositionUbo.exposure, 1.0f, 0.05f, 0.01f, 50.0f);
 
+		ImGui::Separator();
+
+		if (ImGui::Checkbox("Debug Draw", &mbDebugDraw))
+			mMessageBusMember.PushEvent<bool>("DebugDrawChanged", mbDebugDraw);
+
 		ImGui::End();
 	}
 
@@ -333,36 +338,39 @@ namespace SG
 		gTextFilter.Draw("##Filter", ImGui::GetContentRegionAvail().x);
 
 		auto pScene = SSystem()->GetMainScene();
-		auto* pRootNode = pScene->GetTreeRepresentation();
+		auto& hierarchy = pScene->GetTreeRepresentation();
 
 		// draw entity tree
-		for (auto* pChild : pRootNode->pChilds)
-			DrawSceneTreeNode(pChild, false);
+		hierarchy.TraverseChildren(SceneHierarchy::ROOT_NODE, [this, &hierarchy](Scene::NodeID child)
+			{
+				DrawSceneTreeNode(hierarchy, child, false);
+			});
 
 		if (ImGui::IsMouseDown(0) && ImGui::IsWindowHovered())
 		{
-			mpSelectedEntityNode = nullptr;
-			mMessageBusMember.PushEvent<Scene::TreeNode*>("OnSelectedEntityChanged", mpSelectedEntityNode);
+			mpSelectedEntity = nullptr;
+			mMessageBusMember.PushEvent<Scene::Entity*>("OnSelectedEntityChanged", mpSelectedEntity);
 		}
 
 		ImGui::End();
 	}
 
-	void DockSpaceLayer::DrawSceneTreeNode(Scene::TreeNode* pNode, bool bPass)
+	void DockSpaceLayer::DrawSceneTreeNode(const SceneHierarchy& hierarchy, Scene::NodeID node, bool bPass)
 	{
 		SG_PROFILE_FUNCTION();
 
 		// draw entity tree node
-		auto& tag = pNode->pEntity->GetComponent<TagComponent>();
+		auto& tag = hierarchy.GetEntity(node)->GetComponent<TagComponent>();
 		bool bHasChildPass = false;
 		if (!bPass) // if this node's parent passed?
 		{
 			bPass = gTextFilter.PassFilter(tag.name.c_str());
 			if (!bPass) // if this node passed?
 			{
-				for (auto* pChild : pNode->pChilds) // if this node didn't passed, check its children.
+				// if this node didn't passed, check its children.
+				for (auto child = hierarchy.GetFirstChild(node); child != SceneHierarchy::INVALID_NODE; child = hierarchy.GetNextSibling(child))
 				{
-					bHasChildPass = TestNodePassFilter(pChild);
+					bHasChildPass = TestNodePassFilter(hierarchy, child);
 					if (bHasChildPass)
 						break;
 				}
@@ -372,34 +380,34 @@ namespace SG
 		if (bPass || bHasChildPass)
 		{
 			ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
-			flags |= pNode->pChilds.empty() ? ImGuiTreeNodeFlags_Leaf : ImGuiTreeNodeFlags_DefaultOpen;
+			flags |= !hierarchy.HasChild(node) ? ImGuiTreeNodeFlags_Leaf : ImGuiTreeNodeFlags_DefaultOpen;
 			bool bOpened = ImGui::TreeNodeEx(tag.name.c_str(), flags);
 
 			if (ImGui::IsItemClicked())
 			{
-				mpSelectedEntityNode = pNode;
-				mMessageBusMember.PushEvent<Scene::TreeNode*>("OnSelectedEntityChanged", mpSelectedEntityNode);
+				mpSelectedEntity = hierarchy.GetEntity(node);
+				mMessageBusMember.PushEvent<Scene::Entity*>("OnSelectedEntityChanged", mpSelectedEntity);
 			}
 
 			if (bOpened)
 			{
-				for (auto* pChild : pNode->pChilds)
-					DrawSceneTreeNode(pChild, bPass);
+				for (auto child = hierarchy.GetFirstChild(node); child != SceneHierarchy::INVALID_NODE; child = hierarchy.GetNextSibling(child))
+					DrawSceneTreeNode(hierarchy, child, bPass);
 				ImGui::TreePop();
 			}
 		}
 	}
 
-	bool DockSpaceLayer::TestNodePassFilter(Scene::TreeNode* pNode)
+	bool DockSpaceLayer::TestNodePassFilter(const SceneHierarchy& hierarchy, Scene::NodeID node)
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (pNode->pChilds.empty()) // it is a leaf node
-			return gTextFilter.PassFilter(pNode->pEntity->GetComponent<TagComponent>().name.c_str());
+		if (!hierarchy.HasChild(node)) // it is a leaf node
+			return gTextFilter.PassFilter(hierarchy.GetEntity(node)->GetComponent<TagComponent>().name.c_str());
 
-		for (auto& pChild : pNode->pChilds)
+		for (auto child = hierarchy.GetFirstChild(node); child != SceneHierarchy::INVALID_NODE; child = hierarchy.GetNextSibling(child))
 		{
-			if (TestNodePassFilter(pChild))
+			if (TestNodePassFilter(hierarchy, child))
 				return true;
 		}
 		return false;
@@ -411,8 +419,8 @@ namespace SG
 
 		ImGui::Begin("Property");
 
-		if (mpSelectedEntityNode)
-			DrawEntityProperty(mpSelectedEntityNode);
+		if (mpSelectedEntity)
+			DrawEntityProperty(*mpSelectedEntity);
 
 		ImGui::End();
 	}
@@ -479,7 +487,7 @@ namespace SG
 
 	void DockSpaceLayer::OpenScene()
 	{
-		string path = FileSystem::OpenFileDialog(OperatingSystem::GetMainWindow(), "SG Scene (*.scene)\0*.scene\0");
+		string path = FileSystem::OpenFileDialog(OperatingSystem::GetMainWindow(), "SG Scene (*.scene;*.scenebin)\0*.scene;*.scenebin\0");
 		if (path.empty())
 			return;
 
@@ -535,8 +543,8 @@ namespace SG
 		mMessageBusMember.PushEvent("RenderDataRebuild");
 
 		Input::ForceReleaseAllEvent(); // to avoid causing short cut key status error
-		mpSelectedEntityNode = nullptr;
-		mMessageBusMember.PushEvent<Scene::TreeNode*>("OnSelectedEntityChanged", mpSelectedEntityNode);
+		mpSelectedEntity = nullptr;
+		mMessageBusMember.PushEvent<Scene::Entity*>("OnSelectedEntityChanged", mpSelectedEntity);
 	}
 
 }
\ No newline at end of file
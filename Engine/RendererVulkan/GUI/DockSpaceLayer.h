@@ -44,8 +44,8 @@ namespace SG
 
 		void OnSceneRebuild(RefPtr<Scene> pNewScene);
 
-		void DrawSceneTreeNode(Scene::TreeNode* pNode, bool bPass);
-		bool TestNodePassFilter(Scene::TreeNode* pNode);
+		void DrawSceneTreeNode(const SceneHierarchy& hierarchy, Scene::NodeID node, bool bPass);
+		bool TestNodePassFilter(const SceneHierarchy& hierarchy, Scene::NodeID node);
 	private:
 		MessageBusMember mMessageBusMember;
 
@@ -58,12 +58,13 @@ namespace SG
 
 		ReadOnlyHandle<VulkanDescriptorSet*> mViewportTexHandle;
 		ReadOnlyHandle<VulkanDescriptorSet*> mImageViewerTexHandle;
-		Scene::TreeNode* mpSelectedEntityNode;
+		Scene::Entity* mpSelectedEntity;
 
 		string mSavedSceneName = "default.scene";
 		bool mbViewportOnFocused = false;
 		bool mbViewportOnHovered = false;
 		bool mbShowStatisticsDetail = true;
+		bool mbDebugDraw = true;
 		bool mbShowSaveSceneProgressBar = false;
 		bool mbTriggerSave = false;
 		bool mbTriggerOpen = false;
@@ -90,21 +90,11 @@ namespace SG
 		}
 	}
 
-	static void _MarkChildrenDirty(Scene::TreeNode* pTreeNode)
-	{
-		if (pTreeNode->pChilds.empty())
-			pTreeNode->pEntity->GetComponent<TagComponent>().bDirty = true;
-
-		for (auto* pChild : pTreeNode->pChilds)
-			_MarkChildrenDirty(pChild);
-	}
-
-	bool DrawEntityProperty(Scene::TreeNode* pTreeNode)
+	bool DrawEntityProperty(Scene::Entity& entity)
 	{
 		ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_AllowItemOverlap;
 		flags |= ImGuiTreeNodeFlags_SpanAvailWidth;
 
-		auto& entity = *pTreeNode->pEntity;
 		auto& tag = entity.GetComponent<TagComponent>();
 
 		char buffer[256];
@@ -146,7 +136,7 @@ namespace SG
 		DrawComponent<MeshComponent>(entity, [&tag](MeshComponent& comp)
 			{
 				ImGui::Text("MeshType:   %s", MeshTypeToExtString(comp.meshType));
-				ImGui::Text("ObjectId:   %d", comp.objectId);
+				ImGui::Text("ObjectId:   %d (gen %d)", comp.objectId, comp.objectGeneration);
 				ImGui::Text("MeshId:     %d", comp.meshId);
 				ImGui::Text("InstanceId: %d", comp.instanceId);
 				ImGui::Text("AABBMin: (%.2f, %.2f, %.2f)", comp.aabb.min.x, comp.aabb.min.y, comp.aabb.min.z);
@@ -182,9 +172,7 @@ namespace SG
 			});
 		ImGui::PopID();
 
-		if (tag.bDirty)
-			_MarkChildrenDirty(pTreeNode);
-
+		// the dirty flag will be propagated to the children by the scene
 		return false;
 	}
 
@@ -8,7 +8,7 @@
 namespace SG
 {
 
-	bool DrawEntityProperty(Scene::TreeNode* pTreeNode);
+	bool DrawEntityProperty(Scene::Entity& entity);
 
 	bool DrawGUIDragFloat(const string& label, float& values, float defaultValue = 0.0f, float speed = 0.05f,
 		float minValue = 0.0f, float maxValue = 0.0f, float columnWidth = 100.0f);
@@ -8,6 +8,7 @@
 
 #include "Math/MathBasic.h"
 #include "Math/Plane.h"
+#include "Math/Frustum.h"
 #include "Archive/MeshDataArchive.h"
 #include "Profile/Profile.h"
 #include "Render/CommonRenderData.h"
@@ -17,6 +18,7 @@
 #include "RendererVulkan/Backend/VulkanCommand.h"
 #include "RendererVulkan/Backend/VulkanQueryPool.h"
 #include "RendererVulkan/Backend/VulkanSynchronizePrimitive.h"
+#include "RendererVulkan/Backend/VulkanDescriptorCache.h"
 
 // TODO: add graphic api abstraction
 #include "RendererVulkan/RenderGraph/RenderGraph.h"
@@ -149,11 +151,24 @@ namespace SG
 			SG_PROFILE_SCOPE("Listening Events");
 
 			mMessageBusMember.ListenFor("RenderDataRebuild", SG_BIND_MEMBER_FUNC(OnRenderDataRebuild));
+			mMessageBusMember.ListenFor<vector<RefPtr<TextureAsset>>>("OnTextureAssetsLoaded", SG_BIND_MEMBER_FUNC(OnTextureAssetsLoaded));
 			mMessageBusMember.ListenFor<bool>("StatisticsShowDetailChanged", SG_BIND_MEMBER_FUNC(OnShowStatisticsChanged));
 		}
 
 		mpRenderGraph->Update();
 		VK_RESOURCE()->OnUpdate();
+
+		// patch the draw calls with the changes of the render data in this frame, collect all of them again only if the patch is not enough.
+		if (!GPUDrivenDP::UpdateRenderData(SSystem()->GetRenderDataBuilder()))
+		{
+			// the draw calls and the descriptor sets may be used by the frames in flight
+			mpContext->device.WaitIdle();
+			OnRenderDataRebuild();
+		}
+
+		// cull the draw calls against the camera and the shadow casting light, the light space matrix had been updated above.
+		auto pCamera = SSystem()->GetMainScene()->GetMainCamera().GetComponent<CameraComponent>().pCamera;
+		GPUDrivenDP::CullDrawCalls(SSystem()->GetRenderDataBuilder(), pCamera->GetFrustum(), Frustum::FromViewProj(GetShadowUBO().lightSpaceVP));
 	}
 
 	void VulkanRenderDevice::OnDraw()
@@ -178,6 +193,9 @@ namespace SG
 #endif
 		}
 
+		// the descriptor sets released by the finished frames can be freed.
+		mpContext->pDescriptorCache->NextFrame();
+
 		{
 			SG_PROFILE_SCOPE("Render Command Reset");
 
@@ -197,7 +215,8 @@ namespace SG
 			VulkanSemaphore* waitSemaphores[1] = { mpContext->pPresentCompleteSemaphore };
 #endif
 #if SG_ENABLE_GPU_CULLING
-			EPipelineStage waitStages[2] = { EPipelineStage::efColor_Attachment_Output, EPipelineStage::efCompute_Shader };
+			// the uploads of the frame overwrite the instances which the culling reads.
+			EPipelineStage waitStages[2] = { EPipelineStage::efColor_Attachment_Output, EPipelineStage::efCompute_Shader | EPipelineStage::efTransfer };
 #else
 			EPipelineStage waitStages[1] = { EPipelineStage::efColor_Attachment_Output };
 #endif
@@ -236,7 +255,7 @@ namespace SG
 			auto& statisticData = GetStatisticData();
 			statisticData.culledSceneObjects = static_cast<UInt32>(SSystem()->GetMainScene()->GetMeshEntityCount());
 #if SG_ENABLE_GPU_CULLING
-			auto* pIndirectReadBackBuffer = VK_RESOURCE()->GetBuffer("indirectBuffer_read_back");
+			auto* pIndirectReadBackBuffer = GPUDrivenDP::GetIndirectReadBackBuffer();
 			auto* pIndirectCommands = pIndirectReadBackBuffer->MapMemory<DrawIndexedIndirectCommand>();
 			for (UInt32 i = 0; i < MeshDataArchive::GetInstance()->GetNumMeshData(); ++i)
 				statisticData.culledSceneObjects -= (pIndirectCommands + i)->instanceCount;
@@ -356,7 +375,8 @@ namespace SG
 			if (pAsset->GetAssetType() == EAssetType::eTexture)
 			{
 				TextureAsset* pTextureAsset = static_cast<TextureAsset*>(pAsset.get());
-				pTextureAsset->FreeMemory();
+				if (pTextureAsset->IsDiskResourceLoaded()) // may had been released by the other event in this frame
+					pTextureAsset->FreeMemory();
 				SG_ASSERT(!pTextureAsset->IsDiskResourceLoaded());
 			}
 		}
@@ -371,6 +391,22 @@ namespace SG
 		VK_RESOURCE()->WaitBuffersUpdated();
 	}
 
+	void VulkanRenderDevice::OnTextureAssetsLoaded(const vector<RefPtr<TextureAsset>>& textureAssets)
+	{
+		SG_PROFILE_FUNCTION();
+
+		// the streamed in textures are collected as the new assets of this frame by the RenderDataBuilder.
+		auto pRenderDataBuilder = SSystem()->GetRenderDataBuilder();
+		if (pRenderDataBuilder->GetCurrentFrameNewAssets().empty())
+			return;
+
+		CreateVKResourceFromAsset(pRenderDataBuilder);
+
+		// the material descriptor sets may be used by the frames in flight
+		mpContext->device.WaitIdle();
+		GPUDrivenDP::RebindMaterialTextures(pRenderDataBuilder);
+	}
+
 	void VulkanRenderDevice::OnShowStatisticsChanged(bool bActive)
 	{
 		if (bActive)
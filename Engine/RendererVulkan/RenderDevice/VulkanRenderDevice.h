@@ -17,6 +17,7 @@ namespace SG
 
 	class VulkanContext;
 	class RenderGraph;
+	class TextureAsset;
 
 	class DockSpaceLayer;
 
@@ -43,6 +44,7 @@ namespace SG
 		void CreateVKResourceFromAsset(RefPtr<RenderDataBuilder> pRenderDataBuilder);
 
 		void OnRenderDataRebuild();
+		void OnTextureAssetsLoaded(const vector<RefPtr<TextureAsset>>& textureAssets);
 		void OnShowStatisticsChanged(bool bActive);
 	private:
 		VulkanContext* mpContext = nullptr;
@@ -2,6 +2,7 @@
 #include "RenderGraph.h"
 
 #include "System/Logger.h"
+#include "Thread/IJobSystem.h"
 
 #include "RendererVulkan/Backend/VulkanContext.h"
 #include "RendererVulkan/Backend/VulkanQueue.h"
@@ -10,8 +11,10 @@
 #include "RendererVulkan/Backend/VulkanFrameBuffer.h"
 
 #include "RendererVulkan/Resource/RenderResourceRegistry.h"
+#include "RendererVulkan/DrawProtocol/GPUDrivenDP.h"
 
 #include "Stl/Hash.h"
+#include "EASTL/algorithm.h"
 
 namespace SG
 {
@@ -51,6 +54,7 @@ namespace SG
 	RenderGraph::RenderGraph(const char* name, VulkanContext* pContext)
 		: mName(name), mpContext(pContext)
 	{
+		mpCommandPool = MakeUnique<RGCommandPool>(*pContext, static_cast<UInt32>(pContext->commandBuffers.size()));
 	}
 
 	RenderGraph::~RenderGraph()
@@ -66,6 +70,9 @@ namespace SG
 			Delete(beg->second);
 		for (auto& beg = mFrameBuffersMap.begin(); beg != mFrameBuffersMap.end(); ++beg)
 			Delete(beg->second);
+
+		// the aliased render targets only own their images, the images may outlive the memory as long as they are not used anymore.
+		FreeTransientMemory(mTransientMemory);
 	}
 
 	void RenderGraph::Update()
@@ -74,9 +81,18 @@ namespace SG
 
 		for (auto* pCurrNode : mpNodes)
 			pCurrNode->Update();
+
+		// some nodes had been enabled or disabled, the render passes and the frame buffers are cached,
+		// so it only creates the ones of the nodes which are scheduled for the first time.
+		if (mbScheduleDirty)
+		{
+			CompileSchedule();
+			CompileResourceStatus();
+			CompileNodes();
+		}
 	}
 
-	void RenderGraph::Draw(UInt32 frameIndex) const
+	void RenderGraph::Draw(UInt32 frameIndex)
 	{
 		SG_PROFILE_FUNCTION();
 
@@ -85,94 +101,345 @@ namespace SG
 		auto& commandBuf = mpContext->commandBuffers[frameIndex];
 		DrawInfo drawInfo = { &commandBuf, frameIndex };
 
+		// the fence of this frame had been waited, its secondary command buffers are not pending anymore.
+		mpCommandPool->Reset(frameIndex);
+
+		mExecutionFrameBuffers.clear();
+		mRecordBatches.clear();
+		for (auto i : mExecutionOrder)
+		{
+			auto* pCurrNode = mpNodes[i];
+
+			const Size renderpassHash = GetRenderPassHash(pCurrNode, i);
+			const Size framebufferHash = GetFrameBufferHash(pCurrNode, renderpassHash, frameIndex);
+			auto* pFrameBuffer = mFrameBuffersMap.find(framebufferHash)->second;
+			mExecutionFrameBuffers.push_back(pFrameBuffer);
+
+			const UInt32 numBatch = pCurrNode->GetNumRecordBatch();
+			for (UInt32 batch = 0; batch < numBatch; ++batch)
+				mRecordBatches.push_back({ i, batch, numBatch, pFrameBuffer });
+		}
+
+		// the batches are recorded on the job workers, while the main thread records the barriers and the inline nodes.
+		auto recordBatch = [this, frameIndex](UInt32 index)
+		{
+			auto& batch = mRecordBatches[index];
+			batch.pCmdBuf = mpCommandPool->Allocate(frameIndex);
+			if (!batch.pCmdBuf)
+				return;
+
+			DrawInfo batchDrawInfo = { batch.pCmdBuf, frameIndex, batch.batchIndex, batch.numBatch };
+			batch.pCmdBuf->BeginSecondaryRecord(batch.pFrameBuffer);
+			mpNodes[batch.nodeIndex]->Draw(batchDrawInfo);
+			batch.pCmdBuf->EndRecord();
+		};
+		SJobHandle recordHandle = JobSystem::ParallelFor(static_cast<UInt32>(mRecordBatches.size()), 1, recordBatch);
+
 		commandBuf.BeginRecord();
 		commandBuf.ResetQueryPool(mpContext->pPipelineStatisticsQueryPool);
 		commandBuf.ResetQueryPool(mpContext->pTimeStampQueryPool);
 
-		for (auto* pCurrNode : mpNodes)
+		// the newly created resources whose content is read before being written need a defined layout.
+		commandBuf.ImageBarriers(mResourceStatusKeeper.GetInitialTransitions());
+		mResourceStatusKeeper.ClearInitialTransitions();
+		// the render data changed since the last frame, before any node reads it.
+		GPUDrivenDP::RecordUploads(commandBuf, frameIndex);
+
+		UInt32 currBatch = 0;
+		for (UInt32 order = 0; order < mExecutionOrder.size(); ++order)
 		{
-			// calculate the hash data
-			Size renderpassHash = 0;
-			Size framebufferHash = 0;
-			for (auto& resource : pCurrNode->mInResources)
+			const UInt32 i = mExecutionOrder[order];
+			auto* pCurrNode = mpNodes[i];
+			auto* pFrameBuffer = mExecutionFrameBuffers[order];
+
+			// all the transitions of this pass boundary in one barrier
+			commandBuf.ImageBarriers(mResourceStatusKeeper.GetNodeTransitions(i));
+
+			if (currBatch < mRecordBatches.size() && mRecordBatches[currBatch].nodeIndex == i)
 			{
-				if (resource.has_value())
-				{
-					const bool bHaveMultiResource = resource->GetNumRenderTarget() != 1 ? true : false;
+				commandBuf.BeginRenderPass(pFrameBuffer, pCurrNode->GetClearValues(), pCurrNode->GetNumResource(), true);
 
-					renderpassHash = resource->GetRenderPassHash(renderpassHash);
-					framebufferHash = resource->GetFrameBufferHash(renderpassHash, bHaveMultiResource ? frameIndex : 0);
+				// help the workers to record the remaining batches.
+				recordHandle.Complete();
+				mSecondaryCmdBufs.clear();
+				for (; currBatch < mRecordBatches.size() && mRecordBatches[currBatch].nodeIndex == i; ++currBatch)
+				{
+					if (mRecordBatches[currBatch].pCmdBuf)
+						mSecondaryCmdBufs.push_back(mRecordBatches[currBatch].pCmdBuf);
 				}
+				commandBuf.ExecuteCommands(mSecondaryCmdBufs);
+			}
+			else
+			{
+				commandBuf.BeginRenderPass(pFrameBuffer, pCurrNode->GetClearValues(), pCurrNode->GetNumResource());
+				pCurrNode->Draw(drawInfo);
 			}
-			auto* pFrameBuffer = mFrameBuffersMap.find(framebufferHash)->second;
-
-			commandBuf.BeginRenderPass(pFrameBuffer, pCurrNode->GetClearValues(), pCurrNode->GetNumResource());
-			pCurrNode->Draw(drawInfo);
 			commandBuf.EndRenderPass();
 		}
 		commandBuf.EndRecord();
+
+		// the jobs reference the recordBatch lambda on the stack.
+		JobSystem::CompleteAndDispose(recordHandle);
 	}
 
 	void RenderGraph::WindowResize()
 	{
 		SG_PROFILE_FUNCTION();
 
-		mpContext->pGraphicQueue->WaitIdle();
+		// the sizes of the transient render targets had changed, create them in their own memory to get the new memory requirements.
+		VulkanMemoryPlacement oldTransientMemory = mTransientMemory;
+		mTransientMemory = {};
+		VK_RESOURCE()->ClearRenderTargetPlacements();
 
-		for (auto& beg = mFrameBuffersMap.begin(); beg != mFrameBuffersMap.end(); ++beg)
-			Delete(beg->second);
-		mFrameBuffersMap.clear();
+		ResetNodes();
+		FreeTransientMemory(oldTransientMemory);
 
-		mResourceStatusKeeper.Clear();
+		if (CompileTransientMemory())
+			ResetNodes();
 
-		// after the resizing, all the render targets had been recreated,
-		// reset the node to update the resources which is using.
-		for (auto* pCurrNode : mpNodes)
-		{
-			pCurrNode->Reset();
+		CompileNodes();
+	}
+
+	void RenderGraph::Compile()
+	{
+		SG_PROFILE_FUNCTION();
 
+		for (auto* pCurrNode : mpNodes) // iterate all nodes
+		{
 			if (!pCurrNode->HaveValidResource())
 			{
 				SG_LOG_ERROR("No resource bound to this RenderGraphNode!");
 				SG_ASSERT(false);
 			}
+		}
+
+		CompileSchedule();
+		CompileResourceStatus();
+		if (CompileTransientMemory())
+			ResetNodes();
+
+		CompileNodes();
+	}
+
+	void RenderGraph::CompileSchedule()
+	{
+		SG_PROFILE_FUNCTION();
+
+		mCompiler.Reset();
+		mCompiledResources.clear();
+
+		eastl::hash_map<VulkanRenderTarget*, UInt32> resourceIndices;
+		auto GetResourceIndex = [&](VulkanRenderTarget* pRenderTarget)
+		{
+			auto node = resourceIndices.find(pRenderTarget);
+			if (node != resourceIndices.end())
+				return node->second;
+
+			// the swapchain images are presented after the render graph
+			const bool bOutput = eastl::find(mpContext->colorRts.begin(), mpContext->colorRts.end(), pRenderTarget) != mpContext->colorRts.end();
+			const UInt32 index = mCompiler.AddResource(bOutput);
+			resourceIndices[pRenderTarget] = index;
+			mCompiledResources.push_back(pRenderTarget);
+			return index;
+		};
+
+		for (auto* pCurrNode : mpNodes)
+		{
+			const UInt32 pass = mCompiler.AddPass(EQueueType::eGraphic, pCurrNode->IsEnabled());
+			for (auto& read : pCurrNode->mReadResources)
+			{
+				auto* pRenderTarget = VK_RESOURCE()->GetRenderTarget(read.first);
+				if (pRenderTarget)
+					mCompiler.Read(pass, GetResourceIndex(pRenderTarget));
+			}
+
+			for (auto& resource : pCurrNode->mInResources)
+			{
+				if (!resource.has_value())
+					continue;
+
+				auto* pRenderTarget = resource->GetRenderTarget();
+				const UInt32 index = GetResourceIndex(pRenderTarget);
+				const auto& op = resource->GetLoadStoreClearOp();
+				if (op.loadOp == ELoadOp::eLoad || (pRenderTarget->IsDepth() && op.stencilLoadOp == ELoadOp::eLoad))
+					mCompiler.Read(pass, index);
+				mCompiler.Write(pass, index);
+			}
+		}
+		mCompiler.Compile();
 
-			CompileFrameBuffers(pCurrNode);
+		mExecutionOrder.clear();
+		for (auto pass : mCompiler.GetExecutionOrder())
+		{
+			if (!mCompiler.IsPassCulled(pass))
+				mExecutionOrder.push_back(pass);
 		}
+		mbScheduleDirty = false;
 	}
 
-	void RenderGraph::Compile()
+	void RenderGraph::CompileResourceStatus()
 	{
 		SG_PROFILE_FUNCTION();
 
-		for (auto* pCurrNode : mpNodes) // iterate all nodes
+		mResourceStatusKeeper.BeginCompile(static_cast<UInt32>(mpNodes.size()));
+		for (auto i : mExecutionOrder)
+		{
+			auto* pCurrNode = mpNodes[i];
+			for (auto& read : pCurrNode->mReadResources)
+			{
+				auto* pRenderTarget = VK_RESOURCE()->GetRenderTarget(read.first);
+				if (pRenderTarget)
+					mResourceStatusKeeper.AddReadUse(i, pRenderTarget, read.second);
+			}
+
+			for (auto& resource : pCurrNode->mInResources)
+			{
+				if (resource.has_value())
+					mResourceStatusKeeper.AddAttachmentUse(i, *resource);
+			}
+		}
+		mResourceStatusKeeper.EndCompile();
+	}
+
+	bool RenderGraph::CompileTransientMemory()
+	{
+		SG_PROFILE_FUNCTION();
+
+		vector<VulkanRenderTarget*> pTransientRts;
+		vector<RGAliasingResource>  resources;
+		UInt32 memoryTypeBits = ~0u;
+		UInt64 alignment = 1;
+		for (UInt32 i = 0; i < mCompiledResources.size(); ++i)
+		{
+			// the lifetimes count the culled nodes in, so the placements stay valid when the nodes are enabled again.
+			auto* pRenderTarget = mCompiledResources[i];
+			UInt32 firstPosition, lastPosition;
+			if (!mCompiler.GetResourceLifetime(i, firstPosition, lastPosition) || !mCompiler.IsResourceTransient(i) ||
+				!SG_HAS_ENUM_FLAG(pRenderTarget->GetMemoryFlag(), EGPUMemoryFlag::efTransient))
+				continue;
+
+			const VkMemoryRequirements memReqs = pRenderTarget->GetMemoryRequirements();
+			if ((memoryTypeBits & memReqs.memoryTypeBits) == 0)
+			{
+				SG_LOG_WARN("Transient render target can not share the memory type with the others, it would not be aliased!");
+				continue;
+			}
+			memoryTypeBits &= memReqs.memoryTypeBits;
+			alignment = eastl::max<UInt64>(alignment, memReqs.alignment);
+
+			pTransientRts.push_back(pRenderTarget);
+			resources.push_back({ firstPosition, lastPosition, memReqs.size, memReqs.alignment });
+		}
+
+		mTransientMemoryReport = PlaceAliasedResources(resources);
+		if (mTransientMemoryReport.numResource == 0)
+			return false;
+
+		SG_LOG_INFO("RenderGraph(%s) transient render targets: %d, separate: %.2f MB, peak alive: %.2f MB, aliased: %.2f MB", mName,
+			mTransientMemoryReport.numResource,
+			mTransientMemoryReport.separateSize / (1024.0 * 1024.0),
+			mTransientMemoryReport.peakLiveSize / (1024.0 * 1024.0),
+			mTransientMemoryReport.aliasedSize / (1024.0 * 1024.0));
+
+		// nothing to save, keep them in their own memory.
+		if (mTransientMemoryReport.aliasedSize >= mTransientMemoryReport.separateSize)
+			return false;
+
+		VkMemoryRequirements memReqs = {};
+		memReqs.size = mTransientMemoryReport.aliasedSize;
+		memReqs.alignment = alignment;
+		memReqs.memoryTypeBits = memoryTypeBits;
+#if SG_USE_VULKAN_MEMORY_ALLOCATOR
+		VmaAllocationCreateInfo vmaAllocationCI = {};
+		vmaAllocationCI.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+		vmaAllocationCI.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		VK_CHECK(vmaAllocateMemory(mpContext->vmaAllocator, &memReqs, &vmaAllocationCI, &mTransientMemory.allocation, nullptr),
+			SG_LOG_ERROR("Failed to allocate the transient memory!"); mTransientMemory = {}; return false;);
+#else
+		VkMemoryAllocateInfo memAllloc = {};
+		memAllloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memAllloc.allocationSize = memReqs.size;
+		memAllloc.memoryTypeIndex = mpContext->device.GetMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		VK_CHECK(vkAllocateMemory(mpContext->device.logicalDevice, &memAllloc, nullptr, &mTransientMemory.memory),
+			SG_LOG_ERROR("Failed to allocate the transient memory!"); mTransientMemory = {}; return false;);
+#endif
+
+		for (UInt32 i = 0; i < pTransientRts.size(); ++i)
 		{
+			VulkanMemoryPlacement placement = mTransientMemory;
+			placement.offset = resources[i].offset;
+			VK_RESOURCE()->SetRenderTargetPlacement(pTransientRts[i], placement);
+		}
+		return true;
+	}
+
+	void RenderGraph::FreeTransientMemory(VulkanMemoryPlacement& memory)
+	{
+#if SG_USE_VULKAN_MEMORY_ALLOCATOR
+		if (memory.allocation)
+			vmaFreeMemory(mpContext->vmaAllocator, memory.allocation);
+#else
+		if (memory.memory != VK_NULL_HANDLE)
+			vkFreeMemory(mpContext->device.logicalDevice, memory.memory, nullptr);
+#endif
+		memory = {};
+	}
+
+	void RenderGraph::ResetNodes()
+	{
+		SG_PROFILE_FUNCTION();
+
+		mpContext->pGraphicQueue->WaitIdle();
+
+		for (auto& beg = mFrameBuffersMap.begin(); beg != mFrameBuffersMap.end(); ++beg)
+			Delete(beg->second);
+		mFrameBuffersMap.clear();
+
+		mResourceStatusKeeper.Clear();
+
+		// reset the node to create the render targets again and update the resources which is using.
+		// a node which creates a transient render target must create it again in Reset(), so that it is placed in the shared memory.
+		for (auto* pCurrNode : mpNodes)
+		{
+			// the render targets read by this node are recreated by the previous nodes,
+			// track their statuses before the node binds them to the descriptors again.
+			pCurrNode->TrackResourceReads();
+			pCurrNode->Reset();
+
 			if (!pCurrNode->HaveValidResource())
 			{
 				SG_LOG_ERROR("No resource bound to this RenderGraphNode!");
 				SG_ASSERT(false);
 			}
-
-			auto* pRenderPass = CompileRenderPasses(pCurrNode);
-			CompileFrameBuffers(pCurrNode);
-
-			pCurrNode->Prepare(pRenderPass);
 		}
+
+		CompileSchedule();
+		CompileResourceStatus();
 	}
 
-	VulkanRenderPass* RenderGraph::CompileRenderPasses(const RenderGraphNode* pCurrNode)
+	void RenderGraph::CompileNodes()
 	{
 		SG_PROFILE_FUNCTION();
 
-		Size renderpassHash = 0;
-		for (auto& resource : pCurrNode->mInResources)
+		for (auto i : mExecutionOrder)
 		{
-			if (resource.has_value())
+			auto* pCurrNode = mpNodes[i];
+			auto* pRenderPass = CompileRenderPasses(pCurrNode, i);
+			CompileFrameBuffers(pCurrNode, i);
+
+			if (!pCurrNode->mbPrepared)
 			{
-				// calculate the hash value
-				renderpassHash = resource->GetRenderPassHash(renderpassHash);
+				pCurrNode->Prepare(pRenderPass);
+				pCurrNode->mbPrepared = true;
 			}
 		}
+	}
+
+	VulkanRenderPass* RenderGraph::CompileRenderPasses(const RenderGraphNode* pCurrNode, UInt32 nodeIndex)
+	{
+		SG_PROFILE_FUNCTION();
+
+		const Size renderpassHash = GetRenderPassHash(pCurrNode, nodeIndex);
 
 		// retrieve the render pass of this node
 		auto& pRenderPassNode = mRenderPassesMap.find(renderpassHash);
@@ -183,7 +450,7 @@ namespace SG
 			{
 				if (resource.has_value())
 				{
-					auto statusTransition = mResourceStatusKeeper.GetResourceNextStatus(resource->GetRenderTarget());
+					auto statusTransition = mResourceStatusKeeper.GetAttachmentStatus(nodeIndex, resource->GetRenderTarget());
 					rpBuilder.BindRenderTarget(resource->GetRenderTarget(), resource->GetLoadStoreClearOp(),
 						statusTransition.srcStatus, statusTransition.dstStatus);
 				}
@@ -195,7 +462,7 @@ namespace SG
 		return pRenderPassNode->second;
 	}
 
-	void RenderGraph::CompileFrameBuffers(const RenderGraphNode* pCurrNode)
+	void RenderGraph::CompileFrameBuffers(const RenderGraphNode* pCurrNode, UInt32 nodeIndex)
 	{
 		SG_PROFILE_FUNCTION();
 
@@ -209,35 +476,24 @@ namespace SG
 			}
 		}
 
-		// calculate the hash data
+		const Size renderpassHash = GetRenderPassHash(pCurrNode, nodeIndex);
 		for (UInt32 i = 0; i < maxNum; ++i)
 		{
-			Size renderpassHash = 0;
-			Size framebufferHash = 0;
-			vector<VulkanRenderTarget*> frameRtCollection;
-
-			for (auto& resource : pCurrNode->mInResources)
-			{
-				if (resource.has_value())
-				{
-					bool bHaveMultiResource = false;
-					if (resource->GetNumRenderTarget() != 1)
-						bHaveMultiResource = true;
-
-					frameRtCollection.emplace_back(resource->GetRenderTarget(bHaveMultiResource ? i : 0));
-
-					renderpassHash = resource->GetRenderPassHash(renderpassHash);
-					framebufferHash = resource->GetFrameBufferHash(renderpassHash, bHaveMultiResource ? i : 0);
-				}
-			}
+			const Size framebufferHash = GetFrameBufferHash(pCurrNode, renderpassHash, i);
 
 			// create the framebuffer of this node if it doesn't exist
 			auto& pFrameBufferNode = mFrameBuffersMap.find(framebufferHash);
 			if (pFrameBufferNode == mFrameBuffersMap.end()) // Didn't find this framebuffer, then create a new one
 			{
 				VulkanFrameBuffer::Builder fbBuilder(mpContext->device);
-				for (auto* resource : frameRtCollection)
-					fbBuilder.AddRenderTarget(resource);
+				for (auto& resource : pCurrNode->mInResources)
+				{
+					if (resource.has_value())
+					{
+						const bool bHaveMultiResource = resource->GetNumRenderTarget() != 1 ? true : false;
+						fbBuilder.AddRenderTarget(resource->GetRenderTarget(bHaveMultiResource ? i : 0));
+					}
+				}
 
 				auto* pRenderPass = mRenderPassesMap.find(renderpassHash)->second;
 				auto* pFrameBuffer = fbBuilder.BindRenderPass(pRenderPass).Build();
@@ -247,6 +503,37 @@ namespace SG
 		}
 	}
 
+	Size RenderGraph::GetRenderPassHash(const RenderGraphNode* pCurrNode, UInt32 nodeIndex) const
+	{
+		Size renderpassHash = 0;
+		for (auto& resource : pCurrNode->mInResources)
+		{
+			if (resource.has_value())
+			{
+				renderpassHash = resource->GetRenderPassHash(renderpassHash);
+
+				auto statusTransition = mResourceStatusKeeper.GetAttachmentStatus(nodeIndex, resource->GetRenderTarget());
+				UInt32 status[2] = { static_cast<UInt32>(statusTransition.srcStatus), static_cast<UInt32>(statusTransition.dstStatus) };
+				renderpassHash = HashMemory32Array(status, 2, renderpassHash);
+			}
+		}
+		return renderpassHash;
+	}
+
+	Size RenderGraph::GetFrameBufferHash(const RenderGraphNode* pCurrNode, Size renderpassHash, UInt32 frameIndex) const
+	{
+		Size framebufferHash = renderpassHash;
+		for (auto& resource : pCurrNode->mInResources)
+		{
+			if (resource.has_value())
+			{
+				const bool bHaveMultiResource = resource->GetNumRenderTarget() != 1 ? true : false;
+				framebufferHash = resource->GetFrameBufferHash(framebufferHash, bHaveMultiResource ? frameIndex : 0);
+			}
+		}
+		return framebufferHash;
+	}
+
 	void RenderGraph::ResetFrameBuffer(RenderGraphNode* pNode, Size frameBufferHash) noexcept
 	{
 		SG_PROFILE_FUNCTION();
@@ -257,21 +544,20 @@ namespace SG
 			Delete(node->second);
 			mFrameBuffersMap.erase(node);
 		}
-		CompileFrameBuffers(pNode);
-	}
-
-	void RenderGraph::AddResourceDenpendency(VulkanRenderTarget* pRenderTarget, EResourceBarrier srcStatus, EResourceBarrier dstStatus)
-	{
-		SG_PROFILE_FUNCTION();
 
-		mResourceStatusKeeper.AddResourceDenpendency(pRenderTarget, srcStatus, dstStatus);
+		auto pNodeIter = eastl::find(mpNodes.begin(), mpNodes.end(), pNode);
+		SG_ASSERT(pNodeIter != mpNodes.end());
+		const UInt32 nodeIndex = static_cast<UInt32>(pNodeIter - mpNodes.begin());
+		// the frame buffers of a culled node are created when it is scheduled again
+		if (!mCompiler.IsPassCulled(nodeIndex))
+			CompileFrameBuffers(pNode, nodeIndex);
 	}
 
-	void RenderGraph::RemoveResourceDenpendency(VulkanRenderTarget* pRenderTarget)
+	void RenderGraph::TrackResourceRead(VulkanRenderTarget* pRenderTarget, EResourceBarrier status)
 	{
 		SG_PROFILE_FUNCTION();
 
-		mResourceStatusKeeper.RemoveResourceDenpendency(pRenderTarget);
+		mResourceStatusKeeper.TrackResourceRead(pRenderTarget, status);
 	}
 
 }
\ No newline at end of file
@@ -4,10 +4,16 @@
 
 #include "RenderGraphNode.h"
 #include "RenderGraphDependency.h"
+#include "RenderGraphAliasing.h"
+#include "RenderGraphCommandPool.h"
+
+#include "RendererVulkan/Backend/VulkanAllocator.h"
+
+#include "Render/RenderGraphCompiler.h"
 
 #include "Stl/SmartPtr.h"
-#include "eastl/type_traits.h"
-#include "eastl/hash_map.h"
+#include "EASTL/type_traits.h"
+#include "EASTL/hash_map.h"
 
 namespace SG
 {
@@ -49,22 +55,40 @@ namespace SG
 		~RenderGraph();
 
 		void Update();
-		void Draw(UInt32 frameIndex) const;
+		void Draw(UInt32 frameIndex);
 		void WindowResize();
 
 		SG_INLINE const char* GetName() const { return mName; }
+		//! How much memory the transient render targets take, and how much the aliasing saves.
+		SG_INLINE const RGTransientMemoryReport& GetTransientMemoryReport() const { return mTransientMemoryReport; }
 	private:
 		void ResetFrameBuffer(RenderGraphNode* pNode, Size frameBufferHash) noexcept;
 
-		void AddResourceDenpendency(VulkanRenderTarget* pRenderTarget, EResourceBarrier srcStatus, EResourceBarrier dstStatus);
-		void RemoveResourceDenpendency(VulkanRenderTarget* pRenderTarget);
+		void TrackResourceRead(VulkanRenderTarget* pRenderTarget, EResourceBarrier status);
+		void OnNodeEnabledChanged() { mbScheduleDirty = true; }
 
 		//! Compile the render graph to create necessary data for renderer to use.
 		//! If the nodes of this render graph had changed, compile it again.
 		void Compile();
 
-		VulkanRenderPass* CompileRenderPasses(const RenderGraphNode* pCurrNode);
-		void CompileFrameBuffers(const RenderGraphNode* pCurrNode);
+		//! Sort the nodes by the resources they read and write, and cull the disabled nodes and the nodes whose results are not used.
+		void CompileSchedule();
+		//! Collect the attachments and the reads of the nodes in the execution order, then derive the statuses of the resources and the barriers between the nodes.
+		void CompileResourceStatus();
+		//! Place the transient render targets whose lifetimes do not overlap in the same memory.
+		//! Return true if the render targets should be created again to be placed in the shared memory.
+		bool CompileTransientMemory();
+		void FreeTransientMemory(VulkanMemoryPlacement& memory);
+		//! Reset all the nodes to create their resources again, and derive the statuses of the new resources.
+		void ResetNodes();
+		//! Create the render passes and the frame buffers of the scheduled nodes, and prepare the nodes scheduled for the first time.
+		void CompileNodes();
+		VulkanRenderPass* CompileRenderPasses(const RenderGraphNode* pCurrNode, UInt32 nodeIndex);
+		void CompileFrameBuffers(const RenderGraphNode* pCurrNode, UInt32 nodeIndex);
+
+		//! The layouts of the attachments are part of the render pass, so the derived statuses are hashed too.
+		Size GetRenderPassHash(const RenderGraphNode* pCurrNode, UInt32 nodeIndex) const;
+		Size GetFrameBufferHash(const RenderGraphNode* pCurrNode, Size renderpassHash, UInt32 frameIndex) const;
 	private:
 		friend class RenderGraphNode;
 		friend class RenderGraphBuilder;
@@ -77,8 +101,20 @@ namespace SG
 		eastl::hash_map<Size, VulkanFrameBuffer*> mFrameBuffersMap;
 
 		vector<RenderGraphNode*> mpNodes;
+		RenderGraphCompiler      mCompiler;
+		vector<VulkanRenderTarget*> mCompiledResources; //!< Resource index in mCompiler -> render target.
+		vector<UInt32>           mExecutionOrder;       //!< Indices of the nodes not culled, in the execution order.
+		bool                     mbScheduleDirty = false;
 
 		RGResourceStatusKeeper mResourceStatusKeeper;
+
+		VulkanMemoryPlacement  mTransientMemory; //!< Memory shared by the transient render targets.
+		RGTransientMemoryReport mTransientMemoryReport;
+
+		UniquePtr<RGCommandPool>    mpCommandPool;
+		vector<RGRecordBatch>       mRecordBatches;         //!< Batches of the nodes recorded on the job workers, in the execution order.
+		vector<VulkanFrameBuffer*>  mExecutionFrameBuffers; //!< Frame buffers of the nodes in mExecutionOrder of the current frame.
+		vector<VulkanCommandBuffer*> mSecondaryCmdBufs;
 	};
 
 }
\ No newline at end of file
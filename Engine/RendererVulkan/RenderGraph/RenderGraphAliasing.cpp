@@ -0,0 +1,84 @@
+#include "StdAfx.h"
+#include "RenderGraphAliasing.h"
+
+#include "EASTL/algorithm.h"
+
+namespace SG
+{
+
+	namespace // anonymous namespace
+	{
+		UInt64 _AlignUp(UInt64 value, UInt64 alignment)
+		{
+			return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+		}
+
+		bool _IsLifetimeOverlapped(const RGAliasingResource& lhs, const RGAliasingResource& rhs)
+		{
+			return lhs.firstNode <= rhs.lastNode && rhs.firstNode <= lhs.lastNode;
+		}
+	}
+
+	RGTransientMemoryReport PlaceAliasedResources(vector<RGAliasingResource>& resources)
+	{
+		RGTransientMemoryReport report = {};
+		report.numResource = static_cast<UInt32>(resources.size());
+
+		for (auto& resource : resources)
+		{
+			report.separateSize += resource.size;
+
+			// the live memory only grows when a resource begins its lifetime
+			UInt64 liveSize = 0;
+			for (auto& other : resources)
+			{
+				if (other.firstNode <= resource.firstNode && resource.firstNode <= other.lastNode)
+					liveSize += other.size;
+			}
+			report.peakLiveSize = eastl::max(report.peakLiveSize, liveSize);
+		}
+
+		vector<UInt32> order(resources.size());
+		for (UInt32 i = 0; i < order.size(); ++i)
+			order[i] = i;
+		eastl::sort(order.begin(), order.end(), [&resources](UInt32 lhs, UInt32 rhs)
+			{
+				if (resources[lhs].size != resources[rhs].size)
+					return resources[lhs].size > resources[rhs].size;
+				return resources[lhs].firstNode < resources[rhs].firstNode;
+			});
+
+		vector<UInt32> placed;
+		vector<eastl::pair<UInt64, UInt64>> occupied;
+		placed.reserve(resources.size());
+		for (UInt32 index : order)
+		{
+			auto& resource = resources[index];
+
+			// the memory ranges of the placed resources which are alive at the same time
+			occupied.clear();
+			for (UInt32 placedIndex : placed)
+			{
+				const auto& other = resources[placedIndex];
+				if (_IsLifetimeOverlapped(resource, other))
+					occupied.emplace_back(other.offset, other.offset + other.size);
+			}
+			eastl::sort(occupied.begin(), occupied.end());
+
+			// first fit in the gaps between the occupied ranges
+			UInt64 offset = 0;
+			for (auto& range : occupied)
+			{
+				if (_AlignUp(offset, resource.alignment) + resource.size <= range.first)
+					break;
+				offset = eastl::max(offset, range.second);
+			}
+			resource.offset = _AlignUp(offset, resource.alignment);
+
+			report.aliasedSize = eastl::max(report.aliasedSize, resource.offset + resource.size);
+			placed.emplace_back(index);
+		}
+		return report;
+	}
+
+}
\ No newline at end of file
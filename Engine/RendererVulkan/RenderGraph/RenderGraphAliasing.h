@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Base/BasicTypes.h"
+
+#include "Stl/vector.h"
+
+namespace SG
+{
+
+	//! A transient resource to place in the memory shared by the transient resources of a render graph.
+	struct RGAliasingResource
+	{
+		UInt32 firstNode; //!< Index of the first node using it in the execution order.
+		UInt32 lastNode;  //!< Index of the last node using it in the execution order.
+		UInt64 size;
+		UInt64 alignment;
+		UInt64 offset = 0; //!< Output, offset in the shared memory.
+	};
+
+	//! Memory of the transient resources of a render graph, to know how much the aliasing saves.
+	struct RGTransientMemoryReport
+	{
+		UInt32 numResource  = 0;
+		UInt64 separateSize = 0; //!< Every transient resource in its own memory.
+		UInt64 peakLiveSize = 0; //!< The most memory used at one node, the lower bound of the aliased size.
+		UInt64 aliasedSize  = 0; //!< Size of the memory shared by all of them.
+	};
+
+	//! Place the resources in one memory block, the resources whose lifetimes do not overlap may share the same range.
+	//! The biggest resource is placed first, each resource takes the lowest offset which do not overlap the placed resources alive at the same time.
+	RGTransientMemoryReport PlaceAliasedResources(vector<RGAliasingResource>& resources);
+
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "StdAfx.h"
+#include "RenderGraphCommandPool.h"
+
+#include "System/Logger.h"
+#include "Thread/IJobSystem.h"
+#include "Memory/Memory.h"
+
+#include "RendererVulkan/Backend/VulkanContext.h"
+#include "RendererVulkan/Backend/VulkanCommand.h"
+
+namespace SG
+{
+
+	RGCommandPool::RGCommandPool(VulkanContext& context, UInt32 numFrame)
+		:mContext(context), mNumThread(JobSystem::GetNumWorkers() + 1)
+	{
+		mThreadPools.resize(numFrame * mNumThread);
+		for (auto& threadPool : mThreadPools)
+			threadPool.pPool = VulkanCommandPool::Create(mContext.device, VK_QUEUE_GRAPHICS_BIT, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+	}
+
+	RGCommandPool::~RGCommandPool()
+	{
+		for (auto& threadPool : mThreadPools)
+		{
+			for (auto* pCmdBuf : threadPool.pCmdBufs)
+			{
+				threadPool.pPool->FreeCommandBuffer(*pCmdBuf);
+				Delete(pCmdBuf);
+			}
+			Delete(threadPool.pPool);
+		}
+	}
+
+	void RGCommandPool::Reset(UInt32 frameIndex)
+	{
+		SG_PROFILE_FUNCTION();
+
+		SG_ASSERT((frameIndex + 1) * mNumThread <= mThreadPools.size());
+		for (UInt32 i = frameIndex * mNumThread; i < (frameIndex + 1) * mNumThread; ++i)
+		{
+			auto& threadPool = mThreadPools[i];
+			if (threadPool.numUsed == 0)
+				continue;
+			threadPool.pPool->Reset();
+			threadPool.numUsed = 0;
+		}
+	}
+
+	VulkanCommandBuffer* RGCommandPool::Allocate(UInt32 frameIndex)
+	{
+		const UInt32 threadIndex = JobSystem::GetCurrThreadIndex();
+		SG_ASSERT(threadIndex < mNumThread);
+
+		auto& threadPool = mThreadPools[frameIndex * mNumThread + threadIndex];
+		if (threadPool.numUsed == threadPool.pCmdBufs.size())
+		{
+			auto* pCmdBuf = New(VulkanCommandBuffer);
+			if (!threadPool.pPool->AllocateCommandBuffer(*pCmdBuf, false))
+			{
+				Delete(pCmdBuf);
+				return nullptr;
+			}
+			threadPool.pCmdBufs.push_back(pCmdBuf);
+		}
+		return threadPool.pCmdBufs[threadPool.numUsed++];
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+
+#include "Stl/vector.h"
+
+namespace SG
+{
+
+	class VulkanContext;
+	class VulkanCommandPool;
+	class VulkanCommandBuffer;
+	class VulkanFrameBuffer;
+
+	//! A part of a node recorded into a secondary command buffer on a job worker.
+	struct RGRecordBatch
+	{
+		UInt32               nodeIndex;
+		UInt32               batchIndex;
+		UInt32               numBatch;
+		VulkanFrameBuffer*   pFrameBuffer;
+		VulkanCommandBuffer* pCmdBuf = nullptr; //!< Output, nullptr if failed to allocate.
+	};
+
+	//! Secondary command buffers which the nodes of a render graph are recorded into on the job workers.
+	//! Every thread allocates from its own command pool of the frame, so the recording needs no lock,
+	//! and all the pools of a frame are reset at once after the GPU had finished the frame.
+	class RGCommandPool
+	{
+	public:
+		RGCommandPool(VulkanContext& context, UInt32 numFrame);
+		~RGCommandPool();
+		SG_CLASS_NO_COPY_ASSIGNABLE(RGCommandPool);
+
+		//! Reset all the command buffers of the frame, the command buffers of the frame must not be pending on the GPU.
+		void Reset(UInt32 frameIndex);
+		//! Get a secondary command buffer from the pool of the calling thread. It is valid until the frame is reset.
+		VulkanCommandBuffer* Allocate(UInt32 frameIndex);
+	private:
+		struct ThreadPool
+		{
+			VulkanCommandPool*           pPool = nullptr;
+			vector<VulkanCommandBuffer*> pCmdBufs; //!< Allocated once, reused after the pool is reset.
+			UInt32                       numUsed = 0;
+		};
+
+		VulkanContext&     mContext;
+		UInt32             mNumThread;
+		vector<ThreadPool> mThreadPools; //!< frameIndex * mNumThread + threadIndex -> pool.
+	};
+
+}
\ No newline at end of file
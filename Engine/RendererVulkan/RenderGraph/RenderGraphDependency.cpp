@@ -3,68 +3,144 @@
 
 #include "System/Logger.h"
 
+#include "RendererVulkan/Backend/VulkanTexture.h"
+#include "RendererVulkan/RenderGraph/RenderGraphResource.h"
+#include "RendererVulkan/Utils/VkConvert.h"
+
 namespace SG
 {
 
-	void RGResourceStatusKeeper::AddResourceDenpendency(VulkanRenderTarget* pRenderTarget, EResourceBarrier srcStatus, EResourceBarrier dstStatus)
+	void RGResourceStatusKeeper::TrackResourceRead(VulkanRenderTarget* pRenderTarget, EResourceBarrier status)
 	{
-		//if (mDenpendencies.find(pRenderTarget) != mDenpendencies.end())
-		//{
-		//	SG_LOG_WARN("Already add dependency to this resource!");
-		//	return;
-		//}
-
-		mDenpendencies[pRenderTarget] = { srcStatus, dstStatus };
-		// init current resource status
-		mCurrResourcesStaus[pRenderTarget] = srcStatus;
+		auto node = mReadStatuses.find(pRenderTarget);
+		if (node != mReadStatuses.end() && node->second != status)
+			SG_LOG_WARN("Resource is read in different statuses, the descriptors may sample it in a wrong layout!");
+		mReadStatuses[pRenderTarget] = status;
+
+		const VkImageLayout layout = ToVkImageLayout(status);
+		for (auto& currLayout : pRenderTarget->currLayouts)
+			currLayout = layout;
 	}
 
-	void RGResourceStatusKeeper::RemoveResourceDenpendency(VulkanRenderTarget* pRenderTarget)
+	void RGResourceStatusKeeper::BeginCompile(UInt32 numNode)
 	{
-		if (mDenpendencies.find(pRenderTarget) != mDenpendencies.end() &&
-			mCurrResourcesStaus.find(pRenderTarget) != mCurrResourcesStaus.end())
-		{
-			mDenpendencies.erase(pRenderTarget);
-			mCurrResourcesStaus.erase(pRenderTarget);
-			return;
-		}
-		//SG_LOG_WARN("No dependency had been added to this resource!");
+		mResourceRecords.clear();
+		mNodeTransitions.clear();
+		mNodeTransitions.resize(numNode);
+		mInitialTransitions.clear();
 	}
 
-	RGResourceDenpendency RGResourceStatusKeeper::GetResourceNextStatus(VulkanRenderTarget* pRenderTarget)
+	void RGResourceStatusKeeper::AddAttachmentUse(UInt32 nodeIndex, const RenderGraphInReousrce& resource)
 	{
-		if (mDenpendencies.find(pRenderTarget) == mDenpendencies.end())
+		auto* pRenderTarget = resource.GetRenderTarget();
+		auto& record = mResourceRecords[pRenderTarget];
+		if (record.pRenderTargets.empty())
 		{
-			SG_LOG_DEBUG("This resource have no dependency added to it yet!");
-			SG_ASSERT(false);
+			for (UInt32 i = 0; i < resource.GetNumRenderTarget(); ++i)
+				record.pRenderTargets.emplace_back(resource.GetRenderTarget(i));
 		}
 
-		++mCurrNodeIndex;
-		auto& dependencyNode = mDenpendencies[pRenderTarget];
-		auto& currDependency = mCurrResourcesStaus[pRenderTarget];
-		if (currDependency == dependencyNode.srcStatus)
+		const auto& op = resource.GetLoadStoreClearOp();
+		ResourceUse use = {};
+		use.nodeIndex = nodeIndex;
+		use.status = pRenderTarget->IsDepth() ? EResourceBarrier::efDepth_Stencil : EResourceBarrier::efRenderTarget;
+		use.declaredDstStatus = resource.GetDstStatus();
+		use.bAttachment = true;
+		use.bLoadContent = (op.loadOp == ELoadOp::eLoad) || (pRenderTarget->IsDepth() && op.stencilLoadOp == ELoadOp::eLoad);
+		record.uses.emplace_back(use);
+	}
+
+	void RGResourceStatusKeeper::AddReadUse(UInt32 nodeIndex, VulkanRenderTarget* pRenderTarget, EResourceBarrier status)
+	{
+		auto& record = mResourceRecords[pRenderTarget];
+		if (record.pRenderTargets.empty())
+			record.pRenderTargets.emplace_back(pRenderTarget);
+
+		ResourceUse use = {};
+		use.nodeIndex = nodeIndex;
+		use.status = status;
+		use.bAttachment = false;
+		use.bLoadContent = true;
+		record.uses.emplace_back(use);
+	}
+
+	void RGResourceStatusKeeper::EndCompile()
+	{
+		for (auto& node : mResourceRecords)
 		{
-			currDependency = dependencyNode.dstStatus;
-			return { dependencyNode.srcStatus, dependencyNode.dstStatus };
+			auto& record = node.second;
+			auto& uses = record.uses;
+			if (uses.empty())
+				continue;
+
+			// the status at the end of a frame, which is also the status at the beginning of the next frame.
+			const auto& lastUse = uses.back();
+			EResourceBarrier frameStatus = lastUse.status;
+			if (lastUse.bAttachment && lastUse.declaredDstStatus != EResourceBarrier::efUndefined)
+				frameStatus = lastUse.declaredDstStatus;
+
+			EResourceBarrier currStatus = frameStatus;
+			for (UInt32 i = 0; i < uses.size(); ++i)
+			{
+				auto& use = uses[i];
+				if (use.bAttachment)
+				{
+					// the render pass leaves the resource in the status of the next use, no barrier is needed between them.
+					use.transition.srcStatus = use.bLoadContent ? currStatus : EResourceBarrier::efUndefined;
+					use.transition.dstStatus = (i + 1 < uses.size()) ? uses[i + 1].status : frameStatus;
+				}
+				else
+				{
+					use.transition = { currStatus, use.status };
+					if (currStatus != use.status)
+						mNodeTransitions[use.nodeIndex].push_back({ record.pRenderTargets[0], currStatus, use.status });
+				}
+				currStatus = use.transition.dstStatus;
+			}
+
+			if (uses.front().bLoadContent)
+			{
+				for (auto* pRenderTarget : record.pRenderTargets)
+					mInitialTransitions.push_back({ pRenderTarget, EResourceBarrier::efUndefined, frameStatus });
+			}
+			else if (record.pRenderTargets[0]->IsAliased())
+			{
+				// the memory had been used by the other resources since its last use, wait for them before it is written.
+				const auto& firstUse = uses.front();
+				mNodeTransitions[firstUse.nodeIndex].push_back({ record.pRenderTargets[0], EResourceBarrier::efUndefined, firstUse.status, true });
+			}
 		}
-		else
+	}
+
+	RGResourceDenpendency RGResourceStatusKeeper::GetAttachmentStatus(UInt32 nodeIndex, VulkanRenderTarget* pRenderTarget) const
+	{
+		auto node = mResourceRecords.find(pRenderTarget);
+		if (node != mResourceRecords.end())
 		{
-			return { currDependency, dependencyNode.dstStatus };
+			for (auto& use : node->second.uses)
+			{
+				if (use.bAttachment && use.nodeIndex == nodeIndex)
+					return use.transition;
+			}
 		}
+
+		SG_LOG_ERROR("This resource is not an attachment of the node, compile the render graph first!");
+		SG_ASSERT(false);
+		return { EResourceBarrier::efUndefined, EResourceBarrier::efUndefined };
 	}
 
-	void RGResourceStatusKeeper::Reset()
+	const vector<ImageTransition>& RGResourceStatusKeeper::GetNodeTransitions(UInt32 nodeIndex) const
 	{
-		for (auto& node : mCurrResourcesStaus) // reset all to the srcStatus
-			node.second = mDenpendencies[node.first].srcStatus;
-		mCurrNodeIndex = 0;
+		SG_ASSERT(nodeIndex < mNodeTransitions.size());
+		return mNodeTransitions[nodeIndex];
 	}
 
 	void RGResourceStatusKeeper::Clear()
 	{
-		mDenpendencies.clear();
-		mCurrResourcesStaus.clear();
-		mCurrNodeIndex = 0;
+		mResourceRecords.clear();
+		mReadStatuses.clear();
+		mNodeTransitions.clear();
+		mInitialTransitions.clear();
 	}
 
 }
\ No newline at end of file
@@ -2,32 +2,73 @@
 
 #include "Render/ResourceBarriers.h"
 
+#include "RendererVulkan/Backend/VulkanCommand.h"
+
+#include "Stl/vector.h"
 #include "Stl/unordered_map.h"
 
 namespace SG
 {
 
 	class VulkanRenderTarget;
+	class RenderGraphInReousrce;
 
+	//! Status of a render target at the beginning and at the end of a render pass.
 	struct RGResourceDenpendency
 	{
 		EResourceBarrier srcStatus;
 		EResourceBarrier dstStatus;
 	};
 
+	//! Derive the statuses of the render targets from how the nodes use them.
+	//! A node writes its attachments and reads the resources it declared in the shaders. The uses are walked in
+	//! the execution order to decide the initial and final layouts of the render passes and the barriers before them,
+	//! so that a transition is only recorded when the status really changes.
 	class RGResourceStatusKeeper
 	{
 	public:
-		void AddResourceDenpendency(VulkanRenderTarget* pRenderTarget, EResourceBarrier srcStatus, EResourceBarrier dstStatus);
-		void RemoveResourceDenpendency(VulkanRenderTarget* pRenderTarget);
+		//! The resource is read by the shaders in this status. The texture is tracked in this status from now on,
+		//! so the descriptors which are bound after this call sample it in the right layout.
+		void TrackResourceRead(VulkanRenderTarget* pRenderTarget, EResourceBarrier status);
+
+		//! Begin to collect the uses of the resources, the uses should be added in the execution order of the nodes.
+		void BeginCompile(UInt32 numNode);
+		void AddAttachmentUse(UInt32 nodeIndex, const RenderGraphInReousrce& resource);
+		void AddReadUse(UInt32 nodeIndex, VulkanRenderTarget* pRenderTarget, EResourceBarrier status);
+		//! Derive the statuses of all the uses collected.
+		void EndCompile();
+
+		//! The initial and the final status of the attachment in the render pass of the node.
+		RGResourceDenpendency GetAttachmentStatus(UInt32 nodeIndex, VulkanRenderTarget* pRenderTarget) const;
+		//! The transitions to record before the render pass of the node begins.
+		const vector<ImageTransition>& GetNodeTransitions(UInt32 nodeIndex) const;
+		//! The transitions to bring the resources from undefined to the status they are in at the beginning of a frame.
+		//! Only the resources whose content is read before being written need them, they are recorded once after compiling.
+		SG_INLINE const vector<ImageTransition>& GetInitialTransitions() const { return mInitialTransitions; }
+		SG_INLINE void ClearInitialTransitions() { mInitialTransitions.clear(); }
 
-		RGResourceDenpendency GetResourceNextStatus(VulkanRenderTarget* pRenderTarget);
-		void Reset();
 		void Clear();
 	private:
-		unordered_map<VulkanRenderTarget*, RGResourceDenpendency> mDenpendencies;
-		unordered_map<VulkanRenderTarget*, EResourceBarrier>      mCurrResourcesStaus;
-		UInt32 mCurrNodeIndex = 0;
+		struct ResourceUse
+		{
+			UInt32           nodeIndex;
+			EResourceBarrier status;       //!< The status the node uses the resource in.
+			EResourceBarrier declaredDstStatus = EResourceBarrier::efUndefined; //!< Of the attachments, the status to leave the resource in at the end of a frame.
+			bool             bAttachment;
+			bool             bLoadContent; //!< The previous content of the resource is used.
+			RGResourceDenpendency transition = { EResourceBarrier::efUndefined, EResourceBarrier::efUndefined };
+		};
+
+		struct ResourceRecord
+		{
+			vector<VulkanRenderTarget*> pRenderTargets; //!< More than one for the render targets per frame, i.e. the swapchain images.
+			vector<ResourceUse>         uses;
+		};
+	private:
+		unordered_map<VulkanRenderTarget*, ResourceRecord>   mResourceRecords;
+		unordered_map<VulkanRenderTarget*, EResourceBarrier> mReadStatuses;
+		vector<vector<ImageTransition>> mNodeTransitions;
+		vector<ImageTransition>         mInitialTransitions;
 	};
 
 }
\ No newline at end of file
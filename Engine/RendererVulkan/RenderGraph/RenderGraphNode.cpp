@@ -5,8 +5,9 @@
 #include "RendererVulkan/RenderGraph/RenderGraph.h"
 
 #include "RendererVulkan/Backend/VulkanTexture.h"
+#include "RendererVulkan/Resource/RenderResourceRegistry.h"
 
-#include <eastl/algorithm.h>
+#include <EASTL/algorithm.h>
 
 namespace SG
 {
@@ -37,12 +38,8 @@ namespace SG
 	void RenderGraphNode::AttachResource(UInt32 slot, const RenderGraphInReousrce& resource)
 	{
 		SG_ASSERT(slot <= SG_MAX_RENDER_GRAPH_NODE_RESOURCE && "Exceed the maximun limit of render graph node resources.");
-		if ((mResourceValidFlag & UInt32(1 << slot)) != 0) // already add a resource to this slot
-			mpRenderGraph->RemoveResourceDenpendency(mInResources[slot]->GetRenderTarget());
-
 		mInResources[slot] = resource;
 		mResourceValidFlag |= UInt32(1 << slot);
-		mpRenderGraph->AddResourceDenpendency(resource.GetRenderTarget(), resource.GetSrcStatus(), resource.GetDstStatus());
 
 		mClearValues[slot] = mInResources[slot]->GetClearValue();
 	}
@@ -52,7 +49,6 @@ namespace SG
 		SG_ASSERT(slot <= SG_MAX_RENDER_GRAPH_NODE_RESOURCE && "Exceed the maximun limit of render graph node resources.");
 		SG_ASSERT((mResourceValidFlag & UInt32(1 << slot)) != 0 && "No resource had been attach to this slot");
 
-		mpRenderGraph->RemoveResourceDenpendency(mInResources[slot]->GetRenderTarget());
 		mInResources[slot].reset();
 		mResourceValidFlag &= UInt32(~(1 << slot));
 	}
@@ -63,7 +59,6 @@ namespace SG
 		{
 			if (mInResources[i] == resource)
 			{
-				mpRenderGraph->RemoveResourceDenpendency(mInResources[i]->GetRenderTarget());
 				mInResources[i].reset();
 				mResourceValidFlag &= UInt32(~(1 << i));
 				break;
@@ -75,13 +70,51 @@ namespace SG
 	void RenderGraphNode::ClearResources()
 	{
 		for (auto& resource : mInResources)
-		{
-			mpRenderGraph->RemoveResourceDenpendency(resource->GetRenderTarget());
 			resource.reset();
-		}
 		mResourceValidFlag = 0;
 	}
 
+	void RenderGraphNode::ReadResource(const char* name, EResourceBarrier status)
+	{
+		auto* pRenderTarget = VK_RESOURCE()->GetRenderTarget(name);
+		if (!pRenderTarget)
+		{
+			SG_LOG_ERROR("Only the render targets can be read in a render graph!");
+			SG_ASSERT(false);
+			return;
+		}
+
+		auto pRead = eastl::find_if(mReadResources.begin(), mReadResources.end(), [name](const auto& read) { return read.first == name; });
+		if (pRead != mReadResources.end())
+			pRead->second = status;
+		else
+			mReadResources.emplace_back(name, status);
+		mpRenderGraph->TrackResourceRead(pRenderTarget, status);
+	}
+
+	void RenderGraphNode::TrackResourceReads()
+	{
+		for (auto& read : mReadResources)
+		{
+			auto* pRenderTarget = VK_RESOURCE()->GetRenderTarget(read.first);
+			if (!pRenderTarget)
+			{
+				SG_LOG_ERROR("Only the render targets can be read in a render graph!");
+				SG_ASSERT(false);
+				continue;
+			}
+			mpRenderGraph->TrackResourceRead(pRenderTarget, read.second);
+		}
+	}
+
+	void RenderGraphNode::SetEnabled(bool bEnabled)
+	{
+		if (mbEnabled == bEnabled)
+			return;
+		mbEnabled = bEnabled;
+		mpRenderGraph->OnNodeEnabledChanged();
+	}
+
 	void RenderGraphNode::ResetFrameBuffer(Size frameBufferHash)
 	{
 		mpRenderGraph->ResetFrameBuffer(this, frameBufferHash);
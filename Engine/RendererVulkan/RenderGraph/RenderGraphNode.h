@@ -6,8 +6,9 @@
 #include "RenderGraphResource.h"
 
 #include "Stl/vector.h"
-#include "eastl/array.h"
-#include "eastl/optional.h"
+#include "Stl/string.h"
+#include "EASTL/array.h"
+#include "EASTL/optional.h"
 
 namespace SG
 {
@@ -28,6 +29,7 @@ namespace SG
 
 		const ClearValue* GetClearValues() const { return mClearValues.data(); }
 		UInt32 GetNumResource() const;
+		bool   IsEnabled() const { return mbEnabled; }
 	protected:
 
 		const InResourceType& GetResource(UInt32 slot);
@@ -37,6 +39,14 @@ namespace SG
 
 		void ClearResources();
 
+		//! Declare the render target is read by the shaders of this node in the status, i.e. sampled as a texture.
+		//! The render graph transitions it to this status before the node draws, call it before binding the render target to descriptors.
+		void ReadResource(const char* name, EResourceBarrier status = EResourceBarrier::efShader_Resource);
+
+		//! A disabled node is culled by the render graph, so are the nodes which only produce the resources for it.
+		//! The render graph schedules the nodes again in the next Update().
+		void SetEnabled(bool bEnabled);
+
 		//! Callback function to notify the render graph this node had changed the frame buffer.
 		void ResetFrameBuffer(Size frameBufferHash);
 	protected:
@@ -48,8 +58,13 @@ namespace SG
 		virtual void Prepare(VulkanRenderPass* pRenderpass) = 0;
 		//! Be called every frame to record render command.
 		virtual void Draw(DrawInfo& context) = 0;
+		//! How many secondary command buffers this node is split into, they are recorded on the job workers by calling Draw() with each batch index. (optional)
+		//! Return 0 to record it inline on the main thread, i.e. the node submits other work or its commands can not be split.
+		virtual UInt32 GetNumRecordBatch() const { return 0; }
 	private:
 		bool HaveValidResource() const;
+		//! Track the statuses of the resources read by this node again, i.e. after the render targets were recreated.
+		void TrackResourceReads();
 	private:
 		friend class RenderGraph;
 		friend class RenderGraphBuilder;
@@ -57,7 +72,10 @@ namespace SG
 		RenderGraph* mpRenderGraph = nullptr;
 		eastl::array<InResourceType, SG_MAX_RENDER_GRAPH_NODE_RESOURCE> mInResources;
 		eastl::array<ClearValue, SG_MAX_RENDER_GRAPH_NODE_RESOURCE> mClearValues;
+		vector<eastl::pair<string, EResourceBarrier>> mReadResources;
 		UInt32 mResourceValidFlag;
+		bool   mbEnabled = true;
+		bool   mbPrepared = false; //!< Prepare() is called when the node is not culled for the first time.
 	};
 
 }
\ No newline at end of file
@@ -11,6 +11,8 @@ namespace SG
 	{
 		VulkanCommandBuffer* pCmd;
 		UInt32               frameIndex;
+		UInt32               batchIndex = 0; //!< Which part of the node is recorded into pCmd, see RenderGraphNode::GetNumRecordBatch().
+		UInt32               numBatch = 1;
 	};
 
 }
\ No newline at end of file
@@ -55,7 +55,7 @@ namespace SG
 		vbCreateInfo.pInitData = dots.data();
 		vbCreateInfo.bufferSize = static_cast<UInt32>(dots.size()) * sizeof(float);
 		vbCreateInfo.memoryUsage = EGPUMemoryUsage::eGPU_Only;
-		VK_RESOURCE()->CreateBuffer(vbCreateInfo);
+		mDebugGeoBuffer = VK_RESOURCE()->CreateBuffer(vbCreateInfo);
 
 		VK_RESOURCE()->FlushBuffers();
 	}
@@ -69,7 +69,8 @@ namespace SG
 
 	void RGDebugNode::Update()
 	{
-		mMessageBusMember.ListenFor<Scene::TreeNode*>("OnSelectedEntityChanged", SG_BIND_MEMBER_FUNC(OnSelectedEntityChanged));
+		mMessageBusMember.ListenFor<Scene::Entity*>("OnSelectedEntityChanged", SG_BIND_MEMBER_FUNC(OnSelectedEntityChanged));
+		mMessageBusMember.ListenFor<bool>("DebugDrawChanged", SG_BIND_MEMBER_FUNC(OnDebugDrawChanged));
 	}
 
 	void RGDebugNode::Reset()
@@ -114,7 +115,7 @@ namespace SG
 		auto DrawDebugBox = [this](VulkanCommandBuffer& cmd)
 		{
 			UInt64 offset[] = { 0 };
-			auto& pVertexBuffer = *VK_RESOURCE()->GetBuffer("debug_geo");
+			auto& pVertexBuffer = *VK_RESOURCE()->GetBuffer(mDebugGeoBuffer);
 			cmd.BindVertexBuffer(0, 1, pVertexBuffer, offset);
 			cmd.BindPipelineSignatureNonDynamic(mpDebugLinePipelineSignature.get());
 			cmd.BindPipeline(mpDebugLinePipeline);
@@ -126,17 +127,17 @@ namespace SG
 
 		auto& cmd = *context.pCmd;
 
-		if (mpSelectedEntityTreeNode && mpSelectedEntityTreeNode->pEntity->HasComponent<MeshComponent>())
+		if (mpSelectedEntity && mpSelectedEntity->HasComponent<MeshComponent>())
 		{
-			auto& mesh = mpSelectedEntityTreeNode->pEntity->GetComponent<MeshComponent>();
+			auto& mesh = mpSelectedEntity->GetComponent<MeshComponent>();
 			mDebugObjectModelMat = glm::translate(Matrix4f(1.0f), AABBCenter(mesh.aabb)) *
 				glm::scale(Matrix4f(1.0f), AABBExtent(mesh.aabb));
 
 			DrawDebugBox(cmd);
 		}
-		else if (mpSelectedEntityTreeNode && mpSelectedEntityTreeNode->pEntity->HasComponent<DDGIVolumnComponent>())
+		else if (mpSelectedEntity && mpSelectedEntity->HasComponent<DDGIVolumnComponent>())
 		{
-			auto& ddgiVolumn = mpSelectedEntityTreeNode->pEntity->GetComponent<DDGIVolumnComponent>();
+			auto& ddgiVolumn = mpSelectedEntity->GetComponent<DDGIVolumnComponent>();
 			mDebugObjectModelMat = Matrix4f(1.0f) * glm::translate(Matrix4f(1.0f), AABBCenter(ddgiVolumn.volumn)) *
 				glm::scale(Matrix4f(1.0f), AABBExtent(ddgiVolumn.volumn));
 
@@ -152,9 +153,14 @@ namespace SG
 		}
 	}
 
-	void RGDebugNode::OnSelectedEntityChanged(Scene::TreeNode* pTreeNode)
+	void RGDebugNode::OnSelectedEntityChanged(Scene::Entity* pEntity)
 	{
-		mpSelectedEntityTreeNode = pTreeNode;
+		mpSelectedEntity = pEntity;
+	}
+
+	void RGDebugNode::OnDebugDrawChanged(bool bDebugDraw)
+	{
+		SetEnabled(bDebugDraw);
 	}
 
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "RendererVulkan/RenderGraph/RenderGraphNode.h"
+#include "RendererVulkan/Resource/ResourceTable.h"
 #include "Scene/Scene.h"
 #include "Event/MessageBus/MessageBus.h"
 
@@ -25,7 +26,9 @@ namespace SG
 		virtual void Prepare(VulkanRenderPass* pRenderpass) override;
 		virtual void Draw(DrawInfo& context) override;
 	private:
-		void OnSelectedEntityChanged(Scene::TreeNode* pTreeNode);
+		void OnSelectedEntityChanged(Scene::Entity* pEntity);
+		//! The render graph culls this node when the debug draw is off.
+		void OnDebugDrawChanged(bool bDebugDraw);
 	private:
 		VulkanContext& mContext;
 		MessageBusMember mMessageBusMember;
@@ -34,8 +37,9 @@ namespace SG
 		LoadStoreClearOp mDepthRtLoadStoreOp;
 
 		Matrix4f mDebugObjectModelMat;
+		BufferHandle mDebugGeoBuffer;
 
-		Scene::TreeNode* mpSelectedEntityTreeNode = nullptr;
+		Scene::Entity* mpSelectedEntity = nullptr;
 
 		RefPtr<VulkanPipelineSignature> mpDebugLinePipelineSignature;
 		VulkanPipeline*                 mpDebugLinePipeline;
@@ -45,6 +45,12 @@ namespace SG
 		samplerCI.maxAnisotropy = 1.0f;
 		VK_RESOURCE()->CreateSampler(samplerCI);
 
+		ReadResource("shadow map", EResourceBarrier::efDepth_Stencil_Read_Only);
+		ReadResource("position_deferred_rt");
+		ReadResource("normal_deferred_rt");
+		ReadResource("albedo_deferred_rt");
+		ReadResource("mrao_deferred_rt");
+
 		mpGBufferCompositePipelineSignature = VulkanPipelineSignature::Builder(mContext, mpGBufferCompositeShader)
 			.AddCombindSamplerImage("shadow_sampler", "shadow map")
 			.AddCombindSamplerImage("brdf_lut_sampler", "brdf_lut")
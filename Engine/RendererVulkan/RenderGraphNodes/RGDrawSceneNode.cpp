@@ -82,18 +82,14 @@ namespace SG
 
 		mpShader = VulkanShader::Create(mContext.device);
 		mpSkyboxShader = VulkanShader::Create(mContext.device);
-		ShaderCompiler compiler;
-		compiler.CompileGLSLShader("phone", mpShader);
-		compiler.CompileGLSLShader("skybox", mpSkyboxShader);
-
-		VulkanCommandBuffer pCmd;
-		mContext.pGraphicCommandPool->AllocateCommandBuffer(pCmd);
-		pCmd.BeginRecord();
-		pCmd.ImageBarrier(VK_RESOURCE()->GetRenderTarget("shadow map"), EResourceBarrier::efUndefined, EResourceBarrier::efDepth_Stencil_Read_Only);
-		pCmd.EndRecord();
-		mContext.pGraphicQueue->SubmitCommands<0, 0, 0>(&pCmd, nullptr, nullptr, nullptr, nullptr);
-		mContext.pGraphicQueue->WaitIdle();
-		mContext.pGraphicCommandPool->FreeCommandBuffer(pCmd);
+		vector<ShaderCompileRequest> shaderRequests(2);
+		shaderRequests[0].shaderName = "phone";
+		shaderRequests[0].pShader = mpShader;
+		shaderRequests[1].shaderName = "skybox";
+		shaderRequests[1].pShader = mpSkyboxShader;
+		ShaderCompiler::CompileGLSLShaders(shaderRequests);
+
+		ReadResource("shadow map", EResourceBarrier::efDepth_Stencil_Read_Only);
 
 		mpSkyboxPipelineSignature = VulkanPipelineSignature::Builder(mContext, mpSkyboxShader)
 			.AddCombindSamplerImage("cubemap_sampler", "cubemap")
@@ -7,8 +7,10 @@
 #include "Render/CommonRenderData.h"
 #include "Archive/ResourceLoader.h"
 #include "Profile/Profile.h"
+#include "Thread/IJobSystem.h"
 
 #include "Stl/Utility.h"
+#include "EASTL/algorithm.h"
 
 #include "RendererVulkan/Backend/VulkanContext.h"
 #include "RendererVulkan/Backend/VulkanBuffer.h"
@@ -55,19 +57,26 @@ namespace SG
 
 		mpShader = VulkanShader::Create(mContext.device);
 		mpInstanceShader = VulkanShader::Create(mContext.device);
-		ShaderCompiler compiler;
+		vector<ShaderCompileRequest> shaderRequests(2);
 #if SG_ENABLE_DEFERRED_SHADING
-		compiler.CompileGLSLShader("deferred/deferred_sample", mpShader);
-		compiler.CompileGLSLShader("deferred/deferred_sample_instance", "deferred/deferred_sample", mpInstanceShader);
+		shaderRequests[0].shaderName = "deferred/deferred_sample";
+		shaderRequests[1].shaderName = "deferred/deferred_sample_instance";
+		shaderRequests[1].fragShaderName = "deferred/deferred_sample";
 #else
-		compiler.CompileGLSLShader("brdf", mpShader);
-		compiler.CompileGLSLShader("brdf_instance", "brdf", mpInstanceShader);
-#endif
+		shaderRequests[0].shaderName = "brdf";
+		shaderRequests[1].shaderName = "brdf_instance";
+		shaderRequests[1].fragShaderName = "brdf";
 
-#if !SG_ENABLE_DEFERRED_SHADING
 		mpSkyboxShader = VulkanShader::Create(mContext.device);
-		compiler.CompileGLSLShader("skybox", mpSkyboxShader);
+		shaderRequests.emplace_back();
+		shaderRequests[2].shaderName = "skybox";
+		shaderRequests[2].pShader = mpSkyboxShader;
+#endif
+		shaderRequests[0].pShader = mpShader;
+		shaderRequests[1].pShader = mpInstanceShader;
+		ShaderCompiler::CompileGLSLShaders(shaderRequests);
 
+#if !SG_ENABLE_DEFERRED_SHADING
 		mpSkyboxPipelineSignature = VulkanPipelineSignature::Builder(mContext, mpSkyboxShader)
 			.AddCombindSamplerImage("cubemap_sampler", "cubemap")
 			.Build();
@@ -78,6 +87,8 @@ namespace SG
 		mpPipelineSignature = VulkanPipelineSignature::Builder(mContext, mpShader)
 			.Build();
 #else
+		ReadResource("shadow map", EResourceBarrier::efDepth_Stencil_Read_Only);
+
 		// just bind set 0 resource here.
 		mpPipelineSignature = VulkanPipelineSignature::Builder(mContext, mpShader)
 			.AddCombindSamplerImage("shadow_sampler", "shadow map")
@@ -177,18 +188,9 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-#if !SG_ENABLE_DEFERRED_SHADING
-		mpSkyboxPipeline = VulkanPipeline::Builder(mContext.device)
-			.BindSignature(mpSkyboxPipelineSignature)
-			.BindRenderPass(pRenderpass)
-			.SetRasterizer(ECullMode::eFront)
-			.SetColorBlend(false)
-			.SetDynamicStates()
-			.Build();
-#endif
-
-		mpInstancePipeline = VulkanPipeline::Builder(mContext.device)
-			.BindSignature(mpPipelineSignature, true)
+		// the scene pipelines are built on the job workers while the skybox pipeline is built.
+		VulkanPipeline::Builder instancePipelineBuilder(mContext.device);
+		instancePipelineBuilder.BindSignature(mpPipelineSignature, true)
 			.BindShader(mpInstanceShader)
 			.BindRenderPass(pRenderpass)
 			.SetRasterizer(ECullMode::eBack)
@@ -203,10 +205,10 @@ namespace SG
 			.SetColorBlend(false)
 #endif
 			.SetDynamicStates()
-			.Build();
+			.Prewarm();
 
-		mpPipeline = VulkanPipeline::Builder(mContext.device)
-			.BindSignature(mpPipelineSignature, true)
+		VulkanPipeline::Builder pipelineBuilder(mContext.device);
+		pipelineBuilder.BindSignature(mpPipelineSignature, true)
 			.BindShader(mpShader)
 			.BindRenderPass(pRenderpass)
 #if SG_ENABLE_DEFERRED_SHADING
@@ -217,8 +219,21 @@ namespace SG
 #else
 			.SetColorBlend(false)
 #endif
+			.SetDynamicStates()
+			.Prewarm();
+
+#if !SG_ENABLE_DEFERRED_SHADING
+		mpSkyboxPipeline = VulkanPipeline::Builder(mContext.device)
+			.BindSignature(mpSkyboxPipelineSignature)
+			.BindRenderPass(pRenderpass)
+			.SetRasterizer(ECullMode::eFront)
+			.SetColorBlend(false)
 			.SetDynamicStates()
 			.Build();
+#endif
+
+		mpInstancePipeline = instancePipelineBuilder.Build();
+		mpPipeline = pipelineBuilder.Build();
 	}
 
 	void RGDrawScenePBRNode::Draw(DrawInfo& context)
@@ -226,11 +241,15 @@ namespace SG
 		SG_PROFILE_FUNCTION();
 
 		auto& pBuf = *context.pCmd;
-		pBuf.WriteTimeStamp(mContext.pTimeStampQueryPool, EPipelineStage::efTop_Of_Pipeline, 2);
+		const bool bFirstBatch = context.batchIndex == 0;
+		const bool bLastBatch = context.batchIndex + 1 == context.numBatch;
 
-#if !SG_ENABLE_DEFERRED_SHADING
-		// 1. Draw Skybox
+		if (bFirstBatch)
 		{
+			pBuf.WriteTimeStamp(mContext.pTimeStampQueryPool, EPipelineStage::efTop_Of_Pipeline, 2);
+
+#if !SG_ENABLE_DEFERRED_SHADING
+			// 1. Draw Skybox
 			pBuf.SetViewport((float)mContext.colorRts[0]->GetWidth(), (float)mContext.colorRts[0]->GetHeight(), 1.0f, 1.0f); // set z to 1.0
 			pBuf.SetScissor({ 0, 0, (int)mContext.colorRts[0]->GetWidth(), (int)mContext.colorRts[0]->GetHeight() });
 
@@ -240,15 +259,30 @@ namespace SG
 			const DrawCall& skybox = VK_RESOURCE()->GetSkyboxDrawCall();
 			pBuf.BindVertexBuffer(0, 1, *skybox.drawMesh.pVertexBuffer, &skybox.drawMesh.vBOffset);
 			pBuf.Draw(36, 1, 0, 0);
-		}
 #endif
 
+			pBuf.BeginQuery(mContext.pPipelineStatisticsQueryPool, 0);
+		}
+
 		// 2. Draw Scene
-		pBuf.BeginQuery(mContext.pPipelineStatisticsQueryPool, 0);
 		DrawScene(context);
-		pBuf.EndQuery(mContext.pPipelineStatisticsQueryPool, 0);
 
-		pBuf.WriteTimeStamp(mContext.pTimeStampQueryPool, EPipelineStage::efBottom_Of_Pipeline, 3);
+		if (bLastBatch)
+		{
+			pBuf.EndQuery(mContext.pPipelineStatisticsQueryPool, 0);
+			pBuf.WriteTimeStamp(mContext.pTimeStampQueryPool, EPipelineStage::efBottom_Of_Pipeline, 3);
+		}
+	}
+
+	UInt32 RGDrawScenePBRNode::GetNumRecordBatch() const
+	{
+		// the pipeline statistics query can not be begun in one secondary command buffer and ended in another one.
+		if (!mContext.pPipelineStatisticsQueryPool->IsSleep())
+			return 0;
+
+		const UInt32 numDrawCall = GPUDrivenDP::GetNumDrawCall(EMeshPass::eForward) + GPUDrivenDP::GetNumDrawCall(EMeshPass::eForwardInstanced);
+		const UInt32 numBatch = (numDrawCall + SG_DRAW_CALLS_PER_RECORD_BATCH - 1) / SG_DRAW_CALLS_PER_RECORD_BATCH;
+		return eastl::clamp(numBatch, 1u, JobSystem::GetNumWorkers() + 1);
 	}
 
 	void RGDrawScenePBRNode::DrawScene(DrawInfo& drawInfo)
@@ -259,16 +293,25 @@ namespace SG
 		pBuf.SetViewport((float)mContext.colorRts[0]->GetWidth(), (float)mContext.colorRts[0]->GetHeight(), 0.0f, 1.0f);
 		pBuf.SetScissor({ 0, 0, (int)mContext.colorRts[0]->GetWidth(), (int)mContext.colorRts[0]->GetHeight() });
 
-		GPUDrivenDP::Begin(drawInfo);
+		// the draw calls of the forward mesh pass are followed by the instanced ones, every batch draws an even part of them.
+		const UInt32 numForward = GPUDrivenDP::GetNumDrawCall(EMeshPass::eForward);
+		const UInt32 numDrawCall = numForward + GPUDrivenDP::GetNumDrawCall(EMeshPass::eForwardInstanced);
+		const UInt32 begin = static_cast<UInt32>(UInt64(numDrawCall) * drawInfo.batchIndex / drawInfo.numBatch);
+		const UInt32 end = static_cast<UInt32>(UInt64(numDrawCall) * (drawInfo.batchIndex + 1) / drawInfo.numBatch);
 
 		// 1.1 Forward Mesh Pass
-		pBuf.BindPipeline(mpPipeline);
-		GPUDrivenDP::Draw(EMeshPass::eForward);
+		if (begin < numForward)
+		{
+			pBuf.BindPipeline(mpPipeline);
+			GPUDrivenDP::Draw(pBuf, EMeshPass::eForward, ECullingView::eCamera, begin, end);
+		}
 
 		// 1.2 Forward Instanced Mesh Pass
-		pBuf.BindPipeline(mpInstancePipeline);
-		GPUDrivenDP::Draw(EMeshPass::eForwardInstanced);
-		GPUDrivenDP::End();
+		if (end > numForward)
+		{
+			pBuf.BindPipeline(mpInstancePipeline);
+			GPUDrivenDP::Draw(pBuf, EMeshPass::eForwardInstanced, ECullingView::eCamera, begin > numForward ? begin - numForward : 0, end - numForward);
+		}
 	}
 
 	void RGDrawScenePBRNode::GenerateBRDFLut()
@@ -701,18 +744,8 @@ namespace SG
 		rtCI.type = EImageType::e2D;
 		rtCI.usage = EImageUsage::efColor | EImageUsage::efSample;
 		rtCI.initLayout = EImageLayout::eUndefined;
-		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory;
+		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory | EGPUMemoryFlag::efTransient;
 		VK_RESOURCE()->CreateRenderTarget(rtCI);
-
-		// translate color rt from undefined to shader read
-		VulkanCommandBuffer pCmd;
-		mContext.pGraphicCommandPool->AllocateCommandBuffer(pCmd);
-		pCmd.BeginRecord();
-		pCmd.ImageBarrier(VK_RESOURCE()->GetRenderTarget("HDRColor"), EResourceBarrier::efUndefined, EResourceBarrier::efShader_Resource);
-		pCmd.EndRecord();
-		mContext.pGraphicQueue->SubmitCommands<0, 0, 0>(&pCmd, nullptr, nullptr, nullptr, nullptr);
-		mContext.pGraphicQueue->WaitIdle();
-		mContext.pGraphicCommandPool->FreeCommandBuffer(pCmd);
 	}
 
 	void RGDrawScenePBRNode::DestroyColorRt()
@@ -790,7 +823,7 @@ namespace SG
 		rtCI.type = EImageType::e2D;
 		rtCI.usage = EImageUsage::efColor | EImageUsage::efSample;
 		rtCI.initLayout = EImageLayout::eUndefined;
-		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory;
+		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory | EGPUMemoryFlag::efTransient;
 		VK_RESOURCE()->CreateRenderTarget(rtCI);
 
 		// normal deferred render target
@@ -806,7 +839,7 @@ namespace SG
 		rtCI.type = EImageType::e2D;
 		rtCI.usage = EImageUsage::efColor | EImageUsage::efSample;
 		rtCI.initLayout = EImageLayout::eUndefined;
-		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory;
+		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory | EGPUMemoryFlag::efTransient;
 		VK_RESOURCE()->CreateRenderTarget(rtCI);
 
 		// albedo deferred render target
@@ -822,7 +855,7 @@ namespace SG
 		rtCI.type = EImageType::e2D;
 		rtCI.usage = EImageUsage::efColor | EImageUsage::efSample;
 		rtCI.initLayout = EImageLayout::eUndefined;
-		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory;
+		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory | EGPUMemoryFlag::efTransient;
 		VK_RESOURCE()->CreateRenderTarget(rtCI);
 
 		// metallic, roughness and ao deferred render target
@@ -838,21 +871,8 @@ namespace SG
 		rtCI.type = EImageType::e2D;
 		rtCI.usage = EImageUsage::efColor | EImageUsage::efSample;
 		rtCI.initLayout = EImageLayout::eUndefined;
-		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory;
+		rtCI.memoryFlag = EGPUMemoryFlag::efDedicated_Memory | EGPUMemoryFlag::efTransient;
 		VK_RESOURCE()->CreateRenderTarget(rtCI);
-
-		// translate color rt from undefined to shader read
-		VulkanCommandBuffer pCmd;
-		mContext.pGraphicCommandPool->AllocateCommandBuffer(pCmd);
-		pCmd.BeginRecord();
-		pCmd.ImageBarrier(VK_RESOURCE()->GetRenderTarget("position_deferred_rt"), EResourceBarrier::efUndefined, EResourceBarrier::efShader_Resource);
-		pCmd.ImageBarrier(VK_RESOURCE()->GetRenderTarget("normal_deferred_rt"), EResourceBarrier::efUndefined, EResourceBarrier::efShader_Resource);
-		pCmd.ImageBarrier(VK_RESOURCE()->GetRenderTarget("albedo_deferred_rt"), EResourceBarrier::efUndefined, EResourceBarrier::efShader_Resource);
-		pCmd.ImageBarrier(VK_RESOURCE()->GetRenderTarget("mrao_deferred_rt"), EResourceBarrier::efUndefined, EResourceBarrier::efShader_Resource);
-		pCmd.EndRecord();
-		mContext.pGraphicQueue->SubmitCommands<0, 0, 0>(&pCmd, nullptr, nullptr, nullptr, nullptr);
-		mContext.pGraphicQueue->WaitIdle();
-		mContext.pGraphicCommandPool->FreeCommandBuffer(pCmd);
 	}
 
 	void RGDrawScenePBRNode::DestroyDeferredShadingRts()
@@ -28,6 +28,7 @@ namespace SG
 		virtual void Reset() override;
 		virtual void Prepare(VulkanRenderPass* pRenderpass) override;
 		virtual void Draw(DrawInfo& context) override;
+		virtual UInt32 GetNumRecordBatch() const override;
 	private:
 		void CreateColorRt();
 		void DestroyColorRt();
@@ -108,6 +108,10 @@ namespace SG
 			VK_RESOURCE()->AddDescriptorSetHandle("_imgui_font_tex", &mpGUIPipelineSignature->GetDescriptorSet(0, "_imgui_font"));
 			io.Fonts->SetTexID((ImTextureID)VK_RESOURCE()->GetDescriptorSetHandle("_imgui_font_tex").GetData());
 
+			// the viewport and the image viewer of the ui sample the render targets
+			ReadResource("HDRColor");
+			ReadResource("shadow map", EResourceBarrier::efDepth_Stencil_Read_Only);
+
 			VulkanDescriptorSet* pViewportSet = New(VulkanDescriptorSet);
 			VulkanPipelineSignature::SetDataBinder(mpGUIPipelineSignature, 0)
 				.AddCombindSamplerImage(0, "comp_sampler", "HDRColor")
@@ -142,6 +146,11 @@ namespace SG
 
 		//Delete(mpCompPipeline);
 		Delete(mpGUIPipeline);
+
+		for (auto handle : mGUIVertexBuffers)
+			VK_RESOURCE()->DeleteBuffer(handle);
+		for (auto handle : mGUIIndexBuffers)
+			VK_RESOURCE()->DeleteBuffer(handle);
 	}
 
 	void RGFinalOutputNode::Reset()
@@ -228,11 +237,16 @@ namespace SG
 		if (width <= 0 || height <= 0)
 			return;
 
-		const string vtxBufferName = "_imgui_vtx_" + eastl::to_string(frameIndex);
-		const string idxBufferName = "_imgui_idx_" + eastl::to_string(frameIndex);
+		if (frameIndex >= mGUIVertexBuffers.size())
+		{
+			mGUIVertexBuffers.resize(frameIndex + 1);
+			mGUIIndexBuffers.resize(frameIndex + 1);
+		}
+		auto& vtxBufferHandle = mGUIVertexBuffers[frameIndex];
+		auto& idxBufferHandle = mGUIIndexBuffers[frameIndex];
 
-		VulkanBuffer* pVertexBuffer = VK_RESOURCE()->GetBuffer(vtxBufferName);
-		VulkanBuffer* pIndexBuffer = VK_RESOURCE()->GetBuffer(idxBufferName);
+		VulkanBuffer* pVertexBuffer = VK_RESOURCE()->GetBuffer(vtxBufferHandle);
+		VulkanBuffer* pIndexBuffer = VK_RESOURCE()->GetBuffer(idxBufferHandle);
 
 		// create buffer to hold the vtx and idx data
 		if (drawData->TotalVtxCount > 0)
@@ -244,13 +258,13 @@ namespace SG
 
 			if (pVertexBuffer && vtxBufferSize > pVertexBuffer->SizeCPU()) // need to create a new one to hold the vtx buffer
 			{
-				VK_RESOURCE()->DeleteBuffer(vtxBufferName);
+				VK_RESOURCE()->DeleteBuffer(vtxBufferHandle);
 				bNeedToCreateVtxBuffer = true;
 			}
 
 			if (pIndexBuffer && idxBufferSize > pIndexBuffer->SizeCPU()) // need to create a new one to hold the idx buffer
 			{
-				VK_RESOURCE()->DeleteBuffer(idxBufferName);
+				VK_RESOURCE()->DeleteBuffer(idxBufferHandle);
 				bNeedToCreateIdxBuffer = true;
 			}
 
@@ -258,22 +272,24 @@ namespace SG
 			bufferCI.memoryUsage = EGPUMemoryUsage::eCPU_To_GPU;
 			if (!pVertexBuffer || bNeedToCreateVtxBuffer)
 			{
+				const string vtxBufferName = "_imgui_vtx_" + eastl::to_string(frameIndex);
 				bufferCI.name = vtxBufferName.c_str();
 				bufferCI.bufferSize = vtxBufferSize;
 				bufferCI.type = EBufferType::efVertex;
-				VK_RESOURCE()->CreateBuffer(bufferCI);
+				vtxBufferHandle = VK_RESOURCE()->CreateBuffer(bufferCI);
 			}
 
 			if (!pIndexBuffer || bNeedToCreateIdxBuffer)
 			{
+				const string idxBufferName = "_imgui_idx_" + eastl::to_string(frameIndex);
 				bufferCI.name = idxBufferName.c_str();
 				bufferCI.bufferSize = idxBufferSize;
 				bufferCI.type = EBufferType::efIndex;
-				VK_RESOURCE()->CreateBuffer(bufferCI);
+				idxBufferHandle = VK_RESOURCE()->CreateBuffer(bufferCI);
 			}
 
-			pVertexBuffer = VK_RESOURCE()->GetBuffer(vtxBufferName);
-			pIndexBuffer = VK_RESOURCE()->GetBuffer(idxBufferName);
+			pVertexBuffer = VK_RESOURCE()->GetBuffer(vtxBufferHandle);
+			pIndexBuffer = VK_RESOURCE()->GetBuffer(idxBufferHandle);
 			SG_ASSERT(pVertexBuffer && pIndexBuffer);
 
 			UInt32 vtxOffest = 0;
@@ -4,7 +4,9 @@
 #include "Render/GUI/IGUIDriver.h"
 
 #include "RendererVulkan/RenderGraph/RenderGraphNode.h"
+#include "RendererVulkan/Resource/ResourceTable.h"
 
+#include "Stl/vector.h"
 #include "Stl/SmartPtr.h"
 
 namespace SG
@@ -45,6 +47,9 @@ namespace SG
 
 		UInt32 mCurrVertexCount;
 		UInt32 mCurrIndexCount;
+		//! Vertex and index buffers of the gui for each frame in flight.
+		vector<BufferHandle> mGUIVertexBuffers;
+		vector<BufferHandle> mGUIIndexBuffers;
 	};
 
 }
\ No newline at end of file
@@ -51,20 +51,6 @@ namespace SG
 		texCI.initLayout = EImageLayout::eUndefined;
 		VK_RESOURCE()->CreateRenderTarget(texCI, true);
 
-		//! [Critical] 
-		//! This shadow map is used by DrawSceneNode as shader resource, so we need to transit the image layout here.
-		//! If we create the pipeline signature after the execution of the this ShadowNode, we don't need to do a transition here.
-		//! So this is for consistency of the architecture.
-		//! Two ways, both are OK.
-		VulkanCommandBuffer pCmd;
-		mContext.pGraphicCommandPool->AllocateCommandBuffer(pCmd);
-		pCmd.BeginRecord();
-		pCmd.ImageBarrier(VK_RESOURCE()->GetRenderTarget("shadow map"), EResourceBarrier::efUndefined, EResourceBarrier::efDepth_Stencil_Read_Only);
-		pCmd.EndRecord();
-		mContext.pGraphicQueue->SubmitCommands<0, 0, 0>(&pCmd, nullptr, nullptr, nullptr, nullptr);
-		mContext.pGraphicQueue->WaitIdle();
-		mContext.pGraphicCommandPool->FreeCommandBuffer(pCmd);
-
 		SamplerCreateDesc samplerCI = {};
 		samplerCI.name = "shadow_sampler";
 		samplerCI.filterMode = EFilterMode::eLinear;
@@ -79,9 +65,12 @@ namespace SG
 
 		mpShadowShader = VulkanShader::Create(mContext.device);
 		mpShadowInstanceShader = VulkanShader::Create(mContext.device);
-		ShaderCompiler compiler;
-		compiler.CompileGLSLShader("shadow", mpShadowShader);
-		compiler.CompileGLSLShader("shadow_instance", mpShadowInstanceShader);
+		vector<ShaderCompileRequest> shaderRequests(2);
+		shaderRequests[0].shaderName = "shadow";
+		shaderRequests[0].pShader = mpShadowShader;
+		shaderRequests[1].shaderName = "shadow_instance";
+		shaderRequests[1].pShader = mpShadowInstanceShader;
+		ShaderCompiler::CompileGLSLShaders(shaderRequests);
 
 		mpShadowPipelineSignature = VulkanPipelineSignature::Builder(mContext, mpShadowShader)
 			.Build();
@@ -162,11 +151,11 @@ namespace SG
 
 			// 1.1 Forward Mesh Pass
 			pBuf.BindPipeline(mpShadowPipeline);
-			GPUDrivenDP::DrawWithoutBindMaterial(EMeshPass::eForward);
+			GPUDrivenDP::DrawWithoutBindMaterial(pBuf, EMeshPass::eForward, ECullingView::eLight);
 
 			// 1.2 Forward Instanced Mesh Pass
 			pBuf.BindPipeline(mpShadowInstancePipeline);
-			GPUDrivenDP::DrawWithoutBindMaterial(EMeshPass::eForwardInstanced);
+			GPUDrivenDP::DrawWithoutBindMaterial(pBuf, EMeshPass::eForwardInstanced, ECullingView::eLight);
 		}
 		pBuf.WriteTimeStamp(mContext.pTimeStampQueryPool, EPipelineStage::efBottom_Of_Pipeline, 1);
 
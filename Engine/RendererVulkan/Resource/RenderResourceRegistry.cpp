@@ -3,6 +3,7 @@
 
 #include "System/System.h"
 #include "System/Logger.h"
+#include "Scene/RenderDataBuilder.h"
 #include "Memory/Memory.h"
 #include "Render/SwapChain.h"
 #include "Archive/MeshDataArchive.h"
@@ -15,11 +16,13 @@
 #include "RendererVulkan/Backend/VulkanBuffer.h"
 #include "RendererVulkan/Backend/VulkanTexture.h"
 #include "RendererVulkan/Backend/VulkanSynchronizePrimitive.h"
+#include "RendererVulkan/Backend/VulkanPipelineSignature.h"
+#include "RendererVulkan/Backend/VulkanDescriptorCache.h"
 
 #include "ktx/ktx.h"
 #include "glm/ext/matrix_clip_space.hpp"
 
-#include "eastl/utility.h"
+#include "EASTL/utility.h"
 
 namespace SG
 {
@@ -32,27 +35,27 @@ namespace SG
 
 		BufferCreateDesc ssboCI = {};
 		ssboCI.name = "perObjectBuffer";
-		ssboCI.bufferSize = sizeof(ObjcetRenderData) * SG_MAX_NUM_OBJECT;
+		ssboCI.bufferSize = sizeof(ObjcetRenderData) * SG_DEFAULT_NUM_OBJECT;
 		ssboCI.type = EBufferType::efStorage;
 		ssboCI.memoryUsage = EGPUMemoryUsage::eCPU_To_GPU;
 		ssboCI.memoryFlag = EGPUMemoryFlag::efPersistent_Map;
-		CreateBuffer(ssboCI);
+		mPerObjectBuffer = CreateBuffer(ssboCI);
 
 		// This is only for debugging purpose
 		//ssboCI = {};
 		//ssboCI.name = "cullingOutputData";
-		//ssboCI.bufferSize = sizeof(CullingOutputData) * SG_MAX_NUM_OBJECT;
+		//ssboCI.bufferSize = sizeof(CullingOutputData) * SG_DEFAULT_NUM_OBJECT;
 		//ssboCI.type = EBufferType::efStorage;
 		//CreateBuffer(ssboCI);
 
 #if SG_ENABLE_GPU_CULLING
 		BufferCreateDesc cullBufferCI = {};
 		cullBufferCI.name = "cullUbo";
-		cullBufferCI.bufferSize = sizeof(GPUCullUBO) * SG_MAX_NUM_OBJECT;
+		cullBufferCI.bufferSize = sizeof(GPUCullUBO);
 		cullBufferCI.type = EBufferType::efUniform;
 		cullBufferCI.memoryUsage = EGPUMemoryUsage::eCPU_To_GPU;
 		cullBufferCI.memoryFlag = EGPUMemoryFlag::efPersistent_Map;
-		CreateBuffer(cullBufferCI);
+		mCullUbo = CreateBuffer(cullBufferCI);
 #endif
 
 		auto pSkybox = SSystem()->GetMainScene()->GetSkyboxEntity();
@@ -66,7 +69,7 @@ namespace SG
 		bufferCI.bufferSize = static_cast<UInt32>(vbSize);
 		bufferCI.type = EBufferType::efVertex;
 		bufferCI.memoryUsage = EGPUMemoryUsage::eGPU_Only;
-		CreateBuffer(bufferCI);
+		const BufferHandle skyboxVb = CreateBuffer(bufferCI);
 		FlushBuffers();
 
 		// eliminate the translation part of the matrix
@@ -78,7 +81,7 @@ namespace SG
 		mSkyboxDrawCall.drawMesh.iBSize = 0;
 		mSkyboxDrawCall.drawMesh.vBOffset = 0;
 		mSkyboxDrawCall.drawMesh.iBOffset = 0;
-		mSkyboxDrawCall.drawMesh.pVertexBuffer = GetBuffer("skybox_vb");
+		mSkyboxDrawCall.drawMesh.pVertexBuffer = GetBuffer(skyboxVb);
 		mSkyboxDrawCall.drawMesh.pIndexBuffer = nullptr;
 		mSkyboxDrawCall.drawMesh.pInstanceBuffer = nullptr;
 		mSkyboxDrawCall.objectId = 0;
@@ -102,7 +105,7 @@ namespace SG
 		cullUbo.viewPos = pCamera->GetPosition();
 		cullUbo.numObjects = static_cast<UInt32>(pScene->GetMeshEntityCount());
 		cullUbo.numDrawCalls = MeshDataArchive::GetInstance()->GetNumMeshData();
-		GetBuffer("cullUbo")->UploadData(&cullUbo);
+		GetBuffer(mCullUbo)->UploadData(&cullUbo);
 #endif
 
 		auto& skyboxUbo = GetSkyboxUBO();
@@ -112,23 +115,24 @@ namespace SG
 		compositionUbo.gamma = 2.2f;
 		compositionUbo.exposure = 1.0f;
 
-		auto* pSSBOObject = GetBuffer("perObjectBuffer");
+		auto* pSSBOObject = GetBuffer(mPerObjectBuffer);
 
 		renderData = {};
 		renderData.instanceOffset = -1;
 		pSSBOObject->UploadData(&renderData, sizeof(ObjcetRenderData), 0);
 
 		// update all the render data of the render mesh
-		pScene->TraverseEntityContext([pSSBOObject](Scene::EntityContext& context)
+		pScene->TraverseEntityContext([this, pScene](Scene::EntityContext& context)
 			{
 				auto& entity = context.entity;
 				if (entity.HasComponent<MeshComponent>() && entity.HasComponent<MaterialComponent>())
 				{
 					auto [mesh, mat] = entity.GetComponent<MeshComponent, MaterialComponent>();
 					auto matAsset = mat.materialAsset.lock();
+					auto* pSSBOObject = ReserveObjectBuffer(mesh.objectId + 1);
 
 					ObjcetRenderData renderData = {};
-					renderData.model = GetTransform(context.pTreeNode);
+					renderData.model = pScene->GetWorldTransform(context.treeNode);
 					renderData.inverseTransposeModel = glm::transpose(glm::inverse(renderData.model));
 					renderData.meshId = mesh.meshId;
 					renderData.MR = { matAsset->GetMetallic(), matAsset->GetRoughness() };
@@ -145,16 +149,16 @@ namespace SG
 		SG_PROFILE_FUNCTION();
 
 		// release all the memory
-		for (auto beg = mBuffers.begin(); beg != mBuffers.end(); ++beg)
-			Delete(beg->second);
-		for (auto beg = mTextures.begin(); beg != mTextures.end(); ++beg)
-			Delete(beg->second);
-		for (auto beg = mDescriptorSets.begin(); beg != mDescriptorSets.end(); ++beg)
-			Delete(beg->second);
-		for (auto beg = mRenderTargets.begin(); beg != mRenderTargets.end(); ++beg)
-			Delete(beg->second);
-		for (auto beg = mSamplers.begin(); beg != mSamplers.end(); ++beg)
-			Delete(beg->second);
+		mBuffers.ForEach([](const string&, VulkanBuffer* pBuffer) { Delete(pBuffer); });
+		mTextures.ForEach([](const string&, VulkanTexture* pTex) { Delete(pTex); });
+		mDescriptorSets.ForEach([this](const string&, VulkanDescriptorSet* pSet) { mpContext->pDescriptorCache->Release(*pSet); Delete(pSet); });
+		mRenderTargets.ForEach([](const string&, VulkanRenderTarget* pRt) { Delete(pRt); });
+		mSamplers.ForEach([](const string&, VulkanSampler* pSampler) { Delete(pSampler); });
+		mBuffers.Clear();
+		mTextures.Clear();
+		mDescriptorSets.Clear();
+		mRenderTargets.Clear();
+		mSamplers.Clear();
 	}
 
 	void VulkanResourceRegistry::OnUpdate()
@@ -201,90 +205,76 @@ namespace SG
 			cullUbo.frustum[5] = cameraFrustum.GetBackPlane();
 			cullUbo.viewPos = pCamera->GetPosition();
 
-			UpdataBufferData("cullUbo", &cullUbo);
+			UpdataBufferData(mCullUbo, &cullUbo);
 #endif
 
 			cameraUbo.viewProj = cameraUbo.proj * cameraUbo.view;
-			UpdataBufferData("cameraUbo", &cameraUbo);
-			UpdataBufferData("skyboxUbo", &skyboxUbo);
+			UpdataBufferData(ResolveBuffer(mCameraUbo, "cameraUbo"), &cameraUbo);
+			UpdataBufferData(ResolveBuffer(mSkyboxUbo, "skyboxUbo"), &skyboxUbo);
 
 			pCamera->ProjBeUpdated();
 			pCamera->ViewBeUpdated();
 		}
 
-		auto* pSSBOObject = GetBuffer("perObjectBuffer");
+		auto* pSSBOObject = GetBuffer(mPerObjectBuffer);
 		bool bNeedUpdateLightUbo = false;
 		auto& lightUbo = GetLightUBO();
 
-		pScene->TraverseEntityContext([this, pSSBOObject, &bNeedUpdateLightUbo, &lightUbo, pScene, pCamera, bNeedToUpdateDirectionalLight](Scene::EntityContext& context)
+		// the lights are few, walk their component columns instead of all the entities.
+		pScene->TraverseEntityMatchSignature<Signature6>([&bNeedUpdateLightUbo, &lightUbo](TagComponent& tag, TransformComponent& trans, PointLightComponent& light)
 			{
-				auto& entity = context.entity;
+				if (!tag.bDirty)
+					return;
 
-				auto& tag = entity.GetComponent<TagComponent>();
-				if (tag.bDirty)
-				{
-					if (entity.HasComponent<PointLightComponent>())
-					{
-						auto [trans, light] = entity.GetComponent<TransformComponent, PointLightComponent>();
+				lightUbo.pointLightColor = light.color;
+				lightUbo.pointLightRadius = light.radius;
+				lightUbo.pointLightPos = trans.position;
+				bNeedUpdateLightUbo |= true;
+				tag.bDirty = false;
+			});
 
-						lightUbo.pointLightColor = light.color;
-						lightUbo.pointLightRadius = light.radius;
-						lightUbo.pointLightPos = trans.position;
-						bNeedUpdateLightUbo |= true;
-					}
-					else if (entity.HasComponent<DirectionalLightComponent>())
-					{
-						auto [trans, light] = entity.GetComponent<TransformComponent, DirectionalLightComponent>();
+		pScene->TraverseEntityMatchSignature<Signature7>([this, &bNeedUpdateLightUbo, &lightUbo, pCamera, bNeedToUpdateDirectionalLight](TagComponent& tag, TransformComponent& trans, DirectionalLightComponent& light)
+			{
+				if (!tag.bDirty && !bNeedToUpdateDirectionalLight)
+					return;
 
-						auto& shadowUbo = GetShadowUBO();
-						lightUbo.viewDirection = CalcViewDirectionNormalized(trans);
-						lightUbo.directionalColor = { light.color, 1.0f };
+				auto& shadowUbo = GetShadowUBO();
+				lightUbo.viewDirection = CalcViewDirectionNormalized(trans);
+				lightUbo.directionalColor = { light.color, 1.0f };
 
-						shadowUbo.lightSpaceVP = ComputeShadowedLightViewProj(pCamera, trans, light);
-						lightUbo.lightSpaceVP = shadowUbo.lightSpaceVP;
-						UpdataBufferData("shadowUbo", &shadowUbo);
-						bNeedUpdateLightUbo |= true;
-					}
-					else if (entity.HasComponent<MeshComponent>() && entity.HasComponent<MaterialComponent>())
-					{
-						auto [mesh, mat] = entity.GetComponent<MeshComponent, MaterialComponent>();
-						auto matAsset = mat.materialAsset.lock();
-
-						ObjcetRenderData renderData = {};
-						renderData.model = GetTransform(context.pTreeNode);
-						renderData.inverseTransposeModel = glm::transpose(glm::inverse(renderData.model));
-						renderData.meshId = mesh.meshId;
-						renderData.MR = { matAsset->GetMetallic(), matAsset->GetRoughness() };
-						renderData.instanceOffset = MeshDataArchive::GetInstance()->HaveInstance(renderData.meshId) ? MeshDataArchive::GetInstance()->GetInstanceSumOffset(renderData.meshId - 1) + mesh.instanceId : -1;
-						renderData.albedo = matAsset->GetAlbedo();
-						renderData.texFlag = matAsset->GetTextureMask();
-						pSSBOObject->UploadData(&renderData, sizeof(ObjcetRenderData), sizeof(ObjcetRenderData) * mesh.objectId);
-					}
-					tag.bDirty = false;
-				}
-				else if (bNeedToUpdateDirectionalLight)
-				{
-					if (entity.HasComponent<DirectionalLightComponent>())
-					{
-						auto [trans, light] = entity.GetComponent<TransformComponent, DirectionalLightComponent>();
+				shadowUbo.lightSpaceVP = ComputeShadowedLightViewProj(pCamera, trans, light);
+				lightUbo.lightSpaceVP = shadowUbo.lightSpaceVP;
+				UpdataBufferData(ResolveBuffer(mShadowUbo, "shadowUbo"), &shadowUbo);
+				bNeedUpdateLightUbo |= true;
+				tag.bDirty = false;
+			});
 
-						auto& shadowUbo = GetShadowUBO();
-						lightUbo.viewDirection = CalcViewDirectionNormalized(trans);
-						lightUbo.directionalColor = { light.color, 1.0f };
+		// only the mesh objects added or modified in this frame need to be uploaded.
+		SSystem()->GetRenderDataBuilder()->FlushDirtyObjects([pSSBOObject, pScene](Scene::EntityContext& context)
+			{
+				auto& entity = context.entity;
+				if (!entity.HasComponent<MaterialComponent>())
+					return;
 
-						shadowUbo.lightSpaceVP = ComputeShadowedLightViewProj(pCamera, trans, light);
-						lightUbo.lightSpaceVP = shadowUbo.lightSpaceVP;
-						UpdataBufferData("shadowUbo", &shadowUbo);
-						bNeedUpdateLightUbo |= true;
-					}
-				}
+				auto [mesh, mat] = entity.GetComponent<MeshComponent, MaterialComponent>();
+				auto matAsset = mat.materialAsset.lock();
+
+				ObjcetRenderData renderData = {};
+				renderData.model = pScene->GetWorldTransform(context.treeNode);
+				renderData.inverseTransposeModel = glm::transpose(glm::inverse(renderData.model));
+				renderData.meshId = mesh.meshId;
+				renderData.MR = { matAsset->GetMetallic(), matAsset->GetRoughness() };
+				renderData.instanceOffset = MeshDataArchive::GetInstance()->HaveInstance(renderData.meshId) ? MeshDataArchive::GetInstance()->GetInstanceSumOffset(renderData.meshId - 1) + mesh.instanceId : -1;
+				renderData.albedo = matAsset->GetAlbedo();
+				renderData.texFlag = matAsset->GetTextureMask();
+				pSSBOObject->UploadData(&renderData, sizeof(ObjcetRenderData), sizeof(ObjcetRenderData) * mesh.objectId);
 			});
 
 		if (bNeedUpdateLightUbo)
-			UpdataBufferData("lightUbo", &lightUbo);
+			UpdataBufferData(ResolveBuffer(mLightUbo, "lightUbo"), &lightUbo);
 
 		auto& compositionUbo = GetCompositionUBO();
-		UpdataBufferData("compositionUbo", &compositionUbo);
+		UpdataBufferData(ResolveBuffer(mCompositionUbo, "compositionUbo"), &compositionUbo);
 	}
 
 	void VulkanResourceRegistry::WindowResize()
@@ -305,7 +295,7 @@ namespace SG
 		auto& cullUbo = GetGPUCullUBO();
 		cullUbo.numObjects = static_cast<UInt32>(pScene->GetMeshEntityCount());
 		cullUbo.numDrawCalls = MeshDataArchive::GetInstance()->GetNumMeshData();
-		GetBuffer("cullUbo")->UploadData(&cullUbo);
+		GetBuffer(mCullUbo)->UploadData(&cullUbo);
 #endif
 
 		// reset lightUbo
@@ -313,7 +303,28 @@ namespace SG
 		lightUbo.pointLightColor = Vector3f(0.0f);
 		lightUbo.pointLightRadius = 0.0f;
 		lightUbo.pointLightPos = Vector3f(0.0f);
-		UpdataBufferData("lightUbo", &lightUbo);
+		UpdataBufferData(ResolveBuffer(mLightUbo, "lightUbo"), &lightUbo);
+	}
+
+	VulkanBuffer* VulkanResourceRegistry::ReserveObjectBuffer(UInt32 numObjects)
+	{
+		auto* pSSBOObject = GetBuffer(mPerObjectBuffer);
+		const UInt32 capacity = pSSBOObject->SizeCPU() / sizeof(ObjcetRenderData);
+		if (numObjects <= capacity)
+			return pSSBOObject;
+
+		const UInt32 newCapacity = eastl::max(numObjects, capacity * 2);
+		SG_LOG_DEBUG("Grow perObjectBuffer to %d objects", newCapacity);
+		if (!ResizeBuffer(mPerObjectBuffer, static_cast<UInt32>(sizeof(ObjcetRenderData) * newCapacity)))
+			SG_ASSERT(false);
+		return GetBuffer(mPerObjectBuffer);
+	}
+
+	BufferHandle VulkanResourceRegistry::ResolveBuffer(BufferHandle& handle, const char* name) const
+	{
+		if (!mBuffers.IsValid(handle))
+			handle = mBuffers.GetHandle(name);
+		return handle;
 	}
 
 	bool VulkanResourceRegistry::IsTextureNeedToGenerateMipmap(UInt32 width, UInt32 height, EImageFormat imageFormat, UInt32 dataByteSize, UInt32 mipmap) const
@@ -380,7 +391,7 @@ namespace SG
 	/// Buffers
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	bool VulkanResourceRegistry::CreateBuffer(const BufferCreateDesc& bufferCI)
+	BufferHandle VulkanResourceRegistry::CreateBuffer(const BufferCreateDesc& bufferCI)
 	{
 		SG_PROFILE_FUNCTION();
 
@@ -389,29 +400,35 @@ namespace SG
 		if (!bHostVisible && !SG_HAS_ENUM_FLAG(bufferCreateInfo.type, EBufferType::efTransfer_Dst))
 			bufferCreateInfo.type = bufferCreateInfo.type | EBufferType::efTransfer_Dst;
 
-		if (mBuffers.count(bufferCreateInfo.name) != 0) // do data copy
+		BufferHandle handle = mBuffers.GetHandle(bufferCreateInfo.name);
+		if (handle) // do data copy
 		{
 			if (!bHostVisible)
 			{
 				if (!bufferCreateInfo.pInitData)
 				{
 					SG_LOG_ERROR("Device local buffer must have initialize data!");
-					return false;
+					return BufferHandle();
 				}
 				// make a copy of bufferCI
-				mWaitToSubmitBuffers.push_back({ bufferCreateInfo, GetBuffer(bufferCreateInfo.name) });
-				return true;
+				mWaitToSubmitBuffers.push_back({ bufferCreateInfo, GetBuffer(handle) });
+				return handle;
 			}
 		}
 
-		mBuffers[bufferCreateInfo.name] = VulkanBuffer::Create(*mpContext, bufferCreateInfo);
-		VulkanBuffer* pBuffer = mBuffers[bufferCI.name];
+		VulkanBuffer* pBuffer = VulkanBuffer::Create(*mpContext, bufferCreateInfo);
 		if (!pBuffer)
 		{
 			SG_LOG_ERROR("Failed to create buffer: %s", bufferCreateInfo.name);
-			return false;
+			return BufferHandle();
 		}
 
+		// a host visible buffer with the same name is recreated in place, the handles to it stay valid.
+		if (handle)
+			mBuffers.Replace(handle, pBuffer);
+		else
+			handle = mBuffers.Add(bufferCreateInfo.name, pBuffer);
+
 		if (bHostVisible && bufferCreateInfo.pInitData)
 		{
 			if (bufferCreateInfo.bSubBuffer)
@@ -428,7 +445,7 @@ namespace SG
 				mWaitToSubmitBuffers.push_back({ bufferCreateInfo, pBuffer });
 			}
 		}
-		return true;
+		return handle;
 	}
 
 	void VulkanResourceRegistry::FlushBuffers() const
@@ -469,61 +486,166 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mBuffers.count(name) == 0)
-			return nullptr;
-		return mBuffers[name];
+		return mBuffers.Get(name);
 	}
 
-	void VulkanResourceRegistry::DeleteBuffer(const string& name)
+	void VulkanResourceRegistry::DeleteBuffer(BufferHandle handle)
 	{
 		SG_PROFILE_FUNCTION();
 
-		auto* pBuffer = GetBuffer(name);
+		auto* pBuffer = mBuffers.Remove(handle);
 		if (pBuffer)
-		{
 			Delete(pBuffer);
-			mBuffers.erase(name);
+	}
+
+	void VulkanResourceRegistry::DeleteBuffer(const string& name)
+	{
+		DeleteBuffer(mBuffers.GetHandle(name));
+	}
+
+	bool VulkanResourceRegistry::ResizeBuffer(BufferHandle handle, UInt32 newSize)
+	{
+		auto* pOldBuffer = mBuffers.Get(handle);
+		if (!pOldBuffer)
+			return false;
+		if (newSize <= pOldBuffer->SizeCPU())
+			return true;
+
+		vector<BufferCopyRegion> regions;
+		regions.push_back({ 0, 0, pOldBuffer->SizeCPU() });
+		return RelocateBuffer(handle, newSize, regions);
+	}
+
+	bool VulkanResourceRegistry::RelocateBuffer(BufferHandle handle, UInt32 newSize, const vector<BufferCopyRegion>& regions)
+	{
+		SG_PROFILE_FUNCTION();
+
+		auto* pOldBuffer = mBuffers.Get(handle);
+		if (!pOldBuffer)
+			return false;
+
+		// the pending uploads are pointing to the old buffer, and the gpu may still use it.
+		FlushBuffers();
+		WaitBuffersUpdated();
+		mpContext->device.WaitIdle();
+
+		const string& name = mBuffers.GetName(handle);
+		BufferCreateDesc bufferCI = {};
+		bufferCI.name = name.c_str();
+		bufferCI.bufferSize = newSize;
+		bufferCI.type = pOldBuffer->GetType();
+		bufferCI.memoryUsage = pOldBuffer->GetMemoryUsage();
+		bufferCI.memoryFlag = pOldBuffer->GetMemoryFlag();
+		VulkanBuffer* pNewBuffer = VulkanBuffer::Create(*mpContext, bufferCI);
+		if (!pNewBuffer)
+		{
+			SG_LOG_ERROR("Failed to recreate buffer: %s", name.c_str());
+			return false;
+		}
+
+		for (auto& region : regions)
+		{
+			SG_ASSERT(region.srcOffset + region.size <= pOldBuffer->SizeCPU());
+			SG_ASSERT(region.dstOffset + region.size <= newSize);
+		}
+
+		if (IsHostVisible(bufferCI.memoryUsage))
+		{
+			if (auto* pOldData = pOldBuffer->MapMemory<UInt8>())
+			{
+				for (auto& region : regions)
+					pNewBuffer->UploadData(pOldData + region.srcOffset, region.size, region.dstOffset);
+				if (!SG_HAS_ENUM_FLAG(bufferCI.memoryFlag, EGPUMemoryFlag::efPersistent_Map))
+					pOldBuffer->UnmapMemory();
+			}
+		}
+		else if (SG_HAS_ENUM_FLAG(bufferCI.type, EBufferType::efTransfer_Src))
+		{
+			VulkanCommandBuffer cmd;
+			mpContext->pTransferCommandPool->AllocateCommandBuffer(cmd);
+			VulkanFence* pFence = VulkanFence::Create(mpContext->device);
+
+			cmd.BeginRecord();
+			cmd.CopyBuffer(*pOldBuffer, *pNewBuffer, regions);
+			cmd.EndRecord();
+			mpContext->pTransferQueue->SubmitCommands<0, 0, 0>(&cmd, nullptr, nullptr, nullptr, pFence);
+			pFence->WaitAndReset();
+
+			Delete(pFence);
+			mpContext->pTransferCommandPool->FreeCommandBuffer(cmd);
 		}
+		else
+		{
+			SG_LOG_WARN("Buffer (%s) can not be copied, the content is dropped after recreating!", name.c_str());
+		}
+
+		mBuffers.Replace(handle, pNewBuffer);
+		Delete(pOldBuffer);
+
+		VulkanPipelineSignature::RebindBuffer(name);
+		return true;
 	}
 
 	bool VulkanResourceRegistry::HaveBuffer(const char* name)
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mBuffers.find(name) == mBuffers.end())
+		return mBuffers.Have(name);
+	}
+
+	bool VulkanResourceRegistry::UpdataBufferData(BufferHandle handle, const void* pData)
+	{
+		auto* pBuffer = mBuffers.Get(handle);
+		if (!pBuffer)
+		{
+			SG_LOG_ERROR("Invalid buffer handle!");
 			return false;
-		return true;
+		}
+		return pBuffer->UploadData(pData);
+	}
+
+	bool VulkanResourceRegistry::UpdataBufferData(BufferHandle handle, const void* pData, UInt32 size, UInt32 offset)
+	{
+		auto* pBuffer = mBuffers.Get(handle);
+		if (!pBuffer)
+		{
+			SG_LOG_ERROR("Invalid buffer handle!");
+			return false;
+		}
+		return pBuffer->UploadData(pData, size, offset);
 	}
 
 	bool VulkanResourceRegistry::UpdataBufferData(const char* name, const void* pData)
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mBuffers.count(name) == 0)
+		auto* pBuffer = mBuffers.Get(name);
+		if (!pBuffer)
 		{
 			SG_LOG_ERROR("No buffer named: %s", name);
 			return false;
 		}
-		return mBuffers[name]->UploadData(pData);
+		return pBuffer->UploadData(pData);
 	}
 
 	bool VulkanResourceRegistry::UpdataBufferData(const char* name, const void* pData, UInt32 size, UInt32 offset)
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mBuffers.count(name) == 0)
+		auto* pBuffer = mBuffers.Get(name);
+		if (!pBuffer)
 		{
 			SG_LOG_ERROR("No buffer named: %s", name);
 			return false;
 		}
-		return mBuffers[name]->UploadData(pData, size, offset);
+		return pBuffer->UploadData(pData, size, offset);
 	}
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// Textures
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	bool VulkanResourceRegistry::CreateTexture(const TextureCreateDesc& textureCI)
+	TextureHandle VulkanResourceRegistry::CreateTexture(const TextureCreateDesc& textureCI)
 	{
 		SG_PROFILE_FUNCTION();
 
@@ -533,19 +655,19 @@ namespace SG
 		if (IsTextureNeedToGenerateMipmap(textureCI.width, textureCI.height, textureCI.format, textureCI.sizeInByte, textureCI.mipLevel)) // need to generate mipmaps
 			texCI.usage = texCI.usage | EImageUsage::efTransfer_Src;
 
-		if (mTextures.count(texCI.name) != 0)
+		if (mTextures.Have(texCI.name))
 		{
 			SG_LOG_ERROR("Already have a texture named %s!", texCI.name);
-			return false;
+			return TextureHandle();
 		}
 
-		mTextures[texCI.name] = VulkanTexture::Create(*mpContext, texCI);
-		VulkanTexture* pTex = mTextures[texCI.name];
+		VulkanTexture* pTex = VulkanTexture::Create(*mpContext, texCI);
 		if (!pTex)
 		{
 			SG_LOG_ERROR("Failed to create texture: %s", texCI.name);
-			return false;
+			return TextureHandle();
 		}
+		const TextureHandle handle = mTextures.Add(texCI.name, pTex);
 
 		if (texCI.pInitData)
 		{
@@ -564,28 +686,21 @@ namespace SG
 			bufferCI.bufferSize = texCI.sizeInByte;
 			mWaitToSubmitTextures.push_back({ bufferCI, pTex });
 		}
-		return true;
+		return handle;
 	}
 
 	bool VulkanResourceRegistry::HaveTexture(const char* name) const
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mTextures.find(name) == mTextures.end())
-			return false;
-		return true;
+		return mTextures.Have(name);
 	}
 
 	VulkanTexture* VulkanResourceRegistry::GetTexture(const string& name) const
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mTextures.count(name) == 0)
-		{
-			//SG_LOG_ERROR("No texture named: %s", name);
-			return nullptr;
-		}
-		return mTextures[name];
+		return mTextures.Get(name);
 	}
 
 	void VulkanResourceRegistry::FlushTextures() const
@@ -730,20 +845,20 @@ namespace SG
 	/// DescriptorSet	
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void VulkanResourceRegistry::AddDescriptorSet(const string& name, VulkanDescriptorSet* pSet, bool bCreateHandle)
+	DescriptorSetHandle VulkanResourceRegistry::AddDescriptorSet(const string& name, VulkanDescriptorSet* pSet, bool bCreateHandle)
 	{
 		SG_PROFILE_FUNCTION();
 
-		auto node = mDescriptorSets.find(name);
-		if (node != mDescriptorSets.end())
+		if (mDescriptorSets.Have(name))
 		{
 			SG_LOG_ERROR("Already have a descriptor set named: %s", name.c_str());
-			return;
+			return DescriptorSetHandle();
 		}
-		mDescriptorSets[name] = pSet;
+		const DescriptorSetHandle handle = mDescriptorSets.Add(name, pSet);
 
 		if (bCreateHandle)
 			AddDescriptorSetHandle(name, pSet);
+		return handle;
 	}
 
 	void VulkanResourceRegistry::AddDescriptorSetHandle(const string& name, VulkanDescriptorSet* pSet)
@@ -763,15 +878,15 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-		auto node = mDescriptorSets.find(name);
-		if (node == mDescriptorSets.end())
+		auto* pSet = mDescriptorSets.Remove(name);
+		if (!pSet)
 		{
 			SG_LOG_ERROR("No descriptor set named: %s", name.c_str());
 			return;
 		}
 
-		Delete(node->second);
-		mDescriptorSets.erase(node);
+		mpContext->pDescriptorCache->Release(*pSet);
+		Delete(pSet);
 
 		// because the data had been destroyed, the handle must be invalid.
 		auto nodeHandle = mDescriptorSetHandles.find(name);
@@ -787,38 +902,36 @@ namespace SG
 	{
 		SG_PROFILE_FUNCTION();
 
-		for (auto node : mDescriptorSets)
-		{
-			if (node.second == pSet)
+		// this is the slow path, the sets are searched by the pointer.
+		string name;
+		mDescriptorSets.ForEach([pSet, &name](const string& setName, VulkanDescriptorSet* pCurrSet)
 			{
-				mDescriptorSets.erase(node.first);
-				for (auto nodeHandle : mDescriptorSetHandles)
-				{
-					if (nodeHandle.second.GetData() == pSet)
-					{
-						auto& handle = nodeHandle.second;
-						handle.Invalidate();
-						mDescriptorSetHandles.erase(nodeHandle.first);
-					}
-					return;
-				}
-				return;
-			}
+				if (pCurrSet == pSet)
+					name = setName;
+			});
+		if (name.empty())
+		{
+			SG_LOG_ERROR("No descriptor set: 0x%p", pSet);
+			return;
+		}
+
+		mDescriptorSets.Remove(name);
+		auto nodeHandle = mDescriptorSetHandles.find(name);
+		if (nodeHandle != mDescriptorSetHandles.end())
+		{
+			nodeHandle->second.Invalidate();
+			mDescriptorSetHandles.erase(nodeHandle);
 		}
-		SG_LOG_ERROR("No descriptor set: 0x%p", pSet);
 	}
 
 	VulkanDescriptorSet* VulkanResourceRegistry::GetDescriptorSet(const string& name) const
 	{
 		SG_PROFILE_FUNCTION();
 
-		auto node = mDescriptorSets.find(name);
-		if (node == mDescriptorSets.end())
-		{
+		auto* pSet = mDescriptorSets.Get(name);
+		if (!pSet)
 			SG_LOG_ERROR("No descritor set named: %s", name.c_str());
-			return nullptr;
-		}
-		return node->second;
+		return pSet;
 	}
 
 	Handle<VulkanDescriptorSet*> VulkanResourceRegistry::GetDescriptorSetHandle(const string& name)
@@ -838,85 +951,103 @@ namespace SG
 	/// RenderTargets	
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	bool VulkanResourceRegistry::CreateRenderTarget(const TextureCreateDesc& textureCI, bool isDepth)
+	RenderTargetHandle VulkanResourceRegistry::CreateRenderTarget(const TextureCreateDesc& textureCI, bool isDepth)
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mRenderTargets.count(textureCI.name) != 0)
+		if (mRenderTargets.Have(textureCI.name))
 		{
 			SG_LOG_ERROR("Already have a render target named %s!", textureCI.name);
-			return false;
+			return RenderTargetHandle();
 		}
 
-		mRenderTargets[textureCI.name] = VulkanRenderTarget::Create(*mpContext, textureCI, isDepth);
-		VulkanRenderTarget* pRt = mRenderTargets[textureCI.name];
+		auto pPlacement = mRenderTargetPlacements.find(textureCI.name);
+		VulkanRenderTarget* pRt = VulkanRenderTarget::Create(*mpContext, textureCI, isDepth,
+			pPlacement != mRenderTargetPlacements.end() ? &pPlacement->second : nullptr);
 		if (!pRt)
 		{
 			SG_LOG_ERROR("Failed to create render target : %s", textureCI.name);
-			return false;
+			return RenderTargetHandle();
 		}
 
-		return true;
+		return mRenderTargets.Add(textureCI.name, pRt);
 	}
 
-	void VulkanResourceRegistry::DeleteRenderTarget(const string& name)
+	void VulkanResourceRegistry::DeleteRenderTarget(RenderTargetHandle handle)
 	{
 		SG_PROFILE_FUNCTION();
 
-		auto* pRt = GetRenderTarget(name);
+		auto* pRt = mRenderTargets.Remove(handle);
 		if (pRt)
-		{
 			Delete(pRt);
-			mRenderTargets.erase(name);
-		}
+	}
+
+	void VulkanResourceRegistry::DeleteRenderTarget(const string& name)
+	{
+		DeleteRenderTarget(mRenderTargets.GetHandle(name));
 	}
 
 	VulkanRenderTarget* VulkanResourceRegistry::GetRenderTarget(const string& name) const
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mRenderTargets.count(name) == 0)
-		{
-			//SG_LOG_ERROR("No render target named: %s", name);
-			return nullptr;
-		}
-		return mRenderTargets[name];
+		return mRenderTargets.Get(name);
+	}
+
+	void VulkanResourceRegistry::SetRenderTargetPlacement(VulkanRenderTarget* pRenderTarget, const VulkanMemoryPlacement& placement)
+	{
+		SG_PROFILE_FUNCTION();
+
+		bool bFound = false;
+		mRenderTargets.ForEach([&](const string& name, VulkanRenderTarget* pRt)
+			{
+				if (pRt == pRenderTarget)
+				{
+					mRenderTargetPlacements[name] = placement;
+					bFound = true;
+				}
+			});
+
+		if (!bFound)
+			SG_LOG_WARN("Try to place a render target which is not in the registry!");
+	}
+
+	void VulkanResourceRegistry::ClearRenderTargetPlacements()
+	{
+		mRenderTargetPlacements.clear();
 	}
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// Samplers
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	bool VulkanResourceRegistry::CreateSampler(const SamplerCreateDesc& samplerCI)
+	SamplerHandle VulkanResourceRegistry::CreateSampler(const SamplerCreateDesc& samplerCI)
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mSamplers.count(samplerCI.name) != 0)
+		if (mSamplers.Have(samplerCI.name))
 		{
 			SG_LOG_ERROR("Already have a sampler named %s!", samplerCI.name);
-			return false;
+			return SamplerHandle();
 		}
 
-		mSamplers[samplerCI.name] = VulkanSampler::Create(mpContext->device, samplerCI);
-		VulkanSampler* pTex = mSamplers[samplerCI.name];
-		if (!pTex)
+		VulkanSampler* pSampler = VulkanSampler::Create(mpContext->device, samplerCI);
+		if (!pSampler)
 		{
 			SG_LOG_ERROR("Failed to create sampler: %s", samplerCI.name);
-			return false;
+			return SamplerHandle();
 		}
-		return true;
+		return mSamplers.Add(samplerCI.name, pSampler);
 	}
 
 	VulkanSampler* VulkanResourceRegistry::GetSampler(const string& name) const
 	{
 		SG_PROFILE_FUNCTION();
 
-		if (mSamplers.count(name) == 0)
-		{
-			SG_LOG_ERROR("No sampler named: %s", name);
-			return nullptr;
-		}
-		return mSamplers[name];
+		auto* pSampler = mSamplers.Get(name);
+		if (!pSampler)
+			SG_LOG_ERROR("No sampler named: %s", name.c_str());
+		return pSampler;
 	}
 
 }
\ No newline at end of file
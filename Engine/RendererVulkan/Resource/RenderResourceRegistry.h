@@ -11,20 +11,23 @@
 #include "RendererVulkan/RenderDevice/DrawCall.h"
 #include "RendererVulkan/Backend/VulkanCommand.h"
 #include "RendererVulkan/Backend/VulkanDescriptor.h"
+#include "RendererVulkan/Backend/VulkanAllocator.h"
+#include "RendererVulkan/Resource/ResourceTable.h"
 
 #include "Stl/vector.h"
-#include <eastl/utility.h>
-#include <eastl/unordered_map.h>
-#include <eastl/hash_map.h>
+#include <EASTL/utility.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/hash_map.h>
 
 namespace SG
 {
 
-#define SG_MAX_PACKED_VERTEX_BUFFER_SIZE 1024 * 1024 * 64   // 8mb
-#define SG_MAX_PACKED_INSTANCE_BUFFER_SIZE 1024 * 1024 * 32 // 2mb
-#define SG_MAX_PACKED_INDEX_BUFFER_SIZE  1024 * 1024 * 64   // 8mb
+// initial sizes, the buffers grow when the scene needs more.
+#define SG_DEFAULT_PACKED_VERTEX_BUFFER_SIZE 1024 * 1024 * 8   // 8mb
+#define SG_DEFAULT_PACKED_INSTANCE_BUFFER_SIZE 1024 * 1024 * 2 // 2mb
+#define SG_DEFAULT_PACKED_INDEX_BUFFER_SIZE  1024 * 1024 * 8   // 8mb
 
-#define SG_MAX_NUM_OBJECT 250
+#define SG_DEFAULT_NUM_OBJECT 256
 
 	// TODO: resource object reference counting
 	class VulkanContext;
@@ -37,6 +40,9 @@ namespace SG
 
 	class Shader;
 
+	//! The resources are kept in typed handle tables, creation returns a handle which gets the resource in O(1).
+	//! The functions taking a name hash the name on each call, they are meant for the initialization, the debug and the editor,
+	//! the code running each frame should keep the handles (see GetBufferHandle() and the others).
 	class VulkanResourceRegistry
 	{
 	public:
@@ -54,40 +60,65 @@ namespace SG
 
 		/// Buffer Begin
 		// By default, create the buffer using HOST_VISIBLE bit.
-		bool CreateBuffer(const BufferCreateDesc& bufferCI);
+		//! Return a null handle if failed. If a buffer with the same name exists, its data is updated and its handle is returned.
+		BufferHandle  CreateBuffer(const BufferCreateDesc& bufferCI);
+		VulkanBuffer* GetBuffer(BufferHandle handle) const { return mBuffers.Get(handle); }
 		VulkanBuffer* GetBuffer(const string& name) const;
+		BufferHandle  GetBufferHandle(const string& name) const { return mBuffers.GetHandle(name); }
 		bool HaveBuffer(const char* name);
+		void DeleteBuffer(BufferHandle handle);
 		void DeleteBuffer(const string& name);
+		//! Recreate the buffer with a bigger size, the handle stays valid and the descriptors bound to it are updated.
+		//! The content is kept, a gpu only buffer must have EBufferType::efTransfer_Src to be copied. The pointers to the old buffer are dangling after this.
+		//! It waits for the device to be idle, so grow the buffer geometrically instead of a little at a time.
+		bool ResizeBuffer(BufferHandle handle, UInt32 newSize);
+		//! Recreate the buffer with the size, and only copy the regions of the old buffer to the new one (i.e. the ranges moved by a defragmentation).
+		//! The rest of the new buffer is undefined. Like ResizeBuffer(), the handle stays valid and it waits for the device to be idle.
+		bool RelocateBuffer(BufferHandle handle, UInt32 newSize, const vector<BufferCopyRegion>& regions);
+		bool UpdataBufferData(BufferHandle handle, const void* pData);
+		bool UpdataBufferData(BufferHandle handle, const void* pData, UInt32 size, UInt32 offset);
 		bool UpdataBufferData(const char* name, const void* pData);
 		bool UpdataBufferData(const char* name, const void* pData, UInt32 size, UInt32 offset);
 		void FlushBuffers() const;
 		/// Buffer End
 
 		/// Texture Begin
-		bool CreateTexture(const TextureCreateDesc& textureCI);
+		TextureHandle  CreateTexture(const TextureCreateDesc& textureCI);
 		bool HaveTexture(const char* name) const;
+		VulkanTexture* GetTexture(TextureHandle handle) const { return mTextures.Get(handle); }
 		VulkanTexture* GetTexture(const string& name) const;
+		TextureHandle  GetTextureHandle(const string& name) const { return mTextures.GetHandle(name); }
 		void FlushTextures() const;
 		/// Texture End
 
 		/// DescriptorSet Begin
-		void AddDescriptorSet(const string& name, VulkanDescriptorSet* pSet, bool bCreateHandle = false);
+		DescriptorSetHandle AddDescriptorSet(const string& name, VulkanDescriptorSet* pSet, bool bCreateHandle = false);
 		void AddDescriptorSetHandle(const string& name, VulkanDescriptorSet* pSet);
 		void RemoveDescriptorSet(const string& name);
 		void RemoveDescriptorSet(VulkanDescriptorSet* pSet);
+		VulkanDescriptorSet*         GetDescriptorSet(DescriptorSetHandle handle) const { return mDescriptorSets.Get(handle); }
 		VulkanDescriptorSet*         GetDescriptorSet(const string& name) const;
 		Handle<VulkanDescriptorSet*> GetDescriptorSetHandle(const string& name);
 		/// DescriptorSet End
 
 		/// RenderTarget Begin
-		bool CreateRenderTarget(const TextureCreateDesc& textureCI, bool isDepth = false);
+		RenderTargetHandle  CreateRenderTarget(const TextureCreateDesc& textureCI, bool isDepth = false);
+		void DeleteRenderTarget(RenderTargetHandle handle);
 		void DeleteRenderTarget(const string& name);
+		VulkanRenderTarget* GetRenderTarget(RenderTargetHandle handle) const { return mRenderTargets.Get(handle); }
 		VulkanRenderTarget* GetRenderTarget(const string& name) const;
+		RenderTargetHandle  GetRenderTargetHandle(const string& name) const { return mRenderTargets.GetHandle(name); }
+		//! Place the render target in a range of the shared memory when it is created again, i.e. the aliased transient render targets.
+		//! The placement is kept by the name of the render target until ClearRenderTargetPlacements() is called.
+		void SetRenderTargetPlacement(VulkanRenderTarget* pRenderTarget, const VulkanMemoryPlacement& placement);
+		void ClearRenderTargetPlacements();
 		/// RenderTarget End
 
 		/// Sampler Begin
-		bool CreateSampler(const SamplerCreateDesc& samplerCI);
+		SamplerHandle  CreateSampler(const SamplerCreateDesc& samplerCI);
+		VulkanSampler* GetSampler(SamplerHandle handle) const { return mSamplers.Get(handle); }
 		VulkanSampler* GetSampler(const string& name) const;
+		SamplerHandle  GetSamplerHandle(const string& name) const { return mSamplers.GetHandle(name); }
 		/// Sampler End
 
 		static VulkanResourceRegistry* GetInstance();
@@ -99,16 +130,33 @@ namespace SG
 		bool IsTextureNeedToGenerateMipmap(UInt32 width, UInt32 height, EImageFormat imageFormat, UInt32 dataByteSize, UInt32 mipmap) const;
 
 		Matrix4f ComputeShadowedLightViewProj(RefPtr<ICamera> pCamera, const TransformComponent& trans, const DirectionalLightComponent& lightComp);
+
+		//! Grow the per object buffer to hold at least numObjects objects, return the buffer.
+		VulkanBuffer* ReserveObjectBuffer(UInt32 numObjects);
+
+		//! The uniform buffers are created by the pipeline signatures after the registry is initialized, find them by name once.
+		BufferHandle ResolveBuffer(BufferHandle& handle, const char* name) const;
 	private:
 		VulkanContext* mpContext;
 		MessageBusMember mMessageBusMember;
 
-		mutable eastl::unordered_map<string, VulkanBuffer*>  mBuffers;
-		mutable eastl::unordered_map<string, VulkanTexture*> mTextures;
-		mutable eastl::unordered_map<string, VulkanDescriptorSet*> mDescriptorSets;
+		ResourceTable<VulkanBuffer>        mBuffers;
+		ResourceTable<VulkanTexture>       mTextures;
+		ResourceTable<VulkanDescriptorSet> mDescriptorSets;
 		mutable eastl::unordered_map<string, Handle<VulkanDescriptorSet*>> mDescriptorSetHandles;
-		mutable eastl::unordered_map<string, VulkanRenderTarget*> mRenderTargets;
-		mutable eastl::unordered_map<string, VulkanSampler*> mSamplers;
+		ResourceTable<VulkanRenderTarget>  mRenderTargets;
+		eastl::unordered_map<string, VulkanMemoryPlacement> mRenderTargetPlacements;
+		ResourceTable<VulkanSampler>       mSamplers;
+
+		mutable BufferHandle mPerObjectBuffer;
+		mutable BufferHandle mCameraUbo;
+		mutable BufferHandle mSkyboxUbo;
+		mutable BufferHandle mLightUbo;
+		mutable BufferHandle mShadowUbo;
+		mutable BufferHandle mCompositionUbo;
+#if SG_ENABLE_GPU_CULLING
+		mutable BufferHandle mCullUbo;
+#endif
 
 		mutable vector<VulkanCommandBuffer> mSubmitedCommandBuffers; //! Cache all the transfer command buffer, clear it when do sync.
 		mutable vector<VulkanBuffer*> mpStagingBuffers; //! Cache all the transfer command buffer, clear it when do sync.
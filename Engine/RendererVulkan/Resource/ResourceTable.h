@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Base/Handle.h"
+#include "Archive/IDAllocator.h"
+
+#include "Stl/vector.h"
+#include "Stl/string.h"
+#include <EASTL/unordered_map.h>
+
+namespace SG
+{
+
+	//! Handle of a resource of type TResource in a ResourceTable.
+	//! Different resource types have different handle types, so a buffer handle can not be used to get a texture.
+	template <typename TResource>
+	class ResourceHandle
+	{
+	private:
+		using ThisType = ResourceHandle<TResource>;
+	public:
+		ResourceHandle() = default;
+		explicit ResourceHandle(GenHandle32 handle) : mHandle(handle) {}
+
+		//! Only tells if the handle is not null, use ResourceTable::IsValid() to know if the resource is still alive.
+		explicit operator bool() const noexcept { return !mHandle.IsNull(); }
+
+		GenHandle32 GetHandle() const noexcept { return mHandle; }
+
+		bool operator==(const ThisType& rhs) const noexcept { return mHandle == rhs.mHandle; }
+		bool operator!=(const ThisType& rhs) const noexcept { return mHandle != rhs.mHandle; }
+	private:
+		GenHandle32 mHandle;
+	};
+
+	class VulkanBuffer;
+	class VulkanTexture;
+	class VulkanRenderTarget;
+	class VulkanSampler;
+	class VulkanDescriptorSet;
+
+	using BufferHandle        = ResourceHandle<VulkanBuffer>;
+	using TextureHandle       = ResourceHandle<VulkanTexture>;
+	using RenderTargetHandle  = ResourceHandle<VulkanRenderTarget>;
+	using SamplerHandle       = ResourceHandle<VulkanSampler>;
+	using DescriptorSetHandle = ResourceHandle<VulkanDescriptorSet>;
+
+	//! Dense array of resources addressed by generational handles.
+	//! Getting a resource by its handle is an array access plus a generation check, and a handle of a removed resource
+	//! returns nullptr instead of the resource which reuses the slot.
+	//! The names are kept for the debug and editor path (and for the code which had not been moved to handles yet).
+	//! The table do not own the resources, the caller should Delete() the resource it removes.
+	template <typename TResource>
+	class ResourceTable
+	{
+	public:
+		using HandleType = ResourceHandle<TResource>;
+
+		HandleType Add(const string& name, TResource* pResource);
+		//! Replace the resource in the slot of the handle, the handle stays valid. Return the old resource.
+		TResource* Replace(HandleType handle, TResource* pResource);
+		//! Remove the resource and return it, all the handles to it become invalid.
+		TResource* Remove(HandleType handle);
+		TResource* Remove(const string& name) { return Remove(GetHandle(name)); }
+		void       Clear();
+
+		bool IsValid(HandleType handle) const { return mIdAllocator.IsAlive(handle.GetHandle()); }
+		bool Have(const string& name) const { return mNameToSlot.find(name) != mNameToSlot.end(); }
+
+		TResource* Get(HandleType handle) const
+		{
+			return IsValid(handle) ? mSlots[handle.GetHandle().GetIndex()].pResource : nullptr;
+		}
+		TResource* Get(const string& name) const { return Get(GetHandle(name)); }
+
+		//! Hash the name to find the handle, call it once and keep the handle.
+		HandleType    GetHandle(const string& name) const;
+		const string& GetName(HandleType handle) const;
+
+		UInt32 GetNumResources() const { return static_cast<UInt32>(mNameToSlot.size()); }
+
+		//! Call func(const string& name, TResource* pResource) on each resource.
+		template <typename TFunc>
+		void ForEach(TFunc&& func) const
+		{
+			for (const auto& node : mNameToSlot)
+				func(node.first, mSlots[node.second].pResource);
+		}
+	private:
+		struct Slot
+		{
+			TResource* pResource = nullptr;
+			string     name;
+		};
+
+		IDAllocator<UInt32> mIdAllocator;
+		vector<Slot> mSlots;
+		eastl::unordered_map<string, UInt32> mNameToSlot;
+	};
+
+	template <typename TResource>
+	typename ResourceTable<TResource>::HandleType ResourceTable<TResource>::Add(const string& name, TResource* pResource)
+	{
+		SG_ASSERT(!Have(name));
+
+		const UInt32 index = mIdAllocator.Allocate();
+		if (index == mSlots.size())
+			mSlots.emplace_back();
+		auto& slot = mSlots[index];
+		slot.pResource = pResource;
+		slot.name = name;
+		mNameToSlot[name] = index;
+		return HandleType(mIdAllocator.GetHandle<GenHandle32>(index));
+	}
+
+	template <typename TResource>
+	TResource* ResourceTable<TResource>::Replace(HandleType handle, TResource* pResource)
+	{
+		if (!IsValid(handle))
+			return nullptr;
+		auto& slot = mSlots[handle.GetHandle().GetIndex()];
+		TResource* pOld = slot.pResource;
+		slot.pResource = pResource;
+		return pOld;
+	}
+
+	template <typename TResource>
+	TResource* ResourceTable<TResource>::Remove(HandleType handle)
+	{
+		if (!IsValid(handle))
+			return nullptr;
+
+		const UInt32 index = handle.GetHandle().GetIndex();
+		auto& slot = mSlots[index];
+		TResource* pResource = slot.pResource;
+		mNameToSlot.erase(slot.name);
+		slot.pResource = nullptr;
+		slot.name.clear();
+		mIdAllocator.Restore(index);
+		return pResource;
+	}
+
+	template <typename TResource>
+	void ResourceTable<TResource>::Clear()
+	{
+		for (auto& slot : mSlots)
+			slot = Slot();
+		mNameToSlot.clear();
+		mIdAllocator.Reset();
+	}
+
+	template <typename TResource>
+	typename ResourceTable<TResource>::HandleType ResourceTable<TResource>::GetHandle(const string& name) const
+	{
+		auto node = mNameToSlot.find(name);
+		if (node == mNameToSlot.end())
+			return HandleType();
+		return HandleType(mIdAllocator.GetHandle<GenHandle32>(node->second));
+	}
+
+	template <typename TResource>
+	const string& ResourceTable<TResource>::GetName(HandleType handle) const
+	{
+		SG_ASSERT(IsValid(handle));
+		return mSlots[handle.GetHandle().GetIndex()].name;
+	}
+
+}
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <eastl/set.h>
+#include <EASTL/set.h>
 
 #ifdef SG_PLATFORM_WINDOWS
 #	ifndef WIN32_LEAN_AND_MEAN
@@ -60,6 +60,9 @@ project "SRendererVulkan"
     filter "system:windows"
     systemversion "latest"
     defines "SG_PLATFORM_WINDOWS"
+
+    filter "system:linux"
+    defines "SG_PLATFORM_LINUX=1"
     
     filter { "platforms:Win64" }
         defines { "VK_USE_PLATFORM_WIN32_KHR" }
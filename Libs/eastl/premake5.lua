@@ -30,6 +30,9 @@ project "eastl"
     systemversion "latest"
     defines "SG_PLATFORM_WINDOWS"
 
+    filter "system:linux"
+    defines "SG_PLATFORM_LINUX=1"
+
 filter "configurations:Debug"
     runtime "Debug"
     symbols "on"
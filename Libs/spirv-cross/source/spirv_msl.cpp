@@ -16252,6 +16252,6 @@ void CompilerMSL::emit_block_hints(const SPIRBlock &)
 string CompilerMSL::additional_fixed_sample_mask_str() const
 {
 	char print_buffer[32];
-	sprintf_s(print_buffer, "0x%x", msl_options.additional_fixed_sample_mask);
+	snprintf(print_buffer, sizeof(print_buffer), "0x%x", msl_options.additional_fixed_sample_mask);
 	return print_buffer;
 }
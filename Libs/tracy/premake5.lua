@@ -30,6 +30,10 @@ project "tracy_server"
     {
     }
 
+    filter "system:linux"
+    -- the libbacktrace of tracy is not vendored, which the callstacks on linux are built on
+    defines "TRACY_NO_CALLSTACK"
+
 filter "configurations:Debug"
     runtime "Debug"
     symbols "on"
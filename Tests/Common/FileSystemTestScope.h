@@ -0,0 +1,16 @@
+#pragma once
+
+#include "System/FileSystem.h"
+
+namespace SG
+{
+
+	//! Set up the stream ops of the file system for a test case.
+	class FileSystemTestScope
+	{
+	public:
+		FileSystemTestScope() { FileSystem::OnInit(); }
+		~FileSystemTestScope() { FileSystem::OnShutdown(); }
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Thread/IJobSystem.h"
+
+namespace SG
+{
+
+	//! Start the workers for a test case and stop them at the end of the scope.
+	class JobSystemTestScope
+	{
+	public:
+		explicit JobSystemTestScope(UInt32 numWorkers) { JobSystem::OnInit(numWorkers); }
+		~JobSystemTestScope() { JobSystem::OnShutdown(); }
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "System/Logger.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace SG
+{
+namespace Test
+{
+
+	static TestCase* sFirstTestCase = nullptr;
+	static TestCase* sLastTestCase = nullptr;
+	static UInt32    sNumFailures = 0;
+
+	void RegisterTestCase(TestCase* pTestCase)
+	{
+		// keep the order of definition, so the output is stable
+		if (sLastTestCase)
+			sLastTestCase->pNext = pTestCase;
+		else
+			sFirstTestCase = pTestCase;
+		sLastTestCase = pTestCase;
+	}
+
+	void ReportFailure(const char* file, int line, const char* expression)
+	{
+		++sNumFailures;
+		fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+		fflush(stderr);
+	}
+
+	const char* GetRootPath()
+	{
+		return SG_TEST_ROOT_PATH;
+	}
+
+}
+}
+
+//! Usage: <runner> [filter], only run the test cases whose "Suite.Name" contains the filter.
+int main(int argc, char** argv)
+{
+	using namespace SG;
+
+	Logger::SetLogMode(ELogMode::eLog_Mode_Quite_No_File);
+
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+	UInt32 numRun = 0;
+	UInt32 numFailed = 0;
+	char fullName[256];
+	for (Test::TestCase* pCase = Test::sFirstTestCase; pCase; pCase = pCase->pNext)
+	{
+		snprintf(fullName, sizeof(fullName), "%s.%s", pCase->suite, pCase->name);
+		if (filter && !strstr(fullName, filter))
+			continue;
+
+		printf("[ RUN      ] %s\n", fullName);
+		fflush(stdout);
+
+		const UInt32 numFailuresBefore = Test::sNumFailures;
+		pCase->func();
+		++numRun;
+
+		if (Test::sNumFailures == numFailuresBefore)
+			printf("[       OK ] %s\n", fullName);
+		else
+		{
+			++numFailed;
+			printf("[  FAILED  ] %s\n", fullName);
+		}
+		fflush(stdout);
+	}
+
+	printf("%u test cases run, %u failed.\n", numRun, numFailed);
+	return numFailed == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Defs/Defs.h"
+#include "Base/BasicTypes.h"
+#include "System/Logger.h"
+
+namespace SG
+{
+namespace Test
+{
+
+	typedef void (*TestFunc)();
+
+	//! A test case, registered before main() by the SG_TEST() macro.
+	struct TestCase
+	{
+		const char* suite;
+		const char* name;
+		TestFunc    func;
+		TestCase*   pNext;
+	};
+
+	void RegisterTestCase(TestCase* pTestCase);
+	//! Mark the running test case as failed, the test case keeps running.
+	void ReportFailure(const char* file, int line, const char* expression);
+
+	struct TestCaseRegister
+	{
+		TestCaseRegister(TestCase* pTestCase) { RegisterTestCase(pTestCase); }
+	};
+
+	//! Path of the repository root, relative to the working directory of the test runner.
+	const char* GetRootPath();
+
+	//! Log out nothing in the scope, for the tests which feed the bad data on purpose.
+	class SilentLogScope
+	{
+	public:
+		SilentLogScope() : mLogMode(Logger::GetLogMode()) { Logger::SetLogMode(ELogMode::eLog_Mode_Silent); }
+		~SilentLogScope() { Logger::SetLogMode(mLogMode); }
+	private:
+		ELogMode mLogMode;
+	};
+
+}
+}
+
+#define SG_TEST(SUITE, NAME) \
+	static void Test_##SUITE##_##NAME(); \
+	static ::SG::Test::TestCase sTestCase_##SUITE##_##NAME = { #SUITE, #NAME, &Test_##SUITE##_##NAME, nullptr }; \
+	static ::SG::Test::TestCaseRegister sTestCaseRegister_##SUITE##_##NAME(&sTestCase_##SUITE##_##NAME); \
+	static void Test_##SUITE##_##NAME()
+
+//! Check the expression, report and continue if it is false.
+#define SG_CHECK(EXPR) do { if (!(EXPR)) ::SG::Test::ReportFailure(__FILE__, __LINE__, #EXPR); } while (false)
+//! Check the expression, report and leave the test case if it is false.
+#define SG_REQUIRE(EXPR) do { if (!(EXPR)) { ::SG::Test::ReportFailure(__FILE__, __LINE__, #EXPR); return; } } while (false)
\ No newline at end of file
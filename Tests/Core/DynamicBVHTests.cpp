@@ -0,0 +1,214 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Scene/DynamicBVH.h"
+#include "Math/FrustumCulling.h"
+
+#include "Stl/vector.h"
+#include <EASTL/sort.h>
+
+using namespace SG;
+
+namespace
+{
+
+	//! Deterministic random numbers, the failures must be reproducible.
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+
+		UInt32 Range(UInt32 min, UInt32 max) { return min + Next() % (max - min + 1); }
+		float  Range(float min, float max) { return min + (max - min) * float(Next() & 0xffff) / 65535.0f; }
+		Vector3f Range(const Vector3f& min, const Vector3f& max) { return { Range(min.x, max.x), Range(min.y, max.y), Range(min.z, max.z) }; }
+	};
+
+	struct Proxy
+	{
+		DynamicBVH::ProxyID id;
+		UInt32 userData;
+		AABB   aabb;
+	};
+
+	// the world the proxies live in
+	const Vector3f WORLD_MIN = { -100.0f, -100.0f, -100.0f };
+	const Vector3f WORLD_MAX = { 100.0f, 100.0f, 100.0f };
+
+	AABB _RandomAABB(Random& random, float maxSize)
+	{
+		AABB aabb;
+		aabb.min = random.Range(WORLD_MIN, WORLD_MAX);
+		aabb.max = aabb.min + random.Range(Vector3f(0.0f), Vector3f(maxSize));
+		return aabb;
+	}
+
+	Frustum _RandomFrustum(Random& random)
+	{
+		const Vector3f eye = random.Range(WORLD_MIN, WORLD_MAX);
+		Vector3f target = random.Range(WORLD_MIN, WORLD_MAX);
+		if (glm::length(target - eye) < 1.0f)
+			target = eye + Vector3f(0.0f, 0.0f, 1.0f);
+		const Vector3f up = ::fabsf(glm::normalize(target - eye).y) > 0.99f ? Vector3f(1.0f, 0.0f, 0.0f) : Vector3f(0.0f, 1.0f, 0.0f);
+		const Matrix4f view = BuildViewMatrixCenter(eye, target, up);
+		// one draw per statement, the order of the arguments of a call is up to the compiler.
+		const float fovy = glm::radians(random.Range(30.0f, 90.0f));
+		const float aspect = random.Range(0.5f, 2.0f);
+		const float zFar = random.Range(20.0f, 300.0f);
+		const Matrix4f proj = BuildPerspectiveMatrix(fovy, aspect, 0.1f, zFar);
+		return Frustum::FromViewProj(proj * view);
+	}
+
+	bool _Overlap(const AABB& lhs, const AABB& rhs)
+	{
+		return lhs.min.x <= rhs.max.x && lhs.max.x >= rhs.min.x &&
+			lhs.min.y <= rhs.max.y && lhs.max.y >= rhs.min.y &&
+			lhs.min.z <= rhs.max.z && lhs.max.z >= rhs.min.z;
+	}
+
+	bool _IsSameAABB(const AABB& lhs, const AABB& rhs)
+	{
+		return lhs.min == rhs.min && lhs.max == rhs.max;
+	}
+
+	bool _IsSameUserData(vector<UInt32> lhs, vector<UInt32> rhs)
+	{
+		eastl::sort(lhs.begin(), lhs.end());
+		eastl::sort(rhs.begin(), rhs.end());
+		return lhs == rhs;
+	}
+
+	//! Check the tree against the proxies the test keeps, and its queries against a scan over all of them.
+	bool _CheckTree(const DynamicBVH& bvh, const vector<Proxy>& proxies, Random& random)
+	{
+		if (!bvh.Validate() || bvh.GetNumProxies() != proxies.size() || bvh.IsEmpty() != proxies.empty())
+			return false;
+		for (const auto& proxy : proxies)
+		{
+			if (!bvh.IsValid(proxy.id) || bvh.GetUserData(proxy.id) != proxy.userData || !_IsSameAABB(bvh.GetAABB(proxy.id), proxy.aabb))
+				return false;
+		}
+		if (proxies.size() > 1 && !(bvh.GetAreaRatio() >= 1.0f))
+			return false;
+
+		// a query box of any size, from one proxy to the whole world
+		const AABB queryAABB = _RandomAABB(random, random.Range(1.0f, 200.0f));
+		vector<UInt32> expected, result;
+		for (const auto& proxy : proxies)
+		{
+			if (_Overlap(proxy.aabb, queryAABB))
+				expected.push_back(proxy.userData);
+		}
+		bvh.QueryAABB(queryAABB, result);
+		if (!_IsSameUserData(expected, result))
+			return false;
+
+		const Frustum frustum = _RandomFrustum(random);
+		expected.clear();
+		result.clear();
+		for (const auto& proxy : proxies)
+		{
+			if (FrustumIntersectAABB(frustum, proxy.aabb))
+				expected.push_back(proxy.userData);
+		}
+		bvh.QueryFrustum(frustum, result);
+		return _IsSameUserData(expected, result);
+	}
+
+}
+
+SG_TEST(DynamicBVH, RandomOperationsMatchBruteForce)
+{
+	Random random(7);
+	DynamicBVH bvh;
+	vector<Proxy> proxies;
+	UInt32 nextUserData = 0;
+
+	auto createProxy = [&]()
+	{
+		Proxy proxy;
+		proxy.aabb = _RandomAABB(random, random.Range(0.0f, 20.0f));
+		proxy.userData = nextUserData++;
+		proxy.id = bvh.CreateProxy(proxy.aabb, proxy.userData);
+		proxies.push_back(proxy);
+	};
+
+	SG_REQUIRE(_CheckTree(bvh, proxies, random));
+	for (UInt32 step = 0; step < 3000; ++step)
+	{
+		const UInt32 op = random.Range(0u, 99u);
+		if (op < 35 || proxies.empty())
+			createProxy();
+		else if (op < 55) // small move, mostly stays under its parent
+		{
+			auto& proxy = proxies[random.Range(0u, UInt32(proxies.size() - 1))];
+			const Vector3f delta = random.Range(Vector3f(-0.5f), Vector3f(0.5f));
+			proxy.aabb.min += delta;
+			proxy.aabb.max += delta;
+			bvh.MoveProxy(proxy.id, proxy.aabb);
+		}
+		else if (op < 70) // teleport and resize
+		{
+			auto& proxy = proxies[random.Range(0u, UInt32(proxies.size() - 1))];
+			proxy.aabb = _RandomAABB(random, random.Range(0.0f, 20.0f));
+			bvh.MoveProxy(proxy.id, proxy.aabb);
+		}
+		else if (op < 95)
+		{
+			const UInt32 index = random.Range(0u, UInt32(proxies.size() - 1));
+			bvh.DestroyProxy(proxies[index].id);
+			proxies.erase_unsorted(proxies.begin() + index);
+		}
+		else if (op < 98)
+			bvh.Rebuild();
+		else // a burst of proxies, as a scene being loaded, then the tree is rebuilt
+		{
+			const UInt32 count = random.Range(10u, 100u);
+			for (UInt32 i = 0; i < count; ++i)
+				createProxy();
+			bvh.Rebuild();
+		}
+
+		SG_REQUIRE(_CheckTree(bvh, proxies, random));
+	}
+
+	// the ids of the destroyed proxies are reused, the tree must still be consistent after it is emptied.
+	for (const auto& proxy : proxies)
+		bvh.DestroyProxy(proxy.id);
+	proxies.clear();
+	SG_CHECK(bvh.IsEmpty());
+	SG_CHECK(_CheckTree(bvh, proxies, random));
+	createProxy();
+	SG_CHECK(_CheckTree(bvh, proxies, random));
+}
+
+SG_TEST(DynamicBVH, RebuildKeepsTheProxies)
+{
+	Random random(11);
+	DynamicBVH bvh;
+	vector<Proxy> proxies;
+	for (UInt32 i = 0; i < 500; ++i)
+	{
+		Proxy proxy;
+		proxy.aabb = _RandomAABB(random, 5.0f);
+		proxy.userData = i * 3;
+		proxy.id = bvh.CreateProxy(proxy.aabb, proxy.userData);
+		proxies.push_back(proxy);
+	}
+	SG_REQUIRE(_CheckTree(bvh, proxies, random));
+
+	bvh.Rebuild();
+	SG_CHECK(_CheckTree(bvh, proxies, random));
+	// a binary tree of 500 leaves built top-down by the SAH is not a list
+	SG_CHECK(bvh.GetHeight() < 32);
+
+	Random queries(13);
+	for (UInt32 i = 0; i < 50; ++i)
+		SG_CHECK(_CheckTree(bvh, proxies, queries));
+}
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "TipECS/EntityManager.h"
+
+#include "Stl/vector.h"
+
+using namespace SG;
+
+namespace
+{
+
+	struct PositionComponent
+	{
+		float x = 0.0f;
+	};
+
+	struct MeshComponent
+	{
+		UInt32 objectId = UInt32(-1);
+	};
+
+	struct HiddenTag {};
+
+	using TestComponentList = TipECS::ComponentList<PositionComponent, MeshComponent>;
+	using TestTagList = TipECS::TagList<HiddenTag>;
+	using TestSignature = TipECS::Signature<PositionComponent, MeshComponent>;
+	using TestSignatureList = TipECS::SignatureList<TestSignature>;
+	using TestSetting = TipECS::Setting<TestComponentList, TestTagList, TestSignatureList>;
+
+	using EntityManager = TipECS::EntityManager<TestSetting>;
+	using Entity = TipECS::Entity<TestSetting>;
+
+	enum class EHookType
+	{
+		eAdded,
+		eRemoved,
+		eModified,
+	};
+
+	struct HookRecord
+	{
+		EHookType type;
+		UInt32 objectId;
+	};
+
+	//! The hooks are plain functions, like the ones of the scene.
+	vector<HookRecord> gHookRecords;
+	UInt32 gNextObjectId = 0;
+
+	void _OnMeshAdded(const Entity&, MeshComponent& comp)
+	{
+		comp.objectId = gNextObjectId++;
+		gHookRecords.push_back({ EHookType::eAdded, comp.objectId });
+	}
+
+	void _OnMeshRemoved(const Entity&, MeshComponent& comp)
+	{
+		gHookRecords.push_back({ EHookType::eRemoved, comp.objectId });
+	}
+
+	void _OnMeshModified(const Entity&, MeshComponent& comp)
+	{
+		gHookRecords.push_back({ EHookType::eModified, comp.objectId });
+	}
+
+	void _HookMesh(EntityManager& manager)
+	{
+		gHookRecords.clear();
+		gNextObjectId = 0;
+		manager.GetComponentHooker<MeshComponent>().HookOnAdded(_OnMeshAdded);
+		manager.GetComponentHooker<MeshComponent>().HookOnRemoved(_OnMeshRemoved);
+		manager.GetComponentHooker<MeshComponent>().HookOnModified(_OnMeshModified);
+	}
+
+	bool _IsRecord(Size index, EHookType type, UInt32 objectId)
+	{
+		return index < gHookRecords.size() && gHookRecords[index].type == type && gHookRecords[index].objectId == objectId;
+	}
+
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+	};
+
+}
+
+SG_TEST(EntityHook, HooksFireInTheOrderOfTheChanges)
+{
+	EntityManager manager;
+	_HookMesh(manager);
+
+	Entity entity = manager.CreateEntity();
+	entity.AddComponent<PositionComponent>();
+	auto& mesh = entity.AddComponent<MeshComponent>();
+	SG_CHECK(mesh.objectId == 0);
+
+	entity.NotifyModified<MeshComponent>();
+	entity.NotifyModified<MeshComponent>();
+	entity.RemoveComponent<MeshComponent>();
+
+	SG_REQUIRE(gHookRecords.size() == 4);
+	SG_CHECK(_IsRecord(0, EHookType::eAdded, 0));
+	SG_CHECK(_IsRecord(1, EHookType::eModified, 0));
+	SG_CHECK(_IsRecord(2, EHookType::eModified, 0));
+	SG_CHECK(_IsRecord(3, EHookType::eRemoved, 0));
+}
+
+SG_TEST(EntityHook, HooksOnlyFireForTheirComponent)
+{
+	EntityManager manager;
+	_HookMesh(manager);
+
+	Entity entity = manager.CreateEntity();
+	entity.AddComponent<PositionComponent>();
+	entity.NotifyModified<PositionComponent>();
+	entity.RemoveComponent<PositionComponent>();
+	SG_CHECK(gHookRecords.empty());
+
+	// the hooks of an entity manager are not shared by the others
+	EntityManager other;
+	Entity otherEntity = other.CreateEntity();
+	otherEntity.AddComponent<MeshComponent>();
+	otherEntity.NotifyModified<MeshComponent>();
+	SG_CHECK(gHookRecords.empty());
+}
+
+SG_TEST(EntityHook, DestroyingAnEntityDoesNotFireTheRemovedHook)
+{
+	// the scene relies on this, it removes the mesh component itself before destroying the entity.
+	EntityManager manager;
+	_HookMesh(manager);
+
+	Entity entity = manager.CreateEntity();
+	entity.AddComponent<MeshComponent>();
+	manager.DestroyEntity(entity);
+	manager.ReFresh();
+
+	SG_REQUIRE(gHookRecords.size() == 1);
+	SG_CHECK(_IsRecord(0, EHookType::eAdded, 0));
+}
+
+SG_TEST(EntityHook, ReplayedDeltasMatchTheLiveComponents)
+{
+	// a consumer replaying the hook records, as the render data builder does with the mesh deltas,
+	// must end up with the same set of objects and modifications as the entity manager.
+	EntityManager manager;
+	_HookMesh(manager);
+
+	Random random(7);
+	vector<Entity> entities;
+	vector<UInt32> expectedModifyCounts;
+	for (UInt32 i = 0; i < 64; ++i)
+		entities.push_back(manager.CreateEntity());
+
+	for (UInt32 step = 0; step < 20000; ++step)
+	{
+		Entity& entity = entities[random.Next() % entities.size()];
+		if (!entity.HasComponent<MeshComponent>())
+		{
+			entity.AddComponent<MeshComponent>();
+			expectedModifyCounts.push_back(0);
+		}
+		else if (random.Next() % 4 == 0)
+		{
+			entity.RemoveComponent<MeshComponent>();
+		}
+		else
+		{
+			++expectedModifyCounts[entity.GetComponent<MeshComponent>().objectId];
+			entity.NotifyModified<MeshComponent>();
+		}
+
+		if (step % 1000 == 0)
+			manager.ReFresh();
+	}
+
+	vector<UInt8> replayedAlive(gNextObjectId, 0);
+	vector<UInt32> replayedModifyCounts(gNextObjectId, 0);
+	bool bReplayValid = true;
+	for (auto& record : gHookRecords)
+	{
+		auto& bAlive = replayedAlive[record.objectId];
+		switch (record.type)
+		{
+		case EHookType::eAdded:    bReplayValid &= !bAlive; bAlive = 1; break;
+		case EHookType::eRemoved:  bReplayValid &= !!bAlive; bAlive = 0; break;
+		case EHookType::eModified: bReplayValid &= !!bAlive; ++replayedModifyCounts[record.objectId]; break;
+		}
+	}
+	SG_CHECK(bReplayValid);
+	SG_CHECK(replayedModifyCounts == expectedModifyCounts);
+
+	UInt32 numAlive = 0;
+	UInt32 numMismatch = 0;
+	for (auto& entity : entities)
+	{
+		if (!entity.HasComponent<MeshComponent>())
+			continue;
+		++numAlive;
+		numMismatch += replayedAlive[entity.GetComponent<MeshComponent>().objectId] ? 0 : 1;
+	}
+	UInt32 numReplayedAlive = 0;
+	for (auto bAlive : replayedAlive)
+		numReplayedAlive += bAlive;
+	SG_CHECK(numMismatch == 0);
+	SG_CHECK(numReplayedAlive == numAlive);
+}
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "TipECS/EntityManager.h"
+
+#include "Stl/vector.h"
+#include "Stl/string.h"
+#include <EASTL/sort.h>
+
+using namespace SG;
+
+namespace
+{
+
+	struct PositionComponent
+	{
+		UInt32 value = 0;
+	};
+
+	struct NameComponent
+	{
+		string name; // not trivially copyable, the migrations must move it
+	};
+
+	//! Big enough that the archetypes holding it span several chunks.
+	struct PayloadComponent
+	{
+		UInt32 values[64] = {};
+	};
+
+	struct HiddenTag {};
+
+	using TestComponentList = TipECS::ComponentList<PositionComponent, NameComponent, PayloadComponent>;
+	using TestTagList = TipECS::TagList<HiddenTag>;
+	using TestSignature = TipECS::Signature<PositionComponent, PayloadComponent>;
+	using TestSignatureList = TipECS::SignatureList<TestSignature>;
+	using TestSetting = TipECS::Setting<TestComponentList, TestTagList, TestSignatureList>;
+
+	using EntityManager = TipECS::EntityManager<TestSetting>;
+	using Entity = TipECS::Entity<TestSetting>;
+
+	//! Deterministic random numbers, the failures must be reproducible.
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+	};
+
+	//! What the test expects an entity to hold.
+	struct EntityModel
+	{
+		Entity entity;
+		bool   bHasPosition = false;
+		bool   bHasName = false;
+		bool   bHasPayload = false;
+		bool   bHidden = false;
+		UInt32 position = 0;
+		string name;
+		UInt32 payload = 0;
+	};
+
+	string _MakeName(UInt32 value)
+	{
+		// longer than the small string buffer, so that the moves of the heap storage are tested too
+		string name;
+		name.sprintf("entity_with_a_long_enough_name_%u", value);
+		return name;
+	}
+
+	bool _IsSameAsModel(EntityModel& model)
+	{
+		Entity& entity = model.entity;
+		if (!entity.IsAlive() ||
+			entity.HasComponent<PositionComponent>() != model.bHasPosition ||
+			entity.HasComponent<NameComponent>() != model.bHasName ||
+			entity.HasComponent<PayloadComponent>() != model.bHasPayload ||
+			entity.HasTag<HiddenTag>() != model.bHidden)
+			return false;
+
+		if (model.bHasPosition && entity.GetComponent<PositionComponent>().value != model.position)
+			return false;
+		if (model.bHasName && entity.GetComponent<NameComponent>().name != model.name)
+			return false;
+		if (model.bHasPayload)
+		{
+			const auto& payload = entity.GetComponent<PayloadComponent>();
+			for (auto value : payload.values)
+			{
+				if (value != model.payload)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	void _SetPayload(PayloadComponent& payload, UInt32 value)
+	{
+		for (auto& v : payload.values)
+			v = value;
+	}
+
+}
+
+SG_TEST(EntityManager, ComponentsSurviveTheArchetypeMoves)
+{
+	EntityManager manager;
+	Random random(3);
+	vector<EntityModel> models;
+	UInt32 nextValue = 1;
+
+	for (UInt32 step = 0; step < 6000; ++step)
+	{
+		const UInt32 op = random.Next() % 100;
+		if (op < 10 || models.empty())
+		{
+			EntityModel model;
+			model.entity = manager.CreateEntity();
+			models.push_back(model);
+			continue;
+		}
+
+		const UInt32 index = random.Next() % models.size();
+		EntityModel& model = models[index];
+		Entity& entity = model.entity;
+		if (op < 30)
+		{
+			if (model.bHasPosition)
+				entity.RemoveComponent<PositionComponent>();
+			else
+			{
+				model.position = nextValue++;
+				entity.AddComponent<PositionComponent>().value = model.position;
+			}
+			model.bHasPosition = !model.bHasPosition;
+		}
+		else if (op < 50)
+		{
+			if (model.bHasName)
+				entity.RemoveComponent<NameComponent>();
+			else
+			{
+				model.name = _MakeName(nextValue++);
+				entity.AddComponent<NameComponent>(NameComponent{ model.name });
+			}
+			model.bHasName = !model.bHasName;
+		}
+		else if (op < 70)
+		{
+			if (model.bHasPayload)
+				entity.RemoveComponent<PayloadComponent>();
+			else
+			{
+				model.payload = nextValue++;
+				_SetPayload(entity.AddComponent<PayloadComponent>(), model.payload);
+			}
+			model.bHasPayload = !model.bHasPayload;
+		}
+		else if (op < 80)
+		{
+			if (model.bHidden)
+				entity.RemoveTag<HiddenTag>();
+			else
+				entity.AddTag<HiddenTag>();
+			model.bHidden = !model.bHidden;
+		}
+		else if (op < 92)
+		{
+			// write through the references, in whatever archetype the entity is now
+			if (model.bHasPosition)
+				entity.GetComponent<PositionComponent>().value = model.position = nextValue++;
+			if (model.bHasPayload)
+				_SetPayload(entity.GetComponent<PayloadComponent>(), model.payload = nextValue++);
+		}
+		else
+		{
+			manager.DestroyEntity(entity);
+			models.erase_unsorted(models.begin() + index);
+		}
+
+		// an entity leaving a row moves the last one of the chunk into it, every entity is checked
+		bool bAllSame = true;
+		for (auto& m : models)
+			bAllSame &= _IsSameAsModel(m);
+		SG_REQUIRE(bAllSame);
+
+		if (step % 100 == 99)
+			manager.ReFresh();
+	}
+	SG_CHECK(models.size() > 64);
+}
+
+SG_TEST(EntityManager, SignatureTraversalVisitsTheMatchedEntitiesOnce)
+{
+	EntityManager manager;
+	Random random(5);
+	vector<EntityModel> models;
+	for (UInt32 i = 0; i < 500; ++i)
+	{
+		EntityModel model;
+		model.entity = manager.CreateEntity();
+		// the same components added in different orders, with and without the tag, end up in several archetypes
+		const UInt32 kind = random.Next() % 6;
+		model.bHasPosition = kind != 0;
+		model.bHasPayload = kind != 1;
+		model.bHidden = kind == 5;
+		model.position = i + 1;
+		model.payload = i + 1;
+		if (kind % 2 == 0)
+		{
+			if (model.bHasPosition)
+				model.entity.AddComponent<PositionComponent>().value = model.position;
+			if (model.bHasPayload)
+				_SetPayload(model.entity.AddComponent<PayloadComponent>(), model.payload);
+		}
+		else
+		{
+			if (model.bHasPayload)
+				_SetPayload(model.entity.AddComponent<PayloadComponent>(), model.payload);
+			if (model.bHasPosition)
+				model.entity.AddComponent<PositionComponent>().value = model.position;
+		}
+		if (model.bHidden)
+			model.entity.AddTag<HiddenTag>();
+		models.push_back(model);
+	}
+	// destroy some of them, the holes are filled by the last rows of the chunks
+	for (UInt32 i = 0; i < models.size(); )
+	{
+		if (random.Next() % 5 == 0)
+		{
+			manager.DestroyEntity(models[i].entity);
+			models.erase_unsorted(models.begin() + i);
+		}
+		else
+			++i;
+	}
+	manager.ReFresh();
+
+	vector<UInt32> expected;
+	for (auto& model : models)
+	{
+		if (model.bHasPosition && model.bHasPayload)
+			expected.push_back(model.position);
+	}
+
+	vector<UInt32> visited;
+	bool bPayloadMatch = true;
+	manager.TraverseEntityMatchSignature<TestSignature>([&](PositionComponent& position, PayloadComponent& payload)
+		{
+			visited.push_back(position.value);
+			bPayloadMatch &= payload.values[0] == position.value && payload.values[63] == position.value;
+		});
+	eastl::sort(expected.begin(), expected.end());
+	eastl::sort(visited.begin(), visited.end());
+	SG_CHECK(bPayloadMatch);
+	SG_CHECK(!expected.empty());
+	SG_CHECK(visited == expected);
+}
\ No newline at end of file
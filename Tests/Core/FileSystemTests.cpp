@@ -0,0 +1,60 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+#include "Common/FileSystemTestScope.h"
+
+#include "Stl/vector.h"
+#include <filesystem>
+
+using namespace SG;
+
+namespace
+{
+
+	//! Run the test case in an empty working folder.
+	class WorkingFolderScope
+	{
+	public:
+		WorkingFolderScope()
+			:mPrevWorkingPath(std::filesystem::current_path())
+		{
+			mPath = std::filesystem::temp_directory_path() / "sg_file_system_tests";
+			std::filesystem::remove_all(mPath);
+			std::filesystem::create_directories(mPath);
+			std::filesystem::current_path(mPath);
+		}
+
+		~WorkingFolderScope()
+		{
+			std::filesystem::current_path(mPrevWorkingPath);
+			std::filesystem::remove_all(mPath);
+		}
+	private:
+		std::filesystem::path mPrevWorkingPath;
+		std::filesystem::path mPath;
+	};
+
+}
+
+SG_TEST(FileSystem, ReadAndWriteReturnTheBytes)
+{
+	WorkingFolderScope folder;
+	FileSystemTestScope fileSystem;
+
+	vector<Byte> data(1000);
+	for (Size i = 0; i < data.size(); ++i)
+		data[i] = Byte(i * 7);
+
+	SG_REQUIRE(FileSystem::Open(EResourceDirectory::eRoot, "data.bin", EFileMode::efWrite_Binary));
+	SG_CHECK(FileSystem::Write(data.data(), data.size()) == data.size());
+	FileSystem::Close();
+
+	SG_REQUIRE(FileSystem::Open(EResourceDirectory::eRoot, "data.bin", EFileMode::efRead_Binary));
+	SG_CHECK(FileSystem::FileSize() == data.size());
+	vector<Byte> readData(data.size());
+	SG_CHECK(FileSystem::Read(readData.data(), 600) == 600);
+	// only the rest of the file is read
+	SG_CHECK(FileSystem::Read(readData.data() + 600, 600) == 400);
+	SG_CHECK(FileSystem::Read(readData.data(), 1) == 0);
+	FileSystem::Close();
+	SG_CHECK(readData == data);
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Math/FrustumCulling.h"
+
+#include "Stl/vector.h"
+
+using namespace SG;
+
+namespace
+{
+
+	//! Deterministic random numbers, the failures must be reproducible.
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+
+		UInt32 Range(UInt32 min, UInt32 max) { return min + Next() % (max - min + 1); }
+		float  Range(float min, float max) { return min + (max - min) * float(Next() & 0xffff) / 65535.0f; }
+		Vector3f Range(const Vector3f& min, const Vector3f& max) { return { Range(min.x, max.x), Range(min.y, max.y), Range(min.z, max.z) }; }
+	};
+
+	const Vector3f WORLD_MIN = { -50.0f, -50.0f, -50.0f };
+	const Vector3f WORLD_MAX = { 50.0f, 50.0f, 50.0f };
+
+	Frustum _RandomFrustum(Random& random)
+	{
+		const Vector3f eye = random.Range(WORLD_MIN * 0.5f, WORLD_MAX * 0.5f);
+		const Vector3f direction = glm::normalize(random.Range(Vector3f(-1.0f), Vector3f(1.0f)) + Vector3f(0.0f, 0.0f, 0.01f));
+		const Vector3f up = ::fabsf(direction.y) > 0.99f ? Vector3f(1.0f, 0.0f, 0.0f) : Vector3f(0.0f, 1.0f, 0.0f);
+		const Matrix4f view = BuildViewMatrixDirection(eye, direction, up);
+		// one draw per statement, the order of the arguments of a call is up to the compiler.
+		const float fovy = glm::radians(random.Range(30.0f, 100.0f));
+		const float aspect = random.Range(0.5f, 2.0f);
+		const float zFar = random.Range(10.0f, 80.0f);
+		const Matrix4f proj = BuildPerspectiveMatrix(fovy, aspect, 0.1f, zFar);
+		return Frustum::FromViewProj(proj * view);
+	}
+
+	//! A point on one of the planes of the frustum, the bounds around it straddle the plane.
+	Vector3f _RandomPointOnPlane(Random& random, const Frustum& frustum, Vector3f& outNormal)
+	{
+		const Plane planes[6] = { frustum.GetFrontPlane(), frustum.GetBackPlane(), frustum.GetRightPlane(),
+			frustum.GetLeftPlane(), frustum.GetTopPlane(), frustum.GetBottomPlane() };
+		const Vector4f plane = planes[random.Range(0u, 5u)];
+		outNormal = Vector3f(plane);
+		const Vector3f point = random.Range(WORLD_MIN, WORLD_MAX);
+		return point - outNormal * (glm::dot(outNormal, point) + plane.w);
+	}
+
+	//! A point inside the frustum when a few draws find one, so that enough of the bounds are visible.
+	Vector3f _RandomPointInside(Random& random, const Frustum& frustum)
+	{
+		Vector3f point = random.Range(WORLD_MIN, WORLD_MAX);
+		for (UInt32 i = 0; i < 64 && !FrustumIntersectSphere(frustum, point, 0.0f); ++i)
+			point = random.Range(WORLD_MIN, WORLD_MAX);
+		return point;
+	}
+
+	//! Boxes anywhere, boxes inside, boxes straddling the planes, boxes touching the planes from the outside and flat boxes.
+	AABB _RandomAABB(Random& random, const Frustum& frustum)
+	{
+		Vector3f extent = random.Range(Vector3f(0.0f), Vector3f(random.Range(0.0f, 8.0f)));
+		Vector3f center;
+		Vector3f normal;
+		switch (random.Range(0u, 4u))
+		{
+		case 0:
+			center = random.Range(WORLD_MIN, WORLD_MAX);
+			break;
+		case 1:
+			center = _RandomPointInside(random, frustum);
+			break;
+		case 2:
+			center = _RandomPointOnPlane(random, frustum, normal);
+			break;
+		case 3: // the projected radius is the distance of the center to the plane, up to the rounding
+			center = _RandomPointOnPlane(random, frustum, normal);
+			center -= normal * glm::dot(glm::abs(normal), extent);
+			break;
+		default:
+			center = _RandomPointOnPlane(random, frustum, normal);
+			extent[random.Range(0u, 2u)] = 0.0f;
+			break;
+		}
+
+		AABB aabb;
+		aabb.min = center - extent;
+		aabb.max = center + extent;
+		return aabb;
+	}
+
+	void _RandomSphere(Random& random, const Frustum& frustum, Vector3f& outCenter, float& outRadius)
+	{
+		outRadius = random.Range(0u, 7u) == 0 ? 0.0f : random.Range(0.0f, 8.0f);
+		Vector3f normal;
+		switch (random.Range(0u, 3u))
+		{
+		case 0:
+			outCenter = random.Range(WORLD_MIN, WORLD_MAX);
+			break;
+		case 1:
+			outCenter = _RandomPointInside(random, frustum);
+			break;
+		case 2: // the normal is only known once the point is drawn
+			outCenter = _RandomPointOnPlane(random, frustum, normal);
+			outCenter += normal * random.Range(-outRadius, outRadius);
+			break;
+		default: // touching the plane from the outside
+			outCenter = _RandomPointOnPlane(random, frustum, normal);
+			outCenter -= normal * outRadius;
+			break;
+		}
+	}
+
+	//! The kernels to compare, the ones not built for the target fall back to the narrower ones.
+	vector<ECullingKernel> _GetKernels()
+	{
+		vector<ECullingKernel> kernels;
+		for (UInt32 kernel = 0; kernel <= UInt32(GetWidestCullingKernel()); ++kernel)
+			kernels.push_back(ECullingKernel(kernel));
+		return kernels;
+	}
+
+}
+
+SG_TEST(FrustumCulling, AllTheKernelsAreBuiltForTheTests)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+	// SCoreTests builds the culling with AVX, otherwise the AVX kernels are not compared at all.
+	SG_CHECK(GetWidestCullingKernel() == ECullingKernel::eAVX);
+#endif
+	SG_CHECK(!_GetKernels().empty());
+}
+
+SG_TEST(FrustumCulling, AABBKernelsGiveTheSameVisibility)
+{
+	Random random(17);
+	const auto kernels = _GetKernels();
+	UInt32 numVisible = 0;
+	UInt32 numTotal = 0;
+	for (UInt32 round = 0; round < 200; ++round)
+	{
+		const Frustum frustum = _RandomFrustum(random);
+		// the sizes cover the tails of the 8 and the 4 wide kernels
+		const UInt32 count = round < 40 ? round + 1 : random.Range(1u, 300u);
+
+		AABBSoA boxes;
+		vector<UInt8> expected(count);
+		UInt32 numExpected = 0;
+		for (UInt32 i = 0; i < count; ++i)
+		{
+			const AABB aabb = _RandomAABB(random, frustum);
+			boxes.PushBack(aabb);
+			expected[i] = FrustumIntersectAABB(frustum, aabb) ? 1 : 0;
+			numExpected += expected[i];
+		}
+		numVisible += numExpected;
+		numTotal += count;
+
+		for (auto kernel : kernels)
+		{
+			vector<UInt8> visibility(count, 2);
+			SG_CHECK(FrustumCullAABBs(frustum, boxes, visibility.data(), kernel) == numExpected);
+			SG_CHECK(visibility == expected);
+		}
+	}
+	// both sides of the planes are tested
+	SG_CHECK(numVisible > numTotal / 8);
+	SG_CHECK(numVisible < numTotal - numTotal / 8);
+}
+
+SG_TEST(FrustumCulling, SphereKernelsGiveTheSameVisibility)
+{
+	Random random(19);
+	const auto kernels = _GetKernels();
+	UInt32 numVisible = 0;
+	UInt32 numTotal = 0;
+	for (UInt32 round = 0; round < 200; ++round)
+	{
+		const Frustum frustum = _RandomFrustum(random);
+		const UInt32 count = round < 40 ? round + 1 : random.Range(1u, 300u);
+
+		SphereSoA spheres;
+		vector<UInt8> expected(count);
+		UInt32 numExpected = 0;
+		for (UInt32 i = 0; i < count; ++i)
+		{
+			Vector3f center;
+			float radius;
+			_RandomSphere(random, frustum, center, radius);
+			spheres.PushBack(center, radius);
+			expected[i] = FrustumIntersectSphere(frustum, center, radius) ? 1 : 0;
+			numExpected += expected[i];
+		}
+		numVisible += numExpected;
+		numTotal += count;
+
+		for (auto kernel : kernels)
+		{
+			vector<UInt8> visibility(count, 2);
+			SG_CHECK(FrustumCullSpheres(frustum, spheres, visibility.data(), kernel) == numExpected);
+			SG_CHECK(visibility == expected);
+		}
+	}
+	SG_CHECK(numVisible > numTotal / 8);
+	SG_CHECK(numVisible < numTotal - numTotal / 8);
+}
+
+SG_TEST(FrustumCulling, BoxesCrossingTheFarPlaneAreVisible)
+{
+	// only the far plane is in the way of the small boxes on the axis of the view.
+	const Matrix4f view = BuildViewMatrixDirection(Vector3f(0.0f), Vector3f(0.0f, 0.0f, -1.0f), Vector3f(0.0f, 1.0f, 0.0f));
+	const Matrix4f proj = BuildPerspectiveMatrix(glm::radians(90.0f), 1.0f, 1.0f, 100.0f);
+	const Frustum frustum = Frustum::FromViewProj(proj * view);
+
+	// the far plane is at z = -100, the boxes go from the inside of the frustum to the outside, none of them ends on the plane.
+	AABBSoA boxes;
+	vector<UInt8> expected;
+	for (UInt32 i = 0; i < 37; ++i)
+	{
+		const float maxZ = -98.4f - 0.25f * float(i);
+		boxes.PushBack({ Vector3f(-0.25f, -0.25f, maxZ - 0.5f), Vector3f(0.25f, 0.25f, maxZ) });
+		expected.push_back(maxZ > -100.0f ? 1 : 0);
+	}
+
+	for (auto kernel : _GetKernels())
+	{
+		vector<UInt8> visibility(boxes.GetSize(), 2);
+		FrustumCullAABBs(frustum, boxes, visibility.data(), kernel);
+		SG_CHECK(visibility == expected);
+	}
+}
\ No newline at end of file
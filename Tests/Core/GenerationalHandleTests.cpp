@@ -0,0 +1,157 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Archive/IDAllocator.h"
+#include "Base/Handle.h"
+#include "TipECS/EntityManager.h"
+
+#include "Stl/vector.h"
+
+using namespace SG;
+
+namespace
+{
+
+	//! Deterministic random numbers, the failures must be reproducible.
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+	};
+
+	struct PositionComponent
+	{
+		UInt32 value = 0;
+	};
+
+	using TestComponentList = TipECS::ComponentList<PositionComponent>;
+	using TestTagList = TipECS::TagList<>;
+	using TestSignatureList = TipECS::SignatureList<>;
+	using TestSetting = TipECS::Setting<TestComponentList, TestTagList, TestSignatureList>;
+
+	using EntityManager = TipECS::EntityManager<TestSetting>;
+	using Entity = TipECS::Entity<TestSetting>;
+
+}
+
+SG_TEST(GenerationalHandle, PacksTheIndexAndTheGeneration)
+{
+	const GenHandle32 handle(12345u, 678u);
+	SG_CHECK(handle.GetIndex() == 12345u);
+	SG_CHECK(handle.GetGeneration() == 678u);
+	SG_CHECK(!handle.IsNull());
+	SG_CHECK(GenHandle32::FromValue(handle.GetValue()) == handle);
+
+	// the generation wraps in its own bits, it never spills into the index
+	const GenHandle32 wrapped(GenHandle32::MAX_INDEX, GenHandle32::GENERATION_MASK + 2u);
+	SG_CHECK(wrapped.GetIndex() == GenHandle32::MAX_INDEX);
+	SG_CHECK(wrapped.GetGeneration() == 1u);
+	SG_CHECK(wrapped.MatchGeneration(GenHandle32::GENERATION_MASK + 2u));
+	SG_CHECK(!wrapped.IsNull());
+
+	SG_CHECK(GenHandle32().IsNull());
+	SG_CHECK(GenHandle64().IsNull());
+	const GenHandle64 handle64(0xfffffffeu, 0x12345678u);
+	SG_CHECK(handle64.GetIndex() == 0xfffffffeu);
+	SG_CHECK(handle64.GetGeneration() == 0x12345678u);
+}
+
+SG_TEST(IDAllocator, StaleHandlesNeverMatchTheReusedIds)
+{
+	Random random(29);
+	IDAllocator<UInt32> allocator;
+	vector<UInt32> aliveIds;
+	vector<GenHandle32> aliveHandles;
+	vector<GenHandle32> staleHandles;
+	vector<UInt8> bAlive;
+	UInt32 maxAlive = 0;
+
+	for (UInt32 step = 0; step < 20000; ++step)
+	{
+		if (random.Next() % 100 < 55 || aliveIds.empty())
+		{
+			const UInt32 id = allocator.Allocate();
+			if (id >= bAlive.size())
+				bAlive.resize(id + 1, 0);
+			SG_REQUIRE(!bAlive[id]);
+			bAlive[id] = 1;
+			aliveIds.push_back(id);
+			aliveHandles.push_back(allocator.GetHandle<GenHandle32>(id));
+		}
+		else
+		{
+			const UInt32 index = random.Next() % aliveIds.size();
+			const UInt32 id = aliveIds[index];
+			allocator.Restore(id);
+			// a double restore is ignored, the id must not be handed out twice
+			if (random.Next() % 4 == 0)
+				allocator.Restore(id);
+			bAlive[id] = 0;
+			staleHandles.push_back(aliveHandles[index]);
+			aliveIds.erase_unsorted(aliveIds.begin() + index);
+			aliveHandles.erase_unsorted(aliveHandles.begin() + index);
+		}
+		maxAlive = eastl::max(maxAlive, UInt32(aliveIds.size()));
+	}
+
+	bool bAliveMatch = true;
+	for (Size i = 0; i < aliveIds.size(); ++i)
+	{
+		bAliveMatch &= allocator.IsAlive(aliveIds[i]) && allocator.IsAlive(aliveHandles[i]);
+		bAliveMatch &= allocator.IsAlive(aliveIds[i], allocator.GetGeneration(aliveIds[i]));
+	}
+	SG_CHECK(bAliveMatch);
+
+	UInt32 numStaleAlive = 0;
+	for (auto handle : staleHandles)
+		numStaleAlive += allocator.IsAlive(handle) ? 1 : 0;
+	SG_CHECK(numStaleAlive == 0);
+	// the ids stay dense, they index the GPU buffers
+	SG_CHECK(bAlive.size() == maxAlive);
+}
+
+SG_TEST(IDAllocator, ResetMakesTheOldHandlesStale)
+{
+	IDAllocator<UInt32> allocator;
+	vector<GenHandle32> handles;
+	for (UInt32 i = 0; i < 16; ++i)
+		handles.push_back(allocator.GetHandle<GenHandle32>(allocator.Allocate()));
+	allocator.Restore(3);
+
+	allocator.Reset();
+	for (UInt32 i = 0; i < 16; ++i)
+		SG_CHECK(!allocator.IsAlive(handles[i]));
+
+	// the ids start from 0 again, with newer generations
+	SG_CHECK(allocator.Allocate() == 0);
+	SG_CHECK(allocator.IsAlive(allocator.GetHandle<GenHandle32>(0)));
+	SG_CHECK(!allocator.IsAlive(handles[0]));
+	SG_CHECK(!allocator.IsAlive(GenHandle32()));
+}
+
+SG_TEST(EntityHandle, CopiesOfADestroyedEntityAreInvalidAtOnce)
+{
+	EntityManager manager;
+	Entity entity = manager.CreateEntity();
+	entity.AddComponent<PositionComponent>().value = 7;
+	const Entity copy = entity;
+	SG_CHECK(copy.IsValid());
+
+	manager.DestroyEntity(entity);
+	// no ReFresh() in between
+	SG_CHECK(!copy.IsValid());
+
+	// the slot of the entity is reused after the refresh, the old copy must not see the new entity
+	manager.ReFresh();
+	Entity reused = manager.CreateEntity();
+	SG_CHECK(reused.IsValid());
+	SG_CHECK(!copy.IsValid());
+	SG_CHECK(!reused.HasComponent<PositionComponent>());
+}
\ No newline at end of file
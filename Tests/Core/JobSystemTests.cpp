@@ -0,0 +1,207 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+#include "Common/JobSystemTestScope.h"
+
+#include "Stl/vector.h"
+
+using namespace SG;
+
+namespace
+{
+
+	//! Spin (and help the job system) until the flag is set.
+	void _WaitFor(Atomic32& flag)
+	{
+		while (flag.Add(0) == 0)
+			ThreadSleep(0);
+	}
+
+	struct SumJob : public IJob<eastl::vector<UInt32>, UInt64>
+	{
+		virtual void Execute(const eastl::vector<UInt32>& inData, UInt64& outData) override
+		{
+			outData = 0;
+			for (UInt32 value : inData)
+				outData += value;
+		}
+	};
+
+}
+
+SG_TEST(JobSystem, ScheduleRunsEveryJob)
+{
+	JobSystemTestScope scope(3);
+
+	enum { NUM_JOBS = 500 };
+	Atomic32 counter;
+	eastl::vector<SJobHandle> handles;
+	for (UInt32 i = 0; i < NUM_JOBS; ++i)
+		handles.push_back(JobSystem::Schedule([](void* pUser) { reinterpret_cast<Atomic32*>(pUser)->Increase(); }, &counter));
+
+	for (auto& handle : handles)
+		JobSystem::CompleteAndDispose(handle);
+	SG_CHECK(counter.Add(0) == NUM_JOBS);
+
+	// IJob version
+	eastl::vector<UInt32> values;
+	for (UInt32 i = 1; i <= 100; ++i)
+		values.push_back(i);
+	SumJob job;
+	UInt64 sum = 0;
+	SJobHandle handle = JobSystem::Schedule(job, values, sum);
+	JobSystem::CompleteAndDispose(handle);
+	SG_CHECK(sum == 5050);
+}
+
+SG_TEST(JobSystem, ParallelForVisitsEveryIndexOnce)
+{
+	JobSystemTestScope scope(4);
+
+	enum { COUNT = 10000 };
+	eastl::vector<Atomic32> visits(COUNT);
+	auto visit = [&visits](UInt32 index) { visits[index].Increase(); };
+	// batch size not dividing the count, the last batch is a partial one
+	SJobHandle handle = JobSystem::ParallelFor(COUNT, 64, visit);
+	const SJobStatus status = handle.GetStatus();
+	SG_CHECK(status.state != EJobState::eInvalid);
+	SG_CHECK(status.numPendingJobs <= (COUNT + 63) / 64);
+	JobSystem::CompleteAndDispose(handle);
+
+	UInt32 numWrong = 0;
+	for (auto& v : visits)
+		numWrong += v.Add(0) == 1 ? 0 : 1;
+	SG_CHECK(numWrong == 0);
+
+	// nothing to do
+	SJobHandle empty = JobSystem::ParallelFor(0, 64, visit);
+	SG_CHECK(empty.pCounter == nullptr);
+	SG_CHECK(empty.IsCompleted());
+	SG_CHECK(empty.GetStatus().state == EJobState::eInvalid);
+}
+
+SG_TEST(JobSystem, DependencyRunsAfterItsPrerequisite)
+{
+	JobSystemTestScope scope(4);
+
+	struct Chain
+	{
+		Atomic32 step;
+		Atomic32 numOutOfOrder;
+		Atomic32 release;
+	} chain;
+
+	// the first job waits for the release, so the continuations must really be deferred
+	SJobHandle first = JobSystem::Schedule([](void* pUser)
+		{
+			Chain* pChain = reinterpret_cast<Chain*>(pUser);
+			_WaitFor(pChain->release);
+			if (pChain->step.Increase() != 1)
+				pChain->numOutOfOrder.Increase();
+		}, &chain);
+
+	// a parallel for depending on the first job
+	auto checkFirstDone = [&chain](UInt32)
+	{
+		if (chain.step.Add(0) < 1)
+			chain.numOutOfOrder.Increase();
+	};
+	SJobHandle middle = JobSystem::ParallelFor(256, 16, checkFirstDone, first);
+
+	SJobHandle last = JobSystem::Schedule([](void* pUser)
+		{
+			Chain* pChain = reinterpret_cast<Chain*>(pUser);
+			if (pChain->step.Increase() != 2)
+				pChain->numOutOfOrder.Increase();
+		}, &chain, middle);
+
+	SG_CHECK(!middle.IsCompleted());
+	SG_CHECK(middle.GetStatus().numPendingJobs == 16);
+	SG_CHECK(!last.IsCompleted());
+
+	chain.release.Exchange(1);
+	last.Complete();
+	SG_CHECK(first.IsCompleted());
+	SG_CHECK(middle.IsCompleted());
+	SG_CHECK(chain.step.Add(0) == 2);
+	SG_CHECK(chain.numOutOfOrder.Add(0) == 0);
+
+	// depending on a completed handle runs immediately
+	SJobHandle after = JobSystem::Schedule([](void* pUser) { reinterpret_cast<Chain*>(pUser)->step.Increase(); }, &chain, last);
+	JobSystem::CompleteAndDispose(after);
+	SG_CHECK(chain.step.Add(0) == 3);
+
+	first.Dispose();
+	middle.Dispose();
+	last.Dispose();
+}
+
+SG_TEST(JobSystem, CompleteHelpsToExecutePendingJobs)
+{
+	// only one worker, and keep it busy, then the main thread must do the jobs itself.
+	JobSystemTestScope scope(1);
+
+	struct Blocker
+	{
+		Atomic32 started;
+		Atomic32 release;
+	} blocker;
+	SJobHandle busy = JobSystem::Schedule([](void* pUser)
+		{
+			Blocker* pBlocker = reinterpret_cast<Blocker*>(pUser);
+			pBlocker->started.Exchange(1);
+			_WaitFor(pBlocker->release);
+		}, &blocker);
+	_WaitFor(blocker.started);
+
+	struct Record
+	{
+		Atomic32 numRun;
+		Atomic32 numRunOnMainThread;
+	} record;
+	SJobHandle handle = JobSystem::ParallelFor(8, 1, [](UInt32, UInt32, void* pUser)
+		{
+			Record* pRecord = reinterpret_cast<Record*>(pUser);
+			pRecord->numRun.Increase();
+			if (JobSystem::GetCurrThreadIndex() == 0)
+				pRecord->numRunOnMainThread.Increase();
+		}, &record);
+
+	JobSystem::CompleteAndDispose(handle);
+	SG_CHECK(record.numRun.Add(0) == 8);
+	SG_CHECK(record.numRunOnMainThread.Add(0) == 8);
+	SG_CHECK(!busy.IsCompleted());
+
+	blocker.release.Exchange(1);
+	JobSystem::CompleteAndDispose(busy);
+}
+
+SG_TEST(JobSystem, DisposeWhileJobsAreRunning)
+{
+	JobSystemTestScope scope(2);
+
+	struct Blocker
+	{
+		Atomic32 release;
+		Atomic32 numDone;
+	} blocker;
+	auto blockingJob = [](UInt32, UInt32, void* pUser)
+	{
+		Blocker* pBlocker = reinterpret_cast<Blocker*>(pUser);
+		_WaitFor(pBlocker->release);
+		pBlocker->numDone.Increase();
+	};
+
+	SJobHandle handle = JobSystem::ParallelFor(4, 1, blockingJob, &blocker);
+	// a continuation still refers to the counter of the disposed handle
+	SJobHandle next = JobSystem::ParallelFor(4, 1, blockingJob, &blocker, handle);
+	SG_CHECK(!handle.IsCompleted());
+	handle.Dispose();
+	SG_CHECK(handle.pCounter == nullptr);
+	SG_CHECK(handle.IsCompleted()); // a disposed handle is a default one
+	next.Dispose();
+
+	blocker.release.Exchange(1);
+	while (blocker.numDone.Add(0) != 8)
+		ThreadSleep(0);
+	// the scheduler releases the counters when the jobs finish, the sanitizers will catch a use after free.
+}
\ No newline at end of file
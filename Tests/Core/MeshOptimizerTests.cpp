@@ -0,0 +1,275 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Archive/MeshOptimizer.h"
+
+#include "Stl/vector.h"
+#include <EASTL/sort.h>
+#include <math.h>
+#include <string.h>
+
+using namespace SG;
+
+namespace
+{
+
+	// position(3), normal(3), uv(2), tangent(3), as the imported meshes
+	constexpr UInt32 VERTEX_FLOAT_COUNT = 11;
+
+	struct TestMesh
+	{
+		vector<float>  vertices;
+		vector<UInt32> indices;
+
+		UInt32 GetNumVertices() const { return UInt32(vertices.size() / VERTEX_FLOAT_COUNT); }
+		const float* GetVertex(UInt32 vertex) const { return vertices.data() + Size(vertex) * VERTEX_FLOAT_COUNT; }
+	};
+
+	//! Deterministic random numbers, the failures must be reproducible.
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+	};
+
+	void _PushVertex(TestMesh& mesh, float x, float y, float z, float nx, float ny, float nz, float u, float v)
+	{
+		const float vertex[VERTEX_FLOAT_COUNT] = { x, y, z, nx, ny, nz, u, v, 1.0f, 0.0f, 0.0f };
+		mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + VERTEX_FLOAT_COUNT);
+	}
+
+	//! A grid of quads on the xy plane, the triangles are in the row-major order.
+	TestMesh _MakeGrid(UInt32 width, UInt32 height)
+	{
+		TestMesh mesh;
+		for (UInt32 y = 0; y <= height; ++y)
+		{
+			for (UInt32 x = 0; x <= width; ++x)
+				_PushVertex(mesh, float(x), float(y), 0.0f, 0.0f, 0.0f, 1.0f, float(x) / float(width), float(y) / float(height));
+		}
+		for (UInt32 y = 0; y < height; ++y)
+		{
+			for (UInt32 x = 0; x < width; ++x)
+			{
+				const UInt32 v0 = y * (width + 1) + x;
+				const UInt32 v1 = v0 + 1;
+				const UInt32 v2 = v0 + width + 1;
+				const UInt32 v3 = v2 + 1;
+				const UInt32 quad[6] = { v0, v1, v3, v0, v3, v2 };
+				mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+			}
+		}
+		return mesh;
+	}
+
+	//! A uv sphere, the vertices on the seam and the poles are split by their uvs.
+	TestMesh _MakeSphere(UInt32 numRings, UInt32 numSegments)
+	{
+		TestMesh mesh;
+		for (UInt32 ring = 0; ring <= numRings; ++ring)
+		{
+			const float theta = 3.14159265f * float(ring) / float(numRings);
+			for (UInt32 segment = 0; segment <= numSegments; ++segment)
+			{
+				const float phi = 2.0f * 3.14159265f * float(segment) / float(numSegments);
+				const float x = sinf(theta) * cosf(phi);
+				const float y = cosf(theta);
+				const float z = sinf(theta) * sinf(phi);
+				_PushVertex(mesh, x, y, z, x, y, z, float(segment) / float(numSegments), float(ring) / float(numRings));
+			}
+		}
+		for (UInt32 ring = 0; ring < numRings; ++ring)
+		{
+			for (UInt32 segment = 0; segment < numSegments; ++segment)
+			{
+				const UInt32 v0 = ring * (numSegments + 1) + segment;
+				const UInt32 v1 = v0 + 1;
+				const UInt32 v2 = v0 + numSegments + 1;
+				const UInt32 v3 = v2 + 1;
+				const UInt32 quad[6] = { v0, v2, v1, v1, v2, v3 };
+				mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+			}
+		}
+		return mesh;
+	}
+
+	//! Give every index its own copy of the vertex, as a mesh exported without an index buffer.
+	TestMesh _Unweld(const TestMesh& mesh)
+	{
+		TestMesh unwelded;
+		for (auto index : mesh.indices)
+		{
+			unwelded.indices.push_back(unwelded.GetNumVertices());
+			unwelded.vertices.insert(unwelded.vertices.end(), mesh.GetVertex(index), mesh.GetVertex(index) + VERTEX_FLOAT_COUNT);
+		}
+		return unwelded;
+	}
+
+	//! Shuffle the order of the triangles, the order of the vertices in a triangle is kept.
+	void _ShuffleTriangles(TestMesh& mesh, UInt32 seed)
+	{
+		Random random(seed);
+		const UInt32 numTriangles = UInt32(mesh.indices.size() / 3);
+		for (UInt32 i = numTriangles; i > 1; --i)
+		{
+			const UInt32 j = random.Next() % i;
+			for (UInt32 k = 0; k < 3; ++k)
+				eastl::swap(mesh.indices[(i - 1) * 3 + k], mesh.indices[j * 3 + k]);
+		}
+	}
+
+	//! The data of the triangles, each one is rotated to start with its smallest vertex, so that only the winding is kept.
+	vector<vector<float>> _GetSortedTriangles(const TestMesh& mesh)
+	{
+		auto isLess = [&](UInt32 lhs, UInt32 rhs)
+		{
+			return memcmp(mesh.GetVertex(lhs), mesh.GetVertex(rhs), VERTEX_FLOAT_COUNT * sizeof(float)) < 0;
+		};
+
+		vector<vector<float>> triangles;
+		for (Size i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			const UInt32* pTriangle = &mesh.indices[i];
+			UInt32 first = 0;
+			if (isLess(pTriangle[1], pTriangle[first]))
+				first = 1;
+			if (isLess(pTriangle[2], pTriangle[first]))
+				first = 2;
+
+			vector<float> triangle;
+			for (UInt32 k = 0; k < 3; ++k)
+			{
+				const float* pVertex = mesh.GetVertex(pTriangle[(first + k) % 3]);
+				triangle.insert(triangle.end(), pVertex, pVertex + VERTEX_FLOAT_COUNT);
+			}
+			triangles.push_back(eastl::move(triangle));
+		}
+		eastl::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	//! Every index must still point to a vertex holding the data it pointed to before.
+	bool _IsSameVertexData(const TestMesh& before, const TestMesh& after)
+	{
+		if (before.indices.size() != after.indices.size())
+			return false;
+		for (Size i = 0; i < before.indices.size(); ++i)
+		{
+			if (memcmp(before.GetVertex(before.indices[i]), after.GetVertex(after.indices[i]), VERTEX_FLOAT_COUNT * sizeof(float)) != 0)
+				return false;
+		}
+		return true;
+	}
+
+	bool _HasDuplicatedVertices(const TestMesh& mesh)
+	{
+		vector<vector<float>> vertices;
+		for (UInt32 i = 0; i < mesh.GetNumVertices(); ++i)
+			vertices.emplace_back(mesh.GetVertex(i), mesh.GetVertex(i) + VERTEX_FLOAT_COUNT);
+		eastl::sort(vertices.begin(), vertices.end());
+		for (Size i = 1; i < vertices.size(); ++i)
+		{
+			if (vertices[i - 1] == vertices[i])
+				return true;
+		}
+		return false;
+	}
+
+}
+
+SG_TEST(MeshOptimizer, TrianglesAndWindingArePreserved)
+{
+	TestMesh meshes[] = { _Unweld(_MakeGrid(24, 16)), _Unweld(_MakeSphere(12, 24)), _MakeSphere(16, 32) };
+	_ShuffleTriangles(meshes[0], 1);
+	_ShuffleTriangles(meshes[1], 2);
+
+	for (auto& mesh : meshes)
+	{
+		const auto trianglesBefore = _GetSortedTriangles(mesh);
+		SG_REQUIRE(MeshOptimizer::Optimize(mesh.vertices, mesh.indices, VERTEX_FLOAT_COUNT));
+		SG_CHECK(_GetSortedTriangles(mesh) == trianglesBefore);
+	}
+}
+
+SG_TEST(MeshOptimizer, DeduplicateMergesOnlyTheSameVertices)
+{
+	// the seam and the poles of the sphere share the positions, but not the uvs, they must be kept.
+	const TestMesh welded[] = { _MakeGrid(10, 7), _MakeSphere(8, 12) };
+	for (const auto& source : welded)
+	{
+		const TestMesh before = _Unweld(source);
+		TestMesh mesh = before;
+		MeshOptimizer::DeduplicateVertices(mesh.vertices, mesh.indices, VERTEX_FLOAT_COUNT);
+
+		SG_CHECK(mesh.GetNumVertices() == source.GetNumVertices());
+		SG_CHECK(!_HasDuplicatedVertices(mesh));
+		SG_CHECK(_IsSameVertexData(before, mesh));
+	}
+}
+
+SG_TEST(MeshOptimizer, VertexFetchFollowsTheFirstReference)
+{
+	TestMesh mesh = _MakeSphere(8, 12);
+	_ShuffleTriangles(mesh, 3);
+	// a vertex no index points to is dropped
+	_PushVertex(mesh, 5.0f, 5.0f, 5.0f, 0.0f, 1.0f, 0.0f, 0.5f, 0.5f);
+	const TestMesh before = mesh;
+
+	MeshOptimizer::OptimizeVertexFetch(mesh.vertices, mesh.indices, VERTEX_FLOAT_COUNT);
+	SG_CHECK(mesh.GetNumVertices() == before.GetNumVertices() - 1);
+	SG_CHECK(_IsSameVertexData(before, mesh));
+
+	// the indices refer to the vertices in the increasing order when they are first seen
+	UInt32 numSeenVertices = 0;
+	for (auto index : mesh.indices)
+	{
+		SG_REQUIRE(index <= numSeenVertices);
+		if (index == numSeenVertices)
+			++numSeenVertices;
+	}
+	SG_CHECK(numSeenVertices == mesh.GetNumVertices());
+}
+
+SG_TEST(MeshOptimizer, CacheMissRatioIsNotWorse)
+{
+	TestMesh meshes[] = { _MakeGrid(64, 64), _MakeSphere(32, 64), _MakeGrid(64, 64) };
+	_ShuffleTriangles(meshes[2], 4);
+
+	for (auto& mesh : meshes)
+	{
+		const UInt32 numTriangles = UInt32(mesh.indices.size() / 3);
+		MeshCacheStatistics before, after;
+		SG_REQUIRE(MeshOptimizer::Optimize(mesh.vertices, mesh.indices, VERTEX_FLOAT_COUNT, &before, &after));
+
+		SG_CHECK(before.numTriangles == numTriangles);
+		SG_CHECK(after.numTriangles == numTriangles);
+		SG_CHECK(after.numVertices == before.numVertices);
+		SG_CHECK(after.acmr <= before.acmr);
+		// a vertex is transformed at least once
+		SG_CHECK(after.atvr >= 1.0f);
+	}
+}
+
+SG_TEST(MeshOptimizer, NotATriangleListIsLeftUntouched)
+{
+	TestMesh lines = _MakeGrid(2, 2);
+	lines.indices.resize(4);
+	const TestMesh linesBefore = lines;
+	SG_CHECK(!MeshOptimizer::Optimize(lines.vertices, lines.indices, VERTEX_FLOAT_COUNT));
+	SG_CHECK(lines.vertices == linesBefore.vertices);
+	SG_CHECK(lines.indices == linesBefore.indices);
+
+	Test::SilentLogScope silent;
+	TestMesh broken = _MakeGrid(2, 2);
+	broken.indices[4] = broken.GetNumVertices();
+	const TestMesh brokenBefore = broken;
+	SG_CHECK(!MeshOptimizer::Optimize(broken.vertices, broken.indices, VERTEX_FLOAT_COUNT));
+	SG_CHECK(broken.indices == brokenBefore.indices);
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Memory/OffsetAllocator.h"
+
+#include "Stl/vector.h"
+#include <string.h>
+
+using namespace SG;
+
+namespace
+{
+
+	//! Deterministic random numbers, the failures must be reproducible.
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+
+		UInt32 Range(UInt32 min, UInt32 max) { return min + Next() % (max - min + 1); }
+	};
+
+	//! Fill the range of the allocation with a pattern of its id, so that a wrong move or an overlap shows up.
+	void _Stamp(vector<UInt32>& memory, UInt32 offset, UInt32 size, OffsetAllocator::AllocationID id)
+	{
+		for (UInt32 i = 0; i < size; ++i)
+			memory[offset + i] = id * 7919u + i;
+	}
+
+	bool _CheckStamp(const vector<UInt32>& memory, UInt32 offset, UInt32 size, OffsetAllocator::AllocationID id)
+	{
+		for (UInt32 i = 0; i < size; ++i)
+		{
+			if (memory[offset + i] != id * 7919u + i)
+				return false;
+		}
+		return true;
+	}
+
+}
+
+SG_TEST(OffsetAllocator, AllocateAndFreeToEmpty)
+{
+	OffsetAllocator allocator(1024);
+	SG_CHECK(allocator.GetLargestFreeRegion() == 1024);
+	SG_CHECK(!allocator.Allocate(0).IsValid());
+	SG_CHECK(!allocator.Allocate(2048).IsValid());
+
+	vector<OffsetAllocator::Allocation> allocations;
+	for (UInt32 i = 0; i < 16; ++i)
+	{
+		auto allocation = allocator.Allocate(64);
+		SG_REQUIRE(allocation.IsValid());
+		SG_CHECK(allocator.GetOffset(allocation.id) == allocation.offset);
+		SG_CHECK(allocator.GetAllocationSize(allocation.id) == 64);
+		allocations.push_back(allocation);
+	}
+	SG_CHECK(allocator.GetFreeSize() == 0);
+	SG_CHECK(allocator.GetNumAllocations() == 16);
+	SG_CHECK(!allocator.Allocate(1).IsValid());
+	SG_CHECK(allocator.Validate());
+
+	// free in an interleaved order, the regions must merge back to one
+	for (UInt32 i = 0; i < 16; i += 2)
+		allocator.Deallocate(allocations[i].id);
+	for (UInt32 i = 1; i < 16; i += 2)
+		allocator.Deallocate(allocations[i].id);
+	SG_CHECK(allocator.GetNumAllocations() == 0);
+	SG_CHECK(allocator.GetUsedSize() == 0);
+	SG_CHECK(allocator.GetLargestFreeRegion() == 1024);
+	SG_CHECK(allocator.Validate());
+}
+
+SG_TEST(OffsetAllocator, FragmentedFreeSpaceIsPackedByDefragment)
+{
+	enum { SIZE = 1 << 16 };
+	OffsetAllocator allocator(SIZE);
+	vector<UInt32> memory(SIZE, 0);
+
+	// fill the resource with small blocks, then free every other one.
+	Random random(7);
+	vector<OffsetAllocator::Allocation> allocations;
+	while (true)
+	{
+		auto allocation = allocator.Allocate(random.Range(16, 96));
+		if (!allocation.IsValid())
+			break;
+		allocations.push_back(allocation);
+	}
+	SG_REQUIRE(allocations.size() > 100);
+
+	vector<OffsetAllocator::Allocation> alive;
+	for (Size i = 0; i < allocations.size(); ++i)
+	{
+		if (i % 2 == 0)
+			allocator.Deallocate(allocations[i].id);
+		else
+			alive.push_back(allocations[i]);
+	}
+	for (auto& allocation : alive)
+		_Stamp(memory, allocation.offset, allocator.GetAllocationSize(allocation.id), allocation.id);
+	SG_CHECK(allocator.Validate());
+
+	// plenty of free space in total, but no region can hold a large request.
+	const UInt32 request = 4096;
+	SG_CHECK(allocator.GetFreeSize() > 4 * request);
+	SG_CHECK(allocator.GetLargestFreeRegion() < request);
+	SG_CHECK(!allocator.Allocate(request).IsValid());
+
+	vector<OffsetAllocator::Move> moves;
+	allocator.Defragment(moves);
+	SG_CHECK(allocator.Validate());
+	SG_CHECK(!moves.empty());
+	SG_CHECK(allocator.GetLargestFreeRegion() == allocator.GetFreeSize());
+	SG_CHECK(allocator.GetNumAllocations() == (UInt32)alive.size());
+
+	// apply the moves in order as a gpu copy would do, every move goes to a lower offset.
+	UInt32 lastSrcOffset = 0;
+	for (auto& move : moves)
+	{
+		SG_CHECK(move.dstOffset < move.srcOffset);
+		SG_CHECK(move.srcOffset >= lastSrcOffset);
+		lastSrcOffset = move.srcOffset;
+		memmove(memory.data() + move.dstOffset, memory.data() + move.srcOffset, move.size * sizeof(UInt32));
+	}
+
+	// the ids are stable, the content follows them.
+	UInt32 expectedOffset = 0;
+	UInt32 numBadContent = 0;
+	for (auto& allocation : alive)
+	{
+		const UInt32 offset = allocator.GetOffset(allocation.id);
+		const UInt32 size = allocator.GetAllocationSize(allocation.id);
+		SG_CHECK(offset == expectedOffset);
+		expectedOffset = offset + size;
+		if (!_CheckStamp(memory, offset, size, allocation.id))
+			++numBadContent;
+	}
+	SG_CHECK(numBadContent == 0);
+
+	auto large = allocator.Allocate(request);
+	SG_CHECK(large.IsValid());
+	SG_CHECK(large.offset == expectedOffset);
+	SG_CHECK(allocator.Validate());
+}
+
+SG_TEST(OffsetAllocator, RandomAllocationsNeverOverlap)
+{
+	enum { SIZE = 1 << 20, NUM_STEPS = 20000 };
+	OffsetAllocator allocator(SIZE);
+	vector<UInt32> memory(SIZE, 0);
+	vector<OffsetAllocator::Allocation> alive;
+
+	Random random(12345);
+	UInt64 usedSize = 0;
+	UInt32 numBadContent = 0;
+	for (UInt32 step = 0; step < NUM_STEPS; ++step)
+	{
+		// mostly allocate at the beginning, mostly free at the end, so the free space gets scattered
+		const bool bAllocate = alive.empty() || random.Range(0, NUM_STEPS) > step / 2;
+		if (bAllocate)
+		{
+			// a mix of small and large requests
+			const UInt32 size = random.Range(0, 9) == 0 ? random.Range(1024, 16384) : random.Range(1, 256);
+			auto allocation = allocator.Allocate(size);
+			if (!allocation.IsValid())
+				continue;
+			_Stamp(memory, allocation.offset, size, allocation.id);
+			usedSize += size;
+			alive.push_back(allocation);
+		}
+		else
+		{
+			const UInt32 index = random.Range(0, (UInt32)alive.size() - 1);
+			const auto allocation = alive[index];
+			const UInt32 size = allocator.GetAllocationSize(allocation.id);
+			// any overlap would have overwritten the stamp
+			if (!_CheckStamp(memory, allocation.offset, size, allocation.id))
+				++numBadContent;
+			allocator.Deallocate(allocation.id);
+			usedSize -= size;
+			alive[index] = alive.back();
+			alive.pop_back();
+		}
+
+		if (step % 1000 == 0)
+			SG_CHECK(allocator.Validate());
+	}
+
+	SG_CHECK(numBadContent == 0);
+	SG_CHECK(allocator.GetUsedSize() == usedSize);
+	SG_CHECK(allocator.GetNumAllocations() == (UInt32)alive.size());
+	SG_CHECK(allocator.Validate());
+
+	for (auto& allocation : alive)
+		allocator.Deallocate(allocation.id);
+	SG_CHECK(allocator.GetLargestFreeRegion() == SIZE);
+	SG_CHECK(allocator.Validate());
+}
+
+SG_TEST(OffsetAllocator, GrowKeepsTheAllocations)
+{
+	OffsetAllocator allocator(256);
+	auto a = allocator.Allocate(100);
+	auto b = allocator.Allocate(100);
+	SG_REQUIRE(a.IsValid() && b.IsValid());
+	allocator.Deallocate(a.id);
+	SG_CHECK(!allocator.Allocate(200).IsValid());
+
+	allocator.Grow(1024);
+	SG_CHECK(allocator.GetSize() == 1024);
+	SG_CHECK(allocator.GetOffset(b.id) == b.offset);
+	// the free tail is merged with the new space
+	SG_CHECK(allocator.GetLargestFreeRegion() == 1024 - b.offset - 100);
+	auto c = allocator.Allocate(600);
+	SG_CHECK(c.IsValid());
+	SG_CHECK(c.offset == b.offset + 100);
+	SG_CHECK(allocator.Validate());
+
+	allocator.Reset(512);
+	SG_CHECK(allocator.GetNumAllocations() == 0);
+	SG_CHECK(allocator.GetLargestFreeRegion() == 512);
+	SG_CHECK(allocator.Validate());
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+#include "Common/JobSystemTestScope.h"
+
+#include "System/System.h"
+
+#include "Stl/vector.h"
+#include "Stl/string.h"
+#include <stdio.h>
+#include <filesystem>
+
+using namespace SG;
+
+namespace
+{
+
+	//! A folder for the outputs of the processes, removed at the end of the scope.
+	class TempFolderScope
+	{
+	public:
+		explicit TempFolderScope(const char* name)
+		{
+			mPath = std::filesystem::temp_directory_path() / name;
+			std::filesystem::remove_all(mPath);
+			std::filesystem::create_directories(mPath);
+		}
+
+		~TempFolderScope() { std::filesystem::remove_all(mPath); }
+
+		string GetPath(const char* name) const { return string((mPath / name).string().c_str()); }
+	private:
+		std::filesystem::path mPath;
+	};
+
+	string _ReadWholeFile(const string& path)
+	{
+		string content;
+		FILE* pFile = fopen(path.c_str(), "rb");
+		if (!pFile)
+			return content;
+		char buffer[256];
+		Size numRead = 0;
+		while ((numRead = fread(buffer, 1, sizeof(buffer), pFile)) != 0)
+			content.append(buffer, buffer + numRead);
+		fclose(pFile);
+		return content;
+	}
+
+}
+
+#if SG_PLATFORM_LINUX
+SG_TEST(Process, ExitCodeIsReturned)
+{
+	SG_CHECK(System::RunProcess("true", nullptr) == 0);
+	SG_CHECK(System::RunProcess("exit 3", nullptr) == 3);
+	SG_CHECK(System::RunProcess("sg_no_such_command 2>/dev/null", nullptr) == 127); // by the shell
+	SG_CHECK(System::RunProcess("kill -9 $$", nullptr) == -1); // not exited
+}
+
+SG_TEST(Process, OutputAndErrorGoToTheFile)
+{
+	TempFolderScope folder("sg_process_tests");
+	const string outPath = folder.GetPath("out.txt");
+
+	SG_CHECK(System::RunProcess("echo out; echo err 1>&2; exit 1", outPath.c_str()) == 1);
+	SG_CHECK(_ReadWholeFile(outPath) == "out\nerr\n");
+
+	// the file is truncated by the next run
+	SG_CHECK(System::RunProcess("echo again", outPath.c_str()) == 0);
+	SG_CHECK(_ReadWholeFile(outPath) == "again\n");
+}
+
+SG_TEST(Process, ProcessesRunAtTheSameTime)
+{
+	// each process leaves a marker and waits for the markers of all the others,
+	// so they only exit 0 if they are running at the same time, as the shader compiler runs them.
+	enum { NUM_PROCESSES = 3 };
+	JobSystemTestScope scope(NUM_PROCESSES);
+	TempFolderScope folder("sg_process_tests");
+	const string markerFolder = folder.GetPath("markers");
+	std::filesystem::create_directories(markerFolder.c_str());
+
+	vector<int> exitCodes(NUM_PROCESSES, -2);
+	auto runProcess = [&](UInt32 index)
+	{
+		char command[512];
+		snprintf(command, sizeof(command),
+			"touch '%s/%u'; n=0; while [ $(ls '%s' | wc -l) -lt %d ]; do n=$((n+1)); [ $n -gt 400 ] && exit 1; sleep 0.025; done; echo %u",
+			markerFolder.c_str(), index, markerFolder.c_str(), int(NUM_PROCESSES), index);
+		char outName[32];
+		snprintf(outName, sizeof(outName), "out%u.txt", index);
+		exitCodes[index] = System::RunProcess(command, folder.GetPath(outName).c_str());
+	};
+	SJobHandle handle = JobSystem::ParallelFor(NUM_PROCESSES, 1, runProcess);
+	JobSystem::CompleteAndDispose(handle);
+
+	for (UInt32 i = 0; i < NUM_PROCESSES; ++i)
+	{
+		SG_CHECK(exitCodes[i] == 0);
+		char outName[32];
+		snprintf(outName, sizeof(outName), "out%u.txt", i);
+		char expected[32];
+		snprintf(expected, sizeof(expected), "%u\n", i);
+		SG_CHECK(_ReadWholeFile(folder.GetPath(outName)) == expected);
+	}
+}
+#endif // SG_PLATFORM_LINUX
\ No newline at end of file
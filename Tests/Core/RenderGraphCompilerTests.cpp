@@ -0,0 +1,482 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Render/RenderGraphCompiler.h"
+
+#include "Stl/vector.h"
+
+using namespace SG;
+
+namespace
+{
+
+	enum : UInt32
+	{
+		NO_WRITER = RenderGraphCompiler::INVALID_INDEX,
+	};
+
+	//! Deterministic random numbers, the failures must be reproducible.
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+
+		UInt32 Range(UInt32 min, UInt32 max) { return min + Next() % (max - min + 1); }
+	};
+
+	//! The passes and the resources of a frame, as the render graph would declare them to the compiler.
+	struct MockGraph
+	{
+		struct Pass
+		{
+			vector<UInt32> reads;
+			vector<UInt32> writes;
+			EQueueType     queue;
+			bool           bEnabled;
+		};
+
+		vector<Pass> passes;
+		vector<bool> outputs;
+
+		UInt32 AddResource(bool bOutput = false)
+		{
+			outputs.push_back(bOutput);
+			return static_cast<UInt32>(outputs.size() - 1);
+		}
+
+		UInt32 AddPass(EQueueType queue = EQueueType::eGraphic, bool bEnabled = true)
+		{
+			passes.push_back({ {}, {}, queue, bEnabled });
+			return static_cast<UInt32>(passes.size() - 1);
+		}
+
+		void Compile(RenderGraphCompiler& compiler, bool bAsyncCompute = false) const
+		{
+			compiler.Reset();
+			for (bool bOutput : outputs)
+				compiler.AddResource(bOutput);
+			for (UInt32 i = 0; i < passes.size(); ++i)
+			{
+				compiler.AddPass(passes[i].queue, passes[i].bEnabled);
+				for (auto resource : passes[i].reads)
+					compiler.Read(i, resource);
+				for (auto resource : passes[i].writes)
+					compiler.Write(i, resource);
+			}
+			compiler.Compile(bAsyncCompute);
+		}
+
+		//! The content a pass should see: the one of the last enabled pass declared before it which writes the resource.
+		UInt32 GetExpectedWriter(UInt32 resource, UInt32 pass) const
+		{
+			for (UInt32 i = pass; i-- > 0;)
+			{
+				if (passes[i].bEnabled && Contains(passes[i].writes, resource))
+					return i;
+			}
+			return NO_WRITER;
+		}
+
+		static bool Contains(const vector<UInt32>& indices, UInt32 index)
+		{
+			for (auto i : indices)
+			{
+				if (i == index)
+					return true;
+			}
+			return false;
+		}
+	};
+
+	//! Runs a compiled graph as a gpu would do, without any gpu: every queue executes its live passes in the execution order,
+	//! the queues interleave freely, and a pass only starts when the passes it waits for on the other queues are done.
+	//! The resources only remember which pass wrote their content, so a missing dependency shows up as a stale or a too new content.
+	class MockDevice
+	{
+	public:
+		//! Return false if the queues wait for each other forever.
+		bool Execute(const MockGraph& graph, const RenderGraphCompiler& compiler, Random& random)
+		{
+			vector<vector<UInt32>> queues(static_cast<UInt32>(EQueueType::MAX_COUNT));
+			for (auto pass : compiler.GetExecutionOrder())
+			{
+				if (!compiler.IsPassCulled(pass))
+					queues[static_cast<UInt32>(compiler.GetPassQueue(pass))].push_back(pass);
+			}
+
+			mContents.assign(graph.outputs.size(), NO_WRITER);
+			mSeenContents.assign(graph.passes.size(), vector<UInt32>());
+			mExecuted.assign(graph.passes.size(), false);
+			vector<UInt32> heads(queues.size(), 0);
+			vector<UInt32> ready;
+			while (true)
+			{
+				ready.clear();
+				for (UInt32 q = 0; q < queues.size(); ++q)
+				{
+					if (heads[q] < queues[q].size() && CanStart(compiler, queues[q][heads[q]]))
+						ready.push_back(q);
+				}
+				if (ready.empty())
+					break;
+
+				const UInt32 q = ready[random.Range(0, static_cast<UInt32>(ready.size()) - 1)];
+				Run(graph, queues[q][heads[q]++]);
+			}
+
+			for (UInt32 q = 0; q < queues.size(); ++q)
+			{
+				if (heads[q] != queues[q].size())
+					return false;
+			}
+			return true;
+		}
+
+		bool WasExecuted(UInt32 pass) const { return mExecuted[pass]; }
+		//! The writer of the content of the resource the pass saw, in the order of its reads.
+		const vector<UInt32>& GetSeenContents(UInt32 pass) const { return mSeenContents[pass]; }
+		UInt32 GetContent(UInt32 resource) const { return mContents[resource]; }
+	private:
+		bool CanStart(const RenderGraphCompiler& compiler, UInt32 pass) const
+		{
+			for (auto wait : compiler.GetCrossQueueWaits(pass))
+			{
+				if (!mExecuted[wait])
+					return false;
+			}
+			return true;
+		}
+
+		void Run(const MockGraph& graph, UInt32 pass)
+		{
+			for (auto resource : graph.passes[pass].reads)
+				mSeenContents[pass].push_back(mContents[resource]);
+			for (auto resource : graph.passes[pass].writes)
+				mContents[resource] = pass;
+			mExecuted[pass] = true;
+		}
+	private:
+		vector<UInt32>         mContents;
+		vector<vector<UInt32>> mSeenContents;
+		vector<bool>           mExecuted;
+	};
+
+	//! Every executed pass saw the content it was declared after, and the outputs hold the content of their last enabled writers.
+	bool _CheckContents(const MockGraph& graph, const MockDevice& device)
+	{
+		for (UInt32 pass = 0; pass < graph.passes.size(); ++pass)
+		{
+			if (!device.WasExecuted(pass))
+				continue;
+
+			const auto& reads = graph.passes[pass].reads;
+			for (UInt32 i = 0; i < reads.size(); ++i)
+			{
+				if (device.GetSeenContents(pass)[i] != graph.GetExpectedWriter(reads[i], pass))
+					return false;
+			}
+		}
+
+		const UInt32 numPass = static_cast<UInt32>(graph.passes.size());
+		for (UInt32 resource = 0; resource < graph.outputs.size(); ++resource)
+		{
+			if (graph.outputs[resource] && device.GetContent(resource) != graph.GetExpectedWriter(resource, numPass))
+				return false;
+		}
+		return true;
+	}
+
+	//! The deferred frame of the renderer: shadow, gbuffer, composite, debug draw and the final pass to the swapchain.
+	struct DeferredFrame
+	{
+		MockGraph graph;
+		UInt32 shadowMap, gbuffer, depth, hdrColor, swapchain;
+		UInt32 shadowPass, gbufferPass, compositePass, debugPass, finalPass;
+
+		explicit DeferredFrame(bool bDebugDraw)
+		{
+			shadowMap = graph.AddResource();
+			gbuffer = graph.AddResource();
+			depth = graph.AddResource();
+			hdrColor = graph.AddResource();
+			swapchain = graph.AddResource(true);
+
+			shadowPass = graph.AddPass();
+			graph.passes[shadowPass].writes = { shadowMap };
+			gbufferPass = graph.AddPass();
+			graph.passes[gbufferPass].writes = { gbuffer, depth };
+			compositePass = graph.AddPass();
+			graph.passes[compositePass].reads = { shadowMap, gbuffer };
+			graph.passes[compositePass].writes = { hdrColor };
+			// loads the color and the depth to draw on top of them
+			debugPass = graph.AddPass(EQueueType::eGraphic, bDebugDraw);
+			graph.passes[debugPass].reads = { hdrColor, depth };
+			graph.passes[debugPass].writes = { hdrColor, depth };
+			finalPass = graph.AddPass();
+			graph.passes[finalPass].reads = { hdrColor };
+			graph.passes[finalPass].writes = { swapchain };
+		}
+	};
+
+}
+
+SG_TEST(RenderGraphCompiler, DeferredFrameIsSortedByLevels)
+{
+	DeferredFrame frame(true);
+	RenderGraphCompiler compiler;
+	frame.graph.Compile(compiler);
+
+	// the shadow and the gbuffer passes do not depend on each other
+	SG_CHECK(compiler.GetPassLevel(frame.shadowPass) == 0);
+	SG_CHECK(compiler.GetPassLevel(frame.gbufferPass) == 0);
+	SG_CHECK(compiler.GetPassLevel(frame.compositePass) == 1);
+	SG_CHECK(compiler.GetPassLevel(frame.debugPass) == 2);
+	SG_CHECK(compiler.GetPassLevel(frame.finalPass) == 3);
+
+	const auto& order = compiler.GetExecutionOrder();
+	SG_REQUIRE(order.size() == 5);
+	for (UInt32 i = 0; i < order.size(); ++i)
+	{
+		SG_CHECK(order[i] == i);
+		SG_CHECK(!compiler.IsPassCulled(order[i]));
+	}
+
+	// only written before it is read in the frame
+	SG_CHECK(compiler.IsResourceTransient(frame.gbuffer));
+	SG_CHECK(!compiler.IsResourceTransient(frame.swapchain));
+	UInt32 first = 0, last = 0;
+	SG_REQUIRE(compiler.GetResourceLifetime(frame.gbuffer, first, last));
+	SG_CHECK(first == 1 && last == 2);
+	SG_REQUIRE(compiler.GetResourceLifetime(frame.depth, first, last));
+	SG_CHECK(first == 1 && last == 3);
+
+	MockDevice device;
+	Random random(1);
+	SG_CHECK(device.Execute(frame.graph, compiler, random));
+	SG_CHECK(_CheckContents(frame.graph, device));
+	SG_CHECK(device.GetContent(frame.swapchain) == frame.finalPass);
+}
+
+SG_TEST(RenderGraphCompiler, DeclarationOrderIsNotTheExecutionOrder)
+{
+	// the passes of the second chain only depend on the first pass, they are sorted before the end of the first chain
+	MockGraph graph;
+	const UInt32 a = graph.AddResource(), b = graph.AddResource(), c = graph.AddResource(), output = graph.AddResource(true);
+	const UInt32 p0 = graph.AddPass();
+	graph.passes[p0].writes = { a };
+	const UInt32 p1 = graph.AddPass();
+	graph.passes[p1].reads = { a };
+	graph.passes[p1].writes = { b };
+	const UInt32 p2 = graph.AddPass();
+	graph.passes[p2].reads = { b };
+	graph.passes[p2].writes = { b };
+	const UInt32 p3 = graph.AddPass();
+	graph.passes[p3].reads = { a };
+	graph.passes[p3].writes = { c };
+	const UInt32 p4 = graph.AddPass();
+	graph.passes[p4].reads = { b, c };
+	graph.passes[p4].writes = { output };
+	// overwrites a after p1 and p3 read it, and draws on top of the output
+	const UInt32 p5 = graph.AddPass();
+	graph.passes[p5].reads = { output };
+	graph.passes[p5].writes = { a, output };
+
+	RenderGraphCompiler compiler;
+	graph.Compile(compiler);
+
+	const auto& order = compiler.GetExecutionOrder();
+	const UInt32 expected[] = { p0, p1, p3, p2, p4, p5 };
+	SG_REQUIRE(order.size() == sizeof(expected) / sizeof(expected[0]));
+	for (UInt32 i = 0; i < order.size(); ++i)
+		SG_CHECK(order[i] == expected[i]);
+	SG_CHECK(compiler.GetPassLevel(p1) == compiler.GetPassLevel(p3));
+	for (auto pass : order)
+		SG_CHECK(!compiler.IsPassCulled(pass));
+
+	MockDevice device;
+	Random random(4);
+	SG_CHECK(device.Execute(graph, compiler, random));
+	SG_CHECK(_CheckContents(graph, device));
+}
+
+SG_TEST(RenderGraphCompiler, UnusedPassesAreCulled)
+{
+	// the debug draw off: the final pass reads the color of the composite pass directly
+	DeferredFrame frame(false);
+	RenderGraphCompiler compiler;
+	frame.graph.Compile(compiler);
+	SG_CHECK(compiler.IsPassCulled(frame.debugPass));
+	SG_CHECK(!compiler.IsPassCulled(frame.shadowPass));
+	SG_CHECK(!compiler.IsPassCulled(frame.gbufferPass));
+	SG_CHECK(!compiler.IsPassCulled(frame.compositePass));
+	SG_CHECK(!compiler.IsPassCulled(frame.finalPass));
+	// the disabled pass is still sorted, enabling it again does not move the others
+	SG_CHECK(compiler.GetExecutionOrder().size() == 5);
+	SG_CHECK(compiler.GetPassLevel(frame.finalPass) == 3);
+
+	MockDevice device;
+	Random random(2);
+	SG_CHECK(device.Execute(frame.graph, compiler, random));
+	SG_CHECK(!device.WasExecuted(frame.debugPass));
+	SG_CHECK(_CheckContents(frame.graph, device));
+
+	// a pass whose result is never read, and the pass which only feeds it
+	MockGraph graph;
+	const UInt32 color = graph.AddResource(true), unused = graph.AddResource(), temp = graph.AddResource();
+	const UInt32 draw = graph.AddPass();
+	graph.passes[draw].writes = { color };
+	const UInt32 producer = graph.AddPass(EQueueType::eCompute);
+	graph.passes[producer].writes = { temp };
+	const UInt32 consumer = graph.AddPass();
+	graph.passes[consumer].reads = { temp, color };
+	graph.passes[consumer].writes = { unused };
+	graph.Compile(compiler, true);
+	SG_CHECK(!compiler.IsPassCulled(draw));
+	SG_CHECK(compiler.IsPassCulled(producer));
+	SG_CHECK(compiler.IsPassCulled(consumer));
+	// nothing to wait for on the compute queue
+	SG_CHECK(compiler.GetCrossQueueWaits(draw).empty());
+
+	// no output at all, everything is culled
+	graph.outputs[color] = false;
+	graph.Compile(compiler);
+	for (UInt32 pass = 0; pass < graph.passes.size(); ++pass)
+		SG_CHECK(compiler.IsPassCulled(pass));
+}
+
+SG_TEST(RenderGraphCompiler, ComputePassesAreAssignedToTheQueues)
+{
+	// a compute pass builds a light list the composite pass reads while the gbuffer is drawn,
+	// then the list of the transparent objects is built in the same buffer for the last pass.
+	MockGraph graph;
+	const UInt32 lightList = graph.AddResource(), gbuffer = graph.AddResource(), color = graph.AddResource(), swapchain = graph.AddResource(true);
+	const UInt32 cullLights = graph.AddPass(EQueueType::eCompute);
+	graph.passes[cullLights].writes = { lightList };
+	const UInt32 gbufferPass = graph.AddPass();
+	graph.passes[gbufferPass].writes = { gbuffer };
+	const UInt32 composite = graph.AddPass();
+	graph.passes[composite].reads = { lightList, gbuffer };
+	graph.passes[composite].writes = { color };
+	const UInt32 cullLightsAgain = graph.AddPass(EQueueType::eCompute);
+	graph.passes[cullLightsAgain].writes = { lightList };
+	const UInt32 transparent = graph.AddPass();
+	graph.passes[transparent].reads = { color, lightList };
+	graph.passes[transparent].writes = { swapchain };
+
+	RenderGraphCompiler compiler;
+	graph.Compile(compiler, true);
+	SG_CHECK(compiler.GetPassQueue(cullLights) == EQueueType::eCompute);
+	SG_CHECK(compiler.GetPassQueue(gbufferPass) == EQueueType::eGraphic);
+	SG_CHECK(compiler.GetPassQueue(composite) == EQueueType::eGraphic);
+	SG_CHECK(compiler.GetPassQueue(cullLightsAgain) == EQueueType::eCompute);
+	SG_CHECK(compiler.GetPassQueue(transparent) == EQueueType::eGraphic);
+	for (UInt32 pass = 0; pass < graph.passes.size(); ++pass)
+		SG_CHECK(!compiler.IsPassCulled(pass));
+
+	// read after write from the compute queue, write after read from the graphic queue
+	SG_REQUIRE(compiler.GetCrossQueueWaits(composite).size() == 1);
+	SG_CHECK(compiler.GetCrossQueueWaits(composite)[0] == cullLights);
+	SG_REQUIRE(compiler.GetCrossQueueWaits(cullLightsAgain).size() == 1);
+	SG_CHECK(compiler.GetCrossQueueWaits(cullLightsAgain)[0] == composite);
+	SG_REQUIRE(compiler.GetCrossQueueWaits(transparent).size() == 1);
+	SG_CHECK(compiler.GetCrossQueueWaits(transparent)[0] == cullLightsAgain);
+	SG_CHECK(compiler.GetCrossQueueWaits(cullLights).empty());
+	SG_CHECK(compiler.GetCrossQueueWaits(gbufferPass).empty());
+
+	MockDevice device;
+	Random random(3);
+	for (UInt32 i = 0; i < 64; ++i)
+	{
+		SG_CHECK(device.Execute(graph, compiler, random));
+		SG_CHECK(_CheckContents(graph, device));
+	}
+
+	// without the async compute everything goes to the graphic queue
+	graph.Compile(compiler, false);
+	for (UInt32 pass = 0; pass < graph.passes.size(); ++pass)
+	{
+		SG_CHECK(compiler.GetPassQueue(pass) == EQueueType::eGraphic);
+		SG_CHECK(compiler.GetCrossQueueWaits(pass).empty());
+	}
+}
+
+SG_TEST(RenderGraphCompiler, RandomGraphsRunCorrectlyOnTheMockDevice)
+{
+	enum { NUM_GRAPHS = 5000, NUM_RUNS = 4 };
+
+	Random random(2024);
+	RenderGraphCompiler compiler;
+	MockDevice device;
+	UInt32 numBadOrder = 0;
+	UInt32 numBadCull = 0;
+	UInt32 numDeadlock = 0;
+	UInt32 numBadContent = 0;
+	for (UInt32 i = 0; i < NUM_GRAPHS; ++i)
+	{
+		MockGraph graph;
+		const UInt32 numResource = random.Range(1, 6);
+		const UInt32 numPass = random.Range(1, 8);
+		for (UInt32 r = 0; r < numResource; ++r)
+			graph.AddResource(random.Range(0, 3) == 0);
+		for (UInt32 p = 0; p < numPass; ++p)
+		{
+			// one draw per statement, the order of the arguments of a call is up to the compiler.
+			const EQueueType queue = random.Range(0, 2) == 0 ? EQueueType::eCompute : EQueueType::eGraphic;
+			const bool bEnabled = random.Range(0, 4) != 0;
+			graph.AddPass(queue, bEnabled);
+			for (UInt32 r = 0; r < numResource; ++r)
+			{
+				const UInt32 access = random.Range(0, 4); // 0: read, 1: write, 2: read and write, others: none
+				if (access == 0 || access == 2)
+					graph.passes[p].reads.push_back(r);
+				if (access == 1 || access == 2)
+					graph.passes[p].writes.push_back(r);
+			}
+		}
+		graph.Compile(compiler, random.Range(0, 1) == 0);
+
+		// every two passes using the same resource, one of them writing it, keep the declaration order
+		vector<UInt32> positions(numPass);
+		for (UInt32 position = 0; position < numPass; ++position)
+			positions[compiler.GetExecutionOrder()[position]] = position;
+		for (UInt32 a = 0; a < numPass; ++a)
+		{
+			for (UInt32 b = a + 1; b < numPass; ++b)
+			{
+				bool bConflict = false;
+				for (auto resource : graph.passes[a].writes)
+					bConflict |= MockGraph::Contains(graph.passes[b].reads, resource) || MockGraph::Contains(graph.passes[b].writes, resource);
+				for (auto resource : graph.passes[a].reads)
+					bConflict |= MockGraph::Contains(graph.passes[b].writes, resource);
+				if (bConflict && positions[a] > positions[b])
+					++numBadOrder;
+			}
+		}
+
+		for (UInt32 p = 0; p < numPass; ++p)
+		{
+			if (!graph.passes[p].bEnabled && !compiler.IsPassCulled(p))
+				++numBadCull;
+		}
+
+		for (UInt32 run = 0; run < NUM_RUNS; ++run)
+		{
+			if (!device.Execute(graph, compiler, random))
+				++numDeadlock;
+			else if (!_CheckContents(graph, device))
+				++numBadContent;
+		}
+	}
+
+	SG_CHECK(numBadOrder == 0);
+	SG_CHECK(numBadCull == 0);
+	SG_CHECK(numDeadlock == 0);
+	SG_CHECK(numBadContent == 0);
+}
@@ -0,0 +1,154 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Archive/SceneBinary.h"
+
+#include "Stl/vector.h"
+#include "Stl/string.h"
+#include <stdio.h>
+#include <filesystem>
+
+using namespace SG;
+
+namespace
+{
+
+	bool _ReadWholeFile(const std::filesystem::path& path, std::string& outContent)
+	{
+		FILE* pFile = fopen(path.string().c_str(), "rb");
+		if (!pFile)
+			return false;
+		fseek(pFile, 0, SEEK_END);
+		outContent.resize((Size)ftell(pFile));
+		fseek(pFile, 0, SEEK_SET);
+		const Size numRead = fread(outContent.data(), 1, outContent.size(), pFile);
+		fclose(pFile);
+		return numRead == outContent.size();
+	}
+
+	//! The scene json files in Resources/Scene.
+	std::vector<std::filesystem::path> _GetSceneFiles()
+	{
+		std::vector<std::filesystem::path> files;
+		const std::filesystem::path folder = std::filesystem::path(Test::GetRootPath()) / "Resources" / "Scene";
+		for (auto& entry : std::filesystem::directory_iterator(folder))
+		{
+			if (entry.is_regular_file() && entry.path().extension() == ".scene")
+				files.push_back(entry.path());
+		}
+		return files;
+	}
+
+	//! The entity ids are not kept by the binary scene, they are regenerated when the scene is loaded.
+	void _RemoveEntityIDs(json& node)
+	{
+		if (node.is_object())
+		{
+			node.erase("EntityID");
+			for (auto& child : node)
+				_RemoveEntityIDs(child);
+		}
+		else if (node.is_array())
+		{
+			for (auto& child : node)
+				_RemoveEntityIDs(child);
+		}
+	}
+
+	bool _LoadSceneAsBinary(const std::filesystem::path& path, vector<Byte>& outData)
+	{
+		std::string content;
+		if (!_ReadWholeFile(path, content))
+			return false;
+		return SceneBinary::FromJson(json::parse(content), outData);
+	}
+
+}
+
+SG_TEST(SceneBinary, JsonRoundTripOfEveryScene)
+{
+	const auto files = _GetSceneFiles();
+	SG_REQUIRE(!files.empty());
+
+	for (auto& path : files)
+	{
+		std::string content;
+		SG_REQUIRE(_ReadWholeFile(path, content));
+		json original = json::parse(content);
+
+		vector<Byte> binary;
+		SG_CHECK(SceneBinary::FromJson(original, binary));
+		SceneBinaryView view;
+		SG_CHECK(view.Init(binary.data(), binary.size()));
+
+		json converted;
+		SG_CHECK(SceneBinary::ToJson(binary.data(), binary.size(), converted));
+
+		_RemoveEntityIDs(original);
+		_RemoveEntityIDs(converted);
+		const bool bSame = original == converted;
+		if (!bSame)
+			fprintf(stderr, "%s differs after the round trip: %s\n", path.filename().string().c_str(), json::diff(original, converted).dump().substr(0, 512).c_str());
+		SG_CHECK(bSame);
+
+		// and converting it back gives the same bytes
+		vector<Byte> binaryAgain;
+		SG_CHECK(SceneBinary::FromJson(converted, binaryAgain));
+		SG_CHECK(binaryAgain == binary);
+	}
+}
+
+SG_TEST(SceneBinary, TruncatedDataIsRejected)
+{
+	const auto files = _GetSceneFiles();
+	SG_REQUIRE(!files.empty());
+	vector<Byte> binary;
+	SG_REQUIRE(_LoadSceneAsBinary(files[0], binary));
+
+	Test::SilentLogScope silent;
+	SceneBinaryView view;
+	SG_CHECK(!view.Init(nullptr, 0));
+	UInt32 numAccepted = 0;
+	for (Size size = 0; size < binary.size(); ++size)
+	{
+		// copy, so that the sanitizers see a read past the end of the truncated data
+		vector<Byte> truncated(binary.begin(), binary.begin() + size);
+		if (view.Init(truncated.data(), truncated.size()))
+			++numAccepted;
+	}
+	SG_CHECK(numAccepted == 0);
+
+	// a trailing garbage byte is not accepted either
+	vector<Byte> extended = binary;
+	extended.push_back(Byte(0));
+	SG_CHECK(!view.Init(extended.data(), extended.size()));
+}
+
+SG_TEST(SceneBinary, BitFlippedDataIsRejected)
+{
+	Test::SilentLogScope silent;
+	for (auto& path : _GetSceneFiles())
+	{
+		vector<Byte> binary;
+		SG_REQUIRE(_LoadSceneAsBinary(path, binary));
+
+		// every single bit flip of the header, the entities and the first blocks,
+		// and a strided selection of the rest for the large scenes.
+		const Size numFullBytes = binary.size() < 4096 ? binary.size() : 4096;
+		const Size stride = binary.size() / 2048 + 1;
+		SceneBinaryView view;
+		UInt32 numAccepted = 0;
+		for (Size byte = 0; byte < binary.size(); byte += (byte < numFullBytes ? 1 : stride))
+		{
+			for (UInt32 bit = 0; bit < 8; ++bit)
+			{
+				binary[byte] ^= Byte(1 << bit);
+				if (view.Init(binary.data(), binary.size()))
+					++numAccepted;
+				binary[byte] ^= Byte(1 << bit);
+			}
+		}
+		SG_CHECK(numAccepted == 0);
+		SG_CHECK(view.Init(binary.data(), binary.size()));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Scene/SceneHierarchy.h"
+
+#include "Stl/vector.h"
+#include <EASTL/algorithm.h>
+#include <EASTL/sort.h>
+
+using namespace SG;
+
+namespace
+{
+
+	using NodeID = SceneHierarchy::NodeID;
+	using Entity = SceneHierarchy::Entity;
+
+	//! Deterministic random numbers, the failures must be reproducible.
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+	};
+
+	constexpr UInt32 MAX_NODES = 512;
+
+	//! What the test expects of a node, indexed by the slot of its entity.
+	struct NodeModel
+	{
+		bool   bAlive = false;
+		NodeID node = SceneHierarchy::INVALID_NODE;
+		UInt32 parentSlot = UInt32(-1); //! UInt32(-1) for the children of the root.
+		vector<UInt32> childSlots;      //! In the order they were added.
+		Vector3f translation = Vector3f(0.0f);
+		bool   bDirty = true;
+	};
+
+	//! The hierarchy only keeps the entity pointers, so the entities are slots of a fixed array.
+	struct HierarchyModel
+	{
+		vector<Entity>    entities = vector<Entity>(MAX_NODES);
+		vector<NodeModel> nodes = vector<NodeModel>(MAX_NODES);
+		vector<UInt32>    rootChildSlots;
+
+		UInt32 GetSlot(const Entity* pEntity) const { return UInt32(pEntity - entities.data()); }
+		NodeID GetNode(UInt32 slot) const { return slot == UInt32(-1) ? NodeID(SceneHierarchy::ROOT_NODE) : nodes[slot].node; }
+		vector<UInt32>& GetChildSlots(UInt32 parentSlot) { return parentSlot == UInt32(-1) ? rootChildSlots : nodes[parentSlot].childSlots; }
+
+		bool IsDescendant(UInt32 slot, UInt32 ancestorSlot) const
+		{
+			for (UInt32 curr = slot; curr != UInt32(-1); curr = nodes[curr].parentSlot)
+			{
+				if (curr == ancestorSlot)
+					return true;
+			}
+			return false;
+		}
+
+		//! The world translation, summed from the root in the same order as the matrices are multiplied.
+		Vector3f GetWorldTranslation(UInt32 slot) const
+		{
+			vector<UInt32> chain;
+			for (UInt32 curr = slot; curr != UInt32(-1); curr = nodes[curr].parentSlot)
+				chain.push_back(curr);
+			Vector3f translation(0.0f);
+			for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+				translation += nodes[*it].translation;
+			return translation;
+		}
+
+		void Remove(UInt32 slot, vector<UInt32>& outRemovedSlots)
+		{
+			auto& siblings = GetChildSlots(nodes[slot].parentSlot);
+			siblings.erase(eastl::find(siblings.begin(), siblings.end(), slot));
+
+			vector<UInt32> slotsToVisit = { slot };
+			while (!slotsToVisit.empty())
+			{
+				const UInt32 curr = slotsToVisit.back();
+				slotsToVisit.pop_back();
+				slotsToVisit.insert(slotsToVisit.end(), nodes[curr].childSlots.begin(), nodes[curr].childSlots.end());
+				outRemovedSlots.push_back(curr);
+				nodes[curr] = NodeModel();
+			}
+		}
+	};
+
+	Vector3f _RandomTranslation(Random& random)
+	{
+		// integers, so the sums are exact whatever the order.
+		// the braces draw the numbers from left to right, the order of the arguments of a call is up to the compiler.
+		return Vector3f{ float(random.Next() % 17) - 8.0f, float(random.Next() % 17) - 8.0f, float(random.Next() % 17) - 8.0f };
+	}
+
+	bool _CheckLinks(const SceneHierarchy& hierarchy, HierarchyModel& model)
+	{
+		UInt32 numAlive = 0;
+		for (UInt32 slot = 0; slot < MAX_NODES; ++slot)
+		{
+			const NodeModel& node = model.nodes[slot];
+			if (!node.bAlive)
+				continue;
+			++numAlive;
+			if (!hierarchy.IsValid(node.node) || hierarchy.GetEntity(node.node) != &model.entities[slot] ||
+				hierarchy.GetParent(node.node) != model.GetNode(node.parentSlot))
+				return false;
+		}
+		if (hierarchy.GetNodeCount() != numAlive)
+			return false;
+
+		// the children of every node, the root included, in the order they were added
+		for (UInt32 slot = 0; slot <= MAX_NODES; ++slot)
+		{
+			const UInt32 parentSlot = slot == MAX_NODES ? UInt32(-1) : slot;
+			if (parentSlot != UInt32(-1) && !model.nodes[parentSlot].bAlive)
+				continue;
+			vector<NodeID> expected;
+			for (auto childSlot : model.GetChildSlots(parentSlot))
+				expected.push_back(model.nodes[childSlot].node);
+			vector<NodeID> children;
+			hierarchy.TraverseChildren(model.GetNode(parentSlot), [&](NodeID child) { children.push_back(child); });
+			if (children != expected || hierarchy.HasChild(model.GetNode(parentSlot)) != !expected.empty())
+				return false;
+		}
+		return true;
+	}
+
+	//! Every node is visited once, after its parent.
+	bool _CheckTraverse(SceneHierarchy& hierarchy, HierarchyModel& model)
+	{
+		vector<UInt8> visited(MAX_NODES, 0);
+		bool bValid = true;
+		UInt32 numVisited = 0;
+		hierarchy.Traverse([&](NodeID node, Entity& entity)
+			{
+				const UInt32 slot = model.GetSlot(&entity);
+				const UInt32 parentSlot = model.nodes[slot].parentSlot;
+				bValid &= slot < MAX_NODES && model.nodes[slot].bAlive && model.nodes[slot].node == node && !visited[slot];
+				bValid &= parentSlot == UInt32(-1) || visited[parentSlot];
+				visited[slot] = 1;
+				++numVisited;
+			});
+		return bValid && numVisited == hierarchy.GetNodeCount();
+	}
+
+	bool _CheckWorldTransforms(SceneHierarchy& hierarchy, HierarchyModel& model)
+	{
+		hierarchy.UpdateWorldTransforms([&](Entity& entity, Matrix4f& localTransform, bool bForceUpdate)
+			{
+				NodeModel& node = model.nodes[model.GetSlot(&entity)];
+				if (!node.bDirty)
+					return false;
+				localTransform = glm::translate(Matrix4f(1.0f), node.translation);
+				node.bDirty = false;
+				return true;
+			});
+
+		for (UInt32 slot = 0; slot < MAX_NODES; ++slot)
+		{
+			if (model.nodes[slot].bAlive && Vector3f(hierarchy.GetWorldTransform(model.nodes[slot].node)[3]) != model.GetWorldTranslation(slot))
+				return false;
+		}
+		return true;
+	}
+
+}
+
+SG_TEST(SceneHierarchy, RandomEditsMatchTheModel)
+{
+	Random random(23);
+	SceneHierarchy hierarchy;
+	HierarchyModel model;
+
+	auto randomAliveSlot = [&]()
+	{
+		for (UInt32 i = 0; i < 4 * MAX_NODES; ++i)
+		{
+			const UInt32 slot = random.Next() % MAX_NODES;
+			if (model.nodes[slot].bAlive)
+				return slot;
+		}
+		return UInt32(-1);
+	};
+
+	for (UInt32 step = 0; step < 4000; ++step)
+	{
+		const UInt32 op = random.Next() % 100;
+		if (op < 45)
+		{
+			UInt32 slot = random.Next() % MAX_NODES;
+			if (model.nodes[slot].bAlive)
+				continue;
+			const UInt32 parentSlot = random.Next() % 4 == 0 ? UInt32(-1) : randomAliveSlot();
+
+			NodeModel& node = model.nodes[slot];
+			node.bAlive = true;
+			node.parentSlot = parentSlot;
+			node.translation = _RandomTranslation(random);
+			node.node = hierarchy.AddNode(&model.entities[slot], model.GetNode(parentSlot));
+			model.GetChildSlots(parentSlot).push_back(slot);
+		}
+		else if (op < 60)
+		{
+			const UInt32 slot = randomAliveSlot();
+			if (slot == UInt32(-1))
+				continue;
+			vector<Entity*> removed;
+			hierarchy.RemoveNode(model.nodes[slot].node, &removed);
+
+			vector<UInt32> expectedSlots;
+			model.Remove(slot, expectedSlots);
+			vector<UInt32> removedSlots;
+			for (auto* pEntity : removed)
+				removedSlots.push_back(model.GetSlot(pEntity));
+			eastl::sort(expectedSlots.begin(), expectedSlots.end());
+			eastl::sort(removedSlots.begin(), removedSlots.end());
+			SG_REQUIRE(removedSlots == expectedSlots);
+		}
+		else if (op < 85)
+		{
+			const UInt32 slot = randomAliveSlot();
+			if (slot == UInt32(-1))
+				continue;
+			const UInt32 newParentSlot = random.Next() % 5 == 0 ? UInt32(-1) : randomAliveSlot();
+			const bool bExpected = newParentSlot == UInt32(-1) || !model.IsDescendant(newParentSlot, slot);
+			SG_REQUIRE(hierarchy.Reparent(model.nodes[slot].node, model.GetNode(newParentSlot)) == bExpected);
+			// a node which is already under the new parent keeps its place among the children
+			if (bExpected && newParentSlot != model.nodes[slot].parentSlot)
+			{
+				auto& siblings = model.GetChildSlots(model.nodes[slot].parentSlot);
+				siblings.erase(eastl::find(siblings.begin(), siblings.end(), slot));
+				model.GetChildSlots(newParentSlot).push_back(slot);
+				model.nodes[slot].parentSlot = newParentSlot;
+			}
+		}
+		else if (op < 97)
+		{
+			const UInt32 slot = randomAliveSlot();
+			if (slot == UInt32(-1))
+				continue;
+			model.nodes[slot].translation = _RandomTranslation(random);
+			model.nodes[slot].bDirty = true;
+		}
+		else
+		{
+			hierarchy.Compact();
+		}
+
+		SG_REQUIRE(_CheckLinks(hierarchy, model));
+		if (step % 8 == 0)
+		{
+			SG_REQUIRE(_CheckTraverse(hierarchy, model));
+			SG_REQUIRE(_CheckWorldTransforms(hierarchy, model));
+		}
+	}
+	SG_CHECK(hierarchy.GetNodeCount() > 32);
+}
+
+SG_TEST(SceneHierarchy, ReparentMovesTheWholeSubtree)
+{
+	SceneHierarchy hierarchy;
+	HierarchyModel model;
+	auto add = [&](UInt32 slot, UInt32 parentSlot, const Vector3f& translation)
+	{
+		NodeModel& node = model.nodes[slot];
+		node.bAlive = true;
+		node.parentSlot = parentSlot;
+		node.translation = translation;
+		node.node = hierarchy.AddNode(&model.entities[slot], model.GetNode(parentSlot));
+		model.GetChildSlots(parentSlot).push_back(slot);
+	};
+
+	// 0 -> 1 -> 2, and 3 which is added after all of them
+	add(0, UInt32(-1), Vector3f(1.0f, 0.0f, 0.0f));
+	add(1, 0, Vector3f(0.0f, 2.0f, 0.0f));
+	add(2, 1, Vector3f(0.0f, 0.0f, 3.0f));
+	add(3, UInt32(-1), Vector3f(10.0f, 0.0f, 0.0f));
+	SG_REQUIRE(_CheckWorldTransforms(hierarchy, model));
+	SG_CHECK(Vector3f(hierarchy.GetWorldTransform(model.nodes[2].node)[3]) == Vector3f(1.0f, 2.0f, 3.0f));
+
+	// a node can not go under itself or its descendants
+	SG_CHECK(!hierarchy.Reparent(model.nodes[0].node, model.nodes[0].node));
+	SG_CHECK(!hierarchy.Reparent(model.nodes[0].node, model.nodes[2].node));
+
+	// the subtree goes under a node stored after it, the world transforms follow with no local change
+	SG_REQUIRE(hierarchy.Reparent(model.nodes[1].node, model.nodes[3].node));
+	model.nodes[0].childSlots.clear();
+	model.nodes[3].childSlots.push_back(1);
+	model.nodes[1].parentSlot = 3;
+	SG_CHECK(_CheckLinks(hierarchy, model));
+	SG_CHECK(_CheckTraverse(hierarchy, model));
+	SG_REQUIRE(_CheckWorldTransforms(hierarchy, model));
+	SG_CHECK(Vector3f(hierarchy.GetWorldTransform(model.nodes[2].node)[3]) == Vector3f(10.0f, 2.0f, 3.0f));
+
+	// the ids stay the same after the compaction
+	hierarchy.Compact();
+	SG_CHECK(_CheckLinks(hierarchy, model));
+	SG_CHECK(_CheckTraverse(hierarchy, model));
+}
\ No newline at end of file
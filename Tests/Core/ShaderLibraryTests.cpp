@@ -0,0 +1,303 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+#include "Common/FileSystemTestScope.h"
+
+#include "Render/Shader/ShaderLibrary.h"
+
+#include "Stl/vector.h"
+#include "Stl/string.h"
+#include <stdio.h>
+#include <filesystem>
+
+namespace SG
+{
+
+	//! One run of the engine: the shader library reads the database at the beginning and writes it at the end.
+	class ShaderLibraryTestScope
+	{
+	public:
+		ShaderLibraryTestScope() { mLibrary.OnInit(); }
+		~ShaderLibraryTestScope() { mLibrary.OnShutdown(); }
+
+		ShaderLibrary* operator->() { return &mLibrary; }
+	private:
+		ShaderLibrary mLibrary;
+	};
+
+}
+
+using namespace SG;
+
+namespace
+{
+
+	//! Run the test case in an empty folder, the shader sources and the database are written in it.
+	class ShaderSandbox
+	{
+	public:
+		ShaderSandbox()
+			:mPrevWorkingPath(std::filesystem::current_path())
+		{
+			mRootPath = std::filesystem::temp_directory_path() / "sg_shader_library_tests";
+			std::filesystem::remove_all(mRootPath);
+			// the sources are read SG_ENGINE_DEBUG_BASE_OFFSET folders above the working folder in the debug build
+			const std::filesystem::path workingPath = mRootPath / "bin" / "config" / "project";
+			std::filesystem::create_directories(workingPath);
+			std::filesystem::current_path(workingPath);
+		}
+
+		~ShaderSandbox()
+		{
+			std::filesystem::current_path(mPrevWorkingPath);
+			std::filesystem::remove_all(mRootPath);
+		}
+
+		void WriteSource(const char* name, const char* content)
+		{
+			const std::filesystem::path path = std::filesystem::path(_GetSourcePath().c_str()) / name;
+			std::filesystem::create_directories(path.parent_path());
+			_WriteFile(path, content, strlen(content));
+		}
+
+		std::string ReadDatabase()
+		{
+			std::string content;
+			FILE* pFile = fopen(_GetDatabasePath().string().c_str(), "rb");
+			if (!pFile)
+				return content;
+			fseek(pFile, 0, SEEK_END);
+			content.resize((Size)ftell(pFile));
+			fseek(pFile, 0, SEEK_SET);
+			if (fread(content.data(), 1, content.size(), pFile) != content.size())
+				content.clear();
+			fclose(pFile);
+			return content;
+		}
+
+		void WriteDatabase(const std::string& content)
+		{
+			_WriteFile(_GetDatabasePath(), content.data(), content.size());
+		}
+	private:
+		string _GetSourcePath() const { return FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Sources, SG_ENGINE_DEBUG_BASE_OFFSET); }
+
+		std::filesystem::path _GetDatabasePath() const
+		{
+			return std::filesystem::path(FileSystem::GetResourceFolderPath(EResourceDirectory::eShader_Binarires).c_str()) / SG_SHADER_CACHE_FILE_NAME;
+		}
+
+		void _WriteFile(const std::filesystem::path& path, const void* pData, Size size)
+		{
+			FILE* pFile = fopen(path.string().c_str(), "wb");
+			if (!pFile)
+				return;
+			fwrite(pData, 1, size, pFile);
+			fclose(pFile);
+		}
+	private:
+		FileSystemTestScope   mFileSystem;
+		std::filesystem::path mPrevWorkingPath;
+		std::filesystem::path mRootPath;
+	};
+
+	//! An include cycle, the includes in the comments, an include relative to the source and a missing include.
+	void _WriteShaderSources(ShaderSandbox& sandbox)
+	{
+		sandbox.WriteSource("common/light.glsl", "float light;\n#include \"math.glsl\"\n");
+		sandbox.WriteSource("common/math.glsl", "#include \"light.glsl\"\nfloat pi;\n");
+		sandbox.WriteSource("deferred/a.frag",
+			"#version 450\n"
+			"// #include \"commented.glsl\"\n"
+			"/* #include \"commented_block.glsl\"\n"
+			"   #include \"commented_block2.glsl\" */ #include \"local.glsl\"\n"
+			"  #  include <common/light.glsl>\n"
+			"void main() {}\n");
+		sandbox.WriteSource("deferred/local.glsl", "int local;\n");
+		sandbox.WriteSource("b.vert", "#include \"common/math.glsl\"\n#include \"missing.glsl\"\n");
+	}
+
+	bool _IsSameSources(const vector<string>& sources, std::initializer_list<const char*> expected)
+	{
+		if (sources.size() != expected.size())
+			return false;
+		Size i = 0;
+		for (const char* name : expected)
+		{
+			if (sources[i++] != name)
+				return false;
+		}
+		return true;
+	}
+
+	bool _IsBlobKeptOrLost(bool bFound, const vector<Byte>& blob, const vector<Byte>& original)
+	{
+		return !bFound || blob == original;
+	}
+
+}
+
+SG_TEST(ShaderLibrary, IncludesAreFollowedOnceInTheWrittenOrder)
+{
+	ShaderSandbox sandbox;
+	_WriteShaderSources(sandbox);
+
+	ShaderLibraryTestScope library;
+	const UInt64 hashA = library->HashSourceWithIncludes("deferred/a.frag");
+	const UInt64 hashB = library->HashSourceWithIncludes("b.vert");
+	SG_CHECK(hashA != 0);
+	SG_CHECK(hashB != 0);
+	SG_CHECK(hashA != hashB);
+	SG_CHECK(library->HashSourceWithIncludes("./deferred/../deferred/a.frag") == hashA);
+	SG_CHECK(library->HashSourceWithIncludes("nothere.frag") == 0);
+
+	// nothing was read before, so every source is a changed one
+	vector<string> sources;
+	library->GetChangedSources("deferred/a.frag", sources);
+	SG_CHECK(_IsSameSources(sources, { "deferred/a.frag", "deferred/local.glsl", "common/light.glsl", "common/math.glsl" }));
+
+	sources.clear();
+	library->GetChangedSources("b.vert", sources);
+	SG_CHECK(_IsSameSources(sources, { "b.vert", "common/math.glsl", "common/light.glsl", "missing.glsl" }));
+}
+
+SG_TEST(ShaderLibrary, EditedIncludeChangesOnlyItsDependents)
+{
+	ShaderSandbox sandbox;
+	_WriteShaderSources(sandbox);
+
+	UInt64 hashA = 0;
+	UInt64 hashB = 0;
+	{
+		ShaderLibraryTestScope library;
+		hashA = library->HashSourceWithIncludes("deferred/a.frag");
+		hashB = library->HashSourceWithIncludes("b.vert");
+	}
+
+	sandbox.WriteSource("deferred/local.glsl", "int local2;\n");
+	{
+		ShaderLibraryTestScope library;
+		SG_CHECK(library->HashSourceWithIncludes("deferred/a.frag") != hashA);
+		SG_CHECK(library->HashSourceWithIncludes("b.vert") == hashB);
+
+		vector<string> sources;
+		library->GetChangedSources("deferred/a.frag", sources);
+		SG_CHECK(_IsSameSources(sources, { "deferred/local.glsl" }));
+		// the missing include is never known to be the same
+		sources.clear();
+		library->GetChangedSources("b.vert", sources);
+		SG_CHECK(_IsSameSources(sources, { "missing.glsl" }));
+	}
+
+	// written again with the same content, only the time stamp changes
+	sandbox.WriteSource("b.vert", "#include \"common/math.glsl\"\n#include \"missing.glsl\"\n");
+	{
+		ShaderLibraryTestScope library;
+		SG_CHECK(library->HashSourceWithIncludes("b.vert") == hashB);
+		vector<string> sources;
+		library->GetChangedSources("b.vert", sources);
+		SG_CHECK(_IsSameSources(sources, { "missing.glsl" }));
+	}
+}
+
+SG_TEST(ShaderLibrary, BinariesAreKeptUntilUnusedForTooManyRuns)
+{
+	ShaderSandbox sandbox;
+	const vector<Byte> binary1(8, Byte(1));
+	const vector<Byte> binary2(12, Byte(2));
+	const vector<Byte> reflection(5, Byte(3));
+	{
+		ShaderLibraryTestScope library;
+		library->AddBinary(1, binary1);
+		library->AddBinary(2, binary2);
+		library->AddReflection(2, reflection);
+		Test::SilentLogScope silent;
+		library->AddBinary(3, vector<Byte>(3, Byte(3))); // not a SPIR-V
+	}
+
+	vector<Byte> blob;
+	{
+		ShaderLibraryTestScope library;
+		SG_CHECK(library->FindBinary(2, blob) && blob == binary2);
+		SG_CHECK(library->FindReflection(2, blob) && blob == reflection);
+		SG_CHECK(!library->FindReflection(1, blob));
+		SG_CHECK(!library->FindBinary(3, blob));
+	}
+	// the binary 1 was last used in the run 1, it is still there in the run 1 + SG_SHADER_CACHE_MAX_UNUSED_RUNS.
+	for (UInt32 run = 3; run < 1 + SG_SHADER_CACHE_MAX_UNUSED_RUNS; ++run)
+	{
+		ShaderLibraryTestScope library;
+		SG_CHECK(library->FindBinary(2, blob));
+	}
+	{
+		ShaderLibraryTestScope library;
+		SG_CHECK(library->FindBinary(1, blob) && blob == binary1);
+	}
+	// and now it is used in the run 1 + SG_SHADER_CACHE_MAX_UNUSED_RUNS.
+	for (UInt32 run = 0; run < SG_SHADER_CACHE_MAX_UNUSED_RUNS; ++run)
+	{
+		ShaderLibraryTestScope library;
+		SG_CHECK(library->FindBinary(2, blob));
+	}
+	{
+		ShaderLibraryTestScope library;
+		SG_CHECK(!library->FindBinary(1, blob));
+		SG_CHECK(library->FindBinary(2, blob) && blob == binary2);
+	}
+}
+
+SG_TEST(ShaderLibrary, DamagedDatabaseKeepsTheIntactEntries)
+{
+	ShaderSandbox sandbox;
+	_WriteShaderSources(sandbox);
+
+	const vector<Byte> binary1(8, Byte(1));
+	const vector<Byte> binary2(400, Byte(2));
+	const vector<Byte> reflection(5, Byte(3));
+	{
+		ShaderLibraryTestScope library;
+		library->HashSourceWithIncludes("deferred/a.frag");
+		library->AddBinary(1, binary1);
+		library->AddBinary(2, binary2);
+		library->AddReflection(1, reflection);
+	}
+	const std::string database = sandbox.ReadDatabase();
+	SG_REQUIRE(!database.empty());
+
+	Test::SilentLogScope silent;
+	UInt32 numBadEntries = 0;
+	UInt32 numIntactLoads = 0;
+	auto checkEntries = [&]()
+	{
+		ShaderLibraryTestScope library;
+		vector<Byte> blob1, blob2, blob3;
+		const bool bFound1 = library->FindBinary(1, blob1);
+		const bool bFound2 = library->FindBinary(2, blob2);
+		const bool bFound3 = library->FindReflection(1, blob3);
+		if (!_IsBlobKeptOrLost(bFound1, blob1, binary1) || !_IsBlobKeptOrLost(bFound2, blob2, binary2) || !_IsBlobKeptOrLost(bFound3, blob3, reflection))
+			++numBadEntries;
+		if (bFound1 && bFound2 && bFound3)
+			++numIntactLoads;
+	};
+
+	for (Size size = 0; size < database.size(); ++size)
+	{
+		sandbox.WriteDatabase(database.substr(0, size));
+		checkEntries();
+	}
+	SG_CHECK(numBadEntries == 0);
+	SG_CHECK(numIntactLoads == 0);
+
+	for (Size byte = 0; byte < database.size(); ++byte)
+	{
+		std::string flipped = database;
+		flipped[byte] ^= char(1 << (byte % 8));
+		sandbox.WriteDatabase(flipped);
+		checkEntries();
+	}
+	SG_CHECK(numBadEntries == 0);
+
+	sandbox.WriteDatabase(database);
+	numIntactLoads = 0;
+	checkEntries();
+	SG_CHECK(numIntactLoads == 1);
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Thread/Thread.h"
+
+using namespace SG;
+
+namespace
+{
+
+	struct SharedCounter
+	{
+		Mutex    mutex;
+		UInt64   value = 0; //!< Protected by the mutex, not atomic on purpose.
+		Atomic32 numTryLockSucceeded;
+		Atomic32 bHeld;
+		Atomic32 bRelease;
+	};
+
+	void _SpinUntil(Atomic32& flag)
+	{
+		while (flag.Add(0) == 0)
+			ThreadSleep(0);
+	}
+
+}
+
+SG_TEST(Thread, MutexIsRecursive)
+{
+	Mutex mutex;
+	mutex.Lock();
+	mutex.Lock();
+	SG_CHECK(mutex.TryLock());
+	mutex.UnLock();
+	mutex.UnLock();
+	mutex.UnLock();
+
+	// fully released, can be taken again
+	SG_CHECK(mutex.TryLock());
+	mutex.UnLock();
+}
+
+SG_TEST(Thread, MutexIsHeldUntilTheLastUnLock)
+{
+	SharedCounter shared;
+	shared.mutex.Lock();
+	shared.mutex.Lock();
+
+	Thread thread;
+	SG_REQUIRE(ThreadCreate(&thread, [](void* pUser)
+		{
+			SharedCounter* pShared = reinterpret_cast<SharedCounter*>(pUser);
+			if (pShared->mutex.TryLock())
+			{
+				pShared->numTryLockSucceeded.Increase();
+				pShared->mutex.UnLock();
+			}
+			pShared->bHeld.Exchange(1);
+
+			// blocks until the main thread releases the last recursion
+			pShared->mutex.Lock();
+			pShared->value = 42;
+			pShared->mutex.UnLock();
+		}, &shared));
+
+	_SpinUntil(shared.bHeld);
+	SG_CHECK(shared.numTryLockSucceeded.Add(0) == 0);
+
+	shared.mutex.UnLock();
+	ThreadSleep(10);
+	// still held once by the main thread
+	SG_CHECK(shared.value == 0);
+	shared.mutex.UnLock();
+
+	ThreadJoin(&thread);
+	ThreadRestore(&thread);
+	SG_CHECK(shared.value == 42);
+}
+
+SG_TEST(Thread, MutexUnderContention)
+{
+	enum { NUM_THREADS = 4, NUM_INCREMENTS = 20000 };
+
+	SharedCounter shared;
+	Thread threads[NUM_THREADS];
+	for (auto& thread : threads)
+	{
+		SG_REQUIRE(ThreadCreate(&thread, [](void* pUser)
+			{
+				SharedCounter* pShared = reinterpret_cast<SharedCounter*>(pUser);
+				for (UInt32 i = 0; i < NUM_INCREMENTS; ++i)
+				{
+					ScopeLock lock(pShared->mutex);
+					if (i % 2 == 0)
+					{
+						// re-enter on the same thread
+						ScopeLock innerLock(pShared->mutex);
+						++pShared->value;
+					}
+					else
+						++pShared->value;
+				}
+			}, &shared));
+	}
+	for (auto& thread : threads)
+	{
+		ThreadJoin(&thread);
+		ThreadRestore(&thread);
+	}
+	SG_CHECK(shared.value == (UInt64)NUM_THREADS * NUM_INCREMENTS);
+}
+
+SG_TEST(Thread, ConditionVariableWaitReleasesARecursiveLock)
+{
+	struct Context
+	{
+		Mutex             mutex;
+		ConditionVariable cv;
+		bool              bReady = false;
+		Atomic32          bWaiting;
+	} context;
+
+	Thread thread;
+	SG_REQUIRE(ThreadCreate(&thread, [](void* pUser)
+		{
+			Context* pContext = reinterpret_cast<Context*>(pUser);
+			_SpinUntil(pContext->bWaiting);
+			// only possible if the waiter released all its recursions
+			ScopeLock lock(pContext->mutex);
+			pContext->bReady = true;
+			pContext->cv.NotifyAll();
+		}, &context));
+
+	context.mutex.Lock();
+	context.mutex.Lock();
+	context.bWaiting.Exchange(1);
+	bool bTimeout = false;
+	while (!context.bReady && !bTimeout)
+		bTimeout = !context.cv.Wait(context.mutex, 5000);
+	SG_CHECK(!bTimeout);
+	SG_CHECK(context.bReady);
+
+	// the recursion is restored after the wait
+	context.mutex.UnLock();
+	SG_CHECK(context.mutex.TryLock());
+	context.mutex.UnLock();
+	context.mutex.UnLock();
+
+	ThreadJoin(&thread);
+	ThreadRestore(&thread);
+}
+SG_TEST(Thread, ThreadIdIsTheOneSeenInsideTheThread)
+{
+	struct Context
+	{
+		Atomic32 bRelease;
+		UInt32   innerId = 0;
+	} context;
+
+	Thread threads[4];
+	for (auto& thread : threads)
+	{
+		SG_REQUIRE(ThreadCreate(&thread, [](void* pUser)
+			{
+				Context* pContext = reinterpret_cast<Context*>(pUser);
+				_SpinUntil(pContext->bRelease);
+			}, &context));
+	}
+	// asked while the threads are still running
+	UInt32 ids[4] = {};
+	for (UInt32 i = 0; i < 4; ++i)
+	{
+		ids[i] = GetThreadID(&threads[i]);
+		SG_CHECK(ids[i] != 0);
+		SG_CHECK(ids[i] != GetCurrThreadID());
+		for (UInt32 j = 0; j < i; ++j)
+			SG_CHECK(ids[i] != ids[j]);
+	}
+	context.bRelease.Exchange(1);
+	for (auto& thread : threads)
+	{
+		ThreadJoin(&thread);
+		ThreadRestore(&thread);
+	}
+
+	Thread thread;
+	SG_REQUIRE(ThreadCreate(&thread, [](void* pUser)
+		{
+			reinterpret_cast<Context*>(pUser)->innerId = GetCurrThreadID();
+		}, &context));
+	ThreadJoin(&thread);
+	SG_CHECK(context.innerId != 0);
+	SG_CHECK(GetThreadID(&thread) == context.innerId);
+	ThreadRestore(&thread);
+}
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Backend/VulkanPipelineCache.h"
+
+#include "Stl/vector.h"
+#include <string.h>
+
+using namespace SG;
+
+namespace
+{
+
+	PipelineCacheDeviceInfo _GetDeviceInfo()
+	{
+		PipelineCacheDeviceInfo info = {};
+		info.vendorID = 0x10de;
+		info.deviceID = 0x2204;
+		info.driverVersion = 77;
+		for (UInt32 i = 0; i < VK_UUID_SIZE; ++i)
+			info.pipelineCacheUUID[i] = UInt8(i + 1);
+		return info;
+	}
+
+	//! The data the driver would give back by vkGetPipelineCacheData(), it begins with the VkPipelineCacheHeaderVersionOne of the device.
+	vector<Byte> _GetDriverData(const PipelineCacheDeviceInfo& info, UInt32 payloadSize)
+	{
+		struct
+		{
+			UInt32 headerSize;
+			UInt32 headerVersion;
+			UInt32 vendorID;
+			UInt32 deviceID;
+			UInt8  pipelineCacheUUID[VK_UUID_SIZE];
+		} header;
+		header.headerSize = sizeof(header);
+		header.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+		header.vendorID = info.vendorID;
+		header.deviceID = info.deviceID;
+		memcpy(header.pipelineCacheUUID, info.pipelineCacheUUID, VK_UUID_SIZE);
+
+		vector<Byte> data(sizeof(header) + payloadSize);
+		memcpy(data.data(), &header, sizeof(header));
+		for (UInt32 i = 0; i < payloadSize; ++i)
+			data[sizeof(header) + i] = Byte(i * 31 + 7);
+		return data;
+	}
+
+	vector<Byte> _GetBlob(const PipelineCacheDeviceInfo& info)
+	{
+		const vector<UInt64> keys = { 0x1111222233334444ull, 0x5555666677778888ull, 42 };
+		const vector<Byte> driverData = _GetDriverData(info, 61);
+		return VulkanPipelineCache::SerializeBlob(info, keys, driverData.data(), driverData.size());
+	}
+
+	bool _Validate(const PipelineCacheDeviceInfo& info, const vector<Byte>& blob)
+	{
+		const Byte* pDriverData = nullptr;
+		Size driverDataSize = 0;
+		const UInt64* pKeys = nullptr;
+		UInt32 numKeys = 0;
+		return VulkanPipelineCache::ValidateBlob(info, blob.data(), blob.size(), pDriverData, driverDataSize, pKeys, numKeys);
+	}
+
+	//! An opaque pipeline with a depth test, as the render graph nodes build them.
+	//! The structure types and the pointers are left to garbage on purpose, the key must not depend on them.
+	void _FillCreateInfo(VulkanPipeline::GraphicPipelineCreateInfo& CI, UInt8 garbage)
+	{
+		memset(&CI.vertexInputCI, garbage, sizeof(CI.vertexInputCI));
+		memset(&CI.inputAssemblyCI, garbage, sizeof(CI.inputAssemblyCI));
+		memset(&CI.rasterizeStateCI, garbage, sizeof(CI.rasterizeStateCI));
+		memset(&CI.colorBlendCI, garbage, sizeof(CI.colorBlendCI));
+		memset(&CI.viewportStateCI, garbage, sizeof(CI.viewportStateCI));
+		memset(&CI.depthStencilCI, garbage, sizeof(CI.depthStencilCI));
+		memset(&CI.multiSampleStateCI, garbage, sizeof(CI.multiSampleStateCI));
+		memset(&CI.dynamicStateCI, garbage, sizeof(CI.dynamicStateCI));
+
+		CI.vertexInputBindingDesc = { { 0, 32, VK_VERTEX_INPUT_RATE_VERTEX } };
+		CI.vertexInputAttributs = {
+			{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+			{ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, 12 },
+			{ 2, 0, VK_FORMAT_R32G32_SFLOAT, 24 },
+		};
+		CI.vertexInputCI.vertexBindingDescriptionCount = 1;
+		CI.vertexInputCI.pVertexBindingDescriptions = CI.vertexInputBindingDesc.data();
+		CI.vertexInputCI.vertexAttributeDescriptionCount = 3;
+		CI.vertexInputCI.pVertexAttributeDescriptions = CI.vertexInputAttributs.data();
+
+		CI.inputAssemblyCI.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		CI.inputAssemblyCI.primitiveRestartEnable = VK_FALSE;
+
+		CI.rasterizeStateCI.depthClampEnable = VK_FALSE;
+		CI.rasterizeStateCI.rasterizerDiscardEnable = VK_FALSE;
+		CI.rasterizeStateCI.polygonMode = VK_POLYGON_MODE_FILL;
+		CI.rasterizeStateCI.cullMode = VK_CULL_MODE_BACK_BIT;
+		CI.rasterizeStateCI.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		CI.rasterizeStateCI.depthBiasEnable = VK_FALSE;
+		CI.rasterizeStateCI.depthBiasConstantFactor = 0.0f;
+		CI.rasterizeStateCI.depthBiasClamp = 0.0f;
+		CI.rasterizeStateCI.depthBiasSlopeFactor = 0.0f;
+		CI.rasterizeStateCI.lineWidth = 1.0f;
+
+		VkPipelineColorBlendAttachmentState blend = {};
+		blend.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		CI.colorBlends = { blend };
+		CI.colorBlendCI.logicOpEnable = VK_FALSE;
+		CI.colorBlendCI.logicOp = VK_LOGIC_OP_COPY;
+		CI.colorBlendCI.attachmentCount = 1;
+		CI.colorBlendCI.pAttachments = CI.colorBlends.data();
+		for (auto& constant : CI.colorBlendCI.blendConstants)
+			constant = 0.0f;
+
+		CI.viewportStateCI.viewportCount = 1;
+		CI.viewportStateCI.scissorCount = 1;
+
+		CI.depthStencilCI.depthTestEnable = VK_TRUE;
+		CI.depthStencilCI.depthWriteEnable = VK_TRUE;
+		CI.depthStencilCI.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+		CI.depthStencilCI.depthBoundsTestEnable = VK_FALSE;
+		CI.depthStencilCI.stencilTestEnable = VK_FALSE;
+		CI.depthStencilCI.front = {};
+		CI.depthStencilCI.back = {};
+		CI.depthStencilCI.minDepthBounds = 0.0f;
+		CI.depthStencilCI.maxDepthBounds = 1.0f;
+
+		CI.multiSampleStateCI.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		CI.multiSampleStateCI.sampleShadingEnable = VK_FALSE;
+		CI.multiSampleStateCI.minSampleShading = 0.0f;
+		CI.multiSampleStateCI.alphaToCoverageEnable = VK_FALSE;
+		CI.multiSampleStateCI.alphaToOneEnable = VK_FALSE;
+
+		CI.dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		CI.dynamicStateCI.dynamicStateCount = 2;
+		CI.dynamicStateCI.pDynamicStates = CI.dynamicStates.data();
+	}
+
+	enum : UInt64
+	{
+		SHADER_HASH = 0x0123456789abcdefull,
+		LAYOUT_HASH = 0xfedcba9876543210ull,
+		RENDER_PASS_HASH = 0x00ff00ff00ff00ffull,
+	};
+
+	UInt64 _HashGraphic(const VulkanPipeline::GraphicPipelineCreateInfo& CI)
+	{
+		return VulkanPipelineCache::HashGraphicPipeline(CI, SHADER_HASH, LAYOUT_HASH, RENDER_PASS_HASH);
+	}
+
+}
+
+SG_TEST(PipelineCache, KeysAreStableAcrossRuns)
+{
+	VulkanPipeline::GraphicPipelineCreateInfo CI;
+	_FillCreateInfo(CI, 0xcd);
+	// the same states in other memory, with other garbage in the structure types and the pointers
+	auto* pOther = new VulkanPipeline::GraphicPipelineCreateInfo();
+	_FillCreateInfo(*pOther, 0x5a);
+	const UInt64 key = _HashGraphic(CI);
+	SG_CHECK(key == _HashGraphic(*pOther));
+	delete pOther;
+
+	// the keys are saved to the disk, a change of the hashing invalidates every pipeline cache file
+	SG_CHECK(key == 0x65670903c0a7f54bull);
+	SG_CHECK(VulkanPipelineCache::HashComputePipeline(SHADER_HASH, LAYOUT_HASH) == 0xde9ae67299b9c7caull);
+}
+
+SG_TEST(PipelineCache, KeysChangeWithTheStates)
+{
+	VulkanPipeline::GraphicPipelineCreateInfo CI;
+	_FillCreateInfo(CI, 0);
+	const UInt64 key = _HashGraphic(CI);
+
+	SG_CHECK(key != VulkanPipelineCache::HashGraphicPipeline(CI, SHADER_HASH + 1, LAYOUT_HASH, RENDER_PASS_HASH));
+	SG_CHECK(key != VulkanPipelineCache::HashGraphicPipeline(CI, SHADER_HASH, LAYOUT_HASH + 1, RENDER_PASS_HASH));
+	SG_CHECK(key != VulkanPipelineCache::HashGraphicPipeline(CI, SHADER_HASH, LAYOUT_HASH, RENDER_PASS_HASH + 1));
+	SG_CHECK(VulkanPipelineCache::HashComputePipeline(SHADER_HASH, LAYOUT_HASH) != VulkanPipelineCache::HashComputePipeline(SHADER_HASH, LAYOUT_HASH + 1));
+
+	auto ChangedKey = [](void (*change)(VulkanPipeline::GraphicPipelineCreateInfo&))
+	{
+		VulkanPipeline::GraphicPipelineCreateInfo CI;
+		_FillCreateInfo(CI, 0);
+		change(CI);
+		return _HashGraphic(CI);
+	};
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.vertexInputAttributs[1].offset = 16; }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.vertexInputAttributs.pop_back(); }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.vertexInputBindingDesc[0].stride = 36; }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.inputAssemblyCI.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST; }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.rasterizeStateCI.cullMode = VK_CULL_MODE_NONE; }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.rasterizeStateCI.depthBiasSlopeFactor = 1.75f; }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.colorBlends[0].blendEnable = VK_TRUE; }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.depthStencilCI.depthCompareOp = VK_COMPARE_OP_GREATER; }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.depthStencilCI.front.compareMask = 0xff; }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.multiSampleStateCI.rasterizationSamples = VK_SAMPLE_COUNT_4_BIT; }));
+	SG_CHECK(key != ChangedKey([](VulkanPipeline::GraphicPipelineCreateInfo& CI) { CI.dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_BIAS); }));
+}
+
+SG_TEST(PipelineCache, BlobRoundTrip)
+{
+	const auto info = _GetDeviceInfo();
+	const vector<UInt64> keys = { 3, 1, 2 };
+	const vector<Byte> driverData = _GetDriverData(info, 100);
+	const vector<Byte> blob = VulkanPipelineCache::SerializeBlob(info, keys, driverData.data(), driverData.size());
+
+	const Byte* pDriverData = nullptr;
+	Size driverDataSize = 0;
+	const UInt64* pKeys = nullptr;
+	UInt32 numKeys = 0;
+	SG_REQUIRE(VulkanPipelineCache::ValidateBlob(info, blob.data(), blob.size(), pDriverData, driverDataSize, pKeys, numKeys));
+	SG_REQUIRE(numKeys == keys.size());
+	for (UInt32 i = 0; i < numKeys; ++i)
+		SG_CHECK(pKeys[i] == keys[i]);
+	SG_REQUIRE(driverDataSize == driverData.size());
+	SG_CHECK(memcmp(pDriverData, driverData.data(), driverDataSize) == 0);
+
+	// a driver giving no data, and no pipeline built
+	const vector<Byte> emptyBlob = VulkanPipelineCache::SerializeBlob(info, {}, nullptr, 0);
+	SG_CHECK(VulkanPipelineCache::ValidateBlob(info, emptyBlob.data(), emptyBlob.size(), pDriverData, driverDataSize, pKeys, numKeys));
+	SG_CHECK(numKeys == 0 && driverDataSize == 0);
+}
+
+SG_TEST(PipelineCache, TruncatedBlobsAreRejected)
+{
+	const auto info = _GetDeviceInfo();
+	const vector<Byte> blob = _GetBlob(info);
+	SG_REQUIRE(_Validate(info, blob));
+
+	UInt32 numAccepted = 0;
+	for (Size size = 0; size < blob.size(); ++size)
+	{
+		// copy, so that the sanitizers see a read past the end of the truncated blob
+		const vector<Byte> truncated(blob.begin(), blob.begin() + size);
+		if (_Validate(info, truncated))
+			++numAccepted;
+	}
+	SG_CHECK(numAccepted == 0);
+
+	vector<Byte> extended = blob;
+	extended.push_back(Byte(0));
+	SG_CHECK(!_Validate(info, extended));
+}
+
+SG_TEST(PipelineCache, BitFlippedBlobsAreRejected)
+{
+	const auto info = _GetDeviceInfo();
+	vector<Byte> blob = _GetBlob(info);
+
+	UInt32 numAccepted = 0;
+	for (Size byte = 0; byte < blob.size(); ++byte)
+	{
+		for (UInt32 bit = 0; bit < 8; ++bit)
+		{
+			blob[byte] ^= Byte(1 << bit);
+			if (_Validate(info, blob))
+				++numAccepted;
+			blob[byte] ^= Byte(1 << bit);
+		}
+	}
+	SG_CHECK(numAccepted == 0);
+	SG_CHECK(_Validate(info, blob));
+}
+
+SG_TEST(PipelineCache, BlobsOfOtherDevicesAreRejected)
+{
+	const auto info = _GetDeviceInfo();
+	const vector<Byte> blob = _GetBlob(info);
+	SG_REQUIRE(_Validate(info, blob));
+
+	auto otherVendor = info;
+	otherVendor.vendorID = 0x1002;
+	SG_CHECK(!_Validate(otherVendor, blob));
+	auto otherDevice = info;
+	otherDevice.deviceID += 1;
+	SG_CHECK(!_Validate(otherDevice, blob));
+	auto otherDriver = info;
+	otherDriver.driverVersion += 1;
+	SG_CHECK(!_Validate(otherDriver, blob));
+	for (UInt32 i = 0; i < VK_UUID_SIZE; ++i)
+	{
+		auto otherUUID = info;
+		otherUUID.pipelineCacheUUID[i] ^= 0x80;
+		SG_CHECK(!_Validate(otherUUID, blob));
+	}
+
+	// the header of the file is right, but the driver data comes from another device
+	const vector<UInt64> keys = { 7 };
+	auto ValidateWithDriverDataOf = [&](const PipelineCacheDeviceInfo& driverInfo)
+	{
+		const vector<Byte> driverData = _GetDriverData(driverInfo, 16);
+		return _Validate(info, VulkanPipelineCache::SerializeBlob(info, keys, driverData.data(), driverData.size()));
+	};
+	SG_CHECK(ValidateWithDriverDataOf(info));
+	SG_CHECK(!ValidateWithDriverDataOf(otherVendor));
+	SG_CHECK(!ValidateWithDriverDataOf(otherDevice));
+	auto otherUUID = info;
+	otherUUID.pipelineCacheUUID[VK_UUID_SIZE - 1] = 0;
+	SG_CHECK(!ValidateWithDriverDataOf(otherUUID));
+
+	// driver data too short to hold its own header
+	const Byte shortDriverData[8] = {};
+	SG_CHECK(!_Validate(info, VulkanPipelineCache::SerializeBlob(info, keys, shortDriverData, sizeof(shortDriverData))));
+}
@@ -0,0 +1,179 @@
+#include "StdAfx.h"
+#include "Common/TestFramework.h"
+
+#include "Resource/ResourceTable.h"
+
+#include "Stl/vector.h"
+#include "Stl/string.h"
+
+using namespace SG;
+
+namespace
+{
+
+	//! Deterministic random numbers, the failures must be reproducible.
+	struct Random
+	{
+		UInt32 state;
+
+		explicit Random(UInt32 seed) : state(seed) {}
+
+		UInt32 Next()
+		{
+			state = state * 1664525u + 1013904223u;
+			return state >> 8;
+		}
+
+		UInt32 Range(UInt32 min, UInt32 max) { return min + Next() % (max - min + 1); }
+	};
+
+	//! The table never touches the resources, any type will do.
+	struct FakeResource
+	{
+		UInt32 value = 0;
+	};
+
+	using FakeTable = ResourceTable<FakeResource>;
+
+	struct Entry
+	{
+		FakeTable::HandleType handle;
+		string        name;
+		FakeResource* pResource;
+	};
+
+}
+
+SG_TEST(ResourceTable, RemovedHandlesNeverGetTheNewResource)
+{
+	FakeResource resources[3];
+	FakeTable table;
+
+	const auto first = table.Add("first", &resources[0]);
+	const auto second = table.Add("second", &resources[1]);
+	SG_CHECK(first && second && first != second);
+	SG_CHECK(table.Get(first) == &resources[0]);
+	SG_CHECK(table.Get("second") == &resources[1]);
+	SG_CHECK(table.GetHandle("first") == first);
+	SG_CHECK(table.GetName(second) == "second");
+	SG_CHECK(table.GetNumResources() == 2);
+
+	SG_CHECK(table.Remove(first) == &resources[0]);
+	SG_CHECK(!table.IsValid(first));
+	SG_CHECK(!table.Have("first"));
+	SG_CHECK(!table.GetHandle("first"));
+	SG_CHECK(table.Remove(first) == nullptr);
+
+	// the new resource takes the slot of the removed one, the old handle still misses it
+	const auto third = table.Add("third", &resources[2]);
+	SG_CHECK(third.GetHandle().GetIndex() == first.GetHandle().GetIndex());
+	SG_CHECK(third != first);
+	SG_CHECK(table.Get(first) == nullptr);
+	SG_CHECK(table.Get(third) == &resources[2]);
+
+	// the name can be used again after the removal
+	const auto again = table.Add("first", &resources[0]);
+	SG_CHECK(table.Get("first") == &resources[0]);
+	SG_CHECK(again != first);
+}
+
+SG_TEST(ResourceTable, ReplaceKeepsTheHandle)
+{
+	FakeResource oldResource, newResource;
+	FakeTable table;
+
+	const auto handle = table.Add("target", &oldResource);
+	SG_CHECK(table.Replace(handle, &newResource) == &oldResource);
+	SG_CHECK(table.IsValid(handle));
+	SG_CHECK(table.Get(handle) == &newResource);
+	SG_CHECK(table.Get("target") == &newResource);
+
+	SG_CHECK(table.Remove("target") == &newResource);
+	SG_CHECK(table.Replace(handle, &oldResource) == nullptr);
+	SG_CHECK(table.GetNumResources() == 0);
+}
+
+SG_TEST(ResourceTable, ClearMakesAllTheHandlesInvalid)
+{
+	FakeResource resources[8];
+	FakeTable table;
+	vector<FakeTable::HandleType> handles;
+	for (UInt32 i = 0; i < 8; ++i)
+		handles.push_back(table.Add("resource" + eastl::to_string(i), &resources[i]));
+
+	table.Clear();
+	SG_CHECK(table.GetNumResources() == 0);
+	for (UInt32 i = 0; i < 8; ++i)
+	{
+		SG_CHECK(!table.IsValid(handles[i]));
+		SG_CHECK(table.Get(handles[i]) == nullptr);
+		SG_CHECK(!table.Have("resource" + eastl::to_string(i)));
+	}
+
+	// the slots are filled again from the start, the handles of before the clear do not match them
+	const auto handle = table.Add("resource0", &resources[0]);
+	SG_CHECK(handle.GetHandle().GetIndex() == handles[0].GetHandle().GetIndex());
+	SG_CHECK(table.Get(handles[0]) == nullptr);
+	SG_CHECK(table.Get(handle) == &resources[0]);
+}
+
+SG_TEST(ResourceTable, RandomOperationsMatchTheModel)
+{
+	Random random(23);
+	vector<FakeResource> resources(64);
+	FakeTable table;
+	vector<Entry> alive;
+	vector<FakeTable::HandleType> removed;
+	UInt32 nextName = 0;
+
+	for (UInt32 step = 0; step < 5000; ++step)
+	{
+		const UInt32 op = random.Range(0u, 99u);
+		if (op < 45 || alive.empty())
+		{
+			Entry entry;
+			entry.name = "resource" + eastl::to_string(nextName++);
+			entry.pResource = &resources[random.Range(0u, 63u)];
+			entry.handle = table.Add(entry.name, entry.pResource);
+			alive.push_back(entry);
+		}
+		else if (op < 85)
+		{
+			const UInt32 index = random.Range(0u, UInt32(alive.size() - 1));
+			const Entry entry = alive[index];
+			// by the handle or by the name, the result is the same
+			FakeResource* pRemoved = (op & 1) ? table.Remove(entry.handle) : table.Remove(entry.name);
+			SG_REQUIRE(pRemoved == entry.pResource);
+			removed.push_back(entry.handle);
+			alive.erase_unsorted(alive.begin() + index);
+		}
+		else if (op < 99)
+		{
+			auto& entry = alive[random.Range(0u, UInt32(alive.size() - 1))];
+			FakeResource* pResource = &resources[random.Range(0u, 63u)];
+			SG_REQUIRE(table.Replace(entry.handle, pResource) == entry.pResource);
+			entry.pResource = pResource;
+		}
+		else
+		{
+			table.Clear();
+			for (const auto& entry : alive)
+				removed.push_back(entry.handle);
+			alive.clear();
+		}
+
+		SG_REQUIRE(table.GetNumResources() == alive.size());
+		for (const auto& entry : alive)
+		{
+			SG_REQUIRE(table.IsValid(entry.handle));
+			SG_REQUIRE(table.Get(entry.handle) == entry.pResource);
+			SG_REQUIRE(table.GetHandle(entry.name) == entry.handle);
+			SG_REQUIRE(table.GetName(entry.handle) == entry.name);
+		}
+		for (const auto& handle : removed)
+			SG_REQUIRE(table.Get(handle) == nullptr);
+		// keep the check of the removed handles cheap
+		if (removed.size() > 256)
+			removed.erase(removed.begin(), removed.begin() + 128);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+-- The unit tests compile the engine sources they cover instead of linking the engine modules,
+-- so that they run headless (no window, no gpu) on every platform.
+
+-- the settings shared by the test runners, with the engine sources they all depend on (logger, file system, platform)
+local function testProjectSettings()
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    -- bin/Debug-windows-x64/SCoreTests
+    targetdir ("../bin/" .. outputdir .. "/%{prj.name}")
+    -- bin-int/Debug-windows-x64/SCoreTests
+    objdir    ("../bin-int/" .. outputdir .. "/%{prj.name}")
+
+    files
+    {
+        "Common/**.h",
+        "Common/**.cpp",
+
+        "../Engine/Core/Private/Memory/Allocator.cpp",
+        "../Engine/Core/Private/Memory/Memory.cpp",
+        "../Engine/Core/Private/Logger/**.cpp",
+        "../Engine/Core/Private/FileSystem/FileSystem.cpp",
+        "../Engine/Core/Private/Platform/**/Thread_*.cpp",
+        "../Engine/Core/Private/Platform/**/StreamOp_*.cpp",
+        "../Engine/Core/Private/Platform/**/FileInfo_*.cpp",
+        "../Engine/Core/Private/Platform/**/FileDialog_*.cpp",
+        "../Engine/Core/Private/Platform/**/SystemTime_*.cpp",
+    }
+
+    defines
+    {
+        "_SILENCE_CXX17_ADAPTOR_TYPEDEFS_DEPRECATION_WARNING", -- hash<Vector3f>
+        -- the tests read the resources of the repository
+        "SG_TEST_ROOT_PATH=\"" .. path.getabsolute("..") .. "/\"",
+    }
+
+    includedirs
+    {
+        "./",
+        "../Engine/",
+        "../Engine/Core/",
+        "../Engine/Core/Public/",
+        "../Libs/",
+        "../Libs/eastl/include/",
+        "../Libs/glm/",
+        "../Libs/json/single_include/",
+    }
+
+    links
+    {
+        "eastl",
+    }
+
+    filter "system:windows"
+    systemversion "latest"
+    defines "SG_PLATFORM_WINDOWS"
+    links "comdlg32"
+
+    filter "system:linux"
+    defines "SG_PLATFORM_LINUX=1"
+    links "pthread"
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        symbols "on"
+        staticruntime "off"
+
+    filter "configurations:DebugStatic"
+        runtime "Debug"
+        symbols "on"
+        staticruntime "on"
+
+    filter "configurations:Release"
+        runtime "Release"
+        optimize "on"
+        staticruntime "off"
+
+    filter {}
+end
+
+project "SCoreTests"
+    testProjectSettings()
+
+    files
+    {
+        "Core/**.h",
+        "Core/**.cpp",
+
+        -- engine sources under test
+        "../Engine/Core/Private/Memory/OffsetAllocator.cpp",
+        "../Engine/Core/Private/Math/MathBasic.cpp",
+        "../Engine/Core/Private/Math/BoundingBox.cpp",
+        "../Engine/Core/Private/Math/Plane.cpp",
+        "../Engine/Core/Private/Math/Frustum.cpp",
+        "../Engine/Core/Private/Math/FrustumCulling.cpp",
+        "../Engine/Core/Private/Scene/DynamicBVH.cpp",
+        "../Engine/Core/Private/Scene/SceneHierarchy.cpp",
+        "../Engine/Core/Private/Archive/SceneBinary.cpp",
+        "../Engine/Core/Private/Archive/MeshOptimizer.cpp",
+        "../Engine/Core/Private/Render/RenderGraphCompiler.cpp",
+        "../Engine/Core/Private/Thread/JobSystem.cpp",
+        "../Engine/Core/Private/Platform/**/Process_*.cpp",
+        "../Engine/Core/Private/Render/Shader/ShaderLibrary.cpp",
+    }
+
+    -- the AVX kernels of the culling are only built with AVX, so that the tests compare them with the SSE2 and the scalar ones.
+    filter "files:../Engine/Core/Private/Math/FrustumCulling.cpp"
+        vectorextensions "AVX"
+    filter {}
+
+-- The parts of the vulkan backend which do not touch the device.
+project "SRendererVulkanTests"
+    testProjectSettings()
+
+    files
+    {
+        "RendererVulkan/**.h",
+        "RendererVulkan/**.cpp",
+
+        -- engine sources under test
+        "../Engine/RendererVulkan/Backend/VulkanPipelineCacheBlob.cpp",
+    }
+
+    -- after the core ones, "StdAfx.h" is the one of the core
+    includedirs
+    {
+        "../Engine/RendererVulkan/",
+        "../Libs/volk/include/",
+        "../Libs/vulkan_memory_allocator/",
+    }
@@ -12,6 +12,7 @@ workspace "Seagull"
     platforms
     {
         "Win64",
+        "Linux64",
     }
 
     flags
@@ -19,6 +20,18 @@ workspace "Seagull"
 		"MultiProcessorCompile"
     }
 
+    filter "platforms:Win64"
+        system "Windows"
+        architecture "x86_64"
+
+    filter "platforms:Linux64"
+        system "linux"
+        architecture "x86_64"
+        toolset "gcc"
+        pic "On" -- the static libs are linked into the shared modules
+
+    filter {}
+
 -- Debug-windows-x64
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 IncludeDir = { }
@@ -47,6 +60,12 @@ group ""
 group "Tools"
 group ""
 
+group "Tests"
+
+    include "Tests/"
+
+group ""
+
 group "Runtime"
 
     project "Sandbox"
@@ -99,6 +118,9 @@ group "Runtime"
         systemversion "latest"
         defines "SG_PLATFORM_WINDOWS"
 
+    filter "system:linux"
+        defines "SG_PLATFORM_LINUX=1"
+
     filter "configurations:Debug"
         runtime "Debug"
         symbols "on"
@@ -134,8 +156,4 @@ group "Runtime"
             "SG_BUILD_DLL",
         }
 
-    filter "platforms:Win64"
-        system "Windows"
-        architecture "x86_64"
-
 group ""
\ No newline at end of file